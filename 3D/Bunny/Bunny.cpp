@@ -37,8 +37,8 @@ void Bunny::Initialize(Camera* camera) {
 	// identifier
 	modelName_ = "bunny";
 
-	// パイプラインのタイプ
-	pipelineType_ = PipelineType::BLINNPHONG;
+	// パイプラインのタイプ、同じモデルが続けば1回の描画にまとめる
+	pipelineType_ = PipelineType::INSTANCED;
 
 	// SRT
 	transform_.scale = { 0.5f,0.5f,0.5f };
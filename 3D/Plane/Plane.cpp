@@ -37,8 +37,8 @@ void Plane::Initialize(Camera* camera) {
 	// identifier
 	modelName_ = "plane";
 
-	// パイプラインのタイプ
-	pipelineType_ = PipelineType::BLINNPHONG;
+	// パイプラインのタイプ、同じモデルが続けば1回の描画にまとめる
+	pipelineType_ = PipelineType::INSTANCED;
 
 	// SRT
 	transform_.scale = { 1.0f,1.0f,1.0f };
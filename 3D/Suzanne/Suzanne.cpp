@@ -37,8 +37,8 @@ void Suzanne::Initialize(Camera* camera) {
 	// identifier
 	modelName_ = "suzanne";
 
-	// パイプラインのタイプ
-	pipelineType_ = PipelineType::BLINNPHONG;
+	// パイプラインのタイプ、同じモデルが続けば1回の描画にまとめる
+	pipelineType_ = PipelineType::INSTANCED;
 
 	// SRT
 	transform_.scale = { 0.5f,0.5f,0.5f };
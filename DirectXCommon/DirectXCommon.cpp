@@ -6,6 +6,117 @@
 #pragma comment(lib,"dxguid.lib")
 #pragma comment(lib,"dxcompiler.lib")
 
+//============================================================
+// namespace
+//============================================================
+namespace {
+
+	//============================================================
+	// D3D12FrameFence class
+	//============================================================
+	/// ID3D12FenceをFrameSchedulerから使うための橋渡し
+	class D3D12FrameFence : public IFrameFence {
+	public:
+
+		D3D12FrameFence(ID3D12CommandQueue* commandQueue, ID3D12Fence* fence, HANDLE fenceEvent) :
+			commandQueue_(commandQueue), fence_(fence), fenceEvent_(fenceEvent),
+			fenceValue_(fence->GetCompletedValue()) {}
+
+		uint64_t Signal() override {
+
+			// GPUがここまでたどり着いたときに、Fenceの値を指定した値に代入するようにSignalを送る
+			fenceValue_++;
+			HRESULT hr = commandQueue_->Signal(fence_, fenceValue_);
+			assert(SUCCEEDED(hr));
+
+			return fenceValue_;
+		}
+
+		uint64_t GetCompletedValue() const override { return fence_->GetCompletedValue(); }
+
+		void Wait(uint64_t value) override {
+
+			if (fence_->GetCompletedValue() < value) {
+
+				// 指定したSignalにたどり着いていないので、たどり着くまで待つようにイベントを設定する
+				fence_->SetEventOnCompletion(value, fenceEvent_);
+				// イベントを待つ
+				WaitForSingleObject(fenceEvent_, INFINITE);
+			}
+		}
+
+	private:
+
+		ID3D12CommandQueue* commandQueue_;
+		ID3D12Fence* fence_;
+		HANDLE fenceEvent_;
+		uint64_t fenceValue_;
+	};
+
+	//============================================================
+	// D3D12BarrierContext class
+	//============================================================
+	/// RenderGraphのバリアをコマンドリストに記録する
+	class D3D12BarrierContext : public IBarrierContext {
+	public:
+
+		D3D12BarrierContext(ID3D12GraphicsCommandList* commandList, const std::vector<ID3D12Resource*>& resources) :
+			commandList_(commandList), resources_(resources) {}
+
+		void ResourceBarrier(const RenderGraphBarrier* barriers, uint32_t count) override {
+
+			barriers_.resize(count);
+			for (uint32_t i = 0; i < count; ++i) {
+
+				const RenderGraphBarrier& source = barriers[i];
+				D3D12_RESOURCE_BARRIER& barrier = barriers_[i];
+				barrier = {};
+				barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+
+				switch (source.type) {
+				case RenderGraphBarrier::Type::TRANSITION:
+
+					barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+					barrier.Transition.pResource = resources_[source.resource];
+					barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+					// 値はD3D12_RESOURCE_STATESと同じ
+					barrier.Transition.StateBefore = static_cast<D3D12_RESOURCE_STATES>(source.stateBefore);
+					barrier.Transition.StateAfter = static_cast<D3D12_RESOURCE_STATES>(source.stateAfter);
+					break;
+				case RenderGraphBarrier::Type::ALIASING:
+
+					// 直前に使っていたものが分からないときはnullptr
+					barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+					barrier.Aliasing.pResourceBefore = source.resourceBefore == RenderGraph::kInvalidResource ?
+						nullptr : resources_[source.resourceBefore];
+					barrier.Aliasing.pResourceAfter = resources_[source.resource];
+					break;
+				case RenderGraphBarrier::Type::UNORDEREDACCESS:
+
+					barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+					barrier.UAV.pResource = resources_[source.resource];
+					break;
+				}
+			}
+
+			// まとめて1回で張る
+			commandList_->ResourceBarrier(count, barriers_.data());
+		}
+
+		void DiscardResource(RenderGraphResource resource) override {
+
+			// 全てのサブリソース
+			commandList_->DiscardResource(resources_[resource], nullptr);
+		}
+
+	private:
+
+		ID3D12GraphicsCommandList* commandList_;
+		const std::vector<ID3D12Resource*>& resources_;
+		std::vector<D3D12_RESOURCE_BARRIER> barriers_;
+	};
+}
+
 //============================================================
 // シングルトンインスタンス
 //============================================================
@@ -133,25 +244,6 @@ ComPtr<ID3D12DescriptorHeap> DirectXCommon::MakeDescriptorHeap(
 	return descriptorHeap;
 }
 
-//============================================================
-// TransitionBarrier
-//============================================================
-void DirectXCommon::TransitionBarrier() {
-
-	// 今回のバリアはTransition
-	barrier_.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-	// Noneにしておく
-	barrier_.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-	// バリアを貼る対象のリソース。現在のバックバッファに対して行う
-	barrier_.Transition.pResource = swapChainResources_[backBufferIndex_].Get();
-	// 遷移前(現在)のResourceState
-	barrier_.Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
-	// 遷移後のResourceState
-	barrier_.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
-	// TransitionBarrierを張る
-	commandList_->ResourceBarrier(1, &barrier_);
-}
-
 //============================================================
 // FenceとEventの生成
 //============================================================
@@ -159,8 +251,7 @@ void DirectXCommon::CreateFenceEvent() {
 
 	// 初期値0でFenceを作る
 	fence_ = nullptr;
-	fenceValue_ = 0;
-	hr_ = device_->CreateFence(fenceValue_, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence_));
+	hr_ = device_->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence_));
 	assert(SUCCEEDED(hr_));
 
 	// FenceのSignalを待つためのイベントの作成する
@@ -179,16 +270,25 @@ void DirectXCommon::CommandQueue() {
 	// コマンドキューの生成がうまくいったかどうか
 	assert(SUCCEEDED(hr_));
 
-	// コマンドアロケータを生成する
-	commandAllocator_ = nullptr;
-	hr_ = device_->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAllocator_));
+	// コマンドアロケータをフレーム数分生成する
+	commandAllocators_.resize(frameCount_);
+	for (auto& commandAllocator : commandAllocators_) {
 
-	// コマンドアロケータの生成がうまくいったかどうか
-	assert(SUCCEEDED(hr_));
+		commandAllocator = nullptr;
+		hr_ = device_->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAllocator));
+
+		// コマンドアロケータの生成がうまくいったかどうか
+		assert(SUCCEEDED(hr_));
+	}
+
+	// フレームの管理、キューができてからSignalできる
+	frameFence_ = std::make_unique<D3D12FrameFence>(commandQueue_.Get(), fence_.Get(), fenceEvent_);
+	frameScheduler_.Initialize(frameFence_.get(), frameCount_);
 
-	// コマンドリストを生成する
+	// コマンドリストを生成する、最初のフレームのアロケータで記録を始めておく
 	commandList_ = nullptr;
-	hr_ = device_->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocator_.Get(), nullptr, IID_PPV_ARGS(&commandList_));
+	hr_ = device_->CreateCommandList(
+		0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocators_[frameScheduler_.BeginFrame()].Get(), nullptr, IID_PPV_ARGS(&commandList_));
 
 	// コマンドリストの生成がうまくいったかどうか
 	assert(SUCCEEDED(hr_));
@@ -374,12 +474,18 @@ void DirectXCommon::CreateDevice() {
 
 	// デバイスの生成がうまくいかなかったので起動できない
 	assert(device_ != nullptr);
+
+	// 上限のないディスクリプタテーブルにはリソースバインディングTier2が必要
+	D3D12_FEATURE_DATA_D3D12_OPTIONS options{};
+	if (SUCCEEDED(device_->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options)))) {
+		resourceBindingTier_ = options.ResourceBindingTier;
+	}
 }
 
 //============================================================
 // DirectXの初期化
 //============================================================
-void DirectXCommon::Initialize(WinApp* winApp, int32_t width, int32_t height) {
+void DirectXCommon::Initialize(WinApp* winApp, int32_t width, int32_t height, uint32_t frameCount) {
 
 	// デバッグの表示、エラー警告
 	DebugLayer();
@@ -387,6 +493,7 @@ void DirectXCommon::Initialize(WinApp* winApp, int32_t width, int32_t height) {
 	// 変数の値の代入
 	kClientWidth_ = width;
 	kClientHeight_ = height;
+	frameCount_ = frameCount;
 
 	// デバイスの生成
 	CreateDevice();
@@ -429,10 +536,26 @@ void DirectXCommon::PreDraw() {
 	// これから書き込むバックバッファのインデックスを取得
 	backBufferIndex_ = swapChain_->GetCurrentBackBufferIndex();
 
-	TransitionBarrier();
+	// 前フレームの回数を保持してリセット
+	lastDescriptorHeapSetCount_ = descriptorHeapSetCount_.exchange(0);
+
+	// SRVヒープはフレームの最初に1度だけ設定する
+	SetDescriptorHeaps(commandList_.Get());
+
+	// このフレームのパスを登録し直す
+	// バックバッファはPresentで受け取ってPresentで返す。バリアはRenderGraphが張る
+	renderGraph_.Reset();
+	renderGraphResources_.clear();
+	backBuffer_ = renderGraph_.ImportResource("BackBuffer", RENDERGRAPH_STATE_PRESENT, RENDERGRAPH_STATE_PRESENT);
+	renderGraphResources_.push_back(swapChainResources_[backBufferIndex_].Get());
+	depthBuffer_ = renderGraph_.ImportResource("DepthBuffer", RENDERGRAPH_STATE_DEPTHWRITE, RENDERGRAPH_STATE_DEPTHWRITE);
+	renderGraphResources_.push_back(depthStencilResource_.Get());
 
 	// 画面のクリア
-	ClearWindow();
+	renderGraph_.AddPass("Clear", [this](RenderGraphBuilder& builder) {
+		builder.Write(backBuffer_, RENDERGRAPH_STATE_RENDERTARGET);
+		builder.Write(depthBuffer_, RENDERGRAPH_STATE_DEPTHWRITE);
+		}, [this]() { ClearWindow(); });
 
 	// ビューポートの設定
 	// クライアント領域のサイズと一緒にして画面全体に表示
@@ -460,13 +583,14 @@ void DirectXCommon::PreDraw() {
 //============================================================
 void DirectXCommon::PostDraw() {
 
-	// 画面に描く処理は全て終わり、画面に映すので、状態を遷移
-	// 今回はRenderTargetからPresentにする
-	barrier_.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
-	barrier_.Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
+	// 登録されたパスを、バリアを挟みながら記録する
+	// 最後にバックバッファをPresentへ戻すので、そのまま画面に映せる
+	renderGraph_.Compile();
+	CreateTransientResources();
 
-	// TransitionBarrierを張る
-	commandList_->ResourceBarrier(1, &barrier_);
+	D3D12BarrierContext barrierContext(commandList_.Get(), renderGraphResources_);
+	renderGraph_.Execute(barrierContext);
+	renderGraphStats_ = renderGraph_.GetStats();
 
 	// コマンドリストの内容を確定させる。すべてのコマンドを積んでからCloseする
 	hr_ = commandList_->Close();
@@ -479,27 +603,275 @@ void DirectXCommon::PostDraw() {
 	// GPUとOSに画面の交換を行うように通知する
 	swapChain_->Present(1, 0);
 
-	// Feneceの値を更新
-	fenceValue_++;
-	// GPUがここまでたどり着いたときに、Fenceの値を指定した値に代入するようにSignalを送る
-	commandQueue_->Signal(fence_.Get(), fenceValue_);
+	// Signalを送ってこのフレームを投げ終える。GPUの完了は待たない
+	frameScheduler_.EndFrame();
 
-	// Fenceの値が指定したSignal値にたどり着いているか確認する
-	if (fence_->GetCompletedValue() < fenceValue_) {
+	// 次に使うフレームのアロケータを、GPUが使い終わるまで待つ
+	// frameCount_分前のフレームなので、GPUが遅れていなければ待たずに済む
+	uint32_t frameIndex = frameScheduler_.BeginFrame();
 
-		// 指定したSignalにたどり着いていないので、たどり着くまで待つようにイベントを設定する
-		fence_->SetEventOnCompletion(fenceValue_, fenceEvent_);
-		// イベントを待つ
-		WaitForSingleObject(fenceEvent_, INFINITE);
+	// 次のフレーム用のコマンドリストを準備
+	hr_ = commandAllocators_[frameIndex]->Reset();
+	assert(SUCCEEDED(hr_));
+	hr_ = commandList_->Reset(commandAllocators_[frameIndex].Get(), nullptr);
+	assert(SUCCEEDED(hr_));
+}
+
+//============================================================
+// 全てのフレームの完了待ち
+//============================================================
+void DirectXCommon::WaitForGpu() {
 
-		// このあとでGPUの実行を待ってからResetが呼び出される
+	frameScheduler_.WaitForGpu();
+}
+
+//============================================================
+// 遅延解放
+//============================================================
+void DirectXCommon::DeferRelease(ComPtr<ID3D12Resource> resource) {
+
+	// ラムダが参照を持ち続け、呼ばれたら手放す
+	frameScheduler_.DeferRelease([resource]() mutable { resource.Reset(); });
+}
+
+void DirectXCommon::DeferRelease(std::function<void()> release) {
+
+	frameScheduler_.DeferRelease(std::move(release));
+}
+
+//============================================================
+// 並列記録用のコマンドリストの生成
+//============================================================
+void DirectXCommon::CreateRecordCommandLists(uint32_t contextCount) {
+
+	// アロケータはGPUが使い終わるまでResetできないので、フレーム数分持つ
+	recordCommandAllocators_.resize(frameCount_);
+	for (auto& allocators : recordCommandAllocators_) {
+
+		allocators.resize(contextCount);
+		for (auto& allocator : allocators) {
+
+			hr_ = device_->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&allocator));
+			assert(SUCCEEDED(hr_));
+		}
 	}
 
-	// 次のフレーム用のコマンドリストを準備
-	hr_ = commandAllocator_->Reset();
+	recordCommandLists_.resize(contextCount);
+	for (uint32_t i = 0; i < contextCount; ++i) {
+
+		hr_ = device_->CreateCommandList(
+			0, D3D12_COMMAND_LIST_TYPE_DIRECT, recordCommandAllocators_[0][i].Get(), nullptr, IID_PPV_ARGS(&recordCommandLists_[i]));
+		assert(SUCCEEDED(hr_));
+
+		// 記録を始めるまでは閉じておく
+		hr_ = recordCommandLists_[i]->Close();
+		assert(SUCCEEDED(hr_));
+	}
+}
+
+//============================================================
+// 並列記録用のコマンドリストの記録開始
+//============================================================
+ID3D12GraphicsCommandList* DirectXCommon::BeginRecordCommandList(uint32_t contextIndex) {
+
+	ID3D12CommandAllocator* allocator =
+		recordCommandAllocators_[frameScheduler_.GetFrameIndex()][contextIndex].Get();
+	ID3D12GraphicsCommandList* commandList = recordCommandLists_[contextIndex].Get();
+
+	// 各記録先はフレームに1度しか使わないので、ここでResetしてよい
+	HRESULT hr = allocator->Reset();
+	assert(SUCCEEDED(hr));
+	hr = commandList->Reset(allocator, nullptr);
+	assert(SUCCEEDED(hr));
+
+	// コマンドリストをまたいで状態は引き継がれないので設定し直す
+	SetDescriptorHeaps(commandList);
+	SetRenderTargets(commandList);
+
+	return commandList;
+}
+
+//============================================================
+// 並列記録したコマンドリストの実行
+//============================================================
+void DirectXCommon::ExecuteRecordCommandLists(uint32_t contextCount) {
+
+	// メインのコマンドリスト(バリア、クリア)を先頭に、記録先の番号順に並べる
+	std::vector<ID3D12CommandList*> commandLists;
+	commandLists.reserve(contextCount + 1);
+
+	hr_ = commandList_->Close();
 	assert(SUCCEEDED(hr_));
-	hr_ = commandList_->Reset(commandAllocator_.Get(), nullptr);
+	commandLists.push_back(commandList_.Get());
+
+	for (uint32_t i = 0; i < contextCount; ++i) {
+
+		hr_ = recordCommandLists_[i]->Close();
+		assert(SUCCEEDED(hr_));
+		commandLists.push_back(recordCommandLists_[i].Get());
+	}
+
+	commandQueue_->ExecuteCommandLists(static_cast<UINT>(commandLists.size()), commandLists.data());
+
+	// メインのコマンドリストは同じアロケータのまま続きを記録する
+	hr_ = commandList_->Reset(commandAllocators_[frameScheduler_.GetFrameIndex()].Get(), nullptr);
 	assert(SUCCEEDED(hr_));
+	SetDescriptorHeaps(commandList_.Get());
+	SetRenderTargets(commandList_.Get());
+}
+
+//============================================================
+// 共有のSRVヒープの設定
+//============================================================
+void DirectXCommon::SetDescriptorHeaps(ID3D12GraphicsCommandList* commandList) {
+
+	if (!descriptorHeap_) {
+		return;
+	}
+
+	ID3D12DescriptorHeap* descriptorHeaps[] = { descriptorHeap_ };
+	commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+	descriptorHeapSetCount_++;
+}
+
+//============================================================
+// 描画先の設定
+//============================================================
+void DirectXCommon::SetRenderTargets(ID3D12GraphicsCommandList* commandList) {
+
+	D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle = dsvDescriptorHeap_->GetCPUDescriptorHandleForHeapStart();
+	commandList->OMSetRenderTargets(1, &rtvHandles_[backBufferIndex_], false, &dsvHandle);
+	commandList->RSSetViewports(1, &viewport_);
+	commandList->RSSetScissorRects(1, &scissorRect_);
+}
+
+//============================================================
+// RenderGraphの一時的なテクスチャの登録
+//============================================================
+RenderGraphResource DirectXCommon::CreateRenderGraphTexture(
+	const std::string& name, uint32_t width, uint32_t height, DXGI_FORMAT format, uint32_t usage) {
+
+	D3D12_RESOURCE_DESC resourceDesc{};
+	resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+	resourceDesc.Width = width;
+	resourceDesc.Height = height;
+	resourceDesc.DepthOrArraySize = 1;
+	resourceDesc.MipLevels = 1;
+	resourceDesc.Format = format;
+	resourceDesc.SampleDesc.Count = 1;
+	resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+
+	// RTとDSのテクスチャだけのヒープに置くので、UAVもRTとして作る
+	switch (usage) {
+	case RENDERGRAPH_STATE_RENDERTARGET:
+		resourceDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+		break;
+	case RENDERGRAPH_STATE_DEPTHWRITE:
+		resourceDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+		break;
+	case RENDERGRAPH_STATE_UNORDEREDACCESS:
+		resourceDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+		break;
+	default:
+		assert(false);
+		break;
+	}
+
+	// ヒープ上のサイズと境界
+	D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = device_->GetResourceAllocationInfo(0, 1, &resourceDesc);
+
+	RenderGraphTextureDesc desc{};
+	desc.name = name;
+	desc.width = width;
+	desc.height = height;
+	desc.format = static_cast<uint32_t>(format);
+	desc.usage = usage;
+	desc.size = allocationInfo.SizeInBytes;
+	desc.alignment = allocationInfo.Alignment;
+
+	RenderGraphResource resource = renderGraph_.CreateTexture(desc);
+	// 実体はCompileの後に配置する
+	renderGraphResources_.push_back(nullptr);
+
+	return resource;
+}
+
+//============================================================
+// 一時的なテクスチャの配置
+//============================================================
+void DirectXCommon::CreateTransientResources() {
+
+	const auto& placements = renderGraph_.GetPlacements();
+
+	// 配置が前フレームと同じならそのまま使う
+	std::vector<uint64_t> layout;
+	layout.reserve(placements.size() * 6);
+	for (const auto& placement : placements) {
+
+		const RenderGraphTextureDesc& desc = renderGraph_.GetTextureDesc(placement.resource);
+		layout.insert(layout.end(), {
+			placement.resource, placement.offset, placement.initialState,
+			desc.width, desc.height, (static_cast<uint64_t>(desc.format) << 32) | desc.usage });
+	}
+
+	if (layout != transientLayout_) {
+
+		// GPUが前フレームで使っているかもしれないので遅延解放
+		for (auto& resource : transientResources_) {
+			if (resource) {
+				DeferRelease(resource);
+			}
+		}
+		if (transientHeap_) {
+			ComPtr<ID3D12Heap> heap = transientHeap_;
+			DeferRelease([heap]() mutable { heap.Reset(); });
+		}
+		transientResources_.clear();
+		transientHeap_.Reset();
+		transientLayout_ = std::move(layout);
+
+		if (!placements.empty()) {
+
+			D3D12_HEAP_DESC heapDesc{};
+			heapDesc.SizeInBytes = renderGraph_.GetTransientHeapSize();
+			heapDesc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+			heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+			heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+			hr_ = device_->CreateHeap(&heapDesc, IID_PPV_ARGS(&transientHeap_));
+			assert(SUCCEEDED(hr_));
+
+			transientResources_.resize(renderGraph_.GetResourceCount());
+			for (const auto& placement : placements) {
+
+				const RenderGraphTextureDesc& desc = renderGraph_.GetTextureDesc(placement.resource);
+
+				D3D12_RESOURCE_DESC resourceDesc{};
+				resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+				resourceDesc.Width = desc.width;
+				resourceDesc.Height = desc.height;
+				resourceDesc.DepthOrArraySize = 1;
+				resourceDesc.MipLevels = 1;
+				resourceDesc.Format = static_cast<DXGI_FORMAT>(desc.format);
+				resourceDesc.SampleDesc.Count = 1;
+				resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+				resourceDesc.Flags = desc.usage == RENDERGRAPH_STATE_DEPTHWRITE ?
+					D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL : D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+				if (desc.usage == RENDERGRAPH_STATE_UNORDEREDACCESS) {
+					resourceDesc.Flags |= D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+				}
+
+				// 最初に使うときの状態で作る
+				hr_ = device_->CreatePlacedResource(transientHeap_.Get(), placement.offset, &resourceDesc,
+					static_cast<D3D12_RESOURCE_STATES>(placement.initialState), nullptr,
+					IID_PPV_ARGS(&transientResources_[placement.resource]));
+				assert(SUCCEEDED(hr_));
+			}
+		}
+	}
+
+	for (const auto& placement : placements) {
+		renderGraphResources_[placement.resource] = transientResources_[placement.resource].Get();
+	}
 }
 
 //============================================================
@@ -507,6 +879,13 @@ void DirectXCommon::PostDraw() {
 //============================================================
 void DirectXCommon::Finalize(WinApp* winApp) {
 
+	// GPUが使っているものを残さない
+	WaitForGpu();
+	frameFence_.reset();
+
+	transientResources_.clear();
+	transientHeap_.Reset();
+
 	CloseHandle(fenceEvent_);
 
 	CloseWindow(winApp->GetHwnd());
@@ -7,10 +7,17 @@
 #include <dxcapi.h>
 
 #include <cassert>
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <functional>
 
 #include "WinApp.h"
 #include "Vector.h"
 #include "ComPtr.h"
+#include "FrameScheduler.h"
+#include "RenderGraph.h"
 
 // 解放忘れのチェック
 struct LeakChecker {
@@ -48,7 +55,6 @@ public:
 	void DebugLayer();
 	void DebugInfo();
 
-	void TransitionBarrier();
 	void CreateFenceEvent();
 
 	void CommandQueue();
@@ -60,11 +66,59 @@ public:
 	void CreateDSV();
 	void ClearWindow();
 
-	void Initialize(WinApp* winApp, int32_t width, int32_t height);
+	// frameCountはGPUに同時に投げておけるフレーム数
+	void Initialize(WinApp* winApp, int32_t width, int32_t height, uint32_t frameCount = 2);
 	void PreDraw();
 	void PostDraw();
 	void Finalize(WinApp* winApp);
 
+	// 全てのフレームの完了を待つ
+	void WaitForGpu();
+
+	// 使用中かもしれないリソースを、現在のフレームがGPUで完了してから解放する
+	void DeferRelease(ComPtr<ID3D12Resource> resource);
+	// リソース以外、ディスクリプタの返却など
+	void DeferRelease(std::function<void()> release);
+
+	// 各コマンドリストの記録開始時に設定するSRVヒープ、フレーム中は切り替えない
+	void SetDescriptorHeap(ID3D12DescriptorHeap* descriptorHeap) { descriptorHeap_ = descriptorHeap; }
+
+	/*-----------------------------------------------------------------------------------------*/
+	/// 並列記録
+
+	// 並列記録用のコマンドリストの生成、contextCount個をフレーム数分
+	void CreateRecordCommandLists(uint32_t contextCount);
+
+	// 並列記録用のコマンドリストを記録できる状態にする。別スレッドから呼べる
+	ID3D12GraphicsCommandList* BeginRecordCommandList(uint32_t contextIndex);
+
+	// メインのコマンドリストに続けて、並列記録したcontextCount個を番号順に実行する
+	// メインのコマンドリストはそのまま続きを記録できる
+	void ExecuteRecordCommandLists(uint32_t contextCount);
+
+	// 描画先、ビューポート、シザー矩形の設定
+	void SetRenderTargets(ID3D12GraphicsCommandList* commandList);
+
+	/*-----------------------------------------------------------------------------------------*/
+	/// RenderGraph
+
+	// フレームのパスを登録するRenderGraph、PreDrawで作り直しPostDrawで実行する
+	// バックバッファと深度バッファは登録済みで、画面のクリアのパスが先頭に入っている
+	RenderGraph& GetRenderGraph() { return renderGraph_; }
+	RenderGraphResource GetBackBuffer() const { return backBuffer_; }
+	RenderGraphResource GetDepthBuffer() const { return depthBuffer_; }
+
+	// 一時的なテクスチャの登録、寿命が重ならないもの同士で1つのヒープを共有する
+	// usageはRENDERTARGET、DEPTHWRITE、UNORDEREDACCESSのどれか
+	RenderGraphResource CreateRenderGraphTexture(
+		const std::string& name, uint32_t width, uint32_t height, DXGI_FORMAT format, uint32_t usage);
+
+	// RenderGraphのリソースの実体、一時的なテクスチャはPostDrawのCompileの後から使える
+	ID3D12Resource* GetRenderGraphResource(RenderGraphResource resource) const { return renderGraphResources_[resource]; }
+
+	// 前フレームのRenderGraphの統計
+	const RenderGraph::Stats& GetRenderGraphStats() const { return renderGraphStats_; }
+
 	// シングルトン
 	static DirectXCommon* Instance();
 
@@ -76,6 +130,27 @@ public:
 	IDxcCompiler3* GetDxcCompiler() const { return dxcCompiler_.Get(); }
 	IDxcIncludeHandler* GetIncludeHandler() const { return includeHandler_.Get(); }
 
+	// 最後にSignalしたFenceの値
+	uint64_t GetFenceValue() const { return frameScheduler_.GetLastSignaledValue(); }
+	// GPUが完了したFenceの値
+	uint64_t GetCompletedFenceValue() const { return fence_->GetCompletedValue(); }
+	// GPUの完了を待つためのフェンス
+	IFrameFence* GetFrameFence() const { return frameFence_.get(); }
+	// ヒープ全体をテクスチャの配列として使えるか、インスタンシングのパイプラインに必要
+	bool IsBindlessSupported() const { return resourceBindingTier_ >= D3D12_RESOURCE_BINDING_TIER_2; }
+
+	// 同時に投げておけるフレーム数
+	uint32_t GetFrameCount() const { return frameScheduler_.GetFrameCount(); }
+	// 記録中のフレーム番号
+	uint32_t GetFrameIndex() const { return frameScheduler_.GetFrameIndex(); }
+	const FrameScheduler::Stats& GetFrameStats() const { return frameScheduler_.GetStats(); }
+	// 前フレームでSetDescriptorHeapsを呼んだ回数、コマンドリスト1つにつき1回になる
+	uint32_t GetDescriptorHeapSetCount() const { return lastDescriptorHeapSetCount_; }
+
+	// 描画先の大きさ
+	int32_t GetClientWidth() const { return kClientWidth_; }
+	int32_t GetClientHeight() const { return kClientHeight_; }
+
 	DXGI_SWAP_CHAIN_DESC1& GetSwapChainDesc() { return swapChainDesc_; }
 	D3D12_DESCRIPTOR_HEAP_DESC& GetRTVDesc() { return rtvDescriptorHeapDesc_; }
 
@@ -95,7 +170,11 @@ private:
 	ComPtr<IDXGIAdapter4> useAdapter_;
 	ComPtr<ID3D12Device> device_;
 	ComPtr<ID3D12CommandQueue> commandQueue_;
-	ComPtr<ID3D12CommandAllocator> commandAllocator_;
+	// フレームごとのコマンドアロケータ、GPUが使い終わるまでResetできない
+	std::vector<ComPtr<ID3D12CommandAllocator>> commandAllocators_;
+	// 並列記録用 アロケータは[フレーム][記録先]
+	std::vector<std::vector<ComPtr<ID3D12CommandAllocator>>> recordCommandAllocators_;
+	std::vector<ComPtr<ID3D12GraphicsCommandList>> recordCommandLists_;
 	ComPtr<ID3D12GraphicsCommandList> commandList_;
 	ComPtr<IDXGISwapChain4> swapChain_;
 	ComPtr<ID3D12DescriptorHeap> rtvDescriptorHeap_;
@@ -115,9 +194,38 @@ private:
 	D3D12_CPU_DESCRIPTOR_HANDLE rtvStartHandle_;
 	D3D12_CPU_DESCRIPTOR_HANDLE rtvHandles_[2];
 	UINT backBufferIndex_;
-	D3D12_RESOURCE_BARRIER barrier_{};
-	uint64_t fenceValue_;
 	HANDLE fenceEvent_;
+	// fence_を使ったIFrameFence
+	std::unique_ptr<IFrameFence> frameFence_;
+	// フレームの使い回しと遅延解放
+	FrameScheduler frameScheduler_;
+	uint32_t frameCount_ = 2;
+
+	// デバイスのリソースバインディングTier
+	D3D12_RESOURCE_BINDING_TIER resourceBindingTier_ = D3D12_RESOURCE_BINDING_TIER_1;
+
+	// 共有のSRVヒープ
+	ID3D12DescriptorHeap* descriptorHeap_ = nullptr;
+	// SetDescriptorHeapsの回数、並列記録から数えるのでatomic
+	std::atomic<uint32_t> descriptorHeapSetCount_ = 0;
+	uint32_t lastDescriptorHeapSetCount_ = 0;
+
+	// フレームのパスとバリア
+	RenderGraph renderGraph_;
+	RenderGraphResource backBuffer_ = RenderGraph::kInvalidResource;
+	RenderGraphResource depthBuffer_ = RenderGraph::kInvalidResource;
+	RenderGraph::Stats renderGraphStats_;
+	// RenderGraphのリソースの番号から実体へ
+	std::vector<ID3D12Resource*> renderGraphResources_;
+	// 一時的なテクスチャのヒープ、配置が変わらなければ使い回す
+	ComPtr<ID3D12Heap> transientHeap_;
+	std::vector<ComPtr<ID3D12Resource>> transientResources_;
+	std::vector<uint64_t> transientLayout_;
+
+	// 共有のSRVヒープを設定する
+	void SetDescriptorHeaps(ID3D12GraphicsCommandList* commandList);
+	// 一時的なテクスチャをヒープに配置する
+	void CreateTransientResources();
 	D3D12_VIEWPORT viewport_{};
 	D3D12_RECT scissorRect_{};
 
@@ -2,21 +2,184 @@
 
 #include <objbase.h>
 #include <array>
+#include <cmath>
 #include <memory>
 #include <utility>
+#include <thread>
+#include <optional>
+#include <atomic>
+#include <format>
+#include <type_traits>
+#include <filesystem>
 
 #include "WinApp.h"
 #include "DirectXCommon.h"
 #include "ImGuiManager.h"
 #include "TextureManager.h"
+#include "DescriptorHeapManager.h"
+#include "BufferManager.h"
+#include "UploadManager.h"
 #include "ModelManager.h"
 #include "VertexObject.h"
+#include "InstanceBatcher.h"
+#include "PrimitiveBatcher.h"
+#include "GeometryArena.h"
+#include "MeshCache.h"
+#include "VertexResource.h"
+#include "DrawCommand.h"
+#include "JobGraph.h"
+#include "Logger.h"
 
 //============================================================
 // namespace
 //============================================================
 namespace {
 
+	//============================================================
+	// D3D12CommandContext class
+	//============================================================
+	/// DrawCommandをコマンドリストに記録する
+	class D3D12CommandContext : public ICommandContext {
+	public:
+
+		D3D12CommandContext(ID3D12GraphicsCommandList* commandList, Pipeline* pipeline) :
+			commandList_(commandList), pipeline_(pipeline) {}
+
+		void SetPipeline(uint32_t pipelineType) override {
+
+			// 初めて使うパイプラインはここで生成される
+			const PipelineObject* pipeline = pipeline_->Get(pipelineType);
+
+			// RootSignatureの設定
+			commandList_->SetGraphicsRootSignature(pipeline->rootSignature.Get());
+			// PipelineStateの設定
+			commandList_->SetPipelineState(pipeline->pipelineState.Get());
+
+			// 形状を設定。PSOに設定しているものとはまた別。同じものを設定すると考える
+			commandList_->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		}
+
+		void SetVertexBuffer(uint64_t address, uint32_t sizeInBytes, uint32_t strideInBytes) override {
+
+			D3D12_VERTEX_BUFFER_VIEW vertexBufferView{ address, sizeInBytes, strideInBytes };
+			commandList_->IASetVertexBuffers(0, 1, &vertexBufferView);
+		}
+
+		void SetIndexBuffer(uint64_t address, uint32_t sizeInBytes) override {
+
+			D3D12_INDEX_BUFFER_VIEW indexBufferView{ address, sizeInBytes, DXGI_FORMAT_R32_UINT };
+			commandList_->IASetIndexBuffer(&indexBufferView);
+		}
+
+		void SetRootConstantBuffer(uint32_t rootIndex, uint64_t address) override {
+
+			commandList_->SetGraphicsRootConstantBufferView(rootIndex, address);
+		}
+
+		void SetRootShaderResource(uint32_t rootIndex, uint64_t address) override {
+
+			commandList_->SetGraphicsRootShaderResourceView(rootIndex, address);
+		}
+
+		void SetRootDescriptorTable(uint32_t rootIndex, uint64_t gpuHandle) override {
+
+			commandList_->SetGraphicsRootDescriptorTable(rootIndex, D3D12_GPU_DESCRIPTOR_HANDLE{ gpuHandle });
+		}
+
+		void Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex) override {
+
+			commandList_->DrawInstanced(vertexCount, instanceCount, startVertex, 0);
+		}
+
+		void DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, uint32_t baseVertex) override {
+
+			commandList_->DrawIndexedInstanced(indexCount, instanceCount, startIndex, static_cast<INT>(baseVertex), 0);
+		}
+
+	private:
+
+		ID3D12GraphicsCommandList* commandList_;
+		Pipeline* pipeline_;
+	};
+
+	//============================================================
+	// BufferGeometryAllocator class
+	//============================================================
+	/// GeometryArenaのページをBufferManagerから切り出す
+	class BufferGeometryAllocator : public IGeometryAllocator {
+	public:
+
+		GeometryPage AllocatePage(uint64_t size) override {
+
+			// 返却用に切り出した情報を持たせておく
+			BufferAllocation* allocation = new BufferAllocation(BufferManager::Instance()->Allocate(size));
+
+			GeometryPage page{};
+			page.cpuAddress = allocation->cpuAddress;
+			page.gpuAddress = allocation->gpuAddress;
+			page.size = allocation->size;
+			page.handle = allocation;
+
+			return page;
+		}
+
+		void FreePage(GeometryPage& page) override {
+
+			BufferAllocation* allocation = static_cast<BufferAllocation*>(page.handle);
+			BufferManager::Instance()->Free(*allocation);
+			delete allocation;
+
+			page = {};
+		}
+	};
+
+	//============================================================
+	// D3D12MeshFactory class
+	//============================================================
+	/// MeshCacheのメッシュを頂点、インデックスバッファにする
+	/// 形状は変わらないのでデフォルトヒープに置き、UploadManagerで転送する
+	class D3D12MeshFactory : public IMeshFactory {
+	public:
+
+		// 生成したメッシュ
+		struct Mesh {
+
+			ComPtr<ID3D12Resource> vertexResource;
+			D3D12_VERTEX_BUFFER_VIEW vertexBufferView{};
+			ComPtr<ID3D12Resource> indexResource;
+			D3D12_INDEX_BUFFER_VIEW indexBufferView{};
+
+			// 転送は登録順に記録されるので、後に登録したインデックスの転送を待てばよい
+			UploadId uploadId = UploadQueue::kInvalidId;
+		};
+
+		void* CreateMesh(const ProceduralMeshData& data) override {
+
+			UploadManager* uploadManager = UploadManager::Instance();
+			Mesh* mesh = new Mesh();
+
+			UINT sizeVB = static_cast<UINT>(sizeof(VertexData) * data.vertices.size());
+			UINT sizeIB = static_cast<UINT>(sizeof(uint32_t) * data.indices.size());
+
+			mesh->vertexResource = uploadManager->CreateBuffer(sizeVB);
+			mesh->vertexBufferView = { mesh->vertexResource->GetGPUVirtualAddress(), sizeVB, sizeof(VertexData) };
+			mesh->indexResource = uploadManager->CreateBuffer(sizeIB);
+			mesh->indexBufferView = { mesh->indexResource->GetGPUVirtualAddress(), sizeIB, DXGI_FORMAT_R32_UINT };
+
+			// 元データは記録し終わるまで転送側で持つ
+			auto source = std::make_shared<const ProceduralMeshData>(data);
+			uploadManager->UploadBuffer(mesh->vertexResource.Get(), source->vertices.data(), sizeVB, source);
+			mesh->uploadId = uploadManager->UploadBuffer(mesh->indexResource.Get(), source->indices.data(), sizeIB, source);
+
+			return mesh;
+		}
+
+		void DestroyMesh(void* mesh) override {
+
+			delete static_cast<Mesh*>(mesh);
+		}
+	};
+
 	//============================================================
 	// EngineSystem class 
 	//============================================================
@@ -54,6 +217,24 @@ namespace {
 		ImGuiManager* imgui_ = nullptr;
 		TextureManager* textureManager_ = nullptr;
 		ModelManager* modelManager_ = nullptr;
+		VertexResource* vertexResource_ = nullptr;
+		BufferManager* bufferManager_ = nullptr;
+		UploadManager* uploadManager_ = nullptr;
+
+
+
+		/*-----------------------------------------------------------------------------------------*/
+		/// 起動
+
+
+
+		// 起動時のジョブの統計
+		JobGraph::Stats startupStats_;
+		// ジョブごとの時間、登録順
+		std::vector<Engine::StartupTiming> startupTimings_;
+
+		// ジョブごとの時間とクリティカルパスを出力して保持する
+		void LogStartup(const JobGraph& jobs);
 
 
 
@@ -62,19 +243,14 @@ namespace {
 
 
 
-		// 三角形の最大数
-		static const int32_t kMaxTriangleNum = 3;
 		// 三角形の頂点数
 		static const UINT kTriangleVertexNum = 3;
-		// 三角形使用数
-		uint32_t indexTriangle = 0;
 
-		// 三角錐の最大数
-		static const int32_t kMaxTriangularPrismNum = 1;
 		// 三角錐の頂点数
 		static const UINT kTriangularPrismVertexNum = 12;
-		// 三角錐使用数
-		uint32_t indexTriangularPrism = 0;
+
+		// 三角形、三角錐の頂点の置き場の最初の大きさ、足りなければ大きくなる
+		static const uint64_t kGeometryArenaPageSize = 64 * 1024;
 
 
 
@@ -92,58 +268,51 @@ namespace {
 
 
 
-#pragma region /// 三角メッシュ ///
-		// メッシュデータ
-		struct MeshData {
+#pragma region /// 三角形、三角錐 ///
+		// フレームごとに使い捨てる頂点の置き場
+		std::unique_ptr<BufferGeometryAllocator> geometryAllocator_;
+		std::unique_ptr<GeometryArena> geometryArena_;
 
-			// 頂点バッファ
-			ComPtr<ID3D12Resource> vertexResource;
-			// 頂点バッファビュー
-			D3D12_VERTEX_BUFFER_VIEW vertexBufferView{};
+		// 連続する同じ条件の三角形、三角錐をまとめる
+		std::unique_ptr<PrimitiveBatcher> primitiveBatcher_;
+		// 前フレームの統計
+		PrimitiveBatcher::Stats primitiveStats_;
 
-			// 頂点バッファデータ
-			VertexData* vertex = nullptr;
-		};
-		// 三角形メッシュデータ
-		std::unique_ptr<MeshData> triangle_;
-		// メッシュ生成
-		std::unique_ptr<MeshData> CreateMesh(UINT vertexCount);
-#pragma endregion
-
-#pragma region /// 三角錐メッシュ ///
-		// 三角錐データ
-		struct TriangularPrismData {
+		// 頂点の置き場とまとめ機能の生成
+		void CreatePrimitiveBatcher();
 
-			// 頂点バッファ
-			ComPtr<ID3D12Resource> vertexResource;
-			// 頂点バッファビュー
-			D3D12_VERTEX_BUFFER_VIEW vertexBufferView{};
+		// まとめ条件の作成、頂点はワールド座標に変換する。Worldが潰れていて何も描かれなければfalse
+		// アトラスにまとめたテクスチャはuvの変換を頂点に焼き込み、同じページの別のテクスチャともまとめられるようにする
+		bool MakePrimitiveBatchKey(const std::string& identifier, const CBufferData* cBufferData, PipelineType pipelineType,
+			VertexData* vertices, uint32_t vertexCount, PrimitiveBatchKey& key);
 
-			// 頂点バッファデータ
-			VertexData* vertex = nullptr;
-		};
-		// 三角錐データ
-		std::unique_ptr<TriangularPrismData> triangularPrism_;
-		// 三角錐メッシュの生成
-		std::unique_ptr<TriangularPrismData> CreateTriangularPrismMesh(UINT vertexCount);
+		// まとめた三角形、三角錐の描画
+		void DrawPrimitives(const PrimitiveBatchKey& key, const PrimitiveBatch& batch);
 #pragma endregion
 
 #pragma region /// モデルメッシュ ///
 		// モデルデータ
 		struct ModelMeshData {
 
-			// 頂点バッファ
+			// 頂点バッファ、頂点は変わらないのでデフォルトヒープに置く
 			ComPtr<ID3D12Resource> vertexResource;
 			// 頂点バッファビュー
 			D3D12_VERTEX_BUFFER_VIEW vertexBufferView{};
 
-			// 頂点バッファデータ
-			VertexData* vertex = nullptr;
+			// 頂点の転送、記録し終えるまでは描画しない
+			UploadId uploadId = UploadQueue::kInvalidId;
+
+			// 1つ分の頂点数、描画のたびにモデルデータを引かない
+			uint32_t vertexCount = 0;
 		};
+		// 起動時に読むObjの置き場
+		static inline const char* kObjDirectory = "./Resources/Obj";
 		// モデルデータ
 		std::unordered_map<std::string, std::unique_ptr<ModelMeshData>> models_;
 		// モデルメッシュの生成
-		std::unique_ptr<ModelMeshData> CreateModelMesh(UINT vertexCount);
+		std::unique_ptr<ModelMeshData> CreateModelMesh(const std::vector<VertexData>& vertices);
+		// 名前からモデルメッシュを探す、読み込まれていなければnullptr
+		const ModelMeshData* FindModelMesh(const std::string& identifier) const;
 		// 各種モデルの生成
 		void CreateModel(const std::string& identifier);
 
@@ -154,8 +323,72 @@ namespace {
 		}
 #pragma endregion
 
-		// メッシュ生成
-		void CreateMeshes();
+#pragma region /// 生成メッシュ ///
+		// 形状の設定から生成したメッシュ、同じ設定は1つを共有する
+		std::unique_ptr<D3D12MeshFactory> meshFactory_;
+		MeshCache meshCache_;
+#pragma endregion
+
+
+
+		/*-----------------------------------------------------------------------------------------*/
+		/// インスタンシング
+
+
+
+		// 連続する描画をまとめる
+		std::unique_ptr<InstanceBatcher> instanceBatcher_;
+		// 前フレームの統計
+		InstanceBatcher::Stats instancingStats_;
+
+		// まとめ機能の生成
+		void CreateInstanceBatcher();
+
+		// まとめ条件の作成
+		InstanceBatchKey MakeInstanceBatchKey(const std::string& identifier, const CBufferData* cBufferData);
+
+		// モデルに使うテクスチャの名前
+		std::string GetModelTextureName(const std::string& identifier) const;
+
+		// まとめたインスタンスの描画
+		void DrawInstances(const InstanceBatchKey& key, const InstanceData* instances, uint32_t instanceCount);
+
+
+
+		/*-----------------------------------------------------------------------------------------*/
+		/// 並列記録
+
+
+
+		// このフレームの描画、EndFrameでまとめて記録する
+		std::vector<DrawCommand> drawCommands_;
+
+		// 描画の記録を分担する
+		std::unique_ptr<ParallelRecorder> recorder_;
+		// 前フレームの統計
+		ParallelRecorder::Stats recordingStats_;
+		// 前フレームで省いた同じパイプライン、バッファ、ルートパラメータの設定の数
+		uint32_t skippedBindingCount_ = 0;
+
+		// 描画の記録の準備
+		void CreateRecorder();
+
+		// 描画の追加、パイプラインと頂点バッファを設定したものを返す
+		DrawCommand& AddDrawCommand(PipelineType pipelineType, const D3D12_VERTEX_BUFFER_VIEW& vertexBufferView);
+
+		// パイプラインごとのルートパラメータの設定、使わないものはコンパイル時に消える
+		template<class PipelineClass>
+		void SetRootParameters(DrawCommand& command, const CBufferData* cBufferData, const std::string& textureName);
+		// 値で持っているCBufferから設定する、lightとcameraはなければnullptr
+		template<class PipelineClass>
+		void SetRootParameters(DrawCommand& command, const Material& material, const TransformationMatrix& matrix,
+			const DirectionalLight* light, const CameraViewData* camera, const std::string& textureName);
+
+		// 溜まった描画をコマンドリストに記録する
+		void RecordDrawCommands();
+
+		// モデル座標で半径1の物体が画面上で何ピクセルに映るか、テクスチャのミップの選択に使う
+		float CalculateScreenSize(const Matrix4x4& wvp) const;
 
 
 
@@ -173,14 +406,15 @@ namespace {
 		// モデル
 		void DrawModel(const std::string& identifier, const CBufferData* cBufferData, PipelineType pipelineType);
 
+		// モデル インスタンシング
+		void DrawModelInstanced(const std::string& identifier, const std::vector<InstanceData>& instances, const CBufferData* cBufferData);
 
-		/*-----------------------------------------------------------------------------------------*/
-		/// その他、生成を行う関数
-
+		// 生成メッシュ
+		void DrawMesh(const ProceduralMeshDesc& desc, const std::string& textureName, const CBufferData* cBufferData, PipelineType pipelineType);
 
 
-		// BufferResource生成
-		ComPtr<ID3D12Resource> CreateBufferResource(ID3D12Device* device, size_t sizeInBytes);
+		/*-----------------------------------------------------------------------------------------*/
+		/// その他、生成を行う関数
 
 
 
@@ -220,27 +454,158 @@ namespace {
 		imgui_ = ImGuiManager::Instance();
 		textureManager_ = TextureManager::Instance();
 		modelManager_ = ModelManager::Instance();
+		vertexResource_ = VertexResource::Instance();
+		bufferManager_ = BufferManager::Instance();
+		uploadManager_ = UploadManager::Instance();
 
-		// 画像の読み込み
-		textureManager_->LoadTexture("uvCheckerTexture", "./Resources/Images/uvChecker.png");
-		textureManager_->LoadTexture("whiteTexture", "./Resources/Images/whiteTexture.png");
-		textureManager_->LoadTexture("monsterBallTexture", "./Resources/Images/monsterBall.png");
-		textureManager_->LoadTexture("marioTexture", "./Resources/Images/mario.png");
-
-		// モデルの読み込み
-		/*modelManager_->LoadModel("bunny", "./Resources/Obj", "bunny.obj");
-		modelManager_->LoadModel("plane", "./Resources/Obj", "plane.obj");
-		modelManager_->LoadModel("teapot", "./Resources/Obj", "teapot.obj");
-		modelManager_->LoadModel("suzanne", "./Resources/Obj", "suzanne.obj");*/
+		// アップロードリングの生成
+		vertexResource_->Initialize(directXCommon_->GetFrameFence());
 
-		// パイプライン各種生成
+		// パイプラインの登録、シェーダーとPSOは下のジョブで用意する
 		pipeline_ = std::make_unique<Pipeline>();
-		pipeline_->CreateGraphicsPipelines();
+		pipeline_->Initialize();
+
+		// 転送中のテクスチャの代わりに使う
+		textureManager_->SetFallbackTexture("whiteTexture");
+
+		// 読み込みと生成をジョブに分けて同時に進める
+		// ファイルの読み込みやコンパイルはワーカースレッドで、リソースの作成と転送の登録はメインスレッドで行う
+		JobGraph jobs;
+
+		// 転送の登録を全て終えてからまとめて送る
+		std::vector<JobId> uploadJobs;
+
+#pragma region /// 画像 ///
+		const std::array<std::pair<std::string, std::string>, 4> textures = { {
+			{ "uvCheckerTexture", "./Resources/Images/uvChecker.png" },
+			{ "whiteTexture", "./Resources/Images/whiteTexture.png" },
+			{ "monsterBallTexture", "./Resources/Images/monsterBall.png" },
+			{ "marioTexture", "./Resources/Images/mario.png" },
+		} };
+		// UVが0〜1の範囲でしか使わないものはアトラスにまとめてよい、uvCheckerはTriangleが単位行列のuvTransformで使う
+		textureManager_->AllowAtlas("uvCheckerTexture");
+		textureManager_->AllowAtlas("marioTexture");
+		// 読み込んだデータ、作成したら転送側に渡る
+		std::vector<std::shared_ptr<DirectX::ScratchImage>> images(textures.size());
+		// 元ファイルのハッシュ、同じ内容のテクスチャは1つだけデコードして共有する
+		std::vector<std::optional<SHA256Digest>> digests(textures.size());
+
+		for (size_t i = 0; i < textures.size(); ++i) {
+
+			const std::string& identifier = textures[i].first;
+			const std::string& filePath = textures[i].second;
+
+			// 読み込みとミップマップの作成、同じ内容を他のジョブがデコードするなら省く
+			JobId decode = jobs.Add("Decode " + identifier, [this, &images, &digests, &filePath, i]() {
+
+				SHA256Digest digest{};
+				if (textureManager_->HashTextureFile(filePath, digest)) {
+					digests[i] = digest;
+				}
+				if (!digests[i] || textureManager_->ClaimContent(digest)) {
+					images[i] = std::make_shared<DirectX::ScratchImage>(textureManager_->LoadTexture(filePath, digests[i]));
+				}
+				});
+			// リソースとSRVの作成、同じ内容のものは参照を増やすだけ
+			uploadJobs.push_back(jobs.AddMainThread("Texture " + identifier, [this, &images, &digests, &identifier, i]() {
+				if (digests[i]) {
+					textureManager_->CreateTexture(identifier, *digests[i], std::move(images[i]));
+				} else {
+					textureManager_->CreateTexture(identifier, std::move(images[i]));
+				}
+				}, { decode }));
+		}
+
+		// 小さいテクスチャをアトラスにまとめる、まとめたものは元の転送を取り消してページを転送する
+		JobId atlas = jobs.AddMainThread("TextureAtlas", [this]() { textureManager_->BuildAtlas(); });
+		for (JobId upload : uploadJobs) {
+			jobs.AddDependency(atlas, upload);
+		}
+		uploadJobs.push_back(atlas);
+#pragma endregion
+
+#pragma region /// モデル ///
+		// ファイルの解析はワーカースレッドで、登録と頂点バッファの作成はメインスレッドで行う
+		// Objはリポジトリに含まれていないので、置かれているものだけ読む
+		const std::array<std::string, 4> models = { "bunny", "plane", "teapot", "suzanne" };
+		std::vector<ModelData> modelData(models.size());
+
+		for (size_t i = 0; i < models.size(); ++i) {
+
+			const std::string& identifier = models[i];
+			if (!std::filesystem::exists(std::string(kObjDirectory) + "/" + identifier + ".obj")) {
+				Log(std::format("Startup: {}.obj is not in {}, skipped\n", identifier, kObjDirectory));
+				continue;
+			}
+
+			JobId parse = jobs.Add("Parse " + identifier, [this, &modelData, &identifier, i]() {
+				modelData[i] = modelManager_->LoadObjFile(kObjDirectory, identifier + ".obj");
+				});
+			uploadJobs.push_back(jobs.AddMainThread("Model " + identifier, [this, &modelData, &identifier, i]() {
+				modelManager_->AddModel(identifier, std::move(modelData[i]));
+				CreateModel(identifier);
+				}, { parse }));
+		}
+#pragma endregion
+
+#pragma region /// パイプライン ///
+		// キャッシュになければコンパイルする、PSOは使うシェーダーが揃ってから作る
+		JobId shaders = jobs.Add("CompileShaders", [this]() { pipeline_->CompileShaders(); });
+		jobs.Add("CreatePipelines", [this]() { pipeline_->CreateAll(); }, { shaders });
+#pragma endregion
 
-		// 三角形メッシュ生成
-		CreateMeshes();
-		// モデル生成
-		//CreateModels("bunny", "plane", "teapot", "suzanne");
+#pragma region /// 描画機能 ///
+		// 三角形、三角錐の頂点の置き場
+		jobs.AddMainThread("PrimitiveBatcher", [this]() { CreatePrimitiveBatcher(); });
+		// 生成メッシュ、使うときに生成する
+		jobs.AddMainThread("MeshCache", [this]() {
+			meshFactory_ = std::make_unique<D3D12MeshFactory>();
+			meshCache_.Initialize(meshFactory_.get());
+			});
+		// インスタンシング
+		jobs.AddMainThread("InstanceBatcher", [this]() { CreateInstanceBatcher(); });
+		// 並列記録
+		jobs.AddMainThread("Recorder", [this]() { CreateRecorder(); });
+#pragma endregion
+
+		// 初期化時に読み込んだものは、最初のフレームでまとめて転送する
+		JobId flush = jobs.AddMainThread("FlushUploads", [this]() { uploadManager_->Flush(); });
+		for (JobId upload : uploadJobs) {
+			jobs.AddDependency(flush, upload);
+		}
+
+		// 呼び出し元のスレッドも含めてコア数分で実行する
+		jobs.Run((std::max)(std::thread::hardware_concurrency(), 1u));
+
+		LogStartup(jobs);
+	}
+
+	//============================================================
+	// 起動時のジョブの結果の出力
+	//============================================================
+	void EngineSystem::LogStartup(const JobGraph& jobs) {
+
+		startupStats_ = jobs.GetStats();
+		startupTimings_.clear();
+
+		// *はクリティカルパス上のジョブ、これを縮めないと起動は速くならない
+		for (JobId id = 0; id < jobs.GetJobCount(); ++id) {
+
+			const JobGraph::Timing& timing = jobs.GetTiming(id);
+			startupTimings_.push_back({ jobs.GetName(id), timing });
+
+			Log(std::format("Startup {} {:<28} start {:8.2f}ms  {:8.2f}ms  thread {}\n",
+				timing.isCritical ? '*' : ' ', jobs.GetName(id), timing.startMs, timing.durationMs, timing.threadIndex));
+		}
+
+		std::string criticalPath;
+		for (JobId id : jobs.GetCriticalPath()) {
+			criticalPath += (criticalPath.empty() ? "" : " -> ") + jobs.GetName(id);
+		}
+
+		Log(std::format("Startup: {} jobs on {} threads, {:.2f}ms (sequential {:.2f}ms, critical path {:.2f}ms)\n",
+			startupStats_.jobCount, startupStats_.threadCount, startupStats_.totalTimeMs, startupStats_.sumTimeMs, startupStats_.criticalPathMs));
+		Log(std::format("Startup critical path: {}\n", criticalPath));
 	}
 
 	//============================================================
@@ -248,9 +613,9 @@ namespace {
 	//============================================================
 	void EngineSystem::Reset() {
 
-		// 0に戻す
-		indexTriangle = 0;
-		indexTriangularPrism = 0;
+		// 統計を保持してリセット
+		primitiveStats_ = primitiveBatcher_->GetStats();
+		primitiveBatcher_->ResetStats();
 	}
 
 	//============================================================
@@ -260,6 +625,12 @@ namespace {
 
 		imgui_->Begin();
 		directXCommon_->PreDraw();
+
+		// 前フレームの描画の大きさから、テクスチャのミップを読み込む、追い出す
+		textureManager_->UpdateStreaming();
+
+		// 読み込んだテクスチャやメッシュのコピーを、描画より先に記録する
+		uploadManager_->Process();
 	}
 
 	//============================================================
@@ -267,10 +638,39 @@ namespace {
 	//============================================================
 	void EngineSystem::EndFrame() {
 
+		// まとめ途中の描画を発行する
+		primitiveBatcher_->Flush();
+		instanceBatcher_->Flush();
+
+		// 統計を保持してリセット
+		instancingStats_ = instanceBatcher_->GetStats();
+		instanceBatcher_->ResetStats();
+
+		// このフレームのパスを登録する、記録はPostDrawでバリアを挟みながら行われる
+		RenderGraph& renderGraph = directXCommon_->GetRenderGraph();
+		RenderGraphResource backBuffer = directXCommon_->GetBackBuffer();
+		RenderGraphResource depthBuffer = directXCommon_->GetDepthBuffer();
+
+		renderGraph.AddPass("Scene", [&](RenderGraphBuilder& builder) {
+			builder.Write(backBuffer, RENDERGRAPH_STATE_RENDERTARGET);
+			builder.Write(depthBuffer, RENDERGRAPH_STATE_DEPTHWRITE);
+			}, [this]() { RecordDrawCommands(); });
+
 		imgui_->End();
-		imgui_->Draw();
+		renderGraph.AddPass("ImGui", [&](RenderGraphBuilder& builder) {
+			builder.Write(backBuffer, RENDERGRAPH_STATE_RENDERTARGET);
+			}, [this]() { imgui_->Draw(); });
+
 		directXCommon_->PostDraw();
 
+		// このフレームのアップロード分は、GPUが読み終わったら回収する
+		vertexResource_->FinishFrame(directXCommon_->GetFenceValue());
+		vertexResource_->ReleaseCompletedFrames(directXCommon_->GetCompletedFenceValue());
+		geometryArena_->FinishFrame(directXCommon_->GetFenceValue());
+		geometryArena_->ReleaseCompletedFrames(directXCommon_->GetCompletedFenceValue());
+		uploadManager_->FinishFrame(directXCommon_->GetFenceValue());
+		uploadManager_->ReleaseCompletedFrames(directXCommon_->GetCompletedFenceValue());
+
 		Reset();
 	}
 
@@ -291,8 +691,24 @@ namespace {
 	//============================================================
 	void EngineSystem::Finalize() {
 
+		// GPUが使い終わってから解放する
+		directXCommon_->WaitForGpu();
+
+		recorder_->Finalize();
+		recorder_.reset();
 		pipeline_.reset();
-		triangle_.reset();
+
+		// 三角形、三角錐の頂点の置き場を返す
+		primitiveBatcher_.reset();
+		geometryArena_->Finalize();
+		geometryArena_.reset();
+		geometryAllocator_.reset();
+		models_.clear();
+		meshCache_.Finalize();
+		meshFactory_.reset();
+
+		instanceBatcher_.reset();
+		vertexResource_->Finalize();
 	}
 
 #pragma endregion
@@ -300,161 +716,285 @@ namespace {
 #pragma region // 生成 //
 
 	//============================================================
-	// BufferResourceの作成
-	//============================================================
-	ComPtr<ID3D12Resource> EngineSystem::CreateBufferResource(ID3D12Device* device, size_t sizeInBytes) {
-
-		HRESULT hr;
-
-		// 頂点リソース用のヒープの設定
-		D3D12_HEAP_PROPERTIES uploadHeapProperties{};
-		uploadHeapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
-		// 頂点リソースの設定
-		D3D12_RESOURCE_DESC vertexResourceDesc{};
-		// バッファリソース。テクスチャの場合はまた別の設定をする
-		vertexResourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-		// リソースのサイズ、今回はVector4を3頂点分
-		vertexResourceDesc.Width = sizeInBytes;
-		// バッファの場合はこれらは1にする決まり
-		vertexResourceDesc.Height = 1;
-		vertexResourceDesc.DepthOrArraySize = 1;
-		vertexResourceDesc.MipLevels = 1;
-		vertexResourceDesc.SampleDesc.Count = 1;
-		// バッファの場合はこれにする決まり
-		vertexResourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-		// 実際に頂点リソースを作る
-		ComPtr<ID3D12Resource> bufferResource = nullptr;
-		hr = device->CreateCommittedResource(
-			&uploadHeapProperties, D3D12_HEAP_FLAG_NONE, &vertexResourceDesc,
-			D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&bufferResource));
-		assert(SUCCEEDED(hr));
-
-		return bufferResource;
-	}
-
-	//============================================================
-	// メッシュの生成
+	// モデルメッシュの生成
 	//============================================================
-	std::unique_ptr<EngineSystem::MeshData> EngineSystem::CreateMesh(UINT vertexCount) {
+	std::unique_ptr<EngineSystem::ModelMeshData> EngineSystem::CreateModelMesh(const std::vector<VertexData>& vertices) {
 
-		HRESULT hr;
-		std::unique_ptr<MeshData> mesh = std::make_unique<MeshData>();
+		std::unique_ptr<ModelMeshData> model = std::make_unique<ModelMeshData>();
+		model->vertexCount = static_cast<uint32_t>(vertices.size());
 
-		if (vertexCount) {
+		if (!vertices.empty()) {
 
 			// 頂点データサイズ
-			UINT sizeVB = static_cast<UINT>(sizeof(VertexData) * vertexCount);
+			UINT sizeVB = static_cast<UINT>(sizeof(VertexData) * vertices.size());
 
 			// 頂点バッファの生成
-			mesh->vertexResource = CreateBufferResource(directXCommon_->GetDevice(), sizeVB);
+			model->vertexResource = uploadManager_->CreateBuffer(sizeVB);
 
 			// 頂点バッファビューの作成
-			mesh->vertexBufferView.BufferLocation = mesh->vertexResource->GetGPUVirtualAddress();
-			mesh->vertexBufferView.SizeInBytes = sizeVB;
-			mesh->vertexBufferView.StrideInBytes = sizeof(VertexData);
+			model->vertexBufferView.BufferLocation = model->vertexResource->GetGPUVirtualAddress();
+			model->vertexBufferView.SizeInBytes = sizeVB;
+			model->vertexBufferView.StrideInBytes = sizeof(VertexData);
 
-			// 頂点データのマッピング
-			hr = mesh->vertexResource->Map(0, nullptr, reinterpret_cast<void**>(&mesh->vertex));
-			assert(SUCCEEDED(hr));
+			// 頂点は変わらないので生成時に1度だけ転送する、元データは記録し終わるまで転送側で持つ
+			auto source = std::make_shared<const std::vector<VertexData>>(vertices);
+			model->uploadId = uploadManager_->UploadBuffer(model->vertexResource.Get(), source->data(), sizeVB, source);
 		}
 
-		return mesh;
+		return model;
 	}
 
 	//============================================================
-	// 三角錐メッシュの生成
+	// 各種モデルの生成
 	//============================================================
-	std::unique_ptr<EngineSystem::TriangularPrismData> EngineSystem::CreateTriangularPrismMesh(UINT vertexCount) {
-
-		HRESULT hr;
-		std::unique_ptr<TriangularPrismData> triangular = std::make_unique<TriangularPrismData>();
+	void EngineSystem::CreateModel(const std::string& identifier) {
 
-		if (vertexCount) {
+		// 同じ内容のモデルは頂点バッファも共有する
+		const std::string& key = modelManager_->GetContentKey(identifier);
+		if (models_.contains(key)) {
+			return;
+		}
 
-			// 頂点データサイズ
-			UINT sizeVB = static_cast<UINT>(sizeof(VertexData) * vertexCount);
+		const auto& modelData = modelManager_->GetModelData(identifier);
+		models_[key] = CreateModelMesh(modelData.vertices);
+	}
 
-			// 頂点バッファの生成
-			triangular->vertexResource = CreateBufferResource(directXCommon_->GetDevice(), sizeVB);
+	//============================================================
+	// モデルメッシュを探す
+	//============================================================
+	const EngineSystem::ModelMeshData* EngineSystem::FindModelMesh(const std::string& identifier) const {
 
-			// 頂点バッファビューの作成
-			triangular->vertexBufferView.BufferLocation = triangular->vertexResource->GetGPUVirtualAddress();
-			triangular->vertexBufferView.SizeInBytes = sizeVB;
-			triangular->vertexBufferView.StrideInBytes = sizeof(VertexData);
+		// operator[]だと知らない名前で空の要素を作ってしまう
+		auto it = models_.find(modelManager_->GetContentKey(identifier));
+		assert(it != models_.end() && "model is not loaded");
+		return it != models_.end() ? it->second.get() : nullptr;
+	}
 
-			// 頂点データのマッピング
-			hr = triangular->vertexResource->Map(0, nullptr, reinterpret_cast<void**>(&triangular->vertex));
-			assert(SUCCEEDED(hr));
-		}
+	//============================================================
+	// 頂点の置き場とまとめ機能の生成
+	//============================================================
+	void EngineSystem::CreatePrimitiveBatcher() {
+
+		// ページはGPUが読み終わってから使い回すので、フレーム数を気にせず使える
+		geometryAllocator_ = std::make_unique<BufferGeometryAllocator>();
+		geometryArena_ = std::make_unique<GeometryArena>();
+		geometryArena_->Initialize(geometryAllocator_.get(), kGeometryArenaPageSize);
+
+		// まとめた描画の発行先を設定
+		primitiveBatcher_ = std::make_unique<PrimitiveBatcher>();
+		primitiveBatcher_->SetArena(geometryArena_.get());
+		primitiveBatcher_->SetFlushFunction(
+			[this](const PrimitiveBatchKey& key, const PrimitiveBatch& batch) {
+				DrawPrimitives(key, batch);
+			});
+	}
 
-		return triangular;
+	//============================================================
+	// まとめ機能の生成
+	//============================================================
+	void EngineSystem::CreateInstanceBatcher() {
+
+		// まとめた描画の発行先を設定
+		instanceBatcher_ = std::make_unique<InstanceBatcher>();
+		instanceBatcher_->SetFlushFunction(
+			[this](const InstanceBatchKey& key, const InstanceData* instances, uint32_t instanceCount) {
+				DrawInstances(key, instances, instanceCount);
+			});
 	}
 
 	//============================================================
-	// モデルメッシュの生成
+	// 描画の記録の準備
 	//============================================================
-	std::unique_ptr<EngineSystem::ModelMeshData> EngineSystem::CreateModelMesh(UINT vertexCount) {
+	void EngineSystem::CreateRecorder() {
 
-		HRESULT hr;
-		std::unique_ptr<ModelMeshData> model = std::make_unique<ModelMeshData>();
+		// 呼び出し元のスレッドも含めてコア数分で記録する
+		uint32_t contextCount = (std::max)(std::thread::hardware_concurrency(), 1u);
 
-		if (vertexCount) {
+		recorder_ = std::make_unique<ParallelRecorder>();
+		recorder_->Initialize(contextCount);
 
-			// 頂点データサイズ
-			UINT sizeVB = static_cast<UINT>(sizeof(VertexData) * vertexCount);
+		// 記録先ごとのコマンドリスト
+		directXCommon_->CreateRecordCommandLists(recorder_->GetMaxContextCount());
+	}
 
-			// 頂点バッファの生成
-			model->vertexResource = CreateBufferResource(directXCommon_->GetDevice(), sizeVB);
+#pragma endregion
 
-			// 頂点バッファビューの作成
-			model->vertexBufferView.BufferLocation = model->vertexResource->GetGPUVirtualAddress();
-			model->vertexBufferView.SizeInBytes = sizeVB;
-			model->vertexBufferView.StrideInBytes = sizeof(VertexData);
+#pragma region // 描画 //
 
-			// 頂点データのマッピング
-			hr = model->vertexResource->Map(0, nullptr, reinterpret_cast<void**>(&model->vertex));
-			assert(SUCCEEDED(hr));
-		}
+	//============================================================
+	// 描画の追加
+	//============================================================
+	DrawCommand& EngineSystem::AddDrawCommand(PipelineType pipelineType, const D3D12_VERTEX_BUFFER_VIEW& vertexBufferView) {
 
-		return model;
+		DrawCommand& command = drawCommands_.emplace_back();
+		command.pipelineType = static_cast<uint32_t>(pipelineType);
+		command.vertexBufferAddress = vertexBufferView.BufferLocation;
+		command.vertexBufferSize = vertexBufferView.SizeInBytes;
+		command.vertexStride = vertexBufferView.StrideInBytes;
+
+		return command;
 	}
 
 	//============================================================
-	// 各種モデルの生成
+	// パイプラインごとのルートパラメータの設定
 	//============================================================
-	void EngineSystem::CreateModel(const std::string& identifier) {
+	template<class PipelineClass>
+	void EngineSystem::SetRootParameters(DrawCommand& command, const CBufferData* cBufferData, const std::string& textureName) {
 
-		const auto& modelData = modelManager_->GetModelData(identifier);
-		models_[identifier] = CreateModelMesh(static_cast<UINT>(modelData.vertices.size()));
+		// 三角形などはLight、Cameraを持たないことがある
+		const DirectionalLight* light = cBufferData->light ? cBufferData->light->light.get() : nullptr;
+		const CameraViewData* camera = cBufferData->camera ? cBufferData->camera->camera.get() : nullptr;
+
+		SetRootParameters<PipelineClass>(
+			command, *cBufferData->material->data, *cBufferData->matrix->matrix, light, camera, textureName);
 	}
 
 	//============================================================
-	// 各メッシュデータの生成
+	// 値で持っているCBufferからルートパラメータの設定
 	//============================================================
-	void EngineSystem::CreateMeshes() {
+	template<class PipelineClass>
+	void EngineSystem::SetRootParameters(DrawCommand& command,
+		[[maybe_unused]] const Material& material, [[maybe_unused]] const TransformationMatrix& matrix,
+		[[maybe_unused]] const DirectionalLight* light, [[maybe_unused]] const CameraViewData* camera,
+		[[maybe_unused]] const std::string& textureName) {
+
+		if constexpr (std::is_same_v<PipelineClass, InstancedPipeline>) {
 
-		UINT triangleVertexCount = kMaxTriangleNum * kTriangleVertexNum;
+			// インスタンシングはDrawInstancesで設定する
+			assert(false);
+		} else {
 
-		// 三角形
-		triangle_ = CreateMesh(triangleVertexCount);
+			// マテリアルCBufferの場所を設定
+			if constexpr (PipelineClass::kUseTexture) {
+
+				// アトラスにまとめたテクスチャは、uvをアトラス内の場所に変換する
+				Material atlasMaterial = material;
+				atlasMaterial.uvTransform = Multiply(material.uvTransform, textureManager_->GetAtlasTransform(textureName));
+				command.AddRootParameter(DrawRootParameterType::CONSTANTBUFFER,
+					PipelineClass::kMaterial, vertexResource_->UploadConstant(atlasMaterial));
+			} else {
+
+				command.AddRootParameter(DrawRootParameterType::CONSTANTBUFFER,
+					PipelineClass::kMaterial, vertexResource_->UploadConstant(material));
+			}
+			// wvp用のCBufferの場所を設定
+			command.AddRootParameter(DrawRootParameterType::CONSTANTBUFFER,
+				PipelineClass::kTransform, vertexResource_->UploadConstant(matrix));
+
+			if constexpr (PipelineClass::kUseTexture) {
+
+				// SRVのセット
+				command.AddRootParameter(DrawRootParameterType::DESCRIPTORTABLE,
+					PipelineClass::kTexture, textureManager_->GetGPUHandle(textureName).ptr);
+				// 画面上の大きさに合うミップを要求
+				textureManager_->RequestDetail(textureName, CalculateScreenSize(matrix.WVP));
+			}
+
+			if constexpr (PipelineClass::kUseLight) {
+
+				// Light用のCBufferの場所を設定
+				assert(light);
+				command.AddRootParameter(DrawRootParameterType::CONSTANTBUFFER,
+					PipelineClass::kLight, vertexResource_->UploadConstant(*light));
+			}
+
+			if constexpr (PipelineClass::kUseCamera) {
+
+				// Camera用のCBufferの場所を設定、三角形などは持たないことがある
+				if (camera) {
+					command.AddRootParameter(DrawRootParameterType::CONSTANTBUFFER,
+						PipelineClass::kCamera, vertexResource_->UploadConstant(*camera));
+				}
+			}
+		}
+	}
 
-		UINT triangulerPrismVertexCount = kMaxTriangularPrismNum * kTriangularPrismVertexNum;
+	//============================================================
+	// 画面上の大きさ
+	//============================================================
+	float EngineSystem::CalculateScreenSize(const Matrix4x4& wvp) const {
 
-		// 三角錐
-		triangularPrism_ = CreateTriangularPrismMesh(triangulerPrismVertexCount);
+		// 原点のクリップ座標のw、カメラの後ろなら映らない
+		float w = wvp.m[3][3];
+		if (w <= 0.0f) {
+			return 0.0f;
+		}
+
+		// モデルの各軸の長さ1が、画面上で何ピクセルになるか。一番長く映る軸に合わせる
+		float halfWidth = static_cast<float>(directXCommon_->GetClientWidth()) * 0.5f;
+		float halfHeight = static_cast<float>(directXCommon_->GetClientHeight()) * 0.5f;
+
+		float maxLength = 0.0f;
+		for (int axis = 0; axis < 3; ++axis) {
+
+			float x = wvp.m[axis][0] / w * halfWidth;
+			float y = wvp.m[axis][1] / w * halfHeight;
+			maxLength = (std::max)(maxLength, std::sqrt(x * x + y * y));
+		}
+
+		// 直径の分
+		return maxLength * 2.0f;
 	}
 
-#pragma endregion
+	//============================================================
+	// 溜まった描画の記録
+	//============================================================
+	void EngineSystem::RecordDrawCommands() {
 
-#pragma region // 描画 //
+		skippedBindingCount_ = 0;
+		if (drawCommands_.empty()) {
+			return;
+		}
+
+		uint32_t contextCount = recorder_->CalculateContextCount(drawCommands_.size());
+		// 同じ設定の省略は記録先ごとに数える
+		std::atomic<uint32_t> skippedBindingCount = 0;
+
+		// 設定を省く区間の境目で分けるので、記録先の数によらず同じコマンドになる
+		size_t blockCount = GetDrawCommandBlockCount(drawCommands_.size());
+		auto recordBlocks = [&](ICommandContext& context, size_t beginBlock, size_t endBlock) {
+			size_t begin = beginBlock * kDrawCommandBlockSize;
+			size_t end = (std::min)(endBlock * kDrawCommandBlockSize, drawCommands_.size());
+			skippedBindingCount += ::RecordDrawCommands(context, drawCommands_.data(), begin, end);
+			};
+
+		if (contextCount == 1) {
+
+			// 分けるほどないので、メインのコマンドリストにそのまま記録する
+			D3D12CommandContext context(directXCommon_->GetCommandList(), pipeline_.get());
+			recorder_->Record(blockCount, 1, [&](uint32_t, size_t beginBlock, size_t endBlock) {
+				recordBlocks(context, beginBlock, endBlock);
+				});
+		} else {
+
+			// 範囲ごとに別のコマンドリストへ同時に記録する
+			recorder_->Record(blockCount, contextCount, [&](uint32_t contextIndex, size_t beginBlock, size_t endBlock) {
+
+				// SRVヒープ、描画先は設定済みで返ってくる
+				ID3D12GraphicsCommandList* commandList = directXCommon_->BeginRecordCommandList(contextIndex);
+
+				D3D12CommandContext context(commandList, pipeline_.get());
+				recordBlocks(context, beginBlock, endBlock);
+				});
+
+			// 記録先の番号順に実行するので、描画順は1つで記録したときと変わらない
+			directXCommon_->ExecuteRecordCommandLists(contextCount);
+		}
+
+		recordingStats_ = recorder_->GetStats();
+		// 区間の数ではなく描画の数にする
+		recordingStats_.itemCount = static_cast<uint32_t>(drawCommands_.size());
+		skippedBindingCount_ = skippedBindingCount;
+		drawCommands_.clear();
+	}
 
 	//============================================================
 	// 三角形の描画
 	//============================================================
 	void EngineSystem::DrawTriangle(const std::string& identifier, const CBufferData* cBufferData, PipelineType pipelineType) {
 
-		// CommandListをdxCommonClassからもってくる
-		ComPtr<ID3D12GraphicsCommandList> commandList = directXCommon_->GetCommandList();
+		// 描画順を保つため、まとめ途中のモデルを先に描画
+		instanceBatcher_->Flush();
 
 		// 法線の計算
 		Vector3 normal =
@@ -468,43 +1008,13 @@ namespace {
 			VertexData{{1.0f,-1.0f,0.0f,1.0f},{ 1.0f,1.0f },normal}
 		};
 
-		// 三角形使用数に応じた頂点数の計算
-		size_t indexVertex = indexTriangle * kTriangleVertexNum;
-
-		assert(vertices.size() <= kTriangleVertexNum);
-
-		// 頂点バッファへデータ転送
-		std::memcpy(&triangle_->vertex[indexVertex], vertices.data(), sizeof(vertices[0]) * vertices.size());
-
-		// RootSignatureの設定
-		commandList->SetGraphicsRootSignature(pipeline_->GetPipelines()[static_cast<size_t>(pipelineType)]->rootSignature.Get());
-		// PipelineStateの設定
-		commandList->SetPipelineState(pipeline_->GetPipelines()[static_cast<size_t>(pipelineType)]->pipelineState.Get());
+		static_assert(vertices.size() == kTriangleVertexNum);
 
-		// 形状を設定。PSOに設定しているものとはまた別。同じものを設定すると考える
-		commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-		// 頂点バッファの設定
-		commandList->IASetVertexBuffers(0, 1, &triangle_->vertexBufferView);
-
-		// マテリアルCBufferの場所を設定
-		commandList->SetGraphicsRootConstantBufferView(0, cBufferData->material->resource->GetGPUVirtualAddress());
-		// wvp用のCBufferの場所を設定
-		commandList->SetGraphicsRootConstantBufferView(1, cBufferData->matrix->resource->GetGPUVirtualAddress());
-
-		if (PipelineType::TEXTURE == pipelineType || PipelineType::BLINNPHONG == pipelineType) {
-
-			// Light用のCBufferの場所を設定
-			commandList->SetGraphicsRootConstantBufferView(3, cBufferData->light->resource->GetGPUVirtualAddress());
-
-			// SRVのセット
-			textureManager_->SetGraphicsRootDescriptorTable(commandList.Get(), 2, identifier);
+		// 頂点を詰める、前と同じ条件なら置いた場所が違っても1回の描画にまとめられる
+		PrimitiveBatchKey key{};
+		if (MakePrimitiveBatchKey(identifier, cBufferData, pipelineType, vertices.data(), kTriangleVertexNum, key)) {
+			primitiveBatcher_->Add(key, vertices.data(), kTriangleVertexNum, sizeof(VertexData));
 		}
-
-		// 描画を行う(DrawCall)。3頂点で1つのインスタンス
-		commandList->DrawInstanced(kTriangleVertexNum, 1, static_cast<INT>(indexVertex), 0);
-
-		// 使用カウント上昇
-		indexTriangle++;
 	}
 
 	//============================================================
@@ -512,8 +1022,8 @@ namespace {
 	//============================================================
 	void EngineSystem::DrawTriangularPrism(const std::string& identifier, const CBufferData* cBufferData, PipelineType pipelineType) {
 
-		// CommandListをdxCommonClassからもってくる
-		ComPtr<ID3D12GraphicsCommandList> commandList = directXCommon_->GetCommandList();
+		// 描画順を保つため、まとめ途中のモデルを先に描画
+		instanceBatcher_->Flush();
 
 		// 頂点データ
 		std::array vertices = {
@@ -539,43 +1049,78 @@ namespace {
 		   VertexData{{0.0f, 0.0f, 1.0f, 1.0f}, {1.0f, 1.0f}, CalculateTriangleNormal({-0.5f, -0.2887f, 0.0f, 1.0f}, {0.5f, -0.2887f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f})}
 		};
 
-		// 三角形使用数に応じた頂点数の計算
-		size_t indexVertex = indexTriangularPrism * kTriangularPrismVertexNum;
+		static_assert(vertices.size() == kTriangularPrismVertexNum);
 
-		assert(vertices.size() <= kTriangularPrismVertexNum);
+		// 頂点を詰める、三角形とも同じ条件ならまとめられる
+		PrimitiveBatchKey key{};
+		if (MakePrimitiveBatchKey(identifier, cBufferData, pipelineType, vertices.data(), kTriangularPrismVertexNum, key)) {
+			primitiveBatcher_->Add(key, vertices.data(), kTriangularPrismVertexNum, sizeof(VertexData));
+		}
+	}
 
-		// 頂点バッファへデータ転送
-		std::memcpy(&triangularPrism_->vertex[indexVertex], vertices.data(), sizeof(vertices[0]) * vertices.size());
+	//============================================================
+	// 三角形、三角錐のまとめ条件の作成
+	//============================================================
+	bool EngineSystem::MakePrimitiveBatchKey(const std::string& identifier, const CBufferData* cBufferData,
+		PipelineType pipelineType, VertexData* vertices, uint32_t vertexCount, PrimitiveBatchKey& key) {
 
-		// RootSignatureの設定
-		commandList->SetGraphicsRootSignature(pipeline_->GetPipelines()[static_cast<size_t>(pipelineType)]->rootSignature.Get());
-		// PipelineStateの設定
-		commandList->SetPipelineState(pipeline_->GetPipelines()[static_cast<size_t>(pipelineType)]->pipelineState.Get());
+		// 物体ごとの行列は頂点に焼き込み、条件にはカメラの行列だけを残す
+		if (!PrimitiveBatcher::BakeWorld(*cBufferData->matrix->matrix, vertices, vertexCount, key.viewProjection)) {
+			return false;
+		}
 
-		// 形状を設定。PSOに設定しているものとはまた別。同じものを設定すると考える
-		commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-		// 頂点バッファの設定
-		commandList->IASetVertexBuffers(0, 1, &triangularPrism_->vertexBufferView);
+		key.pipelineType = static_cast<uint32_t>(pipelineType);
+		key.textureName = identifier;
+		key.material = *cBufferData->material->data;
 
-		// マテリアルCBufferの場所を設定
-		commandList->SetGraphicsRootConstantBufferView(0, cBufferData->material->resource->GetGPUVirtualAddress());
-		// wvp用のCBufferの場所を設定
-		commandList->SetGraphicsRootConstantBufferView(1, cBufferData->matrix->resource->GetGPUVirtualAddress());
+		// アトラスにまとめたテクスチャは、マテリアルのuvTransformとアトラス内の場所への変換を頂点に焼き込む
+		// 条件はページの名前と単位行列になり、同じページの別のテクスチャとも1回で描画できる
+		if (textureManager_->IsAtlased(identifier)) {
 
-		if (PipelineType::TEXTURE == pipelineType || PipelineType::BLINNPHONG == pipelineType) {
+			Matrix4x4 uvTransform = Multiply(key.material.uvTransform, textureManager_->GetAtlasTransform(identifier));
+			for (uint32_t i = 0; i < vertexCount; ++i) {
 
-			// Light用のCBufferの場所を設定
-			commandList->SetGraphicsRootConstantBufferView(3, cBufferData->light->resource->GetGPUVirtualAddress());
+				Vector2 texcoord = vertices[i].texcoord;
+				vertices[i].texcoord.x = texcoord.x * uvTransform.m[0][0] + texcoord.y * uvTransform.m[1][0] + uvTransform.m[3][0];
+				vertices[i].texcoord.y = texcoord.x * uvTransform.m[0][1] + texcoord.y * uvTransform.m[1][1] + uvTransform.m[3][1];
+			}
 
-			// SRVのセット
-			textureManager_->SetGraphicsRootDescriptorTable(commandList.Get(), 2, identifier);
+			key.textureName = textureManager_->GetBindingIdentifier(identifier);
+			key.material.uvTransform = MakeIdentity4x4();
 		}
 
-		// 描画を行う(DrawCall)。4頂点で1つのインスタンス
-		commandList->DrawInstanced(kTriangularPrismVertexNum, 1, static_cast<INT>(indexVertex), 0);
+		if (cBufferData->light) {
+			key.hasLight = true;
+			key.light = *cBufferData->light->light;
+		}
+		if (cBufferData->camera) {
+			key.hasCamera = true;
+			key.camera = *cBufferData->camera->camera;
+		}
+
+		return true;
+	}
 
-		// 使用カウント上昇
-		indexTriangularPrism++;
+	//============================================================
+	// まとめた三角形、三角錐の描画
+	//============================================================
+	void EngineSystem::DrawPrimitives(const PrimitiveBatchKey& key, const PrimitiveBatch& batch) {
+
+		// パイプラインと頂点バッファの設定、頂点バッファはアリーナのページ全体
+		D3D12_VERTEX_BUFFER_VIEW vertexBufferView{ batch.vertexBufferAddress, batch.vertexBufferSize, batch.vertexStride };
+		PipelineType pipelineType = static_cast<PipelineType>(key.pipelineType);
+		DrawCommand& command = AddDrawCommand(pipelineType, vertexBufferView);
+
+		// CBuffer、SRVの場所を設定、頂点はワールド座標なのでWorldは単位行列
+		TransformationMatrix matrix{ key.viewProjection, MakeIdentity4x4() };
+		DispatchPipeline(pipelineType, [&](auto pipelineClass) {
+			SetRootParameters<decltype(pipelineClass)>(command, key.material, matrix,
+				key.hasLight ? &key.light : nullptr, key.hasCamera ? &key.camera : nullptr, key.textureName);
+			});
+
+		// まとめた頂点を1回で描画
+		command.vertexCount = batch.vertexCount;
+		command.startVertex = batch.startVertex;
 	}
 
 	//============================================================
@@ -583,40 +1128,199 @@ namespace {
 	//============================================================
 	void EngineSystem::DrawModel(const std::string& identifier, const CBufferData* cBufferData, PipelineType pipelineType) {
 
-		// CommandListをdxCommonClassからもってくる
-		ComPtr<ID3D12GraphicsCommandList> commandList = directXCommon_->GetCommandList();
-
-		// 頂点バッファへデータ転送
-		std::memcpy(models_[identifier]->vertex, modelManager_->GetModelData(identifier).vertices.data(), sizeof(VertexData) * modelManager_->GetModelData(identifier).vertices.size());
-
-		// RootSignatureの設定
-		commandList->SetGraphicsRootSignature(pipeline_->GetPipelines()[static_cast<size_t>(pipelineType)]->rootSignature.Get());
-		// PipelineStateの設定
-		commandList->SetPipelineState(pipeline_->GetPipelines()[static_cast<size_t>(pipelineType)]->pipelineState.Get());
-
-		// 形状を設定。PSOに設定しているものとはまた別。同じものを設定すると考える
-		commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-		// 頂点バッファの設定
-		commandList->IASetVertexBuffers(0, 1, &models_[identifier]->vertexBufferView);
-		// マテリアルCBufferの場所を設定
-		commandList->SetGraphicsRootConstantBufferView(0, cBufferData->material->resource->GetGPUVirtualAddress());
-		// wvp用のCBufferの場所を設定
-		commandList->SetGraphicsRootConstantBufferView(1, cBufferData->matrix->resource->GetGPUVirtualAddress());
-		// Camera用のCBufferの場所を設定
-		commandList->SetGraphicsRootConstantBufferView(4, cBufferData->camera->resource->GetGPUVirtualAddress());
+		// 頂点の転送を記録し終えるまでは描画しない
+		const ModelMeshData* model = FindModelMesh(identifier);
+		if (!model || !uploadManager_->IsSubmitted(model->uploadId)) {
+			return;
+		}
 
+		// 描画順を保つため、まとめ途中の三角形などを先に描画
+		primitiveBatcher_->Flush();
 
-		// Light用のCBufferの場所を設定
-		commandList->SetGraphicsRootConstantBufferView(3, cBufferData->light->resource->GetGPUVirtualAddress());
+		// ヒープ全体をテクスチャの配列にできなければ、インスタンシングの代わりに1つずつ描画する
+		if (PipelineType::INSTANCED == pipelineType && !directXCommon_->IsBindlessSupported()) {
+			pipelineType = PipelineType::BLINNPHONG;
+		}
+
+		// インスタンシングを指定されたら、連続する同じモデルをまとめて描画する
+		if (PipelineType::INSTANCED == pipelineType) {
+
+			InstanceData instance{};
+			instance.matrix = *cBufferData->matrix->matrix;
+			instance.material = *cBufferData->material->data;
+			// テクスチャはヒープの番号で参照するので、違うテクスチャでもまとめられる
+			instance.material.textureIndex = textureManager_->GetSrvIndex(GetModelTextureName(identifier));
+			instance.material.uvTransform =
+				Multiply(instance.material.uvTransform, textureManager_->GetAtlasTransform(GetModelTextureName(identifier)));
+			textureManager_->RequestDetail(GetModelTextureName(identifier), CalculateScreenSize(instance.matrix.WVP));
+
+			instanceBatcher_->Add(MakeInstanceBatchKey(identifier, cBufferData), instance);
+			return;
+		}
+
+		// 描画順を保つため、まとめ途中のモデルを先に描画
+		instanceBatcher_->Flush();
+
+		// パイプラインと頂点バッファの設定
+		DrawCommand& command = AddDrawCommand(pipelineType, model->vertexBufferView);
+
+		// CBuffer、SRVの場所を設定
+		DispatchPipeline(pipelineType, [&](auto pipelineClass) {
+			SetRootParameters<decltype(pipelineClass)>(command, cBufferData, GetModelTextureName(identifier));
+			});
+
+		// vertexCountで1つのインスタンス
+		command.vertexCount = model->vertexCount;
+	}
+
+	//============================================================
+	// モデルのインスタンシング描画
+	//============================================================
+	void EngineSystem::DrawModelInstanced(
+		const std::string& identifier, const std::vector<InstanceData>& instances, const CBufferData* cBufferData) {
+
+		const ModelMeshData* model = FindModelMesh(identifier);
+		if (instances.empty() || !model || !uploadManager_->IsSubmitted(model->uploadId)) {
+			return;
+		}
+
+		// 描画順を保つため、まとめ途中のものを先に描画
+		primitiveBatcher_->Flush();
+		instanceBatcher_->Flush();
+
+		// ヒープ全体をテクスチャの配列にできなければ、1つずつBlinnPhongで描画する
+		if (!directXCommon_->IsBindlessSupported()) {
+
+			const DirectionalLight* light = cBufferData->light ? cBufferData->light->light.get() : nullptr;
+			const CameraViewData* camera = cBufferData->camera ? cBufferData->camera->camera.get() : nullptr;
+
+			for (const auto& instance : instances) {
+
+				DrawCommand& command = AddDrawCommand(PipelineType::BLINNPHONG, model->vertexBufferView);
+				SetRootParameters<BlinnPhongPipeline>(
+					command, instance.material, instance.matrix, light, camera, GetModelTextureName(identifier));
+				command.vertexCount = model->vertexCount;
+			}
+			return;
+		}
+
+		// テクスチャはモデルのものをヒープの番号で参照する
+		std::vector<InstanceData> texturedInstances = instances;
+		uint32_t textureIndex = textureManager_->GetSrvIndex(GetModelTextureName(identifier));
+		// アトラスにまとめたテクスチャは、uvをアトラス内の場所に変換する
+		Matrix4x4 atlasTransform = textureManager_->GetAtlasTransform(GetModelTextureName(identifier));
+		bool isAtlased = textureManager_->IsAtlased(GetModelTextureName(identifier));
+		// ミップは一番大きく映るインスタンスに合わせる
+		float screenSize = 0.0f;
+		for (auto& instance : texturedInstances) {
+
+			instance.material.textureIndex = textureIndex;
+			if (isAtlased) {
+				instance.material.uvTransform = Multiply(instance.material.uvTransform, atlasTransform);
+			}
+			screenSize = (std::max)(screenSize, CalculateScreenSize(instance.matrix.WVP));
+		}
+		textureManager_->RequestDetail(GetModelTextureName(identifier), screenSize);
+
+		DrawInstances(
+			MakeInstanceBatchKey(identifier, cBufferData), texturedInstances.data(), static_cast<uint32_t>(texturedInstances.size()));
+	}
+
+	//============================================================
+	// 生成メッシュの描画
+	//============================================================
+	void EngineSystem::DrawMesh(
+		const ProceduralMeshDesc& desc, const std::string& textureName, const CBufferData* cBufferData, PipelineType pipelineType) {
+
+		// 描画順を保つため、まとめ途中のものを先に描画
+		primitiveBatcher_->Flush();
+		instanceBatcher_->Flush();
+
+		// 初めての設定ならここで生成して転送を登録する
+		MeshId id = meshCache_.Get(desc);
+		const D3D12MeshFactory::Mesh* mesh = static_cast<const D3D12MeshFactory::Mesh*>(meshCache_.GetMesh(id));
+
+		// 転送を記録し終えるまでは描画しない
+		if (!uploadManager_->IsSubmitted(mesh->uploadId)) {
+			return;
+		}
+
+		// パイプラインと頂点、インデックスバッファの設定
+		DrawCommand& command = AddDrawCommand(pipelineType, mesh->vertexBufferView);
+		command.indexBufferAddress = mesh->indexBufferView.BufferLocation;
+		command.indexBufferSize = mesh->indexBufferView.SizeInBytes;
+
+		// CBuffer、SRVの場所を設定
+		DispatchPipeline(pipelineType, [&](auto pipelineClass) {
+			SetRootParameters<decltype(pipelineClass)>(command, cBufferData, textureName);
+			});
+
+		command.indexCount = meshCache_.GetIndexCount(id);
+	}
+
+	//============================================================
+	// まとめ条件の作成
+	//============================================================
+	InstanceBatchKey EngineSystem::MakeInstanceBatchKey(const std::string& identifier, const CBufferData* cBufferData) {
 
-		if (identifier != "suzanne") {
+		InstanceBatchKey key{};
+		key.identifier = identifier;
+		key.pipelineType = static_cast<uint32_t>(PipelineType::INSTANCED);
 
-			// SRVのセット
-			textureManager_->SetGraphicsRootDescriptorTable(commandList.Get(), 2, "uvCheckerTexture");
+		// LightとCameraは最初のインスタンスのものを共有する、インスタンシングのパイプラインは両方を使う
+		assert(cBufferData->light && cBufferData->camera && "instanced drawing needs a light and a camera");
+		if (cBufferData->light) {
+			key.light = *cBufferData->light->light;
+		}
+		if (cBufferData->camera) {
+			key.camera = *cBufferData->camera->camera;
 		}
 
-		// 描画を行う(DrawCall)。modelData.vertices.size()で1つのインスタンス
-		commandList->DrawInstanced(UINT(modelManager_->GetModelData(identifier).vertices.size()), 1, 0, 0);
+		return key;
+	}
+
+	//============================================================
+	// モデルに使うテクスチャの名前
+	//============================================================
+	std::string EngineSystem::GetModelTextureName(const std::string& identifier) const {
+
+		// suzanneはテクスチャを持たないので白を使う
+		return identifier != "suzanne" ? "uvCheckerTexture" : "whiteTexture";
+	}
+
+	//============================================================
+	// まとめたインスタンスの描画
+	//============================================================
+	void EngineSystem::DrawInstances(const InstanceBatchKey& key, const InstanceData* instances, uint32_t instanceCount) {
+
+		const ModelMeshData* model = FindModelMesh(key.identifier);
+		if (!model) {
+			return;
+		}
+
+		// インスタンスデータをアップロードリングへ転送
+		UploadAllocation instanceAllocation = vertexResource_->Allocate(sizeof(InstanceData) * instanceCount);
+		std::memcpy(instanceAllocation.cpuAddress, instances, sizeof(InstanceData) * instanceCount);
+
+		// パイプラインと頂点バッファの設定
+		DrawCommand& command = AddDrawCommand(PipelineType::INSTANCED, model->vertexBufferView);
+
+		// インスタンスデータの場所を設定
+		command.AddRootParameter(
+			DrawRootParameterType::SHADERRESOURCE, InstancedPipeline::kInstances, instanceAllocation.gpuAddress);
+		// ヒープ全体をテクスチャの配列として渡す、各インスタンスが番号で選ぶ
+		command.AddRootParameter(DrawRootParameterType::DESCRIPTORTABLE,
+			InstancedPipeline::kTextures, DescriptorHeapManager::Instance()->GetGPUHandleStart().ptr);
+		// Light用のCBufferの場所を設定
+		command.AddRootParameter(
+			DrawRootParameterType::CONSTANTBUFFER, InstancedPipeline::kLight, vertexResource_->UploadConstant(key.light));
+		// Camera用のCBufferの場所を設定
+		command.AddRootParameter(
+			DrawRootParameterType::CONSTANTBUFFER, InstancedPipeline::kCamera, vertexResource_->UploadConstant(key.camera));
+
+		// instanceCount個を1回で描画
+		command.vertexCount = model->vertexCount;
+		command.instanceCount = instanceCount;
 	}
 
 #pragma endregion
@@ -634,7 +1338,7 @@ namespace {
 //============================================================
 // 初期化
 //============================================================
-void Engine::Initialize(int width, int height) {
+void Engine::Initialize(int width, int height, uint32_t frameCount) {
 
 	// ComInitialize
 	CoInitializeEx(nullptr, COINIT_MULTITHREADED);
@@ -651,7 +1355,14 @@ void Engine::Initialize(int width, int height) {
 	swinApp->CreateMainWindow(width, height);
 
 	// DirectXの初期化
-	sdirectXCommon->Initialize(swinApp, width, height);
+	sdirectXCommon->Initialize(swinApp, width, height, frameCount);
+
+	// テクスチャとImGuiで共有するSRVヒープ
+	DescriptorHeapManager::Instance()->Initialize();
+	// 頂点、定数バッファの切り出し元
+	BufferManager::Instance()->Initialize();
+	// テクスチャ、メッシュの転送
+	UploadManager::Instance()->Initialize();
 
 	// ImGuiの初期化
 	simgui->Initialize();
@@ -687,7 +1398,10 @@ void Engine::Finalize() {
 	sEngineSystem->Finalize();
 	sEngineSystem.reset();
 	simgui->Finalize();
+	UploadManager::Instance()->Finalize();
 	sdirectXCommon->Finalize(swinApp);
+	DescriptorHeapManager::Instance()->Finalize();
+	BufferManager::Instance()->Finalize();
 
 	// ComFinalize
 	CoUninitialize();
@@ -712,4 +1426,107 @@ void Engine::DrawTriangularPrism(const std::string& identifier, const CBufferDat
 void Engine::DrawModel(const std::string& identifier, const CBufferData* cBufferData, PipelineType pipelineType) {
 
 	sEngineSystem->DrawModel(identifier, cBufferData, pipelineType);
-}
\ No newline at end of file
+}
+
+// モデル インスタンシング
+void Engine::DrawModelInstanced(const std::string& identifier, const std::vector<InstanceData>& instances, const CBufferData* cBufferData) {
+
+	sEngineSystem->DrawModelInstanced(identifier, instances, cBufferData);
+}
+
+// 生成メッシュ
+void Engine::DrawMesh(const ProceduralMeshDesc& desc, const std::string& textureName, const CBufferData* cBufferData, PipelineType pipelineType) {
+
+	sEngineSystem->DrawMesh(desc, textureName, cBufferData, pipelineType);
+}
+
+//============================================================
+// インスタンシングの統計
+//============================================================
+const InstanceBatcher::Stats& Engine::GetInstancingStats() { return sEngineSystem->instancingStats_; }
+
+//============================================================
+// 三角形、三角錐のまとめの統計
+//============================================================
+const PrimitiveBatcher::Stats& Engine::GetPrimitiveStats() { return sEngineSystem->primitiveStats_; }
+
+//============================================================
+// 三角形、三角錐の頂点の置き場の統計
+//============================================================
+const GeometryArena::Stats& Engine::GetGeometryArenaStats() { return sEngineSystem->geometryArena_->GetStats(); }
+
+//============================================================
+// 生成メッシュの統計
+//============================================================
+const MeshCache::Stats& Engine::GetMeshCacheStats() { return sEngineSystem->meshCache_.GetStats(); }
+
+//============================================================
+// 描画の記録の統計
+//============================================================
+const ParallelRecorder::Stats& Engine::GetRecordingStats() { return sEngineSystem->recordingStats_; }
+
+//============================================================
+// SRVヒープの設定回数
+//============================================================
+uint32_t Engine::GetDescriptorHeapSetCount() { return sdirectXCommon->GetDescriptorHeapSetCount(); }
+
+//============================================================
+// バッファの切り出しの統計
+//============================================================
+BufferManager::Stats Engine::GetBufferStats() { return BufferManager::Instance()->GetStats(); }
+
+//============================================================
+// 転送の統計
+//============================================================
+UploadQueue::Stats Engine::GetUploadStats() { return UploadManager::Instance()->GetStats(); }
+
+//============================================================
+// パイプラインの統計
+//============================================================
+PipelineCache::Stats Engine::GetPipelineStats() { return sEngineSystem->pipeline_->GetStats(); }
+
+//============================================================
+// シェーダーキャッシュの統計
+//============================================================
+ShaderCache::Stats Engine::GetShaderCacheStats() { return sEngineSystem->pipeline_->GetShaderStats(); }
+
+//============================================================
+// RenderGraphの統計
+//============================================================
+const RenderGraph::Stats& Engine::GetRenderGraphStats() { return sdirectXCommon->GetRenderGraphStats(); }
+
+//============================================================
+// テクスチャのストリーミングの統計
+//============================================================
+const TextureStreamer::Stats& Engine::GetTextureStreamingStats() { return stexture->GetStreamingStats(); }
+
+//============================================================
+// テクスチャのアトラスの統計
+//============================================================
+const TextureAtlas::Stats& Engine::GetTextureAtlasStats() { return stexture->GetAtlasStats(); }
+
+//============================================================
+// 省いた同じ設定の数
+//============================================================
+uint32_t Engine::GetSkippedBindingCount() { return sEngineSystem->skippedBindingCount_; }
+
+//============================================================
+// 内容でまとめたテクスチャ、モデルの統計
+//============================================================
+ContentStore::Stats Engine::GetTextureContentStats() { return stexture->GetContentStats(); }
+ContentStore::Stats Engine::GetModelContentStats() { return sEngineSystem->modelManager_->GetContentStats(); }
+
+//============================================================
+// テクスチャの予算の設定
+//============================================================
+void Engine::SetTextureBudget(uint64_t budgetSize) { stexture->SetStreamingBudget(budgetSize); }
+
+//============================================================
+// 起動時の統計
+//============================================================
+const JobGraph::Stats& Engine::GetStartupStats() { return sEngineSystem->startupStats_; }
+
+//============================================================
+// 起動時のジョブごとの時間
+//============================================================
+const std::vector<Engine::StartupTiming>& Engine::GetStartupTimings() { return sEngineSystem->startupTimings_; }
\ No newline at end of file
@@ -8,6 +8,18 @@
 #include <cassert>
 
 #include "Pipeline.h"
+#include "InstanceBatcher.h"
+#include "PrimitiveBatcher.h"
+#include "GeometryArena.h"
+#include "MeshCache.h"
+#include "ParallelRecorder.h"
+#include "BufferManager.h"
+#include "UploadQueue.h"
+#include "RenderGraph.h"
+#include "JobGraph.h"
+#include "TextureStreamer.h"
+#include "TextureAtlas.h"
+#include "ContentStore.h"
 #include "Function.h"
 #include "Matrix4x4.h"
 #include "ComPtr.h"
@@ -22,7 +34,8 @@ public:
 	//====================
 
 	// 各システムの初期化
-	static void Initialize(int width, int height);
+	// frameCountはGPUに同時に投げておけるフレーム数、増やすと遅延が増える代わりにCPUとGPUが並走しやすい
+	static void Initialize(int width, int height, uint32_t frameCount = 2);
 
 	// フレーム開始処理
 	static void BeginFrame();
@@ -45,9 +58,84 @@ public:
 	// 三角錐
 	static void DrawTriangularPrism(const std::string& identifier, const CBufferData* cBufferData, PipelineType pipelineType);
 
-	// モデル
+	// モデル、INSTANCEDを指定すると連続する同じモデルを1回のDrawCallにまとめる
 	static void DrawModel(const std::string& identifier, const CBufferData* cBufferData, PipelineType pipelineType);
 
+	// モデル インスタンシング、instancesを1回のDrawCallで描画する
+	// Light、CameraはcBufferDataのものを使う。リソースバインディングTier2がなければ1つずつ描画する
+	static void DrawModelInstanced(const std::string& identifier, const std::vector<InstanceData>& instances, const CBufferData* cBufferData);
+
+	// 生成メッシュ 球、箱など。同じ分割数のメッシュは1つを使い回し、desc.lodで粗いものを選べる
+	static void DrawMesh(const ProceduralMeshDesc& desc, const std::string& textureName, const CBufferData* cBufferData, PipelineType pipelineType);
+
+	/*-----------------------------------------------------------------------------------------*/
+	/// 統計
+
+	// 起動時のジョブ1つの時間
+	struct StartupTiming {
+
+		std::string name;
+		JobGraph::Timing timing;
+	};
+
+	// 起動時の読み込みの統計 全体の時間とクリティカルパスの時間
+	static const JobGraph::Stats& GetStartupStats();
+
+	// 起動時のジョブごとの時間 登録順、isCriticalがクリティカルパス上のもの
+	static const std::vector<StartupTiming>& GetStartupTimings();
+
+	// インスタンシングの統計 前フレーム分
+	static const InstanceBatcher::Stats& GetInstancingStats();
+
+	// 三角形、三角錐のまとめの統計 前フレーム分、1回の描画あたりのプリミティブ数
+	static const PrimitiveBatcher::Stats& GetPrimitiveStats();
+
+	// 三角形、三角錐の頂点の置き場の統計 現在の値、1フレームの最大使用量とページを大きくした回数
+	static const GeometryArena::Stats& GetGeometryArenaStats();
+
+	// 生成メッシュの統計 現在の値、生成済みのメッシュ数と使い回した回数
+	static const MeshCache::Stats& GetMeshCacheStats();
+
+	// 描画の記録の統計 前フレーム分
+	static const ParallelRecorder::Stats& GetRecordingStats();
+
+	// SetDescriptorHeapsの回数 前フレーム分、コマンドリストの数と一致していればヒープの切り替えはない
+	static uint32_t GetDescriptorHeapSetCount();
+
+	// バッファの切り出しの統計 現在の値、使用率と断片化率
+	static BufferManager::Stats GetBufferStats();
+
+	// テクスチャ、メッシュの転送の統計 前フレーム分と記録待ち
+	static UploadQueue::Stats GetUploadStats();
+
+	// パイプラインの統計 現在の値、登録数と生成済みの数
+	static PipelineCache::Stats GetPipelineStats();
+
+	// シェーダーキャッシュの統計 現在の値、起動時のキャッシュの当たり数とコンパイル時間
+	static ShaderCache::Stats GetShaderCacheStats();
+
+	// パスとバリアの統計 前フレーム分、バリアの数とResourceBarrierの呼び出し回数
+	static const RenderGraph::Stats& GetRenderGraphStats();
+
+	// テクスチャのストリーミングの統計 現在の値、GPUに置いている大きさと読み込み、追い出しの回数
+	static const TextureStreamer::Stats& GetTextureStreamingStats();
+
+	// 小さいテクスチャのアトラスの統計 起動時にまとめた結果、詰めた割合と減ったSRVの数
+	static const TextureAtlas::Stats& GetTextureAtlasStats();
+
+	// 省いた設定の数 前フレーム分、直前の描画と同じパイプライン、バッファ、ルートパラメータは設定しない
+	static uint32_t GetSkippedBindingCount();
+
+	// 元ファイルの内容でまとめた統計、同じ内容のテクスチャ、モデルは1つの資源を共有する
+	static ContentStore::Stats GetTextureContentStats();
+	static ContentStore::Stats GetModelContentStats();
+
+	/*-----------------------------------------------------------------------------------------*/
+	/// 設定
+
+	// GPUに置くテクスチャの大きさの上限、超えた分は使われていないテクスチャのミップから追い出す
+	static void SetTextureBudget(uint64_t budgetSize);
+
 private:
 	//====================
 	// private
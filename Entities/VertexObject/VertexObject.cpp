@@ -1,8 +1,11 @@
 #include "VertexObject.h"
 
-#include "DirectXCommon.h"
+#include "BufferManager.h"
+#include "ProceduralMesh.h"
 #include "Function.h"
 
+#include <cstring>
+
 // lib /* .hに書いてはいけない */
 #pragma comment(lib,"d3d12.lib")
 #pragma comment(lib,"dxgi.lib")
@@ -22,63 +25,34 @@ VertexObject& VertexObject::Instance() {
 	return instance;
 }
 
-//============================================================
-// BufferResourceの作成
-//============================================================
-ComPtr<ID3D12Resource> VertexObject::CreateBufferResource(ID3D12Device* device, size_t sizeInBytes) {
-
-	HRESULT hr;
-
-	// 頂点リソース用のヒープの設定
-	D3D12_HEAP_PROPERTIES uploadHeapProperties{};
-	uploadHeapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
-	// 頂点リソースの設定
-	D3D12_RESOURCE_DESC vertexResourceDesc{};
-	// バッファリソース。テクスチャの場合はまた別の設定をする
-	vertexResourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-	// リソースのサイズ、今回はVector4を3頂点分
-	vertexResourceDesc.Width = sizeInBytes;
-	// バッファの場合はこれらは1にする決まり
-	vertexResourceDesc.Height = 1;
-	vertexResourceDesc.DepthOrArraySize = 1;
-	vertexResourceDesc.MipLevels = 1;
-	vertexResourceDesc.SampleDesc.Count = 1;
-	// バッファの場合はこれにする決まり
-	vertexResourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-	// 実際に頂点リソースを作る
-	ComPtr<ID3D12Resource> bufferResource = nullptr;
-	hr = device->CreateCommittedResource(
-		&uploadHeapProperties, D3D12_HEAP_FLAG_NONE, &vertexResourceDesc,
-		D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&bufferResource));
-	assert(SUCCEEDED(hr));
-
-	return bufferResource;
-}
-
 //============================================================
 // TriangleVertexResourceの生成
 //============================================================
 void VertexObject::CreateTriangleVertexResource(Matrix4x4 wvpMatrix) {
 
-	DirectXCommon* directXCommon = nullptr;
-	directXCommon = DirectXCommon::Instance();
+	BufferManager* bufferManager = BufferManager::Instance();
 
 	///////////////////////////////////////////////////////////
 	// BufferResourceの作成
 	///////////////////////////////////////////////////////////
 
-	vertexResource_ = CreateBufferResource(directXCommon->GetDevice(), sizeof(VertexData) * 6);
-	materialResource_ = CreateBufferResource(directXCommon->GetDevice(), sizeof(Material));
+	// 作り直すときは前のバッファを返す
+	bufferManager->Free(vertexBuffer_);
+	bufferManager->Free(materialBuffer_);
+	bufferManager->Free(wvpBuffer_);
+
+	vertexBuffer_ = bufferManager->Allocate(sizeof(VertexData) * 6);
+	materialBuffer_ = bufferManager->Allocate(sizeof(Material));
 
 	// WVP用のリソースを作る、Matrix4x4 1つ分のサイズを用意する
-	wvpResource_ = CreateBufferResource(directXCommon->GetDevice(), sizeof(TransformationMatrix));
+	wvpBuffer_ = bufferManager->Allocate(sizeof(TransformationMatrix));
 
 	///////////////////////////////////////////////////////////
 	// VertexBufferViewの生成
 	///////////////////////////////////////////////////////////
 
 	// リソースの先頭アドレスから使う
-	vertexBufferView_.BufferLocation = vertexResource_->GetGPUVirtualAddress();
+	vertexBufferView_.BufferLocation = vertexBuffer_.gpuAddress;
 	// 使用するリソースのサイズは頂点6つ分のサイズ
 	vertexBufferView_.SizeInBytes = sizeof(VertexData) * 6;
 	// 1頂点あたりのサイズ
@@ -91,7 +65,7 @@ void VertexObject::CreateTriangleVertexResource(Matrix4x4 wvpMatrix) {
 	// 頂点リソースにデータを書き込む
 	VertexData* vertexData = nullptr;
 	// 書き込むためのアドレスを取得
-	vertexResource_->Map(0, nullptr, reinterpret_cast<void**>(&vertexData));
+	vertexData = vertexBuffer_.GetData<VertexData>();
 
 	// 左下1
 	vertexData[0].pos = { -0.5f,-0.5f,0.0f,1.0f };
@@ -116,7 +90,7 @@ void VertexObject::CreateTriangleVertexResource(Matrix4x4 wvpMatrix) {
 	// マテリアルにデータを書き込む
 	Material* materialData = nullptr;
 	// 書き込むためのアドレスを取得
-	materialResource_->Map(0, nullptr, reinterpret_cast<void**>(&materialData));
+	materialData = materialBuffer_.GetData<Material>();
 	// 書き込むためのアドレスを取得
 	materialData->color = { 1.0f,1.0f,1.0f,1.0f };
 	// Lightingを無効にする
@@ -128,7 +102,7 @@ void VertexObject::CreateTriangleVertexResource(Matrix4x4 wvpMatrix) {
 	// wvpにデータを書き込む
 	TransformationMatrix* matrix = nullptr;
 	// 書き込むためのアドレスを取得
-	wvpResource_->Map(0, nullptr, reinterpret_cast<void**>(&matrix));
+	matrix = wvpBuffer_.GetData<TransformationMatrix>();
 	// wvp行列を書き込んでおく
 	matrix->WVP = wvpMatrix;
 }
@@ -138,30 +112,35 @@ void VertexObject::CreateTriangleVertexResource(Matrix4x4 wvpMatrix) {
 //============================================================
 void VertexObject::CreateSpriteVertexResource(Matrix4x4 wvpMatrix) {
 
-	DirectXCommon* directXCommon = nullptr;
-	directXCommon = DirectXCommon::Instance();
+	BufferManager* bufferManager = BufferManager::Instance();
 
 	///////////////////////////////////////////////////////////
 	// BufferResourceの作成
 	///////////////////////////////////////////////////////////
 
+	// 作り直すときは前のバッファを返す
+	bufferManager->Free(vertexBufferSprite_);
+	bufferManager->Free(transformationMatrixBufferSprite_);
+	bufferManager->Free(materialBufferSprite_);
+	bufferManager->Free(indexBufferSprite_);
+
 	// Sprite用の頂点リソースを作る
-	vertexResourceSprite_ = CreateBufferResource(directXCommon->GetDevice(), sizeof(VertexData) * 4);
+	vertexBufferSprite_ = bufferManager->Allocate(sizeof(VertexData) * 4);
 	// Sprite用のTransformationMatrix用のリソースを作る、Matrix4x4 1つ分のサイズを用意する
-	transformationMatrixResourceSprite_ = CreateBufferResource(directXCommon->GetDevice(), sizeof(TransformationMatrix));
+	transformationMatrixBufferSprite_ = bufferManager->Allocate(sizeof(TransformationMatrix));
 
 	// マテリアル用
-	materialResourceSprite_ = CreateBufferResource(directXCommon->GetDevice(), sizeof(Material));
+	materialBufferSprite_ = bufferManager->Allocate(sizeof(Material));
 
 	// index
-	indexResourceSprite_ = CreateBufferResource(directXCommon->GetDevice(), sizeof(uint32_t) * 6);
+	indexBufferSprite_ = bufferManager->Allocate(sizeof(uint32_t) * 6);
 
 	///////////////////////////////////////////////////////////
 	// VertexBufferViewの生成
 	///////////////////////////////////////////////////////////
 
 	// リソースの先頭アドレスから使う
-	vertexBufferViewSprite_.BufferLocation = vertexResourceSprite_->GetGPUVirtualAddress();
+	vertexBufferViewSprite_.BufferLocation = vertexBufferSprite_.gpuAddress;
 	// 使用するリソースのサイズは頂点6つ分のサイズ
 	vertexBufferViewSprite_.SizeInBytes = sizeof(VertexData) * 4;
 	// 1頂点あたりのサイズ
@@ -169,7 +148,7 @@ void VertexObject::CreateSpriteVertexResource(Matrix4x4 wvpMatrix) {
 
 	// index
 	// リソースの先頭アドレスから使う
-	indexBufferViewSprite_.BufferLocation = indexResourceSprite_->GetGPUVirtualAddress();
+	indexBufferViewSprite_.BufferLocation = indexBufferSprite_.gpuAddress;
 	// 使用するリソースのサイズはインデックス6つ分のサイズ
 	indexBufferViewSprite_.SizeInBytes = sizeof(uint32_t) * 6;
 	// インデックスはuint32_tにする
@@ -180,7 +159,7 @@ void VertexObject::CreateSpriteVertexResource(Matrix4x4 wvpMatrix) {
 	///////////////////////////////////////////////////////////
 
 	VertexData* vertexDataSprite = nullptr;
-	vertexResourceSprite_->Map(0, nullptr, reinterpret_cast<void**>(&vertexDataSprite));
+	vertexDataSprite = vertexBufferSprite_.GetData<VertexData>();
 
 	// 1=3、2=5、頂点4つで描画
 	// 左下
@@ -203,7 +182,7 @@ void VertexObject::CreateSpriteVertexResource(Matrix4x4 wvpMatrix) {
 	// データを書き込む
 	TransformationMatrix* matrix = nullptr;
 	// 書き込むためのアドレスを取得
-	transformationMatrixResourceSprite_->Map(0, nullptr, reinterpret_cast<void**>(&matrix));
+	matrix = transformationMatrixBufferSprite_.GetData<TransformationMatrix>();
 	// wvp行列を書き込んでおく
 	matrix->WVP = wvpMatrix;
 
@@ -228,7 +207,7 @@ void VertexObject::CreateSpriteVertexResource(Matrix4x4 wvpMatrix) {
 	// マテリアルにデータを書き込む
 	Material* materialData = nullptr;
 	// 書き込むためのアドレスを取得
-	materialResourceSprite_->Map(0, nullptr, reinterpret_cast<void**>(&materialData));
+	materialData = materialBufferSprite_.GetData<Material>();
 
 	// 色
 	materialData->color = { 1.0f,1.0f,1.0f,1.0f };
@@ -240,7 +219,7 @@ void VertexObject::CreateSpriteVertexResource(Matrix4x4 wvpMatrix) {
 	// インデックスリソースにデータを書き込む
 	uint32_t* indexDataSprite = nullptr;
 	// 書き込むためのアドレスを取得
-	indexResourceSprite_->Map(0, nullptr, reinterpret_cast<void**>(&indexDataSprite));
+	indexDataSprite = indexBufferSprite_.GetData<uint32_t>();
 
 	indexDataSprite[0] = 0;
 	indexDataSprite[1] = 1;
@@ -255,165 +234,65 @@ void VertexObject::CreateSpriteVertexResource(Matrix4x4 wvpMatrix) {
 //============================================================
 void VertexObject::CreateSphereVertexResource(Matrix4x4 wvpMatrix, Matrix4x4 worldMatrix) {
 
-	DirectXCommon* directXCommon = nullptr;
-	directXCommon = DirectXCommon::Instance();
+	BufferManager* bufferManager = BufferManager::Instance();
 
 	///////////////////////////////////////////////////////////
 	// BufferResourceの作成
 	///////////////////////////////////////////////////////////
 
-	// Sphere用のリソースを作る
-	vertexResourceSphere_ = CreateBufferResource(directXCommon->GetDevice(), sizeof(VertexData) * 1024);
-
-	// WVP用のリソースを作る、Matrix4x4 1つ分のサイズを用意する
-	wvpResourceSphere_ = CreateBufferResource(directXCommon->GetDevice(), sizeof(TransformationMatrix));
-
-	// マテリアル用
-	materialResourceSphere_ = CreateBufferResource(directXCommon->GetDevice(), sizeof(Material));
-
-	// index
-	indexResourceSphere_ = CreateBufferResource(directXCommon->GetDevice(), sizeof(uint32_t) * 1536);
-
-	///////////////////////////////////////////////////////////
-	// VertexBufferViewの生成
-	///////////////////////////////////////////////////////////
-
-	// リソースの先頭アドレスから使う
-	vertexBufferViewSphere_.BufferLocation = vertexResourceSphere_->GetGPUVirtualAddress();
-	// 使用するリソースのサイズは頂点6つ分のサイズ
-	vertexBufferViewSphere_.SizeInBytes = sizeof(VertexData) * 1024;
-	// 1頂点あたりのサイズ
-	vertexBufferViewSphere_.StrideInBytes = sizeof(VertexData);
-
-	// index
-	// リソースの先頭アドレスから使う
-	indexBufferViewSphere_.BufferLocation = indexResourceSphere_->GetGPUVirtualAddress();
-	// 使用するリソースのサイズはインデックス1536分のサイズ
-	indexBufferViewSphere_.SizeInBytes = sizeof(uint32_t) * 1536;
-	// インデックスはuint32_tにする
-	indexBufferViewSphere_.Format = DXGI_FORMAT_R32_UINT;
-
-	///////////////////////////////////////////////////////////
-	// Resourceにデータを書き込む
-	///////////////////////////////////////////////////////////
+	// 形状は変わらないので、頂点とインデックスは最初の1回だけ作る
+	if (!vertexBufferSphere_.IsValid()) {
 
-	VertexData* vertexDataSphere = nullptr;
-	vertexResourceSphere_->Map(0, nullptr, reinterpret_cast<void**>(&vertexDataSphere));
+		// 分割数
+		const uint32_t kSubdivision = 16;
 
-	// 分割数
-	const uint32_t kSubdivision = 16;
+		// 隣のマスと頂点を共有するインデックス付きの球
+		ProceduralMeshData sphere = ProceduralMesh::CreateUVSphere(kSubdivision, kSubdivision);
 
-	// 経度分割1つ分の角度
-	const float kLonEvery = GetPI() * 2.0f / float(kSubdivision);
+		UINT sizeVB = static_cast<UINT>(sizeof(VertexData) * sphere.vertices.size());
+		UINT sizeIB = static_cast<UINT>(sizeof(uint32_t) * sphere.indices.size());
 
-	// 緯度分割1つ分の角度
-	const float kLatEvery = GetPI() / float(kSubdivision);
+		// Sphere用のリソースを作る、生成した数だけ確保する
+		vertexBufferSphere_ = bufferManager->Allocate(sizeVB);
+		indexBufferSphere_ = bufferManager->Allocate(sizeIB);
 
-	// 緯度方向に分割
-	for (uint32_t latIndex = 0; latIndex < kSubdivision; latIndex++) {
+		///////////////////////////////////////////////////////////
+		// VertexBufferViewの生成
+		///////////////////////////////////////////////////////////
 
-		float lat = -GetPI() / 2.0f + kLatEvery * latIndex;
+		// リソースの先頭アドレスから使う
+		vertexBufferViewSphere_.BufferLocation = vertexBufferSphere_.gpuAddress;
+		// 使用するリソースのサイズは生成した頂点分のサイズ
+		vertexBufferViewSphere_.SizeInBytes = sizeVB;
+		// 1頂点あたりのサイズ
+		vertexBufferViewSphere_.StrideInBytes = sizeof(VertexData);
 
-		// 経度の方向に分割
-		for (uint32_t lonIndex = 0; lonIndex < kSubdivision; lonIndex++) {
+		// index
+		// リソースの先頭アドレスから使う
+		indexBufferViewSphere_.BufferLocation = indexBufferSphere_.gpuAddress;
+		// 使用するリソースのサイズは生成したインデックス分のサイズ
+		indexBufferViewSphere_.SizeInBytes = sizeIB;
+		// インデックスはuint32_tにする
+		indexBufferViewSphere_.Format = DXGI_FORMAT_R32_UINT;
 
-			uint32_t start = (latIndex * kSubdivision + lonIndex) * 4;
-			float lon = lonIndex * kLonEvery;
+		///////////////////////////////////////////////////////////
+		// Resourceにデータを書き込む
+		///////////////////////////////////////////////////////////
 
-			float u0 = static_cast<float>(lonIndex) / kSubdivision;
-			float u1 = static_cast<float>(lonIndex + 1) / kSubdivision;
-			float v0 = 1.0f - static_cast<float>(latIndex) / kSubdivision;
-			float v1 = 1.0f - static_cast<float>(latIndex + 1) / kSubdivision;
+		std::memcpy(vertexBufferSphere_.cpuAddress, sphere.vertices.data(), sizeVB);
+		std::memcpy(indexBufferSphere_.cpuAddress, sphere.indices.data(), sizeIB);
 
-			/*=========================================================================================*/
-			// 各頂点の値を書き込む
-			// 基準点 a
-			vertexDataSphere[start].pos.x =
-				std::cos(lat) * std::cos(lon);
+		// WVP用のリソースを作る、Matrix4x4 1つ分のサイズを用意する
+		wvpBufferSphere_ = bufferManager->Allocate(sizeof(TransformationMatrix));
 
-			vertexDataSphere[start].pos.y =
-				std::sin(lat);
-
-			vertexDataSphere[start].pos.z =
-				std::cos(lat) * std::sin(lon);
-
-			vertexDataSphere[start].pos.w = 1.0f;
-
-			vertexDataSphere[start].texcoord = { u0, v0 };
-
-			vertexDataSphere[start].normal.x = vertexDataSphere[start].pos.x;
-			vertexDataSphere[start].normal.y = vertexDataSphere[start].pos.y;
-			vertexDataSphere[start].normal.z = vertexDataSphere[start].pos.z;
-
-			/*=========================================================================================*/
-			// 基準点 b
-			vertexDataSphere[start + 1].pos.x =
-				std::cos(lat + kLatEvery) * std::cos(lon);
-
-			vertexDataSphere[start + 1].pos.y =
-				std::sin(lat + kLatEvery);
-
-			vertexDataSphere[start + 1].pos.z =
-				std::cos(lat + kLatEvery) * std::sin(lon);
-
-			vertexDataSphere[start + 1].pos.w = 1.0f;
-
-			vertexDataSphere[start + 1].texcoord = { u0, v1 };
-
-			vertexDataSphere[start + 1].normal.x = vertexDataSphere[start + 1].pos.x;
-			vertexDataSphere[start + 1].normal.y = vertexDataSphere[start + 1].pos.y;
-			vertexDataSphere[start + 1].normal.z = vertexDataSphere[start + 1].pos.z;
-
-			/*=========================================================================================*/
-			// 基準点 c
-			vertexDataSphere[start + 2].pos.x =
-				std::cos(lat) * std::cos(lon + kLonEvery);
-
-			vertexDataSphere[start + 2].pos.y =
-				std::sin(lat);
-
-			vertexDataSphere[start + 2].pos.z =
-				std::cos(lat) * std::sin(lon + kLonEvery);
-
-			vertexDataSphere[start + 2].pos.w = 1.0f;
-
-			vertexDataSphere[start + 2].texcoord = { u1, v0 };
-
-			vertexDataSphere[start + 2].normal.x = vertexDataSphere[start + 2].pos.x;
-			vertexDataSphere[start + 2].normal.y = vertexDataSphere[start + 2].pos.y;
-			vertexDataSphere[start + 2].normal.z = vertexDataSphere[start + 2].pos.z;
-
-			/*=========================================================================================*/
-			// 基準点 d
-			vertexDataSphere[start + 3].pos.x =
-				std::cos(lat + kLatEvery) * std::cos(lon + kLonEvery);
-
-			vertexDataSphere[start + 3].pos.y =
-				std::sin(lat + kLatEvery);
-
-			vertexDataSphere[start + 3].pos.z =
-				std::cos(lat + kLatEvery) * std::sin(lon + kLonEvery);
-
-			vertexDataSphere[start + 3].pos.w = 1.0f;
-
-			vertexDataSphere[start + 3].texcoord = { u1, v1 };
-
-			vertexDataSphere[start + 3].normal.x = vertexDataSphere[start + 3].pos.x;
-			vertexDataSphere[start + 3].normal.y = vertexDataSphere[start + 3].pos.y;
-			vertexDataSphere[start + 3].normal.z = vertexDataSphere[start + 3].pos.z;
-		}
+		// マテリアル用
+		materialBufferSphere_ = bufferManager->Allocate(sizeof(Material));
 	}
 
-	/*=========================================================================================================
-	*
-	*							↑　本来ここもクラス化して座標を入れるべき ↑
-	*
-	==========================================================================================================*/
-
 	// wvpにデータを書き込む
 	TransformationMatrix* matrix = nullptr;
 	// 書き込むためのアドレスを取得
-	wvpResourceSphere_->Map(0, nullptr, reinterpret_cast<void**>(&matrix));
+	matrix = wvpBufferSphere_.GetData<TransformationMatrix>();
 	// wvp,world行列を書き込んでおく
 	matrix->WVP = wvpMatrix;
 	matrix->World = worldMatrix;
@@ -421,7 +300,7 @@ void VertexObject::CreateSphereVertexResource(Matrix4x4 wvpMatrix, Matrix4x4 wor
 	// マテリアルにデータを書き込む
 	Material* materialData = nullptr;
 	// 書き込むためのアドレスを取得
-	materialResourceSphere_->Map(0, nullptr, reinterpret_cast<void**>(&materialData));
+	materialData = materialBufferSphere_.GetData<Material>();
 	// 書き込むためのアドレスを取得
 	materialData->color = Vector4{ 1.0f,1.0f,1.0f,1.0f };
 	// Lightingを有効にする
@@ -429,25 +308,6 @@ void VertexObject::CreateSphereVertexResource(Matrix4x4 wvpMatrix, Matrix4x4 wor
 
 	// 単位行列で初期化
 	materialData->uvTransform = MakeIdentity4x4();
-
-	// インデックスリソースにデータを書き込む
-	uint32_t* indexDataSphere = nullptr;
-	// 書き込むためのアドレスを取得
-	indexResourceSphere_->Map(0, nullptr, reinterpret_cast<void**>(&indexDataSphere));
-
-	// Indexの計算
-	for (uint32_t latIndex = 0; latIndex <= kSubdivision; latIndex++) {
-		for (uint32_t lonIndex = 0; lonIndex <= kSubdivision; lonIndex++) {
-			uint32_t baseIndex = (latIndex * (kSubdivision)+lonIndex) * 4;
-
-			indexDataSphere[6 * (latIndex * kSubdivision + lonIndex)] = baseIndex;         // 0
-			indexDataSphere[6 * (latIndex * kSubdivision + lonIndex) + 1] = baseIndex + 1; // 1
-			indexDataSphere[6 * (latIndex * kSubdivision + lonIndex) + 2] = baseIndex + 2; // 2
-			indexDataSphere[6 * (latIndex * kSubdivision + lonIndex) + 3] = baseIndex + 2; // 3
-			indexDataSphere[6 * (latIndex * kSubdivision + lonIndex) + 4] = baseIndex + 1; // 4
-			indexDataSphere[6 * (latIndex * kSubdivision + lonIndex) + 5] = baseIndex + 3; // 5
-		}
-	}
 }
 
 //============================================================
@@ -455,22 +315,24 @@ void VertexObject::CreateSphereVertexResource(Matrix4x4 wvpMatrix, Matrix4x4 wor
 //============================================================
 void VertexObject::CreateLightResource(Vector3 lightDirection) {
 
-	DirectXCommon* directXCommon = nullptr;
-	directXCommon = DirectXCommon::Instance();
+	BufferManager* bufferManager = BufferManager::Instance();
 
 	///////////////////////////////////////////////////////////
 	// BufferResourceの作成
 	///////////////////////////////////////////////////////////
 
+	// 作り直すときは前のバッファを返す
+	bufferManager->Free(lightBuffer_);
+
 	// Light用のリソースを作る
-	lightResource_ = CreateBufferResource(directXCommon->GetDevice(), sizeof(DirectionalLight));
+	lightBuffer_ = bufferManager->Allocate(sizeof(DirectionalLight));
 
 	///////////////////////////////////////////////////////////
 	// VertexBufferViewの生成
 	///////////////////////////////////////////////////////////
 
 	// リソースの先頭アドレスから使う
-	lightBufferView_.BufferLocation = lightResource_->GetGPUVirtualAddress();
+	lightBufferView_.BufferLocation = lightBuffer_.gpuAddress;
 	// 使用するリソースのサイズは頂点
 	lightBufferView_.SizeInBytes = sizeof(DirectionalLight);
 	// 1頂点あたりのサイズ
@@ -483,7 +345,7 @@ void VertexObject::CreateLightResource(Vector3 lightDirection) {
 	// directionalLightにデータを書き込む
 	DirectionalLight* directionalLight = nullptr;
 	// 書き込むためのアドレスを取得
-	lightResource_->Map(0, nullptr, reinterpret_cast<void**>(&directionalLight));
+	directionalLight = lightBuffer_.GetData<DirectionalLight>();
 
 	// 必要な値を書き込む
 	directionalLight->color = { 1.0f,1.0f,1.0f,1.0f };
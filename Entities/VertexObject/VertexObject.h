@@ -16,6 +16,7 @@
 #include "Function.h"
 
 #include "ComPtr.h"
+#include "BufferManager.h"
 
 //================================================
 // VertexObject class
@@ -26,10 +27,9 @@ public:
 	// public
 	//====================
 
-	ComPtr<ID3D12Resource> CreateBufferResource(ID3D12Device* device, size_t sizeInBytes);
-
 	void CreateTriangleVertexResource(Matrix4x4 wvpMatrix);
 	void CreateSpriteVertexResource(Matrix4x4 wvpMatrix);
+	// 頂点とインデックスは最初の1回だけ作り、以降は行列とマテリアルだけ書き換える
 	void CreateSphereVertexResource(Matrix4x4 wvpMatrix,Matrix4x4 worldMatrix);
 	void CreateLightResource(Vector3 lightDirection);
 	static VertexObject& Instance();
@@ -40,30 +40,30 @@ public:
 	// Triangle
 	D3D12_VERTEX_BUFFER_VIEW& GetVertexBufferView() { return vertexBufferView_; }
 
-	ID3D12Resource* GetMaterialResource()const { return materialResource_.Get(); }
-	ID3D12Resource* GetWvpResource()const { return wvpResource_.Get(); }
+	D3D12_GPU_VIRTUAL_ADDRESS GetMaterialAddress()const { return materialBuffer_.gpuAddress; }
+	D3D12_GPU_VIRTUAL_ADDRESS GetWvpAddress()const { return wvpBuffer_.gpuAddress; }
 
 	/*=========================================================================*/
 	// Sprite
 	D3D12_VERTEX_BUFFER_VIEW& GetVertexBufferViewSprite() { return vertexBufferViewSprite_; }
 	D3D12_INDEX_BUFFER_VIEW& GetIndexBufferViewSprite() { return indexBufferViewSprite_; }
 
-	ID3D12Resource* GetMaterialResourceSprite()const { return materialResourceSprite_.Get(); }
-	ID3D12Resource* GetTransformationMatrixResourceSprite()const { return transformationMatrixResourceSprite_.Get(); }
+	D3D12_GPU_VIRTUAL_ADDRESS GetMaterialAddressSprite()const { return materialBufferSprite_.gpuAddress; }
+	D3D12_GPU_VIRTUAL_ADDRESS GetTransformationMatrixAddressSprite()const { return transformationMatrixBufferSprite_.gpuAddress; }
 
 	/*=========================================================================*/
 	// Sphere
 	D3D12_VERTEX_BUFFER_VIEW& GetVertexBufferViewSphere() { return vertexBufferViewSphere_; }
 	D3D12_INDEX_BUFFER_VIEW& GetIndexBufferViewSphere() { return indexBufferViewSphere_; }
 
-	ID3D12Resource* GetMaterialResourceSphere()const { return materialResourceSphere_.Get(); }
-	ID3D12Resource* GetWvpResourceSphere()const { return wvpResourceSphere_.Get(); }
+	D3D12_GPU_VIRTUAL_ADDRESS GetMaterialAddressSphere()const { return materialBufferSphere_.gpuAddress; }
+	D3D12_GPU_VIRTUAL_ADDRESS GetWvpAddressSphere()const { return wvpBufferSphere_.gpuAddress; }
 
 	/*=========================================================================*/
 	// Ligth
 	D3D12_VERTEX_BUFFER_VIEW& GetLightBufferView() { return lightBufferView_; }
 
-	ID3D12Resource* GetLightResource()const { return lightResource_.Get(); }
+	D3D12_GPU_VIRTUAL_ADDRESS GetLightAddress()const { return lightBuffer_.gpuAddress; }
 
 private:
 	//====================
@@ -84,32 +84,32 @@ private:
 	/*=========================================================================*/
 	// Triangle
 	D3D12_VERTEX_BUFFER_VIEW vertexBufferView_{};
-	ComPtr<ID3D12Resource> vertexResource_;
-	ComPtr<ID3D12Resource> materialResource_;
-	ComPtr<ID3D12Resource> wvpResource_;
+	BufferAllocation vertexBuffer_;
+	BufferAllocation materialBuffer_;
+	BufferAllocation wvpBuffer_;
 
 	/*=========================================================================*/
 	// Sprite
 	D3D12_INDEX_BUFFER_VIEW indexBufferViewSprite_{};
-	ComPtr<ID3D12Resource> indexResourceSprite_;
+	BufferAllocation indexBufferSprite_;
 
 	D3D12_VERTEX_BUFFER_VIEW vertexBufferViewSprite_{};
-	ComPtr<ID3D12Resource> vertexResourceSprite_;
-	ComPtr<ID3D12Resource> materialResourceSprite_;
-	ComPtr<ID3D12Resource> transformationMatrixResourceSprite_;
+	BufferAllocation vertexBufferSprite_;
+	BufferAllocation materialBufferSprite_;
+	BufferAllocation transformationMatrixBufferSprite_;
 
 	/*=========================================================================*/
 	// Sphere
 	D3D12_INDEX_BUFFER_VIEW indexBufferViewSphere_{};
-	ComPtr<ID3D12Resource> indexResourceSphere_;
+	BufferAllocation indexBufferSphere_;
 
 	D3D12_VERTEX_BUFFER_VIEW vertexBufferViewSphere_{};
-	ComPtr<ID3D12Resource> vertexResourceSphere_;
-	ComPtr<ID3D12Resource> materialResourceSphere_;
-	ComPtr<ID3D12Resource> wvpResourceSphere_;
+	BufferAllocation vertexBufferSphere_;
+	BufferAllocation materialBufferSphere_;
+	BufferAllocation wvpBufferSphere_;
 
 	/*=========================================================================*/
 	// Light
 	D3D12_VERTEX_BUFFER_VIEW lightBufferView_;
-	ComPtr<ID3D12Resource> lightResource_;
+	BufferAllocation lightBuffer_;
 };
\ No newline at end of file
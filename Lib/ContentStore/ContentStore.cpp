@@ -0,0 +1,153 @@
+#include "ContentStore.h"
+
+#include <cassert>
+
+//============================================================
+// 初期化
+//============================================================
+void ContentStore::Initialize(const std::string& keyPrefix) {
+
+	keyPrefix_ = keyPrefix;
+
+	Clear();
+}
+
+//============================================================
+// 名前を内容に結び付ける
+//============================================================
+ContentId ContentStore::Acquire(const std::string& identifier, const SHA256Digest& digest, bool* isNew) {
+
+	if (isNew) {
+		*isNew = false;
+	}
+
+	// 同じ名前で同じ内容を読み直しても参照は増やさない
+	auto bound = identifiers_.find(identifier);
+	if (bound != identifiers_.end()) {
+
+		assert(contents_[bound->second].digest == digest && "Release the identifier before binding it to other content");
+		return bound->second;
+	}
+
+	ContentId id = FindDigest(digest);
+	if (id == kInvalidId) {
+
+		if (freeIds_.empty()) {
+
+			id = static_cast<ContentId>(contents_.size());
+			contents_.emplace_back();
+		} else {
+
+			id = freeIds_.back();
+			freeIds_.pop_back();
+		}
+
+		Content& content = contents_[id];
+		content.digest = digest;
+		content.key = keyPrefix_ + SHA256Hasher::ToHex(digest);
+		content.referenceCount = 0;
+		content.size = 0;
+		digests_.emplace(digest, id);
+
+		if (isNew) {
+			*isNew = true;
+		}
+	}
+
+	++contents_[id].referenceCount;
+	identifiers_.emplace(identifier, id);
+
+	return id;
+}
+
+//============================================================
+// 名前を外す
+//============================================================
+ContentId ContentStore::Release(const std::string& identifier) {
+
+	auto bound = identifiers_.find(identifier);
+	if (bound == identifiers_.end()) {
+		return kInvalidId;
+	}
+
+	ContentId id = bound->second;
+	identifiers_.erase(bound);
+
+	Content& content = contents_[id];
+	assert(content.referenceCount != 0);
+	if (--content.referenceCount != 0) {
+		return kInvalidId;
+	}
+
+	// 最後の参照、キーは呼び出し側が破棄に使うので番号を使い回すまで残す
+	digests_.erase(content.digest);
+	freeIds_.push_back(id);
+
+	return id;
+}
+
+//============================================================
+// 名前から内容
+//============================================================
+ContentId ContentStore::Find(const std::string& identifier) const {
+
+	auto it = identifiers_.find(identifier);
+	return it != identifiers_.end() ? it->second : kInvalidId;
+}
+
+ContentId ContentStore::FindDigest(const SHA256Digest& digest) const {
+
+	auto it = digests_.find(digest);
+	return it != digests_.end() ? it->second : kInvalidId;
+}
+
+//============================================================
+// 資源のキー
+//============================================================
+const std::string& ContentStore::Resolve(const std::string& identifier) const {
+
+	auto it = identifiers_.find(identifier);
+	return it != identifiers_.end() ? contents_[it->second].key : identifier;
+}
+
+//============================================================
+// 実体の大きさ
+//============================================================
+void ContentStore::SetSize(ContentId id, uint64_t size) {
+
+	assert(contents_[id].referenceCount != 0);
+	contents_[id].size = size;
+}
+
+//============================================================
+// 全て外す
+//============================================================
+void ContentStore::Clear() {
+
+	contents_.clear();
+	freeIds_.clear();
+	identifiers_.clear();
+	digests_.clear();
+}
+
+//============================================================
+// 統計
+//============================================================
+ContentStore::Stats ContentStore::GetStats() const {
+
+	Stats stats{};
+	stats.identifierCount = static_cast<uint32_t>(identifiers_.size());
+
+	for (const Content& content : contents_) {
+
+		if (content.referenceCount == 0) {
+			continue;
+		}
+
+		++stats.contentCount;
+		stats.sharedCount += content.referenceCount - 1;
+		stats.storedSize += content.size;
+		stats.savedSize += content.size * (content.referenceCount - 1);
+	}
+	return stats;
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "SHA256Hasher.h"
+
+// 内容の番号、破棄した番号は使い回す
+using ContentId = uint32_t;
+
+//================================================
+// ContentStore Class
+//================================================
+/// 元データのSHA-256で資源をまとめる、別の名前や同じ内容の別のファイルは同じ資源を指す
+/// 名前ごとに参照を数え、最後の名前が外れたら呼び出し側が資源を破棄する
+/// 資源は内容ごとのキーで持つ。GPUを触らないので、テクスチャとモデルのどちらにも使う
+/// スレッドセーフではない、メインスレッドから呼ぶ
+class ContentStore {
+public:
+	//====================
+	// public
+	//====================
+
+	// 無効な番号
+	static constexpr ContentId kInvalidId = ~0u;
+
+	// 統計
+	struct Stats {
+
+		uint32_t identifierCount = 0; // 結び付いている名前の数
+		uint32_t contentCount = 0;    // 内容の数、資源の実体の数
+		uint32_t sharedCount = 0;     // 他の名前と資源を共有している名前の数
+		uint64_t storedSize = 0;      // 実体の大きさの合計
+		uint64_t savedSize = 0;       // 共有せずに読み込んでいたら増えていた大きさ
+	};
+
+	// keyPrefixは資源のキーの先頭、他の名前と重ならないものにする
+	void Initialize(const std::string& keyPrefix);
+
+	// identifierをdigestの内容に結び付けて参照を増やす、isNewはこの内容を初めて参照したか
+	// 既に同じ内容に結び付いていれば何もしない、別の内容に結び付いていれば先にReleaseする
+	ContentId Acquire(const std::string& identifier, const SHA256Digest& digest, bool* isNew = nullptr);
+	// identifierを外して参照を減らす、最後の参照だった内容の番号を返す。それ以外はkInvalidId
+	// 番号は次のAcquireで使い回すので、返ってきたらすぐに資源を破棄する
+	ContentId Release(const std::string& identifier);
+
+	// 名前が結び付いている内容、なければkInvalidId
+	ContentId Find(const std::string& identifier) const;
+	// 内容から番号、読み込み前に同じ内容があるか調べる
+	ContentId FindDigest(const SHA256Digest& digest) const;
+
+	// 資源のキー、結び付いていない名前はそのまま返す
+	const std::string& Resolve(const std::string& identifier) const;
+
+	// 実体の大きさ、資源を作った側が設定する
+	void SetSize(ContentId id, uint64_t size);
+
+	// 全て外す
+	void Clear();
+
+	// getter
+
+	const std::string& GetKey(ContentId id) const { return contents_[id].key; }
+	const SHA256Digest& GetDigest(ContentId id) const { return contents_[id].digest; }
+	uint32_t GetReferenceCount(ContentId id) const { return contents_[id].referenceCount; }
+	Stats GetStats() const;
+
+private:
+	//====================
+	// private
+	//====================
+
+	// 内容1つ分
+	struct Content {
+
+		SHA256Digest digest{};
+		std::string key;
+		uint32_t referenceCount = 0;
+		uint64_t size = 0;
+	};
+
+	std::string keyPrefix_;
+
+	std::vector<Content> contents_;
+	// 空いている番号
+	std::vector<ContentId> freeIds_;
+
+	// 名前から内容
+	std::unordered_map<std::string, ContentId> identifiers_;
+	// 内容から番号
+	std::unordered_map<SHA256Digest, ContentId, SHA256DigestHash> digests_;
+};
\ No newline at end of file
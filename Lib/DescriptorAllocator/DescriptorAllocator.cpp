@@ -0,0 +1,122 @@
+#include "DescriptorAllocator.h"
+
+#include <algorithm>
+#include <iterator>
+#include <cassert>
+
+//============================================================
+// 初期化
+//============================================================
+void DescriptorAllocator::Initialize(uint32_t capacity) {
+
+	assert(capacity > 0);
+
+	capacity_ = capacity;
+	usedCount_ = 0;
+
+	freeBlocks_.clear();
+	freeBlocks_[0] = capacity_;
+
+	stats_ = {};
+}
+
+//============================================================
+// 確保
+//============================================================
+uint32_t DescriptorAllocator::Allocate(uint32_t count) {
+
+	assert(count > 0);
+
+	// 先頭に近い空きから使う、番号が小さい方に詰まりやすくなる
+	for (auto it = freeBlocks_.begin(); it != freeBlocks_.end(); ++it) {
+
+		if (it->second < count) {
+			continue;
+		}
+
+		uint32_t index = it->first;
+		uint32_t remain = it->second - count;
+
+		// 使った分だけ空き区間を後ろにずらす
+		freeBlocks_.erase(it);
+		if (remain > 0) {
+
+			freeBlocks_.emplace(index + count, remain);
+		}
+
+		usedCount_ += count;
+
+		// 統計の更新
+		stats_.allocations++;
+		stats_.peakUsedCount = (std::max)(stats_.peakUsedCount, usedCount_);
+
+		return index;
+	}
+
+	stats_.failedCount++;
+	return kInvalidIndex;
+}
+
+//============================================================
+// 返却
+//============================================================
+void DescriptorAllocator::Free(uint32_t index, uint32_t count) {
+
+	assert(count > 0 && index + count <= capacity_);
+
+	uint32_t begin = index;
+	uint32_t end = index + count;
+
+	// 後ろの空き区間とつなげる
+	auto next = freeBlocks_.lower_bound(begin);
+	if (next != freeBlocks_.end()) {
+
+		// 二重返却
+		assert(next->first >= end);
+
+		if (next->first == end) {
+
+			end += next->second;
+			next = freeBlocks_.erase(next);
+		}
+	}
+
+	// 前の空き区間とつなげる
+	if (next != freeBlocks_.begin()) {
+
+		auto prev = std::prev(next);
+
+		// 二重返却
+		assert(prev->first + prev->second <= begin);
+
+		if (prev->first + prev->second == begin) {
+
+			begin = prev->first;
+			freeBlocks_.erase(prev);
+		}
+	}
+
+	freeBlocks_.emplace(begin, end - begin);
+
+	assert(usedCount_ >= count);
+	usedCount_ -= count;
+	stats_.frees++;
+}
+
+//============================================================
+// 統計の取得
+//============================================================
+DescriptorAllocator::Stats DescriptorAllocator::GetStats() const {
+
+	Stats stats = stats_;
+	stats.capacity = capacity_;
+	stats.usedCount = usedCount_;
+	stats.freeBlockCount = static_cast<uint32_t>(freeBlocks_.size());
+
+	for (const auto& [index, count] : freeBlocks_) {
+
+		stats.largestFreeBlock = (std::max)(stats.largestFreeBlock, count);
+	}
+
+	return stats;
+}
\ No newline at end of file
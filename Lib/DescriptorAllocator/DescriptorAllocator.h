@@ -0,0 +1,63 @@
+#pragma once
+
+#include <map>
+#include <cstdint>
+
+//================================================
+// DescriptorAllocator Class
+//================================================
+/// ディスクリプタヒープの番号を貸し出すフリーリスト
+/// 空き区間を先頭番号順に持ち、返却時に隣の空きとつなげる。ヒープには触らない
+class DescriptorAllocator {
+public:
+	//====================
+	// public
+	//====================
+
+	// 確保失敗
+	static constexpr uint32_t kInvalidIndex = ~0u;
+
+	// 統計
+	struct Stats {
+
+		uint32_t capacity = 0;         // 全体の数
+		uint32_t usedCount = 0;        // 使用中の数
+		uint32_t peakUsedCount = 0;    // 最大使用数
+		uint32_t allocations = 0;      // 確保回数
+		uint32_t frees = 0;            // 返却回数
+		uint32_t failedCount = 0;      // 確保に失敗した回数
+		uint32_t freeBlockCount = 0;   // 空き区間の数、多いほど断片化している
+		uint32_t largestFreeBlock = 0; // 連続して確保できる最大数
+	};
+
+	DescriptorAllocator() = default;
+	~DescriptorAllocator() = default;
+
+	// 初期化、[0, capacity)を全て空きにする
+	void Initialize(uint32_t capacity);
+
+	// count個連続した番号の確保、失敗したらkInvalidIndex
+	uint32_t Allocate(uint32_t count = 1);
+
+	// 返却
+	void Free(uint32_t index, uint32_t count = 1);
+
+	// getter
+
+	uint32_t GetCapacity() const { return capacity_; }
+	uint32_t GetUsedCount() const { return usedCount_; }
+	Stats GetStats() const;
+
+private:
+	//====================
+	// private
+	//====================
+
+	uint32_t capacity_ = 0;
+	uint32_t usedCount_ = 0;
+
+	// 空き区間 先頭番号 → 数
+	std::map<uint32_t, uint32_t> freeBlocks_;
+
+	Stats stats_;
+};
\ No newline at end of file
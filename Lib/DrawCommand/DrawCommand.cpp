@@ -0,0 +1,129 @@
+#include "DrawCommand.h"
+
+#include <cassert>
+
+//============================================================
+// ルートパラメータの追加
+//============================================================
+void DrawCommand::AddRootParameter(DrawRootParameterType type, uint32_t rootIndex, uint64_t value) {
+
+	assert(rootParameterCount < kMaxRootParameterNum);
+
+	rootParameters[rootParameterCount++] = { type, rootIndex, value };
+}
+
+//============================================================
+// DrawCommandの記録
+//============================================================
+uint32_t RecordDrawCommands(ICommandContext& context, const DrawCommand* commands, size_t begin, size_t end) {
+
+	// ルートパラメータの番号の最大、超えるものは毎回設定する
+	static const uint32_t kMaxRootIndex = 16;
+
+	// 範囲の途中から始めると、1つで記録したときに省いた設定が抜ける
+	assert(begin % kDrawCommandBlockSize == 0 || begin == end);
+
+	// 設定済みのもの、区間の最初は何も設定されていないものとする
+	// 頂点、インデックスバッファはパイプラインを変えても残る
+	bool hasPipeline = false;
+	uint32_t pipelineType = 0;
+	bool hasVertexBuffer = false;
+	uint64_t vertexBufferAddress = 0;
+	uint32_t vertexBufferSize = 0;
+	uint32_t vertexStride = 0;
+	bool hasIndexBuffer = false;
+	uint64_t indexBufferAddress = 0;
+	uint32_t indexBufferSize = 0;
+	std::array<bool, kMaxRootIndex> rootSet{};
+	std::array<DrawRootParameter, kMaxRootIndex> rootParameters{};
+
+	uint32_t skippedCount = 0;
+
+	for (size_t i = begin; i < end; ++i) {
+
+		const DrawCommand& command = commands[i];
+
+		// 区間の最初は全て設定し直す、区切り方によらず同じ記録になる
+		if (i % kDrawCommandBlockSize == 0) {
+			hasPipeline = false;
+			hasVertexBuffer = false;
+			hasIndexBuffer = false;
+		}
+
+		// RootSignatureとPipelineStateの設定、変えたらルートパラメータは設定し直す
+		if (hasPipeline && pipelineType == command.pipelineType) {
+			++skippedCount;
+		} else {
+			context.SetPipeline(command.pipelineType);
+			hasPipeline = true;
+			pipelineType = command.pipelineType;
+			rootSet.fill(false);
+		}
+
+		// 頂点バッファの設定
+		if (hasVertexBuffer && vertexBufferAddress == command.vertexBufferAddress &&
+			vertexBufferSize == command.vertexBufferSize && vertexStride == command.vertexStride) {
+			++skippedCount;
+		} else {
+			context.SetVertexBuffer(command.vertexBufferAddress, command.vertexBufferSize, command.vertexStride);
+			hasVertexBuffer = true;
+			vertexBufferAddress = command.vertexBufferAddress;
+			vertexBufferSize = command.vertexBufferSize;
+			vertexStride = command.vertexStride;
+		}
+
+		// インデックスバッファの設定
+		if (command.indexCount != 0) {
+
+			if (hasIndexBuffer && indexBufferAddress == command.indexBufferAddress && indexBufferSize == command.indexBufferSize) {
+				++skippedCount;
+			} else {
+				context.SetIndexBuffer(command.indexBufferAddress, command.indexBufferSize);
+				hasIndexBuffer = true;
+				indexBufferAddress = command.indexBufferAddress;
+				indexBufferSize = command.indexBufferSize;
+			}
+		}
+
+		for (uint32_t j = 0; j < command.rootParameterCount; ++j) {
+
+			const DrawRootParameter& parameter = command.rootParameters[j];
+
+			// 同じ番号に同じものが設定済み
+			if (parameter.rootIndex < kMaxRootIndex) {
+
+				const DrawRootParameter& current = rootParameters[parameter.rootIndex];
+				if (rootSet[parameter.rootIndex] && current.type == parameter.type && current.value == parameter.value) {
+					++skippedCount;
+					continue;
+				}
+				rootSet[parameter.rootIndex] = true;
+				rootParameters[parameter.rootIndex] = parameter;
+			}
+
+			switch (parameter.type) {
+			case DrawRootParameterType::CONSTANTBUFFER:
+
+				context.SetRootConstantBuffer(parameter.rootIndex, parameter.value);
+				break;
+			case DrawRootParameterType::SHADERRESOURCE:
+
+				context.SetRootShaderResource(parameter.rootIndex, parameter.value);
+				break;
+			case DrawRootParameterType::DESCRIPTORTABLE:
+
+				context.SetRootDescriptorTable(parameter.rootIndex, parameter.value);
+				break;
+			}
+		}
+
+		// 描画を行う(DrawCall)
+		if (command.indexCount != 0) {
+			context.DrawIndexed(command.indexCount, command.instanceCount, command.startIndex, command.startVertex);
+		} else {
+			context.Draw(command.vertexCount, command.instanceCount, command.startVertex);
+		}
+	}
+
+	return skippedCount;
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// ルートパラメータの種類
+enum class DrawRootParameterType : uint32_t {
+
+	CONSTANTBUFFER,  // ルートCBV
+	SHADERRESOURCE,  // ルートSRV
+	DESCRIPTORTABLE, // ディスクリプタテーブル
+};
+
+// ルートパラメータ1つ分
+struct DrawRootParameter {
+
+	DrawRootParameterType type;
+	uint32_t rootIndex;
+	// GPU仮想アドレス、またはGPUディスクリプタハンドル
+	uint64_t value;
+};
+
+// 描画1回分、記録に必要なものを全て値で持つ
+// 前の描画の状態に頼らないので、kDrawCommandBlockSizeの境目ならどこで区切って記録しても同じ結果になる
+struct DrawCommand {
+
+	// ルートパラメータの最大数
+	static const uint32_t kMaxRootParameterNum = 5;
+
+	uint32_t pipelineType = 0;
+
+	// 頂点バッファ
+	uint64_t vertexBufferAddress = 0;
+	uint32_t vertexBufferSize = 0;
+	uint32_t vertexStride = 0;
+
+	// インデックスバッファ、indexCountが0ならインデックスなしで描画する
+	uint64_t indexBufferAddress = 0;
+	uint32_t indexBufferSize = 0;
+
+	std::array<DrawRootParameter, kMaxRootParameterNum> rootParameters{};
+	uint32_t rootParameterCount = 0;
+
+	uint32_t vertexCount = 0;
+	uint32_t instanceCount = 1;
+	uint32_t startVertex = 0;
+
+	// インデックス付きの描画、startVertexはインデックスに足す値になる
+	uint32_t indexCount = 0;
+	uint32_t startIndex = 0;
+
+	// ルートパラメータの追加
+	void AddRootParameter(DrawRootParameterType type, uint32_t rootIndex, uint64_t value);
+};
+
+//================================================
+// ICommandContext Class
+//================================================
+/// DrawCommandの記録先
+/// D3D12ではコマンドリスト、デバイスがない環境では記録内容を残すだけのものに差し替えられる
+class ICommandContext {
+public:
+	//====================
+	// public
+	//====================
+
+	// 仮想デストラクタ
+	virtual ~ICommandContext() {}
+
+	virtual void SetPipeline(uint32_t pipelineType) = 0;
+	virtual void SetVertexBuffer(uint64_t address, uint32_t sizeInBytes, uint32_t strideInBytes) = 0;
+	// インデックスはuint32_t
+	virtual void SetIndexBuffer(uint64_t address, uint32_t sizeInBytes) = 0;
+	virtual void SetRootConstantBuffer(uint32_t rootIndex, uint64_t address) = 0;
+	virtual void SetRootShaderResource(uint32_t rootIndex, uint64_t address) = 0;
+	virtual void SetRootDescriptorTable(uint32_t rootIndex, uint64_t gpuHandle) = 0;
+	virtual void Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex) = 0;
+	virtual void DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, uint32_t baseVertex) = 0;
+};
+
+// 設定を省く区間の描画の数、区間の最初では全て設定し直す
+inline constexpr size_t kDrawCommandBlockSize = 64;
+
+// 区間の数、記録先に分けるときは区間単位で分ける
+inline size_t GetDrawCommandBlockCount(size_t commandCount) {
+	return (commandCount + kDrawCommandBlockSize - 1) / kDrawCommandBlockSize;
+}
+
+// commandsの[begin, end)をcontextに記録する、beginは区間の最初
+// 区間内で直前と同じパイプライン、バッファ、ルートパラメータの設定は省き、省いた数を返す
+// 省くかどうかは区間の中だけで決まるので、区間の境目で区切れば、つなげた結果は1つで記録したものと同じになる
+uint32_t RecordDrawCommands(ICommandContext& context, const DrawCommand* commands, size_t begin, size_t end);
\ No newline at end of file
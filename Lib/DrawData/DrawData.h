@@ -0,0 +1,121 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+#include "Vector.h"
+#include "Matrix4x4.h"
+
+/// 描画に渡すデータの構造体、d3d12に依存しないのでデバイスなしのコードからも使える
+
+// Transform構造体
+struct Transform {
+
+	Vector3 scale;
+	Vector3 rotate;
+	Vector3 translate;
+};
+
+// 頂点データ構造体
+struct VertexData {
+
+	Vector4 pos;
+	Vector2 texcoord;
+	Vector3 normal;
+};
+
+// Material構造体
+struct Material {
+
+	Vector4 color;
+	int32_t enableLighting;
+	// 共有SRVヒープ内のテクスチャの番号、インスタンシング描画で使う
+	uint32_t textureIndex;
+	float padding[2];
+	Matrix4x4 uvTransform;
+};
+
+// Matrix構造体
+struct TransformationMatrix {
+
+	Matrix4x4 WVP;
+	Matrix4x4 World;
+};
+
+// インスタンシング用データ構造体
+// StructuredBufferに詰めるので16バイト境界に合わせておく
+struct InstanceData {
+
+	TransformationMatrix matrix;
+	Material material;
+};
+
+// ライト構造体
+struct DirectionalLight {
+
+	Vector4 color;     // ライトの色
+	Vector3 direction; // ライトの向き
+	float intensity;   // 輝度
+};
+
+// マテリアルデータ構造体
+struct MaterialData {
+
+	std::string textureFilePath;
+};
+
+// モデルデータ構造体
+struct ModelData {
+
+	std::vector<VertexData> vertices;
+	MaterialData material;
+};
+
+// カメラビューデータ構造体
+struct CameraViewData {
+
+	Vector3 pos;
+	float padding;
+};
+
+/// CBデータはCPU側で保持し、描画時にフレームごとのアップロードリングへ転送する
+/// GPUが前のフレームを読んでいる間に書き換えても問題ない
+
+// CBマテリアルデータ
+struct CBMaterialData {
+
+	// マテリアル
+	std::unique_ptr<Material> data;
+};
+
+// CBトランスフォームデータ
+struct CBTransformData {
+
+	// 行列
+	std::unique_ptr<TransformationMatrix> matrix;
+};
+
+// CBライトデータ
+struct CBLightData {
+
+	// Light
+	std::unique_ptr<DirectionalLight> light;
+};
+
+// CBカメラビューデータ
+struct CBCameraViewData {
+
+	// Camera
+	std::unique_ptr<CameraViewData> camera;
+};
+
+// CBデータ
+struct CBufferData {
+
+	std::unique_ptr<CBMaterialData> material;
+	std::unique_ptr<CBTransformData> matrix;
+	std::unique_ptr<CBLightData> light;
+	std::unique_ptr<CBCameraViewData> camera;
+};
\ No newline at end of file
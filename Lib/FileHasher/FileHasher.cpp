@@ -0,0 +1,270 @@
+#include "FileHasher.h"
+
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <cstring>
+#include <algorithm>
+
+#include "JobGraph.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+	//============================================================
+	// 読み取り専用でメモリにマップしたファイル
+	//============================================================
+	class MappedFile {
+	public:
+
+		MappedFile(const std::filesystem::path& path) {
+
+#if defined(_WIN32)
+			file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file_ == INVALID_HANDLE_VALUE) {
+				return;
+			}
+			LARGE_INTEGER size{};
+			if (!GetFileSizeEx(file_, &size)) {
+				return;
+			}
+			size_ = static_cast<size_t>(size.QuadPart);
+			isOpen_ = true;
+
+			// 空のファイルはマップできない
+			if (size_ == 0) {
+				return;
+			}
+			mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping_ != nullptr) {
+				data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+			}
+			isOpen_ = data_ != nullptr;
+#else
+			file_ = open(path.c_str(), O_RDONLY);
+			if (file_ < 0) {
+				return;
+			}
+			struct stat status {};
+			if (fstat(file_, &status) != 0) {
+				return;
+			}
+			size_ = static_cast<size_t>(status.st_size);
+			isOpen_ = true;
+
+			if (size_ == 0) {
+				return;
+			}
+			void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_, 0);
+			data_ = data != MAP_FAILED ? static_cast<const uint8_t*>(data) : nullptr;
+			isOpen_ = data_ != nullptr;
+#endif
+		}
+
+		~MappedFile() {
+
+#if defined(_WIN32)
+			if (data_ != nullptr) {
+				UnmapViewOfFile(data_);
+			}
+			if (mapping_ != nullptr) {
+				CloseHandle(mapping_);
+			}
+			if (file_ != INVALID_HANDLE_VALUE) {
+				CloseHandle(file_);
+			}
+#else
+			if (data_ != nullptr) {
+				munmap(const_cast<uint8_t*>(data_), size_);
+			}
+			if (file_ >= 0) {
+				close(file_);
+			}
+#endif
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool IsOpen() const { return isOpen_; }
+		const uint8_t* GetData() const { return data_; }
+		size_t GetSize() const { return size_; }
+
+	private:
+
+#if defined(_WIN32)
+		HANDLE file_ = INVALID_HANDLE_VALUE;
+		HANDLE mapping_ = nullptr;
+#else
+		int file_ = -1;
+#endif
+		const uint8_t* data_ = nullptr;
+		size_t size_ = 0;
+		bool isOpen_ = false;
+	};
+}
+
+//============================================================
+// 初期化
+//============================================================
+void FileHasher::Initialize(uint32_t threadCount) {
+
+	threadCount_ = threadCount != 0 ? threadCount : (std::max)(std::thread::hardware_concurrency(), 1u);
+
+	Clear();
+}
+
+//============================================================
+// ファイルのハッシュ
+//============================================================
+bool FileHasher::Hash(const std::filesystem::path& path, SHA256Digest& digest) {
+
+	std::error_code error;
+	std::string key = std::filesystem::absolute(path, error).lexically_normal().generic_string();
+	uint64_t size = std::filesystem::file_size(path, error);
+	if (error) {
+		return false;
+	}
+	int64_t writeTime = static_cast<int64_t>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+	if (error) {
+		return false;
+	}
+
+	// 大きさと更新時刻が同じなら覚えている結果
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		++stats_.requestCount;
+
+		auto it = cache_.find(key);
+		if (it != cache_.end() && it->second.size == size && it->second.writeTime == writeTime) {
+
+			++stats_.cacheHitCount;
+			digest = it->second.digest;
+			return true;
+		}
+	}
+
+	// 計算中はロックしない、同じファイルを同時に頼まれたら両方で計算する
+	auto start = std::chrono::steady_clock::now();
+
+	MappedFile file(path);
+	if (!file.IsOpen()) {
+		return false;
+	}
+	digest = HashMemory(file.GetData(), file.GetSize(), threadCount_);
+
+	float timeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	++stats_.hashedFileCount;
+	stats_.hashedBytes += file.GetSize();
+	stats_.hashTimeMs += timeMs;
+
+	// 調べてから開くまでに書き換わったものは覚えない
+	if (file.GetSize() == size) {
+		cache_[key] = { size, writeTime, digest };
+	}
+	return true;
+}
+
+//============================================================
+// メモリ上のデータのハッシュ
+//============================================================
+SHA256Digest FileHasher::HashMemory(const void* data, size_t size, uint32_t threadCount) {
+
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+	// 1つに収まるものは普通のSHA-256
+	if (size <= kChunkSize) {
+		return SHA256Hasher::Hash(bytes, size);
+	}
+
+	// 葉、1つずつ別のジョブにして空いたスレッドから取る
+	size_t chunkCount = (size + kChunkSize - 1) / kChunkSize;
+	std::vector<SHA256Digest> level(chunkCount);
+
+	auto hashChunk = [&](size_t index) {
+
+		size_t offset = index * kChunkSize;
+		level[index] = HashLeaf(bytes + offset, (std::min)(kChunkSize, size - offset));
+		};
+
+	threadCount = static_cast<uint32_t>((std::min)(size_t(threadCount), chunkCount));
+	if (threadCount <= 1) {
+
+		for (size_t i = 0; i < chunkCount; ++i) {
+			hashChunk(i);
+		}
+	} else {
+
+		JobGraph graph;
+		for (size_t i = 0; i < chunkCount; ++i) {
+			graph.Add("Chunk", [&hashChunk, i]() { hashChunk(i); });
+		}
+		graph.Run(threadCount);
+	}
+
+	// 節は小さいのでこのスレッドで、奇数個の最後はそのまま上に上げる
+	while (level.size() > 1) {
+
+		std::vector<SHA256Digest> parent((level.size() + 1) / 2);
+		for (size_t i = 0; i < level.size() / 2; ++i) {
+			parent[i] = HashNode(level[i * 2], level[i * 2 + 1]);
+		}
+		if (level.size() % 2 != 0) {
+			parent.back() = level.back();
+		}
+		level = std::move(parent);
+	}
+
+	return level.front();
+}
+
+//============================================================
+// 木の葉と節
+//============================================================
+SHA256Digest FileHasher::HashLeaf(const uint8_t* data, size_t size) {
+
+	const uint8_t prefix = 0x00;
+
+	SHA256Hasher::Stream stream;
+	stream.Update(&prefix, 1);
+	stream.Update(data, size);
+	return stream.Finalize();
+}
+
+SHA256Digest FileHasher::HashNode(const SHA256Digest& left, const SHA256Digest& right) {
+
+	uint8_t node[1 + 64];
+	node[0] = 0x01;
+	std::memcpy(node + 1, left.data(), left.size());
+	std::memcpy(node + 1 + left.size(), right.data(), right.size());
+	return SHA256Hasher::Hash(node, sizeof(node));
+}
+
+//============================================================
+// 覚えている結果を全て消す
+//============================================================
+void FileHasher::Clear() {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	cache_.clear();
+	stats_ = {};
+}
+
+//============================================================
+// 統計
+//============================================================
+FileHasher::Stats FileHasher::GetStats() const {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	return stats_;
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+#include <mutex>
+#include <filesystem>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+#include "SHA256Hasher.h"
+
+//================================================
+// FileHasher Class
+//================================================
+/// ファイルの内容のハッシュ、アセットのキャッシュのキーに使う
+/// ファイルはメモリにマップして読む。kChunkSizeより大きいものは固定の大きさに分けて葉をワーカースレッドで計算し、
+/// マークル木の根を結果にする。分け方はスレッド数によらないので、結果はいつも同じ
+/// kChunkSize以下のファイルは普通のSHA-256と同じ結果になる
+/// 結果はパス、大きさ、更新時刻で覚えておき、変わっていなければ読み直さない。複数のスレッドから呼んでよい
+class FileHasher {
+public:
+	//====================
+	// public
+	//====================
+
+	// 葉1つの大きさ、変えると大きいファイルのハッシュが全て変わる
+	static constexpr size_t kChunkSize = 1024 * 1024;
+
+	// 統計
+	struct Stats {
+
+		uint32_t requestCount = 0;    // Hashを呼んだ回数
+		uint32_t cacheHitCount = 0;   // 覚えていた結果を返した回数
+		uint32_t hashedFileCount = 0; // 実際に読んで計算したファイルの数
+		uint64_t hashedBytes = 0;     // 計算したバイト数の合計
+		float hashTimeMs = 0.0f;      // 計算にかかった時間の合計
+	};
+
+	FileHasher() = default;
+	~FileHasher() = default;
+
+	// threadCountは呼び出し元のスレッドも含めた数、0ならコア数
+	void Initialize(uint32_t threadCount);
+
+	// ファイルのハッシュ、開けなければfalse
+	bool Hash(const std::filesystem::path& path, SHA256Digest& digest);
+
+	// メモリ上のデータのハッシュ、ファイルと同じ分け方で計算する
+	static SHA256Digest HashMemory(const void* data, size_t size, uint32_t threadCount);
+
+	// 覚えている結果を全て消す
+	void Clear();
+
+	// getter
+
+	Stats GetStats() const;
+	uint32_t GetThreadCount() const { return threadCount_; }
+
+private:
+	//====================
+	// private
+	//====================
+
+	// 覚えておく結果
+	struct CacheEntry {
+
+		uint64_t size = 0;
+		int64_t writeTime = 0;
+		SHA256Digest digest{};
+	};
+
+	// 木の葉、先頭に0を付けて区別する
+	static SHA256Digest HashLeaf(const uint8_t* data, size_t size);
+	// 木の節、先頭に1を付けて区別する
+	static SHA256Digest HashNode(const SHA256Digest& left, const SHA256Digest& right);
+
+	uint32_t threadCount_ = 1;
+
+	mutable std::mutex mutex_;
+	// 絶対パスから結果
+	std::unordered_map<std::string, CacheEntry> cache_;
+	Stats stats_;
+};
\ No newline at end of file
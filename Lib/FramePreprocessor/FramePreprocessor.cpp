@@ -0,0 +1,507 @@
+#include "FramePreprocessor.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+	// OpenCVのcvtColor(BGR2GRAY)の係数、14bitの固定小数点
+	const int32_t kGrayShift = 14;
+	const int32_t kBlueToGray = 1868;
+	const int32_t kGreenToGray = 9617;
+	const int32_t kRedToGray = 4899;
+
+	// OpenCVのcvtColor(BGR2HSV)の割り算の表、12bitの固定小数点
+	const int32_t kHSVShift = 12;
+
+	struct HSVTables {
+
+		int32_t saturation[256]; // 255 / V
+		int32_t hue[256];        // 180 / (6 * (V - min))
+	};
+
+	//============================================================
+	// 割り算の表の作成、OpenCVと同じく最も近い整数に丸める
+	//============================================================
+	HSVTables CreateTables() {
+
+		HSVTables tables{};
+		for (int32_t i = 1; i < 256; ++i) {
+
+			tables.saturation[i] = static_cast<int32_t>(std::lrint((255 << kHSVShift) / (1.0 * i)));
+			tables.hue[i] = static_cast<int32_t>(std::lrint((180 << kHSVShift) / (6.0 * i)));
+		}
+		return tables;
+	}
+
+	const HSVTables& GetTables() {
+
+		static const HSVTables tables = CreateTables();
+		return tables;
+	}
+
+	//============================================================
+	// 端の折り返し、OpenCVのBORDER_REFLECT_101
+	//============================================================
+	int32_t Reflect101(int32_t index, int32_t size) {
+
+		if (size == 1) {
+			return 0;
+		}
+		while (index < 0 || index >= size) {
+			index = index < 0 ? -index : 2 * size - 2 - index;
+		}
+		return index;
+	}
+
+	//============================================================
+	// 1ピクセル分のマスク
+	//============================================================
+	uint8_t RedMask(int32_t b, int32_t g, int32_t r, const HSVTables& tables) {
+
+		int32_t v = (std::max)((std::max)(b, g), r);
+		int32_t diff = v - (std::min)((std::min)(b, g), r);
+		int32_t vr = v == r ? -1 : 0;
+		int32_t vg = v == g ? -1 : 0;
+
+		int32_t s = (diff * tables.saturation[v] + (1 << (kHSVShift - 1))) >> kHSVShift;
+		int32_t h = (vr & (g - b)) + (~vr & ((vg & (b - r + 2 * diff)) + (~vg & (r - g + 4 * diff))));
+		h = (h * tables.hue[diff] + (1 << (kHSVShift - 1))) >> kHSVShift;
+		h += h < 0 ? 180 : 0;
+
+		bool isRed = v >= FramePreprocessor::kRedMinValue && s >= FramePreprocessor::kRedMinSaturation &&
+			(h <= FramePreprocessor::kRedHueHigh1 || (h >= FramePreprocessor::kRedHueLow2 && h <= FramePreprocessor::kRedHueHigh2));
+		return isRed ? 255 : 0;
+	}
+}
+
+//============================================================
+// 前処理
+//============================================================
+void FramePreprocessor::Process(const FrameSourceImage& source, const FrameOutputImage& gray, const FrameOutputImage& mask,
+	const FrameOutputImage& color, const Settings& settings) {
+
+	assert(source.pixels && gray.pixels);
+	if (source.width == 0 || source.height == 0) {
+		return;
+	}
+
+	// スレッドから初めて引かないように先に作っておく
+	GetTables();
+	bool useSIMD = settings.useSIMD && IsSIMDSupported();
+
+	// 小さいフレームは分けない
+	uint32_t threadCount = settings.threadCount != 0 ? settings.threadCount : (std::max)(std::thread::hardware_concurrency(), 1u);
+	threadCount = (std::min)(threadCount, (std::max)(source.height / kMinRowsPerThread, 1u));
+
+	if (threadCount <= 1) {
+		ProcessRows(source, gray, mask, color, 0, source.height, settings.isMirrored, useSIMD);
+		return;
+	}
+
+	// 行を均等に分ける、呼び出し元のスレッドも最初の範囲を受け持つ
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount - 1);
+	for (uint32_t i = 1; i < threadCount; ++i) {
+
+		uint32_t begin = static_cast<uint32_t>(uint64_t(source.height) * i / threadCount);
+		uint32_t end = static_cast<uint32_t>(uint64_t(source.height) * (i + 1) / threadCount);
+		threads.emplace_back(ProcessRows, std::cref(source), std::cref(gray), std::cref(mask), std::cref(color),
+			begin, end, settings.isMirrored, useSIMD);
+	}
+
+	ProcessRows(source, gray, mask, color, 0, source.height / threadCount, settings.isMirrored, useSIMD);
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+}
+
+//============================================================
+// 行の範囲の前処理
+//============================================================
+void FramePreprocessor::ProcessRows(const FrameSourceImage& source, const FrameOutputImage& gray, const FrameOutputImage& mask,
+	const FrameOutputImage& color, uint32_t beginRow, uint32_t endRow, bool isMirrored, bool useSIMD) {
+
+	uint32_t width = source.width;
+	int32_t begin = static_cast<int32_t>(beginRow);
+	int32_t end = static_cast<int32_t>(endRow);
+
+	// 入力の順のまま作り、反転は出力するときに行う。ぼかしは左右対称なので結果は同じ
+	std::vector<uint8_t> grayRow(width);
+	std::vector<uint8_t> maskRow(width);
+	std::vector<uint8_t> outputRow(width);
+	// 横にぼかした5行分のリング、縦のぼかしはここから読む
+	std::vector<uint16_t> blurredRows(size_t(width) * 5);
+
+	auto convert = useSIMD ? ConvertRowAVX2 : ConvertRow;
+	auto blurHorizontal = useSIMD ? BlurRowHorizontalAVX2 : BlurRowHorizontal;
+	auto blurVertical = useSIMD ? BlurRowVerticalAVX2 : BlurRowVertical;
+	auto reverse = useSIMD ? ReverseBytesAVX2 : ReverseBytes;
+
+	// 入力の1行を読んで、グレースケールを横にぼかしてリングに置く。範囲内の行はマスクと反転したものも書く
+	auto prepareRow = [&](int32_t row) {
+
+		const uint8_t* sourceRow = source.pixels + size_t(Reflect101(row, source.height)) * source.rowPitch;
+		bool isOutput = row >= begin && row < end;
+
+		uint8_t* maskDestination = nullptr;
+		if (isOutput && mask.pixels) {
+			maskDestination = isMirrored ? maskRow.data() : mask.pixels + size_t(row) * mask.rowPitch;
+		}
+		convert(sourceRow, grayRow.data(), maskDestination, width);
+		if (maskDestination && isMirrored) {
+			reverse(maskRow.data(), mask.pixels + size_t(row) * mask.rowPitch, width);
+		}
+
+		if (isOutput && color.pixels) {
+
+			uint8_t* colorRow = color.pixels + size_t(row) * color.rowPitch;
+			if (isMirrored) {
+				for (uint32_t x = 0; x < width; ++x) {
+					std::memcpy(colorRow + size_t(width - 1 - x) * 3, sourceRow + size_t(x) * 3, 3);
+				}
+			} else {
+				std::memcpy(colorRow, sourceRow, size_t(width) * 3);
+			}
+		}
+
+		blurHorizontal(grayRow.data(), blurredRows.data() + size_t((row - begin + 2) % 5) * width, width);
+	};
+
+	// 最初の行の上下2行ずつ
+	for (int32_t row = begin - 2; row < begin + 2; ++row) {
+		prepareRow(row);
+	}
+
+	for (int32_t y = begin; y < end; ++y) {
+
+		prepareRow(y + 2);
+
+		const uint16_t* rows[5];
+		for (int32_t i = 0; i < 5; ++i) {
+			rows[i] = blurredRows.data() + size_t((y - begin + i) % 5) * width;
+		}
+
+		uint8_t* grayDestination = gray.pixels + size_t(y) * gray.rowPitch;
+		if (isMirrored) {
+			blurVertical(rows, outputRow.data(), width);
+			reverse(outputRow.data(), grayDestination, width);
+		} else {
+			blurVertical(rows, grayDestination, width);
+		}
+	}
+}
+
+//============================================================
+// 1行のグレースケールとマスク
+//============================================================
+void FramePreprocessor::ConvertRow(const uint8_t* source, uint8_t* gray, uint8_t* mask, uint32_t width) {
+
+	const HSVTables& tables = GetTables();
+
+	for (uint32_t x = 0; x < width; ++x) {
+
+		int32_t b = source[x * 3];
+		int32_t g = source[x * 3 + 1];
+		int32_t r = source[x * 3 + 2];
+
+		gray[x] = static_cast<uint8_t>((b * kBlueToGray + g * kGreenToGray + r * kRedToGray + (1 << (kGrayShift - 1))) >> kGrayShift);
+		if (mask) {
+			mask[x] = RedMask(b, g, r, tables);
+		}
+	}
+}
+
+//============================================================
+// 1行のグレースケールとマスク AVX2
+//============================================================
+void FramePreprocessor::ConvertRowAVX2(const uint8_t* source, uint8_t* gray, uint8_t* mask, uint32_t width) {
+
+	const HSVTables& tables = GetTables();
+
+	// 12バイトの4ピクセルを各レーンに置き、ピクセルごとの32bitに広げる
+	const __m256i blueGreenShuffle = _mm256_setr_epi8(
+		0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10, -1,
+		0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10, -1);
+	const __m256i blueShuffle = _mm256_setr_epi8(
+		0, -1, -1, -1, 3, -1, -1, -1, 6, -1, -1, -1, 9, -1, -1, -1,
+		0, -1, -1, -1, 3, -1, -1, -1, 6, -1, -1, -1, 9, -1, -1, -1);
+	const __m256i greenShuffle = _mm256_setr_epi8(
+		1, -1, -1, -1, 4, -1, -1, -1, 7, -1, -1, -1, 10, -1, -1, -1,
+		1, -1, -1, -1, 4, -1, -1, -1, 7, -1, -1, -1, 10, -1, -1, -1);
+	const __m256i redShuffle = _mm256_setr_epi8(
+		2, -1, -1, -1, 5, -1, -1, -1, 8, -1, -1, -1, 11, -1, -1, -1,
+		2, -1, -1, -1, 5, -1, -1, -1, 8, -1, -1, -1, 11, -1, -1, -1);
+
+	// 青と緑を組で掛けて足す
+	const __m256i blueGreenWeight = _mm256_set1_epi32((kGreenToGray << 16) | kBlueToGray);
+	const __m256i redWeight = _mm256_set1_epi32(kRedToGray);
+	const __m256i grayRound = _mm256_set1_epi32(1 << (kGrayShift - 1));
+	const __m256i hsvRound = _mm256_set1_epi32(1 << (kHSVShift - 1));
+
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i byteMask = _mm256_set1_epi32(0xff);
+	const __m256i hueWrap = _mm256_set1_epi32(180);
+	const __m256i minValue = _mm256_set1_epi32(kRedMinValue - 1);
+	const __m256i minSaturation = _mm256_set1_epi32(kRedMinSaturation - 1);
+	const __m256i hueHigh1 = _mm256_set1_epi32(kRedHueHigh1 + 1);
+	const __m256i hueLow2 = _mm256_set1_epi32(kRedHueLow2 - 1);
+	const __m256i hueHigh2 = _mm256_set1_epi32(kRedHueHigh2 + 1);
+
+	// 8ピクセル分、32bitのグレースケールとマスク(0か255)
+	auto convert8 = [&](const uint8_t* pixels, __m256i& grayValue, __m256i& maskValue) {
+
+		__m256i raw = _mm256_inserti128_si256(
+			_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels))),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + 12)), 1);
+
+		grayValue = _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(
+			_mm256_madd_epi16(_mm256_shuffle_epi8(raw, blueGreenShuffle), blueGreenWeight),
+			_mm256_madd_epi16(_mm256_shuffle_epi8(raw, redShuffle), redWeight)), grayRound), kGrayShift);
+
+		if (!mask) {
+			return;
+		}
+
+		__m256i b = _mm256_shuffle_epi8(raw, blueShuffle);
+		__m256i g = _mm256_shuffle_epi8(raw, greenShuffle);
+		__m256i r = _mm256_shuffle_epi8(raw, redShuffle);
+
+		__m256i v = _mm256_max_epi32(_mm256_max_epi32(b, g), r);
+		__m256i diff = _mm256_sub_epi32(v, _mm256_min_epi32(_mm256_min_epi32(b, g), r));
+		__m256i vr = _mm256_cmpeq_epi32(v, r);
+
+		// 赤の範囲の色相はRが最大のときだけなので、明るさも足りなければ割り算の表を引かない
+		__m256i candidate = _mm256_and_si256(vr, _mm256_cmpgt_epi32(v, minValue));
+		if (_mm256_testz_si256(candidate, candidate)) {
+			maskValue = zero;
+			return;
+		}
+
+		__m256i vg = _mm256_cmpeq_epi32(v, g);
+		__m256i s = _mm256_srai_epi32(_mm256_add_epi32(
+			_mm256_mullo_epi32(diff, _mm256_i32gather_epi32(tables.saturation, v, 4)), hsvRound), kHSVShift);
+
+		// Rが最大ならG-B、Gが最大ならB-R+2diff、それ以外はR-G+4diff
+		__m256i h = _mm256_blendv_epi8(
+			_mm256_blendv_epi8(
+				_mm256_add_epi32(_mm256_sub_epi32(r, g), _mm256_slli_epi32(diff, 2)),
+				_mm256_add_epi32(_mm256_sub_epi32(b, r), _mm256_slli_epi32(diff, 1)), vg),
+			_mm256_sub_epi32(g, b), vr);
+		h = _mm256_srai_epi32(_mm256_add_epi32(
+			_mm256_mullo_epi32(h, _mm256_i32gather_epi32(tables.hue, diff, 4)), hsvRound), kHSVShift);
+		h = _mm256_add_epi32(h, _mm256_and_si256(_mm256_cmpgt_epi32(zero, h), hueWrap));
+
+		__m256i isHue = _mm256_or_si256(
+			_mm256_cmpgt_epi32(hueHigh1, h),
+			_mm256_and_si256(_mm256_cmpgt_epi32(h, hueLow2), _mm256_cmpgt_epi32(hueHigh2, h)));
+		__m256i isRed = _mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi32(v, minValue), _mm256_cmpgt_epi32(s, minSaturation)), isHue);
+		maskValue = _mm256_and_si256(isRed, byteMask);
+	};
+
+	// 16ピクセルの32bitを8bitに詰める、packは128bitごとなので並びを戻す
+	auto pack16 = [](__m256i low, __m256i high) {
+
+		__m256i words = _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), 0xD8);
+		__m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(words, words), 0x08);
+		return _mm256_castsi256_si128(bytes);
+	};
+
+	// 後ろの8ピクセルは16バイト読むので、行の終わりを越えない所まで
+	uint32_t x = 0;
+	for (; x + 18 <= width; x += 16) {
+
+		__m256i gray0, gray1, mask0 = zero, mask1 = zero;
+		convert8(source + size_t(x) * 3, gray0, mask0);
+		convert8(source + size_t(x + 8) * 3, gray1, mask1);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(gray + x), pack16(gray0, gray1));
+		if (mask) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(mask + x), pack16(mask0, mask1));
+		}
+	}
+
+	// 残り
+	if (x < width) {
+		ConvertRow(source + size_t(x) * 3, gray + x, mask ? mask + x : nullptr, width - x);
+	}
+}
+
+//============================================================
+// 横方向のぼかし
+//============================================================
+void FramePreprocessor::BlurRowHorizontal(const uint8_t* gray, uint16_t* blurred, uint32_t width) {
+
+	int32_t size = static_cast<int32_t>(width);
+	for (int32_t x = 0; x < size; ++x) {
+
+		// 端以外は折り返さない
+		if (x >= 2 && x + 2 < size) {
+			blurred[x] = static_cast<uint16_t>(gray[x - 2] + 4 * gray[x - 1] + 6 * gray[x] + 4 * gray[x + 1] + gray[x + 2]);
+			continue;
+		}
+		blurred[x] = static_cast<uint16_t>(
+			gray[Reflect101(x - 2, size)] + 4 * gray[Reflect101(x - 1, size)] + 6 * gray[x] +
+			4 * gray[Reflect101(x + 1, size)] + gray[Reflect101(x + 2, size)]);
+	}
+}
+
+//============================================================
+// 横方向のぼかし AVX2
+//============================================================
+void FramePreprocessor::BlurRowHorizontalAVX2(const uint8_t* gray, uint16_t* blurred, uint32_t width) {
+
+	// 端の2ピクセルずつと残りは折り返しが要るので普通に処理する
+	if (width < 20) {
+		BlurRowHorizontal(gray, blurred, width);
+		return;
+	}
+
+	auto load = [](const uint8_t* pixels) {
+		return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels)));
+	};
+
+	uint32_t x = 2;
+	for (; x + 18 <= width; x += 16) {
+
+		__m256i center = load(gray + x);
+		__m256i sum = _mm256_add_epi16(load(gray + x - 2), load(gray + x + 2));
+		sum = _mm256_add_epi16(sum, _mm256_slli_epi16(_mm256_add_epi16(load(gray + x - 1), load(gray + x + 1)), 2));
+		sum = _mm256_add_epi16(sum, _mm256_add_epi16(_mm256_slli_epi16(center, 2), _mm256_slli_epi16(center, 1)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(blurred + x), sum);
+	}
+
+	int32_t size = static_cast<int32_t>(width);
+	auto blurAt = [&](int32_t i) {
+		blurred[i] = static_cast<uint16_t>(
+			gray[Reflect101(i - 2, size)] + 4 * gray[Reflect101(i - 1, size)] + 6 * gray[i] +
+			4 * gray[Reflect101(i + 1, size)] + gray[Reflect101(i + 2, size)]);
+	};
+	blurAt(0);
+	blurAt(1);
+	for (int32_t i = static_cast<int32_t>(x); i < size; ++i) {
+		blurAt(i);
+	}
+}
+
+//============================================================
+// 縦方向のぼかし
+//============================================================
+void FramePreprocessor::BlurRowVertical(const uint16_t* const rows[5], uint8_t* destination, uint32_t width) {
+
+	for (uint32_t x = 0; x < width; ++x) {
+
+		uint32_t sum = rows[0][x] + 4u * rows[1][x] + 6u * rows[2][x] + 4u * rows[3][x] + rows[4][x];
+		destination[x] = static_cast<uint8_t>((sum + 128) >> 8);
+	}
+}
+
+//============================================================
+// 縦方向のぼかし AVX2
+//============================================================
+void FramePreprocessor::BlurRowVerticalAVX2(const uint16_t* const rows[5], uint8_t* destination, uint32_t width) {
+
+	// 横で16倍、縦で16倍しても65535を越えないので16bitのまま足す
+	const __m256i round = _mm256_set1_epi16(128);
+
+	auto load = [&](uint32_t row, uint32_t x) {
+		return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[row] + x));
+	};
+
+	uint32_t x = 0;
+	for (; x + 16 <= width; x += 16) {
+
+		__m256i center = load(2, x);
+		__m256i sum = _mm256_add_epi16(load(0, x), load(4, x));
+		sum = _mm256_add_epi16(sum, _mm256_slli_epi16(_mm256_add_epi16(load(1, x), load(3, x)), 2));
+		sum = _mm256_add_epi16(sum, _mm256_add_epi16(_mm256_slli_epi16(center, 2), _mm256_slli_epi16(center, 1)));
+		sum = _mm256_srli_epi16(_mm256_add_epi16(sum, round), 8);
+
+		__m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(sum, sum), 0x08);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x), _mm256_castsi256_si128(bytes));
+	}
+
+	// 残り
+	if (x < width) {
+
+		const uint16_t* rest[5] = { rows[0] + x, rows[1] + x, rows[2] + x, rows[3] + x, rows[4] + x };
+		BlurRowVertical(rest, destination + x, width - x);
+	}
+}
+
+//============================================================
+// 左右反転
+//============================================================
+void FramePreprocessor::ReverseBytes(const uint8_t* source, uint8_t* destination, uint32_t width) {
+
+	for (uint32_t x = 0; x < width; ++x) {
+		destination[width - 1 - x] = source[x];
+	}
+}
+
+//============================================================
+// 左右反転 AVX2
+//============================================================
+void FramePreprocessor::ReverseBytesAVX2(const uint8_t* source, uint8_t* destination, uint32_t width) {
+
+	// 128bitの中で逆にしてから前後を入れ替える
+	const __m256i reverse = _mm256_setr_epi8(
+		15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+		15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+
+	uint32_t x = 0;
+	for (; x + 32 <= width; x += 32) {
+
+		__m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + x));
+		value = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(value, reverse), 0x4E);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + width - 32 - x), value);
+	}
+
+	// 残り
+	for (; x < width; ++x) {
+		destination[width - 1 - x] = source[x];
+	}
+}
+
+//============================================================
+// AVX2が使えるか
+//============================================================
+bool FramePreprocessor::IsSIMDSupported() {
+
+	static const bool isSupported = []() {
+
+#if defined(_MSC_VER)
+		int info[4]{};
+		__cpuid(info, 0);
+		if (info[0] < 7) {
+			return false;
+		}
+
+		// OSがAVXのレジスタを保存するか
+		__cpuid(info, 1);
+		bool hasOSXSave = (info[2] & (1 << 27)) != 0;
+		bool hasAVX = (info[2] & (1 << 28)) != 0;
+		if (!hasOSXSave || !hasAVX || (_xgetbv(0) & 0x6) != 0x6) {
+			return false;
+		}
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2") != 0;
+#endif
+		}();
+
+	return isSupported;
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// 前処理の入力、1ピクセル3バイトのBGR
+struct FrameSourceImage {
+
+	const uint8_t* pixels = nullptr;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	size_t rowPitch = 0;
+};
+
+// 前処理の出力、大きさは入力と同じ。pixelsがnullptrなら書かない
+struct FrameOutputImage {
+
+	uint8_t* pixels = nullptr;
+	size_t rowPitch = 0;
+};
+
+//================================================
+// FramePreprocessor Class
+//================================================
+/// カメラのフレームの前処理を1回の読み込みでまとめて行う
+/// 左右反転、グレースケール化、5x5のガウシアンでの平滑化と、HSVの赤の範囲のマスクを作る
+/// 行を5行分のリングで処理するので、作業用のデータはキャッシュに収まる。AVX2が使えればSIMDで処理し、行をスレッドに分ける
+/// グレースケールはOpenCVのcvtColorとGaussianBlur(5x5、sigma 0)をこの順にかけたもの、マスクはcvtColorのHSVとinRangeと同じ結果になる
+class FramePreprocessor {
+public:
+	//====================
+	// public
+	//====================
+
+	// 赤の範囲、OpenCVの8bitのHSV(Hは0から179)で。Hの0付近と179付近の2つに分かれる
+	static constexpr uint8_t kRedHueHigh1 = 10;
+	static constexpr uint8_t kRedHueLow2 = 160;
+	static constexpr uint8_t kRedHueHigh2 = 179;
+	static constexpr uint8_t kRedMinSaturation = 100;
+	static constexpr uint8_t kRedMinValue = 100;
+
+	// 設定
+	struct Settings {
+
+		// 左右反転する、カメラを鏡のように見せる
+		bool isMirrored = true;
+		// 0ならコア数分
+		uint32_t threadCount = 0;
+		// falseならAVX2が使えても使わない、比較用
+		bool useSIMD = true;
+	};
+
+	// sourceからgray、赤の範囲を255にしたmask、反転しただけのcolorを作る
+	static void Process(const FrameSourceImage& source, const FrameOutputImage& gray, const FrameOutputImage& mask,
+		const FrameOutputImage& color, const Settings& settings);
+
+	// AVX2が使えるか
+	static bool IsSIMDSupported();
+
+private:
+	//====================
+	// private
+	//====================
+
+	// 1スレッドに割り当てる行の最小、小さいフレームはスレッドを立てない
+	static const uint32_t kMinRowsPerThread = 64;
+
+	// 出力の[beginRow, endRow)を作る
+	static void ProcessRows(const FrameSourceImage& source, const FrameOutputImage& gray, const FrameOutputImage& mask,
+		const FrameOutputImage& color, uint32_t beginRow, uint32_t endRow, bool isMirrored, bool useSIMD);
+
+	// 1行のグレースケールとマスク、入力の順のまま。maskがnullptrならマスクは作らない
+	static void ConvertRow(const uint8_t* source, uint8_t* gray, uint8_t* mask, uint32_t width);
+	static void ConvertRowAVX2(const uint8_t* source, uint8_t* gray, uint8_t* mask, uint32_t width);
+	// 1行の横方向の[1 4 6 4 1]、16倍した値
+	static void BlurRowHorizontal(const uint8_t* gray, uint16_t* blurred, uint32_t width);
+	static void BlurRowHorizontalAVX2(const uint8_t* gray, uint16_t* blurred, uint32_t width);
+	// 5行の縦方向の[1 4 6 4 1]、256で割って丸める
+	static void BlurRowVertical(const uint16_t* const rows[5], uint8_t* destination, uint32_t width);
+	static void BlurRowVerticalAVX2(const uint16_t* const rows[5], uint8_t* destination, uint32_t width);
+	// 1バイトの並びを逆にする
+	static void ReverseBytes(const uint8_t* source, uint8_t* destination, uint32_t width);
+	static void ReverseBytesAVX2(const uint8_t* source, uint8_t* destination, uint32_t width);
+};
\ No newline at end of file
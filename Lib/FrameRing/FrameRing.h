@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+
+//================================================
+// FrameRing Class
+//================================================
+/// 1つのスレッドが書き、1つのスレッドが読むリングバッファ、ロックを使わない
+/// 要素は最初に全て作っておき、書く側と読む側で順に使い回す。cv::Matのように確保が重いものを渡すためのもの
+/// 書く側はBeginWriteで空きを受け取って書き、EndWriteで渡す。読む側はBeginReadで受け取り、EndReadで返す
+template <typename T, size_t kCapacity>
+class FrameRing {
+public:
+	//====================
+	// public
+	//====================
+
+	static_assert(kCapacity >= 2 && (kCapacity & (kCapacity - 1)) == 0, "kCapacity must be a power of two");
+
+	FrameRing() = default;
+	~FrameRing() = default;
+
+	// コピー禁止
+	FrameRing(const FrameRing&) = delete;
+	FrameRing& operator=(const FrameRing&) = delete;
+
+	// 書く側
+
+	// 次に書く要素、満杯ならnullptr
+	T* BeginWrite() {
+
+		size_t head = head_.load(std::memory_order_relaxed);
+		if (head - tail_.load(std::memory_order_acquire) == kCapacity) {
+			return nullptr;
+		}
+		return &slots_[head & (kCapacity - 1)];
+	}
+	// BeginWriteで受け取った要素を読む側に渡す
+	void EndWrite() {
+
+		head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		Notify();
+	}
+
+	// 読む側
+
+	// 一番古い要素、空ならnullptr
+	T* BeginRead() {
+
+		size_t tail = tail_.load(std::memory_order_relaxed);
+		if (head_.load(std::memory_order_acquire) == tail) {
+			return nullptr;
+		}
+		return &slots_[tail & (kCapacity - 1)];
+	}
+	// BeginReadで受け取った要素を書く側に返す
+	void EndRead() {
+
+		tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+	// 空の間眠る、EndWriteかCloseで起きる。起きても空のことがあるのでBeginReadからやり直す
+	void WaitForWrite() {
+
+		// 先に値を取っておけば、確認してから眠るまでに書かれても起きられる
+		uint32_t signal = signal_.load(std::memory_order_acquire);
+		if (head_.load(std::memory_order_acquire) != tail_.load(std::memory_order_relaxed) || IsClosed()) {
+			return;
+		}
+		signal_.wait(signal, std::memory_order_acquire);
+	}
+
+	// どちらからでも
+
+	// もう書かないことを知らせて、眠っている読む側を起こす
+	void Close() {
+
+		isClosed_.store(true, std::memory_order_release);
+		Notify();
+	}
+	bool IsClosed() const { return isClosed_.load(std::memory_order_acquire); }
+	// 読まれていない数、もう一方のスレッドが動いているので目安
+	size_t GetSize() const { return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire); }
+
+	// スレッドを動かす前用
+
+	// 空に戻してCloseを取り消す、要素の中身はそのまま
+	void Reset() {
+
+		head_.store(0, std::memory_order_relaxed);
+		tail_.store(0, std::memory_order_relaxed);
+		isClosed_.store(false, std::memory_order_relaxed);
+	}
+	// 要素、中身を確保しておく用
+	T& GetSlot(size_t index) {
+
+		assert(index < kCapacity);
+		return slots_[index];
+	}
+
+private:
+	//====================
+	// private
+	//====================
+
+	// 書いた数と読んだ数、別のスレッドが書くのでキャッシュラインを分ける
+	alignas(64) std::atomic<size_t> head_ = 0;
+	alignas(64) std::atomic<size_t> tail_ = 0;
+	// 書くたびに増える、読む側が眠るときに待つ値
+	alignas(64) std::atomic<uint32_t> signal_ = 0;
+	std::atomic<bool> isClosed_ = false;
+
+	alignas(64) std::array<T, kCapacity> slots_{};
+
+	// 眠っている読む側を起こす
+	void Notify() {
+
+		signal_.fetch_add(1, std::memory_order_release);
+		signal_.notify_one();
+	}
+};
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "FrameScheduler.h"
+
+#include <cassert>
+
+//============================================================
+// 初期化
+//============================================================
+void FrameScheduler::Initialize(IFrameFence* fence, uint32_t frameCount) {
+
+	assert(fence);
+	assert(frameCount >= 1 && frameCount <= kMaxFrameCount);
+
+	fence_ = fence;
+	frameCount_ = frameCount;
+	frameIndex_ = 0;
+
+	frameFenceValues_.assign(frameCount_, 0);
+	lastSignaledValue_ = fence_->GetCompletedValue();
+
+	pendingReleases_.clear();
+	currentReleases_.clear();
+
+	stats_ = {};
+}
+
+//============================================================
+// フレームの開始
+//============================================================
+uint32_t FrameScheduler::BeginFrame() {
+
+	// このフレームのバッファをGPUがまだ使っていれば待つ
+	uint64_t frameFenceValue = frameFenceValues_[frameIndex_];
+	if (fence_->GetCompletedValue() < frameFenceValue) {
+
+		fence_->Wait(frameFenceValue);
+		stats_.waitCount++;
+	}
+
+	// 待っている間に終わった分もまとめて解放
+	ReleaseCompleted(fence_->GetCompletedValue());
+
+	return frameIndex_;
+}
+
+//============================================================
+// フレームの終了
+//============================================================
+uint64_t FrameScheduler::EndFrame() {
+
+	lastSignaledValue_ = fence_->Signal();
+	frameFenceValues_[frameIndex_] = lastSignaledValue_;
+
+	// このフレームで積まれた遅延解放にSignal値を紐づける
+	for (auto& release : currentReleases_) {
+
+		pendingReleases_.push_back({ lastSignaledValue_, std::move(release) });
+	}
+	currentReleases_.clear();
+
+	stats_.submittedFrames++;
+
+	// 次のフレームへ
+	frameIndex_ = (frameIndex_ + 1) % frameCount_;
+
+	return lastSignaledValue_;
+}
+
+//============================================================
+// 遅延解放
+//============================================================
+void FrameScheduler::DeferRelease(std::function<void()> release) {
+
+	currentReleases_.push_back(std::move(release));
+	stats_.deferredCount++;
+}
+
+//============================================================
+// 全てのフレームの完了待ち
+//============================================================
+void FrameScheduler::WaitForGpu() {
+
+	// 現在のフレームで積まれたものも含めて終わらせるため、Signalしておく
+	lastSignaledValue_ = fence_->Signal();
+	for (auto& release : currentReleases_) {
+
+		pendingReleases_.push_back({ lastSignaledValue_, std::move(release) });
+	}
+	currentReleases_.clear();
+
+	if (fence_->GetCompletedValue() < lastSignaledValue_) {
+
+		fence_->Wait(lastSignaledValue_);
+		stats_.waitCount++;
+	}
+
+	ReleaseCompleted(lastSignaledValue_);
+}
+
+//============================================================
+// 完了した遅延解放の実行
+//============================================================
+void FrameScheduler::ReleaseCompleted(uint64_t completedValue) {
+
+	// Signal値は増える一方なので先頭から見ればよい
+	while (!pendingReleases_.empty() && pendingReleases_.front().fenceValue <= completedValue) {
+
+		pendingReleases_.front().release();
+		pendingReleases_.pop_front();
+		stats_.releasedCount++;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <cstdint>
+
+//================================================
+// IFrameFence Class
+//================================================
+/// GPUの進行を知らせるフェンス
+/// D3D12ではID3D12Fence、デバイスがない環境では偽物に差し替えられる
+class IFrameFence {
+public:
+	//====================
+	// public
+	//====================
+
+	// 仮想デストラクタ
+	virtual ~IFrameFence() {}
+
+	// キューに次の値のSignalを積み、その値を返す
+	virtual uint64_t Signal() = 0;
+
+	// GPUが完了した値
+	virtual uint64_t GetCompletedValue() const = 0;
+
+	// valueに到達するまでCPUで待つ
+	virtual void Wait(uint64_t value) = 0;
+};
+
+//================================================
+// FrameScheduler Class
+//================================================
+/// 複数フレームをGPUに投げたまま次のフレームを記録するための管理
+/// 使い回すフレームのGPU完了だけを待ち、使用中に破棄されたリソースは完了後に解放する
+class FrameScheduler {
+public:
+	//====================
+	// public
+	//====================
+
+	// 同時に投げられるフレームの上限
+	static const uint32_t kMaxFrameCount = 4;
+
+	// 統計
+	struct Stats {
+
+		uint64_t submittedFrames = 0; // 投げたフレーム数
+		uint32_t waitCount = 0;       // GPUを待ったフレーム数
+		uint32_t deferredCount = 0;   // 遅延解放に積まれた数
+		uint32_t releasedCount = 0;   // 遅延解放を実行した数
+	};
+
+	FrameScheduler() = default;
+	~FrameScheduler() = default;
+
+	// 初期化、frameCountは1以上kMaxFrameCount以下
+	void Initialize(IFrameFence* fence, uint32_t frameCount);
+
+	// フレームの開始、このフレームが前回使われたときの完了を待ってフレーム番号を返す
+	uint32_t BeginFrame();
+
+	// フレームの終了、Signalした値を返す
+	uint64_t EndFrame();
+
+	// 遅延解放、現在のフレームがGPUで完了したらreleaseを呼ぶ
+	void DeferRelease(std::function<void()> release);
+
+	// 全てのフレームの完了を待ち、遅延解放を全て実行する
+	void WaitForGpu();
+
+	// getter
+
+	uint32_t GetFrameCount() const { return frameCount_; }
+	uint32_t GetFrameIndex() const { return frameIndex_; }
+	// 最後にSignalした値
+	uint64_t GetLastSignaledValue() const { return lastSignaledValue_; }
+	// フレームが最後に使われたときのSignal値
+	uint64_t GetFrameFenceValue(uint32_t frameIndex) const { return frameFenceValues_[frameIndex]; }
+	uint32_t GetPendingReleaseCount() const {
+		return static_cast<uint32_t>(pendingReleases_.size() + currentReleases_.size());
+	}
+	const Stats& GetStats() const { return stats_; }
+
+private:
+	//====================
+	// private
+	//====================
+
+	// 遅延解放
+	struct PendingRelease {
+
+		uint64_t fenceValue;          // この値が完了したら解放
+		std::function<void()> release;
+	};
+
+	IFrameFence* fence_ = nullptr;
+
+	uint32_t frameCount_ = 0;
+	uint32_t frameIndex_ = 0;
+
+	// 各フレームのSignal値、0は未使用
+	std::vector<uint64_t> frameFenceValues_;
+	uint64_t lastSignaledValue_ = 0;
+
+	// Signal値が決まったもの
+	std::deque<PendingRelease> pendingReleases_;
+	// 現在のフレームで積まれたもの、EndFrameでSignal値が決まる
+	std::vector<std::function<void()>> currentReleases_;
+
+	Stats stats_;
+
+	// completedValueまで完了した遅延解放を実行
+	void ReleaseCompleted(uint64_t completedValue);
+};
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "FrameSource.h"
+
+#include <cassert>
+#include <cctype>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+
+#include <opencv2/imgproc.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/objdetect.hpp>
+
+//============================================================
+// 正解が分からない供給元
+//============================================================
+const std::string& IFrameSource::GetExpectedText() const {
+
+	static const std::string kEmpty;
+	return kEmpty;
+}
+
+//============================================================
+// カメラ
+//============================================================
+CameraFrameSource::CameraFrameSource(int index, uint32_t width, uint32_t height, double fps) : capture_(index) {
+
+	if (!capture_.isOpened()) {
+		return;
+	}
+
+	// カメラウィンドウのサイズ
+	capture_.set(cv::CAP_PROP_FRAME_WIDTH, width);   // 横幅
+	capture_.set(cv::CAP_PROP_FRAME_HEIGHT, height); // 縦幅
+	capture_.set(cv::CAP_PROP_FPS, fps);             // フレームレート (FPS)
+
+	// 対応していない大きさは近いものになる
+	width_ = static_cast<uint32_t>(capture_.get(cv::CAP_PROP_FRAME_WIDTH));
+	height_ = static_cast<uint32_t>(capture_.get(cv::CAP_PROP_FRAME_HEIGHT));
+}
+
+CameraFrameSource::~CameraFrameSource() {
+
+	if (capture_.isOpened()) {
+		capture_.release();
+	}
+}
+
+//============================================================
+// 動画ファイル
+//============================================================
+VideoFrameSource::VideoFrameSource(const std::filesystem::path& path) : capture_(path.string()) {
+
+	if (!capture_.isOpened()) {
+		return;
+	}
+
+	width_ = static_cast<uint32_t>(capture_.get(cv::CAP_PROP_FRAME_WIDTH));
+	height_ = static_cast<uint32_t>(capture_.get(cv::CAP_PROP_FRAME_HEIGHT));
+}
+
+//============================================================
+// 画像のディレクトリ
+//============================================================
+ImageDirectoryFrameSource::ImageDirectoryFrameSource(const std::filesystem::path& directory, uint32_t loopCount) :
+	loopCount_(loopCount) {
+
+	std::error_code error;
+	if (!std::filesystem::is_directory(directory, error)) {
+		return;
+	}
+
+	// 読める画像だけを名前順に
+	std::vector<std::filesystem::path> paths;
+	for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+
+		std::string extension = entry.path().extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		if (entry.is_regular_file() && (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp")) {
+			paths.push_back(entry.path());
+		}
+	}
+	std::sort(paths.begin(), paths.end());
+
+	for (const auto& path : paths) {
+
+		cv::Mat image = cv::imread(path.string(), cv::IMREAD_COLOR);
+		if (!image.empty()) {
+			images_.push_back(std::move(image));
+		}
+	}
+}
+
+bool ImageDirectoryFrameSource::Read(cv::Mat& frame) {
+
+	if (images_.empty() || (loopCount_ != 0 && readCount_ >= uint64_t(loopCount_) * images_.size())) {
+		return false;
+	}
+
+	images_[readCount_ % images_.size()].copyTo(frame);
+	++readCount_;
+	return true;
+}
+
+//============================================================
+// 合成
+//============================================================
+SyntheticFrameSource::SyntheticFrameSource(const Settings& settings) :
+	settings_(settings), random_(settings.seed) {
+
+	assert(!settings_.payloads.empty());
+	assert(settings_.width != 0 && settings_.height != 0);
+
+	cv::Ptr<cv::QRCodeEncoder> encoder = cv::QRCodeEncoder::create();
+
+	// 中身ごとに、白地の真ん中に置いて拡大、回転、ぼかしまでかけておく
+	for (const std::string& payload : settings_.payloads) {
+
+		cv::Mat modules;
+		encoder->encode(payload, modules);
+		if (modules.empty()) {
+			continue;
+		}
+
+		// 1モジュール1ピクセルなので、最近傍で拡大して角を立てたままにする
+		int side = (std::max)(static_cast<int>(std::lround(settings_.height * settings_.scale)), modules.cols);
+		side = (std::min)(side, static_cast<int>((std::min)(settings_.width, settings_.height)));
+		cv::Mat scaled;
+		cv::resize(modules, scaled, cv::Size(side, side), 0.0, 0.0, cv::INTER_NEAREST);
+		cv::cvtColor(scaled, scaled, cv::COLOR_GRAY2BGR);
+
+		cv::Mat frame(settings_.height, settings_.width, CV_8UC3, cv::Scalar::all(255));
+		scaled.copyTo(frame(cv::Rect((frame.cols - side) / 2, (frame.rows - side) / 2, side, side)));
+
+		if (settings_.rotation != 0.0f) {
+
+			cv::Mat rotation = cv::getRotationMatrix2D(cv::Point2f(frame.cols * 0.5f, frame.rows * 0.5f), settings_.rotation, 1.0);
+			cv::warpAffine(frame, frame, rotation, frame.size(), cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar::all(255));
+		}
+		if (settings_.blurSigma > 0.0f) {
+			cv::GaussianBlur(frame, frame, cv::Size(0, 0), settings_.blurSigma);
+		}
+
+		codes_.push_back(std::move(frame));
+	}
+
+	// エンコードできなかった中身があると正解がずれる
+	assert(codes_.size() == settings_.payloads.size());
+}
+
+bool SyntheticFrameSource::Read(cv::Mat& frame) {
+
+	if (codes_.empty() || (settings_.frameCount != 0 && readCount_ >= settings_.frameCount)) {
+		return false;
+	}
+
+	// カメラと同じ間隔で返す、最初のフレームは待たない
+	if (settings_.fps > 0.0) {
+
+		if (readCount_ == 0) {
+			nextTime_ = std::chrono::steady_clock::now();
+		}
+		std::this_thread::sleep_until(nextTime_);
+		nextTime_ += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / settings_.fps));
+	}
+
+	size_t index = static_cast<size_t>(readCount_ % codes_.size());
+	codes_[index].copyTo(frame);
+	expectedText_ = settings_.payloads[index];
+	++readCount_;
+
+	// ノイズはセンサーの後なのでぼかしの後にかける
+	if (settings_.noiseSigma > 0.0f) {
+
+		noise_.create(frame.size(), CV_16SC3);
+		random_.fill(noise_, cv::RNG::NORMAL, cv::Scalar::all(0.0), cv::Scalar::all(settings_.noiseSigma));
+		cv::add(frame, noise_, frame, cv::noArray(), CV_8UC3);
+	}
+	return true;
+}
\ No newline at end of file
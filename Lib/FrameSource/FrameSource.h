@@ -0,0 +1,193 @@
+#pragma once
+
+/// OpenCV
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+//================================================
+// IFrameSource Class
+//================================================
+/// QRCaptureが読むフレームの供給元
+/// カメラの他に、動画ファイル、画像のディレクトリ、合成したQRコードに差し替えられる。カメラがなくても検出を計測できる
+/// Readは読み込みスレッドだけが呼ぶ
+class IFrameSource {
+public:
+	//====================
+	// public
+	//====================
+
+	// 仮想デストラクタ
+	virtual ~IFrameSource() {}
+
+	// 次のフレームをBGRで読む、終わりか失敗でfalse
+	virtual bool Read(cv::Mat& frame) = 0;
+
+	// 開けたか
+	virtual bool IsOpened() const = 0;
+	// フレームの大きさ、開けなければ0。画像のディレクトリは最初の画像の大きさ
+	virtual uint32_t GetWidth() const = 0;
+	virtual uint32_t GetHeight() const = 0;
+
+	// 左右反転して鏡のように見せるか、カメラだけ
+	virtual bool IsMirrored() const { return false; }
+	// 最後に読んだフレームに映っているQRコードの中身、分からなければ空。計測の正解に使うのでReadと同じスレッドから呼ぶ
+	virtual const std::string& GetExpectedText() const;
+};
+
+//================================================
+// CameraFrameSource Class
+//================================================
+/// ウェブカメラ、Readはカメラのフレームレートで戻る
+class CameraFrameSource :
+	public IFrameSource {
+public:
+	//====================
+	// public
+	//====================
+
+	CameraFrameSource(int index, uint32_t width, uint32_t height, double fps);
+	~CameraFrameSource() override;
+
+	bool Read(cv::Mat& frame) override { return capture_.read(frame); }
+
+	bool IsOpened() const override { return capture_.isOpened(); }
+	uint32_t GetWidth() const override { return width_; }
+	uint32_t GetHeight() const override { return height_; }
+	bool IsMirrored() const override { return true; }
+
+private:
+	//====================
+	// private
+	//====================
+
+	cv::VideoCapture capture_;
+	// カメラが実際に選んだ大きさ
+	uint32_t width_ = 0;
+	uint32_t height_ = 0;
+};
+
+//================================================
+// VideoFrameSource Class
+//================================================
+/// 動画ファイル、待たずに最後まで読む
+class VideoFrameSource :
+	public IFrameSource {
+public:
+	//====================
+	// public
+	//====================
+
+	VideoFrameSource(const std::filesystem::path& path);
+	~VideoFrameSource() override = default;
+
+	bool Read(cv::Mat& frame) override { return capture_.read(frame); }
+
+	bool IsOpened() const override { return capture_.isOpened(); }
+	uint32_t GetWidth() const override { return width_; }
+	uint32_t GetHeight() const override { return height_; }
+
+private:
+	//====================
+	// private
+	//====================
+
+	cv::VideoCapture capture_;
+	uint32_t width_ = 0;
+	uint32_t height_ = 0;
+};
+
+//================================================
+// ImageDirectoryFrameSource Class
+//================================================
+/// ディレクトリの画像を名前順に返す、最初に全て読み込むので計測にファイルの読み込みは入らない
+/// loopCount回繰り返したら終わる、0なら終わらない
+class ImageDirectoryFrameSource :
+	public IFrameSource {
+public:
+	//====================
+	// public
+	//====================
+
+	ImageDirectoryFrameSource(const std::filesystem::path& directory, uint32_t loopCount);
+	~ImageDirectoryFrameSource() override = default;
+
+	bool Read(cv::Mat& frame) override;
+
+	bool IsOpened() const override { return !images_.empty(); }
+	uint32_t GetWidth() const override { return images_.empty() ? 0 : static_cast<uint32_t>(images_.front().cols); }
+	uint32_t GetHeight() const override { return images_.empty() ? 0 : static_cast<uint32_t>(images_.front().rows); }
+
+	// 画像の数
+	size_t GetImageCount() const { return images_.size(); }
+
+private:
+	//====================
+	// private
+	//====================
+
+	std::vector<cv::Mat> images_;
+	uint32_t loopCount_ = 0;
+	// 次に返す番号、全ての周回を通して
+	uint64_t readCount_ = 0;
+};
+
+//================================================
+// SyntheticFrameSource Class
+//================================================
+/// QRコードを描いたフレームを作る、同じ設定なら同じフレームの列になる
+/// 中身を順に回し、拡大率、回転、ぼかし、ノイズをかける。正解が分かるので検出の成功率を計れる
+class SyntheticFrameSource :
+	public IFrameSource {
+public:
+	//====================
+	// public
+	//====================
+
+	// 設定
+	struct Settings {
+
+		std::vector<std::string> payloads;  // QRコードの中身、フレームごとに順に使う
+		uint32_t width = 640;               // フレームの大きさ
+		uint32_t height = 360;
+		float scale = 0.6f;                 // QRコードの一辺、フレームの高さに対して
+		float rotation = 0.0f;              // 回転、度
+		float blurSigma = 0.0f;             // ガウシアンぼかしの強さ、0でかけない
+		float noiseSigma = 0.0f;            // 画素値に足すガウスノイズの強さ、0でかけない
+		double fps = 0.0;                   // カメラのように間隔を空けて返す、0なら待たない
+		uint64_t frameCount = 0;            // 作るフレームの数、0なら終わらない
+		uint64_t seed = 0;                  // ノイズの乱数の種
+	};
+
+	SyntheticFrameSource(const Settings& settings);
+	~SyntheticFrameSource() override = default;
+
+	bool Read(cv::Mat& frame) override;
+
+	bool IsOpened() const override { return !codes_.empty(); }
+	uint32_t GetWidth() const override { return settings_.width; }
+	uint32_t GetHeight() const override { return settings_.height; }
+	const std::string& GetExpectedText() const override { return expectedText_; }
+
+private:
+	//====================
+	// private
+	//====================
+
+	Settings settings_;
+
+	// 中身ごとに、ノイズ以外をかけ終えたフレーム
+	std::vector<cv::Mat> codes_;
+	// ノイズの作業用
+	cv::Mat noise_;
+	cv::RNG random_;
+
+	uint64_t readCount_ = 0;
+	std::string expectedText_;
+	std::chrono::steady_clock::time_point nextTime_;
+};
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "GeometryArena.h"
+
+#include <algorithm>
+#include <cassert>
+
+//============================================================
+// 初期化
+//============================================================
+void GeometryArena::Initialize(IGeometryAllocator* allocator, uint64_t initialPageSize) {
+
+	assert(allocator);
+	assert(initialPageSize > 0);
+
+	allocator_ = allocator;
+	pageSize_ = initialPageSize;
+
+	stats_ = {};
+	stats_.pageSize = pageSize_;
+}
+
+//============================================================
+// 終了処理
+//============================================================
+void GeometryArena::Finalize() {
+
+	if (!allocator_) {
+		return;
+	}
+
+	// 完了待ちも含めて全て返す
+	if (currentPage_.cpuAddress) {
+		usedPages_.push_back(currentPage_);
+		currentPage_ = {};
+	}
+	for (auto& frame : frames_) {
+		usedPages_.insert(usedPages_.end(), frame.pages.begin(), frame.pages.end());
+	}
+	frames_.clear();
+	usedPages_.insert(usedPages_.end(), freePages_.begin(), freePages_.end());
+	freePages_.clear();
+
+	for (auto& page : usedPages_) {
+		allocator_->FreePage(page);
+	}
+	usedPages_.clear();
+
+	stats_.reservedSize = 0;
+	stats_.pageCount = 0;
+	allocator_ = nullptr;
+}
+
+//============================================================
+// 確保
+//============================================================
+GeometryAllocation GeometryArena::Allocate(uint64_t size, uint64_t alignment) {
+
+	assert(allocator_);
+	assert(alignment > 0);
+
+	if (size == 0) {
+		return {};
+	}
+
+	// 今のページに入らなければ次のページへ
+	uint64_t offset = AlignUp(currentOffset_, alignment);
+	if (!currentPage_.cpuAddress || offset + size > currentPage_.size) {
+
+		AcquirePage(size);
+		offset = 0;
+	}
+
+	GeometryAllocation allocation{};
+	allocation.cpuAddress = currentPage_.cpuAddress + offset;
+	allocation.pageAddress = currentPage_.gpuAddress;
+	allocation.pageSize = currentPage_.size;
+	allocation.offset = offset;
+
+	// パディングも使用量に含める
+	stats_.frameSize += (offset + size) - currentOffset_;
+	stats_.highWaterSize = (std::max)(stats_.highWaterSize, stats_.frameSize);
+	stats_.allocations++;
+
+	currentOffset_ = offset + size;
+
+	return allocation;
+}
+
+//============================================================
+// フレームの終了
+//============================================================
+void GeometryArena::FinishFrame(uint64_t fenceValue) {
+
+	if (currentPage_.cpuAddress) {
+		usedPages_.push_back(currentPage_);
+		currentPage_ = {};
+		currentOffset_ = 0;
+	}
+
+	// 複数のページに分かれたら、次からはこのフレームの使用量が1ページに収まるようにする
+	if (usedPages_.size() > 1) {
+
+		uint64_t pageSize = pageSize_;
+		while (pageSize < stats_.frameSize) {
+			pageSize *= 2;
+		}
+		pageSize_ = pageSize;
+		stats_.pageSize = pageSize_;
+	}
+
+	// 使っていないフレームも順番を保つために積む
+	frames_.push_back({ fenceValue, std::move(usedPages_) });
+	usedPages_.clear();
+
+	stats_.lastFrameSize = stats_.frameSize;
+	stats_.frameSize = 0;
+}
+
+//============================================================
+// 完了したフレームの回収
+//============================================================
+void GeometryArena::ReleaseCompletedFrames(uint64_t completedFenceValue) {
+
+	while (!frames_.empty() && frames_.front().fenceValue <= completedFenceValue) {
+
+		for (auto& page : frames_.front().pages) {
+			RecyclePage(page);
+		}
+		frames_.pop_front();
+	}
+}
+
+//============================================================
+// 書き込み先のページを用意する
+//============================================================
+void GeometryArena::AcquirePage(uint64_t size) {
+
+	// このフレームで使い切ったページ
+	bool isOverflow = currentPage_.cpuAddress != nullptr;
+	if (isOverflow) {
+		usedPages_.push_back(currentPage_);
+		currentPage_ = {};
+	}
+
+	// 1フレームで溢れた、または1つの確保がページより大きいので、次のページは倍にする
+	if (isOverflow || size > pageSize_) {
+
+		pageSize_ = (std::max)(pageSize_ * 2, size);
+		stats_.pageSize = pageSize_;
+		stats_.growCount++;
+	}
+
+	// 大きくする前の空きページは返しておく
+	std::vector<GeometryPage> freePages = std::move(freePages_);
+	freePages_.clear();
+	for (auto& page : freePages) {
+		RecyclePage(page);
+	}
+
+	// 空いているページがあれば使い回す
+	if (!freePages_.empty()) {
+
+		currentPage_ = freePages_.back();
+		freePages_.pop_back();
+	} else {
+
+		currentPage_ = allocator_->AllocatePage(pageSize_);
+		assert(currentPage_.cpuAddress && currentPage_.size >= size);
+
+		stats_.reservedSize += currentPage_.size;
+		stats_.pageCount++;
+	}
+
+	currentOffset_ = 0;
+}
+
+//============================================================
+// ページの返却
+//============================================================
+void GeometryArena::RecyclePage(GeometryPage& page) {
+
+	// 大きいページに切り替えた後の小さいページは残さない
+	if (page.size < pageSize_) {
+
+		stats_.reservedSize -= page.size;
+		stats_.pageCount--;
+		allocator_->FreePage(page);
+		return;
+	}
+
+	freePages_.push_back(page);
+}
\ No newline at end of file
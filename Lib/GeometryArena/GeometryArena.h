@@ -0,0 +1,143 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <cstdint>
+
+// アリーナが使うバッファ1つ分、マップしたまま使う
+struct GeometryPage {
+
+	uint8_t* cpuAddress = nullptr;
+	uint64_t gpuAddress = 0;
+	uint64_t size = 0;
+
+	// 確保した側が返却に使う
+	void* handle = nullptr;
+};
+
+// アリーナから切り出した範囲、確保したフレームの間だけ有効
+struct GeometryAllocation {
+
+	uint8_t* cpuAddress = nullptr;
+
+	// 切り出し元のページ、頂点バッファビューはページ全体に張ってoffsetで位置を指定する
+	uint64_t pageAddress = 0;
+	uint64_t pageSize = 0;
+	uint64_t offset = 0;
+
+	bool IsValid() const { return cpuAddress != nullptr; }
+
+	// 書き込み先
+	template <typename T>
+	T* GetData() const { return reinterpret_cast<T*>(cpuAddress); }
+};
+
+//================================================
+// IGeometryAllocator Class
+//================================================
+/// GeometryArenaのページの確保先
+/// D3D12ではアップロードバッファ、デバイスがない環境ではメモリを返すだけのものに差し替えられる
+class IGeometryAllocator {
+public:
+	//====================
+	// public
+	//====================
+
+	// 仮想デストラクタ
+	virtual ~IGeometryAllocator() {}
+
+	// sizeバイト以上のページを確保する
+	virtual GeometryPage AllocatePage(uint64_t size) = 0;
+	// GPUが使い終わったページを返す
+	virtual void FreePage(GeometryPage& page) = 0;
+};
+
+//================================================
+// GeometryArena Class
+//================================================
+/// フレームごとに使い捨てる頂点、インデックスの置き場
+/// 足りなくなったら倍の大きさのページを追加し、次のフレームからは大きいページ1つで収まるようにする
+/// 使い終わったページはフェンス値で回収して使い回す。メモリの中身には触らない
+class GeometryArena {
+public:
+	//====================
+	// public
+	//====================
+
+	// 統計
+	struct Stats {
+
+		uint64_t frameSize = 0;       // 現在のフレームで確保したサイズ
+		uint64_t lastFrameSize = 0;   // 前のフレームで確保したサイズ
+		uint64_t highWaterSize = 0;   // 1フレームで確保した最大サイズ
+		uint64_t pageSize = 0;        // 今のページの大きさ
+		uint64_t reservedSize = 0;    // 確保しているページの合計
+		uint32_t pageCount = 0;       // 確保しているページの数
+		uint32_t allocations = 0;     // 確保回数
+		uint32_t growCount = 0;       // ページを大きくした回数
+	};
+
+	GeometryArena() = default;
+	~GeometryArena() = default;
+
+	// 初期化、最初のページの大きさを決める
+	void Initialize(IGeometryAllocator* allocator, uint64_t initialPageSize);
+
+	// 全てのページを返す、GPUが使い終わってから呼ぶ
+	void Finalize();
+
+	// 確保、alignmentは要素の大きさなど。2の累乗でなくてもよい
+	GeometryAllocation Allocate(uint64_t size, uint64_t alignment);
+
+	// フレームの終了、このフレームで使ったページをfenceValueに紐づける
+	void FinishFrame(uint64_t fenceValue);
+
+	// completedFenceValueまで完了したフレームのページを回収
+	void ReleaseCompletedFrames(uint64_t completedFenceValue);
+
+	// getter
+
+	const Stats& GetStats() const { return stats_; }
+	// GPUの完了待ちをしているフレーム数
+	uint32_t GetPendingFrameCount() const { return static_cast<uint32_t>(frames_.size()); }
+
+private:
+	//====================
+	// private
+	//====================
+
+	// 終了したフレーム
+	struct FrameMarker {
+
+		uint64_t fenceValue;              // 完了を知らせるフェンス値
+		std::vector<GeometryPage> pages;  // フレームで使ったページ
+	};
+
+	IGeometryAllocator* allocator_ = nullptr;
+
+	// 次に確保するページの大きさ
+	uint64_t pageSize_ = 0;
+
+	// 書き込み中のページと位置
+	GeometryPage currentPage_;
+	uint64_t currentOffset_ = 0;
+	// このフレームで使い切ったページ
+	std::vector<GeometryPage> usedPages_;
+
+	// 空いているページ
+	std::vector<GeometryPage> freePages_;
+	// GPUの完了待ちのページ
+	std::deque<FrameMarker> frames_;
+
+	Stats stats_;
+
+	// 書き込み先のページを用意する、sizeが入る大きさにする
+	void AcquirePage(uint64_t size);
+	// ページの返却、小さくなったものは確保先に返す
+	void RecyclePage(GeometryPage& page);
+
+	// alignmentの倍数に切り上げ
+	static uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+};
\ No newline at end of file
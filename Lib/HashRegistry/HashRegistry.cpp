@@ -0,0 +1,98 @@
+#include "HashRegistry.h"
+
+#include <unordered_map>
+
+namespace {
+
+	//============================================================
+	// 種類1つ分の作成、コンパイル時
+	//============================================================
+	constexpr HashRegistry::Entry MakeEntry(SHA256::HAJIKI_TYPE type, const char* name, const char* identifier) {
+
+		HashRegistry::Entry entry{ type, name, identifier, SHA256Hasher::HashConstexpr(identifier), {} };
+
+		std::array<char, 64> hex = SHA256Hasher::ToHexConstexpr(entry.digest);
+		for (size_t i = 0; i < hex.size(); ++i) {
+			entry.hex[i] = hex[i];
+		}
+		entry.hex[hex.size()] = '\0';
+		return entry;
+	}
+
+	// 識別子は今までのSHA256::GetTypeHashと同じ、印刷済みのQRコードがそのまま使える
+	constexpr std::array<HashRegistry::Entry, HashRegistry::kTypeCount> kEntries = {
+
+		MakeEntry(SHA256::HAJIKI_TYPE::NORMAL, "NORMAL", "HAJIKI_TYPE::NORMAL"),
+		MakeEntry(SHA256::HAJIKI_TYPE::FEATHER, "FEATHER", "HAJIKI_TYPE::FEATHER"),
+		MakeEntry(SHA256::HAJIKI_TYPE::HEAVY, "HEAVY", "HAJIKI_TYPE::HEAVY"),
+	};
+
+	constexpr HashRegistry::Entry kUnknown = MakeEntry(SHA256::HAJIKI_TYPE::TYPENUM, "UNKNOWN", "UNKNOWN");
+
+	// コンパイル時のハッシュの確認、NISTの例
+	static_assert(SHA256Hasher::ToHexConstexpr(SHA256Hasher::HashConstexpr("abc")) == std::array<char, 64>{
+		'b', 'a', '7', '8', '1', '6', 'b', 'f', '8', 'f', '0', '1', 'c', 'f', 'e', 'a',
+		'4', '1', '4', '1', '4', '0', 'd', 'e', '5', 'd', 'a', 'e', '2', '2', '2', '3',
+		'b', '0', '0', '3', '6', '1', 'a', '3', '9', '6', '1', '7', '7', 'a', '9', 'c',
+		'b', '4', '1', '0', 'f', 'f', '6', '1', 'f', '2', '0', '0', '1', '5', 'a', 'd' });
+
+	// 表の順番とHAJIKI_TYPEの値が揃っているか
+	constexpr bool IsOrdered() {
+
+		for (size_t i = 0; i < kEntries.size(); ++i) {
+			if (static_cast<size_t>(kEntries[i].type) != i) {
+				return false;
+			}
+		}
+		return true;
+	}
+	static_assert(IsOrdered());
+
+	// ダイジェストから種類への表、最初に引いたときに1度だけ作る
+	const std::unordered_map<SHA256Digest, const HashRegistry::Entry*, SHA256DigestHash>& GetDigestMap() {
+
+		static const std::unordered_map<SHA256Digest, const HashRegistry::Entry*, SHA256DigestHash> map = []() {
+
+			std::unordered_map<SHA256Digest, const HashRegistry::Entry*, SHA256DigestHash> result;
+			for (const HashRegistry::Entry& entry : kEntries) {
+				result.emplace(entry.digest, &entry);
+			}
+			return result;
+			}();
+
+		return map;
+	}
+}
+
+//============================================================
+// 種類の情報
+//============================================================
+const HashRegistry::Entry& HashRegistry::Get(SHA256::HAJIKI_TYPE type) {
+
+	size_t index = static_cast<size_t>(type);
+	return index < kEntries.size() ? kEntries[index] : kUnknown;
+}
+
+const std::array<HashRegistry::Entry, HashRegistry::kTypeCount>& HashRegistry::GetEntries() {
+
+	return kEntries;
+}
+
+//============================================================
+// ハッシュから種類を引く
+//============================================================
+const HashRegistry::Entry* HashRegistry::Find(const SHA256Digest& digest) {
+
+	const auto& map = GetDigestMap();
+	auto it = map.find(digest);
+	return it != map.end() ? it->second : nullptr;
+}
+
+const HashRegistry::Entry* HashRegistry::Find(std::string_view hex) {
+
+	SHA256Digest digest{};
+	if (!SHA256Hasher::FromHex(hex, digest)) {
+		return nullptr;
+	}
+	return Find(digest);
+}
\ No newline at end of file
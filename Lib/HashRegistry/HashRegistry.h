@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+
+#include "SHA256.h"
+#include "SHA256Hasher.h"
+
+//================================================
+// HashRegistry Class
+//================================================
+/// HAJIKI_TYPEの識別子とそのハッシュの表、ハッシュはコンパイル時に作るので実行時には計算しない
+/// QRコードから読んだ16進数のハッシュを、ダイジェストをキーにしたmapで種類に引く
+class HashRegistry {
+public:
+	//====================
+	// public
+	//====================
+
+	// 種類1つ分
+	struct Entry {
+
+		SHA256::HAJIKI_TYPE type;
+		// 表示する名前
+		const char* name;
+		// ハッシュを取る文字列
+		const char* identifier;
+		SHA256Digest digest;
+		// digestの16進数、終端付き
+		std::array<char, 65> hex;
+	};
+
+	// 種類の数
+	static const size_t kTypeCount = static_cast<size_t>(SHA256::HAJIKI_TYPE::TYPENUM);
+
+	// 種類の情報、範囲外はUNKNOWN
+	static const Entry& Get(SHA256::HAJIKI_TYPE type);
+	// 全ての種類、HAJIKI_TYPEの順
+	static const std::array<Entry, kTypeCount>& GetEntries();
+
+	// ハッシュから種類を引く、なければnullptr
+	static const Entry* Find(const SHA256Digest& digest);
+	// 16進数のハッシュから種類を引く、大文字も読む。ハッシュでないか、なければnullptr
+	static const Entry* Find(std::string_view hex);
+};
\ No newline at end of file
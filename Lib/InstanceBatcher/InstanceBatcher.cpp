@@ -0,0 +1,78 @@
+#include "InstanceBatcher.h"
+
+#include <algorithm>
+#include <cassert>
+
+//============================================================
+// 同じバッチにまとめられるか
+//============================================================
+bool InstanceBatchKey::IsBatchableWith(const InstanceBatchKey& other) const {
+
+	// メッシュ、パイプラインが同じ
+	if (identifier != other.identifier ||
+		pipelineType != other.pipelineType) {
+		return false;
+	}
+
+	// Lightの値が同じ
+	if (light.color.x != other.light.color.x || light.color.y != other.light.color.y ||
+		light.color.z != other.light.color.z || light.color.w != other.light.color.w ||
+		light.direction.x != other.light.direction.x || light.direction.y != other.light.direction.y ||
+		light.direction.z != other.light.direction.z || light.intensity != other.light.intensity) {
+		return false;
+	}
+
+	// Cameraの位置が同じ
+	return camera.pos.x == other.camera.pos.x &&
+		camera.pos.y == other.camera.pos.y &&
+		camera.pos.z == other.camera.pos.z;
+}
+
+//============================================================
+// 描画の追加
+//============================================================
+void InstanceBatcher::Add(const InstanceBatchKey& key, const InstanceData& instance) {
+
+	// 条件が変わる、または上限に達したら先に発行する
+	if (!instances_.empty() &&
+		(!pendingKey_.IsBatchableWith(key) || instances_.size() >= maxInstanceCount_)) {
+
+		Flush();
+	}
+
+	if (instances_.empty()) {
+
+		// 最初の描画の条件を保持、LightとCameraもこれを使う
+		pendingKey_ = key;
+	}
+
+	instances_.push_back(instance);
+	stats_.drawRequests++;
+}
+
+//============================================================
+// 溜まっている描画を発行
+//============================================================
+void InstanceBatcher::Flush() {
+
+	if (instances_.empty()) {
+		return;
+	}
+
+	// 発行先が設定されていない
+	assert(flushFunction_);
+
+	uint32_t instanceCount = static_cast<uint32_t>(instances_.size());
+	flushFunction_(pendingKey_, instances_.data(), instanceCount);
+
+	// 統計の更新
+	stats_.drawCalls++;
+	if (instanceCount > 1) {
+
+		stats_.batches++;
+		stats_.drawCallsSaved += instanceCount - 1;
+	}
+	stats_.maxInstancesPerBatch = (std::max)(stats_.maxInstancesPerBatch, instanceCount);
+
+	instances_.clear();
+}
\ No newline at end of file
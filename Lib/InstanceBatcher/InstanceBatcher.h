@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <cstdint>
+
+#include "DrawData.h"
+
+// バッチのまとめ条件
+struct InstanceBatchKey {
+
+	std::string identifier;   // メッシュ(モデル)の名前
+	uint32_t pipelineType;    // パイプラインの種類
+	// テクスチャはインスタンスごとにヒープの番号で持つので条件に含めない
+
+	// 共有するLight、Camera。値が一致すればまとめられる
+	DirectionalLight light;
+	CameraViewData camera;
+
+	// 同じバッチにまとめられるか
+	bool IsBatchableWith(const InstanceBatchKey& other) const;
+};
+
+//================================================
+// InstanceBatcher Class
+//================================================
+/// 連続する同メッシュ、同マテリアルの描画を1回のDrawInstancedにまとめる
+/// GPUには触らないのでデバイスなしで動作する
+class InstanceBatcher {
+public:
+	//====================
+	// public
+	//====================
+
+	// まとめた結果を受け取る関数
+	using FlushFunction =
+		std::function<void(const InstanceBatchKey& key, const InstanceData* instances, uint32_t instanceCount)>;
+
+	// 統計
+	struct Stats {
+
+		uint32_t drawRequests = 0;         // 受け付けた描画数
+		uint32_t drawCalls = 0;            // 実際に発行したDrawCall数
+		uint32_t batches = 0;              // 2インスタンス以上まとめられたバッチ数
+		uint32_t drawCallsSaved = 0;       // まとめたことで減ったDrawCall数
+		uint32_t maxInstancesPerBatch = 0; // 1バッチの最大インスタンス数
+	};
+
+	InstanceBatcher() = default;
+	~InstanceBatcher() = default;
+
+	// 描画の追加、条件が変わったら溜まっているものを先に発行する
+	void Add(const InstanceBatchKey& key, const InstanceData& instance);
+
+	// 溜まっている描画を発行する
+	void Flush();
+
+	// 統計のリセット
+	void ResetStats() { stats_ = {}; }
+
+	// getter
+
+	const Stats& GetStats() const { return stats_; }
+	uint32_t GetPendingCount() const { return static_cast<uint32_t>(instances_.size()); }
+
+	// setter
+
+	void SetFlushFunction(FlushFunction function) { flushFunction_ = std::move(function); }
+	// 1バッチの上限、超えたら分割する
+	void SetMaxInstanceCount(uint32_t maxInstanceCount) { maxInstanceCount_ = maxInstanceCount; }
+
+private:
+	//====================
+	// private
+	//====================
+
+	// 発行先
+	FlushFunction flushFunction_;
+
+	// 溜まっている描画の条件
+	InstanceBatchKey pendingKey_;
+	// 溜まっているインスタンス
+	std::vector<InstanceData> instances_;
+
+	uint32_t maxInstanceCount_ = 1024;
+
+	Stats stats_;
+};
\ No newline at end of file
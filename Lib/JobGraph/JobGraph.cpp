@@ -0,0 +1,228 @@
+#include "JobGraph.h"
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <cassert>
+#include <algorithm>
+#include <condition_variable>
+
+//============================================================
+// ジョブの追加
+//============================================================
+JobId JobGraph::Add(const std::string& name, std::function<void()> function,
+	std::initializer_list<JobId> dependencies, bool isMainThread) {
+
+	JobId id = static_cast<JobId>(jobs_.size());
+
+	Job& job = jobs_.emplace_back();
+	job.name = name;
+	job.function = std::move(function);
+	job.isMainThread = isMainThread;
+
+	for (JobId dependency : dependencies) {
+		AddDependency(id, dependency);
+	}
+
+	return id;
+}
+
+//============================================================
+// 依存の追加
+//============================================================
+void JobGraph::AddDependency(JobId job, JobId dependency) {
+
+	assert(job < jobs_.size() && dependency < jobs_.size() && job != dependency);
+
+	jobs_[dependency].successors.push_back(job);
+	jobs_[job].dependencyCount++;
+}
+
+//============================================================
+// 全てのジョブを実行
+//============================================================
+void JobGraph::Run(uint32_t threadCount) {
+
+	// 循環していると終わらない、クリティカルパスもこの順で求める
+	std::vector<JobId> order = SortTopologically();
+	assert(order.size() == jobs_.size());
+
+	threadCount = (std::max)(threadCount, 1u);
+
+	auto start = std::chrono::steady_clock::now();
+	auto elapsedMs = [&start]() {
+		return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		};
+
+	std::mutex mutex;
+	std::condition_variable condition;
+
+	// 依存先が全て終わったジョブ、メインスレッド限定のものは分けて持つ
+	std::deque<JobId> readyJobs;
+	std::deque<JobId> readyMainJobs;
+	std::vector<uint32_t> remaining(jobs_.size());
+	size_t completedCount = 0;
+
+	for (JobId id = 0; id < jobs_.size(); ++id) {
+
+		remaining[id] = jobs_[id].dependencyCount;
+		if (remaining[id] == 0) {
+			(jobs_[id].isMainThread ? readyMainJobs : readyJobs).push_back(id);
+		}
+	}
+
+	// 取れるジョブがなければ、全て終わるまで待つ
+	auto worker = [&](uint32_t threadIndex) {
+
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+
+			condition.wait(lock, [&]() {
+				return completedCount == jobs_.size() || !readyJobs.empty() || (threadIndex == 0 && !readyMainJobs.empty());
+				});
+
+			if (completedCount == jobs_.size()) {
+				break;
+			}
+
+			// メインスレッドは限定のものを先に片付ける、後ろのジョブを早く解放できる
+			JobId id = kInvalidId;
+			if (threadIndex == 0 && !readyMainJobs.empty()) {
+				id = readyMainJobs.front();
+				readyMainJobs.pop_front();
+			} else {
+				id = readyJobs.front();
+				readyJobs.pop_front();
+			}
+
+			Job& job = jobs_[id];
+			lock.unlock();
+
+			job.timing.startMs = elapsedMs();
+			if (job.function) {
+				job.function();
+				// キャプチャしたデータを持ち続けないように破棄する
+				job.function = nullptr;
+			}
+			job.timing.durationMs = elapsedMs() - job.timing.startMs;
+			job.timing.threadIndex = threadIndex;
+
+			lock.lock();
+
+			// 待っていたジョブの依存を1つ減らす
+			for (JobId successor : job.successors) {
+				if (--remaining[successor] == 0) {
+					(jobs_[successor].isMainThread ? readyMainJobs : readyJobs).push_back(successor);
+				}
+			}
+			completedCount++;
+
+			condition.notify_all();
+		}
+		};
+
+	// 呼び出し元のスレッドも実行に加わる
+	std::vector<std::thread> threads;
+	for (uint32_t i = 1; i < threadCount; ++i) {
+		threads.emplace_back(worker, i);
+	}
+	worker(0);
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	// 統計
+	stats_ = {};
+	stats_.jobCount = static_cast<uint32_t>(jobs_.size());
+	stats_.threadCount = threadCount;
+	stats_.totalTimeMs = elapsedMs();
+	for (const Job& job : jobs_) {
+		stats_.sumTimeMs += job.timing.durationMs;
+	}
+
+	BuildCriticalPath(order);
+}
+
+//============================================================
+// ジョブと結果の破棄
+//============================================================
+void JobGraph::Clear() {
+
+	jobs_.clear();
+	criticalPath_.clear();
+	stats_ = {};
+}
+
+//============================================================
+// 依存の順に並べる
+//============================================================
+std::vector<JobId> JobGraph::SortTopologically() const {
+
+	// 依存のないものから順に外していく、循環していれば外せないものが残る
+	std::vector<uint32_t> remaining(jobs_.size());
+	std::vector<JobId> stack;
+	for (JobId id = 0; id < jobs_.size(); ++id) {
+
+		remaining[id] = jobs_[id].dependencyCount;
+		if (remaining[id] == 0) {
+			stack.push_back(id);
+		}
+	}
+
+	std::vector<JobId> order;
+	order.reserve(jobs_.size());
+	while (!stack.empty()) {
+
+		JobId id = stack.back();
+		stack.pop_back();
+		order.push_back(id);
+
+		for (JobId successor : jobs_[id].successors) {
+			if (--remaining[successor] == 0) {
+				stack.push_back(successor);
+			}
+		}
+	}
+
+	return order;
+}
+
+//============================================================
+// クリティカルパスを求める
+//============================================================
+void JobGraph::BuildCriticalPath(const std::vector<JobId>& order) {
+
+	criticalPath_.clear();
+	if (jobs_.empty()) {
+		return;
+	}
+
+	// 依存の順に辿れば、ジョブを見るときには依存先の列が全て求まっている
+	// 開始時間の順では、時間が同じになった依存先と前後することがある
+
+	// そのジョブで終わる一番長い列の時間と、1つ前のジョブ
+	std::vector<float> pathMs(jobs_.size(), 0.0f);
+	std::vector<JobId> previous(jobs_.size(), kInvalidId);
+	for (JobId id : order) {
+
+		pathMs[id] += jobs_[id].timing.durationMs;
+		for (JobId successor : jobs_[id].successors) {
+			if (pathMs[id] > pathMs[successor]) {
+				pathMs[successor] = pathMs[id];
+				previous[successor] = id;
+			}
+		}
+	}
+
+	// 一番長い列の最後から辿る
+	JobId last = static_cast<JobId>(std::max_element(pathMs.begin(), pathMs.end()) - pathMs.begin());
+	stats_.criticalPathMs = pathMs[last];
+
+	for (JobId id = last; id != kInvalidId; id = previous[id]) {
+
+		jobs_[id].timing.isCritical = true;
+		criticalPath_.push_back(id);
+	}
+	std::reverse(criticalPath_.begin(), criticalPath_.end());
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <initializer_list>
+#include <cstdint>
+
+// ジョブの番号、登録順
+using JobId = uint32_t;
+
+//================================================
+// JobGraph Class
+//================================================
+/// 依存関係のあるジョブを、依存先が全て終わったものからワーカースレッドで同時に実行する
+/// メインスレッドに限定したジョブは、Runを呼んだスレッドだけが実行する。GPUやシングルトンの登録に使う
+/// 実行後はジョブごとの時間と、全体の時間を決めている一番長い依存の列(クリティカルパス)が取れる
+class JobGraph {
+public:
+	//====================
+	// public
+	//====================
+
+	// 無効な番号
+	static constexpr JobId kInvalidId = ~0u;
+
+	// ジョブ1つの実行結果
+	struct Timing {
+
+		float startMs = 0.0f;         // Runの開始からの時間
+		float durationMs = 0.0f;      // 実行にかかった時間
+		uint32_t threadIndex = 0;     // 実行したスレッド、0がRunを呼んだスレッド
+		bool isCritical = false;      // クリティカルパス上にあるか
+	};
+
+	// 統計
+	struct Stats {
+
+		uint32_t jobCount = 0;        // ジョブの数
+		uint32_t threadCount = 0;     // 実行に使ったスレッドの数
+		float totalTimeMs = 0.0f;     // Runにかかった時間
+		float sumTimeMs = 0.0f;       // ジョブの時間の合計、1つずつ実行したときの時間
+		float criticalPathMs = 0.0f;  // クリティカルパスの時間の合計、これより短くはならない
+	};
+
+	JobGraph() = default;
+	~JobGraph() = default;
+
+	// ジョブの追加、dependenciesが全て終わってから実行される
+	JobId Add(const std::string& name, std::function<void()> function,
+		std::initializer_list<JobId> dependencies = {}, bool isMainThread = false);
+	// メインスレッドで実行するジョブの追加
+	JobId AddMainThread(const std::string& name, std::function<void()> function,
+		std::initializer_list<JobId> dependencies = {}) {
+		return Add(name, std::move(function), dependencies, true);
+	}
+
+	// 依存の追加、jobはdependencyが終わってから実行される
+	void AddDependency(JobId job, JobId dependency);
+
+	// 全てのジョブを実行する、threadCountは呼び出し元のスレッドも含めた数。全て終わるまで戻らない
+	// 実行し終えた関数は破棄するので、結果はジョブの外の変数に書き出す
+	void Run(uint32_t threadCount);
+
+	// ジョブと結果の破棄
+	void Clear();
+
+	// getter
+
+	uint32_t GetJobCount() const { return static_cast<uint32_t>(jobs_.size()); }
+	const std::string& GetName(JobId id) const { return jobs_[id].name; }
+	const Timing& GetTiming(JobId id) const { return jobs_[id].timing; }
+	// クリティカルパス、最初に実行したものから順に
+	const std::vector<JobId>& GetCriticalPath() const { return criticalPath_; }
+	const Stats& GetStats() const { return stats_; }
+
+private:
+	//====================
+	// private
+	//====================
+
+	struct Job {
+
+		std::string name;
+		std::function<void()> function;
+		bool isMainThread = false;
+
+		// このジョブを待っているジョブ
+		std::vector<JobId> successors;
+		// 依存先の数
+		uint32_t dependencyCount = 0;
+
+		Timing timing;
+	};
+
+	std::vector<Job> jobs_;
+
+	std::vector<JobId> criticalPath_;
+	Stats stats_;
+
+	// 依存の順に並べる、循環しているジョブは含まれないので数が足りなくなる
+	std::vector<JobId> SortTopologically() const;
+
+	// 実行した時間から一番長い依存の列を求める、orderはSortTopologicallyの結果
+	void BuildCriticalPath(const std::vector<JobId>& order);
+};
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "MeshCache.h"
+
+#include <chrono>
+#include <cassert>
+
+//============================================================
+// デストラクタ
+//============================================================
+MeshCache::~MeshCache() {
+
+	Finalize();
+}
+
+//============================================================
+// 初期化
+//============================================================
+void MeshCache::Initialize(IMeshFactory* factory) {
+
+	assert(factory);
+
+	Finalize();
+	factory_ = factory;
+}
+
+//============================================================
+// 終了処理
+//============================================================
+void MeshCache::Finalize() {
+
+	for (auto& entry : entries_) {
+		factory_->DestroyMesh(entry.mesh);
+	}
+
+	entries_.clear();
+	lookup_.clear();
+	stats_ = {};
+}
+
+//============================================================
+// メッシュの番号の取得
+//============================================================
+MeshId MeshCache::Get(const ProceduralMeshDesc& desc) {
+
+	assert(factory_);
+
+	// 違うlodでも分割数が同じなら同じメッシュ
+	ProceduralMeshDesc resolved = desc.Resolve();
+
+	auto& ids = lookup_[resolved.Hash()];
+	for (MeshId id : ids) {
+		if (entries_[id].desc == resolved) {
+
+			++stats_.hitCount;
+			return id;
+		}
+	}
+
+	// 初めての設定なので生成する
+	auto start = std::chrono::steady_clock::now();
+	ProceduralMeshData data = ProceduralMesh::Generate(resolved);
+	stats_.generateTimeMs += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	MeshId id = static_cast<MeshId>(entries_.size());
+	Entry& entry = entries_.emplace_back();
+	entry.desc = resolved;
+	entry.mesh = factory_->CreateMesh(data);
+	entry.vertexCount = static_cast<uint32_t>(data.vertices.size());
+	entry.indexCount = static_cast<uint32_t>(data.indices.size());
+	ids.push_back(id);
+
+	++stats_.missCount;
+	++stats_.meshCount;
+	stats_.vertexCount += entry.vertexCount;
+	stats_.indexCount += entry.indexCount;
+
+	return id;
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+#include "ProceduralMesh.h"
+
+// メッシュの番号、生成順
+using MeshId = uint32_t;
+
+//================================================
+// IMeshFactory Class
+//================================================
+/// MeshCacheが使う生成と破棄
+/// D3D12では頂点、インデックスバッファ、デバイスがない環境では記録するだけのものに差し替えられる
+class IMeshFactory {
+public:
+	//====================
+	// public
+	//====================
+
+	// 仮想デストラクタ
+	virtual ~IMeshFactory() {}
+
+	virtual void* CreateMesh(const ProceduralMeshData& data) = 0;
+	virtual void DestroyMesh(void* mesh) = 0;
+};
+
+//================================================
+// MeshCache Class
+//================================================
+/// 形状の設定をハッシュで引き、初めて使うときに生成して持ち続ける
+/// lodは分割数に反映してから引くので、同じ分割数になる要求は1つのメッシュを共有する
+/// 描画を積むメインスレッドから使う
+class MeshCache {
+public:
+	//====================
+	// public
+	//====================
+
+	// 無効な番号
+	static constexpr MeshId kInvalidId = ~0u;
+
+	// 統計
+	struct Stats {
+
+		uint32_t meshCount = 0;      // 生成済みのメッシュの数
+		uint64_t vertexCount = 0;    // 生成済みの頂点の合計
+		uint64_t indexCount = 0;     // 生成済みのインデックスの合計
+		uint64_t hitCount = 0;       // 生成済みだったGetの回数
+		uint64_t missCount = 0;      // Getで生成した回数
+		float generateTimeMs = 0.0f; // 頂点の生成にかかった時間の合計
+	};
+
+	MeshCache() = default;
+	~MeshCache();
+
+	// 生成と破棄を行うものを設定する
+	void Initialize(IMeshFactory* factory);
+	// 生成したものを全て破棄する
+	void Finalize();
+
+	// メッシュの番号の取得、初めてなら生成する
+	MeshId Get(const ProceduralMeshDesc& desc);
+
+	// getter
+
+	void* GetMesh(MeshId id) const { return entries_[id].mesh; }
+	// lodを反映済みの設定
+	const ProceduralMeshDesc& GetDesc(MeshId id) const { return entries_[id].desc; }
+	uint32_t GetVertexCount(MeshId id) const { return entries_[id].vertexCount; }
+	uint32_t GetIndexCount(MeshId id) const { return entries_[id].indexCount; }
+	const Stats& GetStats() const { return stats_; }
+
+private:
+	//====================
+	// private
+	//====================
+
+	struct Entry {
+
+		ProceduralMeshDesc desc;
+		void* mesh;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+	};
+
+	IMeshFactory* factory_ = nullptr;
+
+	// 追加しても場所が変わらないようにdeque
+	std::deque<Entry> entries_;
+	// ハッシュから番号
+	std::unordered_map<uint64_t, std::vector<MeshId>> lookup_;
+
+	Stats stats_;
+};
\ No newline at end of file
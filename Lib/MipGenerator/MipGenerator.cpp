@@ -0,0 +1,298 @@
+#include "MipGenerator.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+#include "ParallelRecorder.h"
+
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+	// 線形からsRGBへの表の大きさ、sqrt(線形)で引くので暗い所も細かく引ける
+	const uint32_t kSRGBTableSize = 4096;
+
+	// 変換表
+	struct MipTables {
+
+		// 値から線形へ [isSRGB][チャンネル * 256 + 値]、アルファは常に線形
+		float toLinear[2][4 * 256];
+		// 線形からsRGBへ [round(sqrt(線形) * (kSRGBTableSize - 1))]、gatherで引くので32bit
+		int32_t toSRGB[kSRGBTableSize];
+	};
+
+	//============================================================
+	// 変換表の作成
+	//============================================================
+	MipTables CreateTables() {
+
+		MipTables tables{};
+
+		for (uint32_t channel = 0; channel < 4; ++channel) {
+			for (uint32_t value = 0; value < 256; ++value) {
+
+				double unorm = value / 255.0;
+				double linear = unorm <= 0.04045 ? unorm / 12.92 : std::pow((unorm + 0.055) / 1.055, 2.4);
+
+				tables.toLinear[0][channel * 256 + value] = static_cast<float>(unorm);
+				tables.toLinear[1][channel * 256 + value] = static_cast<float>(channel == 3 ? unorm : linear);
+			}
+		}
+
+		for (uint32_t i = 0; i < kSRGBTableSize; ++i) {
+
+			double root = static_cast<double>(i) / (kSRGBTableSize - 1);
+			double linear = root * root;
+			double srgb = linear <= 0.0031308 ? linear * 12.92 : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+			tables.toSRGB[i] = static_cast<int32_t>(std::lround(std::clamp(srgb, 0.0, 1.0) * 255.0));
+		}
+
+		return tables;
+	}
+
+	const MipTables& GetTables() {
+
+		static const MipTables tables = CreateTables();
+		return tables;
+	}
+
+	//============================================================
+	// 行を分けるワーカー
+	//============================================================
+	// 初めて分けるときにコア数分起動し、全てのミップと画像で使い回す
+	// 同時に使えるのは1枚だけ、他の画像を作っている間は分けずに呼び出し元だけで作る
+	struct MipWorkers {
+
+		std::mutex mutex;
+		ParallelRecorder recorder;
+
+		MipWorkers() {
+			recorder.Initialize((std::max)(std::thread::hardware_concurrency(), 1u));
+		}
+	};
+
+	MipWorkers& GetWorkers() {
+
+		static MipWorkers workers;
+		return workers;
+	}
+
+	//============================================================
+	// 1ピクセル分の平均、SIMDと同じ順番で足して結果を揃える
+	//============================================================
+	void DownsamplePixel(const uint8_t* p00, const uint8_t* p01, const uint8_t* p10, const uint8_t* p11,
+		uint8_t* destination, const float* toLinear, const int32_t* toSRGB, bool isSRGB) {
+
+		for (uint32_t channel = 0; channel < 4; ++channel) {
+
+			const float* table = toLinear + channel * 256;
+			float value = ((table[p00[channel]] + table[p10[channel]]) + (table[p01[channel]] + table[p11[channel]])) * 0.25f;
+
+			if (isSRGB && channel != 3) {
+				destination[channel] = static_cast<uint8_t>(toSRGB[std::lrintf(std::sqrt(value) * float(kSRGBTableSize - 1))]);
+			} else {
+				destination[channel] = static_cast<uint8_t>(std::lrintf(value * 255.0f));
+			}
+		}
+	}
+}
+
+//============================================================
+// ミップの段数
+//============================================================
+uint32_t MipGenerator::CalculateMipLevels(uint32_t width, uint32_t height) {
+
+	uint32_t levels = 1;
+	while (width > 1 || height > 1) {
+
+		width = (std::max)(width / 2, 1u);
+		height = (std::max)(height / 2, 1u);
+		++levels;
+	}
+	return levels;
+}
+
+//============================================================
+// 縦横半分にする
+//============================================================
+void MipGenerator::Downsample(const MipSurface& source, const MipSurface& destination, const Settings& settings) {
+
+	assert(destination.width == (std::max)(source.width / 2, 1u));
+	assert(destination.height == (std::max)(source.height / 2, 1u));
+
+	// スレッドから初めて引かないように先に作っておく
+	GetTables();
+	bool useSIMD = settings.useSIMD && IsSIMDSupported();
+
+	// 小さいミップは分けない
+	uint32_t threadCount = settings.threadCount != 0 ? settings.threadCount : (std::max)(std::thread::hardware_concurrency(), 1u);
+	threadCount = (std::min)(threadCount, (std::max)(destination.height / kMinRowsPerThread, 1u));
+
+	if (threadCount <= 1) {
+		DownsampleRows(source, destination, 0, destination.height, settings.isSRGB, useSIMD);
+		return;
+	}
+
+	// 複数の画像を同時に作っているときは、既にコアが埋まっているので分けない
+	MipWorkers& workers = GetWorkers();
+	std::unique_lock<std::mutex> lock(workers.mutex, std::try_to_lock);
+	threadCount = (std::min)(threadCount, workers.recorder.GetMaxContextCount());
+	if (!lock.owns_lock() || threadCount <= 1) {
+		DownsampleRows(source, destination, 0, destination.height, settings.isSRGB, useSIMD);
+		return;
+	}
+
+	// 行を均等に分ける、呼び出し元のスレッドも範囲を受け持つ
+	workers.recorder.Record(destination.height, threadCount, [&](uint32_t, size_t begin, size_t end) {
+		DownsampleRows(source, destination, static_cast<uint32_t>(begin), static_cast<uint32_t>(end), settings.isSRGB, useSIMD);
+		});
+}
+
+//============================================================
+// 全ミップの作成
+//============================================================
+void MipGenerator::Generate(const MipSurface* levels, uint32_t levelCount, const Settings& settings) {
+
+	for (uint32_t level = 1; level < levelCount; ++level) {
+		Downsample(levels[level - 1], levels[level], settings);
+	}
+}
+
+//============================================================
+// 行の範囲の作成
+//============================================================
+void MipGenerator::DownsampleRows(const MipSurface& source, const MipSurface& destination,
+	uint32_t beginRow, uint32_t endRow, bool isSRGB, bool useSIMD) {
+
+	if (useSIMD) {
+		DownsampleRowsAVX2(source, destination, beginRow, endRow, isSRGB);
+		return;
+	}
+
+	const MipTables& tables = GetTables();
+	const float* toLinear = tables.toLinear[isSRGB ? 1 : 0];
+
+	for (uint32_t y = beginRow; y < endRow; ++y) {
+
+		// 奇数の大きさは端を繰り返す、1ピクセルの幅、高さでも同じ処理で済む
+		const uint8_t* row0 = source.pixels + size_t(2 * y) * source.rowPitch;
+		const uint8_t* row1 = source.pixels + size_t((std::min)(2 * y + 1, source.height - 1)) * source.rowPitch;
+		uint8_t* destinationRow = destination.pixels + size_t(y) * destination.rowPitch;
+
+		for (uint32_t x = 0; x < destination.width; ++x) {
+
+			size_t x0 = size_t(2 * x) * 4;
+			size_t x1 = size_t((std::min)(2 * x + 1, source.width - 1)) * 4;
+			DownsamplePixel(row0 + x0, row0 + x1, row1 + x0, row1 + x1, destinationRow + size_t(x) * 4, toLinear, tables.toSRGB, isSRGB);
+		}
+	}
+}
+
+//============================================================
+// 行の範囲の作成 AVX2
+//============================================================
+void MipGenerator::DownsampleRowsAVX2(const MipSurface& source, const MipSurface& destination,
+	uint32_t beginRow, uint32_t endRow, bool isSRGB) {
+
+	const MipTables& tables = GetTables();
+	const float* toLinear = tables.toLinear[isSRGB ? 1 : 0];
+
+	// 2ピクセル分のRGBAを1レジスタで扱う、表はチャンネルごとに256ずらして引く
+	const __m256i channelOffset = _mm256_setr_epi32(0, 256, 512, 768, 0, 256, 512, 768);
+	const __m256 quarter = _mm256_set1_ps(0.25f);
+	const __m256 unormScale = _mm256_set1_ps(255.0f);
+	const __m256 srgbScale = _mm256_set1_ps(float(kSRGBTableSize - 1));
+
+	// 1回で出力2ピクセル、入力は各行4ピクセル。幅1の入力は繰り返しが要るので残りの処理に回す
+	uint32_t simdWidth = source.width >= 2 ? destination.width & ~1u : 0;
+
+	for (uint32_t y = beginRow; y < endRow; ++y) {
+
+		const uint8_t* row0 = source.pixels + size_t(2 * y) * source.rowPitch;
+		const uint8_t* row1 = source.pixels + size_t((std::min)(2 * y + 1, source.height - 1)) * source.rowPitch;
+		uint8_t* destinationRow = destination.pixels + size_t(y) * destination.rowPitch;
+
+		uint32_t x = 0;
+		for (; x < simdWidth; x += 2) {
+
+			__m128i source0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + size_t(x) * 8));
+			__m128i source1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + size_t(x) * 8));
+
+			// 線形に直す [p0, p1]、[p2, p3]
+			__m256 a = _mm256_i32gather_ps(toLinear, _mm256_add_epi32(_mm256_cvtepu8_epi32(source0), channelOffset), 4);
+			__m256 b = _mm256_i32gather_ps(toLinear, _mm256_add_epi32(_mm256_cvtepu8_epi32(_mm_srli_si128(source0, 8)), channelOffset), 4);
+			__m256 c = _mm256_i32gather_ps(toLinear, _mm256_add_epi32(_mm256_cvtepu8_epi32(source1), channelOffset), 4);
+			__m256 d = _mm256_i32gather_ps(toLinear, _mm256_add_epi32(_mm256_cvtepu8_epi32(_mm_srli_si128(source1, 8)), channelOffset), 4);
+
+			// 縦に足してから、隣り合う2ピクセルを足す
+			__m256 vertical0 = _mm256_add_ps(a, c);
+			__m256 vertical1 = _mm256_add_ps(b, d);
+			__m256 value = _mm256_mul_ps(_mm256_add_ps(
+				_mm256_permute2f128_ps(vertical0, vertical1, 0x20),
+				_mm256_permute2f128_ps(vertical0, vertical1, 0x31)), quarter);
+
+			__m256i result = _mm256_cvtps_epi32(_mm256_mul_ps(value, unormScale));
+			if (isSRGB) {
+
+				// RGBは表でsRGBに戻す、アルファはそのまま
+				__m256i index = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_sqrt_ps(value), srgbScale));
+				__m256i srgb = _mm256_i32gather_epi32(tables.toSRGB, index, 4);
+				result = _mm256_blend_epi32(srgb, result, 0x88);
+			}
+
+			// 8bitに詰める、各レーンの先頭4バイトが1ピクセル
+			__m256i packed = _mm256_packus_epi16(_mm256_packus_epi32(result, result), _mm256_setzero_si256());
+			int32_t pixel0 = _mm_cvtsi128_si32(_mm256_castsi256_si128(packed));
+			int32_t pixel1 = _mm_cvtsi128_si32(_mm256_extracti128_si256(packed, 1));
+			std::memcpy(destinationRow + size_t(x) * 4, &pixel0, 4);
+			std::memcpy(destinationRow + size_t(x) * 4 + 4, &pixel1, 4);
+		}
+
+		// 残り
+		for (; x < destination.width; ++x) {
+
+			size_t x0 = size_t(2 * x) * 4;
+			size_t x1 = size_t((std::min)(2 * x + 1, source.width - 1)) * 4;
+			DownsamplePixel(row0 + x0, row0 + x1, row1 + x0, row1 + x1, destinationRow + size_t(x) * 4, toLinear, tables.toSRGB, isSRGB);
+		}
+	}
+}
+
+//============================================================
+// AVX2が使えるか
+//============================================================
+bool MipGenerator::IsSIMDSupported() {
+
+	static const bool isSupported = []() {
+
+#if defined(_MSC_VER)
+		int info[4]{};
+		__cpuid(info, 0);
+		if (info[0] < 7) {
+			return false;
+		}
+
+		// OSがAVXのレジスタを保存するか
+		__cpuid(info, 1);
+		bool hasOSXSave = (info[2] & (1 << 27)) != 0;
+		bool hasAVX = (info[2] & (1 << 28)) != 0;
+		if (!hasOSXSave || !hasAVX || (_xgetbv(0) & 0x6) != 0x6) {
+			return false;
+		}
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2") != 0;
+#endif
+		}();
+
+	return isSupported;
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// ミップ1段分の画像、1ピクセル4バイトで4バイト目がアルファ
+struct MipSurface {
+
+	uint8_t* pixels = nullptr;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	size_t rowPitch = 0;
+};
+
+//================================================
+// MipGenerator Class
+//================================================
+/// RGBA8、BGRA8のミップマップの作成、2x2の平均で縦横半分にする
+/// sRGBは表で線形に直してから平均し、表で戻す。縦横が2の累乗なら結果はDirectXTexのBoxフィルタと1以内の差になる
+/// それ以外の大きさはDirectXTexが別のフィルタで作るので、差は1に収まらない
+/// AVX2が使えればSIMDで処理し、行を使い回しのワーカースレッドに分ける。SIMDとそうでないもので結果は同じ
+class MipGenerator {
+public:
+	//====================
+	// public
+	//====================
+
+	// 設定
+	struct Settings {
+
+		// RGBをsRGBとして扱う、アルファは常に線形
+		bool isSRGB = true;
+		// 呼び出し元のスレッドも含めた数、0ならコア数分。ParallelRecorder::kMaxContextNumで頭打ち
+		uint32_t threadCount = 0;
+		// falseならAVX2が使えても使わない、比較用
+		bool useSIMD = true;
+	};
+
+	// 1x1までのミップの段数
+	static uint32_t CalculateMipLevels(uint32_t width, uint32_t height);
+
+	// sourceを縦横半分にしてdestinationに書く、destinationの大きさはsourceの半分で最小1
+	// 奇数の大きさは最後の行、列を落とす
+	// 複数のスレッドから呼んでよい、他のスレッドがワーカーを使っている間は分けずに作る
+	static void Downsample(const MipSurface& source, const MipSurface& destination, const Settings& settings);
+
+	// levels[0]から順に下のミップを作る
+	static void Generate(const MipSurface* levels, uint32_t levelCount, const Settings& settings);
+
+	// AVX2が使えるか
+	static bool IsSIMDSupported();
+
+private:
+	//====================
+	// private
+	//====================
+
+	// 1スレッドに割り当てる行の最小、小さいミップは分けない
+	static const uint32_t kMinRowsPerThread = 64;
+
+	// destinationの[beginRow, endRow)を作る
+	static void DownsampleRows(const MipSurface& source, const MipSurface& destination,
+		uint32_t beginRow, uint32_t endRow, bool isSRGB, bool useSIMD);
+	static void DownsampleRowsAVX2(const MipSurface& source, const MipSurface& destination,
+		uint32_t beginRow, uint32_t endRow, bool isSRGB);
+};
\ No newline at end of file
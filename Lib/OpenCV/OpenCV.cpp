@@ -3,7 +3,10 @@
 //============================================================
 // コンストラクタ
 //============================================================
-OpenCV::OpenCV() : cap_(0) {
+OpenCV::OpenCV() : OpenCV(std::make_unique<CameraFrameSource>(0, kFrameWidth, kFrameHeight, 60.0)) {
+}
+
+OpenCV::OpenCV(std::unique_ptr<IFrameSource> source) : source_(std::move(source)) {
 
 	Initialize();
 }
@@ -20,20 +23,22 @@ OpenCV::~OpenCV() {
 //============================================================
 void OpenCV::Initialize() {
 
+	// 2回目は読み込みをやり直す
+	capture_.Stop();
+
 	// ウィンドウの名前
 	cv::namedWindow("OpenCV Window", cv::WINDOW_AUTOSIZE);
 
 	// カメラが開けなかったら
-	if (!cap_.isOpened()) {
+	if (!source_ || !source_->IsOpened()) {
 
 		// エラーメッセージを表示する
 		std::cerr << "Failed to open camera!" << std::endl;
+		return;
 	}
 
-	// カメラウィンドウのサイズ
-	cap_.set(cv::CAP_PROP_FRAME_WIDTH, 640);  // 横幅
-	cap_.set(cv::CAP_PROP_FRAME_HEIGHT, 360); // 縦幅
-	cap_.set(cv::CAP_PROP_FPS, 60);           // フレームレート (FPS)
+	// 読み込みと検出は専用のスレッドで行う
+	capture_.Start(source_.get());
 }
 
 //============================================================
@@ -41,26 +46,16 @@ void OpenCV::Initialize() {
 //============================================================
 void OpenCV::Update() {
 
-	// ウェブカメラからの画像データの読み込み
-	cap_ >> frame_;
-
-	if (frame_.empty()) {
+	// 処理スレッドの新しい結果を受け取る、なければ前のまま。カメラは待たない
+	if (!capture_.Receive()) {
 		return;
 	}
 
-	// 取得したフレームの左右反転
-	cv::flip(frame_, frame_, 1);
-
-	// 平滑化処理 (ガウシアンブラー)
-	cv::GaussianBlur(frame_, frame_, cv::Size(5, 5), 0);
-
-	// QRコードの検出とデコード
-	decodedText_ = qrDecoder_.detectAndDecode(frame_);
-
-	if (!decodedText_.empty()) {
+	const QRCapture::Result& result = capture_.GetResult();
+	if (!result.decodedText.empty()) {
 
 		// 新しいQRコードデータを追加
-		qrCodeData_.push_back(decodedText_);
+		qrCodeData_.push_back(result.decodedText);
 	}
 }
 
@@ -69,8 +64,14 @@ void OpenCV::Update() {
 //============================================================
 void OpenCV::Draw() {
 
+	// 最後に受け取ったフレーム、Receiveするまで処理スレッドは書き換えない
+	const cv::Mat& frame = capture_.GetResult().frame;
+	if (frame.empty()) {
+		return;
+	}
+
 	// 画像(今回はカメラのフレーム)、ウィンドウの表示
-	cv::imshow("OpenCV Window", frame_);
+	cv::imshow("OpenCV Window", frame);
 }
 
 //============================================================
@@ -78,9 +79,11 @@ void OpenCV::Draw() {
 //============================================================
 void OpenCV::Finalize() {
 
-	if (cap_.isOpened()) {
-		cap_.release();
-	}
+	// 読み込みスレッドが使っているので先に止める
+	capture_.Stop();
+
+	// カメラを閉じる
+	source_.reset();
 	cv::destroyAllWindows();
 }
 
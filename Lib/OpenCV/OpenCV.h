@@ -8,10 +8,12 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 #include <iostream>
 #include <fstream>
 
 #include "Function.h"
+#include "QRCapture.h"
 
 /// cvの省略
 using namespace cv;
@@ -31,14 +33,18 @@ using namespace cv;
 //================================================
 // OpenCV Class
 //================================================
+/// カメラの読み込みとQRコードの検出はQRCaptureのスレッドで行い、Updateでは結果を受け取るだけ
+/// 描画ループはカメラのフレームレートを待たない。読み込み元を渡せばカメラの代わりに動画や合成したフレームを使う
 class OpenCV {
 public:
 	//====================
 	// public
 	//====================
 
-	// コンストラクタ
+	// コンストラクタ、カメラから読む
 	OpenCV();
+	// sourceから読む
+	OpenCV(std::unique_ptr<IFrameSource> source);
 	// デストラクタ
 	~OpenCV();
 
@@ -57,28 +63,25 @@ public:
 	// getter
 
 	std::string GetQRCodeData();
+	// 読み込みと検出の統計
+	QRCapture::Stats GetCaptureStats() const { return capture_.GetStats(); }
+	// 最後に受け取ったフレームの赤の範囲のマスク、前処理で一緒に作る
+	const cv::Mat& GetRedMask() const { return capture_.GetResult().mask; }
 
 private:
 	//====================
 	// private
 	//====================
 
-	// カメラキャプチャ
-	cv::VideoCapture cap_;
+	// カメラのフレームの大きさ
+	static const uint32_t kFrameWidth = 640;
+	static const uint32_t kFrameHeight = 360;
 
-	// OpenCVで画像を表すための基本的なデータ型
-	cv::Mat
-		frame_,    // カメラからキャプチャしたフレーム(画像データ)の保持
-		hsvFrame_, // BGR色空間からHSV色空間に変換したフレームの保持
-		mask1_,    // 赤色の第1範囲に該当するピクセルを抽出するためのマスク(バイナリ画像)の保持
-		mask2_,    // 赤色の第2範囲に該当するピクセルを抽出するためのマスク(バイナリ画像)の保持
-		mask_;     // mask1とmask2を論理和(OR)した結果を保持するマスク(バイナリ画像)の保持
+	// 読み込み元、読み込みスレッドだけが読む。スレッドより先に破棄しない
+	std::unique_ptr<IFrameSource> source_;
+	// 読み込みと検出のスレッド
+	QRCapture capture_;
 
-	// QRコード検出器
-	cv::QRCodeDetector qrDecoder_;
-
-	// デコード結果を保持する変数
-	std::string decodedText_;
 	// 複数のQRコードデータを保持するベクター
 	std::vector<std::string> qrCodeData_;
 };
\ No newline at end of file
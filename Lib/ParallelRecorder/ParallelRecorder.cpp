@@ -0,0 +1,160 @@
+#include "ParallelRecorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cassert>
+
+//============================================================
+// デストラクタ
+//============================================================
+ParallelRecorder::~ParallelRecorder() {
+
+	Finalize();
+}
+
+//============================================================
+// 初期化
+//============================================================
+void ParallelRecorder::Initialize(uint32_t contextCount) {
+
+	assert(workers_.empty());
+
+	maxContextCount_ = std::clamp(contextCount, 1u, kMaxContextNum);
+	exit_ = false;
+
+	// 呼び出し元のスレッドも記録するので1つ少なく起動する
+	for (uint32_t i = 1; i < maxContextCount_; ++i) {
+
+		workers_.emplace_back(&ParallelRecorder::WorkerLoop, this);
+	}
+}
+
+//============================================================
+// 終了処理
+//============================================================
+void ParallelRecorder::Finalize() {
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		exit_ = true;
+	}
+	workCondition_.notify_all();
+
+	for (auto& worker : workers_) {
+
+		worker.join();
+	}
+	workers_.clear();
+}
+
+//============================================================
+// 使用する記録先の数
+//============================================================
+uint32_t ParallelRecorder::CalculateContextCount(size_t itemCount) const {
+
+	size_t count = itemCount / (std::max)(minItemsPerContext_, 1u);
+	return static_cast<uint32_t>(std::clamp<size_t>(count, 1, maxContextCount_));
+}
+
+//============================================================
+// 記録
+//============================================================
+void ParallelRecorder::Record(size_t itemCount, uint32_t contextCount, const RecordFunction& recordFunction) {
+
+	assert(contextCount >= 1 && contextCount <= maxContextCount_);
+
+	auto start = std::chrono::steady_clock::now();
+
+	if (contextCount == 1) {
+
+		// 分けないならスレッドを起こさない
+		recordFunction(0, 0, itemCount);
+	} else {
+
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+
+			// 前の記録から抜けきっていないワーカーがいれば待つ
+			doneCondition_.wait(lock, [this]() { return activeWorkerCount_ == 0; });
+
+			recordFunction_ = &recordFunction;
+			itemCount_ = itemCount;
+			contextCount_ = contextCount;
+			nextContext_ = 0;
+			finishedContextCount_ = 0;
+			generation_++;
+		}
+		workCondition_.notify_all();
+
+		// 呼び出し元も手伝う
+		RecordRanges();
+
+		// 全ての範囲が終わり、ワーカーが記録から抜けるまで待つ
+		std::unique_lock<std::mutex> lock(mutex_);
+		doneCondition_.wait(lock, [this]() {
+			return finishedContextCount_ == contextCount_ && activeWorkerCount_ == 0;
+			});
+		recordFunction_ = nullptr;
+	}
+
+	// 統計の更新
+	stats_.itemCount = static_cast<uint32_t>(itemCount);
+	stats_.contextCount = contextCount;
+	stats_.recordTimeMs =
+		std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+//============================================================
+// ワーカースレッドの処理
+//============================================================
+void ParallelRecorder::WorkerLoop() {
+
+	uint64_t generation = 0;
+
+	while (true) {
+
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			workCondition_.wait(lock, [&]() { return exit_ || generation_ != generation; });
+
+			if (exit_) {
+				return;
+			}
+			generation = generation_;
+			activeWorkerCount_++;
+		}
+
+		RecordRanges();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			activeWorkerCount_--;
+		}
+		doneCondition_.notify_all();
+	}
+}
+
+//============================================================
+// 範囲の記録
+//============================================================
+void ParallelRecorder::RecordRanges() {
+
+	while (true) {
+
+		// どのスレッドが取っても、範囲と記録先の対応は番号で決まる
+		uint32_t contextIndex = nextContext_.fetch_add(1);
+		if (contextIndex >= contextCount_) {
+			return;
+		}
+
+		size_t begin = itemCount_ * contextIndex / contextCount_;
+		size_t end = itemCount_ * (contextIndex + 1) / contextCount_;
+		(*recordFunction_)(contextIndex, begin, end);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			finishedContextCount_++;
+		}
+		doneCondition_.notify_all();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+//================================================
+// ParallelRecorder Class
+//================================================
+/// 描画リストを連続した範囲に分け、ワーカースレッドで同時に記録する
+/// 範囲iは必ず記録先iに書かれるので、記録先を番号順に提出すれば結果はスレッド数によらない
+class ParallelRecorder {
+public:
+	//====================
+	// public
+	//====================
+
+	// 記録先の最大数
+	static constexpr uint32_t kMaxContextNum = 8;
+
+	// 範囲の記録、contextIndexの記録先に[begin, end)を書く
+	using RecordFunction = std::function<void(uint32_t contextIndex, size_t begin, size_t end)>;
+
+	// 統計
+	struct Stats {
+
+		uint32_t itemCount = 0;      // 記録した数
+		uint32_t contextCount = 0;   // 使用した記録先の数
+		float recordTimeMs = 0.0f;   // 記録にかかった時間
+	};
+
+	ParallelRecorder() = default;
+	~ParallelRecorder();
+
+	// 初期化、contextCountは呼び出し元のスレッドも含めた記録先の数
+	void Initialize(uint32_t contextCount);
+
+	// 終了処理、ワーカースレッドを止める
+	void Finalize();
+
+	// 記録に使う記録先の数、少ない数を分けてもスレッドの起動の方が高くつく
+	uint32_t CalculateContextCount(size_t itemCount) const;
+
+	// itemCount個をcontextCount個の範囲に分けて記録する。全て終わるまで戻らない
+	void Record(size_t itemCount, uint32_t contextCount, const RecordFunction& recordFunction);
+
+	// getter
+
+	uint32_t GetMaxContextCount() const { return maxContextCount_; }
+	const Stats& GetStats() const { return stats_; }
+
+	// setter
+
+	// 1つの記録先に最低限割り当てる数
+	void SetMinItemsPerContext(uint32_t minItemsPerContext) { minItemsPerContext_ = minItemsPerContext; }
+
+private:
+	//====================
+	// private
+	//====================
+
+	std::vector<std::thread> workers_;
+	uint32_t maxContextCount_ = 1;
+	uint32_t minItemsPerContext_ = 64;
+
+	// 現在の記録
+	std::mutex mutex_;
+	std::condition_variable workCondition_;
+	std::condition_variable doneCondition_;
+	const RecordFunction* recordFunction_ = nullptr;
+	size_t itemCount_ = 0;
+	uint32_t contextCount_ = 0;
+	// 記録の世代、ワーカーが新しい記録に気づくのに使う
+	uint64_t generation_ = 0;
+	// 次に取る範囲の番号
+	std::atomic<uint32_t> nextContext_ = 0;
+	uint32_t finishedContextCount_ = 0;
+	// RecordRangesの中にいるワーカーの数、0になるまで次の記録を始めない
+	uint32_t activeWorkerCount_ = 0;
+	bool exit_ = false;
+
+	Stats stats_;
+
+	// ワーカースレッドの処理
+	void WorkerLoop();
+
+	// 残っている範囲を取って記録する
+	void RecordRanges();
+};
\ No newline at end of file
@@ -0,0 +1,256 @@
+#include "PipelineCache.h"
+
+#include <cassert>
+
+//============================================================
+// namespace
+//============================================================
+namespace {
+
+	// FNV-1a
+	const uint64_t kHashOffset = 14695981039346656037ull;
+	const uint64_t kHashPrime = 1099511628211ull;
+
+	void HashBytes(uint64_t& hash, const void* data, size_t size) {
+
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; ++i) {
+			hash ^= bytes[i];
+			hash *= kHashPrime;
+		}
+	}
+
+	// 構造体の隙間を混ぜないよう、値を1つずつ混ぜる
+	void HashValue(uint64_t& hash, uint32_t value) {
+
+		HashBytes(hash, &value, sizeof(value));
+	}
+}
+
+//============================================================
+// ルートパラメータの追加
+//============================================================
+uint32_t PipelineRootLayout::Add(PipelineRootParameterType type, PipelineShaderVisibility visibility,
+	uint32_t shaderRegister, uint32_t registerSpace, uint32_t descriptorCount) {
+
+	assert(parameterCount < kMaxRootParameterNum);
+
+	parameters[parameterCount] = { type, visibility, shaderRegister, registerSpace, descriptorCount };
+	return parameterCount++;
+}
+
+//============================================================
+// 設定のハッシュ
+//============================================================
+uint64_t PipelineDesc::Hash() const {
+
+	uint64_t hash = kHashOffset;
+
+	HashValue(hash, static_cast<uint32_t>(shader.size()));
+	HashBytes(hash, shader.data(), shader.size());
+	HashValue(hash, inputElements);
+
+	HashValue(hash, rootLayout.parameterCount);
+	for (uint32_t i = 0; i < rootLayout.parameterCount; ++i) {
+
+		const PipelineRootParameter& parameter = rootLayout.parameters[i];
+		HashValue(hash, static_cast<uint32_t>(parameter.type));
+		HashValue(hash, static_cast<uint32_t>(parameter.visibility));
+		HashValue(hash, parameter.shaderRegister);
+		HashValue(hash, parameter.registerSpace);
+		HashValue(hash, parameter.descriptorCount);
+	}
+	HashValue(hash, rootLayout.useSampler ? 1u : 0u);
+
+	HashValue(hash, static_cast<uint32_t>(blendMode));
+	HashValue(hash, static_cast<uint32_t>(cullMode));
+	HashValue(hash, depthWrite ? 1u : 0u);
+	HashValue(hash, renderTargetFormat);
+	HashValue(hash, depthStencilFormat);
+
+	return hash;
+}
+
+//============================================================
+// 設定の比較
+//============================================================
+bool PipelineDesc::operator==(const PipelineDesc& other) const {
+
+	if (shader != other.shader || inputElements != other.inputElements ||
+		blendMode != other.blendMode || cullMode != other.cullMode || depthWrite != other.depthWrite ||
+		renderTargetFormat != other.renderTargetFormat || depthStencilFormat != other.depthStencilFormat ||
+		rootLayout.parameterCount != other.rootLayout.parameterCount || rootLayout.useSampler != other.rootLayout.useSampler) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < rootLayout.parameterCount; ++i) {
+
+		const PipelineRootParameter& a = rootLayout.parameters[i];
+		const PipelineRootParameter& b = other.rootLayout.parameters[i];
+		if (a.type != b.type || a.visibility != b.visibility || a.shaderRegister != b.shaderRegister ||
+			a.registerSpace != b.registerSpace || a.descriptorCount != b.descriptorCount) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//============================================================
+// デストラクタ
+//============================================================
+PipelineCache::~PipelineCache() {
+
+	Finalize();
+}
+
+//============================================================
+// 初期化
+//============================================================
+void PipelineCache::Initialize(IPipelineFactory* factory) {
+
+	assert(factory);
+
+	Finalize();
+	factory_ = factory;
+}
+
+//============================================================
+// 終了処理
+//============================================================
+void PipelineCache::Finalize() {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	for (auto& entry : entries_) {
+
+		void* pipeline = entry.pipeline.exchange(nullptr);
+		if (pipeline) {
+			factory_->DestroyPipeline(pipeline);
+		}
+	}
+
+	entries_.clear();
+	lookup_.clear();
+
+	duplicateCount_ = 0;
+	collisionCount_ = 0;
+	hitCount_ = 0;
+	missCount_ = 0;
+}
+
+//============================================================
+// 設定の登録
+//============================================================
+PipelineId PipelineCache::Register(const PipelineDesc& desc) {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	uint64_t hash = desc.Hash();
+	auto& ids = lookup_[hash];
+	for (PipelineId id : ids) {
+		if (entries_[id].desc == desc) {
+			++duplicateCount_;
+			return id;
+		}
+	}
+
+	// ハッシュだけ同じで中身が違う
+	if (!ids.empty()) {
+		++collisionCount_;
+	}
+
+	PipelineId id = static_cast<PipelineId>(entries_.size());
+	Entry& entry = entries_.emplace_back();
+	entry.desc = desc;
+	entry.hash = hash;
+	entry.pipeline = nullptr;
+
+	ids.push_back(id);
+	return id;
+}
+
+//============================================================
+// 登録済みの設定の番号
+//============================================================
+PipelineId PipelineCache::Find(const PipelineDesc& desc) const {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	auto it = lookup_.find(desc.Hash());
+	if (it == lookup_.end()) {
+		return kInvalidId;
+	}
+
+	for (PipelineId id : it->second) {
+		if (entries_[id].desc == desc) {
+			return id;
+		}
+	}
+
+	return kInvalidId;
+}
+
+//============================================================
+// パイプラインの取得
+//============================================================
+void* PipelineCache::Get(PipelineId id) {
+
+	assert(id < entries_.size());
+	Entry& entry = entries_[id];
+
+	// 生成済みならロックしない
+	void* pipeline = entry.pipeline.load(std::memory_order_acquire);
+	if (pipeline) {
+		hitCount_.fetch_add(1, std::memory_order_relaxed);
+		return pipeline;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	// 待っている間に他のスレッドが生成したかもしれない
+	pipeline = entry.pipeline.load(std::memory_order_acquire);
+	if (pipeline) {
+		hitCount_.fetch_add(1, std::memory_order_relaxed);
+		return pipeline;
+	}
+
+	pipeline = factory_->CreatePipeline(entry.desc);
+	assert(pipeline);
+	entry.pipeline.store(pipeline, std::memory_order_release);
+	++missCount_;
+
+	return pipeline;
+}
+
+//============================================================
+// 全て生成
+//============================================================
+void PipelineCache::CreateAll() {
+
+	for (PipelineId id = 0; id < entries_.size(); ++id) {
+		Get(id);
+	}
+}
+
+//============================================================
+// 統計
+//============================================================
+PipelineCache::Stats PipelineCache::GetStats() const {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	Stats stats{};
+	stats.registeredCount = static_cast<uint32_t>(entries_.size());
+	for (const auto& entry : entries_) {
+		if (entry.pipeline.load(std::memory_order_acquire)) {
+			++stats.createdCount;
+		}
+	}
+	stats.duplicateCount = duplicateCount_;
+	stats.collisionCount = collisionCount_;
+	stats.hitCount = hitCount_.load(std::memory_order_relaxed);
+	stats.missCount = missCount_;
+
+	return stats;
+}
\ No newline at end of file
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <array>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+// パイプラインの番号、登録順
+using PipelineId = uint32_t;
+
+// 頂点の要素、組み合わせて使う
+enum PipelineInputElement : uint32_t {
+
+	PIPELINE_INPUT_POSITION = 1 << 0, // float4
+	PIPELINE_INPUT_TEXCOORD = 1 << 1, // float2
+	PIPELINE_INPUT_NORMAL = 1 << 2,   // float3
+};
+
+// ブレンド
+enum class PipelineBlendMode : uint32_t {
+
+	NONE,  // 上書き
+	ALPHA, // アルファブレンド
+	ADD,   // 加算
+};
+
+// カリング
+enum class PipelineCullMode : uint32_t {
+
+	NONE,
+	FRONT,
+	BACK,
+};
+
+// ルートパラメータの種類
+enum class PipelineRootParameterType : uint32_t {
+
+	CONSTANTBUFFER,  // ルートCBV
+	SHADERRESOURCE,  // ルートSRV
+	DESCRIPTORTABLE, // SRVのディスクリプタテーブル
+};
+
+// 使うシェーダー
+enum class PipelineShaderVisibility : uint32_t {
+
+	ALL,
+	VERTEX,
+	PIXEL,
+};
+
+// ルートパラメータ1つ分
+struct PipelineRootParameter {
+
+	PipelineRootParameterType type;
+	PipelineShaderVisibility visibility;
+	uint32_t shaderRegister;
+	uint32_t registerSpace;
+	// DESCRIPTORTABLEのディスクリプタ数、~0uで無制限
+	uint32_t descriptorCount;
+};
+
+// ルートシグネチャの設定
+struct PipelineRootLayout {
+
+	// ルートパラメータの最大数
+	static const uint32_t kMaxRootParameterNum = 5;
+
+	std::array<PipelineRootParameter, kMaxRootParameterNum> parameters{};
+	uint32_t parameterCount = 0;
+	// s0にバイリニアのサンプラーを置くか
+	bool useSampler = false;
+
+	// ルートパラメータの追加、番号を返す
+	uint32_t Add(PipelineRootParameterType type, PipelineShaderVisibility visibility,
+		uint32_t shaderRegister, uint32_t registerSpace = 0, uint32_t descriptorCount = 1);
+};
+
+// パイプラインの設定、これが同じなら同じパイプラインになる
+struct PipelineDesc {
+
+	// シェーダー名、./Resources/Shaders/{shader}.VS.hlslと.PS.hlslを使う
+	std::string shader;
+	// PipelineInputElementの組み合わせ
+	uint32_t inputElements = PIPELINE_INPUT_POSITION;
+	PipelineRootLayout rootLayout;
+	PipelineBlendMode blendMode = PipelineBlendMode::ALPHA;
+	PipelineCullMode cullMode = PipelineCullMode::BACK;
+	bool depthWrite = true;
+	// DXGI_FORMAT
+	uint32_t renderTargetFormat = 0;
+	uint32_t depthStencilFormat = 0;
+
+	// 設定全体のハッシュ
+	uint64_t Hash() const;
+
+	bool operator==(const PipelineDesc& other) const;
+};
+
+//================================================
+// IPipelineFactory Class
+//================================================
+/// PipelineCacheが使う生成と破棄
+/// D3D12ではPSOとルートシグネチャ、デバイスがない環境では記録するだけのものに差し替えられる
+class IPipelineFactory {
+public:
+	//====================
+	// public
+	//====================
+
+	// 仮想デストラクタ
+	virtual ~IPipelineFactory() {}
+
+	virtual void* CreatePipeline(const PipelineDesc& desc) = 0;
+	virtual void DestroyPipeline(void* pipeline) = 0;
+};
+
+//================================================
+// PipelineCache Class
+//================================================
+/// パイプラインの設定をハッシュで引き、初めて使うときに生成して持ち続ける
+/// 同じ設定の登録は同じ番号を返すので、組み合わせが増えても重複して作らない
+/// Getは並列記録の各スレッドから呼べる。Registerは記録中には呼ばない
+class PipelineCache {
+public:
+	//====================
+	// public
+	//====================
+
+	// 無効な番号
+	static constexpr PipelineId kInvalidId = ~0u;
+
+	// 統計
+	struct Stats {
+
+		uint32_t registeredCount = 0; // 登録された設定の数
+		uint32_t createdCount = 0;    // 生成済みの数
+		uint32_t duplicateCount = 0;  // 登録済みの設定を登録し直した回数
+		uint32_t collisionCount = 0;  // ハッシュが同じで設定が違った回数
+		uint64_t hitCount = 0;        // 生成済みだったGetの回数
+		uint64_t missCount = 0;       // Getで生成した回数
+	};
+
+	PipelineCache() = default;
+	~PipelineCache();
+
+	// 生成と破棄を行うものを設定する
+	void Initialize(IPipelineFactory* factory);
+	// 生成したものを全て破棄する
+	void Finalize();
+
+	// 設定の登録、生成はしない。同じ設定なら同じ番号を返す
+	PipelineId Register(const PipelineDesc& desc);
+	// 登録済みの設定の番号、なければkInvalidId
+	PipelineId Find(const PipelineDesc& desc) const;
+
+	// パイプラインの取得、初めてなら生成する
+	void* Get(PipelineId id);
+
+	// 登録済みのものを全て生成しておく、ロード中に呼ぶと描画中に生成しなくて済む
+	void CreateAll();
+
+	// getter
+
+	const PipelineDesc& GetDesc(PipelineId id) const { return entries_[id].desc; }
+	bool IsCreated(PipelineId id) const { return entries_[id].pipeline.load(std::memory_order_acquire) != nullptr; }
+	Stats GetStats() const;
+
+private:
+	//====================
+	// private
+	//====================
+
+	struct Entry {
+
+		PipelineDesc desc;
+		uint64_t hash;
+		std::atomic<void*> pipeline;
+	};
+
+	IPipelineFactory* factory_ = nullptr;
+
+	// 追加しても場所が変わらないようにdeque
+	std::deque<Entry> entries_;
+	// ハッシュから番号
+	std::unordered_map<uint64_t, std::vector<PipelineId>> lookup_;
+
+	// 生成は1つずつ
+	mutable std::mutex mutex_;
+
+	uint32_t duplicateCount_ = 0;
+	uint32_t collisionCount_ = 0;
+	std::atomic<uint64_t> hitCount_ = 0;
+	uint64_t missCount_ = 0;
+};
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "PrimitiveBatcher.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <cmath>
+
+//============================================================
+// 同じ描画にまとめられるか
+//============================================================
+bool PrimitiveBatchKey::IsBatchableWith(const PrimitiveBatchKey& other) const {
+
+	// パイプライン、テクスチャが同じ
+	if (pipelineType != other.pipelineType ||
+		textureName != other.textureName ||
+		hasLight != other.hasLight ||
+		hasCamera != other.hasCamera) {
+		return false;
+	}
+
+	// CBufferはどちらも同じ値からコピーしたものなので、バイト単位で比べる
+	if (std::memcmp(&material, &other.material, sizeof(Material)) != 0) {
+		return false;
+	}
+
+	// ビュープロジェクション行列はWVPから戻したもので、物体ごとに丸め誤差がある
+	// 要素の大きさに対して十分に近ければ同じカメラとみなす
+	float scale = 1.0f;
+	for (uint32_t row = 0; row < 4; ++row) {
+		for (uint32_t column = 0; column < 4; ++column) {
+			scale = (std::max)(scale, std::fabs(viewProjection.m[row][column]));
+		}
+	}
+	for (uint32_t row = 0; row < 4; ++row) {
+		for (uint32_t column = 0; column < 4; ++column) {
+			if (std::fabs(viewProjection.m[row][column] - other.viewProjection.m[row][column]) > scale * kViewProjectionTolerance) {
+				return false;
+			}
+		}
+	}
+
+	if (hasLight && std::memcmp(&light, &other.light, sizeof(DirectionalLight)) != 0) {
+		return false;
+	}
+
+	return !hasCamera || std::memcmp(&camera, &other.camera, sizeof(CameraViewData)) == 0;
+}
+
+//============================================================
+// 頂点をワールド座標に変換
+//============================================================
+bool PrimitiveBatcher::BakeWorld(const TransformationMatrix& matrix, VertexData* vertices, uint32_t vertexCount, Matrix4x4& viewProjection) {
+
+	const Matrix4x4& world = matrix.World;
+
+	// 拡縮、回転の部分の行列式、0なら潰れている
+	float determinant =
+		world.m[0][0] * (world.m[1][1] * world.m[2][2] - world.m[1][2] * world.m[2][1]) -
+		world.m[0][1] * (world.m[1][0] * world.m[2][2] - world.m[1][2] * world.m[2][0]) +
+		world.m[0][2] * (world.m[1][0] * world.m[2][1] - world.m[1][1] * world.m[2][0]);
+	if (!(std::fabs(determinant) > kMinDeterminant)) {
+		return false;
+	}
+
+	// WVP = World * VP
+	viewProjection = Multiply(Inverse(world), matrix.WVP);
+
+	for (uint32_t i = 0; i < vertexCount; ++i) {
+
+		// 位置は行列全体、法線は拡縮、回転の部分だけ。シェーダーと同じく正規化は描画時に行う
+		Vector4 pos = vertices[i].pos;
+		Vector3 normal = vertices[i].normal;
+		vertices[i].pos = {
+			pos.x * world.m[0][0] + pos.y * world.m[1][0] + pos.z * world.m[2][0] + pos.w * world.m[3][0],
+			pos.x * world.m[0][1] + pos.y * world.m[1][1] + pos.z * world.m[2][1] + pos.w * world.m[3][1],
+			pos.x * world.m[0][2] + pos.y * world.m[1][2] + pos.z * world.m[2][2] + pos.w * world.m[3][2],
+			pos.x * world.m[0][3] + pos.y * world.m[1][3] + pos.z * world.m[2][3] + pos.w * world.m[3][3] };
+		vertices[i].normal = {
+			normal.x * world.m[0][0] + normal.y * world.m[1][0] + normal.z * world.m[2][0],
+			normal.x * world.m[0][1] + normal.y * world.m[1][1] + normal.z * world.m[2][1],
+			normal.x * world.m[0][2] + normal.y * world.m[1][2] + normal.z * world.m[2][2] };
+	}
+
+	return true;
+}
+
+//============================================================
+// 描画の追加
+//============================================================
+void PrimitiveBatcher::Add(const PrimitiveBatchKey& key, const void* vertices, uint32_t vertexCount, uint32_t vertexStride) {
+
+	// 書き込み先が設定されていない
+	assert(arena_);
+
+	if (vertexCount == 0) {
+		return;
+	}
+
+	// 頂点の番号で指定するので、ストライドの倍数の位置に置く
+	GeometryAllocation allocation = arena_->Allocate(static_cast<uint64_t>(vertexCount) * vertexStride, vertexStride);
+	assert(allocation.IsValid());
+	std::memcpy(allocation.cpuAddress, vertices, static_cast<size_t>(vertexCount) * vertexStride);
+
+	uint32_t startVertex = static_cast<uint32_t>(allocation.offset / vertexStride);
+
+	// 条件が変わる、またはページが変わって続きに置けなかったら先に発行する
+	if (pending_.primitiveCount != 0 &&
+		(!pendingKey_.IsBatchableWith(key) ||
+			pending_.vertexBufferAddress != allocation.pageAddress ||
+			pending_.vertexStride != vertexStride ||
+			pending_.startVertex + pending_.vertexCount != startVertex)) {
+
+		Flush();
+	}
+
+	if (pending_.primitiveCount == 0) {
+
+		// 最初の描画の条件を保持
+		pendingKey_ = key;
+
+		pending_.vertexBufferAddress = allocation.pageAddress;
+		pending_.vertexBufferSize = static_cast<uint32_t>(allocation.pageSize);
+		pending_.vertexStride = vertexStride;
+		pending_.startVertex = startVertex;
+	}
+
+	pending_.vertexCount += vertexCount;
+	pending_.primitiveCount++;
+
+	stats_.primitives++;
+	stats_.vertices += vertexCount;
+}
+
+//============================================================
+// 溜まっている描画を発行
+//============================================================
+void PrimitiveBatcher::Flush() {
+
+	if (pending_.primitiveCount == 0) {
+		return;
+	}
+
+	// 発行先が設定されていない
+	assert(flushFunction_);
+
+	flushFunction_(pendingKey_, pending_);
+
+	// 統計の更新
+	stats_.drawCalls++;
+	stats_.maxPrimitivesPerDraw = (std::max)(stats_.maxPrimitivesPerDraw, pending_.primitiveCount);
+
+	pending_ = {};
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <string>
+#include <functional>
+#include <cstdint>
+
+#include "DrawData.h"
+#include "GeometryArena.h"
+
+// 三角形などの即時描画のまとめ条件
+struct PrimitiveBatchKey {
+
+	// ビュープロジェクション行列を同じとみなす差、一番大きい要素に対する割合
+	// 逆行列で戻した誤差は大きさ0.1から10、±100の範囲に置いたもので2e-5程度
+	static constexpr float kViewProjectionTolerance = 1.0e-4f;
+
+	uint32_t pipelineType = 0;   // パイプラインの種類
+	std::string textureName;     // テクスチャの名前
+
+	// CBufferの値、全て一致すればまとめられる
+	Material material{};
+	// 頂点はワールド座標に変換して詰めるので、行列はカメラのビュープロジェクションだけを持つ
+	Matrix4x4 viewProjection{};
+	// 持たないものもある
+	bool hasLight = false;
+	DirectionalLight light{};
+	bool hasCamera = false;
+	CameraViewData camera{};
+
+	// 同じ描画にまとめられるか
+	bool IsBatchableWith(const PrimitiveBatchKey& other) const;
+};
+
+// まとめた描画1回分
+struct PrimitiveBatch {
+
+	// 頂点バッファ、アリーナのページ全体
+	uint64_t vertexBufferAddress = 0;
+	uint32_t vertexBufferSize = 0;
+	uint32_t vertexStride = 0;
+
+	uint32_t startVertex = 0;
+	uint32_t vertexCount = 0;
+	// まとめたプリミティブの数
+	uint32_t primitiveCount = 0;
+};
+
+//================================================
+// PrimitiveBatcher Class
+//================================================
+/// 三角形、三角錐などの頂点をGeometryArenaに詰め、連続する同じ条件の描画を1回のDrawにまとめる
+/// 数の上限はなく、アリーナが足りなければ大きくなる。GPUには触らないのでデバイスなしで動作する
+class PrimitiveBatcher {
+public:
+	//====================
+	// public
+	//====================
+
+	// まとめた結果を受け取る関数
+	using FlushFunction = std::function<void(const PrimitiveBatchKey& key, const PrimitiveBatch& batch)>;
+
+	// 統計
+	struct Stats {
+
+		uint32_t primitives = 0;            // 受け付けたプリミティブ数
+		uint32_t vertices = 0;              // 書き込んだ頂点数
+		uint32_t drawCalls = 0;             // 実際に発行したDrawCall数
+		uint32_t maxPrimitivesPerDraw = 0;  // 1回の描画の最大プリミティブ数
+
+		// 1回の描画あたりのプリミティブ数
+		float GetPrimitivesPerDraw() const {
+			return drawCalls ? static_cast<float>(primitives) / static_cast<float>(drawCalls) : 0.0f;
+		}
+	};
+
+	PrimitiveBatcher() = default;
+	~PrimitiveBatcher() = default;
+
+	// 頂点をmatrix.Worldでワールド座標に変換し、WVPからWorldを除いたビュープロジェクション行列を返す
+	// 物体ごとの行列を頂点に焼き込むので、別の場所に置いた三角形も同じカメラなら1回の描画にまとめられる
+	// Worldが潰れていて逆行列がなければfalse、面積がなく何も描かれないので頂点は変えない
+	static bool BakeWorld(const TransformationMatrix& matrix, VertexData* vertices, uint32_t vertexCount, Matrix4x4& viewProjection);
+
+	// 描画の追加、頂点はアリーナにコピーする。条件が変わったら溜まっているものを先に発行する
+	void Add(const PrimitiveBatchKey& key, const void* vertices, uint32_t vertexCount, uint32_t vertexStride);
+
+	// 溜まっている描画を発行する
+	void Flush();
+
+	// 統計のリセット
+	void ResetStats() { stats_ = {}; }
+
+	// getter
+
+	const Stats& GetStats() const { return stats_; }
+	uint32_t GetPendingCount() const { return pending_.primitiveCount; }
+
+	// setter
+
+	void SetArena(GeometryArena* arena) { arena_ = arena; }
+	void SetFlushFunction(FlushFunction function) { flushFunction_ = std::move(function); }
+
+private:
+	//====================
+	// private
+	//====================
+
+	// これより小さい行列式のWorldは潰れているとみなす
+	static constexpr float kMinDeterminant = 1.0e-12f;
+
+	// 頂点の書き込み先
+	GeometryArena* arena_ = nullptr;
+
+	// 発行先
+	FlushFunction flushFunction_;
+
+	// 溜まっている描画の条件と範囲
+	PrimitiveBatchKey pendingKey_;
+	PrimitiveBatch pending_;
+
+	Stats stats_;
+};
\ No newline at end of file
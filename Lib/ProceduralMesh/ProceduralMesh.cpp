@@ -0,0 +1,519 @@
+#include "ProceduralMesh.h"
+
+#include <emmintrin.h>
+
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+#include <numbers>
+#include <unordered_map>
+
+//============================================================
+// namespace
+//============================================================
+namespace {
+
+	// 分割の最小値
+	const uint32_t kMinCircleSegments = 3;
+
+	// Function.hはd3d12に依存するので、使う分だけここに置く
+	const float kPI = std::numbers::pi_v<float>;
+
+	Vector3 Normalize(const Vector3& v) {
+
+		float length = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+		return length != 0.0f ? Vector3{ v.x / length, v.y / length, v.z / length } : Vector3{ 0.0f, 0.0f, 0.0f };
+	}
+
+	// FNV-1a
+	const uint64_t kHashOffset = 14695981039346656037ull;
+	const uint64_t kHashPrime = 1099511628211ull;
+
+	void HashValue(uint64_t& hash, uint32_t value) {
+
+		for (uint32_t i = 0; i < 4; ++i) {
+
+			hash ^= (value >> (i * 8)) & 0xff;
+			hash *= kHashPrime;
+		}
+	}
+
+	// 円周をsegments等分したsin、cosの表、最後は最初と同じ位置
+	void MakeCircleTable(uint32_t segments, std::vector<float>& cosTable, std::vector<float>& sinTable) {
+
+		cosTable.resize(segments + 1);
+		sinTable.resize(segments + 1);
+
+		const float kEvery = kPI * 2.0f / static_cast<float>(segments);
+		for (uint32_t i = 0; i < segments; ++i) {
+
+			cosTable[i] = std::cos(kEvery * static_cast<float>(i));
+			sinTable[i] = std::sin(kEvery * static_cast<float>(i));
+		}
+
+		// 継ぎ目がずれないよう、最初と同じ値を入れる
+		cosTable[segments] = cosTable[0];
+		sinTable[segments] = sinTable[0];
+	}
+
+	// 円周上の頂点をcount個書き込む、4つずつSSEで計算する
+	// pos = (radius * cos, y, radius * sin)、normal = (normalRadius * cos, normalY, normalRadius * sin)、uv = (i * uStep, v)
+	void WriteRing(VertexData* out, const float* cosTable, const float* sinTable, uint32_t count,
+		float radius, float y, float normalRadius, float normalY, float uStep, float v) {
+
+		const __m128 kRadius = _mm_set1_ps(radius);
+		const __m128 kNormalRadius = _mm_set1_ps(normalRadius);
+		const __m128 kUStep = _mm_set1_ps(uStep);
+		const __m128 kLane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+
+		alignas(16) float px[4], pz[4], nx[4], nz[4], u[4];
+
+		uint32_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+
+			__m128 c = _mm_loadu_ps(cosTable + i);
+			__m128 s = _mm_loadu_ps(sinTable + i);
+
+			_mm_store_ps(px, _mm_mul_ps(kRadius, c));
+			_mm_store_ps(pz, _mm_mul_ps(kRadius, s));
+			_mm_store_ps(nx, _mm_mul_ps(kNormalRadius, c));
+			_mm_store_ps(nz, _mm_mul_ps(kNormalRadius, s));
+			_mm_store_ps(u, _mm_mul_ps(kUStep, _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), kLane)));
+
+			for (uint32_t lane = 0; lane < 4; ++lane) {
+
+				VertexData& vertex = out[i + lane];
+				vertex.pos = { px[lane], y, pz[lane], 1.0f };
+				vertex.texcoord = { u[lane], v };
+				vertex.normal = { nx[lane], normalY, nz[lane] };
+			}
+		}
+
+		// 4つに満たない残り
+		for (; i < count; ++i) {
+
+			VertexData& vertex = out[i];
+			vertex.pos = { radius * cosTable[i], y, radius * sinTable[i], 1.0f };
+			vertex.texcoord = { uStep * static_cast<float>(i), v };
+			vertex.normal = { normalRadius * cosTable[i], normalY, normalRadius * sinTable[i] };
+		}
+	}
+
+	// (columns + 1) * (rows + 1)個の格子状の頂点をつなぐ、rowが増える方向が上
+	// 1マスを(a, b, c)、(c, b, d)の2枚にする。aが左下、bが左上、cが右下、dが右上
+	void AppendGridIndices(std::vector<uint32_t>& indices, uint32_t base, uint32_t columns, uint32_t rows,
+		bool skipBottomRow = false, bool skipTopRow = false) {
+
+		for (uint32_t row = 0; row < rows; ++row) {
+			for (uint32_t column = 0; column < columns; ++column) {
+
+				uint32_t a = base + row * (columns + 1) + column;
+				uint32_t b = a + columns + 1;
+				uint32_t c = a + 1;
+				uint32_t d = b + 1;
+
+				// 極ではa、cが同じ位置になるので潰れた三角形は作らない
+				if (!(skipBottomRow && row == 0)) {
+					indices.insert(indices.end(), { a, b, c });
+				}
+				if (!(skipTopRow && row == rows - 1)) {
+					indices.insert(indices.end(), { c, b, d });
+				}
+			}
+		}
+	}
+
+	// 中心と円周をつなぐ蓋、上向きならisTop
+	void AppendCap(ProceduralMeshData& mesh, const std::vector<float>& cosTable, const std::vector<float>& sinTable,
+		uint32_t segments, bool isTop) {
+
+		float y = isTop ? 1.0f : -1.0f;
+		uint32_t center = static_cast<uint32_t>(mesh.vertices.size());
+
+		mesh.vertices.push_back({ { 0.0f, y, 0.0f, 1.0f }, { 0.5f, 0.5f }, { 0.0f, y, 0.0f } });
+		for (uint32_t i = 0; i <= segments; ++i) {
+
+			mesh.vertices.push_back({ { cosTable[i], y, sinTable[i], 1.0f },
+				{ 0.5f + 0.5f * cosTable[i], 0.5f - 0.5f * sinTable[i] }, { 0.0f, y, 0.0f } });
+		}
+
+		for (uint32_t i = 0; i < segments; ++i) {
+
+			uint32_t current = center + 1 + i;
+			if (isTop) {
+				mesh.indices.insert(mesh.indices.end(), { center, current + 1, current });
+			} else {
+				mesh.indices.insert(mesh.indices.end(), { center, current, current + 1 });
+			}
+		}
+	}
+}
+
+//============================================================
+// lodを分割数に反映
+//============================================================
+ProceduralMeshDesc ProceduralMeshDesc::Resolve() const {
+
+	ProceduralMeshDesc desc = *this;
+	uint32_t level = (std::min)(lod, kMaxLod);
+	desc.lod = 0;
+
+	// 半分にしていき、最小の分割数で止める
+	auto reduce = [level](uint32_t value, uint32_t minValue) {
+		return (std::max)(value >> level, minValue);
+		};
+
+	switch (type) {
+	case ProceduralMeshType::UVSPHERE:
+
+		desc.segments = reduce(segments, kMinCircleSegments);
+		desc.rings = reduce(rings, 2);
+		break;
+	case ProceduralMeshType::ICOSPHERE:
+
+		// 分割1回で三角形が4倍になるので、1段で1回減らす
+		// 他の形状と同じ既定の分割数のままでも生成できるように、最大の回数で止める
+		desc.segments = (std::min)(segments, kMaxIcosphereSubdivision);
+		desc.segments = desc.segments > level ? desc.segments - level : 0;
+		desc.rings = 0;
+		break;
+	case ProceduralMeshType::PLANE:
+
+		desc.segments = reduce(segments, 1);
+		desc.rings = reduce(rings, 1);
+		break;
+	case ProceduralMeshType::BOX:
+
+		desc.segments = reduce(segments, 1);
+		desc.rings = 0;
+		break;
+	case ProceduralMeshType::PRISM:
+	case ProceduralMeshType::CYLINDER:
+
+		desc.segments = reduce(segments, kMinCircleSegments);
+		desc.rings = reduce(rings, 1);
+		break;
+	}
+
+	return desc;
+}
+
+//============================================================
+// 設定のハッシュ
+//============================================================
+uint64_t ProceduralMeshDesc::Hash() const {
+
+	uint64_t hash = kHashOffset;
+	HashValue(hash, static_cast<uint32_t>(type));
+	HashValue(hash, segments);
+	HashValue(hash, rings);
+	HashValue(hash, lod);
+
+	return hash;
+}
+
+//============================================================
+// 設定の比較
+//============================================================
+bool ProceduralMeshDesc::operator==(const ProceduralMeshDesc& other) const {
+
+	return type == other.type && segments == other.segments && rings == other.rings && lod == other.lod;
+}
+
+//============================================================
+// 設定から生成
+//============================================================
+ProceduralMeshData ProceduralMesh::Generate(const ProceduralMeshDesc& desc) {
+
+	switch (desc.type) {
+	case ProceduralMeshType::UVSPHERE:  return CreateUVSphere(desc.segments, desc.rings);
+	case ProceduralMeshType::ICOSPHERE: return CreateIcosphere(desc.segments);
+	case ProceduralMeshType::PLANE:     return CreatePlane(desc.segments, desc.rings);
+	case ProceduralMeshType::BOX:       return CreateBox(desc.segments);
+	case ProceduralMeshType::PRISM:     return CreatePrism(desc.segments, desc.rings);
+	case ProceduralMeshType::CYLINDER:  return CreateCylinder(desc.segments, desc.rings);
+	}
+
+	assert(false);
+	return {};
+}
+
+//============================================================
+// UV球
+//============================================================
+ProceduralMeshData ProceduralMesh::CreateUVSphere(uint32_t segments, uint32_t rings) {
+
+	assert(segments >= kMinCircleSegments && rings >= 2);
+
+	ProceduralMeshData mesh;
+
+	std::vector<float> cosTable, sinTable;
+	MakeCircleTable(segments, cosTable, sinTable);
+
+	// 継ぎ目はUVが違うので1列多く持つ、極も経度ごとに持つ
+	mesh.vertices.resize((segments + 1) * (rings + 1));
+
+	// 緯度1つ分の角度
+	const float kLatEvery = kPI / static_cast<float>(rings);
+	for (uint32_t latIndex = 0; latIndex <= rings; ++latIndex) {
+
+		// 南極から北極へ
+		float lat = -kPI / 2.0f + kLatEvery * static_cast<float>(latIndex);
+		float cosLat = latIndex == 0 || latIndex == rings ? 0.0f : std::cos(lat);
+		float sinLat = std::sin(lat);
+		float v = 1.0f - static_cast<float>(latIndex) / static_cast<float>(rings);
+
+		// 単位球なので位置と法線は同じ
+		WriteRing(&mesh.vertices[latIndex * (segments + 1)], cosTable.data(), sinTable.data(), segments + 1,
+			cosLat, sinLat, cosLat, sinLat, 1.0f / static_cast<float>(segments), v);
+	}
+
+	AppendGridIndices(mesh.indices, 0, segments, rings, true, true);
+
+	return mesh;
+}
+
+//============================================================
+// 正二十面体を分割した球
+//============================================================
+ProceduralMeshData ProceduralMesh::CreateIcosphere(uint32_t subdivision) {
+
+	// 1回で三角形が4倍になるので、大きくしすぎない
+	assert(subdivision <= ProceduralMeshDesc::kMaxIcosphereSubdivision);
+
+	// 正二十面体
+	const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+	std::vector<Vector3> positions = {
+		{ -1.0f, t, 0.0f }, { 1.0f, t, 0.0f }, { -1.0f, -t, 0.0f }, { 1.0f, -t, 0.0f },
+		{ 0.0f, -1.0f, t }, { 0.0f, 1.0f, t }, { 0.0f, -1.0f, -t }, { 0.0f, 1.0f, -t },
+		{ t, 0.0f, -1.0f }, { t, 0.0f, 1.0f }, { -t, 0.0f, -1.0f }, { -t, 0.0f, 1.0f },
+	};
+	std::vector<uint32_t> indices = {
+		0, 5, 11,  0, 1, 5,  0, 7, 1,  0, 10, 7,  0, 11, 10,
+		1, 9, 5,  5, 4, 11,  11, 2, 10,  10, 6, 7,  7, 8, 1,
+		3, 4, 9,  3, 2, 4,  3, 6, 2,  3, 8, 6,  3, 9, 8,
+		4, 5, 9,  2, 11, 4,  6, 10, 2,  8, 7, 6,  9, 1, 8,
+	};
+	for (auto& position : positions) {
+		position = Normalize(position);
+	}
+
+	// 辺の中点で4つに分ける、隣の三角形とは中点を共有する
+	for (uint32_t level = 0; level < subdivision; ++level) {
+
+		std::unordered_map<uint64_t, uint32_t> midpoints;
+		midpoints.reserve(indices.size());
+
+		auto midpoint = [&](uint32_t a, uint32_t b) {
+
+			uint64_t key = (static_cast<uint64_t>((std::min)(a, b)) << 32) | (std::max)(a, b);
+			auto it = midpoints.find(key);
+			if (it != midpoints.end()) {
+				return it->second;
+			}
+
+			const Vector3& pa = positions[a];
+			const Vector3& pb = positions[b];
+			uint32_t index = static_cast<uint32_t>(positions.size());
+			positions.push_back(Normalize({ pa.x + pb.x, pa.y + pb.y, pa.z + pb.z }));
+			midpoints.emplace(key, index);
+
+			return index;
+			};
+
+		std::vector<uint32_t> subdivided;
+		subdivided.reserve(indices.size() * 4);
+		for (size_t i = 0; i < indices.size(); i += 3) {
+
+			uint32_t a = indices[i];
+			uint32_t b = indices[i + 1];
+			uint32_t c = indices[i + 2];
+			uint32_t ab = midpoint(a, b);
+			uint32_t bc = midpoint(b, c);
+			uint32_t ca = midpoint(c, a);
+
+			subdivided.insert(subdivided.end(), { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca });
+		}
+		indices = std::move(subdivided);
+	}
+
+	ProceduralMeshData mesh;
+	mesh.vertices.resize(positions.size());
+	for (size_t i = 0; i < positions.size(); ++i) {
+
+		// UVは球面の経度、緯度から。継ぎ目は分けないので少しにじむ
+		const Vector3& p = positions[i];
+		float u = 0.5f + std::atan2(p.z, p.x) / (kPI * 2.0f);
+		float v = 0.5f - std::asin(std::clamp(p.y, -1.0f, 1.0f)) / kPI;
+
+		mesh.vertices[i] = { { p.x, p.y, p.z, 1.0f }, { u, v }, p };
+	}
+
+	// 表裏をUV球に合わせる
+	mesh.indices.resize(indices.size());
+	for (size_t i = 0; i < indices.size(); i += 3) {
+
+		mesh.indices[i] = indices[i];
+		mesh.indices[i + 1] = indices[i + 2];
+		mesh.indices[i + 2] = indices[i + 1];
+	}
+
+	return mesh;
+}
+
+//============================================================
+// 平面
+//============================================================
+ProceduralMeshData ProceduralMesh::CreatePlane(uint32_t segmentsX, uint32_t segmentsZ) {
+
+	assert(segmentsX >= 1 && segmentsZ >= 1);
+
+	ProceduralMeshData mesh;
+	mesh.vertices.resize((segmentsX + 1) * (segmentsZ + 1));
+
+	const float kStepX = 2.0f / static_cast<float>(segmentsX);
+	const float kStepZ = 2.0f / static_cast<float>(segmentsZ);
+
+	// 手前から奥へ、上から見て時計回りになるように並べる
+	for (uint32_t z = 0; z <= segmentsZ; ++z) {
+
+		float positionZ = -1.0f + kStepZ * static_cast<float>(z);
+		float v = 1.0f - static_cast<float>(z) / static_cast<float>(segmentsZ);
+		VertexData* row = &mesh.vertices[z * (segmentsX + 1)];
+
+		for (uint32_t x = 0; x <= segmentsX; ++x) {
+
+			row[x].pos = { -1.0f + kStepX * static_cast<float>(x), 0.0f, positionZ, 1.0f };
+			row[x].texcoord = { static_cast<float>(x) / static_cast<float>(segmentsX), v };
+			row[x].normal = { 0.0f, 1.0f, 0.0f };
+		}
+	}
+
+	AppendGridIndices(mesh.indices, 0, segmentsX, segmentsZ);
+
+	return mesh;
+}
+
+//============================================================
+// 立方体
+//============================================================
+ProceduralMeshData ProceduralMesh::CreateBox(uint32_t segments) {
+
+	assert(segments >= 1);
+
+	// 面ごとの法線と、格子の右方向、上方向
+	struct Face {
+		Vector3 normal;
+		Vector3 right;
+		Vector3 up;
+	};
+	const Face kFaces[] = {
+		{ {  1.0f,  0.0f,  0.0f }, {  0.0f, 0.0f,  1.0f }, { 0.0f, 1.0f,  0.0f } },
+		{ { -1.0f,  0.0f,  0.0f }, {  0.0f, 0.0f, -1.0f }, { 0.0f, 1.0f,  0.0f } },
+		{ {  0.0f,  1.0f,  0.0f }, {  1.0f, 0.0f,  0.0f }, { 0.0f, 0.0f,  1.0f } },
+		{ {  0.0f, -1.0f,  0.0f }, {  1.0f, 0.0f,  0.0f }, { 0.0f, 0.0f, -1.0f } },
+		{ {  0.0f,  0.0f,  1.0f }, { -1.0f, 0.0f,  0.0f }, { 0.0f, 1.0f,  0.0f } },
+		{ {  0.0f,  0.0f, -1.0f }, {  1.0f, 0.0f,  0.0f }, { 0.0f, 1.0f,  0.0f } },
+	};
+
+	ProceduralMeshData mesh;
+	mesh.vertices.reserve(6 * (segments + 1) * (segments + 1));
+	mesh.indices.reserve(6 * segments * segments * 6);
+
+	const float kStep = 2.0f / static_cast<float>(segments);
+	for (const Face& face : kFaces) {
+
+		// 角は面ごとに法線が違うので共有しない
+		uint32_t base = static_cast<uint32_t>(mesh.vertices.size());
+		for (uint32_t row = 0; row <= segments; ++row) {
+
+			float b = -1.0f + kStep * static_cast<float>(row);
+			for (uint32_t column = 0; column <= segments; ++column) {
+
+				float a = -1.0f + kStep * static_cast<float>(column);
+				mesh.vertices.push_back({
+					{ face.normal.x + face.right.x * a + face.up.x * b,
+					  face.normal.y + face.right.y * a + face.up.y * b,
+					  face.normal.z + face.right.z * a + face.up.z * b, 1.0f },
+					{ static_cast<float>(column) / static_cast<float>(segments), 1.0f - static_cast<float>(row) / static_cast<float>(segments) },
+					face.normal });
+			}
+		}
+
+		AppendGridIndices(mesh.indices, base, segments, segments);
+	}
+
+	return mesh;
+}
+
+//============================================================
+// 角柱
+//============================================================
+ProceduralMeshData ProceduralMesh::CreatePrism(uint32_t sides, uint32_t rings) {
+
+	assert(sides >= kMinCircleSegments && rings >= 1);
+
+	ProceduralMeshData mesh;
+
+	std::vector<float> cosTable, sinTable;
+	MakeCircleTable(sides, cosTable, sinTable);
+
+	// 側面は面ごとに法線を持つので、面ごとに2列の格子にする
+	const float kStepY = 2.0f / static_cast<float>(rings);
+	for (uint32_t side = 0; side < sides; ++side) {
+
+		Vector3 normal = Normalize({ cosTable[side] + cosTable[side + 1], 0.0f, sinTable[side] + sinTable[side + 1] });
+		float u0 = static_cast<float>(side) / static_cast<float>(sides);
+		float u1 = static_cast<float>(side + 1) / static_cast<float>(sides);
+
+		uint32_t base = static_cast<uint32_t>(mesh.vertices.size());
+		for (uint32_t row = 0; row <= rings; ++row) {
+
+			float y = -1.0f + kStepY * static_cast<float>(row);
+			float v = 1.0f - static_cast<float>(row) / static_cast<float>(rings);
+
+			mesh.vertices.push_back({ { cosTable[side], y, sinTable[side], 1.0f }, { u0, v }, normal });
+			mesh.vertices.push_back({ { cosTable[side + 1], y, sinTable[side + 1], 1.0f }, { u1, v }, normal });
+		}
+
+		AppendGridIndices(mesh.indices, base, 1, rings);
+	}
+
+	AppendCap(mesh, cosTable, sinTable, sides, false);
+	AppendCap(mesh, cosTable, sinTable, sides, true);
+
+	return mesh;
+}
+
+//============================================================
+// 円柱
+//============================================================
+ProceduralMeshData ProceduralMesh::CreateCylinder(uint32_t segments, uint32_t rings) {
+
+	assert(segments >= kMinCircleSegments && rings >= 1);
+
+	ProceduralMeshData mesh;
+
+	std::vector<float> cosTable, sinTable;
+	MakeCircleTable(segments, cosTable, sinTable);
+
+	// 側面、高さごとに円周を書き込む
+	mesh.vertices.resize((segments + 1) * (rings + 1));
+
+	const float kStepY = 2.0f / static_cast<float>(rings);
+	for (uint32_t row = 0; row <= rings; ++row) {
+
+		float y = -1.0f + kStepY * static_cast<float>(row);
+		float v = 1.0f - static_cast<float>(row) / static_cast<float>(rings);
+
+		WriteRing(&mesh.vertices[row * (segments + 1)], cosTable.data(), sinTable.data(), segments + 1,
+			1.0f, y, 1.0f, 0.0f, 1.0f / static_cast<float>(segments), v);
+	}
+
+	AppendGridIndices(mesh.indices, 0, segments, rings);
+
+	AppendCap(mesh, cosTable, sinTable, segments, false);
+	AppendCap(mesh, cosTable, sinTable, segments, true);
+
+	return mesh;
+}
\ No newline at end of file
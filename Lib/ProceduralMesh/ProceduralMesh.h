@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "DrawData.h"
+
+// 生成する形状
+enum class ProceduralMeshType : uint32_t {
+
+	UVSPHERE,  // 経度、緯度で分割した球
+	ICOSPHERE, // 正二十面体を分割した球
+	PLANE,     // XZ平面
+	BOX,       // 立方体
+	PRISM,     // 角柱、側面は面ごとの法線
+	CYLINDER,  // 円柱、側面はなめらかな法線
+};
+
+// 形状の設定、これが同じなら同じメッシュになる
+// 大きさは全て[-1, 1]に収まる。大きさや向きはWorld行列で変える
+struct ProceduralMeshDesc {
+
+	// LODの最大段数
+	static constexpr uint32_t kMaxLod = 4;
+	// ICOSPHEREの分割の回数の最大、1回で三角形が4倍になる
+	static constexpr uint32_t kMaxIcosphereSubdivision = 8;
+
+	ProceduralMeshType type = ProceduralMeshType::UVSPHERE;
+
+	// 分割数
+	// UVSPHERE、PRISM、CYLINDER : 周方向
+	// PLANE、BOX               : 1辺の分割数
+	// ICOSPHERE                : 分割の回数、ResolveでkMaxIcosphereSubdivisionまでに抑える
+	uint32_t segments = 16;
+	// UVSPHERE : 緯度方向、PLANE : 奥行き方向、PRISM、CYLINDER : 高さ方向
+	uint32_t rings = 16;
+
+	// 0が最も細かい、1つ上がるごとに分割数が半分になる
+	uint32_t lod = 0;
+
+	// lodを分割数に反映した設定、lodは0になる
+	// 最小の分割数で止まるので、違うlodが同じ設定になることもある
+	ProceduralMeshDesc Resolve() const;
+
+	// 設定全体のハッシュ
+	uint64_t Hash() const;
+
+	bool operator==(const ProceduralMeshDesc& other) const;
+};
+
+// インデックス付きのメッシュ、頂点は隣の面と共有する
+struct ProceduralMeshData {
+
+	std::vector<VertexData> vertices;
+	std::vector<uint32_t> indices;
+};
+
+//================================================
+// ProceduralMesh Class
+//================================================
+/// 球、平面、箱などのメッシュを分割数から生成する
+/// 三角形は外側から見て時計回り。円周上の頂点はsin、cosの表から4つずつSSEで計算する
+class ProceduralMesh {
+public:
+	//====================
+	// public
+	//====================
+
+	// 設定から生成する、lodは反映済みにしてから使う
+	static ProceduralMeshData Generate(const ProceduralMeshDesc& desc);
+
+	static ProceduralMeshData CreateUVSphere(uint32_t segments, uint32_t rings);
+	static ProceduralMeshData CreateIcosphere(uint32_t subdivision);
+	static ProceduralMeshData CreatePlane(uint32_t segmentsX, uint32_t segmentsZ);
+	static ProceduralMeshData CreateBox(uint32_t segments);
+	static ProceduralMeshData CreatePrism(uint32_t sides, uint32_t rings);
+	static ProceduralMeshData CreateCylinder(uint32_t segments, uint32_t rings);
+};
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "QRCapture.h"
+
+#include <cassert>
+
+//============================================================
+// デストラクタ
+//============================================================
+QRCapture::~QRCapture() {
+
+	Stop();
+}
+
+//============================================================
+// 開始
+//============================================================
+void QRCapture::Start(IFrameSource* source, const QRDetectionScheduler::Settings& schedulerSettings) {
+
+	assert(!isRunning_ && "QRCapture is already running");
+	assert(source && source->IsOpened());
+
+	source_ = source;
+	isMirrored_ = source->IsMirrored();
+	scheduler_.SetSettings(schedulerSettings);
+	scheduler_.Reset();
+	int width = static_cast<int>(source->GetWidth());
+	int height = static_cast<int>(source->GetHeight());
+
+	// 読み込みと処理の途中で確保しないように、同じ大きさのフレームを先に作る
+	for (size_t i = 0; i < kRingSize; ++i) {
+		ring_.GetSlot(i).image.create(height, width, CV_8UC3);
+	}
+	// 結果は最初のReceiveの前にも表示されるので黒にしておく
+	for (uint32_t i = 0; i < 3; ++i) {
+		Result& result = mailbox_.GetBuffer(i);
+		result.frame.create(height, width, CV_8UC3);
+		result.frame.setTo(cv::Scalar::all(0));
+		result.gray.create(height, width, CV_8UC1);
+		result.gray.setTo(cv::Scalar::all(0));
+		result.mask.create(height, width, CV_8UC1);
+		result.mask.setTo(cv::Scalar::all(0));
+	}
+	discardFrame_.create(height, width, CV_8UC3);
+	ring_.Reset();
+
+	isRunning_.store(true, std::memory_order_release);
+	isCapturing_.store(true, std::memory_order_release);
+	captureThread_ = std::thread(&QRCapture::CaptureLoop, this);
+	processThread_ = std::thread(&QRCapture::ProcessLoop, this);
+}
+
+//============================================================
+// 停止
+//============================================================
+void QRCapture::Stop() {
+
+	isRunning_.store(false, std::memory_order_release);
+
+	// 読み込みスレッドが終わるときにリングを閉じるので、処理スレッドも起きて終わる
+	if (captureThread_.joinable()) {
+		captureThread_.join();
+	}
+	if (processThread_.joinable()) {
+		processThread_.join();
+	}
+}
+
+//============================================================
+// 統計
+//============================================================
+QRCapture::Stats QRCapture::GetStats() const {
+
+	Stats stats{};
+	stats.capturedCount = capturedCount_.load(std::memory_order_relaxed);
+	stats.droppedCount = droppedCount_.load(std::memory_order_relaxed);
+	stats.processedCount = processedCount_.load(std::memory_order_relaxed);
+	stats.decodedCount = decodedCount_.load(std::memory_order_relaxed);
+	if (stats.processedCount != 0) {
+		stats.averageLatencyMs = static_cast<float>(double(totalLatencyUs_.load(std::memory_order_relaxed)) / stats.processedCount / 1000.0);
+	}
+	stats.maxLatencyMs = static_cast<float>(maxLatencyUs_.load(std::memory_order_relaxed) / 1000.0);
+	stats.trackedCount = trackedCount_.load(std::memory_order_relaxed);
+	stats.untrackedCount = untrackedCount_.load(std::memory_order_relaxed);
+	stats.fullScanCount = fullScanCount_.load(std::memory_order_relaxed);
+	if (stats.trackedCount != 0) {
+		stats.averageTrackedDetectMs = static_cast<float>(double(trackedDetectUs_.load(std::memory_order_relaxed)) / stats.trackedCount / 1000.0);
+	}
+	if (stats.untrackedCount != 0) {
+		stats.averageUntrackedDetectMs = static_cast<float>(double(untrackedDetectUs_.load(std::memory_order_relaxed)) / stats.untrackedCount / 1000.0);
+	}
+	return stats;
+}
+
+//============================================================
+// 読み込みスレッド
+//============================================================
+void QRCapture::CaptureLoop() {
+
+	uint64_t frameIndex = 0;
+	while (isRunning_.load(std::memory_order_acquire)) {
+
+		// 処理が追いつかず満杯なら、読み捨ててカメラの古いフレームを溜めない
+		Frame* frame = ring_.BeginWrite();
+		cv::Mat& image = frame ? frame->image : discardFrame_;
+
+		if (!source_->Read(image) || image.empty()) {
+			break;
+		}
+		++frameIndex;
+		capturedCount_.fetch_add(1, std::memory_order_relaxed);
+
+		if (!frame) {
+			droppedCount_.fetch_add(1, std::memory_order_relaxed);
+			continue;
+		}
+
+		frame->index = frameIndex;
+		frame->captureTime = std::chrono::steady_clock::now();
+		ring_.EndWrite();
+	}
+
+	isCapturing_.store(false, std::memory_order_release);
+	ring_.Close();
+}
+
+//============================================================
+// 処理スレッド
+//============================================================
+void QRCapture::ProcessLoop() {
+
+	while (isRunning_.load(std::memory_order_acquire)) {
+
+		Frame* frame = ring_.BeginRead();
+		if (!frame) {
+
+			// 読み込みが終わっていれば残りは処理しない
+			if (ring_.IsClosed()) {
+				break;
+			}
+			ring_.WaitForWrite();
+			continue;
+		}
+
+		// 溜まっていたら一番新しいものだけ処理する
+		while (ring_.GetSize() > 1) {
+
+			ring_.EndRead();
+			droppedCount_.fetch_add(1, std::memory_order_relaxed);
+			frame = ring_.BeginRead();
+		}
+
+		Result& result = mailbox_.GetWriteBuffer();
+		result.frameIndex = frame->index;
+		result.captureTime = frame->captureTime;
+
+		// 前処理の書き込み先が別なので、リングはすぐに返せる
+		// Startで確保した結果のバッファを指すヘッダ、大きさが同じなので確保し直さずに書き込む
+		QRDecoder::Images images{ result.frame, result.gray, result.mask };
+		decoder_.Preprocess(frame->image, isMirrored_, images);
+		ring_.EndRead();
+
+		// QRコードの検出とデコード、前に見つかった位置の周りか、予算が足りれば全体
+		QRDetectionScheduler::Result detection = scheduler_.Detect(decoder_, result.gray);
+		result.decodedText = std::move(detection.text);
+		result.resultTime = std::chrono::steady_clock::now();
+
+		// 統計、書くのはこのスレッドだけ
+		uint64_t latencyUs = static_cast<uint64_t>(
+			std::chrono::duration_cast<std::chrono::microseconds>(result.resultTime - result.captureTime).count());
+		totalLatencyUs_.fetch_add(latencyUs, std::memory_order_relaxed);
+		if (latencyUs > maxLatencyUs_.load(std::memory_order_relaxed)) {
+			maxLatencyUs_.store(latencyUs, std::memory_order_relaxed);
+		}
+		processedCount_.fetch_add(1, std::memory_order_relaxed);
+		uint64_t detectUs = static_cast<uint64_t>(detection.costMs * 1000.0f);
+		if (detection.isTracked) {
+			trackedCount_.fetch_add(1, std::memory_order_relaxed);
+			trackedDetectUs_.fetch_add(detectUs, std::memory_order_relaxed);
+		} else {
+			untrackedCount_.fetch_add(1, std::memory_order_relaxed);
+			untrackedDetectUs_.fetch_add(detectUs, std::memory_order_relaxed);
+		}
+		if (detection.scan == QRDetectionScheduler::Scan::Full) {
+			fullScanCount_.fetch_add(1, std::memory_order_relaxed);
+		}
+		if (!result.decodedText.empty()) {
+			decodedCount_.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		mailbox_.Publish();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+#pragma once
+
+/// OpenCV
+#include <opencv2/core.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "FrameRing.h"
+#include "ResultMailbox.h"
+#include "FrameSource.h"
+#include "QRDecoder.h"
+#include "QRDetectionScheduler.h"
+
+//================================================
+// QRCapture Class
+//================================================
+/// フレームの読み込みとQRコードの検出を、それぞれ専用のスレッドで行う。読み込み元はIFrameSourceで差し替えられる
+/// 読み込みスレッドは先に確保したフレームのリングに書き、処理スレッドは一番新しいものだけを処理する
+/// 結果はResultMailboxで渡すので、Receiveを呼ぶスレッドはカメラを待たない。ウィンドウは使わない
+class QRCapture {
+public:
+	//====================
+	// public
+	//====================
+
+	// 処理の結果
+	struct Result {
+
+		cv::Mat frame;            // 左右反転したフレーム、表示用
+		cv::Mat gray;             // 平滑化したグレースケール、検出に使ったもの
+		cv::Mat mask;             // 赤の範囲のマスク
+		std::string decodedText;  // 読めたQRコード、なければ空
+		uint64_t frameIndex = 0;  // 読み込んだ順の番号、1から
+		std::chrono::steady_clock::time_point captureTime; // 読み込みが終わった時間
+		std::chrono::steady_clock::time_point resultTime;  // 処理が終わった時間
+	};
+
+	// 統計、起動してからの合計
+	struct Stats {
+
+		uint64_t capturedCount = 0;  // 読み込んだ数
+		uint64_t droppedCount = 0;   // 処理されずに捨てた数
+		uint64_t processedCount = 0; // 処理した数
+		uint64_t decodedCount = 0;   // QRコードが読めた数
+		float averageLatencyMs = 0.0f; // 読み込みから結果までの平均
+		float maxLatencyMs = 0.0f;     // 読み込みから結果までの最大
+		uint64_t trackedCount = 0;     // QRコードが見つかっている状態で処理した数
+		uint64_t untrackedCount = 0;   // 見失った状態で処理した数
+		uint64_t fullScanCount = 0;    // 全体を探した数
+		float averageTrackedDetectMs = 0.0f;   // 見つかっている間の1フレームの検出の平均
+		float averageUntrackedDetectMs = 0.0f; // 見失っている間の1フレームの検出の平均
+	};
+
+	QRCapture() = default;
+	~QRCapture();
+
+	// スレッドを立てて読み込みを始める、sourceの大きさでフレームを先に確保する
+	// 検出は前に見つかった位置の周りから探し、見失っている間の全体の探索はschedulerSettingsの予算に合わせて間引く
+	// sourceはStopまで読み込みスレッドが使うので、それまで破棄しない。Readが失敗すると読み込みスレッドは終わる
+	void Start(IFrameSource* source, const QRDetectionScheduler::Settings& schedulerSettings = {});
+	// スレッドを止める、読み込み中のフレームが終わるまで待つ
+	void Stop();
+
+	// 新しい結果があればtrue、待たない。受け取る側は1つのスレッドに決める
+	bool Receive() { return mailbox_.Receive(); }
+
+	// getter
+
+	// 最後にReceiveした結果
+	const Result& GetResult() const { return mailbox_.GetReadBuffer(); }
+	Stats GetStats() const;
+	// 読み込みスレッドが動いているか、カメラが外れるか動画が終わると止まる
+	bool IsCapturing() const { return isCapturing_.load(std::memory_order_acquire); }
+
+private:
+	//====================
+	// private
+	//====================
+
+	// 読み込んだフレーム
+	struct Frame {
+
+		cv::Mat image;
+		uint64_t index = 0;
+		std::chrono::steady_clock::time_point captureTime;
+	};
+
+	// 処理が遅れたときに溜めておく数、多くても古いものは捨てるので遅延は増えない
+	static const size_t kRingSize = 4;
+
+	// 読み込みスレッド
+	void CaptureLoop();
+	// 処理スレッド
+	void ProcessLoop();
+
+	IFrameSource* source_ = nullptr;
+	bool isMirrored_ = false;
+
+	FrameRing<Frame, kRingSize> ring_;
+	ResultMailbox<Result> mailbox_;
+	// リングが満杯のときに読み捨てる先、カメラのバッファを溜めないように読み続ける
+	cv::Mat discardFrame_;
+
+	std::thread captureThread_;
+	std::thread processThread_;
+	std::atomic<bool> isRunning_ = false;
+	std::atomic<bool> isCapturing_ = false;
+
+	// 処理スレッドだけが使う
+	QRDecoder decoder_;
+	QRDetectionScheduler scheduler_;
+
+	// 統計
+	std::atomic<uint64_t> capturedCount_ = 0;
+	std::atomic<uint64_t> droppedCount_ = 0;
+	std::atomic<uint64_t> processedCount_ = 0;
+	std::atomic<uint64_t> decodedCount_ = 0;
+	std::atomic<uint64_t> totalLatencyUs_ = 0;
+	std::atomic<uint64_t> maxLatencyUs_ = 0;
+	std::atomic<uint64_t> trackedCount_ = 0;
+	std::atomic<uint64_t> trackedDetectUs_ = 0;
+	std::atomic<uint64_t> untrackedCount_ = 0;
+	std::atomic<uint64_t> untrackedDetectUs_ = 0;
+	std::atomic<uint64_t> fullScanCount_ = 0;
+};
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "QRDecoder.h"
+
+#include <cassert>
+
+//============================================================
+// 前処理
+//============================================================
+void QRDecoder::Preprocess(const cv::Mat& frame, bool isMirrored, Images& output) {
+
+	assert(frame.type() == CV_8UC3);
+
+	// 大きさが同じなら確保し直さない
+	output.color.create(frame.rows, frame.cols, CV_8UC3);
+	output.gray.create(frame.rows, frame.cols, CV_8UC1);
+	output.mask.create(frame.rows, frame.cols, CV_8UC1);
+
+	FrameSourceImage source{};
+	source.pixels = frame.data;
+	source.width = static_cast<uint32_t>(frame.cols);
+	source.height = static_cast<uint32_t>(frame.rows);
+	source.rowPitch = frame.step;
+
+	// 取得したフレームの左右反転、カメラは鏡のように見せる。平滑化 (ガウシアンブラー) はグレースケールにかける
+	FramePreprocessor::Settings settings{};
+	settings.isMirrored = isMirrored;
+	settings.threadCount = threadCount_;
+	FramePreprocessor::Process(source,
+		FrameOutputImage{ output.gray.data, output.gray.step },
+		FrameOutputImage{ output.mask.data, output.mask.step },
+		FrameOutputImage{ output.color.data, output.color.step }, settings);
+}
+
+//============================================================
+// 検出とデコード
+//============================================================
+std::string QRDecoder::Detect(const cv::Mat& gray) {
+
+	// QRコードの検出とデコード、グレースケールなので中で変換しない
+	return qrDecoder_.detectAndDecode(gray);
+}
+
+//============================================================
+// 検出とデコード、4隅も返す
+//============================================================
+std::string QRDecoder::Detect(const cv::Mat& gray, std::vector<cv::Point2f>& corners) {
+
+	corners.clear();
+	std::string text = qrDecoder_.detectAndDecode(gray, corners);
+	if (corners.size() != 4) {
+		corners.clear();
+	}
+	return text;
+}
+
+//============================================================
+// 位置だけ探す
+//============================================================
+bool QRDecoder::Locate(const cv::Mat& gray, std::vector<cv::Point2f>& corners) {
+
+	corners.clear();
+	if (!qrDecoder_.detect(gray, corners) || corners.size() != 4) {
+		corners.clear();
+		return false;
+	}
+	return true;
+}
\ No newline at end of file
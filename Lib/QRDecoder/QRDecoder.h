@@ -0,0 +1,62 @@
+#pragma once
+
+/// OpenCV
+#include <opencv2/core.hpp>
+#include <opencv2/objdetect.hpp>
+
+#include <string>
+#include <vector>
+
+#include "FramePreprocessor.h"
+
+//================================================
+// QRDecoder Class
+//================================================
+/// カメラのフレームからQRコードを読む、前処理と検出に分けてある
+/// QRCaptureの処理スレッドと、計測用のツールで同じ処理を使う。1つのスレッドから使う
+class QRDecoder {
+public:
+	//====================
+	// public
+	//====================
+
+	QRDecoder() = default;
+	~QRDecoder() = default;
+
+	// 前処理の結果、frameと同じ大きさ
+	struct Images {
+
+		cv::Mat color; // 反転しただけのBGR、表示用
+		cv::Mat gray;  // 反転して平滑化したグレースケール、検出用
+		cv::Mat mask;  // 赤の範囲を255にしたマスク
+	};
+
+	// 前処理、反転、グレースケール化、平滑化と赤のマスクを1回の読み込みで作る
+	// frameは読むだけなので、この後すぐに返せる
+	void Preprocess(const cv::Mat& frame, bool isMirrored, Images& output);
+	// Preprocessしたグレースケールから検出とデコード、読めなければ空
+	std::string Detect(const cv::Mat& gray);
+	// 検出とデコード、見つかればcornersにgrayの中での4隅を書く。見つかってもデコードできなければ空
+	std::string Detect(const cv::Mat& gray, std::vector<cv::Point2f>& corners);
+	// 位置だけ探す、デコードしないので軽い。見つからなければfalse
+	bool Locate(const cv::Mat& gray, std::vector<cv::Point2f>& corners);
+
+	// 前処理から検出までまとめて
+	std::string Decode(const cv::Mat& frame, bool isMirrored, Images& output) {
+
+		Preprocess(frame, isMirrored, output);
+		return Detect(output.gray);
+	}
+
+	// 前処理のスレッド数、0ならコア数分
+	void SetThreadCount(uint32_t threadCount) { threadCount_ = threadCount; }
+
+private:
+	//====================
+	// private
+	//====================
+
+	// QRコード検出器
+	cv::QRCodeDetector qrDecoder_;
+	uint32_t threadCount_ = 0;
+};
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "QRDetectionScheduler.h"
+
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <chrono>
+
+//============================================================
+// 検出
+//============================================================
+QRDetectionScheduler::Result QRDetectionScheduler::Detect(QRDecoder& decoder, const cv::Mat& gray) {
+
+	using Clock = std::chrono::steady_clock;
+
+	// 毎フレーム予算を足す、使わなければ上限まで溜まる
+	creditMs_ = (std::min)(creditMs_ + settings_.budgetMs, settings_.budgetMs * settings_.budgetLimit);
+	++framesSinceFullScan_;
+
+	Result result{};
+	result.isTracked = IsTracking();
+
+	Clock::time_point begin = Clock::now();
+
+	if (result.isTracked) {
+
+		// 前の4隅の周りだけ読む、見つからなくてもすぐには見失わない
+		result.scan = Scan::ROI;
+		if (ScanROI(decoder, gray, result.text)) {
+			missCount_ = 0;
+		} else if (++missCount_ >= settings_.lostFrameCount) {
+			corners_.clear();
+			missCount_ = 0;
+			++stats_.lostCount;
+		}
+	} else if (fullCostMs_ == 0.0f || creditMs_ >= fullCostMs_ || framesSinceFullScan_ >= settings_.maxFullScanInterval) {
+
+		// 予算が溜まったら全体、長い間探していなければ予算が足りなくても探す
+		result.scan = Scan::Full;
+		ScanFull(decoder, gray, result.text);
+	} else if (settings_.pyramidLevel != 0 && (pyramidCostMs_ == 0.0f || creditMs_ >= pyramidCostMs_)) {
+
+		// 全体には足りなければ縮小した画像で
+		result.scan = Scan::Pyramid;
+		ScanPyramid(decoder, gray, result.text);
+	}
+
+	result.costMs = std::chrono::duration<float, std::milli>(Clock::now() - begin).count();
+	creditMs_ -= result.costMs;
+
+	// 見積もりの更新、ピラミッドは見つかると元の大きさでも読むのでその分も入れる
+	auto updateCost = [](float& cost, float sample) {
+		cost = cost == 0.0f ? sample : cost + (sample - cost) * kCostSmoothing;
+	};
+	if (result.scan == Scan::Full) {
+		updateCost(fullCostMs_, result.costMs);
+	} else if (result.scan == Scan::Pyramid) {
+		updateCost(pyramidCostMs_, result.costMs);
+	}
+
+	// 統計
+	if (result.isTracked) {
+		++stats_.trackedFrames;
+		stats_.trackedMs += result.costMs;
+	} else {
+		++stats_.untrackedFrames;
+		stats_.untrackedMs += result.costMs;
+	}
+	++stats_.scanCounts[static_cast<size_t>(result.scan)];
+
+	return result;
+}
+
+//============================================================
+// 見失った状態に戻す
+//============================================================
+void QRDetectionScheduler::Reset() {
+
+	corners_.clear();
+	missCount_ = 0;
+	framesSinceFullScan_ = 0;
+	creditMs_ = 0.0f;
+}
+
+//============================================================
+// 前の4隅の周り
+//============================================================
+bool QRDetectionScheduler::ScanROI(QRDecoder& decoder, const cv::Mat& gray, std::string& text) {
+
+	// 4隅の外接矩形に余白を足す、動いても収まるように
+	cv::Rect bounds = cv::boundingRect(corners_);
+	int padding = static_cast<int>(static_cast<float>((std::max)(bounds.width, bounds.height)) * settings_.roiPadding);
+	cv::Rect roi(bounds.x - padding, bounds.y - padding, bounds.width + padding * 2, bounds.height + padding * 2);
+	roi &= cv::Rect(0, 0, gray.cols, gray.rows);
+	if (roi.width < kMinROISize || roi.height < kMinROISize) {
+		return false;
+	}
+
+	// 部分の行列はコピーしない
+	text = decoder.Detect(gray(roi), points_);
+	if (points_.empty()) {
+		return false;
+	}
+
+	// 読めなくても位置が分かれば追い続ける
+	for (cv::Point2f& point : points_) {
+		point.x += static_cast<float>(roi.x);
+		point.y += static_cast<float>(roi.y);
+	}
+	corners_.swap(points_);
+	return true;
+}
+
+//============================================================
+// 縮小した画像で探す
+//============================================================
+bool QRDetectionScheduler::ScanPyramid(QRDecoder& decoder, const cv::Mat& gray, std::string& text) {
+
+	// 半分ずつ縮小する、平滑化してあるのでそのまま
+	const cv::Mat* source = &gray;
+	for (uint32_t level = 0; level < settings_.pyramidLevel; ++level) {
+
+		cv::pyrDown(*source, level % 2 == 0 ? pyramid_ : pyramidWork_);
+		source = level % 2 == 0 ? &pyramid_ : &pyramidWork_;
+	}
+
+	if (!decoder.Locate(*source, points_)) {
+		return false;
+	}
+
+	// 元の大きさに戻して、その周りを読む
+	float scale = static_cast<float>(1u << settings_.pyramidLevel);
+	for (cv::Point2f& point : points_) {
+		point *= scale;
+	}
+	corners_.swap(points_);
+	missCount_ = 0;
+
+	if (!ScanROI(decoder, gray, text)) {
+		// 元の大きさで見つからなければ、次のフレームでもう一度ROIを試す
+		missCount_ = 1;
+	}
+	return true;
+}
+
+//============================================================
+// 全体
+//============================================================
+bool QRDetectionScheduler::ScanFull(QRDecoder& decoder, const cv::Mat& gray, std::string& text) {
+
+	framesSinceFullScan_ = 0;
+
+	text = decoder.Detect(gray, points_);
+	if (points_.empty()) {
+		return false;
+	}
+
+	corners_.swap(points_);
+	missCount_ = 0;
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+#pragma once
+
+/// OpenCV
+#include <opencv2/core.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "QRDecoder.h"
+
+//================================================
+// QRDetectionScheduler Class
+//================================================
+/// QRコードの検出をフレームごとにどこまで行うか決める
+/// 見つかっている間は前の4隅の周りだけを読み、見失ったら縮小した画像か全体を探す
+/// 全体の探索は重いので、1フレームの予算を溜めて見積もりの時間に足りたときだけ行う。1つのスレッドから使う
+class QRDetectionScheduler {
+public:
+	//====================
+	// public
+	//====================
+
+	// 探し方
+	enum class Scan {
+
+		None,    // 予算が足りないので探さない
+		ROI,     // 前の4隅の周りだけ
+		Pyramid, // 縮小した画像で位置を探し、見つかった所を元の大きさで読む
+		Full,    // 全体
+	};
+
+	// 設定
+	struct Settings {
+
+		float budgetMs = 8.0f;              // 1フレームで検出に使える時間
+		float budgetLimit = 4.0f;           // 溜められる予算、budgetMsの何フレーム分か
+		float roiPadding = 0.25f;           // 4隅の外接矩形の周りに足す余白、一辺に対して
+		uint32_t lostFrameCount = 3;        // ROIで続けてこの回数見つからなければ見失ったとする
+		uint32_t pyramidLevel = 1;          // 縮小の回数、1回で半分
+		uint32_t maxFullScanInterval = 30;  // 予算が足りなくても、この間隔で全体を探す
+	};
+
+	// 1フレームの結果
+	struct Result {
+
+		std::string text;       // 読めたQRコード、なければ空
+		Scan scan = Scan::None;
+		bool isTracked = false; // フレームの始めに見つかっていたか
+		float costMs = 0.0f;    // 検出にかかった時間
+	};
+
+	// 統計、見つかっている間とそれ以外に分ける
+	struct Stats {
+
+		uint64_t trackedFrames = 0;
+		uint64_t untrackedFrames = 0;
+		double trackedMs = 0.0;
+		double untrackedMs = 0.0;
+		uint64_t scanCounts[4] = {}; // Scanごとの回数
+		uint64_t lostCount = 0;      // 見失った回数
+	};
+
+	QRDetectionScheduler() = default;
+	QRDetectionScheduler(const Settings& settings) : settings_(settings) {}
+	~QRDetectionScheduler() = default;
+
+	// grayから検出とデコード、decoderの検出器を使う
+	Result Detect(QRDecoder& decoder, const cv::Mat& gray);
+
+	// 見失った状態に戻す、見積もりと統計は残す
+	void Reset();
+
+	// setter
+
+	void SetSettings(const Settings& settings) { settings_ = settings; }
+
+	// getter
+
+	const Settings& GetSettings() const { return settings_; }
+	const Stats& GetStats() const { return stats_; }
+	// 見つかっているか
+	bool IsTracking() const { return !corners_.empty(); }
+	// 最後に見つかった4隅、見失っていれば空
+	const std::vector<cv::Point2f>& GetCorners() const { return corners_; }
+
+private:
+	//====================
+	// private
+	//====================
+
+	// 見積もりの移動平均の重み
+	static constexpr float kCostSmoothing = 0.2f;
+	// これより小さいROIは読めないので見失ったとする
+	static const int kMinROISize = 21;
+
+	// 前の4隅の周り、見つかればcorners_を更新してtrue
+	bool ScanROI(QRDecoder& decoder, const cv::Mat& gray, std::string& text);
+	// 縮小した画像で探す
+	bool ScanPyramid(QRDecoder& decoder, const cv::Mat& gray, std::string& text);
+	// 全体
+	bool ScanFull(QRDecoder& decoder, const cv::Mat& gray, std::string& text);
+
+	Settings settings_;
+	Stats stats_;
+
+	// 最後に見つかった4隅
+	std::vector<cv::Point2f> corners_;
+	// 作業用
+	std::vector<cv::Point2f> points_;
+	cv::Mat pyramid_;
+	cv::Mat pyramidWork_;
+
+	// ROIで続けて見つからなかった回数
+	uint32_t missCount_ = 0;
+	// 最後に全体を探してからのフレーム数
+	uint32_t framesSinceFullScan_ = 0;
+	// 溜まっている予算、使いすぎると負になり次の探索が遅れる
+	float creditMs_ = 0.0f;
+	// 見積もり、0ならまだ計っていない
+	float fullCostMs_ = 0.0f;
+	float pyramidCostMs_ = 0.0f;
+};
\ No newline at end of file
@@ -0,0 +1,30 @@
+#include "RecordingBarrierContext.h"
+
+//============================================================
+// 記録
+//============================================================
+void RecordingBarrierContext::ResourceBarrier(const RenderGraphBarrier* barriers, uint32_t count) {
+
+	batches_.emplace_back(barriers, barriers + count);
+	barrierCount_ += count;
+}
+
+//============================================================
+// 内容の破棄の記録
+//============================================================
+void RecordingBarrierContext::DiscardResource(RenderGraphResource resource) {
+
+	discards_.push_back(resource);
+	discardBatchCounts_.push_back(static_cast<uint32_t>(batches_.size()));
+}
+
+//============================================================
+// 記録の破棄
+//============================================================
+void RecordingBarrierContext::Clear() {
+
+	batches_.clear();
+	barrierCount_ = 0;
+	discards_.clear();
+	discardBatchCounts_.clear();
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "RenderGraph.h"
+
+//================================================
+// RecordingBarrierContext Class
+//================================================
+/// GPUに送らず、記録したバリアをそのまま残すIBarrierContext
+/// RenderGraphのパスの消し方やバリアのまとめ方の確認に使う
+class RecordingBarrierContext : public IBarrierContext {
+public:
+	//====================
+	// public
+	//====================
+
+	RecordingBarrierContext() = default;
+	~RecordingBarrierContext() override = default;
+
+	void ResourceBarrier(const RenderGraphBarrier* barriers, uint32_t count) override;
+	void DiscardResource(RenderGraphResource resource) override;
+
+	// 記録の破棄
+	void Clear();
+
+	// getter
+
+	// 記録したバリア、呼び出し1回分ずつ
+	const std::vector<std::vector<RenderGraphBarrier>>& GetBatches() const { return batches_; }
+	uint32_t GetBarrierCount() const { return barrierCount_; }
+	// 内容を捨てたもの、呼ばれた順
+	const std::vector<RenderGraphResource>& GetDiscards() const { return discards_; }
+	// 捨てる前に記録したバッチの数、バリアの後に捨てているかの確認に使う
+	const std::vector<uint32_t>& GetDiscardBatchCounts() const { return discardBatchCounts_; }
+
+private:
+	//====================
+	// private
+	//====================
+
+	std::vector<std::vector<RenderGraphBarrier>> batches_;
+	uint32_t barrierCount_ = 0;
+	std::vector<RenderGraphResource> discards_;
+	std::vector<uint32_t> discardBatchCounts_;
+};
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "RecordingCommandContext.h"
+
+//============================================================
+// 比較
+//============================================================
+bool RecordingCommandContext::Entry::operator==(const Entry& other) const {
+
+	return op == other.op &&
+		args[0] == other.args[0] && args[1] == other.args[1] && args[2] == other.args[2] && args[3] == other.args[3] &&
+		value == other.value;
+}
+
+//============================================================
+// 記録
+//============================================================
+void RecordingCommandContext::SetPipeline(uint32_t pipelineType) {
+
+	entries_.push_back({ Op::SETPIPELINE, { pipelineType, 0, 0, 0 }, 0 });
+}
+
+void RecordingCommandContext::SetVertexBuffer(uint64_t address, uint32_t sizeInBytes, uint32_t strideInBytes) {
+
+	entries_.push_back({ Op::SETVERTEXBUFFER, { sizeInBytes, strideInBytes, 0, 0 }, address });
+}
+
+void RecordingCommandContext::SetIndexBuffer(uint64_t address, uint32_t sizeInBytes) {
+
+	entries_.push_back({ Op::SETINDEXBUFFER, { sizeInBytes, 0, 0, 0 }, address });
+}
+
+void RecordingCommandContext::SetRootConstantBuffer(uint32_t rootIndex, uint64_t address) {
+
+	entries_.push_back({ Op::SETROOTCONSTANTBUFFER, { rootIndex, 0, 0, 0 }, address });
+}
+
+void RecordingCommandContext::SetRootShaderResource(uint32_t rootIndex, uint64_t address) {
+
+	entries_.push_back({ Op::SETROOTSHADERRESOURCE, { rootIndex, 0, 0, 0 }, address });
+}
+
+void RecordingCommandContext::SetRootDescriptorTable(uint32_t rootIndex, uint64_t gpuHandle) {
+
+	entries_.push_back({ Op::SETROOTDESCRIPTORTABLE, { rootIndex, 0, 0, 0 }, gpuHandle });
+}
+
+void RecordingCommandContext::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex) {
+
+	entries_.push_back({ Op::DRAW, { vertexCount, instanceCount, startVertex, 0 }, 0 });
+	drawCount_++;
+}
+
+void RecordingCommandContext::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, uint32_t baseVertex) {
+
+	entries_.push_back({ Op::DRAWINDEXED, { indexCount, instanceCount, startIndex, baseVertex }, 0 });
+	drawCount_++;
+}
+
+//============================================================
+// 記録の連結
+//============================================================
+void RecordingCommandContext::Append(const RecordingCommandContext& other) {
+
+	entries_.insert(entries_.end(), other.entries_.begin(), other.entries_.end());
+	drawCount_ += other.drawCount_;
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "DrawCommand.h"
+
+//================================================
+// RecordingCommandContext Class
+//================================================
+/// GPUに送らず、記録した内容をそのまま残すICommandContext
+/// 分割して記録した結果を並べたものが、1つで記録したものと一致するかの確認に使う
+class RecordingCommandContext : public ICommandContext {
+public:
+	//====================
+	// public
+	//====================
+
+	// 記録したコマンドの種類
+	enum class Op : uint32_t {
+
+		SETPIPELINE,
+		SETVERTEXBUFFER,
+		SETINDEXBUFFER,
+		SETROOTCONSTANTBUFFER,
+		SETROOTSHADERRESOURCE,
+		SETROOTDESCRIPTORTABLE,
+		DRAW,
+		DRAWINDEXED,
+	};
+
+	// 記録1つ分
+	struct Entry {
+
+		Op op;
+		uint32_t args[4];
+		uint64_t value;
+
+		bool operator==(const Entry& other) const;
+	};
+
+	RecordingCommandContext() = default;
+	~RecordingCommandContext() override = default;
+
+	void SetPipeline(uint32_t pipelineType) override;
+	void SetVertexBuffer(uint64_t address, uint32_t sizeInBytes, uint32_t strideInBytes) override;
+	void SetIndexBuffer(uint64_t address, uint32_t sizeInBytes) override;
+	void SetRootConstantBuffer(uint32_t rootIndex, uint64_t address) override;
+	void SetRootShaderResource(uint32_t rootIndex, uint64_t address) override;
+	void SetRootDescriptorTable(uint32_t rootIndex, uint64_t gpuHandle) override;
+	void Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex) override;
+	void DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, uint32_t baseVertex) override;
+
+	// 記録の破棄
+	void Clear() {
+		entries_.clear();
+		drawCount_ = 0;
+	}
+
+	// 他の記録を後ろにつなげる、提出順に並べるのに使う
+	void Append(const RecordingCommandContext& other);
+
+	// getter
+
+	const std::vector<Entry>& GetEntries() const { return entries_; }
+	uint32_t GetDrawCount() const { return drawCount_; }
+
+private:
+	//====================
+	// private
+	//====================
+
+	std::vector<Entry> entries_;
+	uint32_t drawCount_ = 0;
+};
\ No newline at end of file
@@ -0,0 +1,19 @@
+#include "RecordingCopyContext.h"
+
+//============================================================
+// 記録
+//============================================================
+void RecordingCopyContext::CopyBuffer(void* destination, uint64_t destinationOffset, uint64_t stagingOffset, uint64_t size) {
+
+	entries_.push_back({ Op::COPYBUFFER, destination, { destinationOffset, stagingOffset, size }, {} });
+}
+
+void RecordingCopyContext::CopyTexture(void* destination, uint32_t subresource, const UploadFootprint& footprint) {
+
+	entries_.push_back({ Op::COPYTEXTURE, destination, { subresource, 0, 0 }, footprint });
+}
+
+void RecordingCopyContext::FinishUpload(void* destination, bool isTexture) {
+
+	entries_.push_back({ Op::FINISHUPLOAD, destination, { isTexture ? 1u : 0u, 0, 0 }, {} });
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "UploadQueue.h"
+
+//================================================
+// RecordingCopyContext Class
+//================================================
+/// GPUに送らず、記録したコピーをそのまま残すICopyContext
+/// UploadQueueの詰め方やbudgetでの区切り方の確認に使う
+class RecordingCopyContext : public ICopyContext {
+public:
+	//====================
+	// public
+	//====================
+
+	// 記録したコマンドの種類
+	enum class Op : uint32_t {
+
+		COPYBUFFER,
+		COPYTEXTURE,
+		FINISHUPLOAD,
+	};
+
+	// 記録1つ分
+	struct Entry {
+
+		Op op;
+		void* destination;
+		// COPYBUFFER    : コピー先の位置、ステージングの位置、サイズ
+		// COPYTEXTURE   : サブリソースの番号
+		// FINISHUPLOAD  : テクスチャなら1
+		uint64_t args[3];
+		UploadFootprint footprint;
+	};
+
+	RecordingCopyContext() = default;
+	~RecordingCopyContext() override = default;
+
+	void CopyBuffer(void* destination, uint64_t destinationOffset, uint64_t stagingOffset, uint64_t size) override;
+	void CopyTexture(void* destination, uint32_t subresource, const UploadFootprint& footprint) override;
+	void FinishUpload(void* destination, bool isTexture) override;
+
+	// 記録の破棄
+	void Clear() { entries_.clear(); }
+
+	// getter
+
+	const std::vector<Entry>& GetEntries() const { return entries_; }
+
+private:
+	//====================
+	// private
+	//====================
+
+	std::vector<Entry> entries_;
+};
\ No newline at end of file
@@ -0,0 +1,31 @@
+#include "RecordingGeometryAllocator.h"
+
+#include <cassert>
+
+//============================================================
+// ページの確保
+//============================================================
+GeometryPage RecordingGeometryAllocator::AllocatePage(uint64_t size) {
+
+	memories_.push_back(std::make_unique<uint8_t[]>(static_cast<size_t>(size)));
+	allocatedSizes_.push_back(size);
+
+	GeometryPage page{};
+	page.cpuAddress = memories_.back().get();
+	page.gpuAddress = reinterpret_cast<uint64_t>(page.cpuAddress);
+	page.size = size;
+	page.handle = page.cpuAddress;
+	return page;
+}
+
+//============================================================
+// ページの返却
+//============================================================
+void RecordingGeometryAllocator::FreePage(GeometryPage& page) {
+
+	// 二重の返却
+	assert(page.handle);
+
+	page = {};
+	freeCount_++;
+}
\ No newline at end of file
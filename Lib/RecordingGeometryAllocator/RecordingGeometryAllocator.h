@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "GeometryArena.h"
+
+//================================================
+// RecordingGeometryAllocator Class
+//================================================
+/// アップロードバッファの代わりにメモリを返し、確保と返却を記録するIGeometryAllocator
+/// GeometryArenaのページの使い回しと大きくなり方の確認に使う
+class RecordingGeometryAllocator : public IGeometryAllocator {
+public:
+	//====================
+	// public
+	//====================
+
+	RecordingGeometryAllocator() = default;
+	~RecordingGeometryAllocator() override = default;
+
+	// GPUのアドレスはメモリのアドレスをそのまま使う
+	GeometryPage AllocatePage(uint64_t size) override;
+	void FreePage(GeometryPage& page) override;
+
+	// getter
+
+	// 確保を頼まれた大きさ、頼まれた順
+	const std::vector<uint64_t>& GetAllocatedSizes() const { return allocatedSizes_; }
+	uint32_t GetFreeCount() const { return freeCount_; }
+	// 返却されていないページの数
+	uint32_t GetLivePageCount() const { return static_cast<uint32_t>(allocatedSizes_.size()) - freeCount_; }
+
+private:
+	//====================
+	// private
+	//====================
+
+	// ページのメモリ、返却されても最後まで持っておき、返却後のアドレスが使い回されないようにする
+	std::vector<std::unique_ptr<uint8_t[]>> memories_;
+
+	std::vector<uint64_t> allocatedSizes_;
+	uint32_t freeCount_ = 0;
+};
\ No newline at end of file
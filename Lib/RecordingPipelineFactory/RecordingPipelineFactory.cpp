@@ -0,0 +1,17 @@
+#include "RecordingPipelineFactory.h"
+
+//============================================================
+// 生成
+//============================================================
+void* RecordingPipelineFactory::CreatePipeline(const PipelineDesc& desc) {
+
+	return &createdDescs_.emplace_back(desc);
+}
+
+//============================================================
+// 破棄
+//============================================================
+void RecordingPipelineFactory::DestroyPipeline([[maybe_unused]] void* pipeline) {
+
+	destroyCount_++;
+}
\ No newline at end of file
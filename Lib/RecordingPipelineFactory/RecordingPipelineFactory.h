@@ -0,0 +1,40 @@
+#pragma once
+
+#include <deque>
+#include <cstdint>
+
+#include "PipelineCache.h"
+
+//================================================
+// RecordingPipelineFactory Class
+//================================================
+/// GPUを使わず、生成を頼まれた設定をそのまま残すIPipelineFactory
+/// PipelineCacheのハッシュの引き方や生成の回数の確認に使う
+class RecordingPipelineFactory : public IPipelineFactory {
+public:
+	//====================
+	// public
+	//====================
+
+	RecordingPipelineFactory() = default;
+	~RecordingPipelineFactory() override = default;
+
+	// 生成したものとして、記録した設定の場所を返す
+	void* CreatePipeline(const PipelineDesc& desc) override;
+	void DestroyPipeline(void* pipeline) override;
+
+	// getter
+
+	// 生成を頼まれた設定、頼まれた順
+	const std::deque<PipelineDesc>& GetCreatedDescs() const { return createdDescs_; }
+	uint32_t GetDestroyCount() const { return destroyCount_; }
+
+private:
+	//====================
+	// private
+	//====================
+
+	// 場所が変わらないようにdeque
+	std::deque<PipelineDesc> createdDescs_;
+	uint32_t destroyCount_ = 0;
+};
\ No newline at end of file
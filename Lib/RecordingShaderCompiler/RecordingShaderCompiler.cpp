@@ -0,0 +1,47 @@
+#include "RecordingShaderCompiler.h"
+
+#include <fstream>
+#include <iterator>
+
+//============================================================
+// コンパイル
+//============================================================
+bool RecordingShaderCompiler::Compile(const ShaderRequest& request, std::vector<uint8_t>& bytecode, std::string& error) {
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		compiledPaths_.push_back(request.path.generic_string());
+	}
+
+	std::ifstream file(request.path, std::ios::binary);
+	if (!file) {
+		error = "cannot open " + request.path.generic_string();
+		return false;
+	}
+
+	// ソースの後ろにプロファイルを付けたものを結果とする
+	bytecode.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	for (wchar_t c : request.profile) {
+		bytecode.push_back(static_cast<uint8_t>(c));
+	}
+
+	return true;
+}
+
+//============================================================
+// 記録の破棄
+//============================================================
+void RecordingShaderCompiler::Clear() {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	compiledPaths_.clear();
+}
+
+//============================================================
+// コンパイルを頼まれたファイル
+//============================================================
+std::vector<std::string> RecordingShaderCompiler::GetCompiledPaths() const {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	return compiledPaths_;
+}
\ No newline at end of file
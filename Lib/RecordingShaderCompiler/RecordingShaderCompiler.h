@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <cstdint>
+
+#include "ShaderCache.h"
+
+//================================================
+// RecordingShaderCompiler Class
+//================================================
+/// コンパイラを使わず、ソースとプロファイルをそのままバイナリとして返すIShaderCompiler
+/// ShaderCacheのキーの作り方やコンパイルの回数の確認に使う
+class RecordingShaderCompiler : public IShaderCompiler {
+public:
+	//====================
+	// public
+	//====================
+
+	RecordingShaderCompiler() = default;
+	~RecordingShaderCompiler() override = default;
+
+	// 読めないファイルは失敗にする
+	bool Compile(const ShaderRequest& request, std::vector<uint8_t>& bytecode, std::string& error) override;
+
+	// 記録の破棄
+	void Clear();
+
+	// getter
+
+	// コンパイルを頼まれたファイル、終わった順
+	std::vector<std::string> GetCompiledPaths() const;
+
+private:
+	//====================
+	// private
+	//====================
+
+	// 複数のスレッドから呼ばれる
+	mutable std::mutex mutex_;
+	std::vector<std::string> compiledPaths_;
+};
\ No newline at end of file
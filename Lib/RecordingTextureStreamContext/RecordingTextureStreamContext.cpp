@@ -0,0 +1,9 @@
+#include "RecordingTextureStreamContext.h"
+
+//============================================================
+// 常駐ミップの反映
+//============================================================
+void RecordingTextureStreamContext::SetResidentMip(StreamTextureId id, uint32_t mip) {
+
+	entries_.push_back({ id, mip });
+}
\ No newline at end of file
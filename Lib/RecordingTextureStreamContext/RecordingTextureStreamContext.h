@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "TextureStreamer.h"
+
+//================================================
+// RecordingTextureStreamContext Class
+//================================================
+/// リソースを作らず、反映を頼まれた常駐ミップを記録するだけのITextureStreamContext
+/// TextureStreamerの読み込みと追い出しの判断の確認に使う
+class RecordingTextureStreamContext : public ITextureStreamContext {
+public:
+	//====================
+	// public
+	//====================
+
+	// 反映1回分
+	struct Entry {
+
+		StreamTextureId id = TextureStreamer::kInvalidId;
+		uint32_t mip = 0;
+	};
+
+	RecordingTextureStreamContext() = default;
+	~RecordingTextureStreamContext() override = default;
+
+	void SetResidentMip(StreamTextureId id, uint32_t mip) override;
+
+	// 記録の破棄
+	void Clear() { entries_.clear(); }
+
+	// getter
+
+	// 反映を頼まれた順
+	const std::vector<Entry>& GetEntries() const { return entries_; }
+
+private:
+	//====================
+	// private
+	//====================
+
+	std::vector<Entry> entries_;
+};
\ No newline at end of file
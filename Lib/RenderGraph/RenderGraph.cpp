@@ -0,0 +1,478 @@
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+//============================================================
+// 読み取りの宣言
+//============================================================
+void RenderGraphBuilder::Read(RenderGraphResource resource, uint32_t state) {
+
+	assert(resource < graph_.resources_.size());
+	assert((state & ~RenderGraph::kReadStates) == 0);
+
+	auto& accesses = graph_.passes_[passIndex_].accesses;
+	for (auto& access : accesses) {
+		if (access.resource == resource) {
+
+			// 書き込むなら書き込みの状態のまま、読むだけなら状態をまとめる
+			if (!access.isWrite) {
+				access.state |= state;
+			}
+			return;
+		}
+	}
+
+	accesses.push_back({ resource, state, false });
+}
+
+//============================================================
+// 書き込みの宣言
+//============================================================
+void RenderGraphBuilder::Write(RenderGraphResource resource, uint32_t state) {
+
+	assert(resource < graph_.resources_.size());
+
+	auto& accesses = graph_.passes_[passIndex_].accesses;
+	for (auto& access : accesses) {
+		if (access.resource == resource) {
+
+			// 1つのパスで2種類の書き込みはできない
+			assert(!access.isWrite || access.state == state);
+			access.state = state;
+			access.isWrite = true;
+			return;
+		}
+	}
+
+	accesses.push_back({ resource, state, true });
+}
+
+//============================================================
+// 消さないパスにする
+//============================================================
+void RenderGraphBuilder::SetSideEffect() {
+
+	graph_.passes_[passIndex_].hasSideEffect = true;
+}
+
+//============================================================
+// リセット
+//============================================================
+void RenderGraph::Reset() {
+
+	passes_.clear();
+	resources_.clear();
+	compiledPasses_.clear();
+	finalBarriers_.clear();
+	placements_.clear();
+
+	stats_ = {};
+}
+
+//============================================================
+// 外部のリソースの登録
+//============================================================
+RenderGraphResource RenderGraph::ImportResource(const std::string& name, uint32_t initialState, uint32_t finalState) {
+
+	Resource resource{};
+	resource.name = name;
+	resource.imported = true;
+	resource.initialState = initialState;
+	resource.finalState = finalState;
+	resource.desc.name = name;
+
+	resources_.push_back(resource);
+	return static_cast<RenderGraphResource>(resources_.size() - 1);
+}
+
+//============================================================
+// 一時的なテクスチャの登録
+//============================================================
+RenderGraphResource RenderGraph::CreateTexture(const RenderGraphTextureDesc& desc) {
+
+	// サイズは登録前に求めておく
+	assert(desc.size > 0);
+	assert(desc.alignment > 0 && (desc.alignment & (desc.alignment - 1)) == 0);
+
+	Resource resource{};
+	resource.name = desc.name;
+	resource.imported = false;
+	resource.initialState = desc.usage;
+	resource.finalState = desc.usage;
+	resource.desc = desc;
+
+	resources_.push_back(resource);
+	return static_cast<RenderGraphResource>(resources_.size() - 1);
+}
+
+//============================================================
+// パスの登録
+//============================================================
+void RenderGraph::AddPass(const std::string& name,
+	const std::function<void(RenderGraphBuilder&)>& setup, std::function<void()> execute) {
+
+	Pass pass{};
+	pass.name = name;
+	pass.execute = std::move(execute);
+	pass.hasSideEffect = false;
+	pass.isCulled = false;
+	passes_.push_back(std::move(pass));
+
+	RenderGraphBuilder builder(*this, static_cast<uint32_t>(passes_.size() - 1));
+	if (setup) {
+		setup(builder);
+	}
+}
+
+//============================================================
+// コンパイル
+//============================================================
+void RenderGraph::Compile() {
+
+	auto start = std::chrono::steady_clock::now();
+
+	stats_ = {};
+	stats_.passCount = static_cast<uint32_t>(passes_.size());
+
+	CullPasses();
+	CalculateLifetimes();
+	PlaceTransients();
+	BuildBarriers();
+
+	stats_.compileTimeMs =
+		std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+//============================================================
+// 実行
+//============================================================
+void RenderGraph::Execute(IBarrierContext& context) {
+
+	for (uint32_t passIndex : compiledPasses_) {
+
+		Pass& pass = passes_[passIndex];
+		if (!pass.barriers.empty()) {
+			context.ResourceBarrier(pass.barriers.data(), static_cast<uint32_t>(pass.barriers.size()));
+		}
+		for (RenderGraphResource resource : pass.discards) {
+			context.DiscardResource(resource);
+		}
+
+		if (pass.execute) {
+			pass.execute();
+		}
+	}
+
+	if (!finalBarriers_.empty()) {
+		context.ResourceBarrier(finalBarriers_.data(), static_cast<uint32_t>(finalBarriers_.size()));
+	}
+}
+
+//============================================================
+// 実行するパスの名前
+//============================================================
+std::vector<std::string> RenderGraph::GetCompiledPassNames() const {
+
+	std::vector<std::string> names;
+	names.reserve(compiledPasses_.size());
+	for (uint32_t passIndex : compiledPasses_) {
+		names.push_back(passes_[passIndex].name);
+	}
+
+	return names;
+}
+
+//============================================================
+// 出力に繋がらないパスを消す
+//============================================================
+void RenderGraph::CullPasses() {
+
+	// 外部のリソースは外で使われるので、書き込んだパスは残す
+	std::vector<bool> required(resources_.size(), false);
+	for (size_t i = 0; i < resources_.size(); ++i) {
+		required[i] = resources_[i].imported;
+	}
+
+	// 後ろから、必要なリソースに書き込むパスを残していく
+	for (size_t i = passes_.size(); i-- > 0;) {
+
+		Pass& pass = passes_[i];
+		bool isNeeded = pass.hasSideEffect;
+		for (const auto& access : pass.accesses) {
+			if (access.isWrite && required[access.resource]) {
+				isNeeded = true;
+				break;
+			}
+		}
+
+		pass.isCulled = !isNeeded;
+		if (pass.isCulled) {
+			continue;
+		}
+
+		// 読むものは必要になる。書き込みは前の内容に続けて書くので前の書き込みも必要
+		for (const auto& access : pass.accesses) {
+			required[access.resource] = true;
+		}
+	}
+
+	// 登録順に並べる、登録の時点で読むものは先に書かれているので依存の順になっている
+	compiledPasses_.clear();
+	for (uint32_t i = 0; i < passes_.size(); ++i) {
+		if (passes_[i].isCulled) {
+			++stats_.culledPassCount;
+		} else {
+			compiledPasses_.push_back(i);
+		}
+	}
+}
+
+//============================================================
+// 寿命を求める
+//============================================================
+void RenderGraph::CalculateLifetimes() {
+
+	for (auto& resource : resources_) {
+		resource.firstPass = ~0u;
+		resource.lastPass = 0;
+	}
+
+	for (uint32_t i = 0; i < compiledPasses_.size(); ++i) {
+		for (const auto& access : passes_[compiledPasses_[i]].accesses) {
+
+			Resource& resource = resources_[access.resource];
+			resource.firstPass = (std::min)(resource.firstPass, i);
+			resource.lastPass = (std::max)(resource.lastPass, i);
+		}
+	}
+}
+
+//============================================================
+// 一時的なテクスチャのメモリの配置
+//============================================================
+void RenderGraph::PlaceTransients() {
+
+	placements_.clear();
+
+	std::vector<RenderGraphResource> transients;
+	for (uint32_t i = 0; i < resources_.size(); ++i) {
+		if (!resources_[i].imported && resources_[i].firstPass != ~0u) {
+			transients.push_back(i);
+		}
+	}
+
+	// 大きいものから置くと隙間が少なくなる
+	std::sort(transients.begin(), transients.end(), [this](RenderGraphResource a, RenderGraphResource b) {
+		if (resources_[a].desc.size != resources_[b].desc.size) {
+			return resources_[a].desc.size > resources_[b].desc.size;
+		}
+		return a < b;
+		});
+
+	std::vector<const RenderGraphPlacement*> conflicts;
+	for (RenderGraphResource index : transients) {
+
+		const Resource& resource = resources_[index];
+		uint64_t size = resource.desc.size;
+		uint64_t alignment = resource.desc.alignment;
+
+		// 寿命が重なるものとはメモリを共有できない
+		conflicts.clear();
+		for (const auto& placement : placements_) {
+			const Resource& other = resources_[placement.resource];
+			if (other.firstPass <= resource.lastPass && resource.firstPass <= other.lastPass) {
+				conflicts.push_back(&placement);
+			}
+		}
+		std::sort(conflicts.begin(), conflicts.end(), [](const RenderGraphPlacement* a, const RenderGraphPlacement* b) {
+			return a->offset < b->offset;
+			});
+
+		// 前から見て、最初に入る隙間に置く
+		uint64_t offset = 0;
+		for (const auto* conflict : conflicts) {
+
+			uint64_t alignedOffset = (offset + alignment - 1) & ~(alignment - 1);
+			if (alignedOffset + size <= conflict->offset) {
+				break;
+			}
+			offset = (std::max)(offset, conflict->offset + conflict->size);
+		}
+		offset = (offset + alignment - 1) & ~(alignment - 1);
+
+		// 最初に使うときの状態で生成しておく
+		uint32_t initialState = resource.desc.usage;
+		for (const auto& access : passes_[compiledPasses_[resource.firstPass]].accesses) {
+			if (access.resource == index) {
+				initialState = access.state;
+			}
+		}
+		resources_[index].initialState = initialState;
+
+		placements_.push_back({ index, offset, size, initialState });
+
+		++stats_.transientCount;
+		stats_.transientSize += size;
+		stats_.transientHeapSize = (std::max)(stats_.transientHeapSize, offset + size);
+	}
+
+	// 番号順にしておく
+	std::sort(placements_.begin(), placements_.end(), [](const RenderGraphPlacement& a, const RenderGraphPlacement& b) {
+		return a.resource < b.resource;
+		});
+}
+
+//============================================================
+// バリアを組み立てる
+//============================================================
+void RenderGraph::BuildBarriers() {
+
+	// 配置の検索用
+	std::vector<const RenderGraphPlacement*> placementOf(resources_.size(), nullptr);
+	for (const auto& placement : placements_) {
+		placementOf[placement.resource] = &placement;
+	}
+
+	// メモリを他と共有しているか
+	auto findPreviousOccupant = [&](RenderGraphResource index, bool& isShared) {
+
+		const RenderGraphPlacement* self = placementOf[index];
+		const Resource& resource = resources_[index];
+		RenderGraphResource previous = kInvalidResource;
+		uint32_t previousLastPass = 0;
+		isShared = false;
+
+		for (const auto& placement : placements_) {
+			if (placement.resource == index ||
+				placement.offset >= self->offset + self->size || self->offset >= placement.offset + placement.size) {
+				continue;
+			}
+
+			isShared = true;
+			const Resource& other = resources_[placement.resource];
+			if (other.lastPass < resource.firstPass && (previous == kInvalidResource || other.lastPass >= previousLastPass)) {
+				previous = placement.resource;
+				previousLastPass = other.lastPass;
+			}
+		}
+
+		return previous;
+		};
+
+	// 次に書き込まれるまで続けて読む状態をまとめる
+	auto collectReadStates = [&](RenderGraphResource index, uint32_t from, uint32_t state) {
+
+		for (uint32_t i = from; i < compiledPasses_.size(); ++i) {
+			for (const auto& access : passes_[compiledPasses_[i]].accesses) {
+				if (access.resource != index) {
+					continue;
+				}
+
+				if (access.isWrite) {
+					return state;
+				}
+				state |= access.state;
+			}
+		}
+
+		return state;
+		};
+
+	std::vector<uint32_t> states(resources_.size());
+	std::vector<bool> isUavWritten(resources_.size(), false);
+	for (size_t i = 0; i < resources_.size(); ++i) {
+		states[i] = resources_[i].initialState;
+	}
+
+	for (auto& pass : passes_) {
+		pass.barriers.clear();
+		pass.discards.clear();
+	}
+	finalBarriers_.clear();
+
+	// 寿命が終わった一時的なテクスチャを次に使うときの状態へ戻す、次のパスのバリアと一緒に張る
+	std::vector<RenderGraphBarrier> restores;
+
+	for (uint32_t i = 0; i < compiledPasses_.size(); ++i) {
+
+		Pass& pass = passes_[compiledPasses_[i]];
+		pass.barriers = std::move(restores);
+		restores.clear();
+
+		for (const auto& access : pass.accesses) {
+
+			RenderGraphResource index = access.resource;
+			const Resource& resource = resources_[index];
+
+			// 他のテクスチャとメモリを共有しているときは使い始める前に切り替える
+			if (!resource.imported && resource.firstPass == i) {
+
+				bool isShared = false;
+				RenderGraphResource previous = findPreviousOccupant(index, isShared);
+				if (isShared) {
+					pass.barriers.push_back({ RenderGraphBarrier::Type::ALIASING, index, previous, 0, 0 });
+				}
+
+				// 置いたばかりのメモリは中身が決まっていないので、書き込む前に捨てて初期化する
+				// DiscardResourceはRT、DS、UAVの状態でしか使えないので、その状態で書くときだけ
+				// それ以外の使い始めは、パスの中で全体を書き換える前提
+				if (access.isWrite && access.state == resource.desc.usage) {
+					pass.discards.push_back(index);
+					++stats_.discardCount;
+				}
+			}
+
+			uint32_t target = access.state;
+			if (!access.isWrite) {
+
+				// 今の読み取りの状態で足りるならそのまま
+				uint32_t current = states[index];
+				if (current != 0 && (current & ~kReadStates) == 0 && (current & target) == target) {
+					continue;
+				}
+				target = collectReadStates(index, i + 1, target);
+			}
+
+			if (states[index] != target) {
+				pass.barriers.push_back({ RenderGraphBarrier::Type::TRANSITION, index, kInvalidResource, states[index], target });
+			} else if (target == RENDERGRAPH_STATE_UNORDEREDACCESS && isUavWritten[index]) {
+				// UAVへの書き込みの後は、同じ状態でも書き終わるのを待つ
+				pass.barriers.push_back({ RenderGraphBarrier::Type::UNORDEREDACCESS, index, kInvalidResource, target, target });
+			}
+
+			states[index] = target;
+			isUavWritten[index] = access.isWrite && target == RENDERGRAPH_STATE_UNORDEREDACCESS;
+		}
+
+		for (const auto& access : pass.accesses) {
+
+			RenderGraphResource index = access.resource;
+			const Resource& resource = resources_[index];
+			if (!resource.imported && resource.lastPass == i && states[index] != resource.initialState) {
+				restores.push_back({ RenderGraphBarrier::Type::TRANSITION, index, kInvalidResource, states[index], resource.initialState });
+				states[index] = resource.initialState;
+			}
+		}
+	}
+
+	// 外部のリソースは指定の状態で返す
+	finalBarriers_ = std::move(restores);
+	for (uint32_t i = 0; i < resources_.size(); ++i) {
+		if (resources_[i].imported && states[i] != resources_[i].finalState) {
+			finalBarriers_.push_back({ RenderGraphBarrier::Type::TRANSITION, i, kInvalidResource, states[i], resources_[i].finalState });
+		}
+	}
+
+	for (uint32_t passIndex : compiledPasses_) {
+		if (!passes_[passIndex].barriers.empty()) {
+			stats_.barrierCount += static_cast<uint32_t>(passes_[passIndex].barriers.size());
+			++stats_.barrierBatchCount;
+		}
+	}
+	if (!finalBarriers_.empty()) {
+		stats_.barrierCount += static_cast<uint32_t>(finalBarriers_.size());
+		++stats_.barrierBatchCount;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <cstdint>
+
+// リソースの番号
+using RenderGraphResource = uint32_t;
+
+// リソースの状態、値はD3D12_RESOURCE_STATESと同じなのでそのまま渡せる
+enum RenderGraphState : uint32_t {
+
+	RENDERGRAPH_STATE_COMMON = 0,
+	RENDERGRAPH_STATE_PRESENT = 0,
+	RENDERGRAPH_STATE_RENDERTARGET = 0x4,
+	RENDERGRAPH_STATE_UNORDEREDACCESS = 0x8,
+	RENDERGRAPH_STATE_DEPTHWRITE = 0x10,
+	RENDERGRAPH_STATE_DEPTHREAD = 0x20,
+	RENDERGRAPH_STATE_NONPIXELSHADERRESOURCE = 0x40,
+	RENDERGRAPH_STATE_PIXELSHADERRESOURCE = 0x80,
+	RENDERGRAPH_STATE_COPYDEST = 0x400,
+	RENDERGRAPH_STATE_COPYSOURCE = 0x800,
+};
+
+// 一時的なテクスチャの設定
+struct RenderGraphTextureDesc {
+
+	std::string name;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t format = 0;      // DXGI_FORMAT
+	// 書き込みに使う状態、RENDERTARGETかDEPTHWRITEかUNORDEREDACCESS
+	uint32_t usage = RENDERGRAPH_STATE_RENDERTARGET;
+	// メモリ上のサイズと境界、D3D12ではGetResourceAllocationInfoで求める
+	uint64_t size = 0;
+	uint64_t alignment = 65536;
+};
+
+// バリア1つ分
+struct RenderGraphBarrier {
+
+	enum class Type : uint32_t {
+
+		TRANSITION,
+		ALIASING,
+		UNORDEREDACCESS,
+	};
+
+	Type type;
+	RenderGraphResource resource;
+	// ALIASINGのとき、同じメモリを直前まで使っていたもの
+	RenderGraphResource resourceBefore;
+	uint32_t stateBefore;
+	uint32_t stateAfter;
+};
+
+// 一時的なテクスチャのメモリ上の配置
+struct RenderGraphPlacement {
+
+	RenderGraphResource resource;
+	uint64_t offset;
+	uint64_t size;
+	// 最初に使うときの状態、この状態で生成しておく
+	uint32_t initialState;
+};
+
+//================================================
+// IBarrierContext Class
+//================================================
+/// RenderGraphのバリアの記録先
+/// D3D12ではコマンドリスト、デバイスがない環境では記録内容を残すだけのものに差し替えられる
+class IBarrierContext {
+public:
+	//====================
+	// public
+	//====================
+
+	// 仮想デストラクタ
+	virtual ~IBarrierContext() {}
+
+	// まとめたバリアを1回で記録する
+	virtual void ResourceBarrier(const RenderGraphBarrier* barriers, uint32_t count) = 0;
+
+	// 一時的なテクスチャの前の内容を捨てる、D3D12ではDiscardResource
+	// 他と共有したメモリに置いたRT、DSは使い始めにClear、Discard、Copyのどれかが必要なので、最初の書き込みの前に呼ばれる
+	virtual void DiscardResource(RenderGraphResource resource) = 0;
+};
+
+class RenderGraph;
+
+//================================================
+// RenderGraphBuilder Class
+//================================================
+/// パスが使うリソースの宣言
+class RenderGraphBuilder {
+public:
+	//====================
+	// public
+	//====================
+
+	RenderGraphBuilder(RenderGraph& graph, uint32_t passIndex) : graph_(graph), passIndex_(passIndex) {}
+
+	// 読み取り、シェーダーリソースやコピー元など
+	void Read(RenderGraphResource resource, uint32_t state);
+	// 書き込み、前の内容に続けて書くので前の書き込みにも依存する
+	void Write(RenderGraphResource resource, uint32_t state);
+	// 出力に繋がらなくても消さない
+	void SetSideEffect();
+
+private:
+	//====================
+	// private
+	//====================
+
+	RenderGraph& graph_;
+	uint32_t passIndex_;
+};
+
+//================================================
+// RenderGraph Class
+//================================================
+/// パスが宣言した読み書きから、実行するパスと順番、バリア、一時的なテクスチャのメモリを決める
+/// 出力に繋がらないパスは消し、続けて読むだけのパスの間ではバリアを張らない
+/// 寿命が重ならない一時的なテクスチャは同じメモリを使う。デバイスには触らない
+class RenderGraph {
+public:
+	//====================
+	// public
+	//====================
+
+	// 無効な番号
+	static constexpr RenderGraphResource kInvalidResource = ~0u;
+
+	// 統計
+	struct Stats {
+
+		uint32_t passCount = 0;         // 登録したパスの数
+		uint32_t culledPassCount = 0;   // 消したパスの数
+		uint32_t barrierCount = 0;      // バリアの数
+		uint32_t barrierBatchCount = 0; // ResourceBarrierの呼び出し回数
+		uint32_t discardCount = 0;      // 使い始めに内容を捨てた一時的なテクスチャの数
+		uint32_t transientCount = 0;    // 使われた一時的なテクスチャの数
+		uint64_t transientSize = 0;     // 一時的なテクスチャのサイズの合計
+		uint64_t transientHeapSize = 0; // メモリを共有した後のサイズ
+		float compileTimeMs = 0.0f;     // Compileにかかった時間
+	};
+
+	RenderGraph() = default;
+	~RenderGraph() = default;
+
+	// パスとリソースを全て破棄する、フレームの最初に呼ぶ
+	void Reset();
+
+	// 外部のリソースの登録、最後にfinalStateへ戻す
+	RenderGraphResource ImportResource(const std::string& name, uint32_t initialState, uint32_t finalState);
+
+	// 一時的なテクスチャの登録、寿命が重ならないもの同士でメモリを共有する
+	RenderGraphResource CreateTexture(const RenderGraphTextureDesc& desc);
+
+	// パスの登録、setupで使うリソースを宣言し、executeで記録する
+	void AddPass(const std::string& name,
+		const std::function<void(RenderGraphBuilder&)>& setup, std::function<void()> execute);
+
+	// 実行するパスと順番、バリア、メモリの配置を決める
+	void Compile();
+
+	// バリアを挟みながらパスを実行する
+	void Execute(IBarrierContext& context);
+
+	// getter
+
+	const Stats& GetStats() const { return stats_; }
+	// 実行するパスの名前、実行順
+	std::vector<std::string> GetCompiledPassNames() const;
+	// 一時的なテクスチャの配置
+	const std::vector<RenderGraphPlacement>& GetPlacements() const { return placements_; }
+	uint64_t GetTransientHeapSize() const { return stats_.transientHeapSize; }
+	const RenderGraphTextureDesc& GetTextureDesc(RenderGraphResource resource) const { return resources_[resource].desc; }
+	bool IsTransient(RenderGraphResource resource) const { return !resources_[resource].imported; }
+	uint32_t GetResourceCount() const { return static_cast<uint32_t>(resources_.size()); }
+
+private:
+	//====================
+	// private
+	//====================
+
+	friend class RenderGraphBuilder;
+
+	// 読み取りの状態
+	static constexpr uint32_t kReadStates =
+		RENDERGRAPH_STATE_DEPTHREAD | RENDERGRAPH_STATE_NONPIXELSHADERRESOURCE |
+		RENDERGRAPH_STATE_PIXELSHADERRESOURCE | RENDERGRAPH_STATE_COPYSOURCE;
+
+	// パスでの使い方
+	struct Access {
+
+		RenderGraphResource resource;
+		uint32_t state;
+		bool isWrite;
+	};
+
+	struct Pass {
+
+		std::string name;
+		std::vector<Access> accesses;
+		std::function<void()> execute;
+		bool hasSideEffect;
+
+		// Compileで決まるもの
+		bool isCulled;
+		// パスの前に張るバリア
+		std::vector<RenderGraphBarrier> barriers;
+		// バリアの後に内容を捨てる一時的なテクスチャ
+		std::vector<RenderGraphResource> discards;
+	};
+
+	struct Resource {
+
+		std::string name;
+		bool imported;
+		uint32_t initialState;
+		uint32_t finalState;
+		RenderGraphTextureDesc desc;
+
+		// Compileで決まるもの、実行するパスの中での最初と最後
+		uint32_t firstPass;
+		uint32_t lastPass;
+	};
+
+	std::vector<Pass> passes_;
+	std::vector<Resource> resources_;
+
+	// 実行するパスの番号、実行順
+	std::vector<uint32_t> compiledPasses_;
+	// 最後のパスの後に張るバリア
+	std::vector<RenderGraphBarrier> finalBarriers_;
+	std::vector<RenderGraphPlacement> placements_;
+
+	Stats stats_;
+
+	void CullPasses();
+	void CalculateLifetimes();
+	void PlaceTransients();
+	void BuildBarriers();
+};
\ No newline at end of file
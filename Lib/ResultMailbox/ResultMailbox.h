@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+
+//================================================
+// ResultMailbox Class
+//================================================
+/// 1つのスレッドが書いた最新の結果を、別の1つのスレッドが受け取る。トリプルバッファで、どちらも待たない
+/// 書く側は書き込み用の要素に書いてPublish、読む側はReceiveで新しいものがあれば受け取る
+/// 読む前に次が書かれたら古いものは捨てる。中身は使い回すので、確保したものは次も使える
+template <typename T>
+class ResultMailbox {
+public:
+	//====================
+	// public
+	//====================
+
+	ResultMailbox() = default;
+	~ResultMailbox() = default;
+
+	// コピー禁止
+	ResultMailbox(const ResultMailbox&) = delete;
+	ResultMailbox& operator=(const ResultMailbox&) = delete;
+
+	// 書く側
+
+	// 書き込み用の要素、前に渡したものは入っていない
+	T& GetWriteBuffer() { return buffers_[writeIndex_]; }
+	// 書き込み用の要素を渡して、空いた要素を次の書き込み用にする
+	void Publish() {
+
+		uint32_t previous = middle_.exchange(writeIndex_ | kNewFlag, std::memory_order_acq_rel);
+		writeIndex_ = previous & kIndexMask;
+	}
+
+	// 読む側
+
+	// 新しい結果があれば読み込み用と入れ替えてtrue、なければ前のままfalse
+	bool Receive() {
+
+		// フラグを消すのは読む側だけなので、見えた後に入れ替えたものは必ず新しい
+		if ((middle_.load(std::memory_order_relaxed) & kNewFlag) == 0) {
+			return false;
+		}
+		uint32_t previous = middle_.exchange(readIndex_, std::memory_order_acq_rel);
+		readIndex_ = previous & kIndexMask;
+		return true;
+	}
+	// 最後に受け取った結果
+	const T& GetReadBuffer() const { return buffers_[readIndex_]; }
+
+	// 要素、スレッドを動かす前に中身を確保しておく用
+	T& GetBuffer(uint32_t index) {
+
+		assert(index < buffers_.size());
+		return buffers_[index];
+	}
+
+private:
+	//====================
+	// private
+	//====================
+
+	static constexpr uint32_t kIndexMask = 0x3;
+	static constexpr uint32_t kNewFlag = 0x4;
+
+	// 受け渡し中の要素の番号と、まだ読まれていないか
+	alignas(64) std::atomic<uint32_t> middle_ = 1;
+	// 書く側だけが触る
+	alignas(64) uint32_t writeIndex_ = 0;
+	// 読む側だけが触る
+	alignas(64) uint32_t readIndex_ = 2;
+
+	std::array<T, 3> buffers_{};
+};
\ No newline at end of file
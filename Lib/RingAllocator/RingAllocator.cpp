@@ -0,0 +1,160 @@
+#include "RingAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+
+//============================================================
+// 初期化
+//============================================================
+void RingAllocator::Initialize(uint64_t capacity) {
+
+	assert(capacity > 0);
+
+	capacity_ = capacity;
+	Reset();
+	stats_ = {};
+}
+
+//============================================================
+// 確保
+//============================================================
+uint64_t RingAllocator::Allocate(uint64_t size, uint64_t alignment) {
+
+	// alignmentは2の累乗
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+	if (size == 0 || size > capacity_ || IsFull()) {
+
+		stats_.failedCount++;
+		return kInvalidOffset;
+	}
+
+	// 空なら先頭から使い直す
+	if (IsEmpty()) {
+
+		head_ = 0;
+		tail_ = 0;
+	}
+
+	uint64_t offset = kInvalidOffset;
+	// パディングや折り返しで捨てる領域も含めた使用量
+	uint64_t addSize = 0;
+
+	if (tail_ >= head_) {
+
+		//            head        tail         capacity
+		//             |           |              |
+		//  [          xxxxxxxxxxxxx              ]
+		uint64_t alignedTail = AlignUp(tail_, alignment);
+		if (alignedTail + size <= capacity_) {
+
+			// 後ろの空きに収まる
+			offset = alignedTail;
+			addSize = (alignedTail - tail_) + size;
+			tail_ = alignedTail + size;
+		} else if (size <= head_) {
+
+			// 後ろの空きを捨てて先頭から確保する
+			offset = 0;
+			addSize = (capacity_ - tail_) + size;
+			tail_ = size;
+			stats_.wrapCount++;
+		}
+	} else {
+
+		//            tail        head         capacity
+		//             |           |              |
+		//  [xxxxxxxxxx            xxxxxxxxxxxxxxx]
+		uint64_t alignedTail = AlignUp(tail_, alignment);
+		if (alignedTail + size <= head_) {
+
+			offset = alignedTail;
+			addSize = (alignedTail - tail_) + size;
+			tail_ = alignedTail + size;
+		}
+	}
+
+	if (offset == kInvalidOffset) {
+
+		stats_.failedCount++;
+		return kInvalidOffset;
+	}
+
+	usedSize_ += addSize;
+	currentFrameSize_ += addSize;
+
+	// 統計の更新
+	stats_.allocations++;
+	stats_.usedSize = usedSize_;
+	stats_.frameSize = currentFrameSize_;
+	stats_.peakUsedSize = (std::max)(stats_.peakUsedSize, usedSize_);
+
+	return offset;
+}
+
+//============================================================
+// フレームの終了
+//============================================================
+void RingAllocator::FinishFrame(uint64_t fenceValue) {
+
+	// 確保がなければ回収するものもない
+	if (currentFrameSize_ != 0) {
+
+		frames_.push_back({ fenceValue, tail_, currentFrameSize_ });
+	}
+
+	currentFrameSize_ = 0;
+	stats_.frameSize = 0;
+}
+
+//============================================================
+// 完了したフレームの回収
+//============================================================
+void RingAllocator::ReleaseCompletedFrames(uint64_t completedFenceValue) {
+
+	while (!frames_.empty() && frames_.front().fenceValue <= completedFenceValue) {
+
+		const FrameMarker& frame = frames_.front();
+
+		assert(usedSize_ >= frame.size);
+		usedSize_ -= frame.size;
+		head_ = frame.tail;
+
+		frames_.pop_front();
+	}
+
+	// 空になったら先頭に戻しておく
+	if (IsEmpty()) {
+
+		head_ = 0;
+		tail_ = 0;
+	}
+
+	stats_.usedSize = usedSize_;
+}
+
+//============================================================
+// 全て回収
+//============================================================
+void RingAllocator::Reset() {
+
+	head_ = 0;
+	tail_ = 0;
+	usedSize_ = 0;
+	currentFrameSize_ = 0;
+	frames_.clear();
+
+	stats_.usedSize = 0;
+	stats_.frameSize = 0;
+}
+
+//============================================================
+// 容量の変更
+//============================================================
+void RingAllocator::Resize(uint64_t capacity) {
+
+	assert(capacity > 0);
+
+	capacity_ = capacity;
+	Reset();
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <deque>
+#include <cstdint>
+
+//================================================
+// RingAllocator Class
+//================================================
+/// 1つの大きなバッファをオフセットで切り分けるリングアロケータ
+/// 使い終わったフレームはフェンス値で回収する。メモリには触らない
+class RingAllocator {
+public:
+	//====================
+	// public
+	//====================
+
+	// 確保失敗
+	static constexpr uint64_t kInvalidOffset = ~0ull;
+
+	// 統計
+	struct Stats {
+
+		uint64_t usedSize = 0;       // 現在使用中のサイズ
+		uint64_t peakUsedSize = 0;   // 最大使用サイズ
+		uint64_t frameSize = 0;      // 現在のフレームで確保したサイズ
+		uint32_t allocations = 0;    // 確保回数
+		uint32_t wrapCount = 0;      // 先頭に戻った回数
+		uint32_t failedCount = 0;    // 確保に失敗した回数
+	};
+
+	RingAllocator() = default;
+	~RingAllocator() = default;
+
+	// 初期化
+	void Initialize(uint64_t capacity);
+
+	// 確保、失敗したらkInvalidOffset
+	uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+	// フレームの終了、このフレームの確保分をfenceValueに紐づける
+	void FinishFrame(uint64_t fenceValue);
+
+	// completedFenceValueまで完了したフレームの回収
+	void ReleaseCompletedFrames(uint64_t completedFenceValue);
+
+	// 全て回収
+	void Reset();
+
+	// 容量を変えて全て回収、統計は残す
+	void Resize(uint64_t capacity);
+
+	// getter
+
+	uint64_t GetCapacity() const { return capacity_; }
+	uint64_t GetUsedSize() const { return usedSize_; }
+	bool IsEmpty() const { return usedSize_ == 0; }
+	bool IsFull() const { return usedSize_ == capacity_; }
+	const Stats& GetStats() const { return stats_; }
+	// GPUの完了待ちをしているフレーム数
+	uint32_t GetPendingFrameCount() const { return static_cast<uint32_t>(frames_.size()); }
+	// 最も古い完了待ちのフェンス値、なければ0
+	uint64_t GetOldestPendingFenceValue() const { return frames_.empty() ? 0 : frames_.front().fenceValue; }
+
+private:
+	//====================
+	// private
+	//====================
+
+	// 終了したフレーム
+	struct FrameMarker {
+
+		uint64_t fenceValue; // 完了を知らせるフェンス値
+		uint64_t tail;       // フレーム終了時の確保位置
+		uint64_t size;       // フレームで使用したサイズ(折り返しの無駄も含む)
+	};
+
+	uint64_t capacity_ = 0;
+	// 使用中の先頭、GPUが読み終わるとここが進む
+	uint64_t head_ = 0;
+	// 次に確保する位置
+	uint64_t tail_ = 0;
+	uint64_t usedSize_ = 0;
+	uint64_t currentFrameSize_ = 0;
+
+	std::deque<FrameMarker> frames_;
+
+	Stats stats_;
+
+	// alignmentの倍数に切り上げ
+	static uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+};
\ No newline at end of file
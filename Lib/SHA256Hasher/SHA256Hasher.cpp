@@ -0,0 +1,606 @@
+#include "SHA256Hasher.h"
+
+#include <cstring>
+#include <algorithm>
+
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+	// 16進数の表、1バイトを2文字に。他の静的な初期化から使われてもよいようにコンパイル時に作る
+	constexpr std::array<std::array<char, 2>, 256> CreateHexTable() {
+
+		std::array<std::array<char, 2>, 256> table{};
+		const char* digits = "0123456789abcdef";
+		for (uint32_t i = 0; i < 256; ++i) {
+			table[i][0] = digits[i >> 4];
+			table[i][1] = digits[i & 0xf];
+		}
+		return table;
+	}
+	constexpr std::array<std::array<char, 2>, 256> kHexTable = CreateHexTable();
+
+	uint32_t LoadBigEndian(const uint8_t* data) {
+		return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | uint32_t(data[3]);
+	}
+
+	void StoreBigEndian(uint8_t* data, uint32_t value) {
+
+		data[0] = static_cast<uint8_t>(value >> 24);
+		data[1] = static_cast<uint8_t>(value >> 16);
+		data[2] = static_cast<uint8_t>(value >> 8);
+		data[3] = static_cast<uint8_t>(value);
+	}
+
+	uint32_t RotateRight(uint32_t value, uint32_t count) {
+		return (value >> count) | (value << (32 - count));
+	}
+
+	// メッセージの末尾、64バイトに満たない残りと詰め物とビット長。1つか2つのブロックになる
+	struct MessageTail {
+
+		alignas(16) uint8_t blocks[128];
+		size_t blockCount = 0;
+
+		// restは最後のsize % 64バイト、sizeはメッセージ全体の長さ
+		MessageTail(const uint8_t* rest, uint64_t size) {
+
+			size_t remaining = static_cast<size_t>(size % 64);
+			blockCount = remaining + 9 <= 64 ? 1 : 2;
+
+			std::memset(blocks, 0, sizeof(blocks));
+			if (remaining != 0) {
+				std::memcpy(blocks, rest, remaining);
+			}
+			blocks[remaining] = 0x80;
+
+			uint64_t bitLength = uint64_t(size) * 8;
+			uint8_t* length = blocks + blockCount * 64 - 8;
+			StoreBigEndian(length, static_cast<uint32_t>(bitLength >> 32));
+			StoreBigEndian(length + 4, static_cast<uint32_t>(bitLength));
+		}
+	};
+
+	//============================================================
+	// CPUの機能
+	//============================================================
+	struct CpuFeatures {
+
+		bool hasAVX2 = false;
+		bool hasSHA = false;
+
+		CpuFeatures() {
+
+#if defined(_MSC_VER)
+			int info[4]{};
+			__cpuid(info, 0);
+			if (info[0] < 7) {
+				return;
+			}
+
+			__cpuid(info, 1);
+			bool hasSSE41 = (info[2] & (1 << 19)) != 0;
+			bool hasSSSE3 = (info[2] & (1 << 9)) != 0;
+			// OSがAVXのレジスタを保存するか
+			bool hasOSAVX = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+
+			__cpuidex(info, 7, 0);
+			hasAVX2 = hasOSAVX && (info[1] & (1 << 5)) != 0;
+			hasSHA = hasSSE41 && hasSSSE3 && (info[1] & (1 << 29)) != 0;
+#else
+			hasAVX2 = __builtin_cpu_supports("avx2") != 0;
+			hasSHA = __builtin_cpu_supports("sha") != 0 && __builtin_cpu_supports("sse4.1") != 0;
+#endif
+		}
+	};
+
+	const CpuFeatures& GetCpuFeatures() {
+
+		static const CpuFeatures features;
+		return features;
+	}
+
+	// AVX2の8レーン用の回転とシフト
+	template<int count>
+	__m256i RotateRight8(__m256i value) {
+		return _mm256_or_si256(_mm256_srli_epi32(value, count), _mm256_slli_epi32(value, 32 - count));
+	}
+}
+
+//============================================================
+// 1つのメッセージのハッシュ
+//============================================================
+SHA256Digest SHA256Hasher::Hash(const void* data, size_t size) {
+
+	AddHashCount(1);
+
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	void (*compress)(uint32_t*, const uint8_t*, size_t) =
+		GetBackend() == Backend::SHANI ? CompressSHANI : CompressScalar;
+
+	uint32_t state[8];
+	std::memcpy(state, kInitialState, sizeof(state));
+
+	// 64バイトずつはそのまま、残りは詰め物を付けてから
+	size_t fullBlockCount = size / 64;
+	if (fullBlockCount != 0) {
+		compress(state, bytes, fullBlockCount);
+	}
+	MessageTail tail(bytes + fullBlockCount * 64, size);
+	compress(state, tail.blocks, tail.blockCount);
+
+	SHA256Digest digest{};
+	for (uint32_t i = 0; i < 8; ++i) {
+		StoreBigEndian(digest.data() + i * 4, state[i]);
+	}
+	return digest;
+}
+
+//============================================================
+// 少しずつ渡して計算する
+//============================================================
+void SHA256Hasher::Stream::Initialize() {
+
+	std::memcpy(state_, kInitialState, sizeof(state_));
+	bufferSize_ = 0;
+	totalSize_ = 0;
+}
+
+void SHA256Hasher::Stream::Update(const void* data, size_t size) {
+
+	void (*compress)(uint32_t*, const uint8_t*, size_t) =
+		GetBackend() == Backend::SHANI ? CompressSHANI : CompressScalar;
+
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	totalSize_ += size;
+
+	// 前の残りを64バイトにしてから
+	if (bufferSize_ != 0) {
+
+		size_t copySize = (std::min)(size, sizeof(buffer_) - bufferSize_);
+		std::memcpy(buffer_ + bufferSize_, bytes, copySize);
+		bufferSize_ += copySize;
+		bytes += copySize;
+		size -= copySize;
+
+		if (bufferSize_ < sizeof(buffer_)) {
+			return;
+		}
+		compress(state_, buffer_, 1);
+		bufferSize_ = 0;
+	}
+
+	// 64バイトずつはコピーせずにそのまま
+	size_t fullBlockCount = size / 64;
+	if (fullBlockCount != 0) {
+		compress(state_, bytes, fullBlockCount);
+	}
+
+	bufferSize_ = size % 64;
+	if (bufferSize_ != 0) {
+		std::memcpy(buffer_, bytes + fullBlockCount * 64, bufferSize_);
+	}
+}
+
+SHA256Digest SHA256Hasher::Stream::Finalize() {
+
+	AddHashCount(1);
+
+	void (*compress)(uint32_t*, const uint8_t*, size_t) =
+		GetBackend() == Backend::SHANI ? CompressSHANI : CompressScalar;
+
+	MessageTail tail(buffer_, totalSize_);
+	compress(state_, tail.blocks, tail.blockCount);
+
+	SHA256Digest digest{};
+	for (uint32_t i = 0; i < 8; ++i) {
+		StoreBigEndian(digest.data() + i * 4, state_[i]);
+	}
+	return digest;
+}
+
+//============================================================
+// まとめて計算する
+//============================================================
+void SHA256Hasher::HashBatch(const std::string_view* messages, size_t count, SHA256Digest* digests) {
+
+	// SHA-NIでも、短いメッセージが8つ以上あれば8つ同時の方が速い
+	Backend backend = GetBackend();
+	bool useAVX2 = backend == Backend::AVX2;
+	if (backend == Backend::SHANI && count >= 8 && IsSupported(Backend::AVX2)) {
+
+		size_t totalSize = 0;
+		for (size_t i = 0; i < count; ++i) {
+			totalSize += messages[i].size();
+		}
+		useAVX2 = totalSize / count <= kMultiBufferMaxSize;
+	}
+
+	if (useAVX2) {
+		AddHashCount(count);
+		HashBatchAVX2(messages, count, digests);
+		return;
+	}
+
+	for (size_t i = 0; i < count; ++i) {
+		digests[i] = Hash(messages[i]);
+	}
+}
+
+//============================================================
+// 16進数への変換
+//============================================================
+void SHA256Hasher::ToHex(const SHA256Digest& digest, char* output) {
+
+	for (size_t i = 0; i < digest.size(); ++i) {
+		std::memcpy(output + i * 2, kHexTable[digest[i]].data(), 2);
+	}
+}
+
+std::string SHA256Hasher::ToHex(const SHA256Digest& digest) {
+
+	std::string hex(digest.size() * 2, '\0');
+	ToHex(digest, hex.data());
+	return hex;
+}
+
+bool SHA256Hasher::FromHex(std::string_view hex, SHA256Digest& digest) {
+
+	if (hex.size() != digest.size() * 2) {
+		return false;
+	}
+
+	auto toNibble = [](char c) -> int {
+
+		if (c >= '0' && c <= '9') {
+			return c - '0';
+		}
+		if (c >= 'a' && c <= 'f') {
+			return c - 'a' + 10;
+		}
+		if (c >= 'A' && c <= 'F') {
+			return c - 'A' + 10;
+		}
+		return -1;
+	};
+
+	for (size_t i = 0; i < digest.size(); ++i) {
+
+		int high = toNibble(hex[i * 2]);
+		int low = toNibble(hex[i * 2 + 1]);
+		if (high < 0 || low < 0) {
+			return false;
+		}
+		digest[i] = static_cast<uint8_t>((high << 4) | low);
+	}
+	return true;
+}
+
+//============================================================
+// 実装の選択
+//============================================================
+void SHA256Hasher::SetBackend(Backend backend) {
+
+	backend_.store(IsSupported(backend) ? backend : GetBestBackend(), std::memory_order_relaxed);
+}
+
+bool SHA256Hasher::IsSupported(Backend backend) {
+
+	switch (backend) {
+	case Backend::SCALAR:
+		return true;
+	case Backend::AVX2:
+		return GetCpuFeatures().hasAVX2;
+	case Backend::SHANI:
+		return GetCpuFeatures().hasSHA;
+	default:
+		return false;
+	}
+}
+
+SHA256Hasher::Backend SHA256Hasher::GetBestBackend() {
+
+	if (IsSupported(Backend::SHANI)) {
+		return Backend::SHANI;
+	}
+	if (IsSupported(Backend::AVX2)) {
+		return Backend::AVX2;
+	}
+	return Backend::SCALAR;
+}
+
+const char* SHA256Hasher::GetBackendName(Backend backend) {
+
+	switch (backend) {
+	case Backend::SCALAR:
+		return "Scalar";
+	case Backend::AVX2:
+		return "AVX2 x8";
+	case Backend::SHANI:
+		return "SHA-NI";
+	default:
+		return "Unknown";
+	}
+}
+
+//============================================================
+// ブロックの計算
+//============================================================
+void SHA256Hasher::CompressScalar(uint32_t state[8], const uint8_t* blocks, size_t blockCount) {
+
+	for (size_t block = 0; block < blockCount; ++block, blocks += 64) {
+
+		uint32_t w[64];
+		for (uint32_t t = 0; t < 16; ++t) {
+			w[t] = LoadBigEndian(blocks + t * 4);
+		}
+		for (uint32_t t = 16; t < 64; ++t) {
+
+			uint32_t s0 = RotateRight(w[t - 15], 7) ^ RotateRight(w[t - 15], 18) ^ (w[t - 15] >> 3);
+			uint32_t s1 = RotateRight(w[t - 2], 17) ^ RotateRight(w[t - 2], 19) ^ (w[t - 2] >> 10);
+			w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+		}
+
+		uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+		uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+		for (uint32_t t = 0; t < 64; ++t) {
+
+			uint32_t s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+			uint32_t choose = (e & f) ^ (~e & g);
+			uint32_t temp1 = h + s1 + choose + kRoundConstants[t] + w[t];
+			uint32_t s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+			uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+			uint32_t temp2 = s0 + majority;
+
+			h = g;
+			g = f;
+			f = e;
+			e = d + temp1;
+			d = c;
+			c = b;
+			b = a;
+			a = temp1 + temp2;
+		}
+
+		state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+		state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+	}
+}
+
+//============================================================
+// ブロックの計算 SHA-NI
+//============================================================
+void SHA256Hasher::CompressSHANI(uint32_t state[8], const uint8_t* blocks, size_t blockCount) {
+
+	// ワードをビッグエンディアンで読む
+	const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+	// 命令が使う並び ABEF、CDGHにする
+	__m128i temp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0])), 0xB1);
+	__m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4])), 0x1B);
+	__m128i state0 = _mm_alignr_epi8(temp, state1, 8);
+	state1 = _mm_blend_epi16(state1, temp, 0xF0);
+
+	for (size_t block = 0; block < blockCount; ++block, blocks += 64) {
+
+		__m128i saved0 = state0;
+		__m128i saved1 = state1;
+
+		// 4ワードずつ、直前4つ分のメッセージを回して使う
+		__m128i message[4];
+		for (uint32_t group = 0; group < 16; ++group) {
+
+			__m128i words;
+			if (group < 4) {
+				words = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + group * 16)), byteSwap);
+			} else {
+				words = _mm_sha256msg1_epu32(message[group % 4], message[(group + 1) % 4]);
+				words = _mm_add_epi32(words, _mm_alignr_epi8(message[(group + 3) % 4], message[(group + 2) % 4], 4));
+				words = _mm_sha256msg2_epu32(words, message[(group + 3) % 4]);
+			}
+			message[group % 4] = words;
+
+			// 2ラウンドずつ
+			__m128i roundInput = _mm_add_epi32(words, _mm_load_si128(reinterpret_cast<const __m128i*>(&kRoundConstants[group * 4])));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, roundInput);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(roundInput, 0x0E));
+		}
+
+		state0 = _mm_add_epi32(state0, saved0);
+		state1 = _mm_add_epi32(state1, saved1);
+	}
+
+	// ABCD、EFGHに戻す
+	temp = _mm_shuffle_epi32(state0, 0x1B);
+	state1 = _mm_shuffle_epi32(state1, 0xB1);
+	state0 = _mm_blend_epi16(temp, state1, 0xF0);
+	state1 = _mm_alignr_epi8(state1, temp, 8);
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+}
+
+//============================================================
+// ブロックの計算 AVX2で8レーン
+//============================================================
+void SHA256Hasher::CompressAVX2(uint32_t state[8][8], const uint8_t* const blocks[8]) {
+
+	// 各レーンのブロックを読んで、ワードごとに8レーンを並べる
+	const __m256i byteSwap = _mm256_setr_epi8(
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+	__m256i w[16];
+	for (uint32_t half = 0; half < 2; ++half) {
+
+		__m256i rows[8];
+		for (uint32_t lane = 0; lane < 8; ++lane) {
+			rows[lane] = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks[lane] + half * 32)), byteSwap);
+		}
+
+		// 8x8の転置
+		__m256i t0 = _mm256_unpacklo_epi32(rows[0], rows[1]);
+		__m256i t1 = _mm256_unpackhi_epi32(rows[0], rows[1]);
+		__m256i t2 = _mm256_unpacklo_epi32(rows[2], rows[3]);
+		__m256i t3 = _mm256_unpackhi_epi32(rows[2], rows[3]);
+		__m256i t4 = _mm256_unpacklo_epi32(rows[4], rows[5]);
+		__m256i t5 = _mm256_unpackhi_epi32(rows[4], rows[5]);
+		__m256i t6 = _mm256_unpacklo_epi32(rows[6], rows[7]);
+		__m256i t7 = _mm256_unpackhi_epi32(rows[6], rows[7]);
+
+		__m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+		__m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+		__m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+		__m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+		__m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+		__m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+		__m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+		__m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+		__m256i* words = w + half * 8;
+		words[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+		words[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+		words[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+		words[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+		words[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+		words[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+		words[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+		words[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+	}
+
+	__m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[0]));
+	__m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[1]));
+	__m256i c = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[2]));
+	__m256i d = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[3]));
+	__m256i e = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[4]));
+	__m256i f = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[5]));
+	__m256i g = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[6]));
+	__m256i h = _mm256_load_si256(reinterpret_cast<const __m256i*>(state[7]));
+
+	for (uint32_t t = 0; t < 64; ++t) {
+
+		// メッセージは直前16ワードを回して使う
+		if (t >= 16) {
+
+			__m256i w15 = w[(t - 15) & 15];
+			__m256i w2 = w[(t - 2) & 15];
+			__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(RotateRight8<7>(w15), RotateRight8<18>(w15)), _mm256_srli_epi32(w15, 3));
+			__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(RotateRight8<17>(w2), RotateRight8<19>(w2)), _mm256_srli_epi32(w2, 10));
+			w[t & 15] = _mm256_add_epi32(_mm256_add_epi32(w[t & 15], s0), _mm256_add_epi32(w[(t - 7) & 15], s1));
+		}
+
+		__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(RotateRight8<6>(e), RotateRight8<11>(e)), RotateRight8<25>(e));
+		__m256i choose = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+		__m256i temp1 = _mm256_add_epi32(_mm256_add_epi32(h, s1), _mm256_add_epi32(choose,
+			_mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(kRoundConstants[t])), w[t & 15])));
+		__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(RotateRight8<2>(a), RotateRight8<13>(a)), RotateRight8<22>(a));
+		__m256i majority = _mm256_xor_si256(_mm256_xor_si256(_mm256_and_si256(a, b), _mm256_and_si256(a, c)), _mm256_and_si256(b, c));
+		__m256i temp2 = _mm256_add_epi32(s0, majority);
+
+		h = g;
+		g = f;
+		f = e;
+		e = _mm256_add_epi32(d, temp1);
+		d = c;
+		c = b;
+		b = a;
+		a = _mm256_add_epi32(temp1, temp2);
+	}
+
+	const __m256i result[8] = { a, b, c, d, e, f, g, h };
+	for (uint32_t i = 0; i < 8; ++i) {
+
+		__m256i* word = reinterpret_cast<__m256i*>(state[i]);
+		_mm256_store_si256(word, _mm256_add_epi32(_mm256_load_si256(word), result[i]));
+	}
+}
+
+//============================================================
+// まとめて計算する AVX2
+//============================================================
+void SHA256Hasher::HashBatchAVX2(const std::string_view* messages, size_t count, SHA256Digest* digests) {
+
+	// レーンごとに計算中のメッセージ、終わったら次のものを入れる
+	struct Lane {
+
+		size_t message = SIZE_MAX;
+		const uint8_t* data = nullptr;
+		size_t fullBlockCount = 0;
+		size_t block = 0;
+		size_t blockCount = 0;
+		alignas(16) uint8_t tail[128];
+	};
+
+	Lane lanes[8];
+	alignas(32) uint32_t state[8][8];
+	// 空いたレーンが読むもの、結果は捨てる
+	alignas(32) const uint8_t emptyBlock[64] = {};
+
+	size_t next = 0;
+	auto assign = [&](uint32_t index) {
+
+		Lane& lane = lanes[index];
+		if (next == count) {
+			lane.message = SIZE_MAX;
+			return;
+		}
+
+		lane.message = next++;
+		lane.data = reinterpret_cast<const uint8_t*>(messages[lane.message].data());
+		lane.fullBlockCount = messages[lane.message].size() / 64;
+		lane.block = 0;
+
+		MessageTail tail(lane.data + lane.fullBlockCount * 64, messages[lane.message].size());
+		std::memcpy(lane.tail, tail.blocks, sizeof(lane.tail));
+		lane.blockCount = lane.fullBlockCount + tail.blockCount;
+
+		for (uint32_t word = 0; word < 8; ++word) {
+			state[word][index] = kInitialState[word];
+		}
+		};
+
+	uint32_t activeCount = 0;
+	for (uint32_t index = 0; index < 8; ++index) {
+
+		assign(index);
+		activeCount += lanes[index].message != SIZE_MAX ? 1 : 0;
+	}
+
+	while (activeCount != 0) {
+
+		const uint8_t* blocks[8];
+		for (uint32_t index = 0; index < 8; ++index) {
+
+			const Lane& lane = lanes[index];
+			if (lane.message == SIZE_MAX) {
+				blocks[index] = emptyBlock;
+			} else if (lane.block < lane.fullBlockCount) {
+				blocks[index] = lane.data + lane.block * 64;
+			} else {
+				blocks[index] = lane.tail + (lane.block - lane.fullBlockCount) * 64;
+			}
+		}
+
+		CompressAVX2(state, blocks);
+
+		// 終わったレーンは結果を書き出して次を入れる
+		for (uint32_t index = 0; index < 8; ++index) {
+
+			Lane& lane = lanes[index];
+			if (lane.message == SIZE_MAX || ++lane.block < lane.blockCount) {
+				continue;
+			}
+
+			for (uint32_t word = 0; word < 8; ++word) {
+				StoreBigEndian(digests[lane.message].data() + word * 4, state[word][index]);
+			}
+
+			assign(index);
+			activeCount -= lane.message == SIZE_MAX ? 1 : 0;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+// SHA-256のダイジェスト、32バイト
+using SHA256Digest = std::array<uint8_t, 32>;
+
+// unordered_mapのキー用、ダイジェストは一様なので先頭8バイトをそのまま使う
+struct SHA256DigestHash {
+
+	size_t operator()(const SHA256Digest& digest) const {
+
+		size_t value = 0;
+		for (size_t i = 0; i < sizeof(size_t); ++i) {
+			value = (value << 8) | digest[i];
+		}
+		return value;
+	}
+};
+
+//================================================
+// SHA256Hasher Class
+//================================================
+/// SHA-256の計算、OpenSSLを通さずにCPUの命令を直接使う
+/// SHA-NIがあれば1つずつそれで、なければAVX2で8つのメッセージを同時に、どちらもなければ普通に計算する
+/// 使う実装は起動時に1度だけ調べる
+class SHA256Hasher {
+public:
+	//====================
+	// public
+	//====================
+
+	// 実装
+	enum class Backend {
+
+		SCALAR, // 普通の計算
+		AVX2,   // 8つのメッセージを同時に計算する、まとめて計算するときだけ使う
+		SHANI,  // SHA-NIの命令
+
+		// 実装の数
+		BACKENDNUM
+	};
+
+	// 少しずつ渡して計算する、ファイルやつなげたデータ用。結果はつなげてHashしたものと同じ
+	class Stream {
+	public:
+
+		Stream() { Initialize(); }
+
+		// 最初からやり直す
+		void Initialize();
+		// 続きを足す
+		void Update(const void* data, size_t size);
+		void Update(std::string_view data) { Update(data.data(), data.size()); }
+		// 詰め物を足して結果を返す、続けて使うならInitializeを呼ぶ
+		SHA256Digest Finalize();
+
+	private:
+
+		uint32_t state_[8];
+		// 64バイトに満たない残り
+		alignas(16) uint8_t buffer_[64];
+		size_t bufferSize_ = 0;
+		uint64_t totalSize_ = 0;
+	};
+
+	// 1つのメッセージのハッシュ
+	static SHA256Digest Hash(const void* data, size_t size);
+	static SHA256Digest Hash(std::string_view message) { return Hash(message.data(), message.size()); }
+
+	// count個のメッセージをまとめて計算する、digests[i]がmessages[i]のハッシュ
+	// 短いメッセージが多いときはSHA-NIが使えてもAVX2で8つ同時に計算する
+	static void HashBatch(const std::string_view* messages, size_t count, SHA256Digest* digests);
+
+	// コンパイル時のハッシュ、決まった文字列のハッシュを事前に作る。実行時は遅いので使わない
+	static constexpr SHA256Digest HashConstexpr(std::string_view message);
+
+	// 小文字の16進数、outputには64文字書く
+	static void ToHex(const SHA256Digest& digest, char* output);
+	static std::string ToHex(const SHA256Digest& digest);
+	static constexpr std::array<char, 64> ToHexConstexpr(const SHA256Digest& digest);
+	// 16進数から戻す、大文字も読む。64文字の16進数でなければfalse
+	static bool FromHex(std::string_view hex, SHA256Digest& digest);
+
+	// 実行時に計算したメッセージの数、起動してからの合計
+	static uint64_t GetHashCount() { return hashCount_.load(std::memory_order_relaxed); }
+	// 呼び出したスレッドで計算したメッセージの数、ワーカースレッドの分を含めずに数える
+	static uint64_t GetThreadHashCount() { return threadHashCount_; }
+
+	// 使っている実装
+	static Backend GetBackend() { return backend_.load(std::memory_order_relaxed); }
+	// 実装を変える、比較用。使えないものは使える中で一番速いものになる
+	static void SetBackend(Backend backend);
+	// CPUが対応しているか
+	static bool IsSupported(Backend backend);
+	// 実装の名前
+	static const char* GetBackendName(Backend backend);
+
+private:
+	//====================
+	// private
+	//====================
+
+	// SHA-NIのときに、まとめて計算するならAVX2を使う平均の長さ
+	static const size_t kMultiBufferMaxSize = 256;
+
+	// CPUが対応している中で一番速いもの
+	static Backend GetBestBackend();
+
+	static inline std::atomic<Backend> backend_ = GetBestBackend();
+	static inline std::atomic<uint64_t> hashCount_ = 0;
+	static inline thread_local uint64_t threadHashCount_ = 0;
+
+	// 計算したメッセージの数を足す
+	static void AddHashCount(uint64_t count) {
+
+		hashCount_.fetch_add(count, std::memory_order_relaxed);
+		threadHashCount_ += count;
+	}
+
+	// ラウンド定数
+	alignas(16) static constexpr uint32_t kRoundConstants[64] = {
+
+		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+		0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+		0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+		0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+	};
+
+	// 初期値
+	static constexpr uint32_t kInitialState[8] = {
+
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+	};
+
+	// 64バイトのブロックをblockCount個、stateに足し込む
+	static void CompressScalar(uint32_t state[8], const uint8_t* blocks, size_t blockCount);
+	static void CompressSHANI(uint32_t state[8], const uint8_t* blocks, size_t blockCount);
+	// 8つのstateに、それぞれのブロックを1つずつ足し込む。state[ワード][レーン]
+	static void CompressAVX2(uint32_t state[8][8], const uint8_t* const blocks[8]);
+
+	// 8つずつ同時に計算する
+	static void HashBatchAVX2(const std::string_view* messages, size_t count, SHA256Digest* digests);
+};
+
+//============================================================
+// コンパイル時のハッシュ
+//============================================================
+constexpr SHA256Digest SHA256Hasher::HashConstexpr(std::string_view message) {
+
+	auto rotateRight = [](uint32_t value, uint32_t count) { return (value >> count) | (value << (32 - count)); };
+
+	// 詰め物とビット長を付けた後のi番目のバイト
+	uint64_t size = message.size();
+	uint64_t blockCount = (size + 9 + 63) / 64;
+	auto paddedByte = [&](uint64_t i) -> uint32_t {
+
+		if (i < size) {
+			return static_cast<uint8_t>(message[static_cast<size_t>(i)]);
+		}
+		if (i == size) {
+			return 0x80;
+		}
+		uint64_t lengthOffset = blockCount * 64 - 8;
+		if (i >= lengthOffset) {
+			return static_cast<uint32_t>(((size * 8) >> ((7 - (i - lengthOffset)) * 8)) & 0xff);
+		}
+		return 0;
+	};
+
+	uint32_t state[8]{};
+	for (uint32_t i = 0; i < 8; ++i) {
+		state[i] = kInitialState[i];
+	}
+
+	for (uint64_t block = 0; block < blockCount; ++block) {
+
+		uint32_t w[64]{};
+		for (uint32_t t = 0; t < 16; ++t) {
+
+			uint64_t offset = block * 64 + t * 4;
+			w[t] = (paddedByte(offset) << 24) | (paddedByte(offset + 1) << 16) | (paddedByte(offset + 2) << 8) | paddedByte(offset + 3);
+		}
+		for (uint32_t t = 16; t < 64; ++t) {
+
+			uint32_t s0 = rotateRight(w[t - 15], 7) ^ rotateRight(w[t - 15], 18) ^ (w[t - 15] >> 3);
+			uint32_t s1 = rotateRight(w[t - 2], 17) ^ rotateRight(w[t - 2], 19) ^ (w[t - 2] >> 10);
+			w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+		}
+
+		uint32_t v[8]{};
+		for (uint32_t i = 0; i < 8; ++i) {
+			v[i] = state[i];
+		}
+		for (uint32_t t = 0; t < 64; ++t) {
+
+			uint32_t s1 = rotateRight(v[4], 6) ^ rotateRight(v[4], 11) ^ rotateRight(v[4], 25);
+			uint32_t temp1 = v[7] + s1 + ((v[4] & v[5]) ^ (~v[4] & v[6])) + kRoundConstants[t] + w[t];
+			uint32_t s0 = rotateRight(v[0], 2) ^ rotateRight(v[0], 13) ^ rotateRight(v[0], 22);
+			uint32_t temp2 = s0 + ((v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]));
+
+			for (uint32_t i = 7; i > 0; --i) {
+				v[i] = v[i - 1];
+			}
+			v[4] += temp1;
+			v[0] = temp1 + temp2;
+		}
+		for (uint32_t i = 0; i < 8; ++i) {
+			state[i] += v[i];
+		}
+	}
+
+	SHA256Digest digest{};
+	for (uint32_t i = 0; i < 32; ++i) {
+		digest[i] = static_cast<uint8_t>(state[i / 4] >> (24 - (i % 4) * 8));
+	}
+	return digest;
+}
+
+//============================================================
+// コンパイル時の16進数
+//============================================================
+constexpr std::array<char, 64> SHA256Hasher::ToHexConstexpr(const SHA256Digest& digest) {
+
+	const char* digits = "0123456789abcdef";
+
+	std::array<char, 64> hex{};
+	for (size_t i = 0; i < digest.size(); ++i) {
+		hex[i * 2] = digits[digest[i] >> 4];
+		hex[i * 2 + 1] = digits[digest[i] & 0xf];
+	}
+	return hex;
+}
\ No newline at end of file
@@ -0,0 +1,370 @@
+#include "ShaderCache.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <set>
+
+//============================================================
+// namespace
+//============================================================
+namespace {
+
+	// FNV-1a
+	const uint64_t kHashOffset = 14695981039346656037ull;
+	const uint64_t kHashPrime = 1099511628211ull;
+
+	// キャッシュファイルの先頭
+	const char kMagic[4] = { 'S','H','C','1' };
+
+	void HashBytes(uint64_t& hash, const void* data, size_t size) {
+
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; ++i) {
+			hash ^= bytes[i];
+			hash *= kHashPrime;
+		}
+	}
+
+	// 長さも混ぜて、区切りの違う文字列の並びを区別する
+	template<class Char>
+	void HashString(uint64_t& hash, const std::basic_string<Char>& text) {
+
+		uint64_t size = text.size();
+		HashBytes(hash, &size, sizeof(size));
+		HashBytes(hash, text.data(), text.size() * sizeof(Char));
+	}
+
+	// ファイルの中身、読めなければfalse
+	bool ReadFile(const std::filesystem::path& path, std::string& content) {
+
+		std::ifstream file(path, std::ios::binary);
+		if (!file) {
+			return false;
+		}
+
+		content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		return true;
+	}
+
+	// #include "name" の名前を取り出す
+	std::vector<std::string> FindIncludes(const std::string& source) {
+
+		std::vector<std::string> includes;
+
+		size_t position = 0;
+		while ((position = source.find("#include", position)) != std::string::npos) {
+
+			position += 8;
+			size_t lineEnd = source.find('\n', position);
+			size_t open = source.find_first_of("\"<", position);
+			if (open == std::string::npos || (lineEnd != std::string::npos && open > lineEnd)) {
+				continue;
+			}
+
+			char closeChar = source[open] == '"' ? '"' : '>';
+			size_t close = source.find(closeChar, open + 1);
+			if (close == std::string::npos || (lineEnd != std::string::npos && close > lineEnd)) {
+				continue;
+			}
+
+			includes.push_back(source.substr(open + 1, close - open - 1));
+			position = close;
+		}
+
+		return includes;
+	}
+
+	// ファイルとincludeしたファイルを再帰的にハッシュに混ぜる
+	void HashFileRecursive(uint64_t& hash, const std::filesystem::path& path, std::set<std::filesystem::path>& visited) {
+
+		std::filesystem::path normalized = path.lexically_normal();
+		if (!visited.insert(normalized).second) {
+			return;
+		}
+
+		// 読めないファイルは名前だけ混ぜる、コンパイラがエラーを返す
+		std::string content;
+		HashString(hash, normalized.generic_string());
+		if (!ReadFile(normalized, content)) {
+			return;
+		}
+		HashString(hash, content);
+
+		for (const auto& include : FindIncludes(content)) {
+			HashFileRecursive(hash, normalized.parent_path() / include, visited);
+		}
+	}
+}
+
+//============================================================
+// デストラクタ
+//============================================================
+ShaderCache::~ShaderCache() {
+
+	Finalize();
+}
+
+//============================================================
+// 初期化
+//============================================================
+void ShaderCache::Initialize(IShaderCompiler* compiler, const std::filesystem::path& directory, uint32_t threadCount) {
+
+	assert(compiler);
+
+	compiler_ = compiler;
+	directory_ = directory;
+
+	std::error_code error;
+	std::filesystem::create_directories(directory_, error);
+
+	// シェーダー1つでもスレッドに分ける
+	workers_.Initialize(threadCount);
+	workers_.SetMinItemsPerContext(1);
+
+	memory_.clear();
+	stats_ = {};
+	lastError_.clear();
+}
+
+//============================================================
+// 終了処理
+//============================================================
+void ShaderCache::Finalize() {
+
+	workers_.Finalize();
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	memory_.clear();
+}
+
+//============================================================
+// キャッシュのキー
+//============================================================
+uint64_t ShaderCache::CalculateKey(const ShaderRequest& request) {
+
+	uint64_t hash = kHashOffset;
+
+	uint32_t version = kVersion;
+	HashBytes(hash, &version, sizeof(version));
+
+	// ソースとincludeしたファイル
+	std::set<std::filesystem::path> visited;
+	HashFileRecursive(hash, request.path, visited);
+
+	HashString(hash, request.entry);
+	HashString(hash, request.profile);
+
+	uint64_t argumentCount = request.arguments.size();
+	HashBytes(hash, &argumentCount, sizeof(argumentCount));
+	for (const auto& argument : request.arguments) {
+		HashString(hash, argument);
+	}
+
+	return hash;
+}
+
+//============================================================
+// まとめて取得
+//============================================================
+std::vector<ShaderBytecode> ShaderCache::CompileAll(const std::vector<ShaderRequest>& requests) {
+
+	std::lock_guard<std::mutex> batchLock(batchMutex_);
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<ShaderBytecode> results(requests.size());
+	std::vector<uint64_t> keys(requests.size());
+
+	// コンパイルが必要なもの、同じキーは1回だけ
+	std::vector<size_t> misses;
+	std::unordered_map<uint64_t, size_t> missIndices;
+
+	uint32_t memoryHitCount = 0;
+	uint32_t diskHitCount = 0;
+
+	for (size_t i = 0; i < requests.size(); ++i) {
+
+		keys[i] = CalculateKey(requests[i]);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			auto it = memory_.find(keys[i]);
+			if (it != memory_.end()) {
+				results[i] = it->second;
+				++memoryHitCount;
+				continue;
+			}
+		}
+
+		if (missIndices.count(keys[i])) {
+			continue;
+		}
+
+		ShaderBytecode bytecode = Load(keys[i]);
+		if (bytecode) {
+
+			std::lock_guard<std::mutex> lock(mutex_);
+			memory_[keys[i]] = bytecode;
+			results[i] = bytecode;
+			++diskHitCount;
+			continue;
+		}
+
+		missIndices[keys[i]] = misses.size();
+		misses.push_back(i);
+	}
+
+	// 残りを並列でコンパイルする
+	std::vector<ShaderBytecode> compiled(misses.size());
+	std::vector<std::string> errors(misses.size());
+
+	if (!misses.empty()) {
+
+		uint32_t contextCount = workers_.CalculateContextCount(misses.size());
+		workers_.Record(misses.size(), contextCount, [&](uint32_t, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+
+				size_t requestIndex = misses[i];
+				std::vector<uint8_t> bytecode;
+				if (compiler_->Compile(requests[requestIndex], bytecode, errors[i])) {
+
+					// 次の起動ではコンパイルしない
+					Store(keys[requestIndex], bytecode);
+					compiled[i] = std::make_shared<const std::vector<uint8_t>>(std::move(bytecode));
+				}
+			}
+			});
+	}
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	for (size_t i = 0; i < misses.size(); ++i) {
+		if (compiled[i]) {
+			memory_[keys[misses[i]]] = compiled[i];
+		} else {
+			++stats_.failedCount;
+			lastError_ = errors[i];
+		}
+	}
+
+	// 同じキーのものにも結果を渡す
+	for (size_t i = 0; i < requests.size(); ++i) {
+		if (!results[i]) {
+			auto it = missIndices.find(keys[i]);
+			if (it != missIndices.end()) {
+				results[i] = compiled[it->second];
+			}
+		}
+	}
+
+	stats_.memoryHitCount += memoryHitCount;
+	stats_.diskHitCount += diskHitCount;
+	stats_.compileCount += static_cast<uint32_t>(misses.size());
+	stats_.lastBatchTimeMs =
+		std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	stats_.totalTimeMs += stats_.lastBatchTimeMs;
+
+	return results;
+}
+
+//============================================================
+// 1つだけ取得
+//============================================================
+ShaderBytecode ShaderCache::Get(const ShaderRequest& request) {
+
+	return CompileAll({ request })[0];
+}
+
+//============================================================
+// 統計
+//============================================================
+ShaderCache::Stats ShaderCache::GetStats() const {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	return stats_;
+}
+
+//============================================================
+// 最後のエラー
+//============================================================
+std::string ShaderCache::GetLastError() const {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	return lastError_;
+}
+
+//============================================================
+// キャッシュファイルのパス
+//============================================================
+std::filesystem::path ShaderCache::MakeCachePath(uint64_t key) const {
+
+	return directory_ / std::format("{:016x}.cso", key);
+}
+
+//============================================================
+// ディスクからの読み込み
+//============================================================
+ShaderBytecode ShaderCache::Load(uint64_t key) const {
+
+	std::ifstream file(MakeCachePath(key), std::ios::binary);
+	if (!file) {
+		return nullptr;
+	}
+
+	// 先頭、キー、サイズを確かめる。壊れていればコンパイルし直す
+	char magic[4] = {};
+	uint64_t storedKey = 0;
+	uint64_t size = 0;
+	file.read(magic, sizeof(magic));
+	file.read(reinterpret_cast<char*>(&storedKey), sizeof(storedKey));
+	file.read(reinterpret_cast<char*>(&size), sizeof(size));
+	if (!file || !std::equal(std::begin(magic), std::end(magic), std::begin(kMagic)) || storedKey != key) {
+		return nullptr;
+	}
+
+	std::vector<uint8_t> bytecode(static_cast<size_t>(size));
+	file.read(reinterpret_cast<char*>(bytecode.data()), static_cast<std::streamsize>(size));
+	if (!file || file.peek() != std::ifstream::traits_type::eof()) {
+		return nullptr;
+	}
+
+	return std::make_shared<const std::vector<uint8_t>>(std::move(bytecode));
+}
+
+//============================================================
+// ディスクへの保存
+//============================================================
+void ShaderCache::Store(uint64_t key, const std::vector<uint8_t>& bytecode) const {
+
+	std::filesystem::path path = MakeCachePath(key);
+
+	// 書きかけのファイルを読まないよう、別名で書いてから置き換える
+	std::filesystem::path temporaryPath = path;
+	temporaryPath += ".tmp";
+
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			return;
+		}
+
+		uint64_t size = bytecode.size();
+		file.write(kMagic, sizeof(kMagic));
+		file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+		file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		file.write(reinterpret_cast<const char*>(bytecode.data()), static_cast<std::streamsize>(bytecode.size()));
+		if (!file) {
+			return;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporaryPath, path, error);
+	if (error) {
+		std::filesystem::remove(temporaryPath, error);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <filesystem>
+#include <unordered_map>
+
+#include "ParallelRecorder.h"
+
+// コンパイル1つ分
+struct ShaderRequest {
+
+	// hlslファイルへのパス、includeはこのファイルのディレクトリから探す
+	std::filesystem::path path;
+	std::wstring entry = L"main";
+	std::wstring profile;
+	// -E、-T以外のコンパイルオプション
+	std::vector<std::wstring> arguments;
+};
+
+// コンパイル結果のバイナリ
+using ShaderBytecode = std::shared_ptr<const std::vector<uint8_t>>;
+
+//================================================
+// IShaderCompiler Class
+//================================================
+/// ShaderCacheが使うコンパイラ
+/// D3D12ではDXC、テストでは決まった結果を返すものに差し替えられる。複数のスレッドから同時に呼ばれる
+class IShaderCompiler {
+public:
+	//====================
+	// public
+	//====================
+
+	// 仮想デストラクタ
+	virtual ~IShaderCompiler() {}
+
+	// 成功したらbytecodeに結果を入れてtrue、失敗したらerrorに理由を入れてfalse
+	virtual bool Compile(const ShaderRequest& request, std::vector<uint8_t>& bytecode, std::string& error) = 0;
+};
+
+//================================================
+// ShaderCache Class
+//================================================
+/// ソース、includeしたファイル、プロファイル、オプションのハッシュでバイナリを引く
+/// メモリになければディスクから読み、どちらにもないものだけを並列でコンパイルしてディスクに残す
+class ShaderCache {
+public:
+	//====================
+	// public
+	//====================
+
+	// 統計
+	struct Stats {
+
+		uint32_t memoryHitCount = 0; // メモリにあった数
+		uint32_t diskHitCount = 0;   // ディスクから読んだ数
+		uint32_t compileCount = 0;   // コンパイルした数
+		uint32_t failedCount = 0;    // コンパイルに失敗した数
+		float lastBatchTimeMs = 0.0f; // 最後のCompileAllにかかった時間
+		float totalTimeMs = 0.0f;     // CompileAllにかかった時間の合計
+	};
+
+	ShaderCache() = default;
+	~ShaderCache();
+
+	// 初期化、directoryにバイナリを保存する。threadCountは呼び出し元のスレッドも含めた数
+	void Initialize(IShaderCompiler* compiler, const std::filesystem::path& directory, uint32_t threadCount);
+	// 終了処理、ワーカースレッドを止める
+	void Finalize();
+
+	// まとめてバイナリを取得する、結果はrequestsと同じ順。失敗したものはnullptr
+	std::vector<ShaderBytecode> CompileAll(const std::vector<ShaderRequest>& requests);
+	// 1つだけ取得する
+	ShaderBytecode Get(const ShaderRequest& request);
+
+	// キャッシュのキー、ソースとincludeしたファイルの中身も含める
+	static uint64_t CalculateKey(const ShaderRequest& request);
+
+	// getter
+
+	Stats GetStats() const;
+	// 最後に失敗したコンパイルのエラー
+	std::string GetLastError() const;
+
+private:
+	//====================
+	// private
+	//====================
+
+	// キャッシュファイルの形式を変えたら上げる
+	static const uint32_t kVersion = 1;
+
+	IShaderCompiler* compiler_ = nullptr;
+	std::filesystem::path directory_;
+
+	// コンパイルを分担する
+	ParallelRecorder workers_;
+	// CompileAllは1つずつ
+	std::mutex batchMutex_;
+
+	// 読み込んだもの、コンパイルしたもの
+	std::unordered_map<uint64_t, ShaderBytecode> memory_;
+	mutable std::mutex mutex_;
+
+	Stats stats_;
+	std::string lastError_;
+
+	// キャッシュファイルのパス
+	std::filesystem::path MakeCachePath(uint64_t key) const;
+	// ディスクからの読み込み、なければnullptr
+	ShaderBytecode Load(uint64_t key) const;
+	// ディスクへの保存
+	void Store(uint64_t key, const std::vector<uint8_t>& bytecode) const;
+};
\ No newline at end of file
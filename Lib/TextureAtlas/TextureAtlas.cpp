@@ -0,0 +1,208 @@
+#include "TextureAtlas.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+// imguiのフォントアトラスと同じくこの翻訳単位だけで使う
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "imstb_rectpack.h"
+
+//============================================================
+// 初期化
+//============================================================
+void TextureAtlas::Initialize(uint32_t maxPageSize, uint32_t padding, uint32_t alignment) {
+
+	assert(alignment != 0 && maxPageSize % alignment == 0);
+
+	maxPageSize_ = maxPageSize;
+	padding_ = padding;
+	alignment_ = alignment;
+
+	Clear();
+}
+
+//============================================================
+// テクスチャの追加
+//============================================================
+uint32_t TextureAtlas::Add(uint32_t width, uint32_t height) {
+
+	assert(width != 0 && height != 0);
+
+	AtlasRegion region{};
+	region.width = width;
+	region.height = height;
+	regions_.push_back(region);
+
+	return static_cast<uint32_t>(regions_.size() - 1);
+}
+
+//============================================================
+// 全て消す
+//============================================================
+void TextureAtlas::Clear() {
+
+	regions_.clear();
+	pageSizes_.clear();
+	stats_ = {};
+}
+
+//============================================================
+// 余白込みで揃えた大きさ
+//============================================================
+uint32_t TextureAtlas::AlignedSize(uint32_t size) const {
+
+	uint32_t padded = size + padding_ * 2;
+	return (padded + alignment_ - 1) / alignment_ * alignment_;
+}
+
+//============================================================
+// 詰める
+//============================================================
+void TextureAtlas::Build() {
+
+	pageSizes_.clear();
+	stats_ = {};
+	stats_.textureCount = static_cast<uint32_t>(regions_.size());
+
+	// ページに入らないものは詰めない
+	std::vector<uint32_t> remaining;
+	for (uint32_t i = 0; i < regions_.size(); ++i) {
+
+		AtlasRegion& region = regions_[i];
+		region.page = kInvalidPage;
+
+		if (AlignedSize(region.width) > maxPageSize_ || AlignedSize(region.height) > maxPageSize_) {
+			++stats_.rejectedCount;
+			continue;
+		}
+		remaining.push_back(i);
+	}
+
+	while (!remaining.empty()) {
+
+		// 残り全部の面積が入る大きさから試す
+		uint64_t area = 0;
+		uint32_t maxSide = 0;
+		for (uint32_t index : remaining) {
+
+			uint32_t width = AlignedSize(regions_[index].width);
+			uint32_t height = AlignedSize(regions_[index].height);
+			area += uint64_t(width) * height;
+			maxSide = (std::max)(maxSide, (std::max)(width, height));
+		}
+
+		uint32_t size = alignment_;
+		while (size < maxPageSize_ && (uint64_t(size) * size < area || size < maxSide)) {
+			size *= 2;
+		}
+		size = (std::min)(size, maxPageSize_);
+
+		// 全部入る一番小さい大きさ、最大でも入らなければ最大で分ける
+		while (size < maxPageSize_ && !PackPage(remaining, kInvalidPage, size, false).empty()) {
+			size *= 2;
+		}
+		size = (std::min)(size, maxPageSize_);
+
+		uint32_t page = static_cast<uint32_t>(pageSizes_.size());
+		std::vector<uint32_t> rest = PackPage(remaining, page, size, true);
+
+		// 1つも入らないことはない、入らない大きさは最初に除いている
+		assert(rest.size() < remaining.size());
+		pageSizes_.push_back(size);
+		remaining = std::move(rest);
+	}
+
+	// 統計
+	stats_.pageCount = static_cast<uint32_t>(pageSizes_.size());
+	for (const AtlasRegion& region : regions_) {
+
+		if (region.page != kInvalidPage) {
+			++stats_.packedCount;
+			stats_.usedArea += uint64_t(region.width) * region.height;
+		}
+	}
+	for (uint32_t size : pageSizes_) {
+		stats_.pageArea += uint64_t(size) * size;
+	}
+	stats_.efficiency = stats_.pageArea != 0 ? static_cast<float>(double(stats_.usedArea) / double(stats_.pageArea)) : 0.0f;
+	stats_.bindingsSaved = stats_.packedCount - stats_.pageCount;
+}
+
+//============================================================
+// 1ページ分詰める
+//============================================================
+std::vector<uint32_t> TextureAtlas::PackPage(const std::vector<uint32_t>& indices, uint32_t page, uint32_t size, bool commit) {
+
+	std::vector<stbrp_rect> rects(indices.size());
+	for (size_t i = 0; i < indices.size(); ++i) {
+
+		rects[i].id = static_cast<int>(indices[i]);
+		rects[i].w = static_cast<stbrp_coord>(AlignedSize(regions_[indices[i]].width));
+		rects[i].h = static_cast<stbrp_coord>(AlignedSize(regions_[indices[i]].height));
+	}
+
+	// ノードは幅の数だけあれば足りる
+	std::vector<stbrp_node> nodes(size);
+	stbrp_context context{};
+	stbrp_init_target(&context, static_cast<int>(size), static_cast<int>(size), nodes.data(), static_cast<int>(nodes.size()));
+	stbrp_pack_rects(&context, rects.data(), static_cast<int>(rects.size()));
+
+	// 入らなかったものは元の順番で返す
+	std::vector<uint32_t> rest;
+	for (const stbrp_rect& rect : rects) {
+
+		if (!rect.was_packed) {
+			rest.push_back(static_cast<uint32_t>(rect.id));
+			continue;
+		}
+		if (!commit) {
+			continue;
+		}
+
+		// 余白の内側が実際のテクスチャ
+		AtlasRegion& region = regions_[rect.id];
+		region.page = page;
+		region.x = static_cast<uint32_t>(rect.x) + padding_;
+		region.y = static_cast<uint32_t>(rect.y) + padding_;
+
+		float invSize = 1.0f / static_cast<float>(size);
+		region.uvScaleU = static_cast<float>(region.width) * invSize;
+		region.uvScaleV = static_cast<float>(region.height) * invSize;
+		region.uvOffsetU = static_cast<float>(region.x) * invSize;
+		region.uvOffsetV = static_cast<float>(region.y) * invSize;
+	}
+	std::sort(rest.begin(), rest.end());
+
+	return rest;
+}
+
+//============================================================
+// ピクセルのコピー
+//============================================================
+void TextureAtlas::CopyRegion(const uint8_t* source, size_t sourceRowPitch,
+	uint8_t* page, size_t pageRowPitch, const AtlasRegion& region, uint32_t padding, size_t pixelSize) {
+
+	assert(region.x >= padding && region.y >= padding);
+
+	size_t rowSize = region.width * pixelSize;
+
+	for (int64_t row = -int64_t(padding); row < int64_t(region.height + padding); ++row) {
+
+		// 上下の余白は端の行を繰り返す
+		int64_t sourceRow = (std::clamp)(row, int64_t(0), int64_t(region.height) - 1);
+		const uint8_t* src = source + size_t(sourceRow) * sourceRowPitch;
+		uint8_t* dst = page + size_t(int64_t(region.y) + row) * pageRowPitch + size_t(region.x) * pixelSize;
+
+		std::memcpy(dst, src, rowSize);
+
+		// 左右の余白は端のピクセルを繰り返す
+		for (uint32_t i = 1; i <= padding; ++i) {
+
+			std::memcpy(dst - i * pixelSize, src, pixelSize);
+			std::memcpy(dst + rowSize + (i - 1) * pixelSize, src + rowSize - pixelSize, pixelSize);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// アトラスに詰めたテクスチャ1つの場所
+struct AtlasRegion {
+
+	// 詰められなかったものはkInvalidPage
+	uint32_t page = ~0u;
+	// ページ内のピクセル位置と大きさ、周りの余白は含まない
+	uint32_t x = 0;
+	uint32_t y = 0;
+	uint32_t width = 0;
+	uint32_t height = 0;
+
+	// 元のUV(0〜1)からページ内のUVへの変換、uv * scale + offset
+	float uvScaleU = 1.0f;
+	float uvScaleV = 1.0f;
+	float uvOffsetU = 0.0f;
+	float uvOffsetV = 0.0f;
+};
+
+//================================================
+// TextureAtlas Class
+//================================================
+/// 小さいテクスチャを正方形のページにまとめて詰める、詰め方はimstb_rectpack
+/// ページは全部が入る一番小さい2の累乗の大きさから選び、入らなければ最大の大きさで次のページに分ける
+/// 周りに余白を取り、ミップを作っても隣のテクスチャが混ざらないように位置を揃える
+/// ピクセルには触らないので、ページの中身はCopyRegionで作る
+class TextureAtlas {
+public:
+	//====================
+	// public
+	//====================
+
+	// 詰められなかったもの
+	static constexpr uint32_t kInvalidPage = ~0u;
+
+	// 統計
+	struct Stats {
+
+		uint32_t textureCount = 0;  // 追加したテクスチャの数
+		uint32_t packedCount = 0;   // 詰めたテクスチャの数
+		uint32_t rejectedCount = 0; // ページに入らない大きさで詰めなかった数
+		uint32_t pageCount = 0;     // ページの数
+		uint64_t usedArea = 0;      // 詰めたテクスチャの面積の合計、余白は含まない
+		uint64_t pageArea = 0;      // ページの面積の合計
+		float efficiency = 0.0f;    // usedArea / pageArea
+		uint32_t bindingsSaved = 0; // 減ったSRVの数、packedCount - pageCount
+	};
+
+	TextureAtlas() = default;
+	~TextureAtlas() = default;
+
+	// maxPageSizeはページの大きさの最大、paddingは周りの余白のピクセル数
+	// 位置と余白込みの大きさはalignmentの倍数に揃える、ミップをalignmentの段数分作っても境目がずれない
+	void Initialize(uint32_t maxPageSize, uint32_t padding, uint32_t alignment);
+
+	// テクスチャの追加、番号は追加順
+	uint32_t Add(uint32_t width, uint32_t height);
+
+	// 追加したものを詰める、前の結果は作り直す
+	void Build();
+
+	// 追加したものを全て消す
+	void Clear();
+
+	// Buildの結果
+	const AtlasRegion& GetRegion(uint32_t index) const { return regions_[index]; }
+	uint32_t GetRegionCount() const { return static_cast<uint32_t>(regions_.size()); }
+	uint32_t GetPageCount() const { return static_cast<uint32_t>(pageSizes_.size()); }
+	uint32_t GetPageSize(uint32_t page) const { return pageSizes_[page]; }
+	uint32_t GetPadding() const { return padding_; }
+	const Stats& GetStats() const { return stats_; }
+
+	// ページへのピクセルのコピー、余白は端のピクセルを引き伸ばして埋める
+	// sourceはregionの大きさ、pixelSizeは1ピクセルのバイト数
+	static void CopyRegion(const uint8_t* source, size_t sourceRowPitch,
+		uint8_t* page, size_t pageRowPitch, const AtlasRegion& region, uint32_t padding, size_t pixelSize);
+
+private:
+	//====================
+	// private
+	//====================
+
+	uint32_t maxPageSize_ = 1024;
+	uint32_t padding_ = 4;
+	uint32_t alignment_ = 4;
+
+	// 追加順
+	std::vector<AtlasRegion> regions_;
+	std::vector<uint32_t> pageSizes_;
+
+	Stats stats_;
+
+	// 余白込みで揃えた大きさ
+	uint32_t AlignedSize(uint32_t size) const;
+
+	// indicesをsizeのページに詰める、詰めたものをpageに置いて残りを返す
+	std::vector<uint32_t> PackPage(const std::vector<uint32_t>& indices, uint32_t page, uint32_t size, bool commit);
+};
\ No newline at end of file
@@ -0,0 +1,223 @@
+#include "TextureCooker.h"
+
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <filesystem>
+
+#include "SHA256Hasher.h"
+
+//============================================================
+// 画像を焼く
+//============================================================
+TextureCookResult TextureCooker::Cook(const std::string& sourcePath, const std::string& outputDirectory, const TextureCookSettings& settings) {
+
+	auto start = std::chrono::steady_clock::now();
+
+	TextureCookResult result{};
+	result.outputPath = GetCookedPath(sourcePath, outputDirectory);
+
+	// 元画像はハッシュとデコードで使うので1度だけ読む
+	std::ifstream sourceFile(sourcePath, std::ios::binary);
+	if (!sourceFile) {
+		result.error = std::format("{}: cannot open", sourcePath);
+		return result;
+	}
+	std::string source((std::istreambuf_iterator<char>(sourceFile)), std::istreambuf_iterator<char>());
+
+	result.hash = MakeHash(source, settings);
+
+	// 同じ内容で焼いたものがあればそのまま使う
+	std::string hashPath = result.outputPath + kHashExtension;
+	std::ifstream hashFile(hashPath);
+	std::string cookedHash;
+	if (hashFile >> cookedHash && cookedHash == result.hash) {
+
+		DirectX::TexMetadata metadata{};
+		std::wstring outputPathW = std::filesystem::path(result.outputPath).wstring();
+		if (SUCCEEDED(DirectX::GetMetadataFromDDSFile(outputPathW.c_str(), DirectX::DDS_FLAGS_NONE, metadata))) {
+
+			result.isSucceeded = true;
+			result.isCached = true;
+			result.format = metadata.format;
+			result.cookedSize = std::filesystem::file_size(result.outputPath);
+			result.cookTimeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+			return result;
+		}
+	}
+
+	// デコード
+	DirectX::ScratchImage image{};
+	HRESULT hr = DirectX::LoadFromWICMemory(source.data(), source.size(),
+		settings.isSRGB ? DirectX::WIC_FLAGS_FORCE_SRGB : DirectX::WIC_FLAGS_IGNORE_SRGB, nullptr, image);
+	if (FAILED(hr)) {
+		result.error = std::format("{}: decode failed (0x{:08x})", sourcePath, static_cast<uint32_t>(hr));
+		return result;
+	}
+
+	// 圧縮前の形式を揃える、RGBA8のまま残すときもこの形式になる
+	DXGI_FORMAT baseFormat = settings.isSRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+	if (image.GetMetadata().format != baseFormat) {
+
+		DirectX::ScratchImage converted{};
+		hr = DirectX::Convert(image.GetImages(), image.GetImageCount(), image.GetMetadata(),
+			baseFormat, DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT, converted);
+		if (FAILED(hr)) {
+			result.error = std::format("{}: convert failed (0x{:08x})", sourcePath, static_cast<uint32_t>(hr));
+			return result;
+		}
+		image = std::move(converted);
+	}
+
+	// ミップマップの作成 → 元画像よりも小さなテクスチャ群
+	if (settings.generateMips) {
+
+		DirectX::ScratchImage mipImages{};
+		hr = DirectX::GenerateMipMaps(image.GetImages(), image.GetImageCount(), image.GetMetadata(),
+			settings.isSRGB ? DirectX::TEX_FILTER_SRGB : DirectX::TEX_FILTER_DEFAULT, 0, mipImages);
+		if (FAILED(hr)) {
+			result.error = std::format("{}: mipmap failed (0x{:08x})", sourcePath, static_cast<uint32_t>(hr));
+			return result;
+		}
+		image = std::move(mipImages);
+	}
+
+	result.uncompressedSize = image.GetPixelsSize();
+	result.format = SelectFormat(image, settings);
+
+	// ブロック圧縮、ブロックはOpenMPで並列に圧縮される
+	if (DirectX::IsCompressed(result.format)) {
+
+		DirectX::TEX_COMPRESS_FLAGS flags = DirectX::TEX_COMPRESS_PARALLEL;
+		if (result.format == DXGI_FORMAT_BC7_UNORM || result.format == DXGI_FORMAT_BC7_UNORM_SRGB) {
+			// 使うモードを絞る、品質はほぼ変わらず圧縮の時間が大きく減る
+			flags |= DirectX::TEX_COMPRESS_BC7_QUICK;
+		}
+
+		DirectX::ScratchImage compressed{};
+		hr = DirectX::Compress(image.GetImages(), image.GetImageCount(), image.GetMetadata(),
+			result.format, flags, DirectX::TEX_THRESHOLD_DEFAULT, compressed);
+		if (FAILED(hr)) {
+			result.error = std::format("{}: compress failed (0x{:08x})", sourcePath, static_cast<uint32_t>(hr));
+			return result;
+		}
+		image = std::move(compressed);
+	}
+
+	result.cookedSize = image.GetPixelsSize();
+
+	// 書き出し、ハッシュは最後に書くので途中で失敗したものは次回焼き直しになる
+	std::filesystem::create_directories(outputDirectory);
+	std::filesystem::remove(hashPath);
+
+	std::wstring outputPathW = std::filesystem::path(result.outputPath).wstring();
+	hr = DirectX::SaveToDDSFile(image.GetImages(), image.GetImageCount(), image.GetMetadata(), DirectX::DDS_FLAGS_NONE, outputPathW.c_str());
+	if (FAILED(hr)) {
+		result.error = std::format("{}: write failed (0x{:08x})", result.outputPath, static_cast<uint32_t>(hr));
+		return result;
+	}
+
+	// 読み込み側は元画像だけのハッシュで変わっていないかを確かめる
+	std::ofstream(hashPath) << result.hash << ' ' << SHA256Hasher::ToHex(SHA256Hasher::Hash(source));
+
+	result.isSucceeded = true;
+	result.cookTimeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return result;
+}
+
+//============================================================
+// 焼いたものの読み込み
+//============================================================
+bool TextureCooker::LoadCooked(const std::string& cookedPath, DirectX::ScratchImage& image) {
+
+	std::error_code error;
+	if (!std::filesystem::exists(cookedPath, error)) {
+		return false;
+	}
+
+	std::wstring cookedPathW = std::filesystem::path(cookedPath).wstring();
+	return SUCCEEDED(DirectX::LoadFromDDSFile(cookedPathW.c_str(), DirectX::DDS_FLAGS_NONE, nullptr, image));
+}
+
+//============================================================
+// 元画像が変わっていないときだけ焼いたものを読む
+//============================================================
+bool TextureCooker::LoadCooked(const std::string& cookedPath, const SHA256Digest& sourceDigest, DirectX::ScratchImage& image) {
+
+	// 2つ目が元画像だけのハッシュ、古い形式で書かれていなければ読まない
+	std::ifstream hashFile(cookedPath + kHashExtension);
+	std::string cookHash;
+	std::string sourceHash;
+	SHA256Digest cookedDigest{};
+	if (!(hashFile >> cookHash >> sourceHash) || !SHA256Hasher::FromHex(sourceHash, cookedDigest) || cookedDigest != sourceDigest) {
+		return false;
+	}
+
+	return LoadCooked(cookedPath, image);
+}
+
+//============================================================
+// 焼いたファイルの場所
+//============================================================
+std::string TextureCooker::GetCookedPath(const std::string& sourcePath, const std::string& outputDirectory) {
+
+	// ./a/b.pngとa/b.pngが同じ名前になるように、作業ディレクトリからの相対パスにそろえる
+	std::filesystem::path source(sourcePath);
+	if (source.is_absolute()) {
+		source = source.lexically_relative(std::filesystem::current_path());
+	}
+	std::string sourceKey = source.lexically_normal().generic_string();
+	std::string pathHash = SHA256Hasher::ToHex(SHA256Hasher::Hash(sourceKey)).substr(0, kPathHashLength);
+
+	std::filesystem::path path = std::filesystem::path(outputDirectory) / std::filesystem::path(sourcePath).stem();
+	path += "-" + pathHash + ".dds";
+
+	return path.generic_string();
+}
+
+//============================================================
+// 元画像と設定のハッシュ
+//============================================================
+std::string TextureCooker::MakeHash(const std::string& source, const TextureCookSettings& settings) {
+
+	// 焼き方が変わったら別のハッシュになるように、設定とバージョンも含める
+	std::string key = std::format("{}:{}:{}:{}:", kVersion, static_cast<int>(settings.format), settings.isSRGB, settings.generateMips);
+
+	// つなげたものと同じハッシュになる、元画像はコピーしない
+	SHA256Hasher::Stream stream;
+	stream.Update(key);
+	stream.Update(source);
+	return SHA256Hasher::ToHex(stream.Finalize());
+}
+
+//============================================================
+// 焼いた後の形式
+//============================================================
+DXGI_FORMAT TextureCooker::SelectFormat(const DirectX::ScratchImage& image, const TextureCookSettings& settings) {
+
+	const DirectX::TexMetadata& metadata = image.GetMetadata();
+	DXGI_FORMAT format = metadata.format;
+
+	// D3D12ではBCの一番上のミップは4の倍数の大きさでないと作れない
+	if (settings.format == TextureCookFormat::RGBA8 || metadata.width % 4 != 0 || metadata.height % 4 != 0) {
+		return format;
+	}
+
+	TextureCookFormat cookFormat = settings.format;
+	if (cookFormat == TextureCookFormat::AUTO) {
+		cookFormat = image.IsAlphaAllOpaque() ? TextureCookFormat::BC1 : TextureCookFormat::BC3;
+	}
+
+	switch (cookFormat) {
+	case TextureCookFormat::BC1:
+		return settings.isSRGB ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM;
+	case TextureCookFormat::BC3:
+		return settings.isSRGB ? DXGI_FORMAT_BC3_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM;
+	case TextureCookFormat::BC7:
+		return settings.isSRGB ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+	default:
+		return format;
+	}
+}
\ No newline at end of file
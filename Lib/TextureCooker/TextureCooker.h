@@ -0,0 +1,86 @@
+#pragma once
+
+#include <DirectXTex.h>
+
+#include <string>
+#include <cstdint>
+
+#include "SHA256Hasher.h"
+
+// 焼いた後の形式
+enum class TextureCookFormat {
+
+	AUTO,   // 不透明ならBC1、透明があればBC3
+	BC1,    // RGB 4bpp
+	BC3,    // RGBA 8bpp
+	BC7,    // RGBA 8bpp、BC3より綺麗だが圧縮に時間がかかる
+	RGBA8,  // 圧縮しない、ミップマップだけ作っておく
+};
+
+// 焼き方の設定
+struct TextureCookSettings {
+
+	TextureCookFormat format = TextureCookFormat::AUTO;
+	// 色のテクスチャはsRGBとして扱う、法線マップなどはfalse
+	bool isSRGB = true;
+	// ミップマップを最後まで作っておく
+	bool generateMips = true;
+};
+
+// 焼いた結果
+struct TextureCookResult {
+
+	bool isSucceeded = false;
+	bool isCached = false;            // 同じ内容で焼いたものがあったので作り直さなかった
+	std::string outputPath;           // 焼いたファイル
+	std::string hash;                 // 元画像と設定のハッシュ
+	DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+	uint64_t uncompressedSize = 0;    // ミップマップ付きのRGBA8のときの大きさ
+	uint64_t cookedSize = 0;          // 焼いた後の大きさ、GPUのメモリ使用量と同じ
+	float cookTimeMs = 0.0f;
+	std::string error;                // 失敗した理由
+};
+
+//================================================
+// TextureCooker Class
+//================================================
+/// 画像をミップマップ付きのブロック圧縮したDDSに焼く
+/// 起動時のデコードとミップマップの作成をなくし、GPUのメモリを4～8分の1にする
+/// 元画像と設定のハッシュを横に置いておき、変わっていないものは焼き直さない
+class TextureCooker {
+public:
+	//====================
+	// public
+	//====================
+
+	// 焼き方を変えたら上げる、古い結果は全て焼き直しになる
+	static constexpr uint32_t kVersion = 2;
+
+	// sourcePathを焼いてoutputDirectoryに置く、ブロックの圧縮は並列で行う
+	static TextureCookResult Cook(const std::string& sourcePath, const std::string& outputDirectory, const TextureCookSettings& settings = {});
+
+	// 焼いたものの読み込み、なければfalse
+	static bool LoadCooked(const std::string& cookedPath, DirectX::ScratchImage& image);
+	// 元画像のハッシュが焼いたときと同じときだけ読む、元画像が変わっていればfalse
+	static bool LoadCooked(const std::string& cookedPath, const SHA256Digest& sourceDigest, DirectX::ScratchImage& image);
+
+	// 焼いたファイルの場所、outputDirectory/元の名前-元のパスのハッシュ.dds
+	// 別のディレクトリにある同じ名前の画像が同じファイルにならないように、パスのハッシュを付ける
+	static std::string GetCookedPath(const std::string& sourcePath, const std::string& outputDirectory);
+
+private:
+	//====================
+	// private
+	//====================
+
+	// 焼いたファイルの横に置くハッシュの拡張子、元画像と設定のハッシュ、元画像だけのハッシュの順に書く
+	static inline const char* kHashExtension = ".hash";
+	// ファイル名に付けるパスのハッシュの長さ
+	static constexpr size_t kPathHashLength = 16;
+
+	// 元画像と設定のハッシュ
+	static std::string MakeHash(const std::string& source, const TextureCookSettings& settings);
+
+	// 焼いた後の形式、BCは4の倍数の大きさでないと使えないのでRGBA8にする
+	static DXGI_FORMAT SelectFormat(const DirectX::ScratchImage& image, const TextureCookSettings& settings);
+};
\ No newline at end of file
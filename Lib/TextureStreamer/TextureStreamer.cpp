@@ -0,0 +1,305 @@
+#include "TextureStreamer.h"
+
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+//============================================================
+// 反映先と予算の設定
+//============================================================
+void TextureStreamer::Initialize(ITextureStreamContext* context, uint64_t budgetSize, uint32_t maxRequestsPerFrame) {
+
+	assert(context && maxRequestsPerFrame > 0);
+
+	context_ = context;
+	maxRequestsPerFrame_ = maxRequestsPerFrame;
+	stats_.budgetSize = budgetSize;
+}
+
+//============================================================
+// テクスチャの登録
+//============================================================
+StreamTextureId TextureStreamer::Register(uint32_t width, uint32_t height, const std::vector<uint64_t>& mipSizes, uint32_t maxTopMip) {
+
+	assert(!mipSizes.empty());
+
+	StreamTextureId id = kInvalidId;
+	if (freeIds_.empty()) {
+		id = static_cast<StreamTextureId>(entries_.size());
+		entries_.emplace_back();
+	} else {
+		id = freeIds_.back();
+		freeIds_.pop_back();
+	}
+
+	Entry& entry = entries_[id];
+	entry = {};
+	entry.mipSizes = mipSizes;
+	entry.width = width;
+	entry.height = height;
+	entry.isRegistered = true;
+
+	// kTailSize以下になる最初のミップ、一番上に置けないミップなら置けるところまで詳細にする
+	uint32_t mipCount = static_cast<uint32_t>(mipSizes.size());
+	uint32_t tailMip = 0;
+	while (tailMip + 1 < mipCount && (std::max)(width >> tailMip, height >> tailMip) > kTailSize) {
+		tailMip++;
+	}
+	entry.tailMip = (std::min)(tailMip, maxTopMip);
+	entry.residentMip = entry.tailMip;
+
+	// 小さいミップは予算に関係なく置く
+	stats_.residentSize += GetResidentSize(entry, entry.residentMip);
+	stats_.textureCount++;
+
+	// 登録直後は使われていない扱い
+	entry.lastUsedFrame = frame_;
+	LinkBack(id);
+
+	return id;
+}
+
+//============================================================
+// 登録の解除
+//============================================================
+void TextureStreamer::Unregister(StreamTextureId id) {
+
+	Entry& entry = entries_[id];
+	assert(entry.isRegistered);
+
+	stats_.residentSize -= GetResidentSize(entry, entry.residentMip);
+	stats_.textureCount--;
+
+	Unlink(id);
+	entry = {};
+	freeIds_.push_back(id);
+}
+
+//============================================================
+// 画面上の大きさから要求
+//============================================================
+void TextureStreamer::Request(StreamTextureId id, float screenSize) {
+
+	const Entry& entry = entries_[id];
+	RequestMip(id, CalculateMip(entry.width, entry.height, screenSize, static_cast<uint32_t>(entry.mipSizes.size())));
+}
+
+//============================================================
+// ミップの要求
+//============================================================
+void TextureStreamer::RequestMip(StreamTextureId id, uint32_t mip) {
+
+	Entry& entry = entries_[id];
+	assert(entry.isRegistered);
+
+	// 同じフレームで何度も描画されたら一番詳細なものに合わせる
+	entry.requestedMip = (std::min)(entry.requestedMip, mip);
+
+	// 最近使ったものとして末尾に移す
+	if (entry.lastUsedFrame != frame_ + 1) {
+		entry.lastUsedFrame = frame_ + 1;
+		Unlink(id);
+		LinkBack(id);
+	}
+}
+
+//============================================================
+// 読み込むものと追い出すものを決めて反映する
+//============================================================
+void TextureStreamer::Update() {
+
+	frame_++;
+
+	// 予算を下げたときなどは、要求を見る前に超えている分を追い出す
+	if (stats_.residentSize > stats_.budgetSize) {
+		Evict(stats_.residentSize - stats_.budgetSize, kInvalidId);
+	}
+
+	// 今置いているより詳細なミップを要求されたもの
+	std::vector<StreamTextureId> candidates;
+	for (StreamTextureId id = 0; id < entries_.size(); ++id) {
+
+		const Entry& entry = entries_[id];
+		if (entry.isRegistered && entry.requestedMip != kNoRequest && entry.requestedMip < entry.residentMip) {
+			candidates.push_back(id);
+		}
+	}
+
+	// 足りない段数が多いものから読み込む、ぼやけて見えているものほど先に直す
+	std::sort(candidates.begin(), candidates.end(), [this](StreamTextureId a, StreamTextureId b) {
+		uint32_t lackA = entries_[a].residentMip - entries_[a].requestedMip;
+		uint32_t lackB = entries_[b].residentMip - entries_[b].requestedMip;
+		return lackA != lackB ? lackA > lackB : a < b;
+		});
+
+	uint32_t requestCount = 0;
+	for (StreamTextureId id : candidates) {
+
+		if (requestCount == maxRequestsPerFrame_) {
+			break;
+		}
+
+		Entry& entry = entries_[id];
+		uint64_t size = GetResidentSize(entry, entry.requestedMip) - GetResidentSize(entry, entry.residentMip);
+
+		// 予算に入るまで他のテクスチャを追い出す、空けられなければ次のフレームに回す
+		if (stats_.residentSize + size > stats_.budgetSize &&
+			!Evict(stats_.residentSize + size - stats_.budgetSize, id)) {
+			stats_.deniedCount++;
+			continue;
+		}
+
+		entry.residentMip = entry.requestedMip;
+		entry.isChanged = true;
+
+		stats_.residentSize += size;
+		stats_.requestCount++;
+		stats_.requestedSize += size;
+		requestCount++;
+	}
+
+	// 変わったものだけ反映する、追い出してから読み込んだものも1回で済む
+	for (StreamTextureId id = 0; id < entries_.size(); ++id) {
+
+		Entry& entry = entries_[id];
+		if (entry.isChanged) {
+			entry.isChanged = false;
+			context_->SetResidentMip(id, entry.residentMip);
+		}
+
+		// 要求は毎フレーム描画から積み直す
+		entry.requestedMip = kNoRequest;
+	}
+}
+
+//============================================================
+// 必要なミップを求める
+//============================================================
+uint32_t TextureStreamer::CalculateMip(uint32_t width, uint32_t height, float screenSize, uint32_t mipCount) {
+
+	// 画面外や潰れているものは一番小さいもので足りる
+	if (!(screenSize >= 1.0f)) {
+		return mipCount - 1;
+	}
+
+	// 1ピクセルあたりのテクセル数が1以下になるまで縮める
+	float texelsPerPixel = static_cast<float>((std::max)(width, height)) / screenSize;
+	if (texelsPerPixel <= 1.0f) {
+		return 0;
+	}
+
+	uint32_t mip = static_cast<uint32_t>(std::floor(std::log2(texelsPerPixel)));
+	return (std::min)(mip, mipCount - 1);
+}
+
+//============================================================
+// 常駐するミップの大きさの合計
+//============================================================
+uint64_t TextureStreamer::GetResidentSize(const Entry& entry, uint32_t mip) {
+
+	uint64_t size = 0;
+	for (size_t i = mip; i < entry.mipSizes.size(); ++i) {
+		size += entry.mipSizes[i];
+	}
+
+	return size;
+}
+
+//============================================================
+// 追い出しても良い一番詳細なミップ
+//============================================================
+uint32_t TextureStreamer::GetKeepMip(const Entry& entry) const {
+
+	// このフレームで使ったものは要求されたミップまで残す
+	if (entry.lastUsedFrame == frame_ && entry.requestedMip != kNoRequest) {
+		return (std::min)(entry.requestedMip, entry.tailMip);
+	}
+
+	return entry.tailMip;
+}
+
+//============================================================
+// 使われていない順に追い出す
+//============================================================
+bool TextureStreamer::Evict(uint64_t size, StreamTextureId exclude) {
+
+	// 先に空けられるかを確かめる、足りないのに追い出すと無駄になる
+	uint64_t evictableSize = 0;
+	for (StreamTextureId id = lruHead_; id != kInvalidId && evictableSize < size; id = entries_[id].next) {
+
+		const Entry& entry = entries_[id];
+		uint32_t keepMip = GetKeepMip(entry);
+		if (id != exclude && entry.residentMip < keepMip) {
+			evictableSize += GetResidentSize(entry, entry.residentMip) - GetResidentSize(entry, keepMip);
+		}
+	}
+
+	if (evictableSize < size) {
+		return false;
+	}
+
+	// 一番使われていないものから、詳細なミップを1段ずつ外す
+	uint64_t evictedSize = 0;
+	for (StreamTextureId id = lruHead_; id != kInvalidId && evictedSize < size; id = entries_[id].next) {
+
+		Entry& entry = entries_[id];
+		if (id == exclude) {
+			continue;
+		}
+
+		uint32_t keepMip = GetKeepMip(entry);
+		while (entry.residentMip < keepMip && evictedSize < size) {
+
+			uint64_t mipSize = entry.mipSizes[entry.residentMip];
+			entry.residentMip++;
+			entry.isChanged = true;
+
+			evictedSize += mipSize;
+			stats_.residentSize -= mipSize;
+			stats_.evictionCount++;
+			stats_.evictedSize += mipSize;
+		}
+	}
+
+	return true;
+}
+
+//============================================================
+// 使われた順のリストの末尾に追加
+//============================================================
+void TextureStreamer::LinkBack(StreamTextureId id) {
+
+	Entry& entry = entries_[id];
+	entry.prev = lruTail_;
+	entry.next = kInvalidId;
+
+	if (lruTail_ != kInvalidId) {
+		entries_[lruTail_].next = id;
+	} else {
+		lruHead_ = id;
+	}
+	lruTail_ = id;
+}
+
+//============================================================
+// 使われた順のリストから外す
+//============================================================
+void TextureStreamer::Unlink(StreamTextureId id) {
+
+	Entry& entry = entries_[id];
+
+	if (entry.prev != kInvalidId) {
+		entries_[entry.prev].next = entry.next;
+	} else {
+		lruHead_ = entry.next;
+	}
+
+	if (entry.next != kInvalidId) {
+		entries_[entry.next].prev = entry.prev;
+	} else {
+		lruTail_ = entry.prev;
+	}
+
+	entry.prev = kInvalidId;
+	entry.next = kInvalidId;
+}
\ No newline at end of file
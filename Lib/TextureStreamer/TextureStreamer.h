@@ -0,0 +1,145 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+// ストリーミングするテクスチャの番号、登録順
+using StreamTextureId = uint32_t;
+
+//================================================
+// ITextureStreamContext Class
+//================================================
+/// TextureStreamerが決めた常駐ミップを反映するもの
+/// D3D12ではリソースを作り直して転送する、デバイスがない環境では記録するだけのものに差し替えられる
+class ITextureStreamContext {
+public:
+	//====================
+	// public
+	//====================
+
+	// 仮想デストラクタ
+	virtual ~ITextureStreamContext() {}
+
+	// mipより詳細でないミップを常駐させる、数字が小さいほど詳細
+	virtual void SetResidentMip(StreamTextureId id, uint32_t mip) = 0;
+};
+
+//================================================
+// TextureStreamer Class
+//================================================
+/// テクスチャごとにどのミップまでGPUに置くかを決める
+/// 登録直後は小さいミップだけを置き、描画の画面上の大きさから要求されたミップを読み込む
+/// 予算を超える分は、最近使われていないテクスチャの詳細なミップから追い出す
+/// 描画を積むメインスレッドから使う
+class TextureStreamer {
+public:
+	//====================
+	// public
+	//====================
+
+	// 無効な番号
+	static constexpr StreamTextureId kInvalidId = ~0u;
+
+	// 登録直後に置くミップの大きさ、これ以下のミップは追い出さない
+	static constexpr uint32_t kTailSize = 64;
+
+	// 統計
+	struct Stats {
+
+		uint32_t textureCount = 0;    // 登録されているテクスチャの数
+		uint64_t residentSize = 0;    // 常駐しているミップの大きさの合計
+		uint64_t budgetSize = 0;      // 予算
+		uint64_t requestCount = 0;    // 詳細なミップを読み込んだ回数
+		uint64_t requestedSize = 0;   // 読み込んだミップの大きさの合計
+		uint64_t evictionCount = 0;   // 追い出したミップの数
+		uint64_t evictedSize = 0;     // 追い出したミップの大きさの合計
+		uint64_t deniedCount = 0;     // 予算に入らず読み込めなかった回数
+	};
+
+	TextureStreamer() = default;
+	~TextureStreamer() = default;
+
+	// 反映先と予算の設定、1フレームに読み込むテクスチャの数を制限する
+	void Initialize(ITextureStreamContext* context, uint64_t budgetSize, uint32_t maxRequestsPerFrame);
+
+	// テクスチャの登録、mipSizesは詳細な順に各ミップの大きさ
+	// maxTopMipは一番上に置けるミップの最大、ブロック圧縮で大きさが4の倍数でないミップは一番上にできない
+	StreamTextureId Register(uint32_t width, uint32_t height, const std::vector<uint64_t>& mipSizes, uint32_t maxTopMip);
+	// 登録の解除、番号は再利用する
+	void Unregister(StreamTextureId id);
+
+	// 画面上でscreenSizeピクセルの大きさに描画される、必要なミップを求めて要求する
+	void Request(StreamTextureId id, float screenSize);
+	// ミップを直接要求する
+	void RequestMip(StreamTextureId id, uint32_t mip);
+
+	// このフレームの要求から、読み込むものと追い出すものを決めて反映する
+	void Update();
+
+	// 予算の変更、超えている分は次のUpdateで追い出す
+	void SetBudget(uint64_t budgetSize) { stats_.budgetSize = budgetSize; }
+
+	// テクスチャの大きさと画面上の大きさから、テクセルとピクセルが1対1になるミップを求める
+	static uint32_t CalculateMip(uint32_t width, uint32_t height, float screenSize, uint32_t mipCount);
+
+	// getter
+
+	// 一番上に置かれているミップ
+	uint32_t GetResidentMip(StreamTextureId id) const { return entries_[id].residentMip; }
+	// 登録直後に置くミップ、これより詳細でないミップは常に置かれる
+	uint32_t GetTailMip(StreamTextureId id) const { return entries_[id].tailMip; }
+	const Stats& GetStats() const { return stats_; }
+
+private:
+	//====================
+	// private
+	//====================
+
+	// 要求がない
+	static constexpr uint32_t kNoRequest = ~0u;
+
+	struct Entry {
+
+		std::vector<uint64_t> mipSizes;
+		uint32_t width = 0;
+		uint32_t height = 0;
+
+		uint32_t residentMip = 0;       // 一番上に置かれているミップ
+		uint32_t tailMip = 0;           // これより詳細でないミップは追い出さない
+		uint32_t requestedMip = kNoRequest; // このフレームで要求された一番詳細なミップ
+
+		uint64_t lastUsedFrame = 0;     // 最後に要求されたフレーム
+		bool isChanged = false;         // このUpdateで常駐ミップが変わった
+		bool isRegistered = false;
+
+		// 使われた順の双方向リスト、先頭が一番使われていない
+		StreamTextureId prev = kInvalidId;
+		StreamTextureId next = kInvalidId;
+	};
+
+	ITextureStreamContext* context_ = nullptr;
+	uint32_t maxRequestsPerFrame_ = 0;
+
+	std::vector<Entry> entries_;
+	std::vector<StreamTextureId> freeIds_;
+
+	// 使われた順のリストの先頭と末尾
+	StreamTextureId lruHead_ = kInvalidId;
+	StreamTextureId lruTail_ = kInvalidId;
+
+	uint64_t frame_ = 0;
+	Stats stats_;
+
+	// mipから下の常駐するミップの大きさの合計
+	static uint64_t GetResidentSize(const Entry& entry, uint32_t mip);
+
+	// 追い出しても良い一番詳細なミップ、このフレームで使ったものは要求されたミップまで残す
+	uint32_t GetKeepMip(const Entry& entry) const;
+
+	// size分空くまで、使われていない順に詳細なミップを追い出す。excludeは追い出さない
+	bool Evict(uint64_t size, StreamTextureId exclude);
+
+	// 使われた順のリストの操作
+	void LinkBack(StreamTextureId id);
+	void Unlink(StreamTextureId id);
+};
\ No newline at end of file
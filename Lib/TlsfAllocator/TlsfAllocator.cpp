@@ -0,0 +1,350 @@
+#include "TlsfAllocator.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+//============================================================
+// 断片化率
+//============================================================
+float TlsfAllocator::Stats::GetFragmentation() const {
+
+	uint64_t freeSize = capacity - usedSize;
+	if (freeSize == 0) {
+		return 0.0f;
+	}
+
+	return 1.0f - static_cast<float>(largestFreeBlock) / static_cast<float>(freeSize);
+}
+
+//============================================================
+// 初期化
+//============================================================
+void TlsfAllocator::Initialize(uint64_t capacity, uint64_t granularity) {
+
+	// granularityは2の累乗
+	assert(granularity > 0 && (granularity & (granularity - 1)) == 0);
+	assert(capacity >= granularity);
+
+	granularity_ = granularity;
+	// 粒度に満たない端は使わない
+	capacity_ = capacity / granularity_ * granularity_;
+	usedSize_ = 0;
+
+	blocks_.clear();
+	unusedBlocks_.clear();
+	usedBlocks_.clear();
+
+	for (auto& heads : freeHeads_) {
+		std::fill(std::begin(heads), std::end(heads), kNullBlock);
+	}
+	std::fill(std::begin(secondLevelBitmaps_), std::end(secondLevelBitmaps_), 0u);
+	firstLevelBitmap_ = 0;
+
+	// 全体を1つの空き区間にする
+	uint32_t blockIndex = NewBlock();
+	blocks_[blockIndex].offset = 0;
+	blocks_[blockIndex].size = capacity_;
+	InsertFreeBlock(blockIndex);
+
+	stats_ = {};
+}
+
+//============================================================
+// 確保
+//============================================================
+uint64_t TlsfAllocator::Allocate(uint64_t size, uint64_t alignment) {
+
+	// alignmentは2の累乗
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+	if (size == 0 || size > capacity_) {
+
+		stats_.failedCount++;
+		return kInvalidOffset;
+	}
+
+	// 粒度単位に切り上げる
+	uint64_t units = (size + granularity_ - 1) / granularity_;
+	alignment = (std::max)(alignment, granularity_);
+
+	// 粒度より大きい境界が必要なら、前に捨てる分も含めて探す
+	uint64_t searchUnits = units + (alignment / granularity_ - 1);
+
+	uint32_t blockIndex = FindFreeBlock(searchUnits);
+	if (blockIndex == kNullBlock) {
+
+		stats_.failedCount++;
+		return kInvalidOffset;
+	}
+
+	RemoveFreeBlock(blockIndex);
+
+	// 境界に合わせるため前を切り離す。前の区間は使用中のはずなのでつなげなくてよい
+	uint64_t offset = blocks_[blockIndex].offset;
+	uint64_t alignedOffset = (offset + alignment - 1) / alignment * alignment;
+	if (alignedOffset != offset) {
+
+		uint32_t frontIndex = blockIndex;
+		SplitBlock(frontIndex, alignedOffset - offset);
+
+		blockIndex = blocks_[frontIndex].nextPhysical;
+		RemoveFreeBlock(blockIndex);
+		InsertFreeBlock(frontIndex);
+	}
+
+	// 余った後ろを空きとして戻す
+	uint64_t allocationSize = units * granularity_;
+	if (blocks_[blockIndex].size > allocationSize) {
+
+		SplitBlock(blockIndex, allocationSize);
+	}
+
+	blocks_[blockIndex].isFree = false;
+	usedBlocks_[alignedOffset] = blockIndex;
+	usedSize_ += allocationSize;
+
+	// 統計の更新
+	stats_.allocations++;
+	stats_.peakUsedSize = (std::max)(stats_.peakUsedSize, usedSize_);
+
+	return alignedOffset;
+}
+
+//============================================================
+// 返却
+//============================================================
+void TlsfAllocator::Free(uint64_t offset) {
+
+	auto it = usedBlocks_.find(offset);
+	// 確保していないオフセット、または二重返却
+	assert(it != usedBlocks_.end());
+
+	uint32_t blockIndex = it->second;
+	usedBlocks_.erase(it);
+
+	usedSize_ -= blocks_[blockIndex].size;
+	blocks_[blockIndex].isFree = true;
+
+	// 前の空き区間とつなげる
+	uint32_t prevIndex = blocks_[blockIndex].prevPhysical;
+	if (prevIndex != kNullBlock && blocks_[prevIndex].isFree) {
+
+		RemoveFreeBlock(prevIndex);
+
+		blocks_[prevIndex].size += blocks_[blockIndex].size;
+		blocks_[prevIndex].nextPhysical = blocks_[blockIndex].nextPhysical;
+		if (blocks_[blockIndex].nextPhysical != kNullBlock) {
+			blocks_[blocks_[blockIndex].nextPhysical].prevPhysical = prevIndex;
+		}
+
+		DeleteBlock(blockIndex);
+		blockIndex = prevIndex;
+	}
+
+	// 後ろの空き区間とつなげる
+	uint32_t nextIndex = blocks_[blockIndex].nextPhysical;
+	if (nextIndex != kNullBlock && blocks_[nextIndex].isFree) {
+
+		RemoveFreeBlock(nextIndex);
+
+		blocks_[blockIndex].size += blocks_[nextIndex].size;
+		blocks_[blockIndex].nextPhysical = blocks_[nextIndex].nextPhysical;
+		if (blocks_[nextIndex].nextPhysical != kNullBlock) {
+			blocks_[blocks_[nextIndex].nextPhysical].prevPhysical = blockIndex;
+		}
+
+		DeleteBlock(nextIndex);
+	}
+
+	InsertFreeBlock(blockIndex);
+	stats_.frees++;
+}
+
+//============================================================
+// 統計の取得
+//============================================================
+TlsfAllocator::Stats TlsfAllocator::GetStats() const {
+
+	Stats stats = stats_;
+	stats.capacity = capacity_;
+	stats.usedSize = usedSize_;
+	stats.allocationCount = static_cast<uint32_t>(usedBlocks_.size());
+
+	// 空き区間を数える、表示用なので区分を全部たどる
+	for (uint32_t fl = 0; fl < kFirstLevelNum; ++fl) {
+		for (uint32_t sl = 0; sl < kSecondLevelNum; ++sl) {
+			for (uint32_t i = freeHeads_[fl][sl]; i != kNullBlock; i = blocks_[i].nextFree) {
+
+				stats.freeBlockCount++;
+				stats.largestFreeBlock = (std::max)(stats.largestFreeBlock, blocks_[i].size);
+			}
+		}
+	}
+
+	return stats;
+}
+
+//============================================================
+// サイズから区分を求める
+//============================================================
+void TlsfAllocator::Mapping(uint64_t units, uint32_t& firstLevel, uint32_t& secondLevel) {
+
+	if (units < kSecondLevelNum) {
+
+		// 小さいものは1段目0に1単位ずつ並べる
+		firstLevel = 0;
+		secondLevel = static_cast<uint32_t>(units);
+	} else {
+
+		// 最上位ビットで1段目、その下のビットで2段目を決める
+		uint32_t msb = static_cast<uint32_t>(std::bit_width(units)) - 1;
+		firstLevel = msb - kSecondLevelLog2 + 1;
+		secondLevel = static_cast<uint32_t>((units >> (msb - kSecondLevelLog2)) - kSecondLevelNum);
+	}
+
+	assert(firstLevel < kFirstLevelNum);
+}
+
+//============================================================
+// 区間の生成
+//============================================================
+uint32_t TlsfAllocator::NewBlock() {
+
+	uint32_t blockIndex;
+	if (!unusedBlocks_.empty()) {
+
+		blockIndex = unusedBlocks_.back();
+		unusedBlocks_.pop_back();
+	} else {
+
+		blockIndex = static_cast<uint32_t>(blocks_.size());
+		blocks_.emplace_back();
+	}
+
+	blocks_[blockIndex] = { 0, 0, kNullBlock, kNullBlock, kNullBlock, kNullBlock, false };
+	return blockIndex;
+}
+
+//============================================================
+// 区間の破棄
+//============================================================
+void TlsfAllocator::DeleteBlock(uint32_t blockIndex) {
+
+	unusedBlocks_.push_back(blockIndex);
+}
+
+//============================================================
+// 空きリストに入れる
+//============================================================
+void TlsfAllocator::InsertFreeBlock(uint32_t blockIndex) {
+
+	Block& block = blocks_[blockIndex];
+	block.isFree = true;
+
+	uint32_t fl, sl;
+	Mapping(block.size / granularity_, fl, sl);
+
+	// 先頭に入れる
+	block.prevFree = kNullBlock;
+	block.nextFree = freeHeads_[fl][sl];
+	if (block.nextFree != kNullBlock) {
+		blocks_[block.nextFree].prevFree = blockIndex;
+	}
+	freeHeads_[fl][sl] = blockIndex;
+
+	firstLevelBitmap_ |= 1ull << fl;
+	secondLevelBitmaps_[fl] |= 1u << sl;
+}
+
+//============================================================
+// 空きリストから外す
+//============================================================
+void TlsfAllocator::RemoveFreeBlock(uint32_t blockIndex) {
+
+	Block& block = blocks_[blockIndex];
+
+	uint32_t fl, sl;
+	Mapping(block.size / granularity_, fl, sl);
+
+	if (block.prevFree != kNullBlock) {
+		blocks_[block.prevFree].nextFree = block.nextFree;
+	} else {
+		freeHeads_[fl][sl] = block.nextFree;
+	}
+	if (block.nextFree != kNullBlock) {
+		blocks_[block.nextFree].prevFree = block.prevFree;
+	}
+
+	// 区分が空になったらビットを落とす
+	if (freeHeads_[fl][sl] == kNullBlock) {
+
+		secondLevelBitmaps_[fl] &= ~(1u << sl);
+		if (secondLevelBitmaps_[fl] == 0) {
+			firstLevelBitmap_ &= ~(1ull << fl);
+		}
+	}
+
+	block.prevFree = kNullBlock;
+	block.nextFree = kNullBlock;
+	block.isFree = false;
+}
+
+//============================================================
+// 空き区間を探す
+//============================================================
+uint32_t TlsfAllocator::FindFreeBlock(uint64_t units) const {
+
+	// 区分内のどの区間でも足りるよう、次の区分の先頭まで切り上げてから探す
+	if (units >= kSecondLevelNum) {
+
+		uint32_t msb = static_cast<uint32_t>(std::bit_width(units)) - 1;
+		units += (1ull << (msb - kSecondLevelLog2)) - 1;
+	}
+
+	uint32_t fl, sl;
+	Mapping(units, fl, sl);
+
+	// 同じ1段目で、sl以上の区分
+	uint32_t secondLevelMap = secondLevelBitmaps_[fl] & (~0u << sl);
+	if (secondLevelMap == 0) {
+
+		// より大きい1段目
+		uint64_t firstLevelMap = (fl + 1 < 64) ? (firstLevelBitmap_ & (~0ull << (fl + 1))) : 0;
+		if (firstLevelMap == 0) {
+			return kNullBlock;
+		}
+
+		fl = static_cast<uint32_t>(std::countr_zero(firstLevelMap));
+		secondLevelMap = secondLevelBitmaps_[fl];
+	}
+
+	sl = static_cast<uint32_t>(std::countr_zero(secondLevelMap));
+	return freeHeads_[fl][sl];
+}
+
+//============================================================
+// 区間の分割
+//============================================================
+void TlsfAllocator::SplitBlock(uint32_t blockIndex, uint64_t size) {
+
+	assert(blocks_[blockIndex].size > size);
+
+	uint32_t restIndex = NewBlock();
+	// NewBlockでblocks_が伸びることがあるので、ここから参照を取る
+	Block& block = blocks_[blockIndex];
+	Block& rest = blocks_[restIndex];
+
+	rest.offset = block.offset + size;
+	rest.size = block.size - size;
+	rest.prevPhysical = blockIndex;
+	rest.nextPhysical = block.nextPhysical;
+	if (block.nextPhysical != kNullBlock) {
+		blocks_[block.nextPhysical].prevPhysical = restIndex;
+	}
+
+	block.size = size;
+	block.nextPhysical = restIndex;
+
+	InsertFreeBlock(restIndex);
+}
\ No newline at end of file
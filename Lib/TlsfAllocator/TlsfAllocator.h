@@ -0,0 +1,123 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+//================================================
+// TlsfAllocator Class
+//================================================
+/// TLSF(Two-Level Segregated Fit)でオフセットを切り分けるアロケータ
+/// 空き区間をサイズの2段階の区分に分けて持ち、確保も返却もO(1)で済む
+/// 返却時は隣の空き区間とつなげる。メモリには触らない
+class TlsfAllocator {
+public:
+	//====================
+	// public
+	//====================
+
+	// 確保失敗
+	static constexpr uint64_t kInvalidOffset = ~0ull;
+
+	// 統計
+	struct Stats {
+
+		uint64_t capacity = 0;         // 全体のサイズ
+		uint64_t usedSize = 0;         // 使用中のサイズ(粒度に切り上げた分も含む)
+		uint64_t peakUsedSize = 0;     // 最大使用サイズ
+		uint64_t largestFreeBlock = 0; // 連続して確保できる最大サイズ
+		uint32_t freeBlockCount = 0;   // 空き区間の数
+		uint32_t allocationCount = 0;  // 使用中の確保数
+		uint32_t allocations = 0;      // 確保回数
+		uint32_t frees = 0;            // 返却回数
+		uint32_t failedCount = 0;      // 確保に失敗した回数
+
+		// 断片化率、空きが1つにまとまっていれば0、細かく散らばるほど1に近づく
+		float GetFragmentation() const;
+	};
+
+	TlsfAllocator() = default;
+	~TlsfAllocator() = default;
+
+	// 初期化、granularityの倍数で切り分ける(2の累乗)
+	void Initialize(uint64_t capacity, uint64_t granularity);
+
+	// 確保、alignmentは2の累乗。失敗したらkInvalidOffset
+	uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+	// 返却
+	void Free(uint64_t offset);
+
+	// getter
+
+	uint64_t GetCapacity() const { return capacity_; }
+	uint64_t GetUsedSize() const { return usedSize_; }
+	bool IsEmpty() const { return usedSize_ == 0; }
+	Stats GetStats() const;
+
+private:
+	//====================
+	// private
+	//====================
+
+	// 1段目の区分数、2段目の区分数(2のkSecondLevelLog2乗)
+	static constexpr uint32_t kFirstLevelNum = 48;
+	static constexpr uint32_t kSecondLevelLog2 = 4;
+	static constexpr uint32_t kSecondLevelNum = 1u << kSecondLevelLog2;
+
+	// 区間が無い
+	static constexpr uint32_t kNullBlock = ~0u;
+
+	// 区間
+	struct Block {
+
+		uint64_t offset;
+		uint64_t size;
+
+		// 物理的に隣の区間
+		uint32_t prevPhysical;
+		uint32_t nextPhysical;
+
+		// 同じ区分の空きリスト
+		uint32_t prevFree;
+		uint32_t nextFree;
+
+		bool isFree;
+	};
+
+	uint64_t capacity_ = 0;
+	uint64_t granularity_ = 1;
+	uint64_t usedSize_ = 0;
+
+	// 区間の実体、使い終わった番号は使い回す
+	std::vector<Block> blocks_;
+	std::vector<uint32_t> unusedBlocks_;
+
+	// 区分ごとの空きリストの先頭
+	uint32_t freeHeads_[kFirstLevelNum][kSecondLevelNum];
+	// 空きのある区分のビット
+	uint64_t firstLevelBitmap_ = 0;
+	uint32_t secondLevelBitmaps_[kFirstLevelNum];
+
+	// 使用中の区間 オフセット → 区間番号
+	std::unordered_map<uint64_t, uint32_t> usedBlocks_;
+
+	Stats stats_;
+
+	// サイズ(粒度単位)から区分を求める
+	static void Mapping(uint64_t units, uint32_t& firstLevel, uint32_t& secondLevel);
+
+	// 区間の生成と破棄
+	uint32_t NewBlock();
+	void DeleteBlock(uint32_t blockIndex);
+
+	// 空きリストへの出し入れ
+	void InsertFreeBlock(uint32_t blockIndex);
+	void RemoveFreeBlock(uint32_t blockIndex);
+
+	// units以上の空きがある区間を探す
+	uint32_t FindFreeBlock(uint64_t units) const;
+
+	// blockIndexの先頭からsizeだけ残し、後ろを空き区間として切り離す
+	void SplitBlock(uint32_t blockIndex, uint64_t size);
+};
\ No newline at end of file
@@ -0,0 +1,323 @@
+#include "UploadQueue.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+//============================================================
+// 初期化
+//============================================================
+void UploadQueue::Initialize(uint8_t* stagingData, uint64_t capacity, uint64_t frameBudget) {
+
+	assert(stagingData);
+	assert(frameBudget > 0);
+
+	stagingData_ = stagingData;
+	stagingAllocator_.Initialize(capacity);
+	frameBudget_ = frameBudget;
+	frameSize_ = 0;
+
+	requests_.clear();
+	frames_.clear();
+
+	nextId_ = 1;
+	submittedId_ = kInvalidId;
+	completedId_ = kInvalidId;
+
+	stats_ = {};
+}
+
+//============================================================
+// バッファの転送の登録
+//============================================================
+UploadId UploadQueue::EnqueueBuffer(void* destination, uint64_t destinationOffset,
+	const void* data, uint64_t size, std::shared_ptr<const void> owner) {
+
+	assert(destination && data && size > 0);
+
+	Request request{};
+	request.id = nextId_++;
+	request.destination = destination;
+	request.isTexture = false;
+	request.data = static_cast<const uint8_t*>(data);
+	request.destinationOffset = destinationOffset;
+	request.size = size;
+	request.uploadedSize = 0;
+	request.nextSubresource = 0;
+	request.owner = std::move(owner);
+
+	stats_.pendingSize += size;
+	stats_.pendingCount++;
+
+	requests_.push_back(std::move(request));
+	return requests_.back().id;
+}
+
+//============================================================
+// テクスチャの転送の登録
+//============================================================
+UploadId UploadQueue::EnqueueTexture(void* destination,
+	const std::vector<UploadSubresource>& subresources, std::shared_ptr<const void> owner) {
+
+	assert(destination && !subresources.empty());
+
+	Request request{};
+	request.id = nextId_++;
+	request.destination = destination;
+	request.isTexture = true;
+	request.data = nullptr;
+	request.destinationOffset = 0;
+	request.uploadedSize = 0;
+	request.subresources = subresources;
+	request.nextSubresource = 0;
+	request.owner = std::move(owner);
+
+	// 配置は登録時に決めておく、記録時はステージング上の位置を足すだけ
+	request.size = 0;
+	for (const auto& subresource : subresources) {
+
+		uint32_t rowPitch = 0;
+		uint64_t size = CalculateFootprintSize(subresource, rowPitch);
+
+		// 1つのサブリソースがステージングに入らない
+		assert(size <= stagingAllocator_.GetCapacity());
+		request.size += size;
+	}
+
+	stats_.pendingSize += request.size;
+	stats_.pendingCount++;
+
+	requests_.push_back(std::move(request));
+	return requests_.back().id;
+}
+
+//============================================================
+// 転送の取り消し
+//============================================================
+void UploadQueue::Cancel(UploadId id) {
+
+	auto it = std::find_if(requests_.begin(), requests_.end(),
+		[id](const Request& request) { return request.id == id; });
+	if (it == requests_.end()) {
+		return;
+	}
+
+	// 記録済みの分はそのまま、残りを捨てる
+	uint64_t remainingSize = it->size - it->uploadedSize;
+	if (it->isTexture) {
+
+		remainingSize = 0;
+		for (size_t i = it->nextSubresource; i < it->subresources.size(); ++i) {
+
+			uint32_t rowPitch = 0;
+			remainingSize += CalculateFootprintSize(it->subresources[i], rowPitch);
+		}
+	}
+
+	stats_.pendingSize -= remainingSize;
+	stats_.pendingCount--;
+
+	requests_.erase(it);
+}
+
+//============================================================
+// budgetまで記録する
+//============================================================
+void UploadQueue::Process(ICopyContext& context) {
+
+	ProcessRequests(context, frameBudget_);
+}
+
+//============================================================
+// 入るだけ記録する
+//============================================================
+bool UploadQueue::Flush(ICopyContext& context) {
+
+	return ProcessRequests(context, ~0ull);
+}
+
+//============================================================
+// フレームの終了
+//============================================================
+void UploadQueue::FinishFrame(uint64_t fenceValue) {
+
+	stagingAllocator_.FinishFrame(fenceValue);
+	frames_.push_back({ fenceValue, submittedId_ });
+
+	stats_.frameSize = frameSize_;
+	frameSize_ = 0;
+}
+
+//============================================================
+// 完了したフレームの回収
+//============================================================
+void UploadQueue::ReleaseCompletedFrames(uint64_t completedFenceValue) {
+
+	stagingAllocator_.ReleaseCompletedFrames(completedFenceValue);
+
+	while (!frames_.empty() && frames_.front().fenceValue <= completedFenceValue) {
+
+		completedId_ = frames_.front().lastId;
+		frames_.pop_front();
+	}
+}
+
+//============================================================
+// 全て破棄
+//============================================================
+void UploadQueue::Reset() {
+
+	stagingAllocator_.Reset();
+	frameSize_ = 0;
+
+	requests_.clear();
+	frames_.clear();
+
+	// 破棄したものは完了扱いにする
+	submittedId_ = nextId_ - 1;
+	completedId_ = nextId_ - 1;
+
+	stats_.pendingSize = 0;
+	stats_.pendingCount = 0;
+}
+
+//============================================================
+// 配置の計算
+//============================================================
+uint64_t UploadQueue::CalculateFootprintSize(const UploadSubresource& subresource, uint32_t& rowPitch) {
+
+	assert(subresource.rowCount > 0 && subresource.rowPitch > 0);
+
+	// 行の先頭を揃える、最後の行は詰めたままでよい
+	rowPitch = static_cast<uint32_t>(
+		(subresource.rowPitch + kTexturePitchAlignment - 1) / kTexturePitchAlignment * kTexturePitchAlignment);
+	uint64_t totalRowCount = static_cast<uint64_t>(subresource.rowCount) * subresource.depth;
+
+	return rowPitch * (totalRowCount - 1) + subresource.rowPitch;
+}
+
+//============================================================
+// limitまで記録する
+//============================================================
+bool UploadQueue::ProcessRequests(ICopyContext& context, uint64_t limit) {
+
+	while (!requests_.empty()) {
+
+		Request& request = requests_.front();
+
+		bool progressed = request.isTexture ?
+			ProcessTexture(context, request, limit) :
+			ProcessBuffer(context, request, limit);
+		if (!progressed) {
+			return false;
+		}
+
+		// 全て記録したら読める状態に戻す
+		bool finished = request.isTexture ?
+			request.nextSubresource == request.subresources.size() :
+			request.uploadedSize == request.size;
+		if (finished) {
+
+			context.FinishUpload(request.destination, request.isTexture);
+
+			submittedId_ = request.id;
+			stats_.pendingCount--;
+			stats_.uploadCount++;
+
+			// 元データはもう読まない
+			requests_.pop_front();
+		}
+	}
+
+	return true;
+}
+
+//============================================================
+// バッファの一部を記録する
+//============================================================
+bool UploadQueue::ProcessBuffer(ICopyContext& context, Request& request, uint64_t limit) {
+
+	if (frameSize_ >= limit) {
+
+		stats_.budgetLimitedCount++;
+		return false;
+	}
+
+	// budgetの残りとステージングに入る分だけ記録する
+	uint64_t size = request.size - request.uploadedSize;
+	size = (std::min)(size, limit - frameSize_);
+	size = (std::min)(size, stagingAllocator_.GetCapacity());
+
+	uint64_t offset = stagingAllocator_.Allocate(size, kBufferAlignment);
+	if (offset == RingAllocator::kInvalidOffset) {
+
+		// GPUが前のフレームを読み終わるまで待つ
+		stats_.stagingFullCount++;
+		return false;
+	}
+
+	std::memcpy(stagingData_ + offset, request.data + request.uploadedSize, size);
+	context.CopyBuffer(request.destination, request.destinationOffset + request.uploadedSize, offset, size);
+
+	request.uploadedSize += size;
+	frameSize_ += size;
+
+	stats_.pendingSize -= size;
+	stats_.uploadedSize += size;
+	stats_.copyCount++;
+
+	return true;
+}
+
+//============================================================
+// サブリソースを1つ記録する
+//============================================================
+bool UploadQueue::ProcessTexture(ICopyContext& context, Request& request, uint64_t limit) {
+
+	const UploadSubresource& subresource = request.subresources[request.nextSubresource];
+
+	uint32_t rowPitch = 0;
+	uint64_t size = CalculateFootprintSize(subresource, rowPitch);
+
+	// サブリソースは分けられないので、このフレームに何か記録済みなら次に回す
+	if (frameSize_ > 0 && frameSize_ + size > limit) {
+
+		stats_.budgetLimitedCount++;
+		return false;
+	}
+
+	uint64_t offset = stagingAllocator_.Allocate(size, kTexturePlacementAlignment);
+	if (offset == RingAllocator::kInvalidOffset) {
+
+		stats_.stagingFullCount++;
+		return false;
+	}
+
+	// 行ごとに揃えた位置へ詰める
+	uint64_t totalRowCount = static_cast<uint64_t>(subresource.rowCount) * subresource.depth;
+	for (uint64_t row = 0; row < totalRowCount; ++row) {
+
+		std::memcpy(
+			stagingData_ + offset + row * rowPitch,
+			subresource.data + row * subresource.rowPitch,
+			subresource.rowPitch);
+	}
+
+	UploadFootprint footprint{};
+	footprint.offset = offset;
+	footprint.format = subresource.format;
+	footprint.width = subresource.width;
+	footprint.height = subresource.height;
+	footprint.depth = subresource.depth;
+	footprint.rowPitch = rowPitch;
+	context.CopyTexture(request.destination, request.nextSubresource, footprint);
+
+	request.nextSubresource++;
+	frameSize_ += size;
+
+	stats_.pendingSize -= size;
+	stats_.uploadedSize += size;
+	stats_.copyCount++;
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "RingAllocator.h"
+
+// 転送の番号、登録順に増える
+using UploadId = uint64_t;
+
+// テクスチャのサブリソース1つ分の配置、D3D12_PLACED_SUBRESOURCE_FOOTPRINTと同じ中身
+struct UploadFootprint {
+
+	uint64_t offset = 0;    // ステージング内の位置
+	uint32_t format = 0;    // DXGI_FORMAT
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t depth = 1;
+	uint32_t rowPitch = 0;  // ステージング内の1行の間隔
+};
+
+// テクスチャのサブリソース1つ分の元データ
+struct UploadSubresource {
+
+	const uint8_t* data = nullptr;
+	uint64_t rowPitch = 0;  // 元データの1行の間隔
+	uint32_t rowCount = 0;  // 行数、ブロック圧縮なら4ピクセルで1行
+	uint32_t format = 0;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t depth = 1;
+};
+
+//================================================
+// ICopyContext Class
+//================================================
+/// UploadQueueのコピーの記録先
+/// D3D12ではコマンドリスト、デバイスがない環境では記録内容を残すだけのものに差し替えられる
+class ICopyContext {
+public:
+	//====================
+	// public
+	//====================
+
+	// 仮想デストラクタ
+	virtual ~ICopyContext() {}
+
+	// ステージングからバッファへ
+	virtual void CopyBuffer(void* destination, uint64_t destinationOffset, uint64_t stagingOffset, uint64_t size) = 0;
+	// ステージングからテクスチャのサブリソースへ
+	virtual void CopyTexture(void* destination, uint32_t subresource, const UploadFootprint& footprint) = 0;
+	// destinationへのコピーを全て記録した、読める状態に戻す
+	virtual void FinishUpload(void* destination, bool isTexture) = 0;
+};
+
+//================================================
+// UploadQueue Class
+//================================================
+/// テクスチャやバッファの転送をステージングのリングに詰め、コピーとしてまとめて記録する
+/// 1フレームに記録する量をbudgetで抑え、残りは次のフレームに回す
+/// 登録順に処理するので、記録済みと完了済みは番号の大小で判定できる。デバイスには触らない
+class UploadQueue {
+public:
+	//====================
+	// public
+	//====================
+
+	// 無効な番号
+	static constexpr UploadId kInvalidId = 0;
+
+	// テクスチャの配置の境界、D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+	static const uint64_t kTexturePlacementAlignment = 512;
+	// テクスチャの行の境界、D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
+	static const uint64_t kTexturePitchAlignment = 256;
+	// バッファの配置の境界
+	static const uint64_t kBufferAlignment = 16;
+
+	// 統計
+	struct Stats {
+
+		uint64_t pendingSize = 0;     // 記録待ちのサイズ
+		uint64_t frameSize = 0;       // 前フレームで記録したサイズ
+		uint64_t uploadedSize = 0;    // 記録したサイズの合計
+		uint32_t pendingCount = 0;    // 記録待ちの転送数
+		uint32_t copyCount = 0;       // 記録したコピーの数
+		uint32_t uploadCount = 0;     // 記録し終えた転送数
+		uint32_t budgetLimitedCount = 0; // budgetで次のフレームに回した回数
+		uint32_t stagingFullCount = 0;   // ステージングが空くのを待った回数
+	};
+
+	UploadQueue() = default;
+	~UploadQueue() = default;
+
+	// 初期化、stagingDataはcapacityバイトの書き込み先、frameBudgetは1フレームに記録する目安
+	void Initialize(uint8_t* stagingData, uint64_t capacity, uint64_t frameBudget);
+
+	// バッファの転送の登録、ownerは記録し終わるまでdataを生かしておくためのもの
+	UploadId EnqueueBuffer(void* destination, uint64_t destinationOffset,
+		const void* data, uint64_t size, std::shared_ptr<const void> owner);
+
+	// テクスチャの転送の登録、subresourcesはサブリソースの番号順
+	UploadId EnqueueTexture(void* destination,
+		const std::vector<UploadSubresource>& subresources, std::shared_ptr<const void> owner);
+
+	// 記録し終えていない転送の取り消し、コピー先を破棄する前に呼ぶ
+	void Cancel(UploadId id);
+
+	// budgetまでステージングに詰めてcontextに記録する
+	void Process(ICopyContext& context);
+
+	// budgetを無視して、ステージングに入るだけ記録する。全て記録できたらtrue
+	bool Flush(ICopyContext& context);
+
+	// フレームの終了、このフレームの記録分をfenceValueに紐づける
+	void FinishFrame(uint64_t fenceValue);
+
+	// completedFenceValueまで完了したフレームの回収
+	void ReleaseCompletedFrames(uint64_t completedFenceValue);
+
+	// 記録待ちも含めて全て破棄
+	void Reset();
+
+	// 配置の計算、行をkTexturePitchAlignmentに揃えたときのステージング上のサイズ
+	static uint64_t CalculateFootprintSize(const UploadSubresource& subresource, uint32_t& rowPitch);
+
+	// getter
+
+	// コピーを全て記録済み、以降に記録するコマンドから使える
+	bool IsSubmitted(UploadId id) const { return id != kInvalidId && id <= submittedId_; }
+	// GPUでのコピーが完了済み
+	bool IsComplete(UploadId id) const { return id != kInvalidId && id <= completedId_; }
+	bool IsIdle() const { return requests_.empty(); }
+	uint64_t GetFrameBudget() const { return frameBudget_; }
+	void SetFrameBudget(uint64_t frameBudget) { frameBudget_ = frameBudget; }
+	const Stats& GetStats() const { return stats_; }
+	const RingAllocator::Stats& GetStagingStats() const { return stagingAllocator_.GetStats(); }
+
+private:
+	//====================
+	// private
+	//====================
+
+	// 転送1つ分
+	struct Request {
+
+		UploadId id;
+		void* destination;
+		bool isTexture;
+
+		// バッファ
+		const uint8_t* data;
+		uint64_t destinationOffset;
+		uint64_t size;
+		// 記録済みのサイズ、大きいバッファは分けて記録する
+		uint64_t uploadedSize;
+
+		// テクスチャ、次に記録するサブリソース
+		std::vector<UploadSubresource> subresources;
+		uint32_t nextSubresource;
+
+		std::shared_ptr<const void> owner;
+	};
+
+	// 記録を終えたフレーム
+	struct FrameMarker {
+
+		uint64_t fenceValue;
+		UploadId lastId; // このフレームまでに記録し終えた番号
+	};
+
+	uint8_t* stagingData_ = nullptr;
+	RingAllocator stagingAllocator_;
+	uint64_t frameBudget_ = 0;
+	// このフレームで記録したサイズ
+	uint64_t frameSize_ = 0;
+
+	std::deque<Request> requests_;
+	std::deque<FrameMarker> frames_;
+
+	UploadId nextId_ = 1;
+	UploadId submittedId_ = kInvalidId;
+	UploadId completedId_ = kInvalidId;
+
+	Stats stats_;
+
+	// limitまで記録する、止まったらfalse
+	bool ProcessRequests(ICopyContext& context, uint64_t limit);
+	// バッファの一部を記録する、進めなかったらfalse
+	bool ProcessBuffer(ICopyContext& context, Request& request, uint64_t limit);
+	// サブリソースを1つ記録する、進めなかったらfalse
+	bool ProcessTexture(ICopyContext& context, Request& request, uint64_t limit);
+};
\ No newline at end of file
@@ -0,0 +1,243 @@
+#include "BufferManager.h"
+
+#include <cassert>
+#include <algorithm>
+
+#include "DirectXCommon.h"
+
+//============================================================
+// 使用率
+//============================================================
+float BufferManager::Stats::GetUtilization() const {
+
+	if (reservedSize == 0) {
+		return 0.0f;
+	}
+
+	return static_cast<float>(requestedSize) / static_cast<float>(reservedSize);
+}
+
+//============================================================
+// 断片化率
+//============================================================
+float BufferManager::Stats::GetFragmentation() const {
+
+	if (freeSize == 0) {
+		return 0.0f;
+	}
+
+	return 1.0f - static_cast<float>(largestFreeBlock) / static_cast<float>(freeSize);
+}
+
+//============================================================
+// シングルトンインスタンス
+//============================================================
+BufferManager* BufferManager::Instance() {
+	static BufferManager instance;
+	return &instance;
+}
+
+//============================================================
+// 初期化
+//============================================================
+void BufferManager::Initialize() {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	// 最初のブロックだけ作っておく、足りなくなったら増やす
+	AddBlock();
+}
+
+//============================================================
+// 終了処理
+//============================================================
+void BufferManager::Finalize() {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	for (auto& block : blocks_) {
+		block->resource->Unmap(0, nullptr);
+	}
+	blocks_.clear();
+
+	dedicatedCount_ = 0;
+	dedicatedSize_ = 0;
+	requestedSize_ = 0;
+}
+
+//============================================================
+// 確保
+//============================================================
+BufferAllocation BufferManager::Allocate(uint64_t sizeInBytes, uint64_t alignment) {
+
+	assert(sizeInBytes > 0);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	BufferAllocation allocation{};
+	allocation.size = sizeInBytes;
+	requestedSize_ += sizeInBytes;
+
+	// 大きいものはブロックに入れず専用のバッファにする
+	if (sizeInBytes > kDedicatedThreshold) {
+
+		allocation.dedicatedResource = CreateBufferResource(sizeInBytes, &allocation.cpuAddress);
+		allocation.resource = allocation.dedicatedResource.Get();
+		allocation.gpuAddress = allocation.resource->GetGPUVirtualAddress();
+
+		dedicatedCount_++;
+		dedicatedSize_ += sizeInBytes;
+
+		return allocation;
+	}
+
+	// 入るブロックを前から探し、どこにも入らなければブロックを増やす
+	uint64_t offset = TlsfAllocator::kInvalidOffset;
+	uint32_t blockIndex = 0;
+	for (; blockIndex < blocks_.size(); ++blockIndex) {
+
+		offset = blocks_[blockIndex]->allocator.Allocate(sizeInBytes, alignment);
+		if (offset != TlsfAllocator::kInvalidOffset) {
+			break;
+		}
+	}
+
+	if (offset == TlsfAllocator::kInvalidOffset) {
+
+		blockIndex = static_cast<uint32_t>(blocks_.size());
+		offset = AddBlock()->allocator.Allocate(sizeInBytes, alignment);
+	}
+
+	// kDedicatedThreshold以下なら空のブロックには必ず入る
+	assert(offset != TlsfAllocator::kInvalidOffset);
+
+	Block* block = blocks_[blockIndex].get();
+	allocation.resource = block->resource.Get();
+	allocation.offset = offset;
+	allocation.cpuAddress = block->cpuAddress + offset;
+	allocation.gpuAddress = block->gpuAddress + offset;
+	allocation.blockIndex = blockIndex;
+
+	return allocation;
+}
+
+//============================================================
+// 返却
+//============================================================
+void BufferManager::Free(BufferAllocation& allocation) {
+
+	if (!allocation.IsValid()) {
+		return;
+	}
+
+	DirectXCommon* directXCommon = DirectXCommon::Instance();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		requestedSize_ -= allocation.size;
+
+		if (allocation.dedicatedResource) {
+
+			dedicatedCount_--;
+			dedicatedSize_ -= allocation.size;
+		}
+	}
+
+	if (allocation.dedicatedResource) {
+
+		// 専用バッファはそのまま遅延解放
+		directXCommon->DeferRelease(std::move(allocation.dedicatedResource));
+	} else {
+
+		// 記録済みのコマンドがまだ参照しているかもしれないので、フレームの完了後に戻す
+		uint32_t blockIndex = allocation.blockIndex;
+		uint64_t offset = allocation.offset;
+		directXCommon->DeferRelease([this, blockIndex, offset]() {
+
+			std::lock_guard<std::mutex> lock(mutex_);
+			// 終了処理でブロックごと破棄済み
+			if (blockIndex < blocks_.size()) {
+				blocks_[blockIndex]->allocator.Free(offset);
+			}
+		});
+	}
+
+	allocation = BufferAllocation{};
+}
+
+//============================================================
+// 統計の取得
+//============================================================
+BufferManager::Stats BufferManager::GetStats() const {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	Stats stats{};
+	stats.blockCount = static_cast<uint32_t>(blocks_.size());
+	stats.dedicatedCount = dedicatedCount_;
+	stats.allocationCount = dedicatedCount_;
+	stats.reservedSize = blocks_.size() * kBlockSize + dedicatedSize_;
+	stats.usedSize = dedicatedSize_;
+	stats.requestedSize = requestedSize_;
+
+	for (const auto& block : blocks_) {
+
+		TlsfAllocator::Stats blockStats = block->allocator.GetStats();
+		stats.allocationCount += blockStats.allocationCount;
+		stats.freeBlockCount += blockStats.freeBlockCount;
+		stats.usedSize += blockStats.usedSize;
+		stats.freeSize += blockStats.capacity - blockStats.usedSize;
+		stats.largestFreeBlock = (std::max)(stats.largestFreeBlock, blockStats.largestFreeBlock);
+	}
+
+	return stats;
+}
+
+//============================================================
+// BufferResourceの作成
+//============================================================
+ComPtr<ID3D12Resource> BufferManager::CreateBufferResource(uint64_t sizeInBytes, uint8_t** cpuAddress) {
+
+	HRESULT hr;
+
+	// アップロードヒープに置く
+	D3D12_HEAP_PROPERTIES uploadHeapProperties{};
+	uploadHeapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
+	// バッファリソースの設定
+	D3D12_RESOURCE_DESC bufferResourceDesc{};
+	bufferResourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	bufferResourceDesc.Width = sizeInBytes;
+	// バッファの場合はこれらは1にする決まり
+	bufferResourceDesc.Height = 1;
+	bufferResourceDesc.DepthOrArraySize = 1;
+	bufferResourceDesc.MipLevels = 1;
+	bufferResourceDesc.SampleDesc.Count = 1;
+	// バッファの場合はこれにする決まり
+	bufferResourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+	ComPtr<ID3D12Resource> bufferResource = nullptr;
+	hr = DirectXCommon::Instance()->GetDevice()->CreateCommittedResource(
+		&uploadHeapProperties, D3D12_HEAP_FLAG_NONE, &bufferResourceDesc,
+		D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&bufferResource));
+	assert(SUCCEEDED(hr));
+
+	// 終了までマップしたままにする
+	hr = bufferResource->Map(0, nullptr, reinterpret_cast<void**>(cpuAddress));
+	assert(SUCCEEDED(hr));
+
+	return bufferResource;
+}
+
+//============================================================
+// ブロックの追加
+//============================================================
+BufferManager::Block* BufferManager::AddBlock() {
+
+	std::unique_ptr<Block> block = std::make_unique<Block>();
+	block->resource = CreateBufferResource(kBlockSize, &block->cpuAddress);
+	block->gpuAddress = block->resource->GetGPUVirtualAddress();
+	block->allocator.Initialize(kBlockSize, kGranularity);
+
+	blocks_.push_back(std::move(block));
+	return blocks_.back().get();
+}
\ No newline at end of file
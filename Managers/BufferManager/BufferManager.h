@@ -0,0 +1,124 @@
+#pragma once
+#include <d3d12.h>
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+#include "ComPtr.h"
+#include "TlsfAllocator.h"
+
+// バッファから切り出した領域、アップロードヒープなので終了までマップしたまま
+struct BufferAllocation {
+
+	// 切り出し元のバッファ
+	ID3D12Resource* resource = nullptr;
+	// resource内の位置とサイズ
+	uint64_t offset = 0;
+	uint64_t size = 0;
+
+	uint8_t* cpuAddress = nullptr;
+	D3D12_GPU_VIRTUAL_ADDRESS gpuAddress = 0;
+
+	// 切り出し元のブロック番号、大きいものは専用のバッファを持つ
+	uint32_t blockIndex = ~0u;
+	ComPtr<ID3D12Resource> dedicatedResource;
+
+	bool IsValid() const { return cpuAddress != nullptr; }
+
+	// 書き込み先
+	template <typename T>
+	T* GetData() const { return reinterpret_cast<T*>(cpuAddress); }
+};
+
+//================================================
+// BufferManager Class
+//================================================
+/// 頂点、インデックス、定数用のバッファを大きなブロックから切り出す
+/// ブロック内の空きはTlsfAllocatorで管理し、小さいバッファごとにリソースを作らずに済む
+class BufferManager {
+public:
+	//====================
+	// public
+	//====================
+
+	// ブロック1つのサイズ
+	static const uint64_t kBlockSize = 4 * 1024 * 1024;
+	// これより大きいものは専用のバッファにする
+	static const uint64_t kDedicatedThreshold = kBlockSize / 2;
+	// 切り出しの単位、CBufferの境界に合わせる
+	static const uint64_t kGranularity = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+
+	// 統計
+	struct Stats {
+
+		uint32_t blockCount = 0;          // ブロックの数
+		uint32_t dedicatedCount = 0;      // 専用バッファの数
+		uint32_t allocationCount = 0;     // 使用中の確保数(専用を含む)
+		uint32_t freeBlockCount = 0;      // ブロック内の空き区間の数
+		uint64_t reservedSize = 0;        // 確保しているGPUメモリ
+		uint64_t usedSize = 0;            // 切り出し済みのサイズ
+		uint64_t requestedSize = 0;       // 要求されたサイズの合計
+		uint64_t freeSize = 0;            // ブロック内の空きの合計
+		uint64_t largestFreeBlock = 0;    // ブロック内で連続して切り出せる最大サイズ
+
+		// 使用率、要求されたサイズ / 確保しているGPUメモリ
+		float GetUtilization() const;
+		// 断片化率、ブロック内の空きが1つにまとまっていれば0
+		float GetFragmentation() const;
+	};
+
+	void Initialize();
+	void Finalize();
+
+	// 確保、alignmentは2の累乗
+	BufferAllocation Allocate(uint64_t sizeInBytes, uint64_t alignment = kGranularity);
+
+	// 返却、GPUが使い終わってから空きに戻す
+	void Free(BufferAllocation& allocation);
+
+	static BufferManager* Instance();
+
+	// getter
+
+	Stats GetStats() const;
+
+private:
+	//====================
+	// private
+	//====================
+
+	// 大きなバッファ1つ分
+	struct Block {
+
+		ComPtr<ID3D12Resource> resource;
+		uint8_t* cpuAddress = nullptr;
+		D3D12_GPU_VIRTUAL_ADDRESS gpuAddress = 0;
+
+		TlsfAllocator allocator;
+	};
+
+	std::vector<std::unique_ptr<Block>> blocks_;
+
+	// 専用バッファ
+	uint32_t dedicatedCount_ = 0;
+	uint64_t dedicatedSize_ = 0;
+	uint64_t requestedSize_ = 0;
+
+	// アセットの読み込みスレッドからも呼ばれる
+	mutable std::mutex mutex_;
+
+	// マップしたアップロードバッファの生成
+	ComPtr<ID3D12Resource> CreateBufferResource(uint64_t sizeInBytes, uint8_t** cpuAddress);
+
+	// 新しいブロックを追加する
+	Block* AddBlock();
+
+	BufferManager() = default;
+	~BufferManager() = default;
+
+	// コピー禁止
+	BufferManager(const BufferManager&) = delete;
+	BufferManager& operator=(const BufferManager&) = delete;
+};
\ No newline at end of file
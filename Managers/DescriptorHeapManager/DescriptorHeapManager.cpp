@@ -0,0 +1,94 @@
+#include "DescriptorHeapManager.h"
+
+#include "DirectXCommon.h"
+
+//============================================================
+// シングルトンインスタンス
+//============================================================
+DescriptorHeapManager* DescriptorHeapManager::Instance() {
+	static DescriptorHeapManager instance;
+	return &instance;
+}
+
+//============================================================
+// 初期化
+//============================================================
+void DescriptorHeapManager::Initialize() {
+
+	DirectXCommon* directXCommon = DirectXCommon::Instance();
+	ID3D12Device* device = directXCommon->GetDevice();
+
+	// シェーダーから見えるSRVヒープを1つだけ作る
+	descriptorHeap_ = directXCommon->MakeDescriptorHeap(
+		device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, kMaxDescriptorNum, true);
+
+	cpuHandleStart_ = descriptorHeap_->GetCPUDescriptorHandleForHeapStart();
+	gpuHandleStart_ = descriptorHeap_->GetGPUDescriptorHandleForHeapStart();
+	descriptorSize_ = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+	allocator_.Initialize(kMaxDescriptorNum);
+
+	// 各コマンドリストの記録開始時にこのヒープを設定してもらう
+	directXCommon->SetDescriptorHeap(descriptorHeap_.Get());
+}
+
+//============================================================
+// 終了処理
+//============================================================
+void DescriptorHeapManager::Finalize() {
+
+	DirectXCommon::Instance()->SetDescriptorHeap(nullptr);
+	descriptorHeap_.Reset();
+}
+
+//============================================================
+// 確保
+//============================================================
+DescriptorHandle DescriptorHeapManager::Allocate(uint32_t count) {
+
+	uint32_t index = allocator_.Allocate(count);
+
+	// ヒープが足りない
+	assert(index != DescriptorAllocator::kInvalidIndex);
+
+	return GetHandle(index);
+}
+
+//============================================================
+// 返却
+//============================================================
+void DescriptorHeapManager::Free(const DescriptorHandle& handle, uint32_t count) {
+
+	if (handle.index == DescriptorAllocator::kInvalidIndex) {
+		return;
+	}
+
+	// 記録済みのコマンドがまだ参照しているかもしれないので、フレームの完了後に戻す
+	uint32_t index = handle.index;
+	DirectXCommon::Instance()->DeferRelease([this, index, count]() { allocator_.Free(index, count); });
+}
+
+//============================================================
+// すぐに返却
+//============================================================
+void DescriptorHeapManager::FreeImmediate(const DescriptorHandle& handle, uint32_t count) {
+
+	if (handle.index == DescriptorAllocator::kInvalidIndex) {
+		return;
+	}
+
+	allocator_.Free(handle.index, count);
+}
+
+//============================================================
+// 番号からハンドルを取得
+//============================================================
+DescriptorHandle DescriptorHeapManager::GetHandle(uint32_t index) const {
+
+	DescriptorHandle handle{};
+	handle.index = index;
+	handle.cpuHandle.ptr = cpuHandleStart_.ptr + static_cast<SIZE_T>(descriptorSize_) * index;
+	handle.gpuHandle.ptr = gpuHandleStart_.ptr + static_cast<UINT64>(descriptorSize_) * index;
+
+	return handle;
+}
\ No newline at end of file
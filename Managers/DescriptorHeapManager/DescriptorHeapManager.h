@@ -0,0 +1,74 @@
+#pragma once
+#include <d3d12.h>
+
+#include <cstdint>
+
+#include "ComPtr.h"
+#include "DescriptorAllocator.h"
+
+// ヒープから確保したディスクリプタ
+struct DescriptorHandle {
+
+	// ヒープ内の番号、シェーダーからはこの番号で参照する
+	uint32_t index = DescriptorAllocator::kInvalidIndex;
+	D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle{};
+	D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle{};
+};
+
+//================================================
+// DescriptorHeapManager Class
+//================================================
+/// SRV用のシェーダーから見えるヒープを1つだけ持ち、テクスチャとImGuiで共有する
+/// フレームの間にヒープを切り替えずに済む
+class DescriptorHeapManager {
+public:
+	//====================
+	// public
+	//====================
+
+	// ヒープに入るディスクリプタの数
+	static const uint32_t kMaxDescriptorNum = 4096;
+
+	void Initialize();
+	void Finalize();
+
+	// count個連続したディスクリプタの確保
+	DescriptorHandle Allocate(uint32_t count = 1);
+
+	// 返却、GPUが使い終わってから空きに戻す
+	void Free(const DescriptorHandle& handle, uint32_t count = 1);
+
+	// すぐに空きに戻す返却、WaitForGpuの後などGPUが使っていないと分かっているときだけ使う
+	void FreeImmediate(const DescriptorHandle& handle, uint32_t count = 1);
+
+	// 番号からハンドルを取得
+	DescriptorHandle GetHandle(uint32_t index) const;
+
+	static DescriptorHeapManager* Instance();
+
+	// getter
+
+	ID3D12DescriptorHeap* GetHeap() const { return descriptorHeap_.Get(); }
+	// ヒープの先頭、全体を1つのテーブルとして使うときに渡す
+	D3D12_GPU_DESCRIPTOR_HANDLE GetGPUHandleStart() const { return gpuHandleStart_; }
+	DescriptorAllocator::Stats GetStats() const { return allocator_.GetStats(); }
+
+private:
+	//====================
+	// private
+	//====================
+
+	ComPtr<ID3D12DescriptorHeap> descriptorHeap_;
+	D3D12_CPU_DESCRIPTOR_HANDLE cpuHandleStart_{};
+	D3D12_GPU_DESCRIPTOR_HANDLE gpuHandleStart_{};
+	uint32_t descriptorSize_ = 0;
+
+	DescriptorAllocator allocator_;
+
+	DescriptorHeapManager() = default;
+	~DescriptorHeapManager() = default;
+
+	// コピー禁止
+	DescriptorHeapManager(const DescriptorHeapManager&) = delete;
+	DescriptorHeapManager& operator=(const DescriptorHeapManager&) = delete;
+};
\ No newline at end of file
@@ -20,15 +20,10 @@ void ImGuiManager::Initialize() {
 	DirectXCommon* directXCommon = DirectXCommon::Instance();
 	WinApp* winApp = WinApp::Instance();
 
-	// デスクリプタヒープ設定
-	D3D12_DESCRIPTOR_HEAP_DESC srvDesc = {};
-	srvDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-	srvDesc.NumDescriptors = 128;
-	srvDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-	// デスクリプタヒープ生成
-	HRESULT hr = directXCommon->GetDevice()->CreateDescriptorHeap(
-		&srvDesc, IID_PPV_ARGS(&srvDescriptorHeap_));
-	assert(SUCCEEDED(hr));
+	DescriptorHeapManager* descriptorHeapManager = DescriptorHeapManager::Instance();
+
+	// フォントのSRVはテクスチャと同じヒープに置く
+	fontSrvHandle_ = descriptorHeapManager->Allocate();
 
 	IMGUI_CHECKVERSION();
 	ImGui::CreateContext();
@@ -36,11 +31,11 @@ void ImGuiManager::Initialize() {
 	ImGui_ImplWin32_Init(winApp->GetHwnd());
 	ImGui_ImplDX12_Init(
 		directXCommon->GetDevice(),
-		directXCommon->GetSwapChainDesc().BufferCount,
+		directXCommon->GetFrameCount(),
 		DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,
-		srvDescriptorHeap_.Get(),
-		srvDescriptorHeap_->GetCPUDescriptorHandleForHeapStart(),
-		srvDescriptorHeap_->GetGPUDescriptorHandleForHeapStart()
+		descriptorHeapManager->GetHeap(),
+		fontSrvHandle_.cpuHandle,
+		fontSrvHandle_.gpuHandle
 	);
 }
 
@@ -77,9 +72,12 @@ void ImGuiManager::Finalize() {
 	ImGui_ImplDX12_Shutdown();
 	ImGui_ImplWin32_Shutdown();
 	ImGui::DestroyContext();
-
-	srvDescriptorHeap_.Reset();
 #endif
+
+	// 最後のフレームの後は遅延解放が呼ばれないので、GPUの完了を待ってすぐに返す
+	DirectXCommon::Instance()->WaitForGpu();
+	DescriptorHeapManager::Instance()->FreeImmediate(fontSrvHandle_);
+	fontSrvHandle_ = {};
 }
 
 //============================================================
@@ -90,9 +88,8 @@ void ImGuiManager::Draw() {
 
 	DirectXCommon* directXCommon = DirectXCommon::Instance();
 
+	// ヒープはフレームの最初に設定済みなので切り替えない
 	ComPtr<ID3D12GraphicsCommandList> commandList = directXCommon->GetCommandList();
-	ID3D12DescriptorHeap* descriptorHeaps[] = { srvDescriptorHeap_.Get()};
-	commandList->SetDescriptorHeaps(1, descriptorHeaps);
 
 	ImGui_ImplDX12_RenderDrawData(ImGui::GetDrawData(), commandList.Get());
 #endif
@@ -3,6 +3,7 @@
 #include "WinApp.h"
 
 #include "ComPtr.h"
+#include "DescriptorHeapManager.h"
 
 #include <imgui.h>
 #include <imgui_impl_win32.h>
@@ -25,14 +26,13 @@ public:
 
 	static ImGuiManager* Instance();
 
-	// getter
-	ID3D12DescriptorHeap* GetSrvDescriotorHeap()const { return srvDescriptorHeap_.Get(); }
 private:
 	//====================
 	// private
 	//====================
 
-	ComPtr<ID3D12DescriptorHeap> srvDescriptorHeap_;
+	// フォントテクスチャのSRV、共有ヒープから確保する
+	DescriptorHandle fontSrvHandle_;
 
 	// コピーの禁止
 	ImGuiManager() = default;
@@ -9,45 +9,22 @@ ModelManager* ModelManager::Instance() {
 }
 
 //============================================================
-// モデルデータのゲッター
+// コンストラクタ
 //============================================================
-ModelData ModelManager::GetModelData(const std::string& identifier) {
+ModelManager::ModelManager() {
 
-	assert(models_.find(identifier) != models_.end());
-	return models_[identifier];
+	contentStore_.Initialize(kContentPrefix);
+	fileHasher_.Initialize(1);
 }
 
 //============================================================
-// BufferResourceの作成
-//============================================================
-ComPtr<ID3D12Resource> ModelManager::CreateBufferResource(ID3D12Device* device, size_t sizeInBytes) {
-
-	HRESULT hr;
-
-	// 頂点リソース用のヒープの設定
-	D3D12_HEAP_PROPERTIES uploadHeapProperties{};
-	uploadHeapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
-	// 頂点リソースの設定
-	D3D12_RESOURCE_DESC vertexResourceDesc{};
-	// バッファリソース。テクスチャの場合はまた別の設定をする
-	vertexResourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-	// リソースのサイズ、今回はVector4を3頂点分
-	vertexResourceDesc.Width = sizeInBytes;
-	// バッファの場合はこれらは1にする決まり
-	vertexResourceDesc.Height = 1;
-	vertexResourceDesc.DepthOrArraySize = 1;
-	vertexResourceDesc.MipLevels = 1;
-	vertexResourceDesc.SampleDesc.Count = 1;
-	// バッファの場合はこれにする決まり
-	vertexResourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-	// 実際に頂点リソースを作る
-	ComPtr<ID3D12Resource> bufferResource = nullptr;
-	hr = device->CreateCommittedResource(
-		&uploadHeapProperties, D3D12_HEAP_FLAG_NONE, &vertexResourceDesc,
-		D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&bufferResource));
-	assert(SUCCEEDED(hr));
-
-	return bufferResource;
+// モデルデータのゲッター
+//============================================================
+const ModelData& ModelManager::GetModelData(const std::string& identifier) const {
+
+	auto it = models_.find(GetContentKey(identifier));
+	assert(it != models_.end());
+	return it->second;
 }
 
 //============================================================
@@ -188,6 +165,55 @@ ModelData ModelManager::LoadObjFile(const std::string& directoryPath, const std:
 //============================================================
 void ModelManager::LoadModel(const std::string& identifier, const std::string& directoryPath, const std::string& filename) {
 
+	SHA256Digest digest{};
+	if (!fileHasher_.Hash(directoryPath + "/" + filename, digest)) {
+
+		AddModel(identifier, LoadObjFile(directoryPath, filename));
+		return;
+	}
+
+	// 同じ名前で別の内容を読み直すときは前の参照を外す
+	ContentId bound = contentStore_.Find(identifier);
+	if (bound == ContentStore::kInvalidId || contentStore_.GetDigest(bound) != digest) {
+		UnloadModel(identifier);
+	}
+
+	// 同じ内容が既にあれば参照を増やすだけ
+	bool isNew = false;
+	ContentId id = contentStore_.Acquire(identifier, digest, &isNew);
+	if (!isNew) {
+		return;
+	}
+
 	ModelData modelData = LoadObjFile(directoryPath, filename);
-	models_[identifier] = modelData;
+	contentStore_.SetSize(id, modelData.vertices.size() * sizeof(VertexData));
+	models_[contentStore_.GetKey(id)] = std::move(modelData);
+}
+
+//============================================================
+// 読み込み済みのモデルの登録
+//============================================================
+void ModelManager::AddModel(const std::string& identifier, ModelData modelData) {
+
+	// LoadModelで内容でまとめた名前なら参照を外す
+	UnloadModel(identifier);
+
+	models_[identifier] = std::move(modelData);
+}
+
+//============================================================
+// モデルの破棄
+//============================================================
+void ModelManager::UnloadModel(const std::string& identifier) {
+
+	if (contentStore_.Find(identifier) == ContentStore::kInvalidId) {
+
+		models_.erase(identifier);
+		return;
+	}
+
+	ContentId released = contentStore_.Release(identifier);
+	if (released != ContentStore::kInvalidId) {
+		models_.erase(contentStore_.GetKey(released));
+	}
 }
\ No newline at end of file
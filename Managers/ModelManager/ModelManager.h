@@ -13,19 +13,25 @@
 #include "Camera.h"
 #include "Function.h"
 #include "ComPtr.h"
+#include "ContentStore.h"
+#include "FileHasher.h"
 
 //================================================
 // ModelManager Class
 //================================================
+/// LoadModelで読んだモデルはファイルのハッシュでまとめ、同じ内容は名前が違っても1つのデータを共有する
 class ModelManager {
 public:
 	//====================
 	// public
 	//====================
 
-	ComPtr<ID3D12Resource> CreateBufferResource(ID3D12Device* device, size_t sizeInBytes);
-
+	// 同じ内容のモデルが既にあれば、解析せずにそれを参照する
 	void LoadModel(const std::string& identifier, const std::string& directoryPath, const std::string& filename);
+	// 読み込み済みのデータの登録、LoadObjFileはワーカースレッドから呼べるのでこちらだけメインスレッドで呼ぶ
+	void AddModel(const std::string& identifier, ModelData modelData);
+	// モデルの破棄、同じ内容の他の名前がなくなってからデータを消す
+	void UnloadModel(const std::string& identifier);
 
 	MaterialData LoadMaterialTemplateFile(const std::string& directorypath, const std::string& filename);
 	ModelData LoadObjFile(const std::string& directoryPath, const std::string& filename);
@@ -34,13 +40,26 @@ public:
 
 	// getter
 
-	ModelData GetModelData(const std::string& identifier);
+	// 読み込み済みのデータ、コピーせずに参照を返す。UnloadModelやLoadModelで無効になる
+	const ModelData& GetModelData(const std::string& identifier) const;
+	// データの実体の名前、同じ内容のモデルは同じ名前になる。頂点バッファもこの名前で共有する
+	const std::string& GetContentKey(const std::string& identifier) const { return contentStore_.Resolve(identifier); }
+	// 内容でまとめた統計、savedSizeは共有しなければ増えていた頂点の大きさ
+	ContentStore::Stats GetContentStats() const { return contentStore_.GetStats(); }
 
 private:
 
+	// 内容でまとめたモデルのキー
+	static inline const char* kContentPrefix = "__content";
+
+	// GetContentKeyの名前から、データ
 	std::unordered_map<std::string, ModelData> models_;
 
-	ModelManager() = default;
+	// LoadModelで読んだモデルの名前から、内容ごとのキー
+	ContentStore contentStore_;
+	FileHasher fileHasher_;
+
+	ModelManager();
 	~ModelManager() = default;
 
 	// コピー禁止
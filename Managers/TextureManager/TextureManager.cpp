@@ -1,6 +1,12 @@
 #include "TextureManager.h"
 
+#include <algorithm>
+#include <map>
+#include <cstring>
+
 #include "DirectXCommon.h"
+#include "TextureCooker.h"
+#include "MipGenerator.h"
 #include "Logger.h"
 
 //============================================================
@@ -36,14 +42,29 @@ D3D12_GPU_DESCRIPTOR_HANDLE TextureManager::GetGPUDescriptorHandle(ID3D12Descrip
 //============================================================
 // Textureデータの読み込み
 //============================================================
-DirectX::ScratchImage TextureManager::LoadTexture(const std::string& filePath) {
+DirectX::ScratchImage TextureManager::LoadTexture(const std::string& filePath, const std::optional<SHA256Digest>& sourceDigest) {
 
-	// テクスチャファイルを呼んでプログラムを扱えるようにする
+	// 焼いたものがあれば、デコードもミップマップの作成もせずにそのまま使う
+	// 元画像が焼いた後に変わっていたら、焼き直すまでは元画像をデコードする
 	DirectX::ScratchImage image{};
+	std::string cookedPath = TextureCooker::GetCookedPath(filePath, kCookedDirectory);
+	bool isCookedLoaded = sourceDigest ?
+		TextureCooker::LoadCooked(cookedPath, *sourceDigest, image) : TextureCooker::LoadCooked(cookedPath, image);
+	if (isCookedLoaded) {
+		return image;
+	}
+
+	// テクスチャファイルを呼んでプログラムを扱えるようにする
 	std::wstring filePathW = ConvertString(filePath);
 	HRESULT hr = DirectX::LoadFromWICFile(filePathW.c_str(), DirectX::WIC_FLAGS_FORCE_SRGB, nullptr, image);
 	assert(SUCCEEDED(hr));
 
+	// RGBA8、BGRA8はMipGeneratorで作る、DirectXTexより速く2の累乗の大きさなら結果は1以内の差
+	const DirectX::TexMetadata& metadata = image.GetMetadata();
+	if (IsMipGeneratorFormat(metadata)) {
+		return GenerateMipMaps(image);
+	}
+
 	// ミップマップの作成 → 元画像よりも小さなテクスチャ群
 	DirectX::ScratchImage mipImages{};
 	hr = DirectX::GenerateMipMaps(
@@ -55,6 +76,63 @@ DirectX::ScratchImage TextureManager::LoadTexture(const std::string& filePath) {
 	return mipImages;
 }
 
+//============================================================
+// MipGeneratorで作れるか
+//============================================================
+bool TextureManager::IsMipGeneratorFormat(const DirectX::TexMetadata& metadata) {
+
+	if (metadata.dimension != DirectX::TEX_DIMENSION_TEXTURE2D || metadata.arraySize != 1 || metadata.mipLevels != 1) {
+		return false;
+	}
+
+	// チャンネルの順番は平均に関係しない、アルファが4バイト目ならよい
+	switch (metadata.format) {
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+		return true;
+	default:
+		return false;
+	}
+}
+
+//============================================================
+// MipGeneratorでのミップマップの作成
+//============================================================
+DirectX::ScratchImage TextureManager::GenerateMipMaps(const DirectX::ScratchImage& image) {
+
+	const DirectX::TexMetadata& metadata = image.GetMetadata();
+	uint32_t width = static_cast<uint32_t>(metadata.width);
+	uint32_t height = static_cast<uint32_t>(metadata.height);
+	uint32_t levelCount = MipGenerator::CalculateMipLevels(width, height);
+
+	DirectX::ScratchImage mipImages{};
+	HRESULT hr = mipImages.Initialize2D(metadata.format, metadata.width, metadata.height, 1, levelCount);
+	assert(SUCCEEDED(hr));
+
+	// ミップ0はそのままコピー
+	const DirectX::Image* source = image.GetImage(0, 0, 0);
+	const DirectX::Image* top = mipImages.GetImage(0, 0, 0);
+	for (size_t y = 0; y < metadata.height; ++y) {
+		std::memcpy(top->pixels + y * top->rowPitch, source->pixels + y * source->rowPitch, (std::min)(top->rowPitch, source->rowPitch));
+	}
+
+	std::vector<MipSurface> levels(levelCount);
+	for (uint32_t level = 0; level < levelCount; ++level) {
+
+		const DirectX::Image* mip = mipImages.GetImage(level, 0, 0);
+		levels[level] = { mip->pixels, static_cast<uint32_t>(mip->width), static_cast<uint32_t>(mip->height), mip->rowPitch };
+	}
+
+	// 読み込みはジョブで並んで走るので、スレッドは大きいミップにだけ立つ
+	MipGenerator::Settings settings{};
+	settings.isSRGB = DirectX::IsSRGB(metadata.format);
+	MipGenerator::Generate(levels.data(), levelCount, settings);
+
+	return mipImages;
+}
+
 //============================================================
 // TextureResourceを作成する関数
 //============================================================
@@ -70,11 +148,9 @@ ComPtr<ID3D12Resource> TextureManager::CreateTextureResource(ID3D12Device* devic
 	resourceDesc.SampleDesc.Count = 1;                                     // サンプリングカウント。1固定
 	resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION(metadata.dimension); // Textureの次元数、普段は2次元
 
-	// 利用するHeapの設定、非常に特殊な運用。
+	// 利用するHeapの設定、データはステージングからコピーするのでGPUだけが触る
 	D3D12_HEAP_PROPERTIES heapProperties{};
-	heapProperties.Type = D3D12_HEAP_TYPE_CUSTOM;                        // 細かい設定を行う
-	heapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_WRITE_BACK; // WriteBackポリシーでCPUアクセス可能
-	heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_L0;          // プロセッサの近くに配置
+	heapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
 
 	// Resourceの作成
 	ComPtr<ID3D12Resource> resource = nullptr;
@@ -83,7 +159,7 @@ ComPtr<ID3D12Resource> TextureManager::CreateTextureResource(ID3D12Device* devic
 			&heapProperties,                   // Heapの設定
 			D3D12_HEAP_FLAG_NONE,              // Heapの特殊な設定
 			&resourceDesc,                     // Resourceの設定
-			D3D12_RESOURCE_STATE_GENERIC_READ, // 初回のResourceState、Textureは基本読むだけ
+			D3D12_RESOURCE_STATE_COPY_DEST,    // 初回のResourceState、コピー後に読み取り用へ遷移する
 			nullptr,                           // Clear最適地、使わない。
 			IID_PPV_ARGS(&resource)            // 作成するResourceポインタへのポインタ
 		);
@@ -95,25 +171,10 @@ ComPtr<ID3D12Resource> TextureManager::CreateTextureResource(ID3D12Device* devic
 //============================================================
 // TextureResourceにデータを転送する関数
 //============================================================
-void TextureManager::UploadTextureData(ID3D12Resource* texture, const DirectX::ScratchImage& mipImages) {
-
-	// Meta情報を取得
-	const DirectX::TexMetadata& metadata = mipImages.GetMetadata();
-	// 全MipMapについて
-	for (size_t mipLevel = 0; mipLevel < metadata.mipLevels; ++mipLevel) {
-
-		// MipMapLevelを指定して各Imageを取得
-		const DirectX::Image* img = mipImages.GetImage(mipLevel, 0, 0);
-		// Textureに転送
-		HRESULT hr = texture->WriteToSubresource(
-			UINT(mipLevel),
-			nullptr,              // 全領域へのコピー
-			img->pixels,          // 元データアドレス
-			UINT(img->rowPitch),  // 1ラインサイズ
-			UINT(img->slicePitch) // 1枚サイズ
-		);
-		assert(SUCCEEDED(hr));
-	}
+UploadId TextureManager::UploadTextureData(ID3D12Resource* texture, std::shared_ptr<const DirectX::ScratchImage> mipImages, uint32_t firstMip) {
+
+	// 全MipMapをステージングに詰めてコピーする、budgetを超えた分は次のフレームに回る
+	return uploadManager_->UploadTexture(texture, std::move(mipImages), firstMip);
 }
 
 //============================================================
@@ -121,18 +182,204 @@ void TextureManager::UploadTextureData(ID3D12Resource* texture, const DirectX::S
 //============================================================
 void TextureManager::LoadTexture(const std::string& identifier, const std::string& filePath) {
 
+	// 元ファイルがなく焼いたものだけのときは、内容でまとめずに読む
+	SHA256Digest digest{};
+	if (!HashTextureFile(filePath, digest)) {
+
+		CreateTexture(identifier, std::make_shared<DirectX::ScratchImage>(LoadTexture(filePath, std::nullopt)));
+		return;
+	}
+
+	// テクスチャを読み込む、同じ内容が既にあれば読まずに参照する
+	// 転送が記録されるまで元データを保持するので共有する
+	std::shared_ptr<DirectX::ScratchImage> mipImages;
+	if (ClaimContent(digest)) {
+		mipImages = std::make_shared<DirectX::ScratchImage>(LoadTexture(filePath, digest));
+	}
+	CreateTexture(identifier, digest, std::move(mipImages));
+}
+
+//============================================================
+// デコードする内容の要求
+//============================================================
+bool TextureManager::ClaimContent(const SHA256Digest& digest) {
+
+	std::lock_guard<std::mutex> lock(claimMutex_);
+	return claimedDigests_.insert(digest).second;
+}
+
+//============================================================
+//  読み込み済みのデータからテクスチャを作成する関数
+//============================================================
+void TextureManager::CreateTexture(const std::string& identifier, std::shared_ptr<const DirectX::ScratchImage> mipImages) {
+
+	// 同じ名前で読み直すときは前のものを破棄する
+	UnloadTexture(identifier);
+
+	CreateTextureData(identifier, std::move(mipImages));
+}
+
+void TextureManager::CreateTexture(const std::string& identifier, const SHA256Digest& digest, std::shared_ptr<const DirectX::ScratchImage> mipImages) {
+
+	// 同じ名前で別の内容を読み直すときは前の参照を外す
+	ContentId bound = contentStore_.Find(identifier);
+	if (bound != ContentStore::kInvalidId && contentStore_.GetDigest(bound) != digest) {
+		UnloadTexture(identifier);
+	}
+	// 内容でまとめていない同じ名前のもの
+	if (bound == ContentStore::kInvalidId && (textures_.contains(identifier) || atlasEntries_.contains(identifier))) {
+		UnloadTexture(identifier);
+	}
+
+	ContentId id = contentStore_.Acquire(identifier, digest);
+	const std::string& key = contentStore_.GetKey(id);
+
+	// 同じ内容が既にあるか、デコードを他に任せたものは参照を増やすだけ
+	// ワーカースレッドでデコードした順に作るので、先に参照だけ登録されてから実体が来ることもある
+	if (!mipImages || textures_.contains(key) || atlasEntries_.contains(key)) {
+		return;
+	}
+
+	uint64_t size = 0;
+	for (size_t i = 0; i < mipImages->GetImageCount(); ++i) {
+		size += mipImages->GetImages()[i].slicePitch;
+	}
+	contentStore_.SetSize(id, size);
+
+	// ClaimContentを通さずにデコードしたものも、この後の読み込みではデコードを省く
+	{
+		std::lock_guard<std::mutex> lock(claimMutex_);
+		claimedDigests_.insert(digest);
+	}
+
+	CreateTextureData(key, std::move(mipImages));
+}
+
+//============================================================
+// リソースとSRVの作成
+//============================================================
+void TextureManager::CreateTextureData(const std::string& key, std::shared_ptr<const DirectX::ScratchImage> mipImages) {
+
+	TextureData texture{};
+	texture.metadata = mipImages->GetMetadata();
+	texture.image = std::move(mipImages);
+
+	// 各ミップの大きさ、予算はこの合計で数える
+	std::vector<uint64_t> mipSizes(texture.metadata.mipLevels);
+	for (size_t mip = 0; mip < texture.metadata.mipLevels; ++mip) {
+		mipSizes[mip] = texture.image->GetImage(mip, 0, 0)->slicePitch;
+	}
+
+	// ブロック圧縮は大きさが4の倍数のミップしか一番上にできない
+	uint32_t maxTopMip = static_cast<uint32_t>(texture.metadata.mipLevels - 1);
+	if (DirectX::IsCompressed(texture.metadata.format)) {
+
+		maxTopMip = 0;
+		for (uint32_t mip = 1; mip < texture.metadata.mipLevels; ++mip) {
+
+			size_t width = texture.metadata.width >> mip;
+			size_t height = texture.metadata.height >> mip;
+			if (width == 0 || height == 0 || width % 4 != 0 || height % 4 != 0) {
+				break;
+			}
+			maxTopMip = mip;
+		}
+	}
+
+	// 最初は小さいミップだけを置く
+	texture.streamId = streamer_.Register(
+		static_cast<uint32_t>(texture.metadata.width), static_cast<uint32_t>(texture.metadata.height), mipSizes, maxTopMip);
+	texture.resident = CreateResidency(texture.image, streamer_.GetResidentMip(texture.streamId));
+
+	if (streamIdentifiers_.size() <= texture.streamId) {
+		streamIdentifiers_.resize(texture.streamId + 1);
+	}
+	streamIdentifiers_[texture.streamId] = key;
+
+	// テクスチャデータをマップに格納
+	textures_[key] = std::move(texture);
+}
+
+//============================================================
+// テクスチャの破棄
+//============================================================
+void TextureManager::UnloadTexture(const std::string& identifier) {
+
+	// 内容でまとめたものは、同じ内容の名前が全て外れてから破棄する
+	ContentId bound = contentStore_.Find(identifier);
+	if (bound != ContentStore::kInvalidId) {
+
+		ContentId released = contentStore_.Release(identifier);
+		if (released == ContentStore::kInvalidId) {
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(claimMutex_);
+			claimedDigests_.erase(contentStore_.GetDigest(released));
+		}
+		DestroyTexture(contentStore_.GetKey(released));
+		return;
+	}
+
+	DestroyTexture(identifier);
+}
+
+//============================================================
+// リソースとSRVの破棄
+//============================================================
+void TextureManager::DestroyTexture(const std::string& key) {
+
+	// アトラスにまとめたものは参照を外すだけ、最後の1つが外れたらページも破棄する
+	auto atlas = atlasEntries_.find(key);
+	if (atlas != atlasEntries_.end()) {
+
+		std::string page = std::move(atlas->second.atlasIdentifier);
+		atlasEntries_.erase(atlas);
+
+		auto pageReference = atlasPageReferences_.find(page);
+		assert(pageReference != atlasPageReferences_.end());
+		if (--pageReference->second == 0) {
+			atlasPageReferences_.erase(pageReference);
+			DestroyTexture(page);
+		}
+		return;
+	}
+
+	auto it = textures_.find(key);
+	if (it == textures_.end()) {
+		return;
+	}
+
+	ReleaseResidency(it->second.resident);
+	ReleaseResidency(it->second.pending);
+
+	streamer_.Unregister(it->second.streamId);
+	streamIdentifiers_[it->second.streamId].clear();
+
+	textures_.erase(it);
+}
+
+//============================================================
+// ミップを置いたリソースの作成
+//============================================================
+TextureManager::TextureResidency TextureManager::CreateResidency(const std::shared_ptr<const DirectX::ScratchImage>& image, uint32_t mip) {
+
 	DirectXCommon* dxCommon = DirectXCommon::Instance();
 
-	// テクスチャを読み込む
-	DirectX::ScratchImage mipImages = LoadTexture(filePath);
-	DirectX::TexMetadata metadata = mipImages.GetMetadata();
-	ComPtr<ID3D12Resource> textureResource = CreateTextureResource(dxCommon->GetDevice(), metadata);
-	UploadTextureData(textureResource.Get(), mipImages);
+	// mipをミップ0とするテクスチャ
+	DirectX::TexMetadata metadata = image->GetMetadata();
+	metadata.width = (std::max)(metadata.width >> mip, size_t(1));
+	metadata.height = (std::max)(metadata.height >> mip, size_t(1));
+	metadata.mipLevels -= mip;
 
-	// ハンドルを生成
-	UINT descriptorSize = dxCommon->GetDevice()->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-	D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle = GetCPUDescriptorHandle(descriptorHeap_.Get(), descriptorSize, static_cast<uint32_t>(textures_.size()));
-	D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle = GetGPUDescriptorHandle(descriptorHeap_.Get(), descriptorSize, static_cast<uint32_t>(textures_.size()));
+	TextureResidency residency{};
+	residency.mip = mip;
+	residency.resource = CreateTextureResource(dxCommon->GetDevice(), metadata);
+	residency.uploadId = UploadTextureData(residency.resource.Get(), image, mip);
+
+	// 共有ヒープからSRVの場所を確保
+	residency.srvHandle = descriptorHeapManager_->Allocate();
 
 	// SRVを作成
 	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
@@ -140,10 +387,91 @@ void TextureManager::LoadTexture(const std::string& identifier, const std::strin
 	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
 	srvDesc.Texture2D.MipLevels = UINT(metadata.mipLevels);
-	dxCommon->GetDevice()->CreateShaderResourceView(textureResource.Get(), &srvDesc, cpuHandle);
+	dxCommon->GetDevice()->CreateShaderResourceView(residency.resource.Get(), &srvDesc, residency.srvHandle.cpuHandle);
 
-	// テクスチャデータをマップに格納
-	textures_[identifier] = { textureResource, cpuHandle, gpuHandle, metadata };
+	return residency;
+}
+
+//============================================================
+// ミップを置いたリソースの破棄
+//============================================================
+void TextureManager::ReleaseResidency(TextureResidency& residency) {
+
+	if (!residency.resource) {
+		return;
+	}
+
+	// まだ記録していないコピーは捨てる
+	uploadManager_->Cancel(residency.uploadId);
+
+	// 記録済みの描画がまだ参照しているかもしれない
+	DirectXCommon::Instance()->DeferRelease(residency.resource);
+	descriptorHeapManager_->Free(residency.srvHandle);
+
+	residency = {};
+}
+
+//============================================================
+// 常駐ミップの反映
+//============================================================
+void TextureManager::SetResidentMip(StreamTextureId id, uint32_t mip) {
+
+	TextureData& texture = textures_.at(streamIdentifiers_[id]);
+
+	// 同じミップを転送中ならそのまま待つ
+	if (texture.pending.resource && texture.pending.mip == mip) {
+		return;
+	}
+
+	// 違うミップを転送中なら捨てる、今のものに戻すだけなら作り直さない
+	ReleaseResidency(texture.pending);
+	if (texture.resident.mip == mip) {
+		return;
+	}
+
+	// 入れ替えるまでは今のものを描画に使う
+	texture.pending = CreateResidency(texture.image, mip);
+}
+
+//============================================================
+// ストリーミングの更新
+//============================================================
+void TextureManager::UpdateStreaming() {
+
+	// 転送を記録し終えたものから入れ替える
+	for (auto& [identifier, texture] : textures_) {
+
+		if (texture.pending.resource && uploadManager_->IsSubmitted(texture.pending.uploadId)) {
+
+			ReleaseResidency(texture.resident);
+			texture.resident = std::move(texture.pending);
+			texture.pending = {};
+		}
+	}
+
+	// 前フレームの描画からの要求を反映する、SetResidentMipが呼ばれる
+	streamer_.Update();
+}
+
+//============================================================
+// ミップの要求
+//============================================================
+void TextureManager::RequestDetail(const std::string& identifier, float screenSize) {
+
+	const std::string& key = contentStore_.Resolve(identifier);
+
+	// アトラスはページ全体の大きさに直して要求する
+	auto atlas = atlasEntries_.find(key);
+	if (atlas != atlasEntries_.end()) {
+
+		RequestDetail(atlas->second.atlasIdentifier, screenSize * atlas->second.detailScale);
+		return;
+	}
+
+	auto it = textures_.find(key);
+	assert(it != textures_.end());
+
+	streamer_.Request(it->second.streamId, screenSize);
 }
 
 //============================================================
@@ -151,14 +479,17 @@ void TextureManager::LoadTexture(const std::string& identifier, const std::strin
 //============================================================
 void TextureManager::Initialize() {
 
-	DirectXCommon* directXCommon = DirectXCommon::Instance();
+	// SRVは共有ヒープから確保する
+	descriptorHeapManager_ = DescriptorHeapManager::Instance();
+	// データはステージングから転送する
+	uploadManager_ = UploadManager::Instance();
 
-	// Descriptor Heapを作成
-	D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
-	heapDesc.NumDescriptors = 4;
-	heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-	heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-	directXCommon->GetDevice()->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&descriptorHeap_));
+	// 予算を超えたら使われていないテクスチャのミップから追い出す
+	streamer_.Initialize(this, kDefaultStreamingBudget, kMaxStreamRequestsPerFrame);
+
+	// 内容でまとめる、テクスチャのファイルは小さいので1つを分けずに、読み込みのジョブごとに求める
+	contentStore_.Initialize(kContentPrefix);
+	fileHasher_.Initialize(1);
 }
 
 //============================================================
@@ -167,8 +498,224 @@ void TextureManager::Initialize() {
 void TextureManager::SetGraphicsRootDescriptorTable(
 	ID3D12GraphicsCommandList* commandList, UINT rootParamaterIndex, std::string identifier) {
 
-	ID3D12DescriptorHeap* descriptorHeaps[] = { descriptorHeap_.Get() };
-	commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+	// ヒープはフレームの最初に設定済み
+	commandList->SetGraphicsRootDescriptorTable(rootParamaterIndex, GetGPUHandle(identifier));
+}
+
+//============================================================
+// SRVのGPUハンドルの取得
+//============================================================
+D3D12_GPU_DESCRIPTOR_HANDLE TextureManager::GetGPUHandle(const std::string& identifier) const {
+
+	return GetDrawableTexture(identifier).resident.srvHandle.gpuHandle;
+}
+
+//============================================================
+// SRVの番号の取得
+//============================================================
+uint32_t TextureManager::GetSrvIndex(const std::string& identifier) const {
+
+	return GetDrawableTexture(identifier).resident.srvHandle.index;
+}
+
+//============================================================
+// 転送を記録し終えたか
+//============================================================
+bool TextureManager::IsTextureReady(const std::string& identifier) const {
+
+	auto it = textures_.find(GetBindingIdentifier(identifier));
+	return it != textures_.end() && uploadManager_->IsSubmitted(it->second.resident.uploadId);
+}
+
+//============================================================
+// 描画に使うテクスチャの取得
+//============================================================
+const TextureManager::TextureData& TextureManager::GetDrawableTexture(const std::string& identifier) const {
+
+	auto it = textures_.find(GetBindingIdentifier(identifier));
+	// 読み込んでいないテクスチャ
+	assert(it != textures_.end());
+
+	// コピーが記録されていないテクスチャは読めないので、代わりのものを使う
+	if (!uploadManager_->IsSubmitted(it->second.resident.uploadId)) {
+
+		// 代わりのものはアトラスにまとめないので、UVの変換なしでどこを読んでも同じ色になる
+		auto fallback = textures_.find(contentStore_.Resolve(fallbackIdentifier_));
+		if (fallback != textures_.end() && uploadManager_->IsSubmitted(fallback->second.resident.uploadId)) {
+			return fallback->second;
+		}
+	}
+
+	return it->second;
+}
+
+//============================================================
+// 小さいテクスチャのアトラスへのまとめ
+//============================================================
+void TextureManager::BuildAtlas() {
+
+	// 指定された名前の数を内容ごとに数える、内容を共有する名前が全て指定していればまとめてよい
+	std::unordered_map<std::string, uint32_t> allowedCounts;
+	std::unordered_map<std::string, uint32_t> referenceCounts;
+	for (const std::string& identifier : atlasAllowed_) {
+
+		ContentId id = contentStore_.Find(identifier);
+		const std::string& key = contentStore_.Resolve(identifier);
+		allowedCounts[key]++;
+		referenceCounts[key] = id != ContentStore::kInvalidId ? contentStore_.GetReferenceCount(id) : 1;
+	}
+
+	// ページは1つのフォーマットしか持てないので、フォーマットごとにまとめる
+	std::map<DXGI_FORMAT, std::vector<std::string>> candidates;
+	const std::string& fallbackKey = contentStore_.Resolve(fallbackIdentifier_);
+	for (const auto& [identifier, texture] : textures_) {
+
+		const DirectX::TexMetadata& metadata = texture.metadata;
+
+		// 指定されていないもの、ページ、転送中の代わりのものはまとめない
+		auto allowed = allowedCounts.find(identifier);
+		if (allowed == allowedCounts.end() || allowed->second != referenceCounts[identifier]) {
+			continue;
+		}
+		if (identifier.starts_with(kAtlasPrefix) || identifier == fallbackKey) {
+			continue;
+		}
+		if (metadata.dimension != DirectX::TEX_DIMENSION_TEXTURE2D || metadata.arraySize != 1 ||
+			(std::max)(metadata.width, metadata.height) > kAtlasMaxTextureSize) {
+			continue;
+		}
+		// ピクセル単位でコピーできないものはまとめない
+		if (DirectX::IsCompressed(metadata.format) || DirectX::IsPlanar(metadata.format) ||
+			DirectX::IsPalettized(metadata.format) || DirectX::BitsPerPixel(metadata.format) % 8 != 0) {
+			continue;
+		}
+
+		candidates[metadata.format].push_back(identifier);
+	}
+
+	atlasStats_ = {};
+	for (auto& [format, identifiers] : candidates) {
+
+		// 1つだけならまとめてもSRVは減らない
+		if (identifiers.size() < 2) {
+			continue;
+		}
+
+		// 毎回同じ並びで詰める
+		std::sort(identifiers.begin(), identifiers.end());
+		BuildAtlas(identifiers);
+	}
+
+	atlasStats_.efficiency = atlasStats_.pageArea != 0 ?
+		static_cast<float>(double(atlasStats_.usedArea) / double(atlasStats_.pageArea)) : 0.0f;
+
+	Log(std::format("TextureAtlas packed {} / {} textures into {} pages, efficiency {:.1f}%, {} bindings saved\n",
+		atlasStats_.packedCount, atlasStats_.textureCount, atlasStats_.pageCount,
+		atlasStats_.efficiency * 100.0f, atlasStats_.bindingsSaved));
+}
+
+//============================================================
+// 同じフォーマットのテクスチャのアトラスへのまとめ
+//============================================================
+void TextureManager::BuildAtlas(const std::vector<std::string>& identifiers) {
+
+	// 余白と位置をミップの段数分揃えて、小さいミップでも隣が混ざらないようにする
+	TextureAtlas atlas;
+	atlas.Initialize(kAtlasMaxPageSize, kAtlasPadding, kAtlasPadding);
+	for (const std::string& identifier : identifiers) {
+
+		const DirectX::TexMetadata& metadata = textures_.at(identifier).metadata;
+		atlas.Add(static_cast<uint32_t>(metadata.width), static_cast<uint32_t>(metadata.height));
+	}
+	atlas.Build();
+
+	const DXGI_FORMAT format = textures_.at(identifiers.front()).metadata.format;
+	const size_t pixelSize = DirectX::BitsPerPixel(format) / 8;
+
+	// ページのミップ0を作る、余白以外の空きは0
+	std::vector<DirectX::ScratchImage> pages(atlas.GetPageCount());
+	for (uint32_t page = 0; page < atlas.GetPageCount(); ++page) {
+
+		HRESULT hr = pages[page].Initialize2D(format, atlas.GetPageSize(page), atlas.GetPageSize(page), 1, 1);
+		assert(SUCCEEDED(hr));
+		std::memset(pages[page].GetPixels(), 0, pages[page].GetPixelsSize());
+	}
+	for (uint32_t i = 0; i < atlas.GetRegionCount(); ++i) {
+
+		const AtlasRegion& region = atlas.GetRegion(i);
+		if (region.page == TextureAtlas::kInvalidPage) {
+			continue;
+		}
+
+		const DirectX::Image* source = textures_.at(identifiers[i]).image->GetImage(0, 0, 0);
+		const DirectX::Image* destination = pages[region.page].GetImage(0, 0, 0);
+		TextureAtlas::CopyRegion(source->pixels, source->rowPitch,
+			destination->pixels, destination->rowPitch, region, kAtlasPadding, pixelSize);
+	}
+
+	// ミップを作って普通のテクスチャとして登録する、ストリーミングもされる
+	std::vector<std::string> pageIdentifiers(atlas.GetPageCount());
+	for (uint32_t page = 0; page < atlas.GetPageCount(); ++page) {
+
+		DirectX::ScratchImage mipImages{};
+		HRESULT hr = DirectX::GenerateMipMaps(*pages[page].GetImage(0, 0, 0),
+			DirectX::IsSRGB(format) ? DirectX::TEX_FILTER_SRGB : DirectX::TEX_FILTER_DEFAULT, kAtlasMipLevels, mipImages);
+		assert(SUCCEEDED(hr));
+
+		pageIdentifiers[page] = std::string(kAtlasPrefix) + std::to_string(atlasPageCount_++);
+		CreateTexture(pageIdentifiers[page], std::make_shared<DirectX::ScratchImage>(std::move(mipImages)));
+	}
+
+	// まとめたテクスチャはページを指すようにして、元のリソースとSRVを解放する
+	for (uint32_t i = 0; i < atlas.GetRegionCount(); ++i) {
+
+		const AtlasRegion& region = atlas.GetRegion(i);
+		if (region.page == TextureAtlas::kInvalidPage) {
+			continue;
+		}
+
+		AtlasEntry entry{};
+		entry.atlasIdentifier = pageIdentifiers[region.page];
+		// uvは行ベクトルなので、拡大の後に3行目の平行移動
+		entry.uvTransform = MakeIdentity4x4();
+		entry.uvTransform.m[0][0] = region.uvScaleU;
+		entry.uvTransform.m[1][1] = region.uvScaleV;
+		entry.uvTransform.m[3][0] = region.uvOffsetU;
+		entry.uvTransform.m[3][1] = region.uvOffsetV;
+		entry.detailScale = static_cast<float>(atlas.GetPageSize(region.page)) / static_cast<float>((std::max)(region.width, region.height));
+
+		DestroyTexture(identifiers[i]);
+		atlasPageReferences_[entry.atlasIdentifier]++;
+		atlasEntries_[identifiers[i]] = std::move(entry);
+	}
+
+	// フォーマットごとの結果を足す
+	const TextureAtlas::Stats& stats = atlas.GetStats();
+	atlasStats_.textureCount += stats.textureCount;
+	atlasStats_.packedCount += stats.packedCount;
+	atlasStats_.rejectedCount += stats.rejectedCount;
+	atlasStats_.pageCount += stats.pageCount;
+	atlasStats_.usedArea += stats.usedArea;
+	atlasStats_.pageArea += stats.pageArea;
+	atlasStats_.bindingsSaved += stats.bindingsSaved;
+}
+
+//============================================================
+// アトラス内の場所へのUVの変換
+//============================================================
+Matrix4x4 TextureManager::GetAtlasTransform(const std::string& identifier) const {
+
+	auto it = atlasEntries_.find(contentStore_.Resolve(identifier));
+	return it != atlasEntries_.end() ? it->second.uvTransform : MakeIdentity4x4();
+}
+
+//============================================================
+// SRVの実体の名前
+//============================================================
+const std::string& TextureManager::GetBindingIdentifier(const std::string& identifier) const {
 
-	commandList->SetGraphicsRootDescriptorTable(rootParamaterIndex, textures_[identifier].gpuHandle);
+	// 内容でまとめたものは内容のキー、アトラスにまとめたものはさらにページ
+	const std::string& key = contentStore_.Resolve(identifier);
+	auto it = atlasEntries_.find(key);
+	return it != atlasEntries_.end() ? it->second.atlasIdentifier : key;
 }
\ No newline at end of file
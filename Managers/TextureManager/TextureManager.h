@@ -3,29 +3,97 @@
 #include <d3dx12.h>
 
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 #include <vector>
+#include <mutex>
+#include <optional>
 
 #include "ComPtr.h"
+#include "DescriptorHeapManager.h"
+#include "UploadManager.h"
+#include "TextureStreamer.h"
+#include "TextureAtlas.h"
+#include "ContentStore.h"
+#include "FileHasher.h"
+#include "Matrix4x4.h"
 
 //================================================
 // TextrueManager Class
 //================================================
-class TextureManager {
+/// テクスチャは小さいミップだけをGPUに置いて始め、描画された大きさに応じて詳細なミップを読み込む
+/// 予算を超える分は使われていないテクスチャのミップから追い出す
+/// BuildAtlasで小さいテクスチャをアトラスにまとめると、元の名前はアトラスのSRVとUVの変換を指すようになる
+/// ファイルから読んだテクスチャは元ファイルのハッシュでまとめ、同じ内容は名前が違っても1つのリソースを共有する
+class TextureManager : public ITextureStreamContext {
 public:
 	//====================
 	// public
 	//====================
 
-	DirectX::ScratchImage LoadTexture(const std::string& filePath);
+	// ファイルの読み込みとミップマップの作成、GPUは触らないのでワーカースレッドから呼べる
+	// TextureCookerで焼いたDDSがkCookedDirectoryにあり、焼いたときの元画像のハッシュがsourceDigestと同じならそのまま読む
+	// sourceDigestがないのは元画像がないときで、焼いたものを確かめずに読む
+	DirectX::ScratchImage LoadTexture(const std::string& filePath, const std::optional<SHA256Digest>& sourceDigest);
 	ComPtr<ID3D12Resource> CreateTextureResource(ID3D12Device* device, const DirectX::TexMetadata& metadata);
 
 	void Initialize();
 
 	void SetGraphicsRootDescriptorTable(ID3D12GraphicsCommandList* commandList, UINT rootParamaterIndex, std::string identifier);
 
-	void UploadTextureData(ID3D12Resource* texture, const DirectX::ScratchImage& mipImages);
+	// SRVのGPUハンドル、記録を後で行う描画用
+	D3D12_GPU_DESCRIPTOR_HANDLE GetGPUHandle(const std::string& identifier) const;
+	// 共有ヒープ内のSRVの番号、シェーダーからヒープ全体を配列として参照するとき使う
+	uint32_t GetSrvIndex(const std::string& identifier) const;
+
+	// 転送の登録、コピーは次のフレームの最初にまとめて記録される
+	UploadId UploadTextureData(ID3D12Resource* texture, std::shared_ptr<const DirectX::ScratchImage> mipImages, uint32_t firstMip = 0);
+	// 同じ内容のテクスチャが既にあれば、読み込まずにそれを参照する
 	void LoadTexture(const std::string& identifier, const std::string& filePath);
+	// 読み込み済みのデータからリソースとSRVを作り、転送を登録する。メインスレッドで呼ぶ
+	void CreateTexture(const std::string& identifier, std::shared_ptr<const DirectX::ScratchImage> mipImages);
+	// digestの内容のテクスチャとして登録する、同じ内容があれば参照を増やすだけでmipImagesは使わない
+	// ClaimContentでデコードを省いたものはmipImagesをnullptrで渡す。メインスレッドで呼ぶ
+	void CreateTexture(const std::string& identifier, const SHA256Digest& digest, std::shared_ptr<const DirectX::ScratchImage> mipImages);
+	// テクスチャの破棄、同じ内容の他の名前がなくなってから、GPUが使い終わったらリソースとSRVを解放する
+	void UnloadTexture(const std::string& identifier);
+
+	// 元ファイルのハッシュ、結果はパスと更新時刻で覚えておく。ワーカースレッドから呼べる
+	bool HashTextureFile(const std::string& filePath, SHA256Digest& digest) { return fileHasher_.Hash(filePath, digest); }
+	// digestの内容を最初に要求したときだけtrue、falseなら他で読み込むのでデコードしなくてよい。ワーカースレッドから呼べる
+	bool ClaimContent(const SHA256Digest& digest);
+	// 内容でまとめた統計、savedSizeは共有しなければ増えていた元データの大きさ
+	ContentStore::Stats GetContentStats() const { return contentStore_.GetStats(); }
+
+	// 転送が記録されていないテクスチャの代わりに返すもの
+	void SetFallbackTexture(const std::string& identifier) { fallbackIdentifier_ = identifier; }
+	// 転送を記録し終えて、描画から使える
+	bool IsTextureReady(const std::string& identifier) const;
+
+	// 画面上でscreenSizeピクセルの大きさに描画する、必要なミップが次のフレームから読み込まれる
+	void RequestDetail(const std::string& identifier, float screenSize);
+	// 転送し終えたミップへの入れ替えと、このフレームの要求からの読み込み、追い出し。転送の記録より先に呼ぶ
+	void UpdateStreaming();
+	// GPUに置くテクスチャの大きさの上限
+	void SetStreamingBudget(uint64_t budgetSize) { streamer_.SetBudget(budgetSize); }
+	const TextureStreamer::Stats& GetStreamingStats() const { return streamer_.GetStats(); }
+
+	// アトラスにまとめてよいテクスチャの指定、UVが0〜1の範囲でしか使わないものだけ指定する
+	// WRAPのサンプラーで範囲外を繰り返すと、アトラスの隣のテクスチャが映る
+	// 同じ内容を共有する名前が全て指定したときだけまとめる
+	void AllowAtlas(const std::string& identifier) { atlasAllowed_.insert(identifier); }
+	// AllowAtlasで指定した読み込み済みの小さいテクスチャをアトラスにまとめ、元のリソースとSRVを解放する
+	void BuildAtlas();
+	// アトラス内の場所へのUVの変換、マテリアルのuvTransformの後に掛ける。まとめていなければ単位行列
+	Matrix4x4 GetAtlasTransform(const std::string& identifier) const;
+	// SRVの実体の名前、アトラスにまとめたものはアトラスの名前
+	const std::string& GetBindingIdentifier(const std::string& identifier) const;
+	bool IsAtlased(const std::string& identifier) const { return atlasEntries_.contains(contentStore_.Resolve(identifier)); }
+	// 最後にまとめたときの統計
+	const TextureAtlas::Stats& GetAtlasStats() const { return atlasStats_; }
+
+	// 常駐ミップの反映、mipから下のミップでリソースを作り直す
+	void SetResidentMip(StreamTextureId id, uint32_t mip) override;
 
 	D3D12_CPU_DESCRIPTOR_HANDLE GetCPUDescriptorHandle(ID3D12DescriptorHeap* descriptorHeap, uint32_t descriptorSize, uint32_t index);
 	D3D12_GPU_DESCRIPTOR_HANDLE GetGPUDescriptorHandle(ID3D12DescriptorHeap* descriptorHeap, uint32_t descriptorSize, uint32_t index);
@@ -37,17 +105,109 @@ private:
 	// privete
 	//====================
 
+	// GPUに置くテクスチャの大きさの上限の初期値
+	static const uint64_t kDefaultStreamingBudget = 256 * 1024 * 1024;
+	// 1フレームに読み込むテクスチャの数、転送はUploadManagerのbudgetでさらに分けられる
+	static const uint32_t kMaxStreamRequestsPerFrame = 4;
+
+	// GPUに置いたミップ
+	struct TextureResidency {
+
+		ComPtr<ID3D12Resource> resource;
+		DescriptorHandle srvHandle;
+		// データの転送
+		UploadId uploadId = UploadQueue::kInvalidId;
+		// リソースのミップ0が元データのどのミップか
+		uint32_t mip = 0;
+	};
+
 	// テクスチャデータ
 	struct TextureData {
 
-		ComPtr<ID3D12Resource> resource;
-		D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle;
-		D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle;
+		// 全ミップの情報
 		DirectX::TexMetadata metadata;
+		// 全ミップの元データ、追い出したミップを読み直すときに使う
+		std::shared_ptr<const DirectX::ScratchImage> image;
+		StreamTextureId streamId = TextureStreamer::kInvalidId;
+
+		// 描画に使っているもの
+		TextureResidency resident;
+		// 作り直して転送中のもの、記録し終えたら入れ替える
+		TextureResidency pending;
+	};
+
+	// アトラスにまとめるテクスチャの大きさの最大
+	static const uint32_t kAtlasMaxTextureSize = 512;
+	// アトラスのページの大きさの最大
+	static const uint32_t kAtlasMaxPageSize = 2048;
+	// アトラスのミップの段数、余白と位置はこの段数分のミップで隣が混ざらないように揃える
+	static const uint32_t kAtlasMipLevels = 3;
+	static const uint32_t kAtlasPadding = 1u << (kAtlasMipLevels - 1);
+
+	// アトラスにまとめたテクスチャ
+	struct AtlasEntry {
+
+		// まとめた先のページ
+		std::string atlasIdentifier;
+		// 元のUVからページ内のUVへの変換
+		Matrix4x4 uvTransform;
+		// ページの大きさ / テクスチャの大きさ、ミップの要求をページの大きさに直す
+		float detailScale = 1.0f;
 	};
 
 	std::unordered_map<std::string, TextureData> textures_;
-	ComPtr<ID3D12DescriptorHeap> descriptorHeap_;
+	// アトラスにまとめたテクスチャの名前から、まとめた先
+	std::unordered_map<std::string, AtlasEntry> atlasEntries_;
+	// ページの名前から、まとめたテクスチャの数。0になったらページを破棄する
+	std::unordered_map<std::string, uint32_t> atlasPageReferences_;
+	// AllowAtlasで指定された名前
+	std::unordered_set<std::string> atlasAllowed_;
+	TextureAtlas::Stats atlasStats_;
+	// 作ったページの数、ページの名前に使う
+	uint32_t atlasPageCount_ = 0;
+	// ストリーミングの番号からテクスチャの名前
+	std::vector<std::string> streamIdentifiers_;
+	TextureStreamer streamer_;
+	DescriptorHeapManager* descriptorHeapManager_ = nullptr;
+	UploadManager* uploadManager_ = nullptr;
+
+	std::string fallbackIdentifier_;
+
+	// ファイルから読んだテクスチャの名前から、内容ごとのキー。textures_はこのキーで持つ
+	ContentStore contentStore_;
+	FileHasher fileHasher_;
+	// デコードを始めた内容、破棄したら外す
+	std::mutex claimMutex_;
+	std::unordered_set<SHA256Digest, SHA256DigestHash> claimedDigests_;
+
+	// アトラスのページの名前
+	static inline const char* kAtlasPrefix = "__atlas";
+	// 内容でまとめたテクスチャのキー
+	static inline const char* kContentPrefix = "__content";
+
+	// TextureCookerで焼いたテクスチャの置き場
+	static inline const char* kCookedDirectory = "./Resources/Cooked";
+
+	// RGBA8、BGRA8の1枚の画像か
+	static bool IsMipGeneratorFormat(const DirectX::TexMetadata& metadata);
+	// MipGeneratorでミップマップを作る、2の累乗の大きさならDirectXTexのBoxフィルタと1以内の差
+	static DirectX::ScratchImage GenerateMipMaps(const DirectX::ScratchImage& image);
+
+	// リソースとSRVの作成、keyはtextures_のキー
+	void CreateTextureData(const std::string& key, std::shared_ptr<const DirectX::ScratchImage> mipImages);
+	// リソースとSRVの破棄
+	void DestroyTexture(const std::string& key);
+
+	// 描画に使うテクスチャ、転送中なら代わりのもの
+	const TextureData& GetDrawableTexture(const std::string& identifier) const;
+
+	// 同じフォーマットのテクスチャをアトラスにまとめる
+	void BuildAtlas(const std::vector<std::string>& identifiers);
+
+	// mipから下のミップでリソースとSRVを作り、転送を登録する
+	TextureResidency CreateResidency(const std::shared_ptr<const DirectX::ScratchImage>& image, uint32_t mip);
+	// リソースとSRVの破棄、GPUが使い終わってから解放する
+	void ReleaseResidency(TextureResidency& residency);
 
 	TextureManager() = default;
 	~TextureManager() = default;
@@ -0,0 +1,256 @@
+#include "UploadManager.h"
+
+#include <cassert>
+
+#include "DirectXCommon.h"
+
+namespace {
+
+	//================================================
+	// D3D12CopyContext Class
+	//================================================
+	/// ICopyContextをコマンドリストへ記録する
+	class D3D12CopyContext : public ICopyContext {
+	public:
+
+		D3D12CopyContext(ID3D12GraphicsCommandList* commandList, const BufferAllocation& staging) :
+			commandList_(commandList), staging_(staging) {}
+
+		void CopyBuffer(void* destination, uint64_t destinationOffset, uint64_t stagingOffset, uint64_t size) override {
+
+			commandList_->CopyBufferRegion(
+				static_cast<ID3D12Resource*>(destination), destinationOffset,
+				staging_.resource, staging_.offset + stagingOffset, size);
+		}
+
+		void CopyTexture(void* destination, uint32_t subresource, const UploadFootprint& footprint) override {
+
+			D3D12_TEXTURE_COPY_LOCATION destinationLocation{};
+			destinationLocation.pResource = static_cast<ID3D12Resource*>(destination);
+			destinationLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+			destinationLocation.SubresourceIndex = subresource;
+
+			// 配置はUploadQueueで計算済み
+			D3D12_TEXTURE_COPY_LOCATION sourceLocation{};
+			sourceLocation.pResource = staging_.resource;
+			sourceLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+			sourceLocation.PlacedFootprint.Offset = staging_.offset + footprint.offset;
+			sourceLocation.PlacedFootprint.Footprint.Format = static_cast<DXGI_FORMAT>(footprint.format);
+			sourceLocation.PlacedFootprint.Footprint.Width = footprint.width;
+			sourceLocation.PlacedFootprint.Footprint.Height = footprint.height;
+			sourceLocation.PlacedFootprint.Footprint.Depth = footprint.depth;
+			sourceLocation.PlacedFootprint.Footprint.RowPitch = footprint.rowPitch;
+
+			commandList_->CopyTextureRegion(&destinationLocation, 0, 0, 0, &sourceLocation, nullptr);
+		}
+
+		void FinishUpload(void* destination, bool isTexture) override {
+
+			// コピー先から読み取り用の状態に戻す
+			D3D12_RESOURCE_BARRIER barrier{};
+			barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+			barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+			barrier.Transition.pResource = static_cast<ID3D12Resource*>(destination);
+			barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+			barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+			barrier.Transition.StateAfter = isTexture ?
+				D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE :
+				D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER | D3D12_RESOURCE_STATE_INDEX_BUFFER;
+
+			commandList_->ResourceBarrier(1, &barrier);
+		}
+
+	private:
+
+		ID3D12GraphicsCommandList* commandList_;
+		const BufferAllocation& staging_;
+	};
+}
+
+//============================================================
+// シングルトンインスタンス
+//============================================================
+UploadManager* UploadManager::Instance() {
+	static UploadManager instance;
+	return &instance;
+}
+
+//============================================================
+// 初期化
+//============================================================
+void UploadManager::Initialize() {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	// ステージングはアップロードヒープ、リングとして使いまわす
+	stagingBuffer_ = BufferManager::Instance()->Allocate(kStagingSize);
+	queue_.Initialize(stagingBuffer_.cpuAddress, kStagingSize, kFrameBudget);
+}
+
+//============================================================
+// 終了処理
+//============================================================
+void UploadManager::Finalize() {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	// 記録待ちの元データも手放す
+	queue_.Reset();
+	BufferManager::Instance()->Free(stagingBuffer_);
+}
+
+//============================================================
+// テクスチャの転送の登録
+//============================================================
+UploadId UploadManager::UploadTexture(ID3D12Resource* texture, std::shared_ptr<const DirectX::ScratchImage> image, uint32_t firstMip) {
+
+	const DirectX::TexMetadata& metadata = image->GetMetadata();
+	assert(firstMip < metadata.mipLevels);
+
+	// サブリソースの番号順、D3D12CalcSubresourceと同じく配列の要素ごとにミップが並ぶ
+	std::vector<UploadSubresource> subresources;
+	subresources.reserve(metadata.arraySize * (metadata.mipLevels - firstMip));
+	for (size_t item = 0; item < metadata.arraySize; ++item) {
+		for (size_t mipLevel = firstMip; mipLevel < metadata.mipLevels; ++mipLevel) {
+
+			const DirectX::Image* img = image->GetImage(mipLevel, item, 0);
+
+			UploadSubresource subresource{};
+			subresource.data = img->pixels;
+			subresource.rowPitch = img->rowPitch;
+			// ブロック圧縮なら4ピクセルで1行になる
+			subresource.rowCount = static_cast<uint32_t>(img->slicePitch / img->rowPitch);
+			subresource.format = static_cast<uint32_t>(img->format);
+			subresource.width = static_cast<uint32_t>(img->width);
+			subresource.height = static_cast<uint32_t>(img->height);
+
+			// ブロック圧縮のフットプリントは4の倍数
+			if (DirectX::IsCompressed(img->format)) {
+
+				subresource.width = (subresource.width + 3) & ~3u;
+				subresource.height = (subresource.height + 3) & ~3u;
+			}
+
+			subresources.push_back(subresource);
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	return queue_.EnqueueTexture(texture, subresources, std::move(image));
+}
+
+//============================================================
+// バッファの転送の登録
+//============================================================
+UploadId UploadManager::UploadBuffer(ID3D12Resource* buffer, const void* data, uint64_t sizeInBytes, std::shared_ptr<const void> owner) {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	return queue_.EnqueueBuffer(buffer, 0, data, sizeInBytes, std::move(owner));
+}
+
+//============================================================
+// 転送の取り消し
+//============================================================
+void UploadManager::Cancel(UploadId id) {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	queue_.Cancel(id);
+}
+
+//============================================================
+// デフォルトヒープのバッファの生成
+//============================================================
+ComPtr<ID3D12Resource> UploadManager::CreateBuffer(uint64_t sizeInBytes) {
+
+	// GPUからだけ読むのでデフォルトヒープに置く
+	D3D12_HEAP_PROPERTIES defaultHeapProperties{};
+	defaultHeapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
+	// バッファリソースの設定
+	D3D12_RESOURCE_DESC bufferResourceDesc{};
+	bufferResourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	bufferResourceDesc.Width = sizeInBytes;
+	// バッファの場合はこれらは1にする決まり
+	bufferResourceDesc.Height = 1;
+	bufferResourceDesc.DepthOrArraySize = 1;
+	bufferResourceDesc.MipLevels = 1;
+	bufferResourceDesc.SampleDesc.Count = 1;
+	// バッファの場合はこれにする決まり
+	bufferResourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+	// バッファはCOMMONで作られ、最初のコピーでCOPY_DESTに昇格する
+	ComPtr<ID3D12Resource> bufferResource = nullptr;
+	HRESULT hr = DirectXCommon::Instance()->GetDevice()->CreateCommittedResource(
+		&defaultHeapProperties, D3D12_HEAP_FLAG_NONE, &bufferResourceDesc,
+		D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&bufferResource));
+	assert(SUCCEEDED(hr));
+
+	return bufferResource;
+}
+
+//============================================================
+// budgetまで記録する
+//============================================================
+void UploadManager::Process() {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	if (queue_.IsIdle()) {
+		return;
+	}
+
+	D3D12CopyContext context(DirectXCommon::Instance()->GetCommandList(), stagingBuffer_);
+	queue_.Process(context);
+}
+
+//============================================================
+// まとめて記録する
+//============================================================
+void UploadManager::Flush() {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	D3D12CopyContext context(DirectXCommon::Instance()->GetCommandList(), stagingBuffer_);
+	bool flushed = queue_.Flush(context);
+
+	// ステージングが足りない、kStagingSizeを増やす
+	assert(flushed);
+}
+
+//============================================================
+// フレームの終了
+//============================================================
+void UploadManager::FinishFrame(uint64_t fenceValue) {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	queue_.FinishFrame(fenceValue);
+}
+
+//============================================================
+// GPUが読み終わったフレームの回収
+//============================================================
+void UploadManager::ReleaseCompletedFrames(uint64_t completedFenceValue) {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	queue_.ReleaseCompletedFrames(completedFenceValue);
+}
+
+//============================================================
+// getter
+//============================================================
+bool UploadManager::IsSubmitted(UploadId id) const {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	return queue_.IsSubmitted(id);
+}
+
+bool UploadManager::IsComplete(UploadId id) const {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	return queue_.IsComplete(id);
+}
+
+UploadQueue::Stats UploadManager::GetStats() const {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	return queue_.GetStats();
+}
\ No newline at end of file
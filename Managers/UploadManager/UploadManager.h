@@ -0,0 +1,86 @@
+#pragma once
+#include <d3d12.h>
+#include <DirectXTex.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "ComPtr.h"
+#include "BufferManager.h"
+#include "UploadQueue.h"
+
+//================================================
+// UploadManager Class
+//================================================
+/// テクスチャやメッシュをステージングバッファ経由でデフォルトヒープへ転送する
+/// コピーはフレームの最初にメインのコマンドリストへまとめて記録し、描画より先に実行される
+class UploadManager {
+public:
+	//====================
+	// public
+	//====================
+
+	// ステージングのサイズ
+	static const uint64_t kStagingSize = 32 * 1024 * 1024;
+	// 1フレームに記録する量の目安
+	static const uint64_t kFrameBudget = 8 * 1024 * 1024;
+
+	void Initialize();
+	void Finalize();
+
+	// テクスチャの転送の登録、imageは記録し終わるまで保持する
+	// firstMipより詳細でないミップを転送する、textureのミップ0がimageのfirstMipになる
+	UploadId UploadTexture(ID3D12Resource* texture, std::shared_ptr<const DirectX::ScratchImage> image, uint32_t firstMip = 0);
+
+	// バッファの転送の登録、ownerは記録し終わるまでdataを生かしておくためのもの
+	UploadId UploadBuffer(ID3D12Resource* buffer, const void* data, uint64_t sizeInBytes, std::shared_ptr<const void> owner);
+
+	// 記録し終えていない転送の取り消し
+	void Cancel(UploadId id);
+
+	// 転送先になるデフォルトヒープのバッファの生成
+	ComPtr<ID3D12Resource> CreateBuffer(uint64_t sizeInBytes);
+
+	// budgetまでメインのコマンドリストに記録する、PreDrawの後に呼ぶ
+	void Process();
+
+	// budgetを無視して記録する、初期化時の読み込みをまとめて送るときに使う
+	void Flush();
+
+	// フレームの終了、このフレームの記録分をfenceValueに紐づける
+	void FinishFrame(uint64_t fenceValue);
+
+	// GPUが読み終わったフレームの回収
+	void ReleaseCompletedFrames(uint64_t completedFenceValue);
+
+	static UploadManager* Instance();
+
+	// getter
+
+	// コピーを全て記録済み、このフレームの描画から使える
+	bool IsSubmitted(UploadId id) const;
+	// GPUでのコピーが完了済み
+	bool IsComplete(UploadId id) const;
+	UploadQueue::Stats GetStats() const;
+
+private:
+	//====================
+	// private
+	//====================
+
+	// 永続的にマップしたステージングバッファ
+	BufferAllocation stagingBuffer_;
+
+	UploadQueue queue_;
+
+	// アセットの読み込みスレッドからも登録される
+	mutable std::mutex mutex_;
+
+	UploadManager() = default;
+	~UploadManager() = default;
+
+	// コピー禁止
+	UploadManager(const UploadManager&) = delete;
+	UploadManager& operator=(const UploadManager&) = delete;
+};
\ No newline at end of file
@@ -2,472 +2,315 @@
 
 #include "DirectXCommon.h"
 
+#include <algorithm>
+#include <thread>
+
 //============================================================
-// DXCを使用してShaderをCompileする
+// namespace
 //============================================================
-ComPtr<IDxcBlob> Pipeline::CompileShader(
-	// CompilerするShaderファイルへのパス
-	const std::wstring& filePath,
-	// Compilerに使用するProfile
-	const wchar_t* profile,
-	// 初期化で生成したものを3つ
-	IDxcUtils* dxcUtils,
-	IDxcCompiler3* dxcCompiler,
-	IDxcIncludeHandler* includeHandler
-) {
-
-	HRESULT hr;
-
-	///////////////////////////////////////////////////////////
-	// 1.hlslファイルを読み込む
-	///////////////////////////////////////////////////////////
-
-	// ここからシェーダーをコンパイルする旨をログに出す
-	Log(ConvertWString(std::format(L"Begin CompilerShader, path:{}. profile:{}\n", filePath, profile)));
-	// hlslファイルを読み込む
-	IDxcBlobEncoding* shaderSouce = nullptr;
-	hr = dxcUtils->LoadFile(filePath.c_str(), nullptr, &shaderSouce);
-	// 読めなかったら止める
-	assert(SUCCEEDED(hr));
-	// 読み込んだファイルの内容を設定する
-	DxcBuffer shaderSourceBuffer;
-	shaderSourceBuffer.Ptr = shaderSouce->GetBufferPointer();
-	shaderSourceBuffer.Size = shaderSouce->GetBufferSize();
-	// UTF8の文字コードであることを通知
-	shaderSourceBuffer.Encoding = DXC_CP_UTF8;
-
-	///////////////////////////////////////////////////////////
-	// 2.Compileする
-	///////////////////////////////////////////////////////////
-
-	LPCWSTR arguments[] = {
-		filePath.c_str(),          // コンパイル対象のファイル名
-		L"-E",L"main",             // エントリーポイントの指定、基本的にmain以外にはしない
-		L"-T",profile,             // ShaderProfileの設定
-		L"-Zi",L"-Qembed_debug",   // デバッグ用の情報を埋め込む
-		L"-Od",                    // 最適化を外しておく
-		L"-Zpr",                   // メモリレイアウトは行優先
+namespace {
+
+	//============================================================
+	// DxcShaderCompiler class
+	//============================================================
+	/// DXCを使用してShaderをCompileする
+	/// 複数のスレッドから呼ばれるので、DXCのインスタンスは呼び出しごとに作る
+	class DxcShaderCompiler : public IShaderCompiler {
+	public:
+
+		bool Compile(const ShaderRequest& request, std::vector<uint8_t>& bytecode, std::string& error) override {
+
+			HRESULT hr;
+
+			ComPtr<IDxcUtils> dxcUtils;
+			ComPtr<IDxcCompiler3> dxcCompiler;
+			ComPtr<IDxcIncludeHandler> includeHandler;
+			hr = DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&dxcUtils));
+			assert(SUCCEEDED(hr));
+			hr = DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&dxcCompiler));
+			assert(SUCCEEDED(hr));
+			hr = dxcUtils->CreateDefaultIncludeHandler(&includeHandler);
+			assert(SUCCEEDED(hr));
+
+			///////////////////////////////////////////////////////////
+			// 1.hlslファイルを読み込む
+			///////////////////////////////////////////////////////////
+
+			std::wstring filePath = request.path.wstring();
+
+			// ここからシェーダーをコンパイルする旨をログに出す
+			Log(ConvertWString(std::format(L"Begin CompilerShader, path:{}. profile:{}\n", filePath, request.profile)));
+			// hlslファイルを読み込む
+			ComPtr<IDxcBlobEncoding> shaderSouce = nullptr;
+			hr = dxcUtils->LoadFile(filePath.c_str(), nullptr, &shaderSouce);
+			if (FAILED(hr)) {
+				error = "Cannot load " + ConvertWString(filePath);
+				return false;
+			}
+			// 読み込んだファイルの内容を設定する
+			DxcBuffer shaderSourceBuffer;
+			shaderSourceBuffer.Ptr = shaderSouce->GetBufferPointer();
+			shaderSourceBuffer.Size = shaderSouce->GetBufferSize();
+			// UTF8の文字コードであることを通知
+			shaderSourceBuffer.Encoding = DXC_CP_UTF8;
+
+			///////////////////////////////////////////////////////////
+			// 2.Compileする
+			///////////////////////////////////////////////////////////
+
+			std::vector<LPCWSTR> arguments = {
+				filePath.c_str(),                // コンパイル対象のファイル名
+				L"-E", request.entry.c_str(),    // エントリーポイントの指定
+				L"-T", request.profile.c_str(),  // ShaderProfileの設定
+			};
+			for (const auto& argument : request.arguments) {
+				arguments.push_back(argument.c_str());
+			}
+
+			// 実際にShaderをコンパイルする
+			ComPtr<IDxcResult> shaderResult = nullptr;
+			hr = dxcCompiler->Compile(
+				&shaderSourceBuffer,                      // 読み込んだファイル
+				arguments.data(),                         // コンパイルオプション
+				static_cast<UINT32>(arguments.size()),    // コンパイルオプションの数
+				includeHandler.Get(),                     // includeが含まれた諸々
+				IID_PPV_ARGS(&shaderResult)               // コンパイル結果
+			);
+			// コンパイルエラーではなくdxcが起動できないなど致命的な状況
+			assert(SUCCEEDED(hr));
+
+			///////////////////////////////////////////////////////////
+			// 3.警告、エラーが出ていないか確認する
+			///////////////////////////////////////////////////////////
+
+			// 警告、エラーが出たら失敗にする
+			ComPtr<IDxcBlobUtf8> shaderError = nullptr;
+			shaderResult->GetOutput(DXC_OUT_ERRORS, IID_PPV_ARGS(&shaderError), nullptr);
+			if (shaderError != nullptr && shaderError->GetStringLength() != 0) {
+				error = shaderError->GetStringPointer();
+				return false;
+			}
+
+			///////////////////////////////////////////////////////////
+			// 4.Complie結果を受け取って返す
+			///////////////////////////////////////////////////////////
+
+			// コンパイル結果から実行用のバイナリ部分を取得
+			ComPtr<IDxcBlob> shaderBlob = nullptr;
+			hr = shaderResult->GetOutput(DXC_OUT_OBJECT, IID_PPV_ARGS(&shaderBlob), nullptr);
+			assert(SUCCEEDED(hr));
+			// 成功したログを出す
+			Log(ConvertWString(std::format(L"Complie Succeeded, path:{}, profile:{}\n", filePath, request.profile)));
+
+			// 実行用のバイナリを返却
+			const uint8_t* data = static_cast<const uint8_t*>(shaderBlob->GetBufferPointer());
+			bytecode.assign(data, data + shaderBlob->GetBufferSize());
+			return true;
+		}
 	};
-	// 実際にShaderをコンパイルする
-	IDxcResult* shaderResult = nullptr;
-	hr = dxcCompiler->Compile(
-		&shaderSourceBuffer,          // 読み込んだファイル
-		arguments,                    // コンパイルオプション
-		_countof(arguments),          // コンパイルオプションの数
-		includeHandler,               // includeが含まれた諸々
-		IID_PPV_ARGS(&shaderResult)   // コンパイル結果
-	);
-	// コンパイルエラーではなくdxcが起動できないなど致命的な状況
-	assert(SUCCEEDED(hr));
-
-	///////////////////////////////////////////////////////////
-	// 3.警告、エラーが出ていないか確認する
-	///////////////////////////////////////////////////////////
-
-	// 警告、エラーが出たらログに出して止める
-	ComPtr<IDxcBlobUtf8> shaderError = nullptr;
-	shaderResult->GetOutput(DXC_OUT_ERRORS, IID_PPV_ARGS(&shaderError), nullptr);
-	if (shaderError != nullptr && shaderError->GetStringLength() != 0) {
-		Log(shaderError->GetStringPointer());
-		// 警告、エラー
-		assert(false);
-	}
-
-	///////////////////////////////////////////////////////////
-	// 4.Complie結果を受け取って返す
-	///////////////////////////////////////////////////////////
-
-	// コンパイル結果から実行用のバイナリ部分を取得
-	ComPtr<IDxcBlob> shaderBlob = nullptr;
-	hr = shaderResult->GetOutput(DXC_OUT_OBJECT, IID_PPV_ARGS(&shaderBlob), nullptr);
-	assert(SUCCEEDED(hr));
-	// 成功したログを出す
-	Log(ConvertWString(std::format(L"Complie Succeeded, path:{}, profile:{}\n", filePath, profile)));
-	// もう使わないリソースを解放
-	shaderSouce->Release();
-	shaderResult->Release();
-	shaderError->Release();
-	// 実行用のバイナリを返却
-	return shaderBlob;
 }
 
 //============================================================
-// プリミティブ適応パイプライン生成
+// 単色パイプラインの設定
 //============================================================
-std::unique_ptr<PipelineObject> Pipeline::CreatePrimitiveGraphicsPipeline() {
-
-	DirectXCommon* dxCommon = DirectXCommon::Instance();
-
-	HRESULT hr;
-
-	std::unique_ptr<PipelineObject> pipeline = std::make_unique<PipelineObject>();
-
-	ComPtr<ID3DBlob> errorBlob = nullptr; // エラー
-	ComPtr<ID3DBlob> signatureBlob = nullptr;
-
-	ComPtr<IDxcBlob> vsBlob = nullptr; // 頂点シェーダ
-	ComPtr<IDxcBlob> psBlob = nullptr; // ピクセルシェーダ
-
-	/// RootSignature
-#pragma region /// RootSignature ///
-
-	D3D12_ROOT_SIGNATURE_DESC descriptionRootSignature{};
-	descriptionRootSignature.Flags =
-		D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
-
-#pragma endregion
+PipelineDesc PrimitivePipeline::MakeDesc() {
+
+	PipelineDesc desc{};
+	desc.shader = "Primitive";
+	desc.inputElements = PIPELINE_INPUT_POSITION;
+	desc.renderTargetFormat = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+	desc.depthStencilFormat = DXGI_FORMAT_D24_UNORM_S8_UINT;
+
+	PipelineRootLayout& root = desc.rootLayout;
+	[[maybe_unused]] uint32_t material =
+		root.Add(PipelineRootParameterType::CONSTANTBUFFER, PipelineShaderVisibility::PIXEL, 0);    // b0
+	[[maybe_unused]] uint32_t transform =
+		root.Add(PipelineRootParameterType::CONSTANTBUFFER, PipelineShaderVisibility::VERTEX, 0);   // b0
+	assert(material == kMaterial && transform == kTransform);
+
+	return desc;
+}
 
-	/// rootParameter
-#pragma region /// rootParameter ///
+//============================================================
+// テクスチャパイプラインの設定
+//============================================================
+PipelineDesc TexturePipeline::MakeDesc() {
+
+	PipelineDesc desc{};
+	desc.shader = "Object3d";
+	desc.inputElements = PIPELINE_INPUT_POSITION | PIPELINE_INPUT_TEXCOORD | PIPELINE_INPUT_NORMAL;
+	desc.renderTargetFormat = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+	desc.depthStencilFormat = DXGI_FORMAT_D24_UNORM_S8_UINT;
+
+	PipelineRootLayout& root = desc.rootLayout;
+	root.useSampler = true;
+	[[maybe_unused]] uint32_t material =
+		root.Add(PipelineRootParameterType::CONSTANTBUFFER, PipelineShaderVisibility::PIXEL, 0);    // b0
+	[[maybe_unused]] uint32_t transform =
+		root.Add(PipelineRootParameterType::CONSTANTBUFFER, PipelineShaderVisibility::VERTEX, 0);   // b0
+	[[maybe_unused]] uint32_t texture =
+		root.Add(PipelineRootParameterType::DESCRIPTORTABLE, PipelineShaderVisibility::PIXEL, 0);   // t0
+	[[maybe_unused]] uint32_t light =
+		root.Add(PipelineRootParameterType::CONSTANTBUFFER, PipelineShaderVisibility::PIXEL, 1);    // b1
+	assert(material == kMaterial && transform == kTransform && texture == kTexture && light == kLight);
+
+	return desc;
+}
 
-	D3D12_ROOT_PARAMETER TEXTURERootParameters[2] = {};
-	TEXTURERootParameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;      // CBVを使う
-	TEXTURERootParameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;   // PixelShaderで使う
-	TEXTURERootParameters[0].Descriptor.ShaderRegister = 0;                      // レジスタ番号0とバインド
+//============================================================
+// BlinnPhong反射パイプラインの設定
+//============================================================
+PipelineDesc BlinnPhongPipeline::MakeDesc() {
+
+	PipelineDesc desc{};
+	desc.shader = "BlinnPhong";
+	desc.inputElements = PIPELINE_INPUT_POSITION | PIPELINE_INPUT_TEXCOORD | PIPELINE_INPUT_NORMAL;
+	desc.renderTargetFormat = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+	desc.depthStencilFormat = DXGI_FORMAT_D24_UNORM_S8_UINT;
+
+	PipelineRootLayout& root = desc.rootLayout;
+	root.useSampler = true;
+	[[maybe_unused]] uint32_t material =
+		root.Add(PipelineRootParameterType::CONSTANTBUFFER, PipelineShaderVisibility::PIXEL, 0);    // b0
+	[[maybe_unused]] uint32_t transform =
+		root.Add(PipelineRootParameterType::CONSTANTBUFFER, PipelineShaderVisibility::VERTEX, 0);   // b0
+	[[maybe_unused]] uint32_t texture =
+		root.Add(PipelineRootParameterType::DESCRIPTORTABLE, PipelineShaderVisibility::PIXEL, 0);   // t0
+	[[maybe_unused]] uint32_t light =
+		root.Add(PipelineRootParameterType::CONSTANTBUFFER, PipelineShaderVisibility::PIXEL, 1);    // b1
+	[[maybe_unused]] uint32_t camera =
+		root.Add(PipelineRootParameterType::CONSTANTBUFFER, PipelineShaderVisibility::PIXEL, 2);    // b2
+	assert(material == kMaterial && transform == kTransform && texture == kTexture && light == kLight && camera == kCamera);
+
+	return desc;
+}
 
-	TEXTURERootParameters[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;      // CBVを使う
-	TEXTURERootParameters[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;   // VertexShaderで使う
-	TEXTURERootParameters[1].Descriptor.ShaderRegister = 0;                      // レジスタ番号0とバインド
+//============================================================
+// インスタンシングパイプラインの設定
+//============================================================
+PipelineDesc InstancedPipeline::MakeDesc() {
+
+	PipelineDesc desc{};
+	desc.shader = "Object3dInstanced";
+	desc.inputElements = PIPELINE_INPUT_POSITION | PIPELINE_INPUT_TEXCOORD | PIPELINE_INPUT_NORMAL;
+	desc.renderTargetFormat = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+	desc.depthStencilFormat = DXGI_FORMAT_D24_UNORM_S8_UINT;
+
+	PipelineRootLayout& root = desc.rootLayout;
+	root.useSampler = true;
+	// StructuredBufferをSRVで直接使う、VertexShader、PixelShaderの両方で使う
+	[[maybe_unused]] uint32_t instances =
+		root.Add(PipelineRootParameterType::SHADERRESOURCE, PipelineShaderVisibility::ALL, 1);      // t1
+	// ヒープ全体をテクスチャの配列として使う、他のSRVとぶつからないようspace1
+	// 上限のない範囲はリソースバインディングTier2が必要、足りなければEngineがこのパイプラインを使わない
+	[[maybe_unused]] uint32_t textures =
+		root.Add(PipelineRootParameterType::DESCRIPTORTABLE, PipelineShaderVisibility::PIXEL, 0, 1, ~0u); // t0, space1
+	[[maybe_unused]] uint32_t light =
+		root.Add(PipelineRootParameterType::CONSTANTBUFFER, PipelineShaderVisibility::PIXEL, 1);    // b1
+	[[maybe_unused]] uint32_t camera =
+		root.Add(PipelineRootParameterType::CONSTANTBUFFER, PipelineShaderVisibility::PIXEL, 2);    // b2
+	assert(instances == kInstances && textures == kTextures && light == kLight && camera == kCamera);
+
+	return desc;
+}
 
-	descriptionRootSignature.pParameters = TEXTURERootParameters;                // ルートパラメータ配列へのポインタ
-	descriptionRootSignature.NumParameters = _countof(TEXTURERootParameters);    // 配列の長さ
+//============================================================
+// デストラクタ
+//============================================================
+Pipeline::~Pipeline() {
 
-#pragma endregion
+	// 生成したものは自分で破棄するので、先に返してもらう
+	cache_.Finalize();
+	shaderCache_.Finalize();
+}
 
-	/// InputLayout
-#pragma region /// InputLayout ///
+//============================================================
+// パイプラインの登録
+//============================================================
+void Pipeline::Initialize() {
 
-	D3D12_INPUT_ELEMENT_DESC inputElementDescs[1] = {};
-	inputElementDescs[0].SemanticName = "POSITION";
-	inputElementDescs[0].SemanticIndex = 0;
-	inputElementDescs[0].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	inputElementDescs[0].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+	cache_.Initialize(this);
 
-	D3D12_INPUT_LAYOUT_DESC inputLayoutDesc{};
-	inputLayoutDesc.pInputElementDescs = inputElementDescs;
-	inputLayoutDesc.NumElements = _countof(inputElementDescs);
+	// 呼び出し元のスレッドも含めてコア数分でコンパイルする
+	shaderCompiler_ = std::make_unique<DxcShaderCompiler>();
+	shaderCache_.Initialize(shaderCompiler_.get(), kShaderCacheDirectory, (std::max)(std::thread::hardware_concurrency(), 1u));
 
-#pragma endregion
+	// PipelineTypeの順に登録するので、番号がそのままPipelineTypeになる
+	[[maybe_unused]] PipelineId primitive = cache_.Register(PrimitivePipeline::MakeDesc());
+	[[maybe_unused]] PipelineId texture = cache_.Register(TexturePipeline::MakeDesc());
+	[[maybe_unused]] PipelineId blinnPhong = cache_.Register(BlinnPhongPipeline::MakeDesc());
+	[[maybe_unused]] PipelineId instanced = cache_.Register(InstancedPipeline::MakeDesc());
 
-	/// バイナリをもとに生成
-#pragma region /// バイナリをもとに生成 rootSignature　///
+	assert(primitive == static_cast<PipelineId>(PipelineType::PRIMITIVE));
+	assert(texture == static_cast<PipelineId>(PipelineType::TEXTURE));
+	assert(blinnPhong == static_cast<PipelineId>(PipelineType::BLINNPHONG));
+	assert(instanced == static_cast<PipelineId>(PipelineType::INSTANCED));
+}
 
-	hr = D3D12SerializeRootSignature(&descriptionRootSignature,
-		D3D_ROOT_SIGNATURE_VERSION_1, &signatureBlob, &errorBlob);
-	if (FAILED(hr)) {
+//============================================================
+// シェーダーの用意
+//============================================================
+void Pipeline::CompileShaders() {
 
-		Log(reinterpret_cast<char*>(errorBlob->GetBufferPointer()));
-		assert(false);
+	// 登録したパイプラインのシェーダーをまとめて用意しておく、PSOの生成時にはコンパイルしない
+	std::vector<ShaderRequest> requests;
+	for (PipelineId id = static_cast<PipelineId>(PipelineType::PRIMITIVE); id <= static_cast<PipelineId>(PipelineType::INSTANCED); ++id) {
+		requests.push_back(MakeShaderRequest(cache_.GetDesc(id), true));
+		requests.push_back(MakeShaderRequest(cache_.GetDesc(id), false));
 	}
 
-	hr = dxCommon->GetDevice()->CreateRootSignature(0, signatureBlob->GetBufferPointer(),
-		signatureBlob->GetBufferSize(), IID_PPV_ARGS(&pipeline->rootSignature));
-	assert(SUCCEEDED(hr));
-
-#pragma endregion
-
-	/// BlendState
-#pragma region /// BlendState ///
-
-	D3D12_BLEND_DESC blendDesc{};
-	// 全ての色要素を書き込む
-	// ブレンドモードNone D3D12_COLOR_WRITE_ENABLE_ALLだけ
-	blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
-	blendDesc.RenderTarget[0].BlendEnable = TRUE;
-	blendDesc.RenderTarget[0].SrcBlend = D3D12_BLEND_SRC_ALPHA;
-	blendDesc.RenderTarget[0].BlendOp = D3D12_BLEND_OP_ADD;
-	blendDesc.RenderTarget[0].DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
-	blendDesc.RenderTarget[0].SrcBlendAlpha = D3D12_BLEND_ONE;
-	blendDesc.RenderTarget[0].BlendOpAlpha = D3D12_BLEND_OP_ADD;
-	blendDesc.RenderTarget[0].DestBlendAlpha = D3D12_BLEND_ZERO;
-
-#pragma endregion
-
-	/// RasterizerState
-#pragma region /// RasterizerState ///
-
-	D3D12_RASTERIZER_DESC rasterizerDesc{};
-	// 裏面(時計周り)を表示しない、背面カリング
-	rasterizerDesc.CullMode = D3D12_CULL_MODE_BACK;
-	//三角形の中を塗りつぶす
-	rasterizerDesc.FillMode = D3D12_FILL_MODE_SOLID;
-
-#pragma endregion
-
-	/// ShaderComplie
-#pragma region /// ShaderComplie ///
-
-	// 頂点シェーダ
-	vsBlob =
-		CompileShader(L"./Resources/Shaders/Primitive.VS.hlsl", L"vs_6_0",
-			dxCommon->GetDxcUtils(), dxCommon->GetDxcCompiler(), dxCommon->GetIncludeHandler());
-	assert(vsBlob != nullptr);
-
-	// ピクセルシェーダ
-	psBlob =
-		CompileShader(L"./Resources/Shaders/Primitive.PS.hlsl", L"ps_6_0",
-			dxCommon->GetDxcUtils(), dxCommon->GetDxcCompiler(), dxCommon->GetIncludeHandler());
-	assert(psBlob != nullptr);
-
-#pragma endregion
-
-	/// DepthStencil
-#pragma region /// DepthStencil ///
-
-	D3D12_DEPTH_STENCIL_DESC depthStencilDesc{};
-	// Depth機能を有効化する
-	depthStencilDesc.DepthEnable = true;
-	// 書き込みを行う
-	depthStencilDesc.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ALL;
-	// 比較関数はLessEqual、近ければ描画される
-	depthStencilDesc.DepthFunc = D3D12_COMPARISON_FUNC_LESS_EQUAL;
-
-#pragma endregion
-
-	/*========================================================================================================*/
-	// Pipeline State Objectの生成
-	D3D12_GRAPHICS_PIPELINE_STATE_DESC graphicsPipelineStateDesc{};
-	graphicsPipelineStateDesc.pRootSignature = pipeline->rootSignature.Get();
-	graphicsPipelineStateDesc.InputLayout = inputLayoutDesc;
-	graphicsPipelineStateDesc.VS = { vsBlob->GetBufferPointer(),vsBlob->GetBufferSize() };
-	graphicsPipelineStateDesc.PS = { psBlob->GetBufferPointer(),psBlob->GetBufferSize() };
-	graphicsPipelineStateDesc.BlendState = blendDesc;
-	graphicsPipelineStateDesc.RasterizerState = rasterizerDesc;
-	graphicsPipelineStateDesc.DepthStencilState = depthStencilDesc;
-	graphicsPipelineStateDesc.DSVFormat = DXGI_FORMAT_D24_UNORM_S8_UINT;
-
-	// 書き込むRTVの情報
-	graphicsPipelineStateDesc.NumRenderTargets = 1;
-	graphicsPipelineStateDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
-	// 利用するトポロジ(形状)のタイプ、三角形
-	graphicsPipelineStateDesc.PrimitiveTopologyType =
-		D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-	// どのように画面に色を打ち込むかの設定
-	graphicsPipelineStateDesc.SampleDesc.Count = 1;
-	graphicsPipelineStateDesc.SampleMask = D3D12_DEFAULT_SAMPLE_MASK;
-	// 実際に生成
-	pipeline->pipelineState = nullptr;
-	hr = dxCommon->GetDevice()->CreateGraphicsPipelineState(
-		&graphicsPipelineStateDesc,
-		IID_PPV_ARGS(&pipeline->pipelineState));
-	assert(SUCCEEDED(hr));
+	for (const auto& bytecode : shaderCache_.CompileAll(requests)) {
+		if (!bytecode) {
+			Log(shaderCache_.GetLastError());
+			assert(false);
+		}
+	}
 
-	return pipeline;
+	// 全てキャッシュから読めたら2回目以降の起動
+	ShaderCache::Stats stats = shaderCache_.GetStats();
+	Log(std::format("ShaderCache {}: {} shaders, {} compiled, {} loaded, {:.2f}ms\n",
+		stats.compileCount == 0 ? "warm" : "cold", requests.size(), stats.compileCount, stats.diskHitCount, stats.lastBatchTimeMs));
 }
 
 //============================================================
-// テクスチャ適応パイプライン生成
+// 設定で使うシェーダー
 //============================================================
-std::unique_ptr<PipelineObject> Pipeline::CreateTextureGraphicsPipeline() {
-
-	DirectXCommon* dxCommon = DirectXCommon::Instance();
-
-	HRESULT hr;
-
-	std::unique_ptr<PipelineObject> pipeline = std::make_unique<PipelineObject>();
-
-	ComPtr<ID3DBlob> errorBlob = nullptr; // エラー
-	ComPtr<ID3DBlob> signatureBlob = nullptr;
-
-	ComPtr<IDxcBlob> vsBlob = nullptr; // 頂点シェーダ
-	ComPtr<IDxcBlob> psBlob = nullptr; // ピクセルシェーダ
-
-	/// RootSignature
-#pragma region /// RootSignature ///
-
-	D3D12_ROOT_SIGNATURE_DESC descriptionRootSignature{};
-	descriptionRootSignature.Flags =
-		D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
-
-#pragma endregion
-
-	/// descriptorRange
-#pragma region /// descriptorRange ///
-
-	D3D12_DESCRIPTOR_RANGE descriptorRange[1] = {};
-	descriptorRange[0].BaseShaderRegister = 0;                      // 0から始まる t0
-	descriptorRange[0].NumDescriptors = 1;                          // 数は1つ
-	descriptorRange[0].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV; // SRVを使う
-	descriptorRange[0].OffsetInDescriptorsFromTableStart =
-		D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;                       // Offsetを自動計算
-
-#pragma endregion
-
-	/// rootParameter
-#pragma region /// rootParameter ///
-
-	D3D12_ROOT_PARAMETER TEXTURERootParameters[4] = {};
-	TEXTURERootParameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;      // CBVを使う
-	TEXTURERootParameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;   // PixelShaderで使う
-	TEXTURERootParameters[0].Descriptor.ShaderRegister = 0;                      // レジスタ番号0とバインド
-
-	TEXTURERootParameters[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;      // CBVを使う
-	TEXTURERootParameters[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;   // VertexShaderで使う
-	TEXTURERootParameters[1].Descriptor.ShaderRegister = 0;                      // レジスタ番号0とバインド
-
-	TEXTURERootParameters[2].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;      // DescriptorTableを使う
-	TEXTURERootParameters[2].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;                // PixelShaderで使う
-	TEXTURERootParameters[2].DescriptorTable.pDescriptorRanges = descriptorRange;             // Tableの中身の配列を指定
-	TEXTURERootParameters[2].DescriptorTable.NumDescriptorRanges = _countof(descriptorRange); // Tableで利用する数
-
-	TEXTURERootParameters[3].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;      // CBVを使う
-	TEXTURERootParameters[3].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;   // PixelShaderで使う
-	TEXTURERootParameters[3].Descriptor.ShaderRegister = 1;                      // レジスタ番号1を使う
-
-	descriptionRootSignature.pParameters = TEXTURERootParameters;                // ルートパラメータ配列へのポインタ
-	descriptionRootSignature.NumParameters = _countof(TEXTURERootParameters);    // 配列の長さ
-
-#pragma endregion
-
-	/// Sampler
-#pragma region /// Sampler ///
-
-	D3D12_STATIC_SAMPLER_DESC staticSamplers[1] = {};
-	staticSamplers[0].Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;         // バイリニアフィルタ
-	staticSamplers[0].AddressU = D3D12_TEXTURE_ADDRESS_MODE_WRAP;       // 0~1の範囲外をリピート
-	staticSamplers[0].AddressV = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
-	staticSamplers[0].AddressW = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
-	staticSamplers[0].ComparisonFunc = D3D12_COMPARISON_FUNC_NEVER;
-	staticSamplers[0].MaxLOD = D3D12_FLOAT32_MAX;                       // ありったけのMipMapを使う
-	staticSamplers[0].ShaderRegister = 0;                               // レジスタ番号0を使う
-	staticSamplers[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL; // PixelShaderで使う
-	descriptionRootSignature.pStaticSamplers = staticSamplers;
-	descriptionRootSignature.NumStaticSamplers = _countof(staticSamplers);
-
-#pragma endregion
-
-	/// InputLayout
-#pragma region /// InputLayout ///
-
-	D3D12_INPUT_ELEMENT_DESC inputElementDescs[3] = {};
-	inputElementDescs[0].SemanticName = "POSITION";
-	inputElementDescs[0].SemanticIndex = 0;
-	inputElementDescs[0].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	inputElementDescs[0].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
-	inputElementDescs[1].SemanticName = "TEXCOORD";
-	inputElementDescs[1].SemanticIndex = 0;
-	inputElementDescs[1].Format = DXGI_FORMAT_R32G32_FLOAT;
-	inputElementDescs[1].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
-	inputElementDescs[2].SemanticName = "NORMAL";
-	inputElementDescs[2].SemanticIndex = 0;
-	inputElementDescs[2].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	inputElementDescs[2].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
-	D3D12_INPUT_LAYOUT_DESC inputLayoutDesc{};
-	inputLayoutDesc.pInputElementDescs = inputElementDescs;
-	inputLayoutDesc.NumElements = _countof(inputElementDescs);
-
-#pragma endregion
+ShaderRequest Pipeline::MakeShaderRequest(const PipelineDesc& desc, bool isVertexShader) const {
+
+	ShaderRequest request{};
+	request.path = "./Resources/Shaders/" + desc.shader + (isVertexShader ? ".VS.hlsl" : ".PS.hlsl");
+	request.entry = L"main";                                // 基本的にmain以外にはしない
+	request.profile = isVertexShader ? L"vs_6_0" : L"ps_6_0";
+	request.arguments = {
+		L"-O3",                    // 最適化する
+		L"-Zpr",                   // メモリレイアウトは行優先
+#ifdef _DEBUG
+		L"-Zi",L"-Qembed_debug",   // デバッグ用の情報を埋め込む
+#endif
+	};
 
-	/// バイナリをもとに生成
-#pragma region /// バイナリをもとに生成 rootSignature　///
+	return request;
+}
 
-	hr = D3D12SerializeRootSignature(&descriptionRootSignature,
-		D3D_ROOT_SIGNATURE_VERSION_1, &signatureBlob, &errorBlob);
-	if (FAILED(hr)) {
+//============================================================
+// シェーダーの取得
+//============================================================
+ShaderBytecode Pipeline::GetShader(const ShaderRequest& request) {
 
-		Log(reinterpret_cast<char*>(errorBlob->GetBufferPointer()));
+	// Initializeで用意済みならメモリから返る
+	ShaderBytecode bytecode = shaderCache_.Get(request);
+	if (!bytecode) {
+		Log(shaderCache_.GetLastError());
 		assert(false);
 	}
 
-	hr = dxCommon->GetDevice()->CreateRootSignature(0, signatureBlob->GetBufferPointer(),
-		signatureBlob->GetBufferSize(), IID_PPV_ARGS(&pipeline->rootSignature));
-	assert(SUCCEEDED(hr));
-
-#pragma endregion
-
-	/// BlendState
-#pragma region /// BlendState ///
-
-	D3D12_BLEND_DESC blendDesc{};
-	// 全ての色要素を書き込む
-	// ブレンドモードNone D3D12_COLOR_WRITE_ENABLE_ALLだけ
-	blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
-	blendDesc.RenderTarget[0].BlendEnable = TRUE;
-	blendDesc.RenderTarget[0].SrcBlend = D3D12_BLEND_SRC_ALPHA;
-	blendDesc.RenderTarget[0].BlendOp = D3D12_BLEND_OP_ADD;
-	blendDesc.RenderTarget[0].DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
-	blendDesc.RenderTarget[0].SrcBlendAlpha = D3D12_BLEND_ONE;
-	blendDesc.RenderTarget[0].BlendOpAlpha = D3D12_BLEND_OP_ADD;
-	blendDesc.RenderTarget[0].DestBlendAlpha = D3D12_BLEND_ZERO;
-
-#pragma endregion
-
-	/// RasterizerState
-#pragma region /// RasterizerState ///
-
-	D3D12_RASTERIZER_DESC rasterizerDesc{};
-	// 裏面(時計周り)を表示しない、背面カリング
-	rasterizerDesc.CullMode = D3D12_CULL_MODE_BACK;
-	//三角形の中を塗りつぶす
-	rasterizerDesc.FillMode = D3D12_FILL_MODE_SOLID;
-
-#pragma endregion
-
-	/// ShaderComplie
-#pragma region /// ShaderComplie ///
-
-	// 頂点シェーダ
-	vsBlob =
-		CompileShader(L"./Resources/Shaders/Object3d.VS.hlsl", L"vs_6_0",
-			dxCommon->GetDxcUtils(), dxCommon->GetDxcCompiler(), dxCommon->GetIncludeHandler());
-	assert(vsBlob != nullptr);
-
-	// ピクセルシェーダ
-	psBlob =
-		CompileShader(L"./Resources/Shaders/Object3d.PS.hlsl", L"ps_6_0",
-			dxCommon->GetDxcUtils(), dxCommon->GetDxcCompiler(), dxCommon->GetIncludeHandler());
-	assert(psBlob != nullptr);
-
-#pragma endregion
-
-	/// DepthStencil
-#pragma region /// DepthStencil ///
-
-	D3D12_DEPTH_STENCIL_DESC depthStencilDesc{};
-	// Depth機能を有効化する
-	depthStencilDesc.DepthEnable = true;
-	// 書き込みを行う
-	depthStencilDesc.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ALL;
-	// 比較関数はLessEqual、近ければ描画される
-	depthStencilDesc.DepthFunc = D3D12_COMPARISON_FUNC_LESS_EQUAL;
-
-#pragma endregion
-
-	/*========================================================================================================*/
-	// Pipeline State Objectの生成
-	D3D12_GRAPHICS_PIPELINE_STATE_DESC graphicsPipelineStateDesc{};
-	graphicsPipelineStateDesc.pRootSignature = pipeline->rootSignature.Get();
-	graphicsPipelineStateDesc.InputLayout = inputLayoutDesc;
-	graphicsPipelineStateDesc.VS = { vsBlob->GetBufferPointer(),vsBlob->GetBufferSize() };
-	graphicsPipelineStateDesc.PS = { psBlob->GetBufferPointer(),psBlob->GetBufferSize() };
-	graphicsPipelineStateDesc.BlendState = blendDesc;
-	graphicsPipelineStateDesc.RasterizerState = rasterizerDesc;
-	graphicsPipelineStateDesc.DepthStencilState = depthStencilDesc;
-	graphicsPipelineStateDesc.DSVFormat = DXGI_FORMAT_D24_UNORM_S8_UINT;
-
-	// 書き込むRTVの情報
-	graphicsPipelineStateDesc.NumRenderTargets = 1;
-	graphicsPipelineStateDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
-	// 利用するトポロジ(形状)のタイプ、三角形
-	graphicsPipelineStateDesc.PrimitiveTopologyType =
-		D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-	// どのように画面に色を打ち込むかの設定
-	graphicsPipelineStateDesc.SampleDesc.Count = 1;
-	graphicsPipelineStateDesc.SampleMask = D3D12_DEFAULT_SAMPLE_MASK;
-	// 実際に生成
-	pipeline->pipelineState = nullptr;
-	hr = dxCommon->GetDevice()->CreateGraphicsPipelineState(
-		&graphicsPipelineStateDesc,
-		IID_PPV_ARGS(&pipeline->pipelineState));
-	assert(SUCCEEDED(hr));
-
-	return pipeline;
+	return bytecode;
 }
 
 //============================================================
-// BlinnPhong反射適応パイプライン生成
+// 設定からパイプライン生成
 //============================================================
-std::unique_ptr<PipelineObject> Pipeline::CreateBlinnPhongGraphicsPipeline() {
+void* Pipeline::CreatePipeline(const PipelineDesc& desc) {
 
 	DirectXCommon* dxCommon = DirectXCommon::Instance();
 
@@ -478,8 +321,8 @@ std::unique_ptr<PipelineObject> Pipeline::CreateBlinnPhongGraphicsPipeline() {
 	ComPtr<ID3DBlob> errorBlob = nullptr; // エラー
 	ComPtr<ID3DBlob> signatureBlob = nullptr;
 
-	ComPtr<IDxcBlob> vsBlob = nullptr; // 頂点シェーダ
-	ComPtr<IDxcBlob> psBlob = nullptr; // ピクセルシェーダ
+	ShaderBytecode vsBlob = nullptr; // 頂点シェーダ
+	ShaderBytecode psBlob = nullptr; // ピクセルシェーダ
 
 	/// RootSignature
 #pragma region /// RootSignature ///
@@ -488,47 +331,63 @@ std::unique_ptr<PipelineObject> Pipeline::CreateBlinnPhongGraphicsPipeline() {
 	descriptionRootSignature.Flags =
 		D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
 
-#pragma endregion
-
-	/// descriptorRange
-#pragma region /// descriptorRange ///
-
-	D3D12_DESCRIPTOR_RANGE descriptorRange[1] = {};
-	descriptorRange[0].BaseShaderRegister = 0;                      // 0から始まる t0
-	descriptorRange[0].NumDescriptors = 1;                          // 数は1つ
-	descriptorRange[0].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV; // SRVを使う
-	descriptorRange[0].OffsetInDescriptorsFromTableStart =
-		D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;                       // Offsetを自動計算
-
 #pragma endregion
 
 	/// rootParameter
 #pragma region /// rootParameter ///
 
-	D3D12_ROOT_PARAMETER rootParameters[5] = {};
-	rootParameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;      // CBVを使う
-	rootParameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;   // PixelShaderで使う
-	rootParameters[0].Descriptor.ShaderRegister = 0;                      // レジスタ番号0とバインド
-
-	rootParameters[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;      // CBVを使う
-	rootParameters[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;   // VertexShaderで使う
-	rootParameters[1].Descriptor.ShaderRegister = 0;                      // レジスタ番号0とバインド
-
-	rootParameters[2].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;      // DescriptorTableを使う
-	rootParameters[2].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;                // PixelShaderで使う
-	rootParameters[2].DescriptorTable.pDescriptorRanges = descriptorRange;             // Tableの中身の配列を指定
-	rootParameters[2].DescriptorTable.NumDescriptorRanges = _countof(descriptorRange); // Tableで利用する数
-
-	rootParameters[3].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;      // CBVを使う
-	rootParameters[3].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;   // PixelShaderで使う
-	rootParameters[3].Descriptor.ShaderRegister = 1;                      // レジスタ番号1を使う
-
-	rootParameters[4].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;      // CBVを使う
-	rootParameters[4].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;   // PixelShaderで使う
-	rootParameters[4].Descriptor.ShaderRegister = 2;                      // レジスタ番号2を使う
+	const PipelineRootLayout& rootLayout = desc.rootLayout;
+
+	// テーブルの中身はパラメータごとに1つ
+	D3D12_DESCRIPTOR_RANGE descriptorRanges[PipelineRootLayout::kMaxRootParameterNum] = {};
+	D3D12_ROOT_PARAMETER rootParameters[PipelineRootLayout::kMaxRootParameterNum] = {};
+
+	for (uint32_t i = 0; i < rootLayout.parameterCount; ++i) {
+
+		const PipelineRootParameter& source = rootLayout.parameters[i];
+
+		switch (source.visibility) {
+		case PipelineShaderVisibility::ALL:
+			rootParameters[i].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+			break;
+		case PipelineShaderVisibility::VERTEX:
+			rootParameters[i].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+			break;
+		case PipelineShaderVisibility::PIXEL:
+			rootParameters[i].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+			break;
+		}
+
+		switch (source.type) {
+		case PipelineRootParameterType::CONSTANTBUFFER:
+
+			rootParameters[i].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
+			rootParameters[i].Descriptor.ShaderRegister = source.shaderRegister;
+			rootParameters[i].Descriptor.RegisterSpace = source.registerSpace;
+			break;
+		case PipelineRootParameterType::SHADERRESOURCE:
+
+			rootParameters[i].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+			rootParameters[i].Descriptor.ShaderRegister = source.shaderRegister;
+			rootParameters[i].Descriptor.RegisterSpace = source.registerSpace;
+			break;
+		case PipelineRootParameterType::DESCRIPTORTABLE:
+
+			descriptorRanges[i].BaseShaderRegister = source.shaderRegister;
+			descriptorRanges[i].NumDescriptors = source.descriptorCount == ~0u ? UINT_MAX : source.descriptorCount;
+			descriptorRanges[i].RegisterSpace = source.registerSpace;
+			descriptorRanges[i].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+			descriptorRanges[i].OffsetInDescriptorsFromTableStart = 0;
+
+			rootParameters[i].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+			rootParameters[i].DescriptorTable.pDescriptorRanges = &descriptorRanges[i];
+			rootParameters[i].DescriptorTable.NumDescriptorRanges = 1;
+			break;
+		}
+	}
 
-	descriptionRootSignature.pParameters = rootParameters;                // ルートパラメータ配列へのポインタ
-	descriptionRootSignature.NumParameters = _countof(rootParameters);    // 配列の長さ
+	descriptionRootSignature.pParameters = rootParameters;                   // ルートパラメータ配列へのポインタ
+	descriptionRootSignature.NumParameters = rootLayout.parameterCount;      // 配列の長さ
 
 #pragma endregion
 
@@ -544,8 +403,11 @@ std::unique_ptr<PipelineObject> Pipeline::CreateBlinnPhongGraphicsPipeline() {
 	staticSamplers[0].MaxLOD = D3D12_FLOAT32_MAX;                       // ありったけのMipMapを使う
 	staticSamplers[0].ShaderRegister = 0;                               // レジスタ番号0を使う
 	staticSamplers[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL; // PixelShaderで使う
-	descriptionRootSignature.pStaticSamplers = staticSamplers;
-	descriptionRootSignature.NumStaticSamplers = _countof(staticSamplers);
+
+	if (rootLayout.useSampler) {
+		descriptionRootSignature.pStaticSamplers = staticSamplers;
+		descriptionRootSignature.NumStaticSamplers = _countof(staticSamplers);
+	}
 
 #pragma endregion
 
@@ -553,21 +415,30 @@ std::unique_ptr<PipelineObject> Pipeline::CreateBlinnPhongGraphicsPipeline() {
 #pragma region /// InputLayout ///
 
 	D3D12_INPUT_ELEMENT_DESC inputElementDescs[3] = {};
-	inputElementDescs[0].SemanticName = "POSITION";
-	inputElementDescs[0].SemanticIndex = 0;
-	inputElementDescs[0].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	inputElementDescs[0].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
-	inputElementDescs[1].SemanticName = "TEXCOORD";
-	inputElementDescs[1].SemanticIndex = 0;
-	inputElementDescs[1].Format = DXGI_FORMAT_R32G32_FLOAT;
-	inputElementDescs[1].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
-	inputElementDescs[2].SemanticName = "NORMAL";
-	inputElementDescs[2].SemanticIndex = 0;
-	inputElementDescs[2].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	inputElementDescs[2].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+	UINT inputElementCount = 0;
+
+	if (desc.inputElements & PIPELINE_INPUT_POSITION) {
+		inputElementDescs[inputElementCount].SemanticName = "POSITION";
+		inputElementDescs[inputElementCount].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+		inputElementDescs[inputElementCount].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+		inputElementCount++;
+	}
+	if (desc.inputElements & PIPELINE_INPUT_TEXCOORD) {
+		inputElementDescs[inputElementCount].SemanticName = "TEXCOORD";
+		inputElementDescs[inputElementCount].Format = DXGI_FORMAT_R32G32_FLOAT;
+		inputElementDescs[inputElementCount].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+		inputElementCount++;
+	}
+	if (desc.inputElements & PIPELINE_INPUT_NORMAL) {
+		inputElementDescs[inputElementCount].SemanticName = "NORMAL";
+		inputElementDescs[inputElementCount].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+		inputElementDescs[inputElementCount].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+		inputElementCount++;
+	}
+
 	D3D12_INPUT_LAYOUT_DESC inputLayoutDesc{};
 	inputLayoutDesc.pInputElementDescs = inputElementDescs;
-	inputLayoutDesc.NumElements = _countof(inputElementDescs);
+	inputLayoutDesc.NumElements = inputElementCount;
 
 #pragma endregion
 
@@ -593,12 +464,31 @@ std::unique_ptr<PipelineObject> Pipeline::CreateBlinnPhongGraphicsPipeline() {
 
 	D3D12_BLEND_DESC blendDesc{};
 	// 全ての色要素を書き込む
-	// ブレンドモードNone D3D12_COLOR_WRITE_ENABLE_ALLだけ
 	blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
-	blendDesc.RenderTarget[0].BlendEnable = TRUE;
-	blendDesc.RenderTarget[0].SrcBlend = D3D12_BLEND_SRC_ALPHA;
-	blendDesc.RenderTarget[0].BlendOp = D3D12_BLEND_OP_ADD;
-	blendDesc.RenderTarget[0].DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+
+	switch (desc.blendMode) {
+	case PipelineBlendMode::NONE:
+
+		// ブレンドモードNone D3D12_COLOR_WRITE_ENABLE_ALLだけ
+		blendDesc.RenderTarget[0].BlendEnable = FALSE;
+		break;
+	case PipelineBlendMode::ALPHA:
+
+		blendDesc.RenderTarget[0].BlendEnable = TRUE;
+		blendDesc.RenderTarget[0].SrcBlend = D3D12_BLEND_SRC_ALPHA;
+		blendDesc.RenderTarget[0].BlendOp = D3D12_BLEND_OP_ADD;
+		blendDesc.RenderTarget[0].DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+		break;
+	case PipelineBlendMode::ADD:
+
+		blendDesc.RenderTarget[0].BlendEnable = TRUE;
+		blendDesc.RenderTarget[0].SrcBlend = D3D12_BLEND_SRC_ALPHA;
+		blendDesc.RenderTarget[0].BlendOp = D3D12_BLEND_OP_ADD;
+		blendDesc.RenderTarget[0].DestBlend = D3D12_BLEND_ONE;
+		break;
+	}
+
+	// αは元の値をそのまま使う
 	blendDesc.RenderTarget[0].SrcBlendAlpha = D3D12_BLEND_ONE;
 	blendDesc.RenderTarget[0].BlendOpAlpha = D3D12_BLEND_OP_ADD;
 	blendDesc.RenderTarget[0].DestBlendAlpha = D3D12_BLEND_ZERO;
@@ -609,8 +499,18 @@ std::unique_ptr<PipelineObject> Pipeline::CreateBlinnPhongGraphicsPipeline() {
 #pragma region /// RasterizerState ///
 
 	D3D12_RASTERIZER_DESC rasterizerDesc{};
-	// 裏面(時計周り)を表示しない、背面カリング
-	rasterizerDesc.CullMode = D3D12_CULL_MODE_BACK;
+	switch (desc.cullMode) {
+	case PipelineCullMode::NONE:
+		rasterizerDesc.CullMode = D3D12_CULL_MODE_NONE;
+		break;
+	case PipelineCullMode::FRONT:
+		rasterizerDesc.CullMode = D3D12_CULL_MODE_FRONT;
+		break;
+	case PipelineCullMode::BACK:
+		// 裏面(時計周り)を表示しない、背面カリング
+		rasterizerDesc.CullMode = D3D12_CULL_MODE_BACK;
+		break;
+	}
 	//三角形の中を塗りつぶす
 	rasterizerDesc.FillMode = D3D12_FILL_MODE_SOLID;
 
@@ -620,15 +520,11 @@ std::unique_ptr<PipelineObject> Pipeline::CreateBlinnPhongGraphicsPipeline() {
 #pragma region /// ShaderComplie ///
 
 	// 頂点シェーダ
-	vsBlob =
-		CompileShader(L"./Resources/Shaders/BlinnPhong.VS.hlsl", L"vs_6_0",
-			dxCommon->GetDxcUtils(), dxCommon->GetDxcCompiler(), dxCommon->GetIncludeHandler());
+	vsBlob = GetShader(MakeShaderRequest(desc, true));
 	assert(vsBlob != nullptr);
 
 	// ピクセルシェーダ
-	psBlob =
-		CompileShader(L"./Resources/Shaders/BlinnPhong.PS.hlsl", L"ps_6_0",
-			dxCommon->GetDxcUtils(), dxCommon->GetDxcCompiler(), dxCommon->GetIncludeHandler());
+	psBlob = GetShader(MakeShaderRequest(desc, false));
 	assert(psBlob != nullptr);
 
 #pragma endregion
@@ -639,8 +535,8 @@ std::unique_ptr<PipelineObject> Pipeline::CreateBlinnPhongGraphicsPipeline() {
 	D3D12_DEPTH_STENCIL_DESC depthStencilDesc{};
 	// Depth機能を有効化する
 	depthStencilDesc.DepthEnable = true;
-	// 書き込みを行う
-	depthStencilDesc.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ALL;
+	// 書き込みを行うか
+	depthStencilDesc.DepthWriteMask = desc.depthWrite ? D3D12_DEPTH_WRITE_MASK_ALL : D3D12_DEPTH_WRITE_MASK_ZERO;
 	// 比較関数はLessEqual、近ければ描画される
 	depthStencilDesc.DepthFunc = D3D12_COMPARISON_FUNC_LESS_EQUAL;
 
@@ -651,16 +547,16 @@ std::unique_ptr<PipelineObject> Pipeline::CreateBlinnPhongGraphicsPipeline() {
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC graphicsPipelineStateDesc{};
 	graphicsPipelineStateDesc.pRootSignature = pipeline->rootSignature.Get();
 	graphicsPipelineStateDesc.InputLayout = inputLayoutDesc;
-	graphicsPipelineStateDesc.VS = { vsBlob->GetBufferPointer(),vsBlob->GetBufferSize() };
-	graphicsPipelineStateDesc.PS = { psBlob->GetBufferPointer(),psBlob->GetBufferSize() };
+	graphicsPipelineStateDesc.VS = { vsBlob->data(),vsBlob->size() };
+	graphicsPipelineStateDesc.PS = { psBlob->data(),psBlob->size() };
 	graphicsPipelineStateDesc.BlendState = blendDesc;
 	graphicsPipelineStateDesc.RasterizerState = rasterizerDesc;
 	graphicsPipelineStateDesc.DepthStencilState = depthStencilDesc;
-	graphicsPipelineStateDesc.DSVFormat = DXGI_FORMAT_D24_UNORM_S8_UINT;
+	graphicsPipelineStateDesc.DSVFormat = static_cast<DXGI_FORMAT>(desc.depthStencilFormat);
 
 	// 書き込むRTVの情報
 	graphicsPipelineStateDesc.NumRenderTargets = 1;
-	graphicsPipelineStateDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+	graphicsPipelineStateDesc.RTVFormats[0] = static_cast<DXGI_FORMAT>(desc.renderTargetFormat);
 	// 利用するトポロジ(形状)のタイプ、三角形
 	graphicsPipelineStateDesc.PrimitiveTopologyType =
 		D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
@@ -674,15 +570,14 @@ std::unique_ptr<PipelineObject> Pipeline::CreateBlinnPhongGraphicsPipeline() {
 		IID_PPV_ARGS(&pipeline->pipelineState));
 	assert(SUCCEEDED(hr));
 
-	return pipeline;
+	// 破棄はDestroyPipelineで行う
+	return pipeline.release();
 }
 
 //============================================================
-// パイプライン各種生成
+// パイプラインの破棄
 //============================================================
-void Pipeline::CreateGraphicsPipelines() {
+void Pipeline::DestroyPipeline(void* pipeline) {
 
-	pipelines_[static_cast<size_t>(PipelineType::PRIMITIVE)] = CreatePrimitiveGraphicsPipeline();
-	pipelines_[static_cast<size_t>(PipelineType::TEXTURE)] = CreateTextureGraphicsPipeline();
-	pipelines_[static_cast<size_t>(PipelineType::BLINNPHONG)] = CreateBlinnPhongGraphicsPipeline();
+	delete static_cast<PipelineObject*>(pipeline);
 }
\ No newline at end of file
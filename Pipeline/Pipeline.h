@@ -10,13 +10,16 @@
 
 #include "Logger.h"
 #include "ComPtr.h"
+#include "PipelineCache.h"
+#include "ShaderCache.h"
 
-// パイプラインの種類
+// パイプラインの種類、Pipelineに登録した順の番号
 enum class PipelineType {
 
 	PRIMITIVE,    // 単色 テクスチャを使用しない
 	TEXTURE,     // テクスチャを使う
 	BLINNPHONG,  // BlinnPhong反射 テクスチャ付き
+	INSTANCED,   // BlinnPhong反射 インスタンシング描画
 };
 
 // パイプライン
@@ -29,47 +32,151 @@ struct PipelineObject {
 };
 
 // パイプラインの種類の数
-static inline const uint32_t pipelineNum = 3;
+static inline const uint32_t pipelineNum = 4;
+
+/*-----------------------------------------------------------------------------------------*/
+/// パイプラインごとのルートパラメータの番号
+/// 描画側はDispatchPipelineで受け取り、使わないものはif constexprで消える
+
+// 単色
+struct PrimitivePipeline {
+
+	static constexpr PipelineType kType = PipelineType::PRIMITIVE;
+
+	static constexpr uint32_t kMaterial = 0;
+	static constexpr uint32_t kTransform = 1;
+
+	static constexpr bool kUseTexture = false;
+	static constexpr bool kUseLight = false;
+	static constexpr bool kUseCamera = false;
+
+	static PipelineDesc MakeDesc();
+};
+
+// テクスチャ
+struct TexturePipeline {
+
+	static constexpr PipelineType kType = PipelineType::TEXTURE;
+
+	static constexpr uint32_t kMaterial = 0;
+	static constexpr uint32_t kTransform = 1;
+	static constexpr uint32_t kTexture = 2;
+	static constexpr uint32_t kLight = 3;
+
+	static constexpr bool kUseTexture = true;
+	static constexpr bool kUseLight = true;
+	static constexpr bool kUseCamera = false;
+
+	static PipelineDesc MakeDesc();
+};
+
+// BlinnPhong反射
+struct BlinnPhongPipeline {
+
+	static constexpr PipelineType kType = PipelineType::BLINNPHONG;
+
+	static constexpr uint32_t kMaterial = 0;
+	static constexpr uint32_t kTransform = 1;
+	static constexpr uint32_t kTexture = 2;
+	static constexpr uint32_t kLight = 3;
+	static constexpr uint32_t kCamera = 4;
+
+	static constexpr bool kUseTexture = true;
+	static constexpr bool kUseLight = true;
+	static constexpr bool kUseCamera = true;
+
+	static PipelineDesc MakeDesc();
+};
+
+// インスタンシング
+struct InstancedPipeline {
+
+	static constexpr PipelineType kType = PipelineType::INSTANCED;
+
+	static constexpr uint32_t kInstances = 0;
+	static constexpr uint32_t kTextures = 1;
+	static constexpr uint32_t kLight = 2;
+	static constexpr uint32_t kCamera = 3;
+
+	static PipelineDesc MakeDesc();
+};
+
+// 実行時のPipelineTypeから、パイプラインごとの型でfunctionを呼ぶ
+template<class Function>
+void DispatchPipeline(PipelineType pipelineType, Function&& function) {
+
+	switch (pipelineType) {
+	case PipelineType::PRIMITIVE:
+		function(PrimitivePipeline{});
+		break;
+	case PipelineType::TEXTURE:
+		function(TexturePipeline{});
+		break;
+	case PipelineType::BLINNPHONG:
+		function(BlinnPhongPipeline{});
+		break;
+	case PipelineType::INSTANCED:
+		function(InstancedPipeline{});
+		break;
+	}
+}
 
 //================================================
 // Pipeline Class
 //================================================
 /// PSO
-class Pipeline {
+/// 設定を登録しておき、初めて使うときにルートシグネチャとPSOを生成する
+class Pipeline : public IPipelineFactory {
 public:
 	//====================
 	// public
 	//====================
 
-	// パイプライン各種生成
-	void CreateGraphicsPipelines();
+	Pipeline() = default;
+	~Pipeline() override;
+
+	// PipelineTypeのパイプラインを登録する、生成は使うときに行う
+	void Initialize();
+
+	// 登録したパイプラインのシェーダーをまとめて用意する。キャッシュになければ並列でコンパイルする
+	// GPUは触らないのでワーカースレッドから呼べる
+	void CompileShaders();
+
+	// パイプラインの設定の登録、同じ設定なら同じ番号を返す
+	PipelineId Register(const PipelineDesc& desc) { return cache_.Register(desc); }
+
+	// パイプラインの取得、初めてなら生成する。並列記録の各スレッドから呼べる
+	const PipelineObject* Get(PipelineId id) { return static_cast<const PipelineObject*>(cache_.Get(id)); }
+
+	// 登録済みのものを全て生成しておく、CompileShadersの後ならワーカースレッドから呼べる
+	void CreateAll() { cache_.CreateAll(); }
 
 	// getter
 
-	const std::array<std::unique_ptr<PipelineObject>, pipelineNum>& GetPipelines() const { return pipelines_; }
+	PipelineCache::Stats GetStats() const { return cache_.GetStats(); }
+	ShaderCache::Stats GetShaderStats() const { return shaderCache_.GetStats(); }
 
 private:
 	//====================
 	// private
 	//====================
 
-	// 各パイプライン
-	std::array<std::unique_ptr<PipelineObject>, pipelineNum> pipelines_;
-
-	// パイプライン生成
-	std::unique_ptr<PipelineObject> CreatePrimitiveGraphicsPipeline();
-	std::unique_ptr<PipelineObject> CreateTextureGraphicsPipeline();
-	std::unique_ptr<PipelineObject> CreateBlinnPhongGraphicsPipeline();
-
-	// シェーダのコンパイル
-	ComPtr<IDxcBlob> CompileShader(
-		// CompilerするShaderファイルへのパス
-		const std::wstring& filePath,
-		// Compilerに使用するProfile
-		const wchar_t* profile,
-		// 初期化で生成したものを3つ
-		IDxcUtils* dxcUtils,
-		IDxcCompiler3* dxcCompiler,
-		IDxcIncludeHandler* includeHandler
-	);
+	// コンパイル結果の保存先
+	static inline const char* kShaderCacheDirectory = "./ShaderCache";
+
+	// 設定とパイプライン
+	PipelineCache cache_;
+
+	// シェーダーのバイナリ、DXCでコンパイルしてディスクに残す
+	std::unique_ptr<IShaderCompiler> shaderCompiler_;
+	ShaderCache shaderCache_;
+
+	// 設定からルートシグネチャとPSOを生成する
+	void* CreatePipeline(const PipelineDesc& desc) override;
+	void DestroyPipeline(void* pipeline) override;
+
+	// 設定で使うシェーダー
+	ShaderRequest MakeShaderRequest(const PipelineDesc& desc, bool isVertexShader) const;
+	// シェーダーの取得、失敗したらエラーを出して止める
+	ShaderBytecode GetShader(const ShaderRequest& request);
 };
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "Object3dInstanced.hlsli"
+
+//================================================
+// Instancing PS Shader BlinnPhong
+//================================================
+
+// 共有SRVヒープ全体、インスタンスのtextureIndexで選ぶ
+Texture2D<float4> gTextures[] : register(t0, space1);
+SamplerState gSampler : register(s0);
+
+struct DirectionalLight
+{
+    float4 color;
+    float3 direction;
+    float intensity;
+};
+
+struct Camera
+{
+    float3 position;
+    float padding;
+};
+
+ConstantBuffer<DirectionalLight> gDirectionalLight : register(b1);
+ConstantBuffer<Camera> gCamera : register(b2);
+
+static const float4 SpecularColor = float4(1.0f, 1.0f, 1.0f, 1.0f);
+static const float SpecularPower = 64.0f;
+
+struct PixelShaderOutput
+{
+    float4 color : SV_TARGET0;
+};
+
+PixelShaderOutput main(InstancedVertexShaderOutput input)
+{
+    InstanceData instance = gInstances[input.instanceId];
+    
+    float4 transformedUV = mul(float4(input.texcoord, 0.0f, 1.0f), instance.uvTransform);
+    float4 textureColor = gTextures[NonUniformResourceIndex(instance.textureIndex)].Sample(gSampler, transformedUV.xy);
+
+    PixelShaderOutput output;
+
+    if (instance.enableLighting != 0)
+    {
+        float3 normal = normalize(input.normal);
+        float3 lightDir = normalize(-gDirectionalLight.direction);
+        float3 viewDir = normalize(gCamera.position - input.worldPosition);
+
+        // 拡散反射 (Diffuse)
+        float NdotL = saturate(dot(normal, lightDir));
+
+        // ハーフベクトルの計算
+        float3 halfVector = normalize(lightDir + viewDir);
+        float NdotH = saturate(dot(normal, halfVector));
+
+        // スペキュラ反射の計算
+        float spec = pow(NdotH, SpecularPower);
+
+        // ライト計算
+        float3 diffuse =
+        instance.color.rgb * textureColor.xyz * gDirectionalLight.color.rgb * gDirectionalLight.intensity * NdotL;
+        
+        float3 specular =
+        SpecularColor.rgb * spec * gDirectionalLight.intensity * gDirectionalLight.color.rgb;
+
+        output.color.rgb = diffuse + specular;
+        
+        output.color.a = instance.color.a * textureColor.a;
+    }
+    else
+    {
+        output.color = instance.color * textureColor;
+    }
+
+    return output;
+}
\ No newline at end of file
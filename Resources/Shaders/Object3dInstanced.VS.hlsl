@@ -0,0 +1,27 @@
+#include "Object3dInstanced.hlsli"
+
+//================================================
+// Instancing VS Shader
+//================================================
+
+struct VertexShaderInput
+{
+    float4 position : POSITION0;
+    float2 texcoord : TEXCOORD0;
+    float3 normal : NORMAL0;
+};
+
+InstancedVertexShaderOutput main(VertexShaderInput input, uint instanceId : SV_InstanceID)
+{
+    InstancedVertexShaderOutput output;
+    
+    InstanceData instance = gInstances[instanceId];
+    
+    output.texcoord = input.texcoord;
+    output.position = mul(input.position, instance.WVP);
+    output.worldPosition = mul(input.position, instance.World).xyz;
+    output.normal = normalize(mul(input.normal, (float3x3) instance.World));
+    output.instanceId = instanceId;
+    
+    return output;
+}
\ No newline at end of file
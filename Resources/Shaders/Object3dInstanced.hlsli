@@ -0,0 +1,25 @@
+//================================================
+// Instancing 共通定義
+//================================================
+
+struct InstanceData
+{
+    float4x4 WVP;
+    float4x4 World;
+    float4 color;
+    int enableLighting;
+    uint textureIndex; // 共有SRVヒープ内の番号
+    float2 padding;
+    float4x4 uvTransform;
+};
+
+StructuredBuffer<InstanceData> gInstances : register(t1);
+
+struct InstancedVertexShaderOutput
+{
+    float4 position : SV_POSITION;
+    float3 worldPosition : POSITION0;
+    float2 texcoord : TEXCOORD0;
+    float3 normal : NORMAL0;
+    nointerpolation uint instanceId : INSTANCEID0;
+};
\ No newline at end of file
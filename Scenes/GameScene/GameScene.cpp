@@ -12,22 +12,6 @@ GameScene::GameScene() {
 
 	// 生成
 	openCV_ = std::make_unique<OpenCV>();
-
-	/*======================================================*/
-	// OpenSSL SHA256 ハッシュ
-
-	// 生成
-	sha_.resize(static_cast<size_t>(SHA256::HAJIKI_TYPE::TYPENUM));
-
-	for (int i = 0; i < sha_.size(); i++) {
-
-		sha_[i] = std::make_unique<SHA256>();
-	}
-
-	// 各HAJIKI_TYPEを設定
-	sha_[0]->SetType({ SHA256::HAJIKI_TYPE::NORMAL });
-	sha_[1]->SetType({ SHA256::HAJIKI_TYPE::FEATHER });
-	sha_[2]->SetType({ SHA256::HAJIKI_TYPE::HEAVY });
 }
 
 //============================================================
@@ -38,7 +22,6 @@ GameScene::~GameScene() {
 	// 解放
 	openCV_->Finalize();
 	openCV_.reset();
-	sha_.clear();
 }
 
 //============================================================
@@ -60,13 +43,17 @@ void GameScene::Update() {
 	/*======================================================*/
 	// IｍGui
 
+	// シーンで計算したハッシュの数、メインスレッドの分だけを数えるのでワーカースレッドの読み込みは含まない
+	uint64_t hashCountBegin = SHA256Hasher::GetThreadHashCount();
+
 	ImGui::Begin("Hash Type");
 
-	for (const auto& sha : sha_) {
+	for (const auto& entry : HashRegistry::GetEntries()) {
 
 		// それぞれのタイプのハッシュ値の出力
-		ImGui::Text("Type: %s, Hash: %s", sha->GetTypeName().c_str(), sha->GetTypeHash().c_str());
+		ImGui::Text("Type: %s, Hash: %s", entry.name, entry.hex.data());
 	}
+	ImGui::Text("Hashes per frame: %llu", static_cast<unsigned long long>(frameHashCount_));
 
 	ImGui::End();
 
@@ -76,37 +63,43 @@ void GameScene::Update() {
 	std::string qrCodeData = openCV_->GetQRCodeData();
 	if (!qrCodeData.empty()) {
 		// すでに同じタイプのものがあるかどうかをチェック
-		if (std::find(keepQRCodeData_.begin(), keepQRCodeData_.end(), qrCodeData) == keepQRCodeData_.end()) {
+		auto it = std::find_if(keepQRCodeData_.begin(), keepQRCodeData_.end(),
+			[&](const QRCode& qrCode) { return qrCode.data == qrCodeData; });
+		if (it == keepQRCodeData_.end()) {
 
-			keepQRCodeData_.push_back(qrCodeData);
+			// 種類は追加したときに1度だけ引く
+			const HashRegistry::Entry* entry = HashRegistry::Find(qrCodeData);
+			keepQRCodeData_.push_back({ std::move(qrCodeData), entry });
 		}
 	}
+	frameHashCount_ = SHA256Hasher::GetThreadHashCount() - hashCountBegin;
 
 	// QRコードの値を表示
-	for (const auto& data : keepQRCodeData_) {
+	for (const auto& qrCode : keepQRCodeData_) {
 
-		bool found = false;
-		for (const auto& sha : sha_) {
-			if (data == sha->GetTypeHash()) {
-
-				// QRコードの値がshaのハッシュ値と一致する場合、TypeNameを表示
-				ImGui::Text("QRCodeHash: %s (same Type: %s)", data.c_str(), sha->GetTypeName().c_str());
-				found = true;
-				break;
-			}
-		}
-		if (!found) {
-
-			// 一致するものがなかったらTypeNONEでQRコードの値を表示
-			ImGui::Text("QRCodeHash: %s (same Type: NONE)", data.c_str());
-		}
+		// 一致するものがなかったらTypeNONEでQRコードの値を表示
+		ImGui::Text("QRCodeHash: %s (same Type: %s)", qrCode.data.c_str(), qrCode.entry ? qrCode.entry->name : "NONE");
 	}
 
+	// カメラの読み込みから検出結果までの時間
+	QRCapture::Stats captureStats = openCV_->GetCaptureStats();
+	ImGui::Text("Capture latency: avg %.1f ms, max %.1f ms", captureStats.averageLatencyMs, captureStats.maxLatencyMs);
+	ImGui::Text("Frames: captured %llu, processed %llu, dropped %llu",
+		static_cast<unsigned long long>(captureStats.capturedCount),
+		static_cast<unsigned long long>(captureStats.processedCount),
+		static_cast<unsigned long long>(captureStats.droppedCount));
+	// QRコードが見つかっている間は周りだけ探すので軽くなる
+	ImGui::Text("Detect: tracked avg %.2f ms (%llu), untracked avg %.2f ms (%llu), full scans %llu",
+		captureStats.averageTrackedDetectMs, static_cast<unsigned long long>(captureStats.trackedCount),
+		captureStats.averageUntrackedDetectMs, static_cast<unsigned long long>(captureStats.untrackedCount),
+		static_cast<unsigned long long>(captureStats.fullScanCount));
+
 	ImGui::End();
 
 	/*======================================================*/
 	// OpenCV
 
+	// 検出結果を受け取るだけで、カメラは待たない
 	openCV_->Update();
 
 }
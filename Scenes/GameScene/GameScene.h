@@ -23,8 +23,8 @@
 
 /// OpenCV
 #include "OpenCV.h"
-/// OpenSSL SHA256 ハッシュ
-#include "SHA256.h"
+/// SHA256 ハッシュ
+#include "HashRegistry.h"
 
 /// Base
 #include "IScene.h"
@@ -60,12 +60,19 @@ private:
 	// インスタンス
 	std::unique_ptr<OpenCV> openCV_;
 
+	// QRコードのデータと一致した種類、一致しなければnullptr
+	struct QRCode {
+
+		std::string data;
+		const HashRegistry::Entry* entry;
+	};
+
 	// 複数のQRコードデータを保持するためのベクター
-	std::vector<std::string> keepQRCodeData_;
+	std::vector<QRCode> keepQRCodeData_;
 
 	/*----------------------------------------------------------------------*/
-	// OpenSSL SHA256 ハッシュ
+	// SHA256 ハッシュ
 
-	// インスタンス
-	std::vector<std::unique_ptr<SHA256>> sha_;
+	// 前のフレームで種類の表示と照合に計算したハッシュの数、種類のハッシュは事前に作るので0になる
+	uint64_t frameHashCount_ = 0;
 };
\ No newline at end of file
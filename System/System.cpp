@@ -123,9 +123,9 @@
 //	// 形状を設定。PSOに設定しているものとはまた別。同じものを設定すると考える
 //	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 //	// マテリアルCBufferの場所を設定
-//	commandList->SetGraphicsRootConstantBufferView(0, vertex.GetMaterialResource()->GetGPUVirtualAddress());
+//	commandList->SetGraphicsRootConstantBufferView(0, vertex.GetMaterialAddress());
 //	// wvp用のCBufferの場所を設定
-//	commandList->SetGraphicsRootConstantBufferView(1, vertex.GetWvpResource()->GetGPUVirtualAddress());
+//	commandList->SetGraphicsRootConstantBufferView(1, vertex.GetWvpAddress());
 //	// SRVのDescriptorTableの先頭を設定。2はrootParamater[2]
 //	commandList->SetGraphicsRootDescriptorTable(2, texture->GetTextureSrvHandleGPU());
 //	// 描画を行う(DrawCall)。3頂点で1つのインスタンス
@@ -154,9 +154,9 @@
 //	// 形状を設定。PSOに設定しているものとはまた別。同じものを設定すると考える
 //	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 //	// マテリアルCBufferの場所を設定
-//	commandList->SetGraphicsRootConstantBufferView(0, vertex.GetMaterialResourceSprite()->GetGPUVirtualAddress());
+//	commandList->SetGraphicsRootConstantBufferView(0, vertex.GetMaterialAddressSprite());
 //	// wvp用のCBufferの場所を設定
-//	commandList->SetGraphicsRootConstantBufferView(1, vertex.GetTransformationMatrixResourceSprite()->GetGPUVirtualAddress());
+//	commandList->SetGraphicsRootConstantBufferView(1, vertex.GetTransformationMatrixAddressSprite());
 //	// SRVのDescriptorTableの先頭を設定。2はrootParamater[2]
 //	commandList->SetGraphicsRootDescriptorTable(2, texture->GetTextureSrvHandleGPU());
 //	// 描画を行う(DrawCall)。6個のインデックスを使用し1つのインスタンスを描画
@@ -188,11 +188,11 @@
 //	// 形状を設定。PSOに設定しているものとはまた別。同じものを設定すると考える
 //	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 //	// マテリアルCBufferの場所を設定
-//	commandList->SetGraphicsRootConstantBufferView(0, vertex.GetMaterialResourceSphere()->GetGPUVirtualAddress());
+//	commandList->SetGraphicsRootConstantBufferView(0, vertex.GetMaterialAddressSphere());
 //	// wvp用のCBufferの場所を設定
-//	commandList->SetGraphicsRootConstantBufferView(1, vertex.GetWvpResourceSphere()->GetGPUVirtualAddress());
+//	commandList->SetGraphicsRootConstantBufferView(1, vertex.GetWvpAddressSphere());
 //	// light用のBufferの場所を設定
-//	commandList->SetGraphicsRootConstantBufferView(3, vertex.GetLightResource()->GetGPUVirtualAddress());
+//	commandList->SetGraphicsRootConstantBufferView(3, vertex.GetLightAddress());
 //	// SRVのDescriptorTableの先頭を設定。2はrootParamater[2]
 //	commandList->SetGraphicsRootDescriptorTable(2, texture->GetTextureSrvHandleGPU2());
 //	// 描画を行う(DrawCall)。3頂点で1つのインスタンス
@@ -0,0 +1,120 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+#include "QRCapture.h"
+#include "FrameSource.h"
+
+namespace {
+
+	using Clock = std::chrono::steady_clock;
+
+	// 合成するQRコードの中身、ゲームと同じ64文字の16進数
+	const char* kPayload = "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad";
+
+	// フレームの大きさ、OpenCVクラスのカメラと同じ
+	const uint32_t kFrameWidth = 640;
+	const uint32_t kFrameHeight = 360;
+
+	//============================================================
+	// 計測
+	//============================================================
+	/// cameraFpsの合成カメラをQRCaptureで動かし、renderHzで回す描画ループから結果を受け取る
+	/// 読み込みから処理スレッドの結果まで、読み込みから描画ループが受け取るまでの時間とReceiveにかかった時間を出す
+	bool Measure(double cameraFps, double renderHz, double seconds) {
+
+		// カメラと同じく次のフレームまで待つ合成フレーム
+		SyntheticFrameSource::Settings settings{};
+		settings.payloads = { kPayload };
+		settings.width = kFrameWidth;
+		settings.height = kFrameHeight;
+		settings.fps = cameraFps;
+		SyntheticFrameSource source(settings);
+
+		QRCapture capture;
+		capture.Start(&source);
+
+		const Clock::duration renderPeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / renderHz));
+		const Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+
+		uint64_t renderFrames = 0;
+		uint64_t receivedCount = 0;
+		uint64_t correctCount = 0;
+		double totalReceiveLatencyMs = 0.0;
+		double maxReceiveLatencyMs = 0.0;
+		double maxReceiveCallUs = 0.0;
+
+		for (Clock::time_point next = Clock::now(); next < end; next += renderPeriod) {
+
+			std::this_thread::sleep_until(next);
+			++renderFrames;
+
+			// 描画ループ側、待たずに戻るかを計る
+			Clock::time_point begin = Clock::now();
+			bool isReceived = capture.Receive();
+			maxReceiveCallUs = (std::max)(maxReceiveCallUs, std::chrono::duration<double, std::micro>(Clock::now() - begin).count());
+
+			if (!isReceived) {
+				continue;
+			}
+
+			const QRCapture::Result& result = capture.GetResult();
+			double latencyMs = std::chrono::duration<double, std::milli>(Clock::now() - result.captureTime).count();
+			totalReceiveLatencyMs += latencyMs;
+			maxReceiveLatencyMs = (std::max)(maxReceiveLatencyMs, latencyMs);
+			++receivedCount;
+			if (result.decodedText == kPayload) {
+				++correctCount;
+			}
+		}
+
+		capture.Stop();
+		QRCapture::Stats stats = capture.GetStats();
+
+		std::printf("  camera %5.0f fps  render %5.0f Hz\n", cameraFps, renderHz);
+		std::printf("    frames     captured %6llu  processed %6llu  dropped %6llu  decoded %6llu\n",
+			static_cast<unsigned long long>(stats.capturedCount), static_cast<unsigned long long>(stats.processedCount),
+			static_cast<unsigned long long>(stats.droppedCount), static_cast<unsigned long long>(stats.decodedCount));
+		std::printf("    capture -> result   avg %7.2f ms  max %7.2f ms\n", stats.averageLatencyMs, stats.maxLatencyMs);
+		std::printf("    capture -> receive  avg %7.2f ms  max %7.2f ms  (%llu received in %llu render frames)\n",
+			receivedCount != 0 ? totalReceiveLatencyMs / receivedCount : 0.0, maxReceiveLatencyMs,
+			static_cast<unsigned long long>(receivedCount), static_cast<unsigned long long>(renderFrames));
+		std::printf("    Receive call max %7.2f us\n", maxReceiveCallUs);
+		std::printf("    detect  tracked avg %7.2f ms (%llu)  untracked avg %7.2f ms (%llu)  full scans %llu\n",
+			stats.averageTrackedDetectMs, static_cast<unsigned long long>(stats.trackedCount),
+			stats.averageUntrackedDetectMs, static_cast<unsigned long long>(stats.untrackedCount),
+			static_cast<unsigned long long>(stats.fullScanCount));
+
+		// 受け取ったものは全て正しく読めているはず
+		bool isValid = receivedCount != 0 && correctCount == receivedCount;
+		if (!isValid) {
+			std::printf("    failed  %llu of %llu results did not decode\n",
+				static_cast<unsigned long long>(receivedCount - correctCount), static_cast<unsigned long long>(receivedCount));
+		}
+		return isValid;
+	}
+}
+
+//============================================================
+// main
+//============================================================
+/// カメラの代わりに合成したフレームを流し、読み込みから検出結果までの時間を計る
+/// 引数で計測の秒数、なければ3秒
+int main(int argc, char* argv[]) {
+
+	double seconds = argc > 1 ? (std::max)(std::atof(argv[1]), 0.5) : 3.0;
+
+	const double kCameraFps[] = { 30.0, 60.0, 120.0 };
+	const double kRenderHz = 144.0;
+
+	bool isValid = true;
+	for (double fps : kCameraFps) {
+		isValid = Measure(fps, kRenderHz, seconds) && isValid;
+	}
+
+	std::printf(isValid ? "all results decoded\n" : "decode failure\n");
+	return isValid ? 0 : 1;
+}
\ No newline at end of file
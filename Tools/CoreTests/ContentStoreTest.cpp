@@ -0,0 +1,132 @@
+#include <string>
+
+#include "CoreTests.h"
+#include "ContentStore.h"
+
+namespace {
+
+	//============================================================
+	// 名前の結び付け
+	//============================================================
+	/// 同じ内容の別のファイルや別名は1つのキーにまとまり、同じ名前で読み直しても参照は増えない
+	void TestAcquire() {
+
+		ContentStore store;
+		store.Initialize("content:");
+
+		SHA256Digest checker = SHA256Hasher::Hash("checker");
+		SHA256Digest white = SHA256Hasher::Hash("white");
+
+		bool isNew = false;
+		ContentId id = store.Acquire("Resources/checker.png", checker, &isNew);
+		CHECK(isNew);
+		CHECK(store.GetKey(id) == "content:" + SHA256Hasher::ToHex(checker));
+		CHECK(store.GetDigest(id) == checker);
+
+		// 中身が同じ別のファイルと別名
+		CHECK(store.Acquire("Resources/checkerCopy.png", checker, &isNew) == id);
+		CHECK(!isNew);
+		CHECK(store.Acquire("checker", checker, &isNew) == id);
+		CHECK(store.GetReferenceCount(id) == 3);
+
+		// 同じ名前で読み直しても増やさない
+		CHECK(store.Acquire("checker", checker, &isNew) == id);
+		CHECK(!isNew);
+		CHECK(store.GetReferenceCount(id) == 3);
+
+		ContentId whiteId = store.Acquire("Resources/white.png", white, &isNew);
+		CHECK(isNew && whiteId != id);
+		CHECK(store.FindDigest(white) == whiteId);
+
+		// 全ての名前が同じキーになり、管理していない名前はそのまま
+		CHECK(store.Resolve("Resources/checkerCopy.png") == store.GetKey(id));
+		CHECK(store.Resolve("checker") == store.GetKey(id));
+		CHECK(store.Resolve("Resources/white.png") != store.GetKey(id));
+		CHECK(store.Resolve("atlas0") == "atlas0");
+		CHECK(store.Find("atlas0") == ContentStore::kInvalidId);
+	}
+
+	//============================================================
+	// 統計と解放
+	//============================================================
+	/// 最後の名前が外れたときだけ番号を返し、その番号は次の新しい内容で使い回す
+	void TestRelease() {
+
+		ContentStore store;
+		store.Initialize("model:");
+
+		SHA256Digest bunny = SHA256Hasher::Hash("bunny.obj");
+		SHA256Digest teapot = SHA256Hasher::Hash("teapot.obj");
+
+		ContentId bunnyId = store.Acquire("bunny.obj", bunny);
+		store.SetSize(bunnyId, 1000);
+		store.Acquire("bunny2.obj", bunny);
+		store.Acquire("rabbit", bunny);
+		ContentId teapotId = store.Acquire("teapot.obj", teapot);
+		store.SetSize(teapotId, 300);
+
+		ContentStore::Stats stats = store.GetStats();
+		CHECK(stats.identifierCount == 4);
+		CHECK(stats.contentCount == 2);
+		CHECK(stats.sharedCount == 2);
+		CHECK(stats.storedSize == 1300);
+		CHECK(stats.savedSize == 2000);
+
+		// 他の名前が残っていれば破棄しない
+		CHECK(store.Release("bunny2.obj") == ContentStore::kInvalidId);
+		CHECK(store.Release("bunny2.obj") == ContentStore::kInvalidId);
+		CHECK(store.Release("rabbit") == ContentStore::kInvalidId);
+		CHECK(store.GetStats().savedSize == 0);
+
+		// 最後の参照、キーは破棄に使えるように残る
+		const std::string bunnyKey = store.GetKey(bunnyId);
+		CHECK(store.Release("bunny.obj") == bunnyId);
+		CHECK(store.GetKey(bunnyId) == bunnyKey);
+		CHECK(store.FindDigest(bunny) == ContentStore::kInvalidId);
+		CHECK(store.Resolve("bunny.obj") == "bunny.obj");
+
+		stats = store.GetStats();
+		CHECK(stats.identifierCount == 1);
+		CHECK(stats.contentCount == 1);
+		CHECK(stats.storedSize == 300);
+
+		// 番号を使い回し、大きさは新しい内容のもの
+		bool isNew = false;
+		SHA256Digest suzanne = SHA256Hasher::Hash("suzanne.obj");
+		CHECK(store.Acquire("suzanne.obj", suzanne, &isNew) == bunnyId);
+		CHECK(isNew);
+		CHECK(store.GetKey(bunnyId) == "model:" + SHA256Hasher::ToHex(suzanne));
+		CHECK(store.GetStats().storedSize == 300);
+
+		// 同じ内容をもう一度読めば新しく作る
+		CHECK(store.Acquire("bunny.obj", bunny, &isNew) != teapotId);
+		CHECK(isNew);
+
+		store.Clear();
+		CHECK(store.GetStats().identifierCount == 0);
+		CHECK(store.GetStats().contentCount == 0);
+	}
+}
+
+//============================================================
+// ContentStore
+//============================================================
+void TestContentStore() {
+
+	TestAcquire();
+	TestRelease();
+
+	CoreTests::ExpectAbort("ContentStore.RebindIdentifier");
+}
+
+//============================================================
+// 外さずに別の内容へ結び付け直す
+//============================================================
+void AbortContentStoreRebindIdentifier() {
+
+	ContentStore store;
+	store.Initialize("content:");
+
+	store.Acquire("checker.png", SHA256Hasher::Hash("checker"));
+	store.Acquire("checker.png", SHA256Hasher::Hash("white"));
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+
+/// デバイスを使わない部分の確認
+/// 失敗しても止めずに次の確認へ進み、最後に失敗の数を出す
+
+// 確認、失敗したら式と場所を出す
+#define CHECK(expression) CoreTests::Check(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
+
+namespace CoreTests {
+
+	// 失敗したらfalse
+	bool Check(bool condition, const char* expression, const char* file, int line);
+
+	// nameの処理を別のプロセスで実行し、assertで止まることを確かめる
+	// assertが無効なビルドでは確かめずにtrue
+	bool ExpectAbort(const char* name);
+}
+
+/*-----------------------------------------------------------------------------------------*/
+/// 各テスト
+
+void TestDescriptorAllocator();
+void TestTlsfAllocator();
+void TestRenderGraph();
+void TestRingAllocator();
+void TestFrameScheduler();
+void TestUploadQueue();
+void TestPipelineCache();
+void TestShaderCache();
+void TestTextureStreamer();
+void TestContentStore();
+void TestGeometryArena();
+void TestPrimitiveBatcher();
+void TestInstanceBatcher();
+void TestTextureAtlas();
+void TestJobGraph();
+void TestProceduralMesh();
+
+/*-----------------------------------------------------------------------------------------*/
+/// assertで止まるはずの処理、ExpectAbortから名前で呼ばれる
+
+void AbortDescriptorAllocatorDoubleFree();
+void AbortDescriptorAllocatorOverlappingFree();
+void AbortTlsfAllocatorDoubleFree();
+void AbortRenderGraphConflictingWrite();
+void AbortRingAllocatorBadAlignment();
+void AbortFrameSchedulerTooManyFrames();
+void AbortPipelineCacheTooManyRootParameters();
+void AbortTextureStreamerDoubleUnregister();
+void AbortContentStoreRebindIdentifier();
+void AbortJobGraphCycle();
\ No newline at end of file
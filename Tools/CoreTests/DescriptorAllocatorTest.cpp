@@ -0,0 +1,206 @@
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "CoreTests.h"
+#include "DescriptorAllocator.h"
+
+namespace {
+
+	//============================================================
+	// 使用状況から求めた断片化
+	//============================================================
+	/// 空きの並びの数と最大の長さを数え、GetStatsと比べる
+	void CheckFragmentation(const DescriptorAllocator& allocator, const std::vector<bool>& used) {
+
+		uint32_t freeBlockCount = 0;
+		uint32_t largestFreeBlock = 0;
+		uint32_t run = 0;
+		uint32_t usedCount = 0;
+		for (size_t i = 0; i < used.size(); ++i) {
+
+			if (used[i]) {
+				usedCount++;
+				run = 0;
+				continue;
+			}
+			if (run == 0) {
+				freeBlockCount++;
+			}
+			run++;
+			largestFreeBlock = (std::max)(largestFreeBlock, run);
+		}
+
+		DescriptorAllocator::Stats stats = allocator.GetStats();
+		CHECK(stats.usedCount == usedCount);
+		CHECK(stats.freeBlockCount == freeBlockCount);
+		CHECK(stats.largestFreeBlock == largestFreeBlock);
+	}
+
+	//============================================================
+	// 確保と返却、隣とのつなぎ方
+	//============================================================
+	void TestMerge() {
+
+		DescriptorAllocator allocator;
+		allocator.Initialize(16);
+
+		DescriptorAllocator::Stats stats = allocator.GetStats();
+		CHECK(stats.capacity == 16);
+		CHECK(stats.freeBlockCount == 1);
+		CHECK(stats.largestFreeBlock == 16);
+
+		// 先頭から詰めて貸す
+		uint32_t a = allocator.Allocate(4);
+		uint32_t b = allocator.Allocate(4);
+		uint32_t c = allocator.Allocate(4);
+		CHECK(a == 0);
+		CHECK(b == 4);
+		CHECK(c == 8);
+		CHECK(allocator.GetUsedCount() == 12);
+
+		// 入らない数は失敗する
+		CHECK(allocator.Allocate(5) == DescriptorAllocator::kInvalidIndex);
+		CHECK(allocator.GetStats().failedCount == 1);
+
+		// 真ん中を返すと空きが2つに分かれる
+		allocator.Free(b, 4);
+		stats = allocator.GetStats();
+		CHECK(stats.freeBlockCount == 2);
+		CHECK(stats.largestFreeBlock == 4);
+
+		// 後ろの空きとつながる
+		allocator.Free(a, 4);
+		stats = allocator.GetStats();
+		CHECK(stats.freeBlockCount == 2);
+		CHECK(stats.largestFreeBlock == 8);
+
+		// 前後の空きとつながって1つに戻る
+		allocator.Free(c, 4);
+		stats = allocator.GetStats();
+		CHECK(stats.freeBlockCount == 1);
+		CHECK(stats.largestFreeBlock == 16);
+		CHECK(stats.usedCount == 0);
+		CHECK(stats.allocations == 3);
+		CHECK(stats.frees == 3);
+		CHECK(stats.peakUsedCount == 12);
+
+		// 前の空きとだけつながる
+		allocator.Initialize(12);
+		a = allocator.Allocate(4);
+		b = allocator.Allocate(4);
+		c = allocator.Allocate(4);
+		CHECK(allocator.GetStats().freeBlockCount == 0);
+		allocator.Free(a, 4);
+		allocator.Free(b, 4);
+		stats = allocator.GetStats();
+		CHECK(stats.freeBlockCount == 1);
+		CHECK(stats.largestFreeBlock == 8);
+
+		// 返した所は再び先頭から使われる
+		CHECK(allocator.Allocate(8) == 0);
+	}
+
+	//============================================================
+	// ランダムな確保と返却
+	//============================================================
+	/// 貸した範囲が重ならないこと、断片化の統計が実際の空きと合うことを確かめる
+	void TestRandom() {
+
+		const uint32_t kCapacity = 512;
+
+		DescriptorAllocator allocator;
+		allocator.Initialize(kCapacity);
+
+		struct Block {
+			uint32_t index;
+			uint32_t count;
+		};
+		std::vector<Block> blocks;
+		std::vector<bool> used(kCapacity, false);
+
+		std::mt19937 random(0);
+		for (int step = 0; step < 20000; ++step) {
+
+			if (blocks.empty() || random() % 2 == 0) {
+
+				uint32_t count = 1 + random() % 8;
+				uint32_t index = allocator.Allocate(count);
+				if (index == DescriptorAllocator::kInvalidIndex) {
+					continue;
+				}
+
+				CHECK(index + count <= kCapacity);
+				for (uint32_t i = index; i < index + count; ++i) {
+					CHECK(!used[i]);
+					used[i] = true;
+				}
+				blocks.push_back({ index, count });
+			} else {
+
+				size_t i = random() % blocks.size();
+				Block block = blocks[i];
+				blocks[i] = blocks.back();
+				blocks.pop_back();
+
+				allocator.Free(block.index, block.count);
+				for (uint32_t j = block.index; j < block.index + block.count; ++j) {
+					used[j] = false;
+				}
+			}
+
+			if (step % 97 == 0) {
+				CheckFragmentation(allocator, used);
+			}
+		}
+		CheckFragmentation(allocator, used);
+
+		// 全て返せば1つの空きに戻る
+		for (const Block& block : blocks) {
+			allocator.Free(block.index, block.count);
+		}
+		DescriptorAllocator::Stats stats = allocator.GetStats();
+		CHECK(stats.usedCount == 0);
+		CHECK(stats.freeBlockCount == 1);
+		CHECK(stats.largestFreeBlock == kCapacity);
+	}
+}
+
+//============================================================
+// DescriptorAllocator
+//============================================================
+void TestDescriptorAllocator() {
+
+	TestMerge();
+	TestRandom();
+
+	CoreTests::ExpectAbort("DescriptorAllocator.DoubleFree");
+	CoreTests::ExpectAbort("DescriptorAllocator.OverlappingFree");
+}
+
+//============================================================
+// 二重返却
+//============================================================
+void AbortDescriptorAllocatorDoubleFree() {
+
+	DescriptorAllocator allocator;
+	allocator.Initialize(8);
+
+	uint32_t index = allocator.Allocate(2);
+	allocator.Free(index, 2);
+	allocator.Free(index, 2);
+}
+
+//============================================================
+// 空きに重なる返却
+//============================================================
+void AbortDescriptorAllocatorOverlappingFree() {
+
+	DescriptorAllocator allocator;
+	allocator.Initialize(8);
+
+	allocator.Allocate(8);
+	allocator.Free(0, 4);
+	// [2, 6)は前の空き[0, 4)に重なる
+	allocator.Free(2, 4);
+}
\ No newline at end of file
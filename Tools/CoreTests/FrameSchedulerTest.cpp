@@ -0,0 +1,191 @@
+#include <vector>
+#include <algorithm>
+
+#include "CoreTests.h"
+#include "FrameScheduler.h"
+
+namespace {
+
+	//============================================================
+	// 偽のフェンス
+	//============================================================
+	/// GPUの進みはCompleteで手で進め、Waitされたらその値まで終わったことにする
+	class SimulatedFrameFence : public IFrameFence {
+	public:
+
+		uint64_t Signal() override { return ++signaledValue_; }
+		uint64_t GetCompletedValue() const override { return completedValue_; }
+		void Wait(uint64_t value) override {
+
+			// Signalしていない値を待つと戻ってこない
+			CHECK(value <= signaledValue_);
+			waitedValues_.push_back(value);
+			completedValue_ = (std::max)(completedValue_, value);
+		}
+
+		// GPUがvalueまで終わった
+		void Complete(uint64_t value) {
+
+			CHECK(value <= signaledValue_);
+			completedValue_ = (std::max)(completedValue_, value);
+		}
+
+		uint64_t GetSignaledValue() const { return signaledValue_; }
+		const std::vector<uint64_t>& GetWaitedValues() const { return waitedValues_; }
+
+	private:
+
+		uint64_t signaledValue_ = 0;
+		uint64_t completedValue_ = 0;
+		std::vector<uint64_t> waitedValues_;
+	};
+
+	//============================================================
+	// フレームの使い回し
+	//============================================================
+	/// 使い回すフレームが前回Signalした値だけを待ち、終わっていれば待たない
+	void TestFrames() {
+
+		SimulatedFrameFence fence;
+		FrameScheduler scheduler;
+		scheduler.Initialize(&fence, 3);
+
+		// 3フレームまでは待たずに投げられる
+		for (uint32_t i = 0; i < 3; ++i) {
+			CHECK(scheduler.BeginFrame() == i);
+			CHECK(scheduler.EndFrame() == i + 1);
+		}
+		CHECK(fence.GetWaitedValues().empty());
+		CHECK(scheduler.GetFrameFenceValue(0) == 1);
+		CHECK(scheduler.GetFrameFenceValue(2) == 3);
+
+		// 4フレーム目はフレーム0を使い回すので1だけを待つ
+		CHECK(scheduler.BeginFrame() == 0);
+		CHECK(fence.GetWaitedValues() == std::vector<uint64_t>({ 1 }));
+		CHECK(fence.GetCompletedValue() == 1);
+		scheduler.EndFrame();
+
+		// GPUが先に進んでいれば待たない
+		fence.Complete(2);
+		CHECK(scheduler.BeginFrame() == 1);
+		CHECK(fence.GetWaitedValues().size() == 1);
+		scheduler.EndFrame();
+
+		// 1フレームなら毎回直前のフレームを待つ
+		SimulatedFrameFence singleFence;
+		FrameScheduler single;
+		single.Initialize(&singleFence, 1);
+		for (uint32_t i = 0; i < 4; ++i) {
+			CHECK(single.BeginFrame() == 0);
+			single.EndFrame();
+		}
+		CHECK(singleFence.GetWaitedValues() == std::vector<uint64_t>({ 1, 2, 3 }));
+
+		CHECK(scheduler.GetStats().submittedFrames == 5);
+		CHECK(scheduler.GetStats().waitCount == 1);
+		CHECK(single.GetStats().waitCount == 3);
+	}
+
+	//============================================================
+	// 遅延解放
+	//============================================================
+	/// 積んだフレームのSignal値をGPUが越えるまでは解放せず、越えたら積んだ順に解放する
+	void TestDeferredRelease() {
+
+		SimulatedFrameFence fence;
+		FrameScheduler scheduler;
+		scheduler.Initialize(&fence, 2);
+
+		std::vector<int> released;
+
+		// フレーム0で2つ積む、Signal値は1
+		scheduler.BeginFrame();
+		scheduler.DeferRelease([&]() { released.push_back(0); });
+		scheduler.DeferRelease([&]() { released.push_back(1); });
+		CHECK(scheduler.GetPendingReleaseCount() == 2);
+		CHECK(scheduler.EndFrame() == 1);
+
+		// フレーム1で1つ積む、Signal値は2
+		scheduler.BeginFrame();
+		scheduler.DeferRelease([&]() { released.push_back(2); });
+		CHECK(released.empty());
+
+		// 記録中のフレームの分はGPUが先に進んでいても解放しない
+		fence.Complete(1);
+		scheduler.EndFrame();
+		CHECK(released.empty());
+
+		// 次のBeginFrameで1までの分を解放する
+		scheduler.BeginFrame();
+		CHECK(released == std::vector<int>({ 0, 1 }));
+		CHECK(scheduler.GetPendingReleaseCount() == 1);
+		scheduler.EndFrame();
+
+		// 2はまだ終わっていないので、フレーム1を使い回すまで残る
+		CHECK(fence.GetCompletedValue() == 1);
+		scheduler.BeginFrame();
+		CHECK(fence.GetWaitedValues() == std::vector<uint64_t>({ 2 }));
+		CHECK(released == std::vector<int>({ 0, 1, 2 }));
+		CHECK(scheduler.GetPendingReleaseCount() == 0);
+		scheduler.EndFrame();
+
+		CHECK(scheduler.GetStats().deferredCount == 3);
+		CHECK(scheduler.GetStats().releasedCount == 3);
+	}
+
+	//============================================================
+	// 全ての完了待ち
+	//============================================================
+	/// 記録中のフレームで積んだものも含め、全て解放する
+	void TestWaitForGpu() {
+
+		SimulatedFrameFence fence;
+		FrameScheduler scheduler;
+		scheduler.Initialize(&fence, 3);
+
+		uint32_t releasedCount = 0;
+		scheduler.BeginFrame();
+		scheduler.DeferRelease([&]() { releasedCount++; });
+		scheduler.EndFrame();
+		scheduler.BeginFrame();
+		scheduler.DeferRelease([&]() { releasedCount++; });
+
+		scheduler.WaitForGpu();
+		CHECK(releasedCount == 2);
+		CHECK(scheduler.GetPendingReleaseCount() == 0);
+		CHECK(fence.GetCompletedValue() == fence.GetSignaledValue());
+		CHECK(scheduler.GetLastSignaledValue() == fence.GetSignaledValue());
+		CHECK(scheduler.GetStats().waitCount == 1);
+
+		// 待った後も続けてフレームを回せる
+		scheduler.BeginFrame();
+		scheduler.DeferRelease([&]() { releasedCount++; });
+		scheduler.EndFrame();
+		fence.Complete(fence.GetSignaledValue());
+		scheduler.BeginFrame();
+		CHECK(releasedCount == 3);
+		CHECK(fence.GetWaitedValues().size() == 1);
+	}
+}
+
+//============================================================
+// FrameScheduler
+//============================================================
+void TestFrameScheduler() {
+
+	TestFrames();
+	TestDeferredRelease();
+	TestWaitForGpu();
+
+	CoreTests::ExpectAbort("FrameScheduler.TooManyFrames");
+}
+
+//============================================================
+// 上限を超えるフレーム数
+//============================================================
+void AbortFrameSchedulerTooManyFrames() {
+
+	SimulatedFrameFence fence;
+	FrameScheduler scheduler;
+	scheduler.Initialize(&fence, FrameScheduler::kMaxFrameCount + 1);
+}
\ No newline at end of file
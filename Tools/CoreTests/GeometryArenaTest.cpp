@@ -0,0 +1,127 @@
+#include <vector>
+
+#include "CoreTests.h"
+#include "GeometryArena.h"
+#include "RecordingGeometryAllocator.h"
+
+namespace {
+
+	// 頂点1つの大きさ、VertexDataと同じ
+	const uint64_t kVertexStride = 36;
+
+	//============================================================
+	// 確保とページの使い回し
+	//============================================================
+	/// 要素の大きさの倍数に置き、GPUが使い終わったページだけを次のフレームで使い回す
+	void TestReset() {
+
+		RecordingGeometryAllocator allocator;
+		GeometryArena arena;
+		arena.Initialize(&allocator, 1024);
+
+		// 2の累乗でない大きさでも倍数の位置に置く
+		GeometryAllocation first = arena.Allocate(10, 1);
+		GeometryAllocation second = arena.Allocate(kVertexStride * 3, kVertexStride);
+		CHECK(first.IsValid() && second.IsValid());
+		CHECK(first.offset == 0);
+		CHECK(second.offset == kVertexStride);
+		CHECK(second.pageAddress == first.pageAddress);
+		CHECK(second.cpuAddress == first.cpuAddress + kVertexStride);
+		CHECK(arena.GetStats().frameSize == kVertexStride * 4);
+		CHECK(!arena.Allocate(0, 1).IsValid());
+
+		arena.FinishFrame(1);
+		CHECK(arena.GetStats().frameSize == 0);
+		CHECK(arena.GetStats().lastFrameSize == kVertexStride * 4);
+		CHECK(arena.GetPendingFrameCount() == 1);
+
+		// GPUが読んでいる間は別のページに書く
+		GeometryAllocation pending = arena.Allocate(16, 16);
+		CHECK(pending.pageAddress != first.pageAddress);
+		CHECK(allocator.GetAllocatedSizes().size() == 2);
+		arena.FinishFrame(2);
+
+		// 回収したページは確保し直さずに先頭から使う
+		arena.ReleaseCompletedFrames(1);
+		CHECK(arena.GetPendingFrameCount() == 1);
+		GeometryAllocation reused = arena.Allocate(16, 16);
+		CHECK(reused.pageAddress == first.pageAddress);
+		CHECK(reused.offset == 0);
+		CHECK(allocator.GetAllocatedSizes().size() == 2);
+		CHECK(arena.GetStats().growCount == 0);
+		arena.FinishFrame(3);
+
+		// 使わなかったフレームも順番を保つ
+		arena.FinishFrame(4);
+		CHECK(arena.GetPendingFrameCount() == 3);
+		arena.ReleaseCompletedFrames(4);
+		CHECK(arena.GetPendingFrameCount() == 0);
+		CHECK(arena.GetStats().pageCount == 2);
+
+		arena.Finalize();
+		CHECK(allocator.GetLivePageCount() == 0);
+	}
+
+	//============================================================
+	// フレームをまたいだ成長
+	//============================================================
+	/// 1フレームで溢れたらページを倍にし、次のフレームからは使用量が1ページに収まる
+	void TestGrowth() {
+
+		RecordingGeometryAllocator allocator;
+		GeometryArena arena;
+		arena.Initialize(&allocator, 1024);
+
+		// 2つ目で溢れて倍のページに移る
+		GeometryAllocation a = arena.Allocate(1000, 4);
+		GeometryAllocation b = arena.Allocate(1000, 4);
+		GeometryAllocation c = arena.Allocate(1000, 4);
+		CHECK(b.pageAddress != a.pageAddress);
+		CHECK(c.pageAddress == b.pageAddress && c.offset == 1000);
+		CHECK(b.pageSize == 2048);
+		CHECK(arena.GetStats().growCount == 1);
+		CHECK(arena.GetStats().highWaterSize == 3000);
+
+		// このフレームの使用量が入る大きさにする
+		arena.FinishFrame(1);
+		CHECK(arena.GetStats().pageSize == 4096);
+
+		// 小さいページは回収したときに返す
+		arena.ReleaseCompletedFrames(1);
+		CHECK(allocator.GetFreeCount() == 2);
+		CHECK(arena.GetStats().pageCount == 0);
+		CHECK(arena.GetStats().reservedSize == 0);
+
+		// 同じ量なら1ページに収まり、それ以上は大きくならない
+		for (uint64_t frame = 2; frame < 6; ++frame) {
+
+			GeometryAllocation first = arena.Allocate(1000, 4);
+			for (int i = 0; i < 2; ++i) {
+				CHECK(arena.Allocate(1000, 4).pageAddress == first.pageAddress);
+			}
+			arena.FinishFrame(frame);
+			arena.ReleaseCompletedFrames(frame);
+		}
+		CHECK(arena.GetStats().growCount == 1);
+		CHECK(allocator.GetAllocatedSizes() == std::vector<uint64_t>({ 1024, 2048, 4096 }));
+		CHECK(arena.GetStats().pageCount == 1);
+
+		// ページより大きい確保は、それが入るページを用意する
+		GeometryAllocation large = arena.Allocate(10000, 4);
+		CHECK(large.IsValid() && large.pageSize >= 10000 && large.offset == 0);
+		CHECK(arena.GetStats().growCount == 2);
+
+		arena.FinishFrame(6);
+		arena.Finalize();
+		CHECK(allocator.GetLivePageCount() == 0);
+	}
+}
+
+//============================================================
+// GeometryArena
+//============================================================
+void TestGeometryArena() {
+
+	TestReset();
+	TestGrowth();
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include <vector>
+#include <string>
+
+#include "CoreTests.h"
+#include "InstanceBatcher.h"
+
+namespace {
+
+	// 発行された1回分の描画
+	struct FlushedBatch {
+
+		std::string identifier;
+		float lightIntensity;
+		float cameraX;
+		std::vector<float> instanceIds; // インスタンスごとのcolor.x
+	};
+
+	// 発行先を記録する
+	void Record(InstanceBatcher& batcher, std::vector<FlushedBatch>& batches) {
+
+		batcher.SetFlushFunction([&batches](const InstanceBatchKey& key, const InstanceData* instances, uint32_t instanceCount) {
+
+			FlushedBatch batch{ key.identifier, key.light.intensity, key.camera.pos.x, {} };
+			for (uint32_t i = 0; i < instanceCount; ++i) {
+				batch.instanceIds.push_back(instances[i].material.color.x);
+			}
+			batches.push_back(std::move(batch));
+			});
+	}
+
+	InstanceBatchKey MakeKey(const std::string& identifier, float lightIntensity = 1.0f, float cameraX = 0.0f) {
+
+		InstanceBatchKey key{};
+		key.identifier = identifier;
+		key.pipelineType = 3; // PipelineType::INSTANCED
+		key.light.color = { 1.0f, 1.0f, 1.0f, 1.0f };
+		key.light.direction = { 0.0f, -1.0f, 0.0f };
+		key.light.intensity = lightIntensity;
+		key.camera.pos = { cameraX, 0.0f, -10.0f };
+		return key;
+	}
+
+	// 発行順を確かめるため、color.xに番号を入れる
+	InstanceData MakeInstance(float id) {
+
+		InstanceData instance{};
+		instance.material.color = { id, 1.0f, 1.0f, 1.0f };
+		return instance;
+	}
+
+	//============================================================
+	// まとめる条件
+	//============================================================
+	/// 連続する同じ条件だけをまとめ、条件が変わったら溜まっている分を先に発行する
+	void TestMixedKeys() {
+
+		std::vector<FlushedBatch> batches;
+		InstanceBatcher batcher;
+		Record(batcher, batches);
+
+		// bunny x3, teapot x1, bunny x2, bunny(ライト違い) x1, bunny(カメラ違い) x2
+		batcher.Add(MakeKey("bunny"), MakeInstance(0.0f));
+		batcher.Add(MakeKey("bunny"), MakeInstance(1.0f));
+		batcher.Add(MakeKey("bunny"), MakeInstance(2.0f));
+		batcher.Add(MakeKey("teapot"), MakeInstance(3.0f));
+		batcher.Add(MakeKey("bunny"), MakeInstance(4.0f));
+		batcher.Add(MakeKey("bunny"), MakeInstance(5.0f));
+		batcher.Add(MakeKey("bunny", 0.5f), MakeInstance(6.0f));
+		batcher.Add(MakeKey("bunny", 0.5f, 1.0f), MakeInstance(7.0f));
+		batcher.Add(MakeKey("bunny", 0.5f, 1.0f), MakeInstance(8.0f));
+
+		// 最後の条件はFlushまで溜まったまま
+		CHECK(batches.size() == 4);
+		CHECK(batcher.GetPendingCount() == 2);
+		batcher.Flush();
+		CHECK(batcher.GetPendingCount() == 0);
+
+		CHECK(batches.size() == 5);
+		CHECK(batches[0].identifier == "bunny" && batches[0].instanceIds == std::vector<float>({ 0.0f, 1.0f, 2.0f }));
+		CHECK(batches[1].identifier == "teapot" && batches[1].instanceIds == std::vector<float>({ 3.0f }));
+		CHECK(batches[2].identifier == "bunny" && batches[2].instanceIds == std::vector<float>({ 4.0f, 5.0f }));
+		CHECK(batches[3].lightIntensity == 0.5f && batches[3].instanceIds == std::vector<float>({ 6.0f }));
+		CHECK(batches[4].cameraX == 1.0f && batches[4].instanceIds == std::vector<float>({ 7.0f, 8.0f }));
+
+		// 空のときのFlushは何も発行しない
+		batcher.Flush();
+		CHECK(batches.size() == 5);
+
+		const InstanceBatcher::Stats& stats = batcher.GetStats();
+		CHECK(stats.drawRequests == 9);
+		CHECK(stats.drawCalls == 5);
+		CHECK(stats.batches == 3);
+		CHECK(stats.drawCallsSaved == 4);
+		CHECK(stats.maxInstancesPerBatch == 3);
+	}
+
+	//============================================================
+	// 上限での分割
+	//============================================================
+	/// 1バッチの上限を超えたら同じ条件でも分割し、統計はリセットで0に戻る
+	void TestMaxInstanceCount() {
+
+		std::vector<FlushedBatch> batches;
+		InstanceBatcher batcher;
+		Record(batcher, batches);
+		batcher.SetMaxInstanceCount(4);
+
+		for (uint32_t i = 0; i < 10; ++i) {
+			batcher.Add(MakeKey("plane"), MakeInstance(static_cast<float>(i)));
+		}
+		batcher.Flush();
+
+		CHECK(batches.size() == 3);
+		CHECK(batches[0].instanceIds == std::vector<float>({ 0.0f, 1.0f, 2.0f, 3.0f }));
+		CHECK(batches[1].instanceIds == std::vector<float>({ 4.0f, 5.0f, 6.0f, 7.0f }));
+		CHECK(batches[2].instanceIds == std::vector<float>({ 8.0f, 9.0f }));
+
+		const InstanceBatcher::Stats& stats = batcher.GetStats();
+		CHECK(stats.drawRequests == 10);
+		CHECK(stats.drawCalls == 3);
+		CHECK(stats.batches == 3);
+		CHECK(stats.drawCallsSaved == 7);
+		CHECK(stats.maxInstancesPerBatch == 4);
+
+		batcher.ResetStats();
+		CHECK(batcher.GetStats().drawRequests == 0 && batcher.GetStats().drawCalls == 0);
+		CHECK(batcher.GetStats().maxInstancesPerBatch == 0);
+	}
+}
+
+//============================================================
+// InstanceBatcher
+//============================================================
+void TestInstanceBatcher() {
+
+	TestMixedKeys();
+	TestMaxInstanceCount();
+}
\ No newline at end of file
@@ -0,0 +1,234 @@
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include "CoreTests.h"
+#include "JobGraph.h"
+
+namespace {
+
+	// 依存の辺、jobはdependencyの後
+	struct Edge {
+
+		JobId job;
+		JobId dependency;
+	};
+
+	// 実行した順番
+	class ExecutionLog {
+	public:
+
+		void Push(JobId id) {
+
+			std::lock_guard<std::mutex> lock(mutex_);
+			order_.push_back(id);
+		}
+
+		// 依存先が全て先に実行されている
+		bool IsOrdered(const std::vector<Edge>& edges) const {
+
+			for (const Edge& edge : edges) {
+
+				auto job = std::find(order_.begin(), order_.end(), edge.job);
+				auto dependency = std::find(order_.begin(), order_.end(), edge.dependency);
+				if (job == order_.end() || dependency == order_.end() || dependency > job) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		size_t GetCount() const { return order_.size(); }
+
+	private:
+
+		std::mutex mutex_;
+		std::vector<JobId> order_;
+	};
+
+	// 辺として登録されている
+	bool HasEdge(const std::vector<Edge>& edges, JobId dependency, JobId job) {
+
+		return std::any_of(edges.begin(), edges.end(),
+			[&](const Edge& edge) { return edge.job == job && edge.dependency == dependency; });
+	}
+
+	void Sleep(uint32_t ms) {
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+	}
+
+	//============================================================
+	// 依存の順番
+	//============================================================
+	/// 依存先が終わってから実行し、後から足した依存も守る
+	void TestDependencyOrder() {
+
+		JobGraph jobs;
+		ExecutionLog log;
+		std::vector<Edge> edges;
+
+		// 5段のひし形を4つ並べ、後ろの段ほど番号が小さい
+		const uint32_t kColumns = 4;
+		std::array<std::array<JobId, 5>, kColumns> ids{};
+		for (uint32_t column = 0; column < kColumns; ++column) {
+			for (int32_t row = 4; row >= 0; --row) {
+
+				JobId id = jobs.Add("Job", [&log, &ids, column, row]() { log.Push(ids[column][row]); });
+				ids[column][row] = id;
+			}
+		}
+		for (uint32_t column = 0; column < kColumns; ++column) {
+			for (uint32_t row = 1; row < 5; ++row) {
+
+				// 上の段の同じ列と隣の列に依存する
+				edges.push_back({ ids[column][row], ids[column][row - 1] });
+				edges.push_back({ ids[column][row], ids[(column + 1) % kColumns][row - 1] });
+			}
+		}
+		for (const Edge& edge : edges) {
+			jobs.AddDependency(edge.job, edge.dependency);
+		}
+
+		jobs.Run(4);
+
+		CHECK(log.GetCount() == kColumns * 5);
+		CHECK(log.IsOrdered(edges));
+		CHECK(jobs.GetStats().jobCount == kColumns * 5);
+		CHECK(jobs.GetStats().threadCount == 4);
+
+		// 実行した関数は破棄されている、もう一度Runしても実行されない
+		jobs.Run(1);
+		CHECK(log.GetCount() == kColumns * 5);
+	}
+
+	//============================================================
+	// メインスレッド限定
+	//============================================================
+	/// AddMainThreadのジョブはRunを呼んだスレッドだけが実行する
+	void TestMainThread() {
+
+		const std::thread::id mainThread = std::this_thread::get_id();
+
+		JobGraph jobs;
+		std::atomic<uint32_t> mainCount = 0;
+		std::atomic<uint32_t> wrongThreadCount = 0;
+		std::vector<JobId> mainJobs;
+
+		for (uint32_t i = 0; i < 8; ++i) {
+
+			// ワーカーが空いていても、メインスレッドのものは取らない
+			JobId work = jobs.Add("Work", []() { Sleep(1); });
+			mainJobs.push_back(jobs.AddMainThread("Main", [&]() {
+				if (std::this_thread::get_id() == mainThread) {
+					mainCount++;
+				} else {
+					wrongThreadCount++;
+				}
+				}, { work }));
+		}
+
+		jobs.Run(4);
+
+		CHECK(mainCount == 8);
+		CHECK(wrongThreadCount == 0);
+		for (JobId id : mainJobs) {
+			CHECK(jobs.GetTiming(id).threadIndex == 0);
+		}
+	}
+
+	//============================================================
+	// クリティカルパス
+	//============================================================
+	/// 時間の合計が一番長い依存の列を、依存の順に返す
+	void TestCriticalPath() {
+
+		// a(20ms) → b(30ms) → d(10ms)
+		// a → c(2ms) → d、e(5ms)は単独
+		JobGraph jobs;
+		JobId d = jobs.Add("d", []() { Sleep(10); });
+		JobId c = jobs.Add("c", []() { Sleep(2); });
+		JobId b = jobs.Add("b", []() { Sleep(30); });
+		JobId a = jobs.Add("a", []() { Sleep(20); });
+		JobId e = jobs.Add("e", []() { Sleep(5); });
+		jobs.AddDependency(b, a);
+		jobs.AddDependency(c, a);
+		jobs.AddDependency(d, b);
+		jobs.AddDependency(d, c);
+
+		jobs.Run(3);
+
+		CHECK(jobs.GetCriticalPath() == std::vector<JobId>({ a, b, d }));
+		CHECK(jobs.GetTiming(a).isCritical && jobs.GetTiming(b).isCritical && jobs.GetTiming(d).isCritical);
+		CHECK(!jobs.GetTiming(c).isCritical && !jobs.GetTiming(e).isCritical);
+
+		const JobGraph::Stats& stats = jobs.GetStats();
+		float pathMs = jobs.GetTiming(a).durationMs + jobs.GetTiming(b).durationMs + jobs.GetTiming(d).durationMs;
+		CHECK(stats.criticalPathMs == pathMs);
+		CHECK(stats.criticalPathMs >= 60.0f);
+		CHECK(stats.criticalPathMs <= stats.totalTimeMs);
+		CHECK(stats.sumTimeMs >= stats.criticalPathMs);
+	}
+
+	//============================================================
+	// 時間が同じジョブのクリティカルパス
+	//============================================================
+	/// 何もしないジョブは開始時間が同じになるが、列は依存の順に並ぶ
+	void TestCriticalPathOrder() {
+
+		// 番号と逆向きに依存する長い列と、短い枝
+		JobGraph jobs;
+		std::vector<Edge> edges;
+		std::vector<JobId> chain;
+		for (uint32_t i = 0; i < 64; ++i) {
+			chain.push_back(jobs.Add("Chain", nullptr));
+		}
+		for (uint32_t i = 1; i < chain.size(); ++i) {
+
+			edges.push_back({ chain[i - 1], chain[i] });
+			jobs.AddDependency(chain[i - 1], chain[i]);
+		}
+		JobId branch = jobs.Add("Branch", nullptr);
+		edges.push_back({ branch, chain.back() });
+		jobs.AddDependency(branch, chain.back());
+
+		jobs.Run(2);
+
+		// 辿った列は全て依存の辺でつながっている
+		const std::vector<JobId>& path = jobs.GetCriticalPath();
+		CHECK(!path.empty());
+		for (size_t i = 1; i < path.size(); ++i) {
+			CHECK(HasEdge(edges, path[i - 1], path[i]));
+		}
+		CHECK(jobs.GetStats().criticalPathMs <= jobs.GetStats().sumTimeMs);
+	}
+}
+
+//============================================================
+// JobGraph
+//============================================================
+void TestJobGraph() {
+
+	TestDependencyOrder();
+	TestMainThread();
+	TestCriticalPath();
+	TestCriticalPathOrder();
+
+	CoreTests::ExpectAbort("JobGraph.Cycle");
+}
+
+//============================================================
+// 循環した依存
+//============================================================
+void AbortJobGraphCycle() {
+
+	JobGraph jobs;
+	JobId a = jobs.Add("a", nullptr);
+	JobId b = jobs.Add("b", nullptr, { a });
+	jobs.AddDependency(a, b);
+	jobs.Run(1);
+}
\ No newline at end of file
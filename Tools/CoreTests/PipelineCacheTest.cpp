@@ -0,0 +1,214 @@
+#include <vector>
+#include <thread>
+#include <random>
+#include <algorithm>
+
+#include "CoreTests.h"
+#include "PipelineCache.h"
+#include "RecordingPipelineFactory.h"
+
+namespace {
+
+	// 3Dのオブジェクトに近い設定
+	PipelineDesc MakeDesc() {
+
+		PipelineDesc desc{};
+		desc.shader = "Object3d";
+		desc.inputElements = PIPELINE_INPUT_POSITION | PIPELINE_INPUT_TEXCOORD | PIPELINE_INPUT_NORMAL;
+		desc.rootLayout.Add(PipelineRootParameterType::CONSTANTBUFFER, PipelineShaderVisibility::PIXEL, 0);
+		desc.rootLayout.Add(PipelineRootParameterType::CONSTANTBUFFER, PipelineShaderVisibility::VERTEX, 0);
+		desc.rootLayout.Add(PipelineRootParameterType::DESCRIPTORTABLE, PipelineShaderVisibility::PIXEL, 0);
+		desc.rootLayout.useSampler = true;
+		desc.renderTargetFormat = 29; // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+		desc.depthStencilFormat = 45; // DXGI_FORMAT_D24_UNORM_S8_UINT
+		return desc;
+	}
+
+	//============================================================
+	// 設定の登録と検索
+	//============================================================
+	/// 同じ設定は同じ番号、1か所でも違えば別の番号とハッシュになる
+	void TestRegister() {
+
+		RecordingPipelineFactory factory;
+		PipelineCache cache;
+		cache.Initialize(&factory);
+
+		PipelineDesc base = MakeDesc();
+		PipelineId baseId = cache.Register(base);
+		CHECK(cache.Register(MakeDesc()) == baseId);
+		CHECK(cache.Find(MakeDesc()) == baseId);
+
+		// 1か所ずつ変えたもの
+		std::vector<PipelineDesc> variants(9, base);
+		variants[0].shader = "Object3d2";
+		variants[1].inputElements = PIPELINE_INPUT_POSITION;
+		variants[2].rootLayout.parameters[2].shaderRegister = 1;
+		variants[3].rootLayout.parameters[0].visibility = PipelineShaderVisibility::ALL;
+		variants[4].rootLayout.useSampler = false;
+		variants[5].blendMode = PipelineBlendMode::ADD;
+		variants[6].cullMode = PipelineCullMode::NONE;
+		variants[7].depthWrite = false;
+		variants[8].renderTargetFormat = 28;
+
+		std::vector<PipelineId> ids;
+		for (const auto& variant : variants) {
+
+			CHECK(!(variant == base));
+			CHECK(variant.Hash() != base.Hash());
+			CHECK(cache.Find(variant) == PipelineCache::kInvalidId);
+			ids.push_back(cache.Register(variant));
+		}
+		std::sort(ids.begin(), ids.end());
+		CHECK(std::unique(ids.begin(), ids.end()) == ids.end());
+		CHECK(std::find(ids.begin(), ids.end(), baseId) == ids.end());
+
+		// 使っていないルートパラメータの中身は比べない
+		PipelineDesc stale = base;
+		stale.rootLayout.parameters[4].shaderRegister = 7;
+		CHECK(stale == base);
+		CHECK(stale.Hash() == base.Hash());
+		CHECK(cache.Register(stale) == baseId);
+
+		PipelineCache::Stats stats = cache.GetStats();
+		CHECK(stats.registeredCount == 10);
+		CHECK(stats.duplicateCount == 2);
+		CHECK(stats.collisionCount == 0);
+
+		// 登録だけでは生成しない
+		CHECK(stats.createdCount == 0);
+		CHECK(factory.GetCreatedDescs().empty());
+	}
+
+	//============================================================
+	// 生成と破棄
+	//============================================================
+	/// 初めてのGetで1回だけ生成し、Finalizeで生成したものだけを破棄する
+	void TestCreate() {
+
+		RecordingPipelineFactory factory;
+		PipelineCache cache;
+		cache.Initialize(&factory);
+
+		PipelineDesc alpha = MakeDesc();
+		PipelineDesc add = MakeDesc();
+		add.blendMode = PipelineBlendMode::ADD;
+		PipelineDesc sprite = MakeDesc();
+		sprite.shader = "Sprite";
+		sprite.depthWrite = false;
+
+		PipelineId alphaId = cache.Register(alpha);
+		PipelineId addId = cache.Register(add);
+		PipelineId spriteId = cache.Register(sprite);
+
+		void* pipeline = cache.Get(addId);
+		CHECK(cache.Get(addId) == pipeline);
+		CHECK(cache.IsCreated(addId) && !cache.IsCreated(alphaId));
+		CHECK(factory.GetCreatedDescs().size() == 1);
+		CHECK(*static_cast<const PipelineDesc*>(pipeline) == add);
+
+		// 残りはまとめて生成する
+		cache.CreateAll();
+		CHECK(factory.GetCreatedDescs().size() == 3);
+		CHECK(cache.IsCreated(alphaId) && cache.IsCreated(spriteId));
+		CHECK(*static_cast<const PipelineDesc*>(cache.Get(spriteId)) == sprite);
+
+		PipelineCache::Stats stats = cache.GetStats();
+		CHECK(stats.createdCount == 3);
+		CHECK(stats.missCount == 3);
+		CHECK(stats.hitCount == 3);
+
+		cache.Finalize();
+		CHECK(factory.GetDestroyCount() == 3);
+		CHECK(cache.GetStats().registeredCount == 0);
+		CHECK(cache.Find(alpha) == PipelineCache::kInvalidId);
+	}
+
+	//============================================================
+	// 並列の取得
+	//============================================================
+	/// 記録の各スレッドが同時に初めてのGetをしても、1つの設定につき1回だけ生成する
+	void TestConcurrentGet() {
+
+		const uint32_t kDescCount = 64;
+		const uint32_t kThreadCount = 8;
+		const uint32_t kGetCount = 10000;
+
+		RecordingPipelineFactory factory;
+		PipelineCache cache;
+		cache.Initialize(&factory);
+
+		std::vector<PipelineId> ids;
+		for (uint32_t i = 0; i < kDescCount; ++i) {
+
+			PipelineDesc desc = MakeDesc();
+			desc.renderTargetFormat = i;
+			ids.push_back(cache.Register(desc));
+		}
+
+		// スレッドごとに最初に受け取ったものと、違うものを受け取った回数
+		std::vector<std::vector<void*>> results(kThreadCount, std::vector<void*>(kDescCount, nullptr));
+		std::vector<uint32_t> mismatchCounts(kThreadCount, 0);
+		std::vector<std::thread> threads;
+		for (uint32_t thread = 0; thread < kThreadCount; ++thread) {
+			threads.emplace_back([&, thread]() {
+
+				std::mt19937 random(thread);
+				for (uint32_t i = 0; i < kGetCount; ++i) {
+
+					uint32_t index = random() % kDescCount;
+					void* pipeline = cache.Get(ids[index]);
+					if (results[thread][index] == nullptr) {
+						results[thread][index] = pipeline;
+					} else if (results[thread][index] != pipeline) {
+						mismatchCounts[thread]++;
+					}
+				}
+				});
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		CHECK(factory.GetCreatedDescs().size() == kDescCount);
+
+		// どのスレッドも同じものを受け取っている
+		for (uint32_t index = 0; index < kDescCount; ++index) {
+			void* expected = cache.Get(ids[index]);
+			CHECK(static_cast<const PipelineDesc*>(expected)->renderTargetFormat == index);
+			for (uint32_t thread = 0; thread < kThreadCount; ++thread) {
+				CHECK(results[thread][index] == nullptr || results[thread][index] == expected);
+			}
+		}
+		for (uint32_t mismatchCount : mismatchCounts) {
+			CHECK(mismatchCount == 0);
+		}
+
+		PipelineCache::Stats stats = cache.GetStats();
+		CHECK(stats.missCount == kDescCount);
+		CHECK(stats.hitCount + stats.missCount == uint64_t(kThreadCount) * kGetCount + kDescCount);
+	}
+}
+
+//============================================================
+// PipelineCache
+//============================================================
+void TestPipelineCache() {
+
+	TestRegister();
+	TestCreate();
+	TestConcurrentGet();
+
+	CoreTests::ExpectAbort("PipelineCache.TooManyRootParameters");
+}
+
+//============================================================
+// ルートパラメータの上限超え
+//============================================================
+void AbortPipelineCacheTooManyRootParameters() {
+
+	PipelineRootLayout layout;
+	for (uint32_t i = 0; i <= PipelineRootLayout::kMaxRootParameterNum; ++i) {
+		layout.Add(PipelineRootParameterType::CONSTANTBUFFER, PipelineShaderVisibility::ALL, i);
+	}
+}
\ No newline at end of file
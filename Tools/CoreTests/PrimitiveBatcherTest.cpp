@@ -0,0 +1,232 @@
+#include <array>
+#include <vector>
+#include <string>
+#include <cmath>
+
+#include "CoreTests.h"
+#include "PrimitiveBatcher.h"
+#include "RecordingGeometryAllocator.h"
+
+namespace {
+
+	// Cameraと同じ透視投影
+	Matrix4x4 MakeViewProjection(const Vector3& cameraTranslate) {
+
+		Matrix4x4 projection{};
+		projection.m[0][0] = 1.0f / ((1280.0f / 720.0f) * std::tan(0.45f / 2.0f));
+		projection.m[1][1] = 1.0f / std::tan(0.45f / 2.0f);
+		projection.m[2][2] = 100.0f / (100.0f - 0.1f);
+		projection.m[2][3] = 1.0f;
+		projection.m[3][2] = (-100.0f * 0.1f) / (100.0f - 0.1f);
+
+		Matrix4x4 view = Inverse(MakeAffineMatrix({ 1.0f, 1.0f, 1.0f }, { 0.2f, 0.0f, 0.0f }, cameraTranslate));
+		return Multiply(view, projection);
+	}
+
+	// 三角形の頂点、Engine::DrawTriangleと同じ
+	std::array<VertexData, 3> MakeTriangle() {
+
+		return {
+			VertexData{ { -1.0f, -1.0f, 0.0f, 1.0f }, { 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f } },
+			VertexData{ { 0.0f, 1.0f, 0.0f, 1.0f }, { 0.5f, 0.0f }, { 0.0f, 0.0f, -1.0f } },
+			VertexData{ { 1.0f, -1.0f, 0.0f, 1.0f }, { 1.0f, 1.0f }, { 0.0f, 0.0f, -1.0f } },
+		};
+	}
+
+	// 行と行列の積
+	Vector4 MultiplyRow(const Vector4& v, const Matrix4x4& m) {
+
+		return {
+			v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0] + v.w * m.m[3][0],
+			v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1] + v.w * m.m[3][1],
+			v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2] + v.w * m.m[3][2],
+			v.x * m.m[0][3] + v.y * m.m[1][3] + v.z * m.m[2][3] + v.w * m.m[3][3] };
+	}
+
+	// 画面上の位置、1280x720のピクセル
+	Vector2 ToScreen(const Vector4& clip) {
+
+		return { (clip.x / clip.w * 0.5f + 0.5f) * 1280.0f, (clip.y / clip.w * 0.5f + 0.5f) * 720.0f };
+	}
+
+	PrimitiveBatchKey MakeKey(const std::string& textureName, const Matrix4x4& viewProjection) {
+
+		PrimitiveBatchKey key{};
+		key.pipelineType = 1;
+		key.textureName = textureName;
+		key.material.color = { 1.0f, 1.0f, 1.0f, 1.0f };
+		key.material.uvTransform = MakeIdentity4x4();
+		key.viewProjection = viewProjection;
+		return key;
+	}
+
+	// 発行された描画
+	struct FlushLog {
+
+		std::vector<PrimitiveBatch> batches;
+		std::vector<std::string> textureNames;
+	};
+
+	void Connect(PrimitiveBatcher& batcher, FlushLog& log) {
+
+		batcher.SetFlushFunction([&log](const PrimitiveBatchKey& key, const PrimitiveBatch& batch) {
+			log.batches.push_back(batch);
+			log.textureNames.push_back(key.textureName);
+			});
+	}
+
+	//============================================================
+	// Worldの焼き込み
+	//============================================================
+	/// 焼き込んだ頂点を戻したビュープロジェクションで描くと、元のWVPと同じ位置になる
+	/// 同じカメラなら置いた場所が違ってもまとめられ、別のカメラはまとめない
+	void TestBakeWorld() {
+
+		Matrix4x4 viewProjection = MakeViewProjection({ 0.0f, 2.0f, -10.0f });
+
+		const Transform kTransforms[] = {
+			{ { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } },
+			{ { 2.0f, 0.5f, 1.0f }, { 0.3f, 1.2f, -0.4f }, { 3.0f, -1.0f, 5.0f } },
+			{ { 0.1f, 0.1f, 0.1f }, { 0.0f, 3.0f, 0.0f }, { -20.0f, 4.0f, 60.0f } },
+			{ { 5.0f, 5.0f, 5.0f }, { 1.0f, 0.0f, 2.0f }, { 40.0f, -15.0f, 80.0f } },
+		};
+
+		PrimitiveBatchKey firstKey{};
+		for (uint32_t i = 0; i < std::size(kTransforms); ++i) {
+
+			const Transform& transform = kTransforms[i];
+			TransformationMatrix matrix{};
+			matrix.World = MakeAffineMatrix(transform.scale, transform.rotate, transform.translate);
+			matrix.WVP = Multiply(matrix.World, viewProjection);
+
+			std::array<VertexData, 3> vertices = MakeTriangle();
+			PrimitiveBatchKey key = MakeKey("uvChecker", {});
+			CHECK(PrimitiveBatcher::BakeWorld(matrix, vertices.data(), 3, key.viewProjection));
+
+			// 0.01ピクセル以内で同じ位置
+			std::array<VertexData, 3> original = MakeTriangle();
+			for (uint32_t v = 0; v < 3; ++v) {
+
+				Vector2 expected = ToScreen(MultiplyRow(original[v].pos, matrix.WVP));
+				Vector2 baked = ToScreen(MultiplyRow(vertices[v].pos, key.viewProjection));
+				CHECK(std::fabs(expected.x - baked.x) < 0.01f && std::fabs(expected.y - baked.y) < 0.01f);
+
+				// 最初の物体のカメラで描いても同じ位置、まとめたときは最初の条件で描く
+				if (i != 0) {
+					Vector2 merged = ToScreen(MultiplyRow(vertices[v].pos, firstKey.viewProjection));
+					CHECK(std::fabs(expected.x - merged.x) < 0.01f && std::fabs(expected.y - merged.y) < 0.01f);
+				}
+
+				// 法線はWorldの向きに回る
+				Vector4 normal = MultiplyRow({ original[v].normal.x, original[v].normal.y, original[v].normal.z, 0.0f }, matrix.World);
+				CHECK(std::fabs(vertices[v].normal.x - normal.x) < 1.0e-5f && std::fabs(vertices[v].normal.z - normal.z) < 1.0e-5f);
+			}
+
+			if (i == 0) {
+				firstKey = key;
+			} else {
+				CHECK(firstKey.IsBatchableWith(key));
+			}
+		}
+
+		// カメラが動けばまとめない
+		CHECK(!firstKey.IsBatchableWith(MakeKey("uvChecker", MakeViewProjection({ 0.0f, 2.0f, -10.01f }))));
+
+		// 潰れたWorldは描かない
+		TransformationMatrix flat{};
+		flat.World = MakeAffineMatrix({ 0.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f });
+		flat.WVP = Multiply(flat.World, viewProjection);
+		std::array<VertexData, 3> vertices = MakeTriangle();
+		Matrix4x4 unused{};
+		CHECK(!PrimitiveBatcher::BakeWorld(flat, vertices.data(), 3, unused));
+		CHECK(vertices[0].pos.x == -1.0f);
+	}
+
+	//============================================================
+	// 隣り合う描画のまとめと分割
+	//============================================================
+	/// 同じ条件で続けて置かれたものだけを1回にまとめ、条件かページが変われば分ける
+	void TestMerge() {
+
+		Matrix4x4 viewProjection = MakeViewProjection({ 0.0f, 0.0f, -10.0f });
+		const uint32_t kStride = sizeof(VertexData);
+		std::array<VertexData, 3> triangle = MakeTriangle();
+		std::array<VertexData, 12> prism{};
+
+		RecordingGeometryAllocator allocator;
+		GeometryArena arena;
+		arena.Initialize(&allocator, kStride * 30);
+
+		PrimitiveBatcher batcher;
+		FlushLog log;
+		batcher.SetArena(&arena);
+		Connect(batcher, log);
+
+		// 三角形と三角錐は同じ条件なら1回
+		PrimitiveBatchKey checker = MakeKey("uvChecker", viewProjection);
+		batcher.Add(checker, triangle.data(), 3, kStride);
+		batcher.Add(checker, prism.data(), 12, kStride);
+		batcher.Add(checker, triangle.data(), 3, kStride);
+		CHECK(batcher.GetPendingCount() == 3);
+		CHECK(log.batches.empty());
+
+		// テクスチャが変わったら溜まっている分を先に発行する
+		batcher.Add(MakeKey("white", viewProjection), triangle.data(), 3, kStride);
+		CHECK(log.batches.size() == 1);
+		CHECK(log.batches[0].startVertex == 0 && log.batches[0].vertexCount == 18);
+		CHECK(log.batches[0].primitiveCount == 3);
+		CHECK(log.textureNames[0] == "uvChecker");
+
+		// 間に別の条件が入れば同じ条件でも分かれる
+		batcher.Add(checker, triangle.data(), 3, kStride);
+		CHECK(log.batches.size() == 2);
+		CHECK(log.batches[1].startVertex == 18 && log.batches[1].vertexCount == 3);
+
+		// マテリアルが変われば分ける
+		PrimitiveBatchKey red = checker;
+		red.material.color = { 1.0f, 0.0f, 0.0f, 1.0f };
+		batcher.Add(red, triangle.data(), 3, kStride);
+		CHECK(log.batches.size() == 3);
+
+		// ページに入らなければ、同じ条件でも次のページから別の描画にする
+		batcher.Add(red, prism.data(), 12, kStride);
+		CHECK(log.batches.size() == 4);
+		CHECK(log.batches[3].startVertex == 24 && log.batches[3].primitiveCount == 1);
+		batcher.Flush();
+		CHECK(log.batches.size() == 5);
+		CHECK(log.batches[4].startVertex == 0 && log.batches[4].vertexCount == 12);
+		CHECK(log.batches[4].vertexBufferAddress != log.batches[0].vertexBufferAddress);
+
+		// 溜まっていなければ何もしない
+		batcher.Flush();
+		CHECK(log.batches.size() == 5);
+
+		const PrimitiveBatcher::Stats& stats = batcher.GetStats();
+		CHECK(stats.primitives == 7);
+		CHECK(stats.vertices == 39);
+		CHECK(stats.drawCalls == 5);
+		CHECK(stats.maxPrimitivesPerDraw == 3);
+		CHECK(std::fabs(stats.GetPrimitivesPerDraw() - 7.0f / 5.0f) < 1.0e-6f);
+
+		// 次のフレームは回収したページの先頭から
+		arena.FinishFrame(1);
+		arena.ReleaseCompletedFrames(1);
+		batcher.ResetStats();
+		batcher.Add(checker, triangle.data(), 3, kStride);
+		batcher.Flush();
+		CHECK(log.batches.back().startVertex == 0);
+		CHECK(batcher.GetStats().drawCalls == 1);
+
+		arena.FinishFrame(2);
+		arena.Finalize();
+	}
+}
+
+//============================================================
+// PrimitiveBatcher
+//============================================================
+void TestPrimitiveBatcher() {
+
+	TestBakeWorld();
+	TestMerge();
+}
\ No newline at end of file
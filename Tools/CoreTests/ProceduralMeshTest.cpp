@@ -0,0 +1,241 @@
+#include <vector>
+#include <cmath>
+
+#include "CoreTests.h"
+#include "ProceduralMesh.h"
+#include "MeshCache.h"
+
+namespace {
+
+	//============================================================
+	// RecordingMeshFactory class
+	//============================================================
+	/// 生成と破棄の数だけ数えるMeshCacheの生成先
+	class RecordingMeshFactory : public IMeshFactory {
+	public:
+
+		void* CreateMesh(const ProceduralMeshData& data) override {
+
+			createdVertexCounts_.push_back(static_cast<uint32_t>(data.vertices.size()));
+			return new uint32_t(static_cast<uint32_t>(createdVertexCounts_.size()));
+		}
+
+		void DestroyMesh(void* mesh) override {
+
+			delete static_cast<uint32_t*>(mesh);
+			++destroyCount_;
+		}
+
+		uint32_t GetCreateCount() const { return static_cast<uint32_t>(createdVertexCounts_.size()); }
+		uint32_t GetDestroyCount() const { return destroyCount_; }
+
+	private:
+
+		std::vector<uint32_t> createdVertexCounts_;
+		uint32_t destroyCount_ = 0;
+	};
+
+	ProceduralMeshDesc MakeDesc(ProceduralMeshType type, uint32_t segments, uint32_t rings, uint32_t lod = 0) {
+
+		ProceduralMeshDesc desc{};
+		desc.type = type;
+		desc.segments = segments;
+		desc.rings = rings;
+		desc.lod = lod;
+		return desc;
+	}
+
+	Vector3 Subtract(const Vector4& a, const Vector4& b) {
+
+		return { a.x - b.x, a.y - b.y, a.z - b.z };
+	}
+
+	Vector3 Cross(const Vector3& a, const Vector3& b) {
+
+		return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+	}
+
+	float Dot(const Vector3& a, const Vector3& b) {
+
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	// インデックスが範囲内で、位置は[-1, 1]、法線は長さ1
+	bool IsValidMesh(const ProceduralMeshData& mesh) {
+
+		if (mesh.vertices.empty() || mesh.indices.empty() || mesh.indices.size() % 3 != 0) {
+			return false;
+		}
+		for (uint32_t index : mesh.indices) {
+			if (index >= mesh.vertices.size()) {
+				return false;
+			}
+		}
+		const float kEpsilon = 1.0e-4f;
+		for (const VertexData& vertex : mesh.vertices) {
+
+			const Vector4& p = vertex.pos;
+			if (std::abs(p.x) > 1.0f + kEpsilon || std::abs(p.y) > 1.0f + kEpsilon || std::abs(p.z) > 1.0f + kEpsilon || p.w != 1.0f) {
+				return false;
+			}
+			if (std::abs(Dot(vertex.normal, vertex.normal) - 1.0f) > kEpsilon) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// 全ての三角形が外側から見て時計回り
+	// 左手座標系なので、時計回りの面は(b - a) x (c - a)が見ている側、頂点の法線と同じ側を向く
+	bool IsClockwiseFromOutside(const ProceduralMeshData& mesh) {
+
+		for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+
+			const VertexData& a = mesh.vertices[mesh.indices[i]];
+			const VertexData& b = mesh.vertices[mesh.indices[i + 1]];
+			const VertexData& c = mesh.vertices[mesh.indices[i + 2]];
+
+			Vector3 faceNormal = Cross(Subtract(b.pos, a.pos), Subtract(c.pos, a.pos));
+			// 極に集まる面積のない三角形は向きがない
+			if (Dot(faceNormal, faceNormal) < 1.0e-12f) {
+				continue;
+			}
+			Vector3 normal = { a.normal.x + b.normal.x + c.normal.x, a.normal.y + b.normal.y + c.normal.y, a.normal.z + b.normal.z + c.normal.z };
+			if (Dot(faceNormal, normal) <= 0.0f) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//============================================================
+	// 形状
+	//============================================================
+	/// 全ての形状でインデックスが頂点の範囲内に収まり、三角形の向きが揃う
+	void TestShapes() {
+
+		const ProceduralMeshDesc descs[] = {
+			MakeDesc(ProceduralMeshType::UVSPHERE, 16, 8),
+			MakeDesc(ProceduralMeshType::UVSPHERE, 3, 2),
+			MakeDesc(ProceduralMeshType::ICOSPHERE, 0, 0),
+			MakeDesc(ProceduralMeshType::ICOSPHERE, 3, 0),
+			MakeDesc(ProceduralMeshType::PLANE, 4, 3),
+			MakeDesc(ProceduralMeshType::BOX, 1, 0),
+			MakeDesc(ProceduralMeshType::BOX, 3, 0),
+			MakeDesc(ProceduralMeshType::PRISM, 6, 2),
+			MakeDesc(ProceduralMeshType::CYLINDER, 7, 3),
+		};
+
+		for (const ProceduralMeshDesc& desc : descs) {
+
+			ProceduralMeshData mesh = ProceduralMesh::Generate(desc);
+			CHECK(IsValidMesh(mesh));
+			CHECK(IsClockwiseFromOutside(mesh));
+		}
+
+		// 正二十面体の分割は辺の中点を共有する
+		ProceduralMeshData icosphere = ProceduralMesh::CreateIcosphere(2);
+		CHECK(icosphere.vertices.size() == 162);
+		CHECK(icosphere.indices.size() == 320 * 3);
+
+		// 平面は分割の数だけ四角形を並べる
+		ProceduralMeshData plane = ProceduralMesh::CreatePlane(4, 3);
+		CHECK(plane.vertices.size() == 5 * 4);
+		CHECK(plane.indices.size() == 4 * 3 * 6);
+	}
+
+	//============================================================
+	// LOD
+	//============================================================
+	/// lodは分割数を半分にしていき、最小の分割数とkMaxLodで止まる
+	void TestResolve() {
+
+		ProceduralMeshDesc sphere = MakeDesc(ProceduralMeshType::UVSPHERE, 16, 12, 1).Resolve();
+		CHECK(sphere.segments == 8 && sphere.rings == 6 && sphere.lod == 0);
+
+		// kMaxLodより上は同じ
+		ProceduralMeshDesc coarse = MakeDesc(ProceduralMeshType::UVSPHERE, 64, 64, 10).Resolve();
+		CHECK(coarse == MakeDesc(ProceduralMeshType::UVSPHERE, 64, 64, ProceduralMeshDesc::kMaxLod).Resolve());
+		CHECK(coarse.segments == 4 && coarse.rings == 4);
+
+		// 最小の分割数で止まる
+		ProceduralMeshDesc cylinder = MakeDesc(ProceduralMeshType::CYLINDER, 8, 2, 3).Resolve();
+		CHECK(cylinder.segments == 3 && cylinder.rings == 1);
+		ProceduralMeshDesc box = MakeDesc(ProceduralMeshType::BOX, 4, 9, 4).Resolve();
+		CHECK(box.segments == 1 && box.rings == 0);
+
+		// ICOSPHEREは1段で分割を1回減らす
+		ProceduralMeshDesc icosphere = MakeDesc(ProceduralMeshType::ICOSPHERE, 3, 5, 1).Resolve();
+		CHECK(icosphere.segments == 2 && icosphere.rings == 0);
+		CHECK(MakeDesc(ProceduralMeshType::ICOSPHERE, 3, 0, 4).Resolve().segments == 0);
+
+		// 既定の分割数のままでも生成できる回数に抑える
+		ProceduralMeshDesc defaultIcosphere{};
+		defaultIcosphere.type = ProceduralMeshType::ICOSPHERE;
+		CHECK(defaultIcosphere.Resolve().segments == ProceduralMeshDesc::kMaxIcosphereSubdivision);
+		defaultIcosphere.lod = 3;
+		CHECK(defaultIcosphere.Resolve().segments == ProceduralMeshDesc::kMaxIcosphereSubdivision - 3);
+		CHECK(IsValidMesh(ProceduralMesh::Generate(defaultIcosphere.Resolve())));
+	}
+
+	//============================================================
+	// キャッシュ
+	//============================================================
+	/// 同じ設定と、lodを反映して同じになる設定は1つのメッシュを使う
+	void TestMeshCache() {
+
+		RecordingMeshFactory factory;
+		{
+			MeshCache cache;
+			cache.Initialize(&factory);
+
+			ProceduralMeshDesc sphere = MakeDesc(ProceduralMeshType::UVSPHERE, 16, 16);
+			MeshId a = cache.Get(sphere);
+			CHECK(cache.Get(sphere) == a);
+			CHECK(factory.GetCreateCount() == 1);
+
+			// 同じ設定は同じハッシュ
+			CHECK(sphere.Hash() == MakeDesc(ProceduralMeshType::UVSPHERE, 16, 16).Hash());
+			CHECK(sphere.Hash() != MakeDesc(ProceduralMeshType::UVSPHERE, 16, 16, 1).Hash());
+
+			// lodを反映すると同じ分割数になるもの
+			MeshId b = cache.Get(MakeDesc(ProceduralMeshType::UVSPHERE, 16, 16, 1));
+			CHECK(b != a);
+			CHECK(cache.Get(MakeDesc(ProceduralMeshType::UVSPHERE, 8, 8)) == b);
+			CHECK(cache.GetDesc(b) == MakeDesc(ProceduralMeshType::UVSPHERE, 8, 8));
+
+			// 分割数が同じでも形状が違えば別
+			MeshId c = cache.Get(MakeDesc(ProceduralMeshType::CYLINDER, 16, 16));
+			CHECK(c != a && c != b);
+
+			// 既定の設定のICOSPHEREも生成できる
+			ProceduralMeshDesc icosphere{};
+			icosphere.type = ProceduralMeshType::ICOSPHERE;
+			icosphere.lod = ProceduralMeshDesc::kMaxLod;
+			MeshId d = cache.Get(icosphere);
+			CHECK(cache.GetDesc(d).segments == ProceduralMeshDesc::kMaxIcosphereSubdivision - ProceduralMeshDesc::kMaxLod);
+
+			const MeshCache::Stats& stats = cache.GetStats();
+			CHECK(stats.meshCount == 4);
+			CHECK(stats.missCount == 4);
+			CHECK(stats.hitCount == 2);
+			CHECK(stats.vertexCount == uint64_t(cache.GetVertexCount(a)) + cache.GetVertexCount(b) + cache.GetVertexCount(c) + cache.GetVertexCount(d));
+			CHECK(stats.indexCount == uint64_t(cache.GetIndexCount(a)) + cache.GetIndexCount(b) + cache.GetIndexCount(c) + cache.GetIndexCount(d));
+			CHECK(factory.GetCreateCount() == 4);
+			CHECK(factory.GetDestroyCount() == 0);
+		}
+
+		// 破棄で生成したものを全て返す
+		CHECK(factory.GetDestroyCount() == 4);
+	}
+}
+
+//============================================================
+// ProceduralMesh
+//============================================================
+void TestProceduralMesh() {
+
+	TestShapes();
+	TestResolve();
+	TestMeshCache();
+}
\ No newline at end of file
@@ -0,0 +1,316 @@
+#include <vector>
+#include <string>
+
+#include "CoreTests.h"
+#include "RenderGraph.h"
+#include "RecordingBarrierContext.h"
+
+namespace {
+
+	const uint64_t kTextureSize = 1024 * 1024;
+
+	// 一時的なテクスチャの設定
+	RenderGraphTextureDesc MakeDesc(const char* name, uint64_t size, uint32_t usage = RENDERGRAPH_STATE_RENDERTARGET) {
+
+		RenderGraphTextureDesc desc{};
+		desc.name = name;
+		desc.usage = usage;
+		desc.size = size;
+		return desc;
+	}
+
+	//============================================================
+	// 実行の記録
+	//============================================================
+	/// パスごとに、直前に張られたバリアと捨てられたテクスチャを分けて残す
+	struct ExecuteLog {
+
+		RecordingBarrierContext context;
+		// パスを実行した時点のバッチの数と捨てた数、実行順
+		std::vector<size_t> batchMarks;
+		std::vector<size_t> discardMarks;
+
+		std::function<void()> Mark() {
+			return [this]() {
+				batchMarks.push_back(context.GetBatches().size());
+				discardMarks.push_back(context.GetDiscards().size());
+				};
+		}
+
+		// passIndex番目に実行したパスの前に張ったバリア
+		std::vector<RenderGraphBarrier> BarriersBefore(size_t passIndex) const {
+
+			size_t begin = passIndex == 0 ? 0 : batchMarks[passIndex - 1];
+			std::vector<RenderGraphBarrier> barriers;
+			for (size_t i = begin; i < batchMarks[passIndex]; ++i) {
+				barriers.insert(barriers.end(), context.GetBatches()[i].begin(), context.GetBatches()[i].end());
+			}
+			return barriers;
+		}
+
+		// passIndex番目に実行したパスの前に捨てたもの
+		std::vector<RenderGraphResource> DiscardsBefore(size_t passIndex) const {
+
+			size_t begin = passIndex == 0 ? 0 : discardMarks[passIndex - 1];
+			return std::vector<RenderGraphResource>(
+				context.GetDiscards().begin() + begin, context.GetDiscards().begin() + discardMarks[passIndex]);
+		}
+	};
+
+	// 数えたバリアと記録したバリアが一致する
+	void CheckCounts(const RenderGraph& graph, const ExecuteLog& log) {
+
+		const RenderGraph::Stats& stats = graph.GetStats();
+		CHECK(stats.barrierCount == log.context.GetBarrierCount());
+		CHECK(stats.barrierBatchCount == log.context.GetBatches().size());
+		CHECK(stats.discardCount == log.context.GetDiscards().size());
+	}
+
+	//============================================================
+	// パスの削除
+	//============================================================
+	/// 出力に繋がらないパスは消え、SetSideEffectしたものは残る
+	void TestCulling() {
+
+		RenderGraph graph;
+		RenderGraphResource backBuffer = graph.ImportResource("BackBuffer", RENDERGRAPH_STATE_PRESENT, RENDERGRAPH_STATE_PRESENT);
+		RenderGraphResource unused = graph.CreateTexture(MakeDesc("Unused", kTextureSize));
+		RenderGraphResource debug = graph.CreateTexture(MakeDesc("Debug", kTextureSize));
+
+		bool isUnusedExecuted = false;
+		graph.AddPass("Unused", [&](RenderGraphBuilder& builder) {
+			builder.Write(unused, RENDERGRAPH_STATE_RENDERTARGET);
+			}, [&]() { isUnusedExecuted = true; });
+		graph.AddPass("Debug", [&](RenderGraphBuilder& builder) {
+			builder.Write(debug, RENDERGRAPH_STATE_RENDERTARGET);
+			builder.SetSideEffect();
+			}, nullptr);
+		graph.AddPass("Main", [&](RenderGraphBuilder& builder) {
+			builder.Write(backBuffer, RENDERGRAPH_STATE_RENDERTARGET);
+			}, nullptr);
+
+		graph.Compile();
+
+		CHECK(graph.GetCompiledPassNames() == std::vector<std::string>({ "Debug", "Main" }));
+		CHECK(graph.GetStats().passCount == 3);
+		CHECK(graph.GetStats().culledPassCount == 1);
+
+		// 消したパスのテクスチャは置かない
+		CHECK(graph.GetStats().transientCount == 1);
+		CHECK(graph.GetPlacements().size() == 1 && graph.GetPlacements()[0].resource == debug);
+
+		ExecuteLog log;
+		graph.Execute(log.context);
+		CHECK(!isUnusedExecuted);
+		CheckCounts(graph, log);
+	}
+
+	//============================================================
+	// 読み取りの状態をまとめる
+	//============================================================
+	/// 続けて読む2つのパスの状態は1回の遷移にまとめ、2つ目の前では張らない
+	void TestMergedReads() {
+
+		RenderGraph graph;
+		ExecuteLog log;
+		RenderGraphResource backBuffer = graph.ImportResource("BackBuffer", RENDERGRAPH_STATE_PRESENT, RENDERGRAPH_STATE_PRESENT);
+		RenderGraphResource scene = graph.CreateTexture(MakeDesc("Scene", kTextureSize));
+
+		graph.AddPass("Scene", [&](RenderGraphBuilder& builder) {
+			builder.Write(scene, RENDERGRAPH_STATE_RENDERTARGET);
+			}, log.Mark());
+		graph.AddPass("Composite", [&](RenderGraphBuilder& builder) {
+			builder.Read(scene, RENDERGRAPH_STATE_PIXELSHADERRESOURCE);
+			builder.Write(backBuffer, RENDERGRAPH_STATE_RENDERTARGET);
+			}, log.Mark());
+		graph.AddPass("Histogram", [&](RenderGraphBuilder& builder) {
+			builder.Read(scene, RENDERGRAPH_STATE_NONPIXELSHADERRESOURCE);
+			builder.Write(backBuffer, RENDERGRAPH_STATE_RENDERTARGET);
+			}, log.Mark());
+
+		graph.Compile();
+		graph.Execute(log.context);
+		CHECK(log.batchMarks.size() == 3);
+
+		const uint32_t kMerged = RENDERGRAPH_STATE_PIXELSHADERRESOURCE | RENDERGRAPH_STATE_NONPIXELSHADERRESOURCE;
+
+		// 最初の状態で生成するので遷移はない
+		CHECK(log.BarriersBefore(0).empty());
+
+		std::vector<RenderGraphBarrier> composite = log.BarriersBefore(1);
+		CHECK(composite.size() == 2);
+		uint32_t sceneTransitionCount = 0;
+		for (const auto& barrier : composite) {
+			CHECK(barrier.type == RenderGraphBarrier::Type::TRANSITION);
+			if (barrier.resource == scene) {
+				sceneTransitionCount++;
+				CHECK(barrier.stateBefore == RENDERGRAPH_STATE_RENDERTARGET);
+				CHECK(barrier.stateAfter == kMerged);
+			} else {
+				CHECK(barrier.resource == backBuffer);
+				CHECK(barrier.stateBefore == RENDERGRAPH_STATE_PRESENT);
+				CHECK(barrier.stateAfter == RENDERGRAPH_STATE_RENDERTARGET);
+			}
+		}
+		CHECK(sceneTransitionCount == 1);
+		CHECK(log.BarriersBefore(2).empty());
+
+		// 最後にテクスチャは次のフレームの最初の状態へ、バックバッファは指定の状態へ戻す
+		CHECK(!log.context.GetBatches().empty() && log.context.GetBatches().back().size() == 2);
+		CHECK(graph.GetStats().barrierCount == 4);
+		CHECK(graph.GetStats().barrierBatchCount == 2);
+		CheckCounts(graph, log);
+	}
+
+	//============================================================
+	// メモリの共有
+	//============================================================
+	/// 寿命が重ならないものは同じ場所に置き、重なるものは別の場所に置く
+	/// 共有した場所ではALIASINGを張ってから捨てる
+	void TestAliasing() {
+
+		RenderGraph graph;
+		ExecuteLog log;
+		RenderGraphResource backBuffer = graph.ImportResource("BackBuffer", RENDERGRAPH_STATE_PRESENT, RENDERGRAPH_STATE_PRESENT);
+		RenderGraphResource a = graph.CreateTexture(MakeDesc("A", kTextureSize * 2));
+		RenderGraphResource b = graph.CreateTexture(MakeDesc("B", kTextureSize));
+		RenderGraphResource c = graph.CreateTexture(MakeDesc("C", kTextureSize));
+
+		// Aは0から1、Bは1から2、Cは2から3で使う
+		graph.AddPass("WriteA", [&](RenderGraphBuilder& builder) {
+			builder.Write(a, RENDERGRAPH_STATE_RENDERTARGET);
+			}, log.Mark());
+		graph.AddPass("AToB", [&](RenderGraphBuilder& builder) {
+			builder.Read(a, RENDERGRAPH_STATE_PIXELSHADERRESOURCE);
+			builder.Write(b, RENDERGRAPH_STATE_RENDERTARGET);
+			}, log.Mark());
+		graph.AddPass("BToC", [&](RenderGraphBuilder& builder) {
+			builder.Read(b, RENDERGRAPH_STATE_PIXELSHADERRESOURCE);
+			builder.Write(c, RENDERGRAPH_STATE_RENDERTARGET);
+			}, log.Mark());
+		graph.AddPass("CToBackBuffer", [&](RenderGraphBuilder& builder) {
+			builder.Read(c, RENDERGRAPH_STATE_PIXELSHADERRESOURCE);
+			builder.Write(backBuffer, RENDERGRAPH_STATE_RENDERTARGET);
+			}, log.Mark());
+
+		graph.Compile();
+
+		// 大きいAを先に0へ、Bは重なるので後ろへ、CはAと同じ0へ置く
+		const auto& placements = graph.GetPlacements();
+		CHECK(placements.size() == 3);
+		if (placements.size() == 3) {
+			CHECK(placements[0].resource == a && placements[0].offset == 0);
+			CHECK(placements[1].resource == b && placements[1].offset == kTextureSize * 2);
+			CHECK(placements[2].resource == c && placements[2].offset == 0);
+			for (const auto& placement : placements) {
+				CHECK(placement.offset % 65536 == 0);
+				CHECK(placement.initialState == RENDERGRAPH_STATE_RENDERTARGET);
+			}
+		}
+		CHECK(graph.GetStats().transientSize == kTextureSize * 4);
+		CHECK(graph.GetStats().transientHeapSize == kTextureSize * 3);
+
+		graph.Execute(log.context);
+		CHECK(log.batchMarks.size() == 4);
+
+		// 共有した場所で使い始めるときはALIASINGを張る、Cの前はA
+		auto findAliasing = [](const std::vector<RenderGraphBarrier>& barriers, RenderGraphResource resource) {
+			for (const auto& barrier : barriers) {
+				if (barrier.type == RenderGraphBarrier::Type::ALIASING && barrier.resource == resource) {
+					return &barrier;
+				}
+			}
+			return static_cast<const RenderGraphBarrier*>(nullptr);
+			};
+
+		std::vector<RenderGraphBarrier> writeA = log.BarriersBefore(0);
+		const RenderGraphBarrier* aliasingA = findAliasing(writeA, a);
+		CHECK(aliasingA && aliasingA->resourceBefore == RenderGraph::kInvalidResource);
+		CHECK(!findAliasing(log.BarriersBefore(1), b));
+		std::vector<RenderGraphBarrier> bToC = log.BarriersBefore(2);
+		const RenderGraphBarrier* aliasingC = findAliasing(bToC, c);
+		CHECK(aliasingC && aliasingC->resourceBefore == a);
+
+		// 使い始めに書き込むものは全て、そのパスのバリアの後に捨てる
+		CHECK(log.DiscardsBefore(0) == std::vector<RenderGraphResource>({ a }));
+		CHECK(log.DiscardsBefore(1) == std::vector<RenderGraphResource>({ b }));
+		CHECK(log.DiscardsBefore(2) == std::vector<RenderGraphResource>({ c }));
+		CHECK(log.DiscardsBefore(3).empty());
+		const auto& discardBatchCounts = log.context.GetDiscardBatchCounts();
+		for (size_t i = 0; i < discardBatchCounts.size(); ++i) {
+			CHECK(discardBatchCounts[i] == log.batchMarks[i]);
+		}
+
+		CHECK(graph.GetStats().barrierCount == 10);
+		CHECK(graph.GetStats().barrierBatchCount == 5);
+		CHECK(graph.GetStats().discardCount == 3);
+		CheckCounts(graph, log);
+
+		// コンパイルし直しても同じになる
+		graph.Compile();
+		ExecuteLog again;
+		graph.Execute(again.context);
+		CHECK(again.context.GetBarrierCount() == log.context.GetBarrierCount());
+		CHECK(again.context.GetDiscards() == log.context.GetDiscards());
+	}
+
+	//============================================================
+	// UAVの書き込みの待ち
+	//============================================================
+	/// 同じ状態のまま続けて書くときはUNORDEREDACCESSを張る。COPYDESTから使い始めるものは捨てない
+	void TestUnorderedAccess() {
+
+		RenderGraph graph;
+		ExecuteLog log;
+		RenderGraphResource buffer = graph.CreateTexture(MakeDesc("Buffer", kTextureSize, RENDERGRAPH_STATE_UNORDEREDACCESS));
+		RenderGraphResource copied = graph.CreateTexture(MakeDesc("Copied", kTextureSize));
+
+		graph.AddPass("Clear", [&](RenderGraphBuilder& builder) {
+			builder.Write(buffer, RENDERGRAPH_STATE_UNORDEREDACCESS);
+			}, log.Mark());
+		graph.AddPass("Accumulate", [&](RenderGraphBuilder& builder) {
+			builder.Write(buffer, RENDERGRAPH_STATE_UNORDEREDACCESS);
+			builder.Write(copied, RENDERGRAPH_STATE_COPYDEST);
+			builder.SetSideEffect();
+			}, log.Mark());
+
+		graph.Compile();
+		graph.Execute(log.context);
+
+		std::vector<RenderGraphBarrier> accumulate = log.BarriersBefore(1);
+		CHECK(accumulate.size() == 1);
+		if (accumulate.size() == 1) {
+			CHECK(accumulate[0].type == RenderGraphBarrier::Type::UNORDEREDACCESS);
+			CHECK(accumulate[0].resource == buffer);
+		}
+		CHECK(log.DiscardsBefore(0) == std::vector<RenderGraphResource>({ buffer }));
+		CHECK(log.DiscardsBefore(1).empty());
+		CheckCounts(graph, log);
+	}
+}
+
+//============================================================
+// RenderGraph
+//============================================================
+void TestRenderGraph() {
+
+	TestCulling();
+	TestMergedReads();
+	TestAliasing();
+	TestUnorderedAccess();
+
+	CoreTests::ExpectAbort("RenderGraph.ConflictingWrite");
+}
+
+//============================================================
+// 1つのパスで2種類の書き込み
+//============================================================
+void AbortRenderGraphConflictingWrite() {
+
+	RenderGraph graph;
+	RenderGraphResource texture = graph.CreateTexture(MakeDesc("Texture", kTextureSize));
+	graph.AddPass("Conflict", [&](RenderGraphBuilder& builder) {
+		builder.Write(texture, RENDERGRAPH_STATE_RENDERTARGET);
+		builder.Write(texture, RENDERGRAPH_STATE_UNORDEREDACCESS);
+		}, nullptr);
+}
\ No newline at end of file
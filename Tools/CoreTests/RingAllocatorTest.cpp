@@ -0,0 +1,203 @@
+#include <map>
+#include <deque>
+#include <random>
+#include <iterator>
+
+#include "CoreTests.h"
+#include "RingAllocator.h"
+
+namespace {
+
+	//============================================================
+	// 確保とフェンス値での回収
+	//============================================================
+	void TestBasic() {
+
+		RingAllocator allocator;
+		allocator.Initialize(1024);
+
+		CHECK(allocator.Allocate(100, 16) == 0);
+		// 境界に合わせた隙間も使用量に入る
+		CHECK(allocator.Allocate(10, 256) == 256);
+		CHECK(allocator.GetUsedSize() == 266);
+		CHECK(allocator.GetStats().frameSize == 266);
+
+		// 0と容量より大きいものは失敗する
+		CHECK(allocator.Allocate(0, 16) == RingAllocator::kInvalidOffset);
+		CHECK(allocator.Allocate(2048, 16) == RingAllocator::kInvalidOffset);
+		CHECK(allocator.GetStats().failedCount == 2);
+		CHECK(allocator.GetStats().allocations == 2);
+
+		allocator.FinishFrame(1);
+		CHECK(allocator.GetStats().frameSize == 0);
+		CHECK(allocator.GetPendingFrameCount() == 1);
+		CHECK(allocator.GetOldestPendingFenceValue() == 1);
+
+		// 確保のないフレームは積まない
+		allocator.FinishFrame(2);
+		CHECK(allocator.GetPendingFrameCount() == 1);
+
+		// 完了するまでは回収しない
+		allocator.ReleaseCompletedFrames(0);
+		CHECK(allocator.GetUsedSize() == 266);
+		allocator.ReleaseCompletedFrames(1);
+		CHECK(allocator.IsEmpty());
+		CHECK(allocator.GetPendingFrameCount() == 0);
+		CHECK(allocator.GetOldestPendingFenceValue() == 0);
+
+		// 空になったら先頭から使う
+		CHECK(allocator.Allocate(64, 16) == 0);
+	}
+
+	//============================================================
+	// 折り返し
+	//============================================================
+	/// 後ろに入らないときは末尾を捨てて先頭へ戻り、使用中の先頭は越えない
+	void TestWrap() {
+
+		RingAllocator allocator;
+		allocator.Initialize(1024);
+
+		CHECK(allocator.Allocate(600, 1) == 0);
+		allocator.FinishFrame(1);
+		CHECK(allocator.Allocate(300, 1) == 600);
+		allocator.FinishFrame(2);
+
+		allocator.ReleaseCompletedFrames(1);
+		CHECK(allocator.GetUsedSize() == 300);
+
+		// 末尾の124を捨てて先頭から
+		CHECK(allocator.Allocate(200, 1) == 0);
+		CHECK(allocator.GetStats().wrapCount == 1);
+		CHECK(allocator.GetUsedSize() == 300 + 124 + 200);
+
+		// 使用中の先頭(600)は越えない
+		CHECK(allocator.Allocate(500, 1) == RingAllocator::kInvalidOffset);
+		CHECK(allocator.Allocate(400, 1) == 200);
+		CHECK(allocator.IsFull());
+		CHECK(allocator.Allocate(1, 1) == RingAllocator::kInvalidOffset);
+		allocator.FinishFrame(3);
+
+		allocator.ReleaseCompletedFrames(2);
+		CHECK(allocator.GetUsedSize() == 124 + 200 + 400);
+		allocator.ReleaseCompletedFrames(3);
+		CHECK(allocator.IsEmpty());
+
+		CHECK(allocator.GetStats().peakUsedSize == 1024);
+		CHECK(allocator.GetStats().failedCount == 2);
+
+		// 容量を変えても統計は残る
+		allocator.Allocate(100, 1);
+		allocator.FinishFrame(4);
+		allocator.Resize(4096);
+		CHECK(allocator.GetCapacity() == 4096);
+		CHECK(allocator.IsEmpty());
+		CHECK(allocator.GetPendingFrameCount() == 0);
+		CHECK(allocator.GetStats().wrapCount == 1);
+		CHECK(allocator.GetStats().peakUsedSize == 1024);
+		CHECK(allocator.Allocate(4096, 1) == 0);
+	}
+
+	//============================================================
+	// GPUが遅れて追いかけるフレームの連続
+	//============================================================
+	/// 使用中の範囲とは重ならず、入らないときは最も古いフレームを待てば必ず入る
+	void TestFrames() {
+
+		// 1フレームの最大(16×32KB)は入り、3フレーム分は入らないことがある大きさ
+		const uint64_t kCapacity = 640 * 1024;
+		const uint64_t kAlignments[] = { 1, 16, 256, 512 };
+		const uint32_t kFramesInFlight = 3;
+
+		RingAllocator allocator;
+		allocator.Initialize(kCapacity);
+
+		// 使用中 オフセット → (終わり, フェンス値)
+		std::map<uint64_t, std::pair<uint64_t, uint64_t>> used;
+		std::deque<uint64_t> submitted;
+		uint64_t completed = 0;
+		uint32_t waitCount = 0;
+
+		auto release = [&](uint64_t fenceValue) {
+			completed = fenceValue;
+			allocator.ReleaseCompletedFrames(completed);
+			for (auto it = used.begin(); it != used.end();) {
+				it = it->second.second <= completed ? used.erase(it) : std::next(it);
+			}
+			};
+
+		std::mt19937_64 random(0);
+		for (uint64_t fenceValue = 1; fenceValue <= 5000; ++fenceValue) {
+
+			// GPUはkFramesInFlightフレーム遅れて終わる
+			while (submitted.size() >= kFramesInFlight) {
+				release(submitted.front());
+				submitted.pop_front();
+			}
+
+			uint32_t allocationCount = 1 + random() % 16;
+			for (uint32_t i = 0; i < allocationCount; ++i) {
+
+				uint64_t size = 1 + random() % (32 * 1024);
+				uint64_t alignment = kAlignments[random() % std::size(kAlignments)];
+
+				uint64_t offset = allocator.Allocate(size, alignment);
+				while (offset == RingAllocator::kInvalidOffset && allocator.GetPendingFrameCount() > 0) {
+					release(allocator.GetOldestPendingFenceValue());
+					waitCount++;
+					offset = allocator.Allocate(size, alignment);
+				}
+				if (!CHECK(offset != RingAllocator::kInvalidOffset)) {
+					return;
+				}
+
+				uint64_t end = offset + size;
+				CHECK(offset % alignment == 0);
+				CHECK(end <= kCapacity);
+
+				auto next = used.lower_bound(offset);
+				if (next != used.end()) {
+					CHECK(next->first >= end);
+				}
+				if (next != used.begin()) {
+					CHECK(std::prev(next)->second.first <= offset);
+				}
+				used.emplace(offset, std::make_pair(end, fenceValue));
+			}
+
+			allocator.FinishFrame(fenceValue);
+			submitted.push_back(fenceValue);
+		}
+
+		// 待たずに済んだフレームも待ったフレームもある
+		CHECK(waitCount > 0);
+		CHECK(allocator.GetStats().wrapCount > 0);
+		CHECK(allocator.GetStats().peakUsedSize <= kCapacity);
+
+		release(submitted.back());
+		CHECK(allocator.IsEmpty());
+		CHECK(allocator.GetPendingFrameCount() == 0);
+	}
+}
+
+//============================================================
+// RingAllocator
+//============================================================
+void TestRingAllocator() {
+
+	TestBasic();
+	TestWrap();
+	TestFrames();
+
+	CoreTests::ExpectAbort("RingAllocator.BadAlignment");
+}
+
+//============================================================
+// 2の累乗でない境界
+//============================================================
+void AbortRingAllocatorBadAlignment() {
+
+	RingAllocator allocator;
+	allocator.Initialize(1024);
+	allocator.Allocate(16, 3);
+}
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include <string>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+
+#include "CoreTests.h"
+#include "ShaderCache.h"
+#include "RecordingShaderCompiler.h"
+
+namespace {
+
+	const uint32_t kThreadCount = 4;
+
+	// テスト用のファイルを置く場所、毎回空にする
+	std::filesystem::path MakeDirectory() {
+
+		std::filesystem::path directory = std::filesystem::temp_directory_path() / "CoreTests.ShaderCache";
+		std::error_code error;
+		std::filesystem::remove_all(directory, error);
+		std::filesystem::create_directories(directory / "Shaders");
+		return directory;
+	}
+
+	void WriteFile(const std::filesystem::path& path, const std::string& content) {
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file << content;
+	}
+
+	ShaderRequest MakeRequest(const std::filesystem::path& path, const wchar_t* profile) {
+
+		ShaderRequest request{};
+		request.path = path;
+		request.profile = profile;
+		request.arguments = { L"-O3" };
+		return request;
+	}
+
+	// RecordingShaderCompilerの結果、ソースの後ろにプロファイル
+	bool IsCompiledFrom(const ShaderBytecode& bytecode, const std::string& source, const std::string& profile) {
+
+		std::string expected = source + profile;
+		return bytecode && bytecode->size() == expected.size() &&
+			std::equal(bytecode->begin(), bytecode->end(), expected.begin());
+	}
+
+	//============================================================
+	// キャッシュのキー
+	//============================================================
+	/// ソース、includeしたファイル、エントリ、プロファイル、オプションのどれが変わっても変わる
+	void TestKey(const std::filesystem::path& shaders) {
+
+		WriteFile(shaders / "Key.hlsli", "float4 Color;\n");
+		WriteFile(shaders / "Key.hlsl", "#include \"Key.hlsli\"\nfloat4 main() : SV_TARGET { return Color; }\n");
+
+		ShaderRequest base = MakeRequest(shaders / "Key.hlsl", L"ps_6_0");
+		uint64_t key = ShaderCache::CalculateKey(base);
+		CHECK(ShaderCache::CalculateKey(base) == key);
+
+		ShaderRequest entry = base;
+		entry.entry = L"PSMain";
+		ShaderRequest profile = base;
+		profile.profile = L"ps_6_6";
+		ShaderRequest arguments = base;
+		arguments.arguments.push_back(L"-Zi");
+		// 区切りが違うだけのオプション
+		ShaderRequest joined = base;
+		joined.arguments = { L"-O3-Zi" };
+		CHECK(ShaderCache::CalculateKey(entry) != key);
+		CHECK(ShaderCache::CalculateKey(profile) != key);
+		CHECK(ShaderCache::CalculateKey(arguments) != key);
+		CHECK(ShaderCache::CalculateKey(joined) != ShaderCache::CalculateKey(arguments));
+
+		// includeしたファイルの中身も含める
+		WriteFile(shaders / "Key.hlsli", "float4 Color;\nfloat Alpha;\n");
+		uint64_t includeChanged = ShaderCache::CalculateKey(base);
+		CHECK(includeChanged != key);
+		WriteFile(shaders / "Key.hlsl", "#include \"Key.hlsli\"\nfloat4 main() : SV_TARGET { return Color * Alpha; }\n");
+		CHECK(ShaderCache::CalculateKey(base) != includeChanged);
+
+		// 互いにincludeしていても止まる
+		WriteFile(shaders / "Key.hlsli", "#include \"Key.hlsl\"\n");
+		CHECK(ShaderCache::CalculateKey(base) != includeChanged);
+	}
+
+	//============================================================
+	// メモリ、ディスク、コンパイル
+	//============================================================
+	/// 同じキーは1回だけコンパイルし、2回目はメモリ、次の起動ではディスクから読む
+	void TestCache(const std::filesystem::path& directory) {
+
+		std::filesystem::path shaders = directory / "Shaders";
+		std::filesystem::path cache = directory / "Cache";
+
+		const std::string common = "cbuffer Camera : register(b0) { float4x4 ViewProjection; };\n";
+		const std::string vertex = "#include \"Common.hlsli\"\nfloat4 main(float4 position : POSITION) : SV_POSITION { return mul(position, ViewProjection); }\n";
+		const std::string pixel = "float4 main() : SV_TARGET { return 1; }\n";
+		WriteFile(shaders / "Common.hlsli", common);
+		WriteFile(shaders / "Object3d.VS.hlsl", vertex);
+		WriteFile(shaders / "Object3d.PS.hlsl", pixel);
+
+		std::vector<ShaderRequest> requests = {
+			MakeRequest(shaders / "Object3d.VS.hlsl", L"vs_6_0"),
+			MakeRequest(shaders / "Object3d.PS.hlsl", L"ps_6_0"),
+			MakeRequest(shaders / "Object3d.VS.hlsl", L"vs_6_0"),
+			MakeRequest(shaders / "Missing.PS.hlsl", L"ps_6_0"),
+		};
+
+		RecordingShaderCompiler compiler;
+		{
+			ShaderCache shaderCache;
+			shaderCache.Initialize(&compiler, cache, kThreadCount);
+
+			std::vector<ShaderBytecode> results = shaderCache.CompileAll(requests);
+			CHECK(results.size() == 4);
+			CHECK(IsCompiledFrom(results[0], vertex, "vs_6_0"));
+			CHECK(IsCompiledFrom(results[1], pixel, "ps_6_0"));
+			// 同じキーは同じ結果を共有する
+			CHECK(results[2] == results[0]);
+			// 読めないものは失敗
+			CHECK(!results[3]);
+			CHECK(shaderCache.GetLastError().find("Missing.PS.hlsl") != std::string::npos);
+
+			CHECK(compiler.GetCompiledPaths().size() == 3);
+			ShaderCache::Stats stats = shaderCache.GetStats();
+			CHECK(stats.compileCount == 3);
+			CHECK(stats.failedCount == 1);
+			CHECK(stats.memoryHitCount == 0 && stats.diskHitCount == 0);
+
+			// 2回目はメモリから、失敗したものはもう一度コンパイルする
+			compiler.Clear();
+			std::vector<ShaderBytecode> again = shaderCache.CompileAll(requests);
+			CHECK(again[0] == results[0] && again[1] == results[1]);
+			CHECK(compiler.GetCompiledPaths().size() == 1);
+			stats = shaderCache.GetStats();
+			CHECK(stats.memoryHitCount == 3);
+			CHECK(stats.failedCount == 2);
+		}
+
+		// 次の起動ではディスクから読む
+		compiler.Clear();
+		{
+			ShaderCache shaderCache;
+			shaderCache.Initialize(&compiler, cache, kThreadCount);
+
+			std::vector<ShaderBytecode> results = shaderCache.CompileAll(requests);
+			CHECK(IsCompiledFrom(results[0], vertex, "vs_6_0"));
+			CHECK(IsCompiledFrom(results[1], pixel, "ps_6_0"));
+			CHECK(results[2] == results[0]);
+
+			// 失敗したものだけコンパイルする
+			CHECK(compiler.GetCompiledPaths().size() == 1);
+			ShaderCache::Stats stats = shaderCache.GetStats();
+			CHECK(stats.diskHitCount == 2);
+			CHECK(stats.memoryHitCount == 1);
+			CHECK(stats.compileCount == 1);
+
+			// includeしたファイルを変えると、それを使うものだけコンパイルし直す
+			compiler.Clear();
+			const std::string changed = common + "float Time;\n";
+			WriteFile(shaders / "Common.hlsli", changed);
+			ShaderBytecode recompiled = shaderCache.Get(requests[0]);
+			CHECK(IsCompiledFrom(recompiled, vertex, "vs_6_0"));
+			CHECK(recompiled != results[0]);
+			CHECK(shaderCache.Get(requests[1]) == results[1]);
+			CHECK(compiler.GetCompiledPaths() == std::vector<std::string>({ requests[0].path.generic_string() }));
+		}
+
+		// 壊れたキャッシュファイルは使わずにコンパイルし直す
+		for (const auto& file : std::filesystem::directory_iterator(cache)) {
+			std::filesystem::resize_file(file.path(), 10);
+		}
+		compiler.Clear();
+		{
+			ShaderCache shaderCache;
+			shaderCache.Initialize(&compiler, cache, kThreadCount);
+
+			std::vector<ShaderBytecode> results = shaderCache.CompileAll({ requests[0], requests[1] });
+			CHECK(IsCompiledFrom(results[0], vertex, "vs_6_0"));
+			CHECK(IsCompiledFrom(results[1], pixel, "ps_6_0"));
+			CHECK(shaderCache.GetStats().diskHitCount == 0);
+			CHECK(compiler.GetCompiledPaths().size() == 2);
+		}
+	}
+}
+
+//============================================================
+// ShaderCache
+//============================================================
+void TestShaderCache() {
+
+	std::filesystem::path directory = MakeDirectory();
+
+	TestKey(directory / "Shaders");
+	TestCache(directory);
+
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+}
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "CoreTests.h"
+#include "TextureAtlas.h"
+
+namespace {
+
+	// 余白込みの範囲が重ならない
+	bool IsSeparated(const AtlasRegion& a, const AtlasRegion& b, uint32_t padding) {
+
+		if (a.page != b.page) {
+			return true;
+		}
+		return a.x + a.width + padding <= b.x - padding || b.x + b.width + padding <= a.x - padding ||
+			a.y + a.height + padding <= b.y - padding || b.y + b.height + padding <= a.y - padding;
+	}
+
+	//============================================================
+	// 詰め方
+	//============================================================
+	/// 余白込みでページ内に重ならずに置き、位置はalignmentに揃え、全部入る一番小さいページを選ぶ
+	void TestPack() {
+
+		const uint32_t kPadding = 4;
+		const uint32_t kAlignment = 4;
+
+		TextureAtlas atlas;
+		atlas.Initialize(1024, kPadding, kAlignment);
+		const uint32_t sizes[][2] = { { 512, 512 }, { 480, 480 }, { 64, 64 }, { 30, 17 }, { 1, 1 }, { 100, 250 } };
+		for (const auto& size : sizes) {
+			atlas.Add(size[0], size[1]);
+		}
+		// ページに入らない大きさ
+		uint32_t rejected = atlas.Add(1020, 8);
+		atlas.Build();
+
+		CHECK(atlas.GetPageCount() == 1);
+		CHECK(atlas.GetPageSize(0) == 1024);
+		CHECK(atlas.GetRegion(rejected).page == TextureAtlas::kInvalidPage);
+
+		uint64_t usedArea = 0;
+		for (uint32_t i = 0; i < rejected; ++i) {
+
+			const AtlasRegion& region = atlas.GetRegion(i);
+			CHECK(region.page == 0);
+			CHECK(region.width == sizes[i][0] && region.height == sizes[i][1]);
+			CHECK(region.x >= kPadding && region.y >= kPadding);
+			CHECK(region.x + region.width + kPadding <= 1024 && region.y + region.height + kPadding <= 1024);
+			CHECK((region.x - kPadding) % kAlignment == 0 && (region.y - kPadding) % kAlignment == 0);
+			for (uint32_t j = 0; j < i; ++j) {
+				CHECK(IsSeparated(region, atlas.GetRegion(j), kPadding));
+			}
+			usedArea += uint64_t(region.width) * region.height;
+		}
+
+		const TextureAtlas::Stats& stats = atlas.GetStats();
+		CHECK(stats.textureCount == 7);
+		CHECK(stats.packedCount == 6);
+		CHECK(stats.rejectedCount == 1);
+		CHECK(stats.pageCount == 1);
+		CHECK(stats.usedArea == usedArea);
+		CHECK(stats.pageArea == 1024ull * 1024);
+		CHECK(stats.bindingsSaved == 5);
+
+		// 小さいものだけなら小さいページになる、余白込みで64が2つ
+		atlas.Clear();
+		atlas.Add(56, 56);
+		atlas.Add(56, 56);
+		atlas.Build();
+		CHECK(atlas.GetPageCount() == 1 && atlas.GetPageSize(0) == 128);
+	}
+
+	//============================================================
+	// ページの分割
+	//============================================================
+	/// 最大の大きさに入らない分は次のページに置く
+	void TestPages() {
+
+		TextureAtlas atlas;
+		atlas.Initialize(256, 2, 4);
+		for (uint32_t i = 0; i < 5; ++i) {
+			atlas.Add(120, 120);
+		}
+		atlas.Build();
+
+		// 余白込みで124、1ページに4つまで
+		CHECK(atlas.GetPageCount() == 2);
+		CHECK(atlas.GetPageSize(0) == 256);
+		CHECK(atlas.GetPageSize(1) == 128);
+
+		uint32_t pageCounts[2] = {};
+		for (uint32_t i = 0; i < atlas.GetRegionCount(); ++i) {
+			pageCounts[atlas.GetRegion(i).page]++;
+		}
+		CHECK(pageCounts[0] == 4 && pageCounts[1] == 1);
+		CHECK(atlas.GetStats().bindingsSaved == 3);
+	}
+
+	//============================================================
+	// UVの変換
+	//============================================================
+	/// 元のUVの0と1がページ内の余白の内側の端になる
+	void TestUV() {
+
+		TextureAtlas atlas;
+		atlas.Initialize(1024, 4, 4);
+		atlas.Add(512, 512);
+		atlas.Add(480, 240);
+		atlas.Build();
+
+		const float size = static_cast<float>(atlas.GetPageSize(0));
+		for (uint32_t i = 0; i < atlas.GetRegionCount(); ++i) {
+
+			const AtlasRegion& region = atlas.GetRegion(i);
+			CHECK(region.uvOffsetU == region.x / size);
+			CHECK(region.uvOffsetV == region.y / size);
+			CHECK(region.uvScaleU == region.width / size);
+			CHECK(region.uvScaleV == region.height / size);
+
+			// 右下の端
+			float u = 1.0f * region.uvScaleU + region.uvOffsetU;
+			float v = 1.0f * region.uvScaleV + region.uvOffsetV;
+			CHECK(u * size == static_cast<float>(region.x + region.width));
+			CHECK(v * size == static_cast<float>(region.y + region.height));
+		}
+	}
+
+	//============================================================
+	// 余白の引き伸ばし
+	//============================================================
+	/// 中身はそのままコピーし、余白は端のピクセルで埋め、余白の外には書かない
+	void TestCopyRegion() {
+
+		const uint32_t kPadding = 2;
+		const uint32_t kPageSize = 16;
+		const size_t kPixelSize = 2;
+
+		// 3x2、ピクセルごとに違う値
+		const uint32_t kWidth = 3;
+		const uint32_t kHeight = 2;
+		std::vector<uint8_t> source(kWidth * kHeight * kPixelSize);
+		for (size_t i = 0; i < source.size(); ++i) {
+			source[i] = static_cast<uint8_t>(i + 1);
+		}
+
+		AtlasRegion region{};
+		region.page = 0;
+		region.x = 5;
+		region.y = 4;
+		region.width = kWidth;
+		region.height = kHeight;
+
+		std::vector<uint8_t> page(kPageSize * kPageSize * kPixelSize, 0xCD);
+		TextureAtlas::CopyRegion(source.data(), kWidth * kPixelSize,
+			page.data(), kPageSize * kPixelSize, region, kPadding, kPixelSize);
+
+		for (int32_t y = 0; y < int32_t(kPageSize); ++y) {
+			for (int32_t x = 0; x < int32_t(kPageSize); ++x) {
+
+				const uint8_t* pixel = &page[(size_t(y) * kPageSize + x) * kPixelSize];
+				int32_t localX = x - int32_t(region.x);
+				int32_t localY = y - int32_t(region.y);
+
+				// 余白の外は触らない
+				if (localX < -int32_t(kPadding) || localX >= int32_t(kWidth + kPadding) ||
+					localY < -int32_t(kPadding) || localY >= int32_t(kHeight + kPadding)) {
+					CHECK(pixel[0] == 0xCD && pixel[1] == 0xCD);
+					continue;
+				}
+
+				// 中身と余白は一番近い端のピクセル
+				int32_t sourceX = (std::clamp)(localX, 0, int32_t(kWidth) - 1);
+				int32_t sourceY = (std::clamp)(localY, 0, int32_t(kHeight) - 1);
+				const uint8_t* expected = &source[(size_t(sourceY) * kWidth + sourceX) * kPixelSize];
+				CHECK(pixel[0] == expected[0] && pixel[1] == expected[1]);
+			}
+		}
+	}
+}
+
+//============================================================
+// TextureAtlas
+//============================================================
+void TestTextureAtlas() {
+
+	TestPack();
+	TestPages();
+	TestUV();
+	TestCopyRegion();
+}
\ No newline at end of file
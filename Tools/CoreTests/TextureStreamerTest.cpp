@@ -0,0 +1,224 @@
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+
+#include "CoreTests.h"
+#include "TextureStreamer.h"
+#include "RecordingTextureStreamContext.h"
+
+namespace {
+
+	// RGBA8の各ミップの大きさ
+	std::vector<uint64_t> MakeMipSizes(uint32_t width, uint32_t height) {
+
+		std::vector<uint64_t> mipSizes;
+		for (uint32_t mip = 0; ; ++mip) {
+
+			uint32_t mipWidth = (std::max)(width >> mip, 1u);
+			uint32_t mipHeight = (std::max)(height >> mip, 1u);
+			mipSizes.push_back(uint64_t(mipWidth) * mipHeight * 4);
+			if (mipWidth == 1 && mipHeight == 1) {
+				break;
+			}
+		}
+		return mipSizes;
+	}
+
+	// mipから下の大きさの合計
+	uint64_t SumFrom(const std::vector<uint64_t>& mipSizes, uint32_t mip) {
+
+		return std::accumulate(mipSizes.begin() + mip, mipSizes.end(), uint64_t(0));
+	}
+
+	using Entry = RecordingTextureStreamContext::Entry;
+
+	// 反映された内容が順番も含めて同じ
+	bool IsEntries(const std::vector<Entry>& entries, const std::vector<Entry>& expected) {
+
+		return std::equal(entries.begin(), entries.end(), expected.begin(), expected.end(),
+			[](const Entry& a, const Entry& b) { return a.id == b.id && a.mip == b.mip; });
+	}
+
+	//============================================================
+	// 必要なミップ
+	//============================================================
+	void TestCalculateMip() {
+
+		CHECK(TextureStreamer::CalculateMip(1024, 1024, 2048.0f, 11) == 0);
+		CHECK(TextureStreamer::CalculateMip(1024, 1024, 1024.0f, 11) == 0);
+		CHECK(TextureStreamer::CalculateMip(1024, 1024, 512.0f, 11) == 1);
+		CHECK(TextureStreamer::CalculateMip(1024, 512, 100.0f, 11) == 3);
+		// 小さすぎるものや画面外は一番小さいミップ
+		CHECK(TextureStreamer::CalculateMip(1024, 1024, 0.5f, 11) == 10);
+		CHECK(TextureStreamer::CalculateMip(1024, 1024, std::numeric_limits<float>::quiet_NaN(), 11) == 10);
+		CHECK(TextureStreamer::CalculateMip(1024, 1024, 2.0f, 4) == 3);
+	}
+
+	//============================================================
+	// 登録
+	//============================================================
+	/// 最初はkTailSize以下のミップだけを置き、一番上に置けないミップは避ける
+	void TestRegister() {
+
+		RecordingTextureStreamContext context;
+		TextureStreamer streamer;
+		streamer.Initialize(&context, 0, 4);
+
+		std::vector<uint64_t> mipSizes = MakeMipSizes(1024, 1024);
+		StreamTextureId a = streamer.Register(1024, 1024, mipSizes, 10);
+		CHECK(streamer.GetTailMip(a) == 4);
+		CHECK(streamer.GetResidentMip(a) == 4);
+
+		// 予算が0でも小さいミップは置く
+		CHECK(streamer.GetStats().residentSize == SumFrom(mipSizes, 4));
+
+		StreamTextureId b = streamer.Register(1024, 1024, mipSizes, 2);
+		CHECK(streamer.GetTailMip(b) == 2);
+		CHECK(streamer.GetStats().residentSize == SumFrom(mipSizes, 4) + SumFrom(mipSizes, 2));
+
+		// 登録だけでは反映しない
+		streamer.Update();
+		CHECK(context.GetEntries().empty());
+
+		// 解除した番号は使い回す
+		streamer.Unregister(a);
+		CHECK(streamer.GetStats().residentSize == SumFrom(mipSizes, 2));
+		CHECK(streamer.Register(64, 64, MakeMipSizes(64, 64), 6) == a);
+		CHECK(streamer.GetTailMip(a) == 0);
+		CHECK(streamer.GetStats().textureCount == 2);
+	}
+
+	//============================================================
+	// 読み込み
+	//============================================================
+	/// 要求されたミップを1回で反映し、1フレームの数を超えた分は足りない段数が多いものから読む
+	void TestRequest() {
+
+		RecordingTextureStreamContext context;
+		TextureStreamer streamer;
+		streamer.Initialize(&context, 64ull * 1024 * 1024, 2);
+
+		std::vector<uint64_t> mipSizes = MakeMipSizes(1024, 1024);
+		StreamTextureId a = streamer.Register(1024, 1024, mipSizes, 10);
+		StreamTextureId b = streamer.Register(1024, 1024, mipSizes, 10);
+		StreamTextureId c = streamer.Register(1024, 1024, mipSizes, 10);
+
+		// 同じフレームで何度も描画されたら一番詳細なものに合わせる
+		streamer.Request(a, 64.0f);
+		streamer.Request(a, 256.0f);
+		streamer.RequestMip(b, 0);
+		streamer.RequestMip(c, 1);
+		streamer.Update();
+
+		// bは4段、cは3段、aは2段足りない
+		CHECK(IsEntries(context.GetEntries(), { { b, 0 }, { c, 1 } }));
+		CHECK(streamer.GetResidentMip(a) == 4);
+		CHECK(streamer.GetStats().requestCount == 2);
+
+		// 読み込めなかったものは次のフレームも描画されれば読む
+		context.Clear();
+		streamer.Request(a, 256.0f);
+		streamer.Update();
+		CHECK(IsEntries(context.GetEntries(), { { a, 2 } }));
+
+		// 置いているより詳細でない要求では何もしない
+		context.Clear();
+		streamer.RequestMip(a, 5);
+		streamer.Update();
+		CHECK(context.GetEntries().empty());
+
+		const TextureStreamer::Stats& stats = streamer.GetStats();
+		CHECK(stats.requestCount == 3);
+		CHECK(stats.requestedSize == (SumFrom(mipSizes, 2) - SumFrom(mipSizes, 4)) +
+			(SumFrom(mipSizes, 0) - SumFrom(mipSizes, 4)) + (SumFrom(mipSizes, 1) - SumFrom(mipSizes, 4)));
+		CHECK(stats.residentSize == SumFrom(mipSizes, 2) + SumFrom(mipSizes, 0) + SumFrom(mipSizes, 1));
+		CHECK(stats.evictionCount == 0);
+	}
+
+	//============================================================
+	// 追い出し
+	//============================================================
+	/// 予算を超えるときは使われていないものから詳細なミップを外し、このフレームで使うものは外さない
+	void TestEviction() {
+
+		std::vector<uint64_t> mipSizes = MakeMipSizes(1024, 1024);
+		const uint64_t kTail = SumFrom(mipSizes, 4);
+		const uint64_t kFull = SumFrom(mipSizes, 0);
+
+		// 1つだけ全て置ける予算
+		RecordingTextureStreamContext context;
+		TextureStreamer streamer;
+		streamer.Initialize(&context, kFull + kTail, 4);
+
+		StreamTextureId a = streamer.Register(1024, 1024, mipSizes, 10);
+		StreamTextureId b = streamer.Register(1024, 1024, mipSizes, 10);
+
+		streamer.RequestMip(a, 0);
+		streamer.Update();
+		CHECK(streamer.GetResidentMip(a) == 0);
+		CHECK(streamer.GetStats().residentSize == kFull + kTail);
+
+		// aを使わなくなったのでbのために追い出す、反映はどちらも1回
+		context.Clear();
+		streamer.RequestMip(b, 0);
+		streamer.Update();
+		CHECK(IsEntries(context.GetEntries(), { { a, 4 }, { b, 0 } }));
+		CHECK(streamer.GetStats().evictionCount == 4);
+		CHECK(streamer.GetStats().evictedSize == kFull - kTail);
+		CHECK(streamer.GetStats().residentSize <= kFull + kTail);
+
+		// 両方使っているときは外さず、入らない方を諦める
+		context.Clear();
+		streamer.RequestMip(a, 0);
+		streamer.RequestMip(b, 0);
+		streamer.Update();
+		CHECK(context.GetEntries().empty());
+		CHECK(streamer.GetResidentMip(b) == 0);
+		CHECK(streamer.GetStats().deniedCount == 1);
+
+		// 使っていても要求より詳細な分は外せる、足りる分だけ外す
+		context.Clear();
+		streamer.RequestMip(a, 1);
+		streamer.RequestMip(b, 2);
+		streamer.Update();
+		CHECK(IsEntries(context.GetEntries(), { { a, 1 }, { b, 1 } }));
+		CHECK(streamer.GetStats().deniedCount == 1);
+
+		// 予算を下げると要求がなくても追い出す
+		context.Clear();
+		streamer.SetBudget(kTail * 2);
+		streamer.Update();
+		CHECK(streamer.GetResidentMip(a) == 4 && streamer.GetResidentMip(b) == 4);
+		CHECK(streamer.GetStats().residentSize == kTail * 2);
+		CHECK(context.GetEntries().size() == 2);
+	}
+}
+
+//============================================================
+// TextureStreamer
+//============================================================
+void TestTextureStreamer() {
+
+	TestCalculateMip();
+	TestRegister();
+	TestRequest();
+	TestEviction();
+
+	CoreTests::ExpectAbort("TextureStreamer.DoubleUnregister");
+}
+
+//============================================================
+// 二重の登録解除
+//============================================================
+void AbortTextureStreamerDoubleUnregister() {
+
+	RecordingTextureStreamContext context;
+	TextureStreamer streamer;
+	streamer.Initialize(&context, 0, 1);
+
+	StreamTextureId id = streamer.Register(64, 64, MakeMipSizes(64, 64), 6);
+	streamer.Unregister(id);
+	streamer.Unregister(id);
+}
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include <vector>
+#include <map>
+#include <random>
+#include <algorithm>
+#include <iterator>
+
+#include "CoreTests.h"
+#include "TlsfAllocator.h"
+
+namespace {
+
+	//============================================================
+	// 確保と返却、境界と粒度
+	//============================================================
+	void TestBasic() {
+
+		TlsfAllocator allocator;
+		allocator.Initialize(1024 * 1024, 256);
+
+		TlsfAllocator::Stats stats = allocator.GetStats();
+		CHECK(stats.capacity == 1024 * 1024);
+		CHECK(stats.freeBlockCount == 1);
+		CHECK(stats.largestFreeBlock == 1024 * 1024);
+		CHECK(stats.GetFragmentation() == 0.0f);
+
+		// 粒度に切り上げて使う
+		uint64_t a = allocator.Allocate(1, 1);
+		CHECK(a == 0);
+		CHECK(allocator.GetUsedSize() == 256);
+
+		// 境界に合わせるため前を空きとして残す
+		uint64_t b = allocator.Allocate(1000, 65536);
+		CHECK(b == 65536);
+		CHECK(allocator.GetUsedSize() == 256 + 1024);
+		CHECK(allocator.GetStats().freeBlockCount == 2);
+
+		// 残った前の空きは小さいものに使われる
+		uint64_t c = allocator.Allocate(512, 256);
+		CHECK(c != TlsfAllocator::kInvalidOffset && c < 65536);
+
+		// 入らないサイズは失敗する
+		CHECK(allocator.Allocate(2 * 1024 * 1024, 256) == TlsfAllocator::kInvalidOffset);
+		CHECK(allocator.Allocate(0, 256) == TlsfAllocator::kInvalidOffset);
+		CHECK(allocator.GetStats().failedCount == 2);
+
+		allocator.Free(b);
+		allocator.Free(a);
+		allocator.Free(c);
+		stats = allocator.GetStats();
+		CHECK(stats.usedSize == 0);
+		CHECK(stats.allocationCount == 0);
+		CHECK(stats.freeBlockCount == 1);
+		CHECK(stats.largestFreeBlock == 1024 * 1024);
+	}
+
+	//============================================================
+	// ランダムな確保と返却
+	//============================================================
+	/// 大きさと境界をばらばらにして断片化させ、重なりと境界を毎回確かめる
+	/// 最後に全て返し、空きが1つにつながることを確かめる
+	void TestStress() {
+
+		const uint64_t kCapacity = 64ull * 1024 * 1024;
+		const uint64_t kGranularity = 256;
+		const uint64_t kAlignments[] = { 1, 256, 512, 4096, 65536 };
+
+		TlsfAllocator allocator;
+		allocator.Initialize(kCapacity, kGranularity);
+
+		// 使用中 オフセット → 終わり
+		std::map<uint64_t, uint64_t> used;
+		std::vector<uint64_t> offsets;
+
+		std::mt19937_64 random(0);
+		uint32_t failedCount = 0;
+		for (int step = 0; step < 200000; ++step) {
+
+			// 前半は確保を多めにして埋め、後半は返却を多めにする
+			bool isAllocate = offsets.empty() || random() % 100 < (step < 100000 ? 60u : 40u);
+			if (isAllocate) {
+
+				// 小さいものが多く、たまに大きいもの
+				uint64_t size = 1 + (random() % (1ull << (8 + random() % 13)));
+				uint64_t alignment = kAlignments[random() % std::size(kAlignments)];
+
+				uint64_t offset = allocator.Allocate(size, alignment);
+				if (offset == TlsfAllocator::kInvalidOffset) {
+					failedCount++;
+					continue;
+				}
+
+				uint64_t end = offset + size;
+				CHECK(offset % (std::max)(alignment, kGranularity) == 0);
+				CHECK(end <= kCapacity);
+
+				// 前後の使用中の範囲と重ならない
+				auto next = used.lower_bound(offset);
+				if (next != used.end()) {
+					CHECK(next->first >= end);
+				}
+				if (next != used.begin()) {
+					CHECK(std::prev(next)->second <= offset);
+				}
+
+				used.emplace(offset, end);
+				offsets.push_back(offset);
+			} else {
+
+				size_t i = random() % offsets.size();
+				uint64_t offset = offsets[i];
+				offsets[i] = offsets.back();
+				offsets.pop_back();
+
+				allocator.Free(offset);
+				used.erase(offset);
+			}
+
+			if (step % 1000 == 0) {
+
+				TlsfAllocator::Stats stats = allocator.GetStats();
+				CHECK(stats.allocationCount == offsets.size());
+				CHECK(stats.largestFreeBlock <= kCapacity - stats.usedSize);
+			}
+		}
+
+		// 埋まって失敗するところまで使えている
+		CHECK(failedCount > 0);
+		CHECK(allocator.GetStats().GetFragmentation() > 0.0f);
+
+		// 全て返すと1つの空きに戻る
+		std::shuffle(offsets.begin(), offsets.end(), random);
+		for (uint64_t offset : offsets) {
+			allocator.Free(offset);
+		}
+
+		TlsfAllocator::Stats stats = allocator.GetStats();
+		CHECK(stats.usedSize == 0);
+		CHECK(stats.allocationCount == 0);
+		CHECK(stats.freeBlockCount == 1);
+		CHECK(stats.largestFreeBlock == kCapacity);
+		CHECK(stats.GetFragmentation() == 0.0f);
+
+		// つながった空きは全体を1つで確保できる
+		CHECK(allocator.Allocate(kCapacity, kGranularity) == 0);
+	}
+}
+
+//============================================================
+// TlsfAllocator
+//============================================================
+void TestTlsfAllocator() {
+
+	TestBasic();
+	TestStress();
+
+	CoreTests::ExpectAbort("TlsfAllocator.DoubleFree");
+}
+
+//============================================================
+// 二重返却
+//============================================================
+void AbortTlsfAllocatorDoubleFree() {
+
+	TlsfAllocator allocator;
+	allocator.Initialize(4096, 256);
+
+	uint64_t offset = allocator.Allocate(256, 256);
+	allocator.Free(offset);
+	allocator.Free(offset);
+}
\ No newline at end of file
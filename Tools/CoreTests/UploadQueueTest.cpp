@@ -0,0 +1,225 @@
+#include <vector>
+#include <memory>
+#include <cstring>
+
+#include "CoreTests.h"
+#include "UploadQueue.h"
+#include "RecordingCopyContext.h"
+
+namespace {
+
+	// 連番で埋めたデータ
+	std::vector<uint8_t> MakeData(size_t size, uint8_t seed) {
+
+		std::vector<uint8_t> data(size);
+		for (size_t i = 0; i < size; ++i) {
+			data[i] = static_cast<uint8_t>(seed + i * 7);
+		}
+		return data;
+	}
+
+	//============================================================
+	// GPUの代わり
+	//============================================================
+	/// 記録されたバッファのコピーをステージングから行い、前回からの続きだけを実行する
+	struct SimulatedCopy {
+
+		explicit SimulatedCopy(const uint8_t* stagingData) : staging(stagingData) {}
+
+		const uint8_t* staging;
+		RecordingCopyContext context;
+		size_t executedCount = 0;
+
+		void Execute() {
+
+			const auto& entries = context.GetEntries();
+			for (; executedCount < entries.size(); ++executedCount) {
+
+				const auto& entry = entries[executedCount];
+				if (entry.op == RecordingCopyContext::Op::COPYBUFFER) {
+					auto* destination = static_cast<std::vector<uint8_t>*>(entry.destination);
+					std::memcpy(destination->data() + entry.args[0], staging + entry.args[1], entry.args[2]);
+				}
+			}
+		}
+	};
+
+	//============================================================
+	// バッファの分割
+	//============================================================
+	/// budgetを超えるバッファはフレームに分けて記録し、全て届いてからFinishUploadする
+	void TestBuffer() {
+
+		std::vector<uint8_t> staging(64 * 1024);
+		UploadQueue queue;
+		queue.Initialize(staging.data(), staging.size(), 4096);
+
+		auto data = std::make_shared<std::vector<uint8_t>>(MakeData(10000, 1));
+		std::vector<uint8_t> destination(10000 + 16);
+		UploadId id = queue.EnqueueBuffer(&destination, 16, data->data(), data->size(), data);
+		CHECK(queue.GetStats().pendingSize == 10000);
+		CHECK(!queue.IsSubmitted(id));
+
+		SimulatedCopy gpu(staging.data());
+		const uint64_t kExpectedSizes[] = { 4096, 4096, 10000 - 8192 };
+		for (uint64_t frame = 0; frame < 3; ++frame) {
+
+			queue.Process(gpu.context);
+			gpu.Execute();
+			queue.FinishFrame(frame + 1);
+			CHECK(queue.GetStats().frameSize == kExpectedSizes[frame]);
+
+			const auto& entry = gpu.context.GetEntries()[frame];
+			CHECK(entry.op == RecordingCopyContext::Op::COPYBUFFER);
+			CHECK(entry.args[0] == 16 + frame * 4096);
+			CHECK(entry.args[1] % UploadQueue::kBufferAlignment == 0);
+			CHECK(entry.args[2] == kExpectedSizes[frame]);
+
+			// 前のフレームのステージングは次のフレームまでに読み終わる
+			queue.ReleaseCompletedFrames(frame + 1);
+		}
+
+		CHECK(gpu.context.GetEntries().size() == 4);
+		CHECK(gpu.context.GetEntries().back().op == RecordingCopyContext::Op::FINISHUPLOAD);
+		CHECK(gpu.context.GetEntries().back().args[0] == 0);
+		CHECK(queue.IsSubmitted(id) && queue.IsComplete(id));
+		CHECK(queue.IsIdle());
+		CHECK(std::memcmp(destination.data() + 16, data->data(), data->size()) == 0);
+
+		const UploadQueue::Stats& stats = queue.GetStats();
+		CHECK(stats.pendingSize == 0 && stats.pendingCount == 0);
+		CHECK(stats.uploadedSize == 10000);
+		CHECK(stats.copyCount == 3);
+		CHECK(stats.uploadCount == 1);
+		CHECK(stats.budgetLimitedCount == 2);
+	}
+
+	//============================================================
+	// テクスチャの配置
+	//============================================================
+	/// 行はkTexturePitchAlignment、先頭はkTexturePlacementAlignmentに揃えて詰める
+	/// サブリソースは分けず、何も記録していないフレームならbudgetを超えても記録する
+	void TestTexture() {
+
+		std::vector<uint8_t> staging(64 * 1024);
+		UploadQueue queue;
+		queue.Initialize(staging.data(), staging.size(), 500);
+
+		// 100バイト×4行と、100バイト×2行×奥行き2
+		std::vector<uint8_t> mip0 = MakeData(400, 3);
+		std::vector<uint8_t> mip1 = MakeData(400, 5);
+		std::vector<UploadSubresource> subresources(2);
+		subresources[0] = { mip0.data(), 100, 4, 28, 25, 4, 1 };
+		subresources[1] = { mip1.data(), 100, 2, 28, 25, 2, 2 };
+
+		uint32_t rowPitch = 0;
+		CHECK(UploadQueue::CalculateFootprintSize(subresources[0], rowPitch) == 256 * 3 + 100);
+		CHECK(rowPitch == 256);
+
+		int texture = 0;
+		UploadId id = queue.EnqueueTexture(&texture, subresources, nullptr);
+		CHECK(queue.GetStats().pendingSize == (256 * 3 + 100) * 2);
+
+		RecordingCopyContext context;
+		for (uint32_t i = 0; i < 2; ++i) {
+
+			// 1つ目の後は何か記録済みなので、2つ目は次のフレームに回る
+			queue.Process(context);
+			CHECK(context.GetEntries().size() > i);
+
+			const auto& entry = context.GetEntries()[i];
+			CHECK(entry.op == RecordingCopyContext::Op::COPYTEXTURE);
+			CHECK(entry.destination == &texture);
+			CHECK(entry.args[0] == i);
+			CHECK(entry.footprint.offset % UploadQueue::kTexturePlacementAlignment == 0);
+			CHECK(entry.footprint.rowPitch == 256);
+			CHECK(entry.footprint.format == 28);
+			CHECK(entry.footprint.depth == subresources[i].depth);
+
+			// 各行が揃えた位置に入っている
+			for (uint32_t row = 0; row < 4; ++row) {
+				CHECK(std::memcmp(staging.data() + entry.footprint.offset + row * 256,
+					subresources[i].data + row * 100, 100) == 0);
+			}
+
+			queue.FinishFrame(i + 1);
+		}
+
+		CHECK(context.GetEntries().size() == 3);
+		CHECK(context.GetEntries()[2].op == RecordingCopyContext::Op::FINISHUPLOAD);
+		CHECK(context.GetEntries()[2].args[0] == 1);
+		CHECK(queue.IsSubmitted(id));
+		CHECK(queue.GetStats().budgetLimitedCount == 1);
+	}
+
+	//============================================================
+	// ステージングの空き待ちと取り消し
+	//============================================================
+	/// 入らないときは止めて、GPUが読み終えたフレームを回収すれば続きから記録する
+	void TestStagingFull() {
+
+		std::vector<uint8_t> staging(4096);
+		UploadQueue queue;
+		queue.Initialize(staging.data(), staging.size(), 1024 * 1024);
+
+		std::vector<uint8_t> data = MakeData(3000, 9);
+		std::vector<uint8_t> destinations[3];
+		UploadId ids[3];
+		for (int i = 0; i < 3; ++i) {
+			destinations[i].resize(data.size());
+			ids[i] = queue.EnqueueBuffer(&destinations[i], 0, data.data(), data.size(), nullptr);
+		}
+
+		// 取り消したものは記録しない
+		int cancelled = 0;
+		UploadId cancelledId = queue.EnqueueBuffer(&cancelled, 0, data.data(), 4, nullptr);
+		queue.Cancel(cancelledId);
+		CHECK(queue.GetStats().pendingCount == 3);
+		CHECK(queue.GetStats().pendingSize == 9000);
+
+		SimulatedCopy gpu(staging.data());
+		CHECK(!queue.Flush(gpu.context));
+		gpu.Execute();
+		CHECK(queue.IsSubmitted(ids[0]) && !queue.IsSubmitted(ids[1]));
+		CHECK(queue.GetStats().stagingFullCount == 1);
+		queue.FinishFrame(1);
+
+		// 回収するまでは進まない
+		CHECK(!queue.Flush(gpu.context));
+		queue.ReleaseCompletedFrames(1);
+		CHECK(queue.IsComplete(ids[0]) && !queue.IsComplete(ids[1]));
+
+		CHECK(!queue.Flush(gpu.context));
+		gpu.Execute();
+		queue.FinishFrame(2);
+		queue.ReleaseCompletedFrames(2);
+		CHECK(queue.Flush(gpu.context));
+		gpu.Execute();
+		queue.FinishFrame(3);
+
+		CHECK(queue.IsSubmitted(ids[2]));
+		CHECK(queue.IsIdle());
+		for (const auto& destination : destinations) {
+			CHECK(destination == data);
+		}
+		for (const auto& entry : gpu.context.GetEntries()) {
+			CHECK(entry.destination != &cancelled);
+		}
+
+		// 記録待ちを破棄したものは完了扱い
+		UploadId dropped = queue.EnqueueBuffer(&cancelled, 0, data.data(), 4, nullptr);
+		queue.Reset();
+		CHECK(queue.IsComplete(dropped));
+		CHECK(queue.GetStats().pendingCount == 0);
+	}
+}
+
+//============================================================
+// UploadQueue
+//============================================================
+void TestUploadQueue() {
+
+	TestBuffer();
+	TestTexture();
+	TestStagingFull();
+}
\ No newline at end of file
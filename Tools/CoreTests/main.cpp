@@ -0,0 +1,157 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#ifdef _MSC_VER
+#include <crtdbg.h>
+#endif
+
+#include "CoreTests.h"
+
+namespace {
+
+	// テスト
+	struct TestCase {
+
+		const char* name;
+		void (*run)();
+	};
+
+	// assertで止まるはずの処理
+	struct AbortCase {
+
+		const char* name;
+		void (*run)();
+	};
+
+	const TestCase kTests[] = {
+		{ "DescriptorAllocator", TestDescriptorAllocator },
+		{ "TlsfAllocator", TestTlsfAllocator },
+		{ "RenderGraph", TestRenderGraph },
+		{ "RingAllocator", TestRingAllocator },
+		{ "FrameScheduler", TestFrameScheduler },
+		{ "UploadQueue", TestUploadQueue },
+		{ "PipelineCache", TestPipelineCache },
+		{ "ShaderCache", TestShaderCache },
+		{ "TextureStreamer", TestTextureStreamer },
+		{ "ContentStore", TestContentStore },
+		{ "GeometryArena", TestGeometryArena },
+		{ "PrimitiveBatcher", TestPrimitiveBatcher },
+		{ "InstanceBatcher", TestInstanceBatcher },
+		{ "TextureAtlas", TestTextureAtlas },
+		{ "JobGraph", TestJobGraph },
+		{ "ProceduralMesh", TestProceduralMesh },
+	};
+
+	const AbortCase kAbortCases[] = {
+		{ "DescriptorAllocator.DoubleFree", AbortDescriptorAllocatorDoubleFree },
+		{ "DescriptorAllocator.OverlappingFree", AbortDescriptorAllocatorOverlappingFree },
+		{ "TlsfAllocator.DoubleFree", AbortTlsfAllocatorDoubleFree },
+		{ "RenderGraph.ConflictingWrite", AbortRenderGraphConflictingWrite },
+		{ "RingAllocator.BadAlignment", AbortRingAllocatorBadAlignment },
+		{ "FrameScheduler.TooManyFrames", AbortFrameSchedulerTooManyFrames },
+		{ "PipelineCache.TooManyRootParameters", AbortPipelineCacheTooManyRootParameters },
+		{ "TextureStreamer.DoubleUnregister", AbortTextureStreamerDoubleUnregister },
+		{ "ContentStore.RebindIdentifier", AbortContentStoreRebindIdentifier },
+		{ "JobGraph.Cycle", AbortJobGraphCycle },
+	};
+
+	// 失敗した確認の数
+	int failedCount = 0;
+	// 自分の実行ファイル、ExpectAbortで起動し直す
+	std::string executablePath;
+
+	//============================================================
+	// assertで止まるはずの処理の実行
+	//============================================================
+	/// 子プロセス側、止まらずに戻ってきたら0で終わり親が失敗と判断する
+	int RunAbortCase(const char* name) {
+
+#ifdef _MSC_VER
+		// ダイアログを出さずに標準エラーへ出して終わる
+		_set_abort_behavior(0, _WRITE_ABORT_MSG | _CALL_REPORTFAULT);
+		_CrtSetReportMode(_CRT_ASSERT, _CRTDBG_MODE_FILE);
+		_CrtSetReportFile(_CRT_ASSERT, _CRTDBG_FILE_STDERR);
+		_CrtSetReportMode(_CRT_ERROR, _CRTDBG_MODE_FILE);
+		_CrtSetReportFile(_CRT_ERROR, _CRTDBG_FILE_STDERR);
+#endif
+
+		for (const AbortCase& abortCase : kAbortCases) {
+
+			if (std::strcmp(abortCase.name, name) == 0) {
+				abortCase.run();
+				return 0;
+			}
+		}
+
+		std::printf("unknown abort case %s\n", name);
+		return 0;
+	}
+}
+
+//============================================================
+// 確認
+//============================================================
+bool CoreTests::Check(bool condition, const char* expression, const char* file, int line) {
+
+	if (!condition) {
+		std::printf("  failed  %s  (%s:%d)\n", expression, file, line);
+		failedCount++;
+	}
+	return condition;
+}
+
+//============================================================
+// assertで止まることの確認
+//============================================================
+bool CoreTests::ExpectAbort(const char* name) {
+
+#ifdef NDEBUG
+	// assertが無効なので止まらない
+	(void)name;
+	return true;
+#else
+	std::string command = "\"" + executablePath + "\" --abort " + name;
+#ifdef _MSC_VER
+	// cmd.exeは先頭と末尾の引用符を外すので全体を囲む
+	command = "\"" + command + "\"";
+#endif
+
+	std::printf("  expecting an assert from %s\n", name);
+	std::fflush(stdout);
+	int result = std::system(command.c_str());
+
+	return Check(result != 0, name, __FILE__, __LINE__);
+#endif
+}
+
+//============================================================
+// main
+//============================================================
+/// 引数なしなら全てのテスト、--abortはExpectAbortから起動されたときだけ使う
+int main(int argc, char* argv[]) {
+
+	executablePath = argv[0];
+
+	if (argc > 2 && std::strcmp(argv[1], "--abort") == 0) {
+		return RunAbortCase(argv[2]);
+	}
+
+	for (const TestCase& test : kTests) {
+
+		std::printf("%s\n", test.name);
+		std::fflush(stdout);
+
+		int failedBefore = failedCount;
+		test.run();
+		std::printf("  %s\n", failedCount == failedBefore ? "passed" : "FAILED");
+	}
+
+	if (failedCount == 0) {
+		std::printf("all tests passed\n");
+	} else {
+		std::printf("%d checks failed\n", failedCount);
+	}
+	return failedCount == 0 ? 0 : 1;
+}
\ No newline at end of file
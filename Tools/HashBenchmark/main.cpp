@@ -0,0 +1,202 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <thread>
+
+#include <openssl/sha.h>
+
+#include "SHA256Hasher.h"
+#include "FileHasher.h"
+
+namespace {
+
+	// NISTの例
+	struct TestVector {
+
+		std::string message;
+		const char* digest;
+	};
+
+	//============================================================
+	// 正しさの確認
+	//============================================================
+	/// NISTの例と、0から1024バイトの全ての長さでOpenSSLと比べる
+	bool Verify(SHA256Hasher::Backend backend) {
+
+		const std::vector<TestVector> vectors = {
+			{ "", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+			{ "abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+			{ "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+				"248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+			{ "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu",
+				"cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1" },
+			{ std::string(1000000, 'a'), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+		};
+
+		bool isValid = true;
+		for (const TestVector& vector : vectors) {
+
+			if (SHA256Hasher::ToHex(SHA256Hasher::Hash(vector.message)) != vector.digest) {
+				std::printf("  failed  NIST %zu bytes\n", vector.message.size());
+				isValid = false;
+			}
+		}
+
+		std::mt19937 random(0);
+		std::vector<std::string> messages(1025);
+		for (size_t length = 0; length < messages.size(); ++length) {
+
+			messages[length].resize(length);
+			for (char& c : messages[length]) {
+				c = static_cast<char>(random());
+			}
+		}
+
+		// 1つずつとまとめた場合、AVX2はまとめた場合だけ違う実装になる
+		std::vector<std::string_view> views(messages.begin(), messages.end());
+		std::vector<SHA256Digest> batch(views.size());
+		SHA256Hasher::HashBatch(views.data(), views.size(), batch.data());
+
+		for (size_t i = 0; i < messages.size(); ++i) {
+
+			SHA256Digest expected{};
+			::SHA256(reinterpret_cast<const unsigned char*>(messages[i].data()), messages[i].size(), expected.data());
+
+			if (SHA256Hasher::Hash(messages[i]) != expected || batch[i] != expected) {
+				std::printf("  failed  %s %zu bytes\n", SHA256Hasher::GetBackendName(backend), i);
+				isValid = false;
+			}
+		}
+		return isValid;
+	}
+
+	//============================================================
+	// 時間の計測
+	//============================================================
+	/// messageSizeのメッセージをtotalSize分まとめて計算し、1秒あたりのバイト数とメッセージ数を出す
+	void Measure(const char* name, size_t messageSize, size_t totalSize, bool useOpenSSL) {
+
+		size_t count = (std::max)(totalSize / (std::max)(messageSize, size_t(1)), size_t(1));
+
+		std::string data(messageSize * count, '\0');
+		std::mt19937 random(1);
+		for (char& c : data) {
+			c = static_cast<char>(random());
+		}
+
+		std::vector<std::string_view> views(count);
+		for (size_t i = 0; i < count; ++i) {
+			views[i] = std::string_view(data.data() + i * messageSize, messageSize);
+		}
+		std::vector<SHA256Digest> digests(count);
+
+		// 1回目は捨てる
+		double bestSeconds = 0.0;
+		for (int repeat = 0; repeat < 4; ++repeat) {
+
+			auto begin = std::chrono::steady_clock::now();
+			if (useOpenSSL) {
+				for (size_t i = 0; i < count; ++i) {
+					::SHA256(reinterpret_cast<const unsigned char*>(views[i].data()), views[i].size(), digests[i].data());
+				}
+			} else {
+				SHA256Hasher::HashBatch(views.data(), count, digests.data());
+			}
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+			if (repeat == 1 || (repeat > 1 && seconds < bestSeconds)) {
+				bestSeconds = seconds;
+			}
+		}
+
+		std::printf("  %-8s %8zu B  %10.1f MB/s  %12.0f msg/s\n", name, messageSize,
+			double(messageSize * count) / bestSeconds / (1024.0 * 1024.0), double(count) / bestSeconds);
+	}
+
+	//============================================================
+	// ファイルのハッシュの計測
+	//============================================================
+	/// スレッド数を倍にしながら同じファイルを計算し、速度と結果が全て同じかを出す
+	int MeasureFile(const char* path) {
+
+		uint32_t maxThreadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+
+		SHA256Digest firstDigest{};
+		bool isValid = true;
+		for (uint32_t threadCount = 1; ; threadCount = (std::min)(threadCount * 2, maxThreadCount)) {
+
+			// 覚えた結果を使わないように毎回作り直す、1回目はファイルをキャッシュに載せる分遅くなる
+			FileHasher hasher;
+			hasher.Initialize(threadCount);
+
+			SHA256Digest digest{};
+			if (!hasher.Hash(path, digest)) {
+				std::printf("failed  %s: cannot open\n", path);
+				return 1;
+			}
+			if (threadCount == 1) {
+				firstDigest = digest;
+			}
+			isValid = isValid && digest == firstDigest;
+
+			FileHasher::Stats stats = hasher.GetStats();
+			std::printf("  %2u threads  %10.1f MB/s  %s\n", threadCount,
+				double(stats.hashedBytes) / (stats.hashTimeMs / 1000.0) / (1024.0 * 1024.0), SHA256Hasher::ToHex(digest).c_str());
+
+			if (threadCount == maxThreadCount) {
+				break;
+			}
+		}
+
+		std::printf(isValid ? "all digests match\n" : "digest mismatch\n");
+		return isValid ? 0 : 1;
+	}
+}
+
+//============================================================
+// main
+//============================================================
+/// 引数なしなら各実装の確認と速度、ファイルを渡すとスレッド数ごとのファイルのハッシュの速度
+int main(int argc, char* argv[]) {
+
+	if (argc > 1) {
+		return MeasureFile(argv[1]);
+	}
+
+	const size_t kMessageSizes[] = { 32, 64, 1024, 1024 * 1024 };
+	const size_t kTotalSize = 64 * 1024 * 1024;
+
+	bool isValid = true;
+	for (uint32_t i = 0; i < static_cast<uint32_t>(SHA256Hasher::Backend::BACKENDNUM); ++i) {
+
+		SHA256Hasher::Backend backend = static_cast<SHA256Hasher::Backend>(i);
+		if (!SHA256Hasher::IsSupported(backend)) {
+			std::printf("%s is not supported\n", SHA256Hasher::GetBackendName(backend));
+			continue;
+		}
+
+		SHA256Hasher::SetBackend(backend);
+		std::printf("%s\n", SHA256Hasher::GetBackendName(backend));
+
+		if (!Verify(backend)) {
+			isValid = false;
+			continue;
+		}
+		for (size_t size : kMessageSizes) {
+			Measure(SHA256Hasher::GetBackendName(backend), size, kTotalSize, false);
+		}
+	}
+
+	std::printf("OpenSSL\n");
+	for (size_t size : kMessageSizes) {
+		Measure("OpenSSL", size, kTotalSize, true);
+	}
+
+	std::printf(isValid ? "all digests match\n" : "digest mismatch\n");
+	return isValid ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,403 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "FrameSource.h"
+#include "FramePreprocessor.h"
+#include "QRDecoder.h"
+#include "QRDetectionScheduler.h"
+#include "SHA256Hasher.h"
+
+namespace {
+
+	using Clock = std::chrono::steady_clock;
+
+	// 計測の設定
+	struct Config {
+
+		const char* name;
+		float scale;
+		float rotation;
+		float blurSigma;
+		float noiseSigma;
+	};
+
+	// 結果
+	struct Result {
+
+		uint64_t frameCount = 0;
+		uint64_t correctCount = 0;  // 正解と同じ、正解がなければ何か読めた
+		uint64_t wrongCount = 0;    // 正解と違うものが読めた
+		double preprocessMs = 0.0;
+		double detectMs = 0.0;
+	};
+
+	//============================================================
+	// 計測
+	//============================================================
+	/// sourceが終わるかmaxFrameCountまで、QRCaptureの処理スレッドと同じ処理を1スレッドで行う
+	Result Measure(IFrameSource& source, uint64_t maxFrameCount) {
+
+		QRDecoder decoder;
+		cv::Mat frame;
+		QRDecoder::Images images;
+
+		Result result{};
+		while (result.frameCount < maxFrameCount && source.Read(frame)) {
+
+			Clock::time_point begin = Clock::now();
+			decoder.Preprocess(frame, source.IsMirrored(), images);
+			Clock::time_point preprocessed = Clock::now();
+			std::string text = decoder.Detect(images.gray);
+			Clock::time_point end = Clock::now();
+
+			result.preprocessMs += std::chrono::duration<double, std::milli>(preprocessed - begin).count();
+			result.detectMs += std::chrono::duration<double, std::milli>(end - preprocessed).count();
+			++result.frameCount;
+
+			const std::string& expected = source.GetExpectedText();
+			if (expected.empty()) {
+				result.correctCount += text.empty() ? 0 : 1;
+			} else if (text == expected) {
+				++result.correctCount;
+			} else if (!text.empty()) {
+				++result.wrongCount;
+			}
+		}
+		return result;
+	}
+
+	// 前処理の比較の結果
+	struct PreprocessResult {
+
+		double openCVMs = 0.0;       // 今までのOpenCVの呼び出しの並び
+		double scalarMs = 0.0;       // まとめた処理、1スレッド
+		double simdMs = 0.0;         // まとめた処理、AVX2、1スレッド
+		double threadedMs = 0.0;     // まとめた処理、AVX2、コア数分
+		int grayMaxDiff = 0;         // 同じ順のOpenCVとのグレースケールの差の最大
+		int legacyGrayMaxDiff = 0;   // 今までの並び(平滑化してからグレースケール)との差の最大
+		double legacyGrayMeanDiff = 0.0;
+		uint64_t maskMismatch = 0;   // OpenCVのinRangeと違うピクセル数
+		bool isSIMDExact = false;    // SIMDとスカラーが完全に同じか
+	};
+
+	template <class Function>
+	double MeasureMs(uint32_t iterations, Function function) {
+
+		Clock::time_point begin = Clock::now();
+		for (uint32_t i = 0; i < iterations; ++i) {
+			function();
+		}
+		return std::chrono::duration<double, std::milli>(Clock::now() - begin).count() / iterations;
+	}
+
+	//============================================================
+	// 前処理の比較
+	//============================================================
+	/// 今までのOpenCVの反転、平滑化、グレースケール化、HSVのマスクと、FramePreprocessorを比べる
+	PreprocessResult ComparePreprocess(const cv::Mat& frame, uint32_t iterations) {
+
+		PreprocessResult result{};
+
+		// 今までの並び、検出器は中でグレースケールにするのでそれも含める
+		cv::Mat flipped, blurred, legacyGray, hsv, mask1, mask2, mask;
+		auto openCV = [&]() {
+			cv::flip(frame, flipped, 1);
+			cv::GaussianBlur(flipped, blurred, cv::Size(5, 5), 0);
+			cv::cvtColor(blurred, legacyGray, cv::COLOR_BGR2GRAY);
+			cv::cvtColor(flipped, hsv, cv::COLOR_BGR2HSV);
+			cv::inRange(hsv, cv::Scalar(0, FramePreprocessor::kRedMinSaturation, FramePreprocessor::kRedMinValue),
+				cv::Scalar(FramePreprocessor::kRedHueHigh1, 255, 255), mask1);
+			cv::inRange(hsv, cv::Scalar(FramePreprocessor::kRedHueLow2, FramePreprocessor::kRedMinSaturation, FramePreprocessor::kRedMinValue),
+				cv::Scalar(FramePreprocessor::kRedHueHigh2, 255, 255), mask2);
+			cv::bitwise_or(mask1, mask2, mask);
+		};
+		result.openCVMs = MeasureMs(iterations, openCV);
+
+		cv::Mat color(frame.size(), CV_8UC3);
+		cv::Mat gray[2] = { cv::Mat(frame.size(), CV_8UC1), cv::Mat(frame.size(), CV_8UC1) };
+		cv::Mat fusedMask[2] = { cv::Mat(frame.size(), CV_8UC1), cv::Mat(frame.size(), CV_8UC1) };
+
+		FrameSourceImage source{ frame.data, static_cast<uint32_t>(frame.cols), static_cast<uint32_t>(frame.rows), frame.step };
+		auto fused = [&](uint32_t output, bool useSIMD, uint32_t threadCount) {
+
+			FramePreprocessor::Settings settings{};
+			settings.useSIMD = useSIMD;
+			settings.threadCount = threadCount;
+			FramePreprocessor::Process(source,
+				FrameOutputImage{ gray[output].data, gray[output].step },
+				FrameOutputImage{ fusedMask[output].data, fusedMask[output].step },
+				FrameOutputImage{ color.data, color.step }, settings);
+		};
+		result.scalarMs = MeasureMs(iterations, [&]() { fused(0, false, 1); });
+		result.simdMs = MeasureMs(iterations, [&]() { fused(1, true, 1); });
+		result.isSIMDExact = cv::countNonZero(gray[0] != gray[1]) == 0 && cv::countNonZero(fusedMask[0] != fusedMask[1]) == 0;
+		result.threadedMs = MeasureMs(iterations, [&]() { fused(1, true, 0); });
+		result.isSIMDExact = result.isSIMDExact && cv::countNonZero(gray[0] != gray[1]) == 0 && cv::countNonZero(fusedMask[0] != fusedMask[1]) == 0;
+
+		// 同じ順(グレースケールにしてから平滑化)のOpenCVとは一致するはず
+		cv::Mat expectedGray;
+		cv::cvtColor(flipped, expectedGray, cv::COLOR_BGR2GRAY);
+		cv::GaussianBlur(expectedGray, expectedGray, cv::Size(5, 5), 0);
+
+		double maxDiff = 0.0;
+		cv::Mat diff;
+		cv::absdiff(gray[0], expectedGray, diff);
+		cv::minMaxLoc(diff, nullptr, &maxDiff);
+		result.grayMaxDiff = static_cast<int>(maxDiff);
+
+		cv::absdiff(gray[0], legacyGray, diff);
+		cv::minMaxLoc(diff, nullptr, &maxDiff);
+		result.legacyGrayMaxDiff = static_cast<int>(maxDiff);
+		result.legacyGrayMeanDiff = cv::mean(diff)[0];
+
+		result.maskMismatch = static_cast<uint64_t>(cv::countNonZero(fusedMask[0] != mask));
+		return result;
+	}
+
+	void PrintPreprocess(const char* name, const PreprocessResult& result) {
+
+		std::printf("  %-20s %8.3f  %8.3f  %8.3f  %8.3f  %5d  %5d %6.3f  %8llu  %s\n", name,
+			result.openCVMs, result.scalarMs, result.simdMs, result.threadedMs,
+			result.grayMaxDiff, result.legacyGrayMaxDiff, result.legacyGrayMeanDiff,
+			static_cast<unsigned long long>(result.maskMismatch), result.isSIMDExact ? "yes" : "NO");
+	}
+
+	// 検出の間引きの結果
+	struct ScheduleResult {
+
+		uint64_t frameCount = 0;
+		uint64_t codeFrameCount = 0;   // QRコードが写っているフレーム
+		uint64_t everyCorrectCount = 0; // 毎フレーム全体を探したときに読めた数
+		uint64_t correctCount = 0;     // 間引いたときに読めた数
+		double everyDetectMs = 0.0;    // 毎フレーム全体を探した合計
+		QRDetectionScheduler::Stats stats;
+	};
+
+	//============================================================
+	// 検出の間引きの計測
+	//============================================================
+	/// 同じフレームで、毎フレーム全体を探す場合とQRDetectionSchedulerで間引く場合を比べる
+	/// blankPeriodが0でなければ、その数のフレームごとにQRコードのない画像と入れ替えて見失わせる
+	ScheduleResult MeasureSchedule(IFrameSource& source, uint64_t maxFrameCount, uint64_t blankPeriod,
+		const QRDetectionScheduler::Settings& settings) {
+
+		QRDecoder everyDecoder;
+		QRDecoder decoder;
+		QRDetectionScheduler scheduler(settings);
+		cv::Mat frame;
+		QRDecoder::Images images;
+
+		// QRコードのない画像、灰色にノイズ
+		cv::Mat blank(static_cast<int>(source.GetHeight()), static_cast<int>(source.GetWidth()), CV_8UC1);
+		cv::randn(blank, cv::Scalar::all(128.0), cv::Scalar::all(20.0));
+
+		ScheduleResult result{};
+		while (result.frameCount < maxFrameCount && source.Read(frame)) {
+
+			decoder.Preprocess(frame, source.IsMirrored(), images);
+			bool hasCode = blankPeriod == 0 || (result.frameCount / blankPeriod) % 2 == 0;
+			const cv::Mat& gray = hasCode ? images.gray : blank;
+			const std::string& expected = source.GetExpectedText();
+
+			Clock::time_point begin = Clock::now();
+			std::string everyText = everyDecoder.Detect(gray);
+			result.everyDetectMs += std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+
+			QRDetectionScheduler::Result scheduled = scheduler.Detect(decoder, gray);
+
+			++result.frameCount;
+			if (!hasCode) {
+				continue;
+			}
+			++result.codeFrameCount;
+			if (expected.empty() ? !everyText.empty() : everyText == expected) {
+				++result.everyCorrectCount;
+			}
+			if (expected.empty() ? !scheduled.text.empty() : scheduled.text == expected) {
+				++result.correctCount;
+			}
+		}
+		result.stats = scheduler.GetStats();
+		return result;
+	}
+
+	void PrintSchedule(const char* name, const ScheduleResult& result) {
+
+		const QRDetectionScheduler::Stats& stats = result.stats;
+		double frames = double((std::max)(result.frameCount, uint64_t(1)));
+		double codeFrames = double((std::max)(result.codeFrameCount, uint64_t(1)));
+		std::printf("  %-20s %6llu  %6.1f %%  %6.1f %%  %8.2f  %8.2f  %8.2f  %8.2f  %5llu %5llu %5llu  %4llu\n", name,
+			static_cast<unsigned long long>(result.frameCount),
+			100.0 * result.everyCorrectCount / codeFrames, 100.0 * result.correctCount / codeFrames,
+			result.everyDetectMs / frames, (stats.trackedMs + stats.untrackedMs) / frames,
+			stats.trackedFrames != 0 ? stats.trackedMs / stats.trackedFrames : 0.0,
+			stats.untrackedFrames != 0 ? stats.untrackedMs / stats.untrackedFrames : 0.0,
+			static_cast<unsigned long long>(stats.scanCounts[static_cast<size_t>(QRDetectionScheduler::Scan::Full)]),
+			static_cast<unsigned long long>(stats.scanCounts[static_cast<size_t>(QRDetectionScheduler::Scan::Pyramid)]),
+			static_cast<unsigned long long>(stats.scanCounts[static_cast<size_t>(QRDetectionScheduler::Scan::None)]),
+			static_cast<unsigned long long>(stats.lostCount));
+	}
+
+	void Print(const char* name, const Result& result) {
+
+		double frames = double((std::max)(result.frameCount, uint64_t(1)));
+		double totalMs = result.preprocessMs + result.detectMs;
+		std::printf("  %-20s %6llu  %6.1f %%  %4llu  %8.2f  %8.2f  %8.1f\n", name,
+			static_cast<unsigned long long>(result.frameCount), 100.0 * result.correctCount / frames,
+			static_cast<unsigned long long>(result.wrongCount),
+			result.preprocessMs / frames, result.detectMs / frames, totalMs > 0.0 ? result.frameCount / (totalMs / 1000.0) : 0.0);
+	}
+}
+
+//============================================================
+// main
+//============================================================
+/// カメラなしで、QRコードの読み込みの成功率と速度を設定ごとに出す
+/// QRBenchmark [設定ごとのフレーム数] [--images ディレクトリ] [--video ファイル]
+/// 画像のディレクトリを渡さなければResources/QRCodeを探す
+int main(int argc, char* argv[]) {
+
+	uint64_t frameCount = 60;
+	std::filesystem::path imageDirectory;
+	std::filesystem::path videoPath;
+	for (int i = 1; i < argc; ++i) {
+
+		if (std::strcmp(argv[i], "--images") == 0 && i + 1 < argc) {
+			imageDirectory = argv[++i];
+		} else if (std::strcmp(argv[i], "--video") == 0 && i + 1 < argc) {
+			videoPath = argv[++i];
+		} else {
+			frameCount = (std::max)(std::strtoull(argv[i], nullptr, 10), 1ull);
+		}
+	}
+
+	// ゲームと同じ、種類の識別子のハッシュを中身にする
+	const std::vector<std::string> kPayloads = {
+		SHA256Hasher::ToHex(SHA256Hasher::HashConstexpr("HAJIKI_TYPE::NORMAL")),
+		SHA256Hasher::ToHex(SHA256Hasher::HashConstexpr("HAJIKI_TYPE::FEATHER")),
+		SHA256Hasher::ToHex(SHA256Hasher::HashConstexpr("HAJIKI_TYPE::HEAVY")),
+	};
+
+	const Config kConfigs[] = {
+		{ "clean",            0.6f,  0.0f, 0.0f,  0.0f },
+		{ "small",            0.25f, 0.0f, 0.0f,  0.0f },
+		{ "large",            0.95f, 0.0f, 0.0f,  0.0f },
+		{ "rotate 15",        0.6f, 15.0f, 0.0f,  0.0f },
+		{ "rotate 45",        0.6f, 45.0f, 0.0f,  0.0f },
+		{ "blur 1.5",         0.6f,  0.0f, 1.5f,  0.0f },
+		{ "blur 3",           0.6f,  0.0f, 3.0f,  0.0f },
+		{ "noise 10",         0.6f,  0.0f, 0.0f, 10.0f },
+		{ "noise 30",         0.6f,  0.0f, 0.0f, 30.0f },
+		{ "mixed",            0.35f, 30.0f, 1.5f, 15.0f },
+	};
+
+	std::printf("  %-20s %6s  %8s  %4s  %8s  %8s  %8s\n", "config", "frames", "success", "bad", "prep ms", "det ms", "fps");
+
+	for (const Config& config : kConfigs) {
+
+		SyntheticFrameSource::Settings settings{};
+		settings.payloads = kPayloads;
+		settings.scale = config.scale;
+		settings.rotation = config.rotation;
+		settings.blurSigma = config.blurSigma;
+		settings.noiseSigma = config.noiseSigma;
+		SyntheticFrameSource source(settings);
+
+		Print(config.name, Measure(source, frameCount));
+	}
+
+	// 前処理だけの比較、合成したQRコードと、マスクの分岐が多くなる乱数の色で
+	std::printf("\n  %-20s %8s  %8s  %8s  %8s  %5s  %12s  %8s  %s\n", "preprocess", "opencv", "scalar", "simd", "threads",
+		"gray", "legacy gray", "mask bad", "simd exact");
+	std::printf("  AVX2 %s\n", FramePreprocessor::IsSIMDSupported() ? "supported" : "not supported");
+
+	for (const cv::Size& size : { cv::Size(640, 360), cv::Size(1280, 720), cv::Size(1920, 1080) }) {
+
+		SyntheticFrameSource::Settings settings{};
+		settings.payloads = kPayloads;
+		settings.width = static_cast<uint32_t>(size.width);
+		settings.height = static_cast<uint32_t>(size.height);
+		SyntheticFrameSource source(settings);
+		cv::Mat frame;
+		source.Read(frame);
+
+		cv::Mat randomFrame(size, CV_8UC3);
+		cv::randu(randomFrame, cv::Scalar::all(0), cv::Scalar::all(256));
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "qr %dx%d", size.width, size.height);
+		PrintPreprocess(name, ComparePreprocess(frame, static_cast<uint32_t>(frameCount)));
+		std::snprintf(name, sizeof(name), "random %dx%d", size.width, size.height);
+		PrintPreprocess(name, ComparePreprocess(randomFrame, static_cast<uint32_t>(frameCount)));
+	}
+
+	// 検出の間引き、見つかっている間(tracked)と見失っている間(untracked)の1フレームの検出の時間
+	std::printf("\n  %-20s %6s  %8s  %8s  %8s  %8s  %8s  %8s  %5s %5s %5s  %4s\n", "schedule", "frames", "every", "sched",
+		"every ms", "sched ms", "tracked", "untrack", "full", "pyr", "skip", "lost");
+
+	const struct {
+		const char* name;
+		float scale;
+		uint64_t blankPeriod;
+		float budgetMs;
+	} kSchedules[] = {
+		{ "still",               0.6f,  0,  8.0f },
+		{ "still small",         0.25f, 0,  8.0f },
+		{ "lost 30",             0.6f, 30,  8.0f },
+		{ "lost 30 budget 2",    0.6f, 30,  2.0f },
+		{ "lost 30 budget 30",   0.6f, 30, 30.0f },
+		{ "small lost 30",       0.25f, 30, 8.0f },
+	};
+	for (const auto& schedule : kSchedules) {
+
+		// 中身は変えずに、同じ位置に置き続ける
+		SyntheticFrameSource::Settings settings{};
+		settings.payloads = { kPayloads[0] };
+		settings.scale = schedule.scale;
+		SyntheticFrameSource source(settings);
+
+		QRDetectionScheduler::Settings schedulerSettings{};
+		schedulerSettings.budgetMs = schedule.budgetMs;
+		PrintSchedule(schedule.name, MeasureSchedule(source, (std::max)(frameCount, uint64_t(120)), schedule.blankPeriod, schedulerSettings));
+	}
+
+	// 実際のQRコードの画像、正解はないので読めたかだけ
+	if (imageDirectory.empty()) {
+		for (const char* candidate : { "Resources/QRCode", "../../Resources/QRCode" }) {
+			if (std::filesystem::is_directory(candidate)) {
+				imageDirectory = candidate;
+				break;
+			}
+		}
+	}
+	if (!imageDirectory.empty()) {
+
+		ImageDirectoryFrameSource source(imageDirectory, 0);
+		if (source.IsOpened()) {
+			Print(imageDirectory.filename().string().c_str(), Measure(source, frameCount));
+		} else {
+			std::printf("  no images in %s\n", imageDirectory.string().c_str());
+		}
+	}
+
+	if (!videoPath.empty()) {
+
+		VideoFrameSource source(videoPath);
+		if (source.IsOpened()) {
+			Print(videoPath.filename().string().c_str(), Measure(source, frameCount));
+		} else {
+			std::printf("  cannot open %s\n", videoPath.string().c_str());
+		}
+	}
+
+	return 0;
+}
\ No newline at end of file
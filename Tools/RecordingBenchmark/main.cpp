@@ -0,0 +1,153 @@
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <thread>
+
+#include "DrawCommand.h"
+#include "ParallelRecorder.h"
+#include "RecordingCommandContext.h"
+
+namespace {
+
+	//============================================================
+	// 描画リストの生成
+	//============================================================
+	/// ゲームの描画リストに近づけるため、パイプラインと頂点バッファはしばらく同じものが続くようにする
+	std::vector<DrawCommand> MakeCommands(size_t count) {
+
+		std::mt19937 random(0);
+		std::vector<DrawCommand> commands(count);
+
+		uint32_t pipelineType = 0;
+		uint64_t vertexBufferAddress = 0x10000;
+		for (size_t i = 0; i < count; ++i) {
+
+			DrawCommand& command = commands[i];
+
+			if (random() % 16 == 0) {
+				pipelineType = random() % 5;
+			}
+			if (random() % 4 == 0) {
+				vertexBufferAddress = 0x10000 + (random() % 64) * 0x1000;
+			}
+
+			command.pipelineType = pipelineType;
+			command.vertexBufferAddress = vertexBufferAddress;
+			command.vertexBufferSize = 0x1000;
+			command.vertexStride = 36;
+
+			// 半分はインデックス付き
+			if (random() % 2 == 0) {
+				command.indexBufferAddress = 0x100000 + (random() % 8) * 0x1000;
+				command.indexBufferSize = 0x1000;
+				command.indexCount = 6 + random() % 64 * 3;
+				command.startIndex = random() % 16;
+			} else {
+				command.vertexCount = 3 + random() % 64 * 3;
+			}
+			command.startVertex = random() % 16;
+			command.instanceCount = 1 + random() % 4;
+
+			// CBufferは描画ごとに違い、テクスチャは偏りがある
+			command.AddRootParameter(DrawRootParameterType::CONSTANTBUFFER, 0, 0x200000 + i * 256);
+			command.AddRootParameter(DrawRootParameterType::CONSTANTBUFFER, 1, 0x200000 + i * 256 + 128);
+			command.AddRootParameter(DrawRootParameterType::DESCRIPTORTABLE, 2, 0x300000 + (random() % 4) * 32);
+			if (pipelineType % 2 == 0) {
+				command.AddRootParameter(DrawRootParameterType::SHADERRESOURCE, 3, 0x400000 + (random() % 2) * 0x100);
+			}
+		}
+
+		return commands;
+	}
+
+	//============================================================
+	// 記録
+	//============================================================
+	/// contextCount個の記録先に分けて記録し、番号順につなげたものをresultに入れる。かかった時間を秒で返す
+	double Record(ParallelRecorder& recorder, const std::vector<DrawCommand>& commands,
+		std::vector<RecordingCommandContext>& contexts, uint32_t contextCount, RecordingCommandContext& result) {
+
+		for (auto& context : contexts) {
+			context.Clear();
+		}
+
+		auto begin = std::chrono::steady_clock::now();
+		// 設定を省く区間の境目で分ける
+		recorder.Record(GetDrawCommandBlockCount(commands.size()), contextCount, [&](uint32_t contextIndex, size_t beginBlock, size_t endBlock) {
+			size_t rangeBegin = beginBlock * kDrawCommandBlockSize;
+			size_t rangeEnd = (std::min)(endBlock * kDrawCommandBlockSize, commands.size());
+			RecordDrawCommands(contexts[contextIndex], commands.data(), rangeBegin, rangeEnd);
+			});
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+		// 提出と同じ順につなげる
+		result.Clear();
+		for (uint32_t i = 0; i < contextCount; ++i) {
+			result.Append(contexts[i]);
+		}
+		return seconds;
+	}
+}
+
+//============================================================
+// main
+//============================================================
+/// 記録先の数を1から増やしながら同じ描画リストを記録し、速度と1つで記録したものと一致するかを出す
+/// 引数で描画の数を変えられる
+int main(int argc, char* argv[]) {
+
+	size_t drawCount = 100000;
+	if (argc > 1) {
+		drawCount = std::strtoull(argv[1], nullptr, 10);
+	}
+
+	uint32_t maxContextCount = std::clamp(std::thread::hardware_concurrency(), 1u, ParallelRecorder::kMaxContextNum);
+
+	std::vector<DrawCommand> commands = MakeCommands(drawCount);
+
+	ParallelRecorder recorder;
+	recorder.Initialize(maxContextCount);
+	std::vector<RecordingCommandContext> contexts(maxContextCount);
+
+	// 1つで記録したものを正解にする
+	RecordingCommandContext single;
+	Record(recorder, commands, contexts, 1, single);
+	const std::vector<RecordingCommandContext::Entry> expected = single.GetEntries();
+
+	bool isValid = single.GetDrawCount() == drawCount;
+	double singleSeconds = 0.0;
+
+	std::printf("%zu draws\n", drawCount);
+	RecordingCommandContext result;
+	for (uint32_t contextCount = 1; contextCount <= maxContextCount; ++contextCount) {
+
+		// 1回目は捨てる
+		double bestSeconds = 0.0;
+		for (int repeat = 0; repeat < 5; ++repeat) {
+
+			double seconds = Record(recorder, commands, contexts, contextCount, result);
+			if (repeat == 1 || (repeat > 1 && seconds < bestSeconds)) {
+				bestSeconds = seconds;
+			}
+		}
+		if (contextCount == 1) {
+			singleSeconds = bestSeconds;
+		}
+
+		// 区間の境目で分けているので、設定の省略も含めて1つで記録したものと同じになる
+		bool isMatch = result.GetDrawCount() == drawCount && result.GetEntries() == expected;
+		isValid = isValid && isMatch;
+
+		std::printf("  %u contexts  %10.2f Mdraw/s  x%5.2f  %8zu entries  %s\n", contextCount,
+			double(drawCount) / bestSeconds / 1000000.0, singleSeconds / bestSeconds,
+			result.GetEntries().size(), isMatch ? "match" : "MISMATCH");
+	}
+
+	recorder.Finalize();
+
+	std::printf(isValid ? "all recordings match\n" : "recording mismatch\n");
+	return isValid ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include "RenderGraph.h"
+#include "RecordingBarrierContext.h"
+
+namespace {
+
+	const uint64_t kTargetSize = 8ull * 1024 * 1024;   // 1920x1080のRGBA8程度
+	const uint64_t kShadowSize = 4ull * 1024 * 1024;   // 1024x1024のD32程度
+	const uint32_t kPostProcessCount = 6;
+
+	// 一時的なテクスチャの設定
+	RenderGraphTextureDesc MakeDesc(const std::string& name, uint64_t size, uint32_t usage) {
+
+		RenderGraphTextureDesc desc{};
+		desc.name = name;
+		desc.usage = usage;
+		desc.size = size;
+		return desc;
+	}
+
+	//============================================================
+	// グラフの組み立て
+	//============================================================
+	/// 影、GBuffer、ライティング、ポストエフェクトを持つビューをviewCount個並べ、最後にバックバッファへまとめる
+	/// ビューごとに出力に繋がらないデバッグ用のパスを1つ入れる
+	void BuildGraph(RenderGraph& graph, uint32_t viewCount) {
+
+		graph.Reset();
+		RenderGraphResource backBuffer = graph.ImportResource("BackBuffer", RENDERGRAPH_STATE_PRESENT, RENDERGRAPH_STATE_PRESENT);
+
+		std::vector<RenderGraphResource> outputs;
+		for (uint32_t view = 0; view < viewCount; ++view) {
+
+			std::string prefix = "View" + std::to_string(view) + ".";
+
+			RenderGraphResource shadow = graph.CreateTexture(MakeDesc(prefix + "Shadow", kShadowSize, RENDERGRAPH_STATE_DEPTHWRITE));
+			graph.AddPass(prefix + "Shadow", [&](RenderGraphBuilder& builder) {
+				builder.Write(shadow, RENDERGRAPH_STATE_DEPTHWRITE);
+				}, nullptr);
+
+			RenderGraphResource albedo = graph.CreateTexture(MakeDesc(prefix + "Albedo", kTargetSize, RENDERGRAPH_STATE_RENDERTARGET));
+			RenderGraphResource normal = graph.CreateTexture(MakeDesc(prefix + "Normal", kTargetSize, RENDERGRAPH_STATE_RENDERTARGET));
+			RenderGraphResource depth = graph.CreateTexture(MakeDesc(prefix + "Depth", kTargetSize, RENDERGRAPH_STATE_DEPTHWRITE));
+			graph.AddPass(prefix + "GBuffer", [&](RenderGraphBuilder& builder) {
+				builder.Write(albedo, RENDERGRAPH_STATE_RENDERTARGET);
+				builder.Write(normal, RENDERGRAPH_STATE_RENDERTARGET);
+				builder.Write(depth, RENDERGRAPH_STATE_DEPTHWRITE);
+				}, nullptr);
+
+			RenderGraphResource debug = graph.CreateTexture(MakeDesc(prefix + "Debug", kTargetSize, RENDERGRAPH_STATE_RENDERTARGET));
+			graph.AddPass(prefix + "Debug", [&](RenderGraphBuilder& builder) {
+				builder.Read(normal, RENDERGRAPH_STATE_PIXELSHADERRESOURCE);
+				builder.Write(debug, RENDERGRAPH_STATE_RENDERTARGET);
+				}, nullptr);
+
+			RenderGraphResource hdr = graph.CreateTexture(MakeDesc(prefix + "Lighting", kTargetSize * 2, RENDERGRAPH_STATE_UNORDEREDACCESS));
+			graph.AddPass(prefix + "Lighting", [&](RenderGraphBuilder& builder) {
+				builder.Read(shadow, RENDERGRAPH_STATE_NONPIXELSHADERRESOURCE);
+				builder.Read(albedo, RENDERGRAPH_STATE_NONPIXELSHADERRESOURCE);
+				builder.Read(normal, RENDERGRAPH_STATE_NONPIXELSHADERRESOURCE);
+				builder.Read(depth, RENDERGRAPH_STATE_NONPIXELSHADERRESOURCE);
+				builder.Write(hdr, RENDERGRAPH_STATE_UNORDEREDACCESS);
+				}, nullptr);
+
+			// 前の結果を読んで次へ書くのを繰り返す
+			RenderGraphResource source = hdr;
+			for (uint32_t i = 0; i < kPostProcessCount; ++i) {
+
+				std::string name = prefix + "Post" + std::to_string(i);
+				RenderGraphResource target = graph.CreateTexture(MakeDesc(name, kTargetSize, RENDERGRAPH_STATE_RENDERTARGET));
+				graph.AddPass(name, [&](RenderGraphBuilder& builder) {
+					builder.Read(source, RENDERGRAPH_STATE_PIXELSHADERRESOURCE);
+					builder.Read(depth, RENDERGRAPH_STATE_PIXELSHADERRESOURCE);
+					builder.Write(target, RENDERGRAPH_STATE_RENDERTARGET);
+					}, nullptr);
+				source = target;
+			}
+			outputs.push_back(source);
+		}
+
+		graph.AddPass("Composite", [&](RenderGraphBuilder& builder) {
+			for (RenderGraphResource output : outputs) {
+				builder.Read(output, RENDERGRAPH_STATE_PIXELSHADERRESOURCE);
+			}
+			builder.Write(backBuffer, RENDERGRAPH_STATE_RENDERTARGET);
+			}, nullptr);
+	}
+}
+
+//============================================================
+// main
+//============================================================
+/// ビューの数を増やしながら組み立て、Compile、Executeにかかる時間と、バリアとメモリの共有の結果を出す
+/// 引数で最大のビューの数を変えられる
+int main(int argc, char* argv[]) {
+
+	uint32_t maxViewCount = 64;
+	if (argc > 1) {
+		maxViewCount = static_cast<uint32_t>((std::max)(1ul, std::strtoul(argv[1], nullptr, 10)));
+	}
+
+	RenderGraph graph;
+	RecordingBarrierContext context;
+	bool isValid = true;
+
+	for (uint32_t viewCount = 1; viewCount <= maxViewCount; viewCount *= 2) {
+
+		// 1回目は捨てる
+		double bestBuild = 0.0;
+		double bestCompile = 0.0;
+		double bestExecute = 0.0;
+		for (int repeat = 0; repeat < 6; ++repeat) {
+
+			auto begin = std::chrono::steady_clock::now();
+			BuildGraph(graph, viewCount);
+			auto built = std::chrono::steady_clock::now();
+			graph.Compile();
+			auto compiled = std::chrono::steady_clock::now();
+			context.Clear();
+			graph.Execute(context);
+			auto executed = std::chrono::steady_clock::now();
+
+			double build = std::chrono::duration<double, std::milli>(built - begin).count();
+			double compile = std::chrono::duration<double, std::milli>(compiled - built).count();
+			double execute = std::chrono::duration<double, std::milli>(executed - compiled).count();
+			if (repeat == 1) {
+				bestBuild = build;
+				bestCompile = compile;
+				bestExecute = execute;
+			} else if (repeat > 1) {
+				bestBuild = (std::min)(bestBuild, build);
+				bestCompile = (std::min)(bestCompile, compile);
+				bestExecute = (std::min)(bestExecute, execute);
+			}
+		}
+
+		// 数えたものと記録したものが一致し、共有で小さくなっている
+		const RenderGraph::Stats& stats = graph.GetStats();
+		bool isMatch = stats.barrierCount == context.GetBarrierCount() &&
+			stats.barrierBatchCount == context.GetBatches().size() &&
+			stats.discardCount == context.GetDiscards().size() &&
+			stats.culledPassCount == viewCount &&
+			stats.transientHeapSize <= stats.transientSize;
+		isValid = isValid && isMatch;
+
+		std::printf("%3u views  %5u passes  %4u culled  build %8.3f ms  compile %8.3f ms  execute %7.3f ms\n",
+			viewCount, stats.passCount, stats.culledPassCount, bestBuild, bestCompile, bestExecute);
+		std::printf("           %5u barriers  %4u batches  %4u discards  heap %7.1f MB / %7.1f MB  %s\n",
+			stats.barrierCount, stats.barrierBatchCount, stats.discardCount,
+			double(stats.transientHeapSize) / (1024.0 * 1024.0), double(stats.transientSize) / (1024.0 * 1024.0),
+			isMatch ? "match" : "MISMATCH");
+	}
+
+	std::printf(isValid ? "all graphs match\n" : "graph mismatch\n");
+	return isValid ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include <Windows.h>
+#include <objbase.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+
+#include "TextureCooker.h"
+#include "MipGenerator.h"
+
+//============================================================
+// 使い方
+//============================================================
+static void PrintUsage() {
+
+	std::printf(
+		"usage: TextureCooker [options] [inputs...]\n"
+		"  inputs            image files or directories (default: ./Resources/Images)\n"
+		"  -o <directory>    output directory (default: ./Resources/Cooked)\n"
+		"  -f <format>       auto | bc1 | bc3 | bc7 | rgba8 (default: auto)\n"
+		"  -linear           not sRGB, for normal maps and masks\n"
+		"  -nomips           do not generate mipmaps\n"
+		"  -benchmark [file] compare mipmap generation with DirectXTex (default: 4096x4096 noise)\n");
+}
+
+//============================================================
+// ミップマップの作成の比較
+//============================================================
+/// 読み込み時と同じDirectXTexのGenerateMipMapsとMipGeneratorの時間と、全ミップの差の最大
+static int RunMipBenchmark(const std::string& source) {
+
+	DirectX::ScratchImage image{};
+	if (source.empty()) {
+
+		// 圧縮されにくいノイズ
+		HRESULT hr = image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 4096, 4096, 1, 1);
+		if (FAILED(hr)) {
+			return 1;
+		}
+		std::mt19937 random(0);
+		uint8_t* pixels = image.GetPixels();
+		for (size_t i = 0; i < image.GetPixelsSize(); ++i) {
+			pixels[i] = static_cast<uint8_t>(random());
+		}
+	} else {
+
+		std::wstring path = std::filesystem::path(source).wstring();
+		HRESULT hr = DirectX::LoadFromWICFile(path.c_str(), DirectX::WIC_FLAGS_FORCE_SRGB, nullptr, image);
+		if (FAILED(hr) || DirectX::BitsPerPixel(image.GetMetadata().format) != 32) {
+			std::printf("failed  %s: not an RGBA8 image\n", source.c_str());
+			return 1;
+		}
+	}
+
+	const DirectX::TexMetadata& metadata = image.GetMetadata();
+	std::printf("benchmark %zux%zu %s\n", metadata.width, metadata.height, DirectX::IsSRGB(metadata.format) ? "sRGB" : "linear");
+
+	// 基準 読み込み時に使っていたもの
+	DirectX::ScratchImage reference{};
+	auto start = std::chrono::steady_clock::now();
+	HRESULT hr = DirectX::GenerateMipMaps(image.GetImages(), image.GetImageCount(), metadata, DirectX::TEX_FILTER_SRGB, 0, reference);
+	float referenceMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	if (FAILED(hr)) {
+		return 1;
+	}
+	std::printf("  DirectXTex           %8.2fms\n", referenceMs);
+
+	uint32_t levelCount = MipGenerator::CalculateMipLevels(static_cast<uint32_t>(metadata.width), static_cast<uint32_t>(metadata.height));
+
+	struct Case {
+		const char* name;
+		bool useSIMD;
+		uint32_t threadCount;
+	};
+	const Case cases[] = {
+		{ "MipGenerator scalar", false, 1 },
+		{ "MipGenerator AVX2", true, 1 },
+		{ "MipGenerator AVX2 MT", true, 0 },
+	};
+
+	for (const Case& benchmarkCase : cases) {
+
+		if (benchmarkCase.useSIMD && !MipGenerator::IsSIMDSupported()) {
+			std::printf("  %-20s  AVX2 is not supported\n", benchmarkCase.name);
+			continue;
+		}
+
+		DirectX::ScratchImage mipImages{};
+		hr = mipImages.Initialize2D(metadata.format, metadata.width, metadata.height, 1, levelCount);
+		if (FAILED(hr)) {
+			return 1;
+		}
+		const DirectX::Image* top = mipImages.GetImage(0, 0, 0);
+		const DirectX::Image* sourceImage = image.GetImage(0, 0, 0);
+		for (size_t y = 0; y < metadata.height; ++y) {
+			std::memcpy(top->pixels + y * top->rowPitch, sourceImage->pixels + y * sourceImage->rowPitch, metadata.width * 4);
+		}
+
+		std::vector<MipSurface> levels(levelCount);
+		for (uint32_t level = 0; level < levelCount; ++level) {
+
+			const DirectX::Image* mip = mipImages.GetImage(level, 0, 0);
+			levels[level] = { mip->pixels, static_cast<uint32_t>(mip->width), static_cast<uint32_t>(mip->height), mip->rowPitch };
+		}
+
+		MipGenerator::Settings settings{};
+		settings.isSRGB = DirectX::IsSRGB(metadata.format);
+		settings.useSIMD = benchmarkCase.useSIMD;
+		settings.threadCount = benchmarkCase.threadCount;
+
+		start = std::chrono::steady_clock::now();
+		MipGenerator::Generate(levels.data(), levelCount, settings);
+		float timeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		// 基準との差、大きさが2の累乗でなければDirectXTexは別のフィルタになる
+		int maxDifference = 0;
+		uint64_t overCount = 0;
+		for (uint32_t level = 1; level < levelCount && level < reference.GetMetadata().mipLevels; ++level) {
+
+			const DirectX::Image* expected = reference.GetImage(level, 0, 0);
+			const DirectX::Image* actual = mipImages.GetImage(level, 0, 0);
+			for (size_t y = 0; y < actual->height; ++y) {
+				for (size_t x = 0; x < actual->width * 4; ++x) {
+
+					int difference = std::abs(int(expected->pixels[y * expected->rowPitch + x]) - int(actual->pixels[y * actual->rowPitch + x]));
+					maxDifference = (std::max)(maxDifference, difference);
+					overCount += difference > 1 ? 1 : 0;
+				}
+			}
+		}
+
+		std::printf("  %-20s %8.2fms  x%.2f  max difference %d, %llu values over 1\n",
+			benchmarkCase.name, timeMs, referenceMs / timeMs, maxDifference, static_cast<unsigned long long>(overCount));
+	}
+
+	return 0;
+}
+
+//============================================================
+// 画像を焼いてDDSにする
+//============================================================
+int main(int argc, char* argv[]) {
+
+	// WICで画像を読む
+	CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+	std::string outputDirectory = "./Resources/Cooked";
+	TextureCookSettings settings{};
+	std::vector<std::filesystem::path> inputs;
+
+	for (int i = 1; i < argc; ++i) {
+
+		std::string arg = argv[i];
+		if (arg == "-o" && i + 1 < argc) {
+			outputDirectory = argv[++i];
+		} else if (arg == "-f" && i + 1 < argc) {
+
+			std::string format = argv[++i];
+			if (format == "auto") {
+				settings.format = TextureCookFormat::AUTO;
+			} else if (format == "bc1") {
+				settings.format = TextureCookFormat::BC1;
+			} else if (format == "bc3") {
+				settings.format = TextureCookFormat::BC3;
+			} else if (format == "bc7") {
+				settings.format = TextureCookFormat::BC7;
+			} else if (format == "rgba8") {
+				settings.format = TextureCookFormat::RGBA8;
+			} else {
+				PrintUsage();
+				return 1;
+			}
+		} else if (arg == "-linear") {
+			settings.isSRGB = false;
+		} else if (arg == "-nomips") {
+			settings.generateMips = false;
+		} else if (arg == "-benchmark") {
+
+			std::string source = i + 1 < argc ? argv[i + 1] : "";
+			int result = RunMipBenchmark(source);
+			CoUninitialize();
+			return result;
+		} else if (arg == "-h" || arg == "--help") {
+			PrintUsage();
+			return 0;
+		} else if (arg[0] == '-') {
+			PrintUsage();
+			return 1;
+		} else {
+			inputs.push_back(arg);
+		}
+	}
+
+	if (inputs.empty()) {
+		inputs.push_back("./Resources/Images");
+	}
+
+	// ディレクトリは中の画像を全て焼く
+	std::vector<std::string> sources;
+	for (const auto& input : inputs) {
+
+		if (!std::filesystem::is_directory(input)) {
+			sources.push_back(input.string());
+			continue;
+		}
+
+		for (const auto& entry : std::filesystem::directory_iterator(input)) {
+
+			std::string extension = entry.path().extension().string();
+			if (extension == ".png" || extension == ".jpg" || extension == ".bmp" || extension == ".tif") {
+				sources.push_back(entry.path().string());
+			}
+		}
+	}
+
+	uint32_t failedCount = 0;
+	uint32_t cachedCount = 0;
+	uint64_t uncompressedSize = 0;
+	uint64_t cookedSize = 0;
+	float totalTimeMs = 0.0f;
+
+	for (const auto& source : sources) {
+
+		TextureCookResult result = TextureCooker::Cook(source, outputDirectory, settings);
+		totalTimeMs += result.cookTimeMs;
+
+		if (!result.isSucceeded) {
+			std::printf("failed  %s\n", result.error.c_str());
+			failedCount++;
+			continue;
+		}
+
+		if (result.isCached) {
+			std::printf("cached  %s\n", result.outputPath.c_str());
+			cachedCount++;
+			continue;
+		}
+
+		uncompressedSize += result.uncompressedSize;
+		cookedSize += result.cookedSize;
+		std::printf("cooked  %s  %s  %llu -> %llu bytes  %.2fms\n",
+			result.outputPath.c_str(), DirectX::IsCompressed(result.format) ? "BC" : "RGBA8",
+			static_cast<unsigned long long>(result.uncompressedSize), static_cast<unsigned long long>(result.cookedSize), result.cookTimeMs);
+	}
+
+	std::printf("%zu textures, %u cached, %u failed, %llu -> %llu bytes, %.2fms\n",
+		sources.size(), cachedCount, failedCount,
+		static_cast<unsigned long long>(uncompressedSize), static_cast<unsigned long long>(cookedSize), totalTimeMs);
+
+	CoUninitialize();
+
+	return failedCount == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -1,7 +1,5 @@
 #include "VertexResource.h"
 
-#include "DirectXCommon.h"
-
 //============================================================
 // シングルトンインスタンス
 //============================================================
@@ -11,56 +9,134 @@ VertexResource* VertexResource::Instance() {
 }
 
 //============================================================
-// BufferResourceの作成
-//============================================================
-ComPtr<ID3D12Resource> VertexResource::CreateBufferResource(ID3D12Device* device, size_t sizeInBytes) {
-
-	HRESULT hr;
-
-	// 頂点リソース用のヒープの設定
-	D3D12_HEAP_PROPERTIES uploadHeapProperties{};
-	uploadHeapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
-	// 頂点リソースの設定
-	D3D12_RESOURCE_DESC vertexResourceDesc{};
-	// バッファリソース。テクスチャの場合はまた別の設定をする
-	vertexResourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-	// リソースのサイズ、今回はVector4を3頂点分
-	vertexResourceDesc.Width = sizeInBytes;
-	// バッファの場合はこれらは1にする決まり
-	vertexResourceDesc.Height = 1;
-	vertexResourceDesc.DepthOrArraySize = 1;
-	vertexResourceDesc.MipLevels = 1;
-	vertexResourceDesc.SampleDesc.Count = 1;
-	// バッファの場合はこれにする決まり
-	vertexResourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-	// 実際に頂点リソースを作る
-	ComPtr<ID3D12Resource> bufferResource = nullptr;
-	hr = device->CreateCommittedResource(
-		&uploadHeapProperties, D3D12_HEAP_FLAG_NONE, &vertexResourceDesc,
-		D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&bufferResource));
-	assert(SUCCEEDED(hr));
-
-	return bufferResource;
+// 初期化
+//============================================================
+void VertexResource::Initialize(IFrameFence* fence) {
+
+	assert(fence);
+	fence_ = fence;
+	uploadWaitCount_ = 0;
+
+	// アップロードリングの生成、1つの大きなバッファを使いまわす
+	// リングのサイズはブロックより大きいので専用のバッファになる
+	uploadBuffer_ = BufferManager::Instance()->Allocate(kUploadRingSize);
+
+	uploadAllocator_.Initialize(kUploadRingSize);
 }
 
 //============================================================
-// マテリアル生成
+// 終了処理
 //============================================================
-std::unique_ptr<CBMaterialData> VertexResource::CreateMaterial() {
+void VertexResource::Finalize() {
+
+	// GPUの完了を待ってから呼ばれるので、大きくする前のバッファもまとめて返す
+	for (auto& retired : retiredBuffers_) {
+		BufferManager::Instance()->Free(retired.buffer);
+	}
+	retiredBuffers_.clear();
+	for (auto& buffer : currentRetiredBuffers_) {
+		BufferManager::Instance()->Free(buffer);
+	}
+	currentRetiredBuffers_.clear();
+
+	BufferManager::Instance()->Free(uploadBuffer_);
+	uploadAllocator_.Reset();
+	fence_ = nullptr;
+}
 
-	DirectXCommon* directXCommon = DirectXCommon::Instance();
+//============================================================
+// アップロードリングからの確保
+//============================================================
+UploadAllocation VertexResource::Allocate(size_t sizeInBytes, size_t alignment) {
 
-	HRESULT hr;
-	std::unique_ptr<CBMaterialData> material = std::make_unique<CBMaterialData>();
+	uint64_t offset = uploadAllocator_.Allocate(sizeInBytes, alignment);
+
+	// リングが足りない、古いフレームから順にGPUの完了を待って空ける
+	while (offset == RingAllocator::kInvalidOffset && uploadAllocator_.GetPendingFrameCount() != 0) {
+
+		uint64_t fenceValue = uploadAllocator_.GetOldestPendingFenceValue();
+		if (fence_->GetCompletedValue() < fenceValue) {
+
+			fence_->Wait(fenceValue);
+			uploadWaitCount_++;
+		}
+		ReleaseCompletedFrames(fence_->GetCompletedValue());
 
-	// 頂点マテリアルの生成
-	material->resource = CreateBufferResource(directXCommon->GetDevice(), sizeof(Material));
+		offset = uploadAllocator_.Allocate(sizeInBytes, alignment);
+	}
+
+	// このフレームだけで埋まっている、リングを大きくする
+	if (offset == RingAllocator::kInvalidOffset) {
+
+		GrowUploadRing(sizeInBytes + alignment);
+		offset = uploadAllocator_.Allocate(sizeInBytes, alignment);
+	}
+	assert(offset != RingAllocator::kInvalidOffset);
+
+	UploadAllocation allocation{};
+	allocation.cpuAddress = uploadBuffer_.cpuAddress + offset;
+	allocation.gpuAddress = uploadBuffer_.gpuAddress + offset;
+
+	return allocation;
+}
+
+//============================================================
+// フレームの終了
+//============================================================
+void VertexResource::FinishFrame(uint64_t fenceValue) {
+
+	uploadAllocator_.FinishFrame(fenceValue);
+
+	// このフレームで大きくする前のバッファにフェンス値を紐づける
+	for (auto& buffer : currentRetiredBuffers_) {
+		retiredBuffers_.push_back({ fenceValue, buffer });
+	}
+	currentRetiredBuffers_.clear();
+}
+
+//============================================================
+// GPUが読み終わったフレームの回収
+//============================================================
+void VertexResource::ReleaseCompletedFrames(uint64_t completedFenceValue) {
 
-	// マテリアルデータのマッピング
-	hr = material->resource->Map(0, nullptr, reinterpret_cast<void**>(&material->data));
+	uploadAllocator_.ReleaseCompletedFrames(completedFenceValue);
 
-	// 作れなければエラー
-	assert(SUCCEEDED(hr));
+	while (!retiredBuffers_.empty() && retiredBuffers_.front().fenceValue <= completedFenceValue) {
+
+		BufferManager::Instance()->Free(retiredBuffers_.front().buffer);
+		retiredBuffers_.pop_front();
+	}
+}
+
+//============================================================
+// アップロードリングを大きくする
+//============================================================
+void VertexResource::GrowUploadRing(size_t sizeInBytes) {
+
+	// 前のフレームは全て完了しているので、残っているのはこのフレームの確保分だけ
+	assert(uploadAllocator_.GetPendingFrameCount() == 0);
+
+	uint64_t capacity = uploadAllocator_.GetCapacity() * 2;
+	while (capacity < sizeInBytes) {
+		capacity *= 2;
+	}
+
+	// このフレームで書き込んだ分はGPUがまだ読むので、フレームが終わるまで返さない
+	currentRetiredBuffers_.push_back(uploadBuffer_);
+
+	uploadBuffer_ = BufferManager::Instance()->Allocate(capacity);
+	uploadAllocator_.Resize(capacity);
+}
+
+//============================================================
+// マテリアル生成
+//============================================================
+std::unique_ptr<CBMaterialData> VertexResource::CreateMaterial() {
+
+	std::unique_ptr<CBMaterialData> material = std::make_unique<CBMaterialData>();
+
+	// CPU側のマテリアル、描画時にアップロードリングへ転送する
+	material->data = std::make_unique<Material>();
 
 	return material;
 }
@@ -70,19 +146,10 @@ std::unique_ptr<CBMaterialData> VertexResource::CreateMaterial() {
 //============================================================
 std::unique_ptr<CBTransformData> VertexResource::CreateWVP() {
 
-	DirectXCommon* directXCommon = DirectXCommon::Instance();
-
-	HRESULT hr;
 	std::unique_ptr<CBTransformData> matrix = std::make_unique<CBTransformData>();
 
-	// WVPの生成
-	matrix->resource = CreateBufferResource(directXCommon->GetDevice(), sizeof(TransformationMatrix));
-
-	// WVPデータのマッピング
-	hr = matrix->resource->Map(0, nullptr, reinterpret_cast<void**>(&matrix->matrix));
-
-	// 作れなければエラー
-	assert(SUCCEEDED(hr));
+	// CPU側の行列、描画時にアップロードリングへ転送する
+	matrix->matrix = std::make_unique<TransformationMatrix>();
 
 	return matrix;
 }
@@ -92,19 +159,10 @@ std::unique_ptr<CBTransformData> VertexResource::CreateWVP() {
 //============================================================
 std::unique_ptr<CBLightData> VertexResource::CreateLight() {
 
-	DirectXCommon* directXCommon = DirectXCommon::Instance();
-
-	HRESULT hr;
 	std::unique_ptr<CBLightData> light = std::make_unique<CBLightData>();
 
-	// Lightの生成
-	light->resource = CreateBufferResource(directXCommon->GetDevice(), sizeof(DirectionalLight));
-
-	// Lightデータのマッピング
-	hr = light->resource->Map(0, nullptr, reinterpret_cast<void**>(&light->light));
-
-	// 作れなければエラー
-	assert(SUCCEEDED(hr));
+	// CPU側のLight、描画時にアップロードリングへ転送する
+	light->light = std::make_unique<DirectionalLight>();
 
 	return light;
 }
@@ -114,19 +172,10 @@ std::unique_ptr<CBLightData> VertexResource::CreateLight() {
 //============================================================
 std::unique_ptr<CBCameraViewData> VertexResource::CreateCameraView() {
 
-	DirectXCommon* directXCommon = DirectXCommon::Instance();
-
-	HRESULT hr;
 	std::unique_ptr<CBCameraViewData> camera = std::make_unique<CBCameraViewData>();
 
-	// CameraViewの生成
-	camera->resource = CreateBufferResource(directXCommon->GetDevice(), sizeof(CameraViewData));
-
-	// CameraViewデータのマッピング
-	hr = camera->resource->Map(0, nullptr, reinterpret_cast<void**>(&camera->camera));
-
-	// 作れなければエラー
-	assert(SUCCEEDED(hr));
+	// CPU側のCamera、描画時にアップロードリングへ転送する
+	camera->camera = std::make_unique<CameraViewData>();
 
 	return camera;
 }
\ No newline at end of file
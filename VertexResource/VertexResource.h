@@ -4,9 +4,22 @@
 #include <d3d12.h>
 
 #include <memory>
+#include <cstring>
+#include <deque>
+#include <vector>
 
 #include "Function.h"
 #include "ComPtr.h"
+#include "RingAllocator.h"
+#include "BufferManager.h"
+#include "FrameScheduler.h"
+
+// アップロードリングから確保した領域、確保したフレームの間だけ有効
+struct UploadAllocation {
+
+	void* cpuAddress = nullptr;
+	D3D12_GPU_VIRTUAL_ADDRESS gpuAddress = 0;
+};
 
 //================================================
 // VertexResource Class
@@ -18,6 +31,13 @@ public:
 	// public
 	//====================
 
+	// 初期化、アップロードリングの生成
+	// リングが足りないときはfenceで前のフレームの完了を待つ
+	void Initialize(IFrameFence* fence);
+
+	// 終了処理
+	void Finalize();
+
 	// マテリアル生成
 	std::unique_ptr<CBMaterialData> CreateMaterial();
 
@@ -30,15 +50,71 @@ public:
 	// Camera生成
 	std::unique_ptr<CBCameraViewData> CreateCameraView();
 
+	/*-----------------------------------------------------------------------------------------*/
+	/// アップロードリング
+
+	// 確保、CBufferは256バイト境界
+	// リングが足りなければ前のフレームの完了を待ち、このフレームだけで足りなければリングを大きくする
+	UploadAllocation Allocate(size_t sizeInBytes, size_t alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+
+	// 定数データの転送、CBVに設定するGPUアドレスを返す
+	template <typename T>
+	D3D12_GPU_VIRTUAL_ADDRESS UploadConstant(const T& data) {
+
+		UploadAllocation allocation = Allocate(sizeof(T));
+		std::memcpy(allocation.cpuAddress, &data, sizeof(T));
+
+		return allocation.gpuAddress;
+	}
+
+	// フレームの終了、このフレームの確保分をfenceValueに紐づける
+	void FinishFrame(uint64_t fenceValue);
+
+	// GPUが読み終わったフレームの回収
+	void ReleaseCompletedFrames(uint64_t completedFenceValue);
+
 	// シングルトン
 	static VertexResource* Instance();
 
+	// getter
+
+	const RingAllocator::Stats& GetUploadStats() const { return uploadAllocator_.GetStats(); }
+	uint64_t GetUploadRingSize() const { return uploadAllocator_.GetCapacity(); }
+	// リングが足りずにGPUを待った回数
+	uint32_t GetUploadWaitCount() const { return uploadWaitCount_; }
+
 private:
 	//====================
 	// peivate
 	//====================
 
-	// BufferResource生成
-	ComPtr<ID3D12Resource> CreateBufferResource(ID3D12Device* device, size_t sizeInBytes);
+	// 大きくする前のバッファ、確保したフレームがGPUで完了したら返す
+	struct RetiredBuffer {
+
+		uint64_t fenceValue;
+		BufferAllocation buffer;
+	};
+
+	// アップロードリングの最初のサイズ
+	static const size_t kUploadRingSize = 8 * 1024 * 1024;
+
+	// 前のフレームの完了待ちに使う
+	IFrameFence* fence_ = nullptr;
+
+	// 永続的にマップしたアップロードバッファ、BufferManagerから確保する
+	BufferAllocation uploadBuffer_;
+
+	// 切り分けの管理
+	RingAllocator uploadAllocator_;
+
+	// フェンス値が決まったもの
+	std::deque<RetiredBuffer> retiredBuffers_;
+	// 現在のフレームで大きくしたもの、FinishFrameでフェンス値が決まる
+	std::vector<BufferAllocation> currentRetiredBuffers_;
+
+	uint32_t uploadWaitCount_ = 0;
+
+	// sizeInBytesが入るようにリングを作り直す、古いバッファはこのフレームが終わるまで残す
+	void GrowUploadRing(size_t sizeInBytes);
 
 };
\ No newline at end of file